@@ -0,0 +1,176 @@
+#include "BenchmarkData.h"
+#include "Animation/AnimationClip.h"
+#include "Animation/AnimationSystem.h"
+#include "Animation/Skeleton.h"
+#include "Animation/Skinning.h"
+#include "Render/Mesh.h"
+#include "Thread/ThreadPool.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/gtc/quaternion.hpp>
+#include <benchmark/benchmark.h>
+
+static constexpr uint32_t BenchmarkJointCount = 100;
+
+static constexpr uint32_t BenchmarkCharacterCount = 1000;
+
+// A 100 joint skeleton of five 20 joint chains, a 30 frame clip of small random rotations and a grid
+// mesh whose vertices each follow up to four random joints.
+struct AnimationBenchmarkData
+{
+    Skeleton skeleton;
+
+    std::unique_ptr<AnimationClip> clips[2];
+
+    std::unique_ptr<Mesh> mesh;
+
+    std::unique_ptr<SkinnedMesh> skinnedMesh;
+
+    explicit AnimationBenchmarkData(uint32_t cells)
+    {
+        std::mt19937 random{ 3 };
+        std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+
+        for (uint32_t joint = 0; joint < BenchmarkJointCount; ++joint)
+        {
+            JointTransform restPose;
+            restPose.translation = glm::vec3{ 0.0f, 0.1f, 0.0f };
+
+            glm::mat4 inverseBind{ 1.0f };
+            inverseBind[3] = glm::vec4{ 0.0f, -0.1f * static_cast<float>(joint % 20 + 1), 0.0f, 1.0f };
+            skeleton.AddJoint("Joint" + std::to_string(joint), joint % 20 == 0 ? -1 : static_cast<int32_t>(joint - 1), restPose, inverseBind);
+        }
+
+        for (std::unique_ptr<AnimationClip> &clip : clips)
+        {
+            clip = std::make_unique<AnimationClip>("Clip", BenchmarkJointCount, 30, 30.0f);
+            for (uint32_t frame = 0; frame < clip->GetFrameCount(); ++frame)
+            {
+                for (uint32_t joint = 0; joint < BenchmarkJointCount; ++joint)
+                {
+                    JointTransform transform;
+                    transform.translation = glm::vec3{ 0.0f, 0.1f, 0.0f };
+                    transform.rotation = glm::angleAxis(distribution(random) * 0.3f, glm::normalize(glm::vec3{ distribution(random), 1.0f, distribution(random) }));
+                    clip->GetFrame(frame).SetJoint(joint, transform);
+                }
+            }
+        }
+
+        mesh = BenchmarkData::CreateGridMesh(cells);
+
+        std::vector<JointInfluence> influences(mesh->GetVertexCount());
+        for (JointInfluence &influence : influences)
+        {
+            for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+            {
+                influence.joints[slot] = static_cast<uint16_t>(random() % BenchmarkJointCount);
+                influence.weights[slot] = distribution(random) + 1.1f;
+            }
+        }
+        skinnedMesh = std::make_unique<SkinnedMesh>(*mesh, influences.data());
+    }
+};
+
+// range(0) is the SkinningMethod, range(1) whether vertices are skinned on the CPU as well.
+static void BM_AnimationUpdate(benchmark::State &state)
+{
+    SkinningMethod method = static_cast<SkinningMethod>(state.range(0));
+    bool skinOnCpu = state.range(1) != 0;
+
+    // 32 x 32 cell grid, 1089 vertices per character.
+    AnimationBenchmarkData data{ 32 };
+
+    AnimationSystem system;
+    for (uint32_t character = 0; character < BenchmarkCharacterCount; ++character)
+    {
+        system.AddCharacter(data.skeleton, data.skinnedMesh.get());
+
+        AnimationPlayback playback;
+        playback.clip = data.clips[0].get();
+        playback.time = static_cast<float>(character) * 0.01f;
+        system.SetPlayback(character, 0, playback);
+
+        playback.clip = data.clips[1].get();
+        playback.speed = 1.3f;
+        system.SetPlayback(character, 1, playback);
+        system.SetBlendWeight(character, 0.3f);
+    }
+
+    for (auto _ : state)
+    {
+        system.Update(*g_WorkerThreadPool, 1.0f / 60.0f, method, skinOnCpu);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BenchmarkCharacterCount);
+}
+BENCHMARK(BM_AnimationUpdate)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 0, 1 })->Args({ 1, 1 })->UseRealTime();
+
+static void BM_PoseBlend(benchmark::State &state)
+{
+    AnimationBenchmarkData data{ 1 };
+    AnimationPose pose;
+    pose.Resize(BenchmarkJointCount);
+
+    float weight = 0.0f;
+    for (auto _ : state)
+    {
+        PoseBlend::Lerp(data.clips[0]->GetFrame(0), data.clips[1]->GetFrame(0), weight, pose);
+        weight = weight < 1.0f ? weight + 0.01f : 0.0f;
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BenchmarkJointCount);
+}
+BENCHMARK(BM_PoseBlend);
+
+// Single threaded kernels over a 16k vertex mesh, range(0) is the SkinningKernel.
+static void BM_SkinLinearBlend(benchmark::State &state)
+{
+    SkinningKernel kernel = static_cast<SkinningKernel>(state.range(0));
+    AnimationBenchmarkData data{ 127 };
+
+    std::vector<glm::mat4> modelMatrices(BenchmarkJointCount);
+    std::vector<SkinMatrix> skinMatrices(BenchmarkJointCount);
+    Skinning::ComputeModelMatrices(data.skeleton, data.clips[0]->GetFrame(5), modelMatrices.data());
+    Skinning::ComputeSkinMatrices(data.skeleton, modelMatrices.data(), skinMatrices.data());
+
+    std::vector<glm::vec3> positions(data.skinnedMesh->GetVertexCount());
+    std::vector<glm::vec3> normals(data.skinnedMesh->GetVertexCount());
+
+    for (auto _ : state)
+    {
+        Skinning::SkinLinearBlend(*data.skinnedMesh, skinMatrices.data(), positions.data(), normals.data(), kernel);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.skinnedMesh->GetVertexCount());
+}
+BENCHMARK(BM_SkinLinearBlend)->Arg(static_cast<int>(SkinningKernel::Auto))->Arg(static_cast<int>(SkinningKernel::Scalar));
+
+static void BM_SkinDualQuaternion(benchmark::State &state)
+{
+    SkinningKernel kernel = static_cast<SkinningKernel>(state.range(0));
+    AnimationBenchmarkData data{ 127 };
+
+    std::vector<glm::mat4> modelMatrices(BenchmarkJointCount);
+    std::vector<SkinMatrix> skinMatrices(BenchmarkJointCount);
+    std::vector<DualQuaternion> dualQuaternions(BenchmarkJointCount);
+    Skinning::ComputeModelMatrices(data.skeleton, data.clips[0]->GetFrame(5), modelMatrices.data());
+    Skinning::ComputeSkinMatrices(data.skeleton, modelMatrices.data(), skinMatrices.data());
+    Skinning::ComputeDualQuaternions(skinMatrices.data(), BenchmarkJointCount, dualQuaternions.data());
+
+    std::vector<glm::vec3> positions(data.skinnedMesh->GetVertexCount());
+    std::vector<glm::vec3> normals(data.skinnedMesh->GetVertexCount());
+
+    for (auto _ : state)
+    {
+        Skinning::SkinDualQuaternion(*data.skinnedMesh, dualQuaternions.data(), positions.data(), normals.data(), kernel);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.skinnedMesh->GetVertexCount());
+}
+BENCHMARK(BM_SkinDualQuaternion)->Arg(static_cast<int>(SkinningKernel::Auto))->Arg(static_cast<int>(SkinningKernel::Scalar));
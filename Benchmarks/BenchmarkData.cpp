@@ -0,0 +1,168 @@
+#include "BenchmarkData.h"
+#include "Render/GpuScene.h"
+#include "Render/Mesh.h"
+#include "Scene/Scene.h"
+#include "Scene/Transform.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// [0, 1) from the top 24 bits, unlike std::uniform_real_distribution the same on every standard library.
+static float NextFloat(std::mt19937 &random)
+{
+    return static_cast<float>(random() >> 8) * (1.0f / 16777216.0f);
+}
+
+static void BuildGrid(uint32_t cells, std::vector<glm::vec3> &positions, std::vector<glm::vec3> &normals, std::vector<uint32_t> &indices)
+{
+    uint32_t rowLength = cells + 1;
+    float cellSize = 1.0f / static_cast<float>(cells);
+
+    positions.clear();
+    normals.clear();
+    indices.clear();
+
+    for (uint32_t z = 0; z < rowLength; ++z)
+    {
+        for (uint32_t x = 0; x < rowLength; ++x)
+        {
+            positions.push_back({ static_cast<float>(x) * cellSize - 0.5f, 0.0f, static_cast<float>(z) * cellSize - 0.5f });
+            normals.push_back({ 0.0f, 1.0f, 0.0f });
+        }
+    }
+
+    for (uint32_t z = 0; z < cells; ++z)
+    {
+        for (uint32_t x = 0; x < cells; ++x)
+        {
+            uint32_t corner = z * rowLength + x;
+            indices.insert(indices.end(), { corner, corner + rowLength, corner + 1, corner + 1, corner + rowLength, corner + rowLength + 1 });
+        }
+    }
+}
+
+namespace BenchmarkData
+{
+    std::unique_ptr<Mesh> CreateGridMesh(uint32_t cells)
+    {
+        auto mesh = std::make_unique<Mesh>("Grid");
+        BuildGrid(cells, mesh->GetPositions(), mesh->GetNormals(), mesh->GetIndices());
+
+        SubMesh subMesh{};
+        subMesh.indexCount = static_cast<uint32_t>(mesh->GetIndices().size());
+        mesh->GetSubMeshes().push_back(subMesh);
+        mesh->ComputeBounds();
+        return mesh;
+    }
+
+    void CreateHierarchy(Scene &scene, uint32_t objectCount, uint32_t hierarchyDepth)
+    {
+        std::mt19937 random{ 1 };
+
+        GameObject *parent = nullptr;
+        for (uint32_t index = 0; index < objectCount; ++index)
+        {
+            if (index % hierarchyDepth == 0)
+            {
+                parent = nullptr;
+            }
+
+            GameObject &gameObject = scene.CreateGameObject("Object", parent);
+
+            Transform &transform = *gameObject.GetComponent<Transform>();
+            transform.SetTranslation({ NextFloat(random) * 10.0f, NextFloat(random) * 10.0f, NextFloat(random) * 10.0f });
+            transform.SetRotation(glm::angleAxis(NextFloat(random) * 6.28f, glm::normalize(glm::vec3{ NextFloat(random), 1.0f, NextFloat(random) })));
+            transform.SetScale(glm::vec3{ 0.5f + NextFloat(random) });
+
+            parent = &gameObject;
+        }
+    }
+
+    void CreateGpuScene(GpuScene &scene, const Mesh &mesh, uint32_t objectCount)
+    {
+        std::mt19937 random{ 2 };
+
+        uint32_t geometry = scene.AddGeometry(mesh, 0, 0, 0);
+        for (uint32_t index = 0; index < objectCount; ++index)
+        {
+            glm::vec3 position{ NextFloat(random) * 1000.0f - 500.0f, NextFloat(random) * 20.0f, NextFloat(random) * 1000.0f - 500.0f };
+            glm::mat4 world = glm::scale(glm::translate(glm::mat4{ 1.0f }, position), glm::vec3{ 1.0f + NextFloat(random) * 4.0f });
+            scene.AddInstance(geometry, index / 64, world, index);
+        }
+    }
+
+    std::string WriteGltfScene(uint32_t meshCount, uint32_t cells)
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "NextRenderBenchmarks";
+        std::string name = "Grid_" + std::to_string(meshCount) + "_" + std::to_string(cells);
+        std::filesystem::path gltfPath = directory / (name + ".gltf");
+        std::filesystem::path binPath = directory / (name + ".bin");
+
+        if (std::filesystem::exists(gltfPath) && std::filesystem::exists(binPath))
+        {
+            return gltfPath.string();
+        }
+
+        std::filesystem::create_directories(directory);
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<uint32_t> indices;
+        BuildGrid(cells, positions, normals, indices);
+
+        size_t positionBytes = positions.size() * sizeof(glm::vec3);
+        size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+        {
+            std::ofstream bin{ binPath, std::ios::binary | std::ios::trunc };
+            bin.write(reinterpret_cast<const char *>(positions.data()), positionBytes);
+            bin.write(reinterpret_cast<const char *>(normals.data()), positionBytes);
+            bin.write(reinterpret_cast<const char *>(indices.data()), indexBytes);
+        }
+
+        // Every mesh gets its own copy of the accessors, as exporters write them.
+        std::ofstream gltf{ gltfPath, std::ios::trunc };
+        gltf << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\n";
+        gltf << "\"buffers\":[{\"uri\":\"" << name << ".bin\",\"byteLength\":" << positionBytes * 2 + indexBytes << "}],\n";
+        gltf << "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << positionBytes << "},"
+            << "{\"buffer\":0,\"byteOffset\":" << positionBytes << ",\"byteLength\":" << positionBytes << "},"
+            << "{\"buffer\":0,\"byteOffset\":" << positionBytes * 2 << ",\"byteLength\":" << indexBytes << "}],\n";
+
+        gltf << "\"accessors\":[";
+        for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+        {
+            gltf << (mesh > 0 ? ",\n" : "")
+                << "{\"bufferView\":0,\"componentType\":5126,\"count\":" << positions.size() << ",\"type\":\"VEC3\",\"min\":[-0.5,0,-0.5],\"max\":[0.5,0,0.5]},"
+                << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << normals.size() << ",\"type\":\"VEC3\"},"
+                << "{\"bufferView\":2,\"componentType\":5125,\"count\":" << indices.size() << ",\"type\":\"SCALAR\"}";
+        }
+        gltf << "],\n";
+
+        gltf << "\"meshes\":[";
+        for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+        {
+            gltf << (mesh > 0 ? ",\n" : "") << "{\"name\":\"Grid" << mesh << "\",\"primitives\":[{\"attributes\":{\"POSITION\":" << mesh * 3
+                << ",\"NORMAL\":" << mesh * 3 + 1 << "},\"indices\":" << mesh * 3 + 2 << "}]}";
+        }
+        gltf << "],\n";
+
+        gltf << "\"nodes\":[";
+        for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+        {
+            gltf << (mesh > 0 ? ",\n" : "") << "{\"name\":\"Node" << mesh << "\",\"mesh\":" << mesh << ",\"translation\":[" << mesh % 32 << ",0," << mesh / 32 << "]}";
+        }
+        gltf << "],\n";
+
+        gltf << "\"scenes\":[{\"nodes\":[";
+        for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+        {
+            gltf << (mesh > 0 ? "," : "") << mesh;
+        }
+        gltf << "]}]}\n";
+
+        return gltfPath.string();
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class Mesh;
+
+class Scene;
+
+class GpuScene;
+
+// Synthetic content shared by the benchmarks. Everything is generated from a fixed seed, so runs on
+// different commits measure the same work.
+namespace BenchmarkData
+{
+    // Flat grid in the XZ plane with (cells + 1)^2 vertices and 2 * cells^2 triangles.
+    std::unique_ptr<Mesh> CreateGridMesh(uint32_t cells);
+
+    // objectCount objects in chains of depth hierarchyDepth, with varied local transforms.
+    void CreateHierarchy(Scene &scene, uint32_t objectCount, uint32_t hierarchyDepth);
+
+    // objectCount instances of a few geometries scattered over a 1km square, one pipeline per 64 objects.
+    void CreateGpuScene(GpuScene &scene, const Mesh &mesh, uint32_t objectCount);
+
+    // Writes a .gltf with an external .bin holding meshCount grid meshes of cells^2 quads, one node
+    // each, and returns its path. Files are reused when they already exist.
+    std::string WriteGltfScene(uint32_t meshCount, uint32_t cells);
+}
@@ -0,0 +1,263 @@
+#include "Gfx/GfxCommandList.h"
+#include "Gfx/GfxResourceManager.h"
+#include "Gfx/GfxSampler.h"
+#include "Thread/ParallelFor.h"
+#include "Thread/ThreadPool.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+static std::vector<SamplerDesc> CreateSamplerDescs(uint32_t count)
+{
+    std::mt19937 random{ 4 };
+
+    std::vector<SamplerDesc> descs(count);
+    for (SamplerDesc &desc : descs)
+    {
+        uint32_t bits = random();
+        desc.magFilter = bits & 1;
+        desc.minFilter = (bits >> 1) & 1;
+        desc.mipmapMode = (bits >> 2) & 1;
+        desc.addressModeU = (bits >> 3) % 5;
+        desc.addressModeV = (bits >> 6) % 5;
+        desc.addressModeW = (bits >> 9) % 5;
+        desc.maxAnisotropy = static_cast<float>(1u << ((bits >> 12) % 5));
+        desc.mipLodBias = static_cast<float>((bits >> 16) % 8) * 0.25f;
+    }
+    return descs;
+}
+
+static void BM_SamplerDescHash(benchmark::State &state)
+{
+    std::vector<SamplerDesc> descs = CreateSamplerDescs(256);
+
+    for (auto _ : state)
+    {
+        for (const SamplerDesc &desc : descs)
+        {
+            benchmark::DoNotOptimize(desc.Hash());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * descs.size());
+}
+BENCHMARK(BM_SamplerDescHash);
+
+// Hash plus compare, the path every material bind takes to find its sampler.
+static void BM_SamplerCacheLookup(benchmark::State &state)
+{
+    std::vector<SamplerDesc> descs = CreateSamplerDescs(static_cast<uint32_t>(state.range(0)));
+
+    std::unordered_map<SamplerDesc, uint32_t> cache;
+    for (const SamplerDesc &desc : descs)
+    {
+        cache.emplace(desc, static_cast<uint32_t>(cache.size()));
+    }
+
+    for (auto _ : state)
+    {
+        for (const SamplerDesc &desc : descs)
+        {
+            benchmark::DoNotOptimize(cache.find(desc));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * descs.size());
+}
+BENCHMARK(BM_SamplerCacheLookup)->Arg(16)->Arg(256);
+
+// Cache hits of RequestShader(), dominated by hashing the source.
+static void BM_ShaderCacheLookup(benchmark::State &state)
+{
+    uint32_t shaderCount = static_cast<uint32_t>(state.range(0));
+    size_t sourceSize = static_cast<size_t>(state.range(1));
+
+    std::mt19937 random{ 5 };
+
+    std::vector<std::vector<uint8_t>> sources(shaderCount);
+    for (std::vector<uint8_t> &source : sources)
+    {
+        source.resize(sourceSize);
+        for (uint8_t &byte : source)
+        {
+            byte = static_cast<uint8_t>(random());
+        }
+    }
+
+    std::vector<std::string> definitions{ "USE_NORMAL_MAP=1", "SHADOW_CASCADES=4" };
+
+    GfxResourceManager resourceManager;
+    for (const std::vector<uint8_t> &source : sources)
+    {
+        resourceManager.RequestShader(FragmentShader, "main", source, definitions);
+    }
+
+    for (auto _ : state)
+    {
+        for (const std::vector<uint8_t> &source : sources)
+        {
+            benchmark::DoNotOptimize(resourceManager.RequestShader(FragmentShader, "main", source, definitions));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * shaderCount);
+    state.SetBytesProcessed(state.iterations() * shaderCount * static_cast<int64_t>(sourceSize));
+}
+BENCHMARK(BM_ShaderCacheLookup)->Args({ 64, 1024 })->Args({ 64, 16384 });
+
+// Handle to object, the lookup every draw does when it is recorded.
+static void BM_TextureHandleResolve(benchmark::State &state)
+{
+    uint32_t textureCount = static_cast<uint32_t>(state.range(0));
+
+    GfxResourceManager resourceManager;
+    std::vector<TextureHandle> handles;
+    for (uint32_t index = 0; index < textureCount; ++index)
+    {
+        TextureDesc desc{};
+        desc.width = 256;
+        desc.height = 256;
+        handles.push_back(resourceManager.CreateTexture(desc));
+    }
+
+    std::shuffle(handles.begin(), handles.end(), std::mt19937{ 6 });
+
+    for (auto _ : state)
+    {
+        for (TextureHandle handle : handles)
+        {
+            benchmark::DoNotOptimize(resourceManager.GetTexture(handle));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * textureCount);
+}
+BENCHMARK(BM_TextureHandleResolve)->Arg(256)->Arg(16384);
+
+// A pass of draws sorted by pipeline and material, like RenderQueue::Execute() produces.
+static void RecordDraws(GfxCommandList &commandList, uint32_t begin, uint32_t end)
+{
+    GfxViewport viewport{ 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+    GfxScissor scissor{ 0, 0, 1920, 1080 };
+
+    for (uint32_t draw = begin; draw < end; ++draw)
+    {
+        commandList.BindPipeline(draw / 256);
+        commandList.BindDescriptorSet(0, 0);
+        commandList.BindDescriptorSet(1, draw / 16);
+        commandList.SetViewport(viewport);
+        commandList.SetScissor(scissor);
+        commandList.BindVertexBuffer(0, draw / 4);
+        commandList.BindIndexBuffer(draw / 4, 0, GfxIndexType::Uint32);
+        commandList.PushConstants(0, &draw, sizeof(draw));
+        commandList.DrawIndexed(36 + draw % 64, 1, 0, 0, draw);
+    }
+}
+
+static void BM_CommandListRecord(benchmark::State &state)
+{
+    uint32_t drawCount = static_cast<uint32_t>(state.range(0));
+
+    GfxCommandList commandList;
+    RecordDraws(commandList, 0, drawCount);
+
+    for (auto _ : state)
+    {
+        commandList.Reset();
+        RecordDraws(commandList, 0, drawCount);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * drawCount);
+    state.counters["BytesPerDraw"] = static_cast<double>(commandList.GetUsedBytes()) / drawCount;
+}
+BENCHMARK(BM_CommandListRecord)->Arg(10000)->Arg(100000);
+
+// One command list per batch of draws, recorded by the workers.
+static void BM_CommandListRecordParallel(benchmark::State &state)
+{
+    uint32_t drawCount = static_cast<uint32_t>(state.range(0));
+    uint32_t batchSize = 2048;
+    uint32_t listCount = (drawCount + batchSize - 1) / batchSize;
+
+    std::vector<std::unique_ptr<GfxCommandList>> commandLists;
+    for (uint32_t index = 0; index < listCount; ++index)
+    {
+        commandLists.push_back(std::make_unique<GfxCommandList>());
+    }
+
+    for (auto _ : state)
+    {
+        ParallelFor(*g_WorkerThreadPool, listCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t list = begin; list < end; ++list)
+            {
+                commandLists[list]->Reset();
+                RecordDraws(*commandLists[list], list * batchSize, std::min((list + 1) * batchSize, drawCount));
+            }
+        });
+    }
+
+    state.SetItemsProcessed(state.iterations() * drawCount);
+}
+BENCHMARK(BM_CommandListRecordParallel)->Arg(100000)->UseRealTime();
+
+// Stands in for a backend, to measure the decoding and state filtering alone.
+class CountingCommandVisitor
+{
+public:
+
+    bool BindPipeline(uint32_t pipeline) { m_Calls += pipeline; return true; }
+
+    void BindDescriptorSet(uint32_t slot, uint32_t set) { m_Calls += slot + set; }
+
+    void BindVertexBuffer(uint32_t binding, uint32_t buffer, uint32_t offset) { m_Calls += binding + buffer + offset; }
+
+    void BindIndexBuffer(uint32_t buffer, uint32_t offset, GfxIndexType) { m_Calls += buffer + offset; }
+
+    void SetViewport(const GfxViewport &) { ++m_Calls; }
+
+    void SetScissor(const GfxScissor &) { ++m_Calls; }
+
+    void PushConstants(uint32_t offset, const void *, uint32_t size) { m_Calls += offset + size; }
+
+    void Draw(const GfxDrawCommand &command) { m_Calls += command.vertexCount; }
+
+    void DrawIndexed(const GfxDrawIndexedCommand &command) { m_Calls += command.indexCount; }
+
+    void DrawIndexedIndirect(const GfxDrawIndexedIndirectCommand &command) { m_Calls += command.drawCount; }
+
+    void Dispatch(const GfxDispatchCommand &command) { m_Calls += command.groupCountX; }
+
+    uint64_t GetCalls() const { return m_Calls; }
+
+private:
+
+    uint64_t m_Calls{ 0 };
+};
+
+static void BM_CommandListReplay(benchmark::State &state)
+{
+    uint32_t drawCount = static_cast<uint32_t>(state.range(0));
+
+    GfxCommandList commandList;
+    RecordDraws(commandList, 0, drawCount);
+
+    GfxCommandReplayer replayer;
+    CountingCommandVisitor visitor;
+
+    for (auto _ : state)
+    {
+        replayer.Invalidate();
+        replayer.ResetStats();
+        replayer.Replay(commandList, visitor);
+        benchmark::DoNotOptimize(visitor.GetCalls());
+    }
+
+    state.SetItemsProcessed(state.iterations() * commandList.GetCommandCount());
+    state.counters["SkippedPercent"] = 100.0 * replayer.GetStats().skippedCount / replayer.GetStats().commandCount;
+}
+BENCHMARK(BM_CommandListReplay)->Arg(10000)->Arg(100000);
@@ -0,0 +1,77 @@
+// Benchmarks of the runtime's hot paths.
+//
+//   NextRenderBenchmarks [--vulkan] [--lavapipe] [Google Benchmark flags]
+//
+// --vulkan adds end-to-end benchmarks on a headless device, --lavapipe does the same on Mesa's
+// software driver, so frame benchmarks also run on GPU-less CI machines. Results for regression
+// tracking are written with --benchmark_out=<file> --benchmark_out_format=json.
+
+#include "VulkanBenchmarks.h"
+#include "Thread/ThreadPool.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include <benchmark/benchmark.h>
+
+#if !defined(_WIN32)
+// Where Debian, Ubuntu and Fedora install the lavapipe ICD manifest.
+static const char *g_LavapipeIcd = "/usr/share/vulkan/icd.d/lvp_icd.x86_64.json";
+#endif
+
+int main(int argc, char **argv)
+{
+    bool vulkan = false;
+    bool lavapipe = false;
+
+    std::vector<char *> arguments;
+    for (int index = 0; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--vulkan") == 0)
+        {
+            vulkan = true;
+        }
+        else if (strcmp(argv[index], "--lavapipe") == 0)
+        {
+            vulkan = true;
+            lavapipe = true;
+        }
+        else
+        {
+            arguments.push_back(argv[index]);
+        }
+    }
+
+    if (lavapipe)
+    {
+#if !defined(_WIN32)
+        // An explicit driver choice in the environment wins.
+        setenv("VK_DRIVER_FILES", g_LavapipeIcd, 0);
+        setenv("VK_ICD_FILENAMES", g_LavapipeIcd, 0);
+#endif
+    }
+
+    int argumentCount = static_cast<int>(arguments.size());
+    benchmark::Initialize(&argumentCount, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(argumentCount, arguments.data()))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Importer and device messages would interleave with the results.
+    spdlog::set_level(spdlog::level::warn);
+
+    g_WorkerThreadPool->Create(0, 0);
+
+    if (vulkan)
+    {
+        RegisterVulkanBenchmarks();
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    ReleaseVulkanBenchmarks();
+    g_WorkerThreadPool->Destory();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include "BenchmarkData.h"
+#include "Render/GpuScene.h"
+#include "Render/LightClusters.h"
+#include "Render/LodSelector.h"
+#include "Render/Mesh.h"
+#include "Render/RenderQueue.h"
+#include "Render/ShadowCache.h"
+#include "Thread/ThreadPool.h"
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include <benchmark/benchmark.h>
+
+static GpuCullParams GetCullParams()
+{
+    glm::vec3 cameraPosition{ 0.0f, 10.0f, -200.0f };
+    glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+    glm::mat4 projection = glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    return GpuCullParams::FromView(projection * view, cameraPosition, LodSelectionParams{});
+}
+
+// CPU reference of the GPU driven cull: frustum test, LOD selection and draw compaction per instance.
+static void BM_GpuSceneCull(benchmark::State &state)
+{
+    uint32_t objectCount = static_cast<uint32_t>(state.range(0));
+
+    std::unique_ptr<Mesh> mesh = BenchmarkData::CreateGridMesh(8);
+    GpuScene scene;
+    BenchmarkData::CreateGpuScene(scene, *mesh, objectCount);
+
+    GpuCullParams params = GetCullParams();
+    std::vector<DrawIndexedIndirectCommand> draws;
+    std::vector<uint32_t> drawCounts;
+    GpuCullStats stats{};
+
+    for (auto _ : state)
+    {
+        GpuSceneCuller::Cull(scene, params, draws, drawCounts, &stats);
+        benchmark::DoNotOptimize(draws.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * objectCount);
+    state.counters["visible"] = stats.visibleCount;
+}
+BENCHMARK(BM_GpuSceneCull)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 18);
+
+// Submit, sort and batch of a frame's draws.
+static void BM_RenderQueueSort(benchmark::State &state)
+{
+    uint32_t drawCount = static_cast<uint32_t>(state.range(0));
+
+    std::mt19937 random{ 3 };
+    std::vector<DrawItem> items(drawCount);
+    for (DrawItem &item : items)
+    {
+        uint32_t bits = random();
+        item.pass = (bits & 7) == 0 ? TransparentPass : OpaquePass;
+        item.pipelineIndex = static_cast<uint16_t>((bits >> 3) % 32);
+        item.materialIndex = (bits >> 8) % 512;
+        item.meshIndex = random() % 256;
+        item.depth = static_cast<float>(random() % 100000) * 0.01f;
+        item.objectId = static_cast<uint32_t>(&item - items.data());
+    }
+
+    RenderQueue queue;
+    for (auto _ : state)
+    {
+        queue.Reset(drawCount, 1000.0f);
+        for (const DrawItem &item : items)
+        {
+            queue.Submit(item);
+        }
+        queue.Sort(*g_WorkerThreadPool);
+        queue.BuildBatches();
+        benchmark::DoNotOptimize(queue.GetBatches().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * drawCount);
+    state.counters["batches"] = queue.GetStats().batchCount;
+}
+BENCHMARK(BM_RenderQueueSort)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17)->UseRealTime();
+
+// Binning of point and spot lights into the default 16x9x24 cluster grid.
+static void BM_LightClusterBuild(benchmark::State &state)
+{
+    uint32_t lightCount = static_cast<uint32_t>(state.range(0));
+
+    std::mt19937 random{ 7 };
+    std::vector<GpuLight> lights(lightCount);
+    for (GpuLight &light : lights)
+    {
+        light.position = glm::vec3{ static_cast<float>(random() % 1000) - 500.0f, static_cast<float>(random() % 20), static_cast<float>(random() % 1000) - 500.0f };
+        light.range = 2.0f + static_cast<float>(random() % 100) * 0.1f;
+        if ((random() & 1) != 0)
+        {
+            light.direction = glm::normalize(glm::vec3{ 0.3f, -1.0f, 0.2f });
+            light.spotCosAngle = 0.8f;
+        }
+    }
+
+    glm::vec3 cameraPosition{ 0.0f, 10.0f, -200.0f };
+    glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+
+    LightClusterGrid grid{};
+    LightClusterBuilder builder;
+    builder.SetView(grid, glm::perspective(1.0f, 16.0f / 9.0f, grid.nearPlane, grid.farPlane));
+
+    for (auto _ : state)
+    {
+        builder.Build(*g_WorkerThreadPool, lights.data(), lightCount, view);
+        benchmark::DoNotOptimize(builder.GetLightIndices().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * lightCount);
+    state.counters["indices"] = builder.GetStats().indexCount;
+    state.counters["maxPerCluster"] = builder.GetStats().maxClusterLights;
+}
+BENCHMARK(BM_LightClusterBuild)->Arg(1 << 10)->Arg(5000)->Arg(1 << 14)->UseRealTime();
+
+// Shadow planning for a camera walking through lights: cascade fitting, atlas bookkeeping and the
+// frustum tests that decide which tiles are redrawn.
+static void BM_ShadowCacheUpdate(benchmark::State &state)
+{
+    uint32_t lightCount = static_cast<uint32_t>(state.range(0));
+
+    std::mt19937 random{ 7 };
+    std::vector<ShadowLightRequest> lights(lightCount);
+    for (uint32_t index = 0; index < lightCount; ++index)
+    {
+        ShadowLightRequest &request = lights[index];
+        request.id = index;
+        request.resolution = 128u << (random() % 3);
+        request.light.position = glm::vec3{ static_cast<float>(random() % 200) - 100.0f, 5.0f, static_cast<float>(random() % 200) - 100.0f };
+        request.light.range = 10.0f;
+        if ((random() & 1) != 0)
+        {
+            request.light.direction = glm::vec3{ 0.0f, -1.0f, 0.0f };
+            request.light.spotCosAngle = 0.8f;
+        }
+    }
+
+    std::vector<BoundingBox> dynamicCasters(64);
+    for (BoundingBox &bounds : dynamicCasters)
+    {
+        bounds.min = glm::vec3{ static_cast<float>(random() % 200) - 100.0f, 0.0f, static_cast<float>(random() % 200) - 100.0f };
+        bounds.max = bounds.min + glm::vec3{ 1.0f, 2.0f, 1.0f };
+    }
+
+    ShadowCache cache;
+    glm::mat4 projection = glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    glm::vec3 lightDirection = glm::normalize(glm::vec3{ 0.3f, -1.0f, 0.2f });
+
+    uint32_t frame = 0;
+    for (auto _ : state)
+    {
+        glm::vec3 cameraPosition{ static_cast<float>(frame % 1000) * 0.05f, 2.0f, 0.0f };
+        glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+        cache.Update(view, projection, 0.1f, 1000.0f, lightDirection, lights.data(), lightCount, dynamicCasters.data(), static_cast<uint32_t>(dynamicCasters.size()));
+        benchmark::DoNotOptimize(cache.GetViews().data());
+        ++frame;
+    }
+
+    state.SetItemsProcessed(state.iterations() * lightCount);
+    state.counters["views"] = cache.GetStats().viewCount;
+    state.counters["refreshed"] = cache.GetStats().refreshCount;
+    state.counters["dropped"] = cache.GetStats().droppedLightCount;
+}
+BENCHMARK(BM_ShadowCacheUpdate)->Arg(16)->Arg(64)->Arg(256);
@@ -0,0 +1,46 @@
+#include "BenchmarkData.h"
+#include "Scene/GltfImporter.h"
+#include "Scene/Scene.h"
+#include "Thread/ThreadPool.h"
+#include <benchmark/benchmark.h>
+
+static void BM_UpdateTransforms(benchmark::State &state)
+{
+    uint32_t objectCount = static_cast<uint32_t>(state.range(0));
+
+    Scene scene;
+    BenchmarkData::CreateHierarchy(scene, objectCount, 8);
+
+    for (auto _ : state)
+    {
+        scene.UpdateTransforms();
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_UpdateTransforms)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+// Parse, decode and scene construction of a .gltf, with the files in the page cache after the first run.
+static void BM_ImportGltf(benchmark::State &state)
+{
+    std::string path = BenchmarkData::WriteGltfScene(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+
+    GltfImporter importer{ *g_WorkerThreadPool };
+    GltfImportStats stats{};
+
+    for (auto _ : state)
+    {
+        Scene scene;
+        if (!importer.Import(path, scene, &stats))
+        {
+            state.SkipWithError("Import failed");
+            break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(stats.bytes));
+    state.counters["meshes"] = stats.meshCount;
+    state.counters["vertices"] = static_cast<double>(stats.vertexCount);
+}
+BENCHMARK(BM_ImportGltf)->Args({ 64, 64 })->Args({ 1024, 16 })->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,60 @@
+#include "Thread/ParallelFor.h"
+#include "Thread/ThreadPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+// Round trip of jobs that do nothing: queueing, waking workers and signalling completion.
+static void BM_DispatchThreadJob(benchmark::State &state)
+{
+    uint32_t jobCount = static_cast<uint32_t>(state.range(0));
+
+    std::atomic<uint32_t> remaining{ 0 };
+    std::mutex mutex;
+    std::condition_variable doneEvent;
+
+    for (auto _ : state)
+    {
+        remaining.store(jobCount, std::memory_order_relaxed);
+        for (uint32_t job = 0; job < jobCount; ++job)
+        {
+            g_WorkerThreadPool->DispatchThreadJob([&]()
+            {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard lock(mutex);
+                    doneEvent.notify_one();
+                }
+            }, "Benchmark");
+        }
+
+        std::unique_lock lock(mutex);
+        doneEvent.wait(lock, [&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    state.SetItemsProcessed(state.iterations() * jobCount);
+}
+BENCHMARK(BM_DispatchThreadJob)->Arg(16)->Arg(256)->Arg(4096)->UseRealTime();
+
+static void BM_ParallelFor(benchmark::State &state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    std::vector<float> values(count, 1.0f);
+
+    for (auto _ : state)
+    {
+        ParallelFor(*g_WorkerThreadPool, count, 4096, [&values](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t index = begin; index < end; ++index)
+            {
+                values[index] = values[index] * 0.999f + 1.0f;
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ParallelFor)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20)->UseRealTime();
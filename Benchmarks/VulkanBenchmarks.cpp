@@ -0,0 +1,158 @@
+#include "VulkanBenchmarks.h"
+#include "Gfx/Vulkan/VulkanDevice.h"
+#include "Gfx/Vulkan/VulkanGfx.h"
+#include "Gfx/Vulkan/VulkanImage.h"
+#include "Gfx/Vulkan/VulkanOffscreenRenderer.h"
+#include "Gfx/Vulkan/VulkanRenderPassCache.h"
+#include "Gfx/Vulkan/VulkanUtils.h"
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+static std::unique_ptr<VulkanGfx> g_BenchmarkGfx;
+
+// Sets of a typical material layout, allocated one at a time and released with a pool reset.
+static void BM_AllocateDescriptorSets(benchmark::State &state)
+{
+    VkDevice device = g_BenchmarkGfx->GetDevice().GetHandle();
+    uint32_t setCount = static_cast<uint32_t>(state.range(0));
+
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[1].descriptorCount = 4;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+
+    VkDescriptorSetLayout layout{ VK_NULL_HANDLE };
+    VK_CHECK(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout));
+
+    VkDescriptorPoolSize poolSizes[2]{ { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount }, { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount * 4 } };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = setCount;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+
+    VkDescriptorPool pool{ VK_NULL_HANDLE };
+    VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool));
+
+    VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocateInfo.descriptorPool = pool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &layout;
+
+    std::vector<VkDescriptorSet> sets(setCount);
+
+    for (auto _ : state)
+    {
+        for (VkDescriptorSet &set : sets)
+        {
+            VK_CHECK(vkAllocateDescriptorSets(device, &allocateInfo, &set));
+        }
+        VK_CHECK(vkResetDescriptorPool(device, pool, 0));
+    }
+
+    vkDestroyDescriptorPool(device, pool, nullptr);
+    vkDestroyDescriptorSetLayout(device, layout, nullptr);
+
+    state.SetItemsProcessed(state.iterations() * setCount);
+}
+
+// Whole frames through the offscreen renderer: record, submit, render a clear and read it back.
+static void BM_OffscreenFrame(benchmark::State &state)
+{
+    VulkanOffscreenRenderer &renderer = g_BenchmarkGfx->GetOffscreenRenderer();
+
+    uint64_t readbackCount = 0;
+
+    OffscreenRenderJob job{};
+    job.width = static_cast<uint32_t>(state.range(0));
+    job.height = static_cast<uint32_t>(state.range(0));
+    job.clearColor = { { 0.2f, 0.3f, 0.4f, 1.0f } };
+    job.onReadback = [&readbackCount](const OffscreenReadback &readback)
+    {
+        benchmark::DoNotOptimize(readback.pixels[0]);
+        ++readbackCount;
+    };
+
+    for (auto _ : state)
+    {
+        g_BenchmarkGfx->BeginFrame();
+        renderer.Submit(job);
+        g_BenchmarkGfx->EndFrame();
+    }
+    renderer.Flush();
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["readbacks"] = static_cast<double>(readbackCount);
+}
+
+// Framebuffer of a color plus depth pass, created and destroyed every time or found in the cache.
+static void BM_RenderPassFramebuffer(benchmark::State &state)
+{
+    bool cached = state.range(0) != 0;
+
+    VulkanDevice &device = g_BenchmarkGfx->GetDevice();
+    VkExtent2D extent{ 1280, 720 };
+    VulkanImage color{ device, extent, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT };
+    VulkanImage depth{ device, extent, VK_FORMAT_D32_SFLOAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT };
+
+    VulkanRenderingDesc desc{};
+    desc.extent = extent;
+    desc.colorCount = 1;
+    desc.colors[0].view = color.GetView();
+    desc.colors[0].format = color.GetFormat();
+    desc.depth.view = depth.GetView();
+    desc.depth.format = depth.GetFormat();
+
+    VulkanRenderPassCache cache{ device, false };
+    VkRenderPass renderPass = cache.GetRenderPass(VulkanRenderPassKey::Make(desc));
+
+    for (auto _ : state)
+    {
+        if (cached)
+        {
+            benchmark::DoNotOptimize(cache.GetFramebuffer(renderPass, desc));
+        }
+        else
+        {
+            VkImageView views[2]{ color.GetView(), depth.GetView() };
+
+            VkFramebufferCreateInfo framebufferInfo{ VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = 2;
+            framebufferInfo.pAttachments = views;
+            framebufferInfo.width = extent.width;
+            framebufferInfo.height = extent.height;
+            framebufferInfo.layers = 1;
+
+            VkFramebuffer framebuffer{ VK_NULL_HANDLE };
+            VK_CHECK(vkCreateFramebuffer(device.GetHandle(), &framebufferInfo, nullptr, &framebuffer));
+            vkDestroyFramebuffer(device.GetHandle(), framebuffer, nullptr);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void RegisterVulkanBenchmarks()
+{
+    g_BenchmarkGfx = std::make_unique<VulkanGfx>("NextRenderBenchmarks", std::unordered_map<const char *, bool>{}, std::vector<const char *>{}, true);
+
+    benchmark::RegisterBenchmark("BM_AllocateDescriptorSets", BM_AllocateDescriptorSets)->Arg(64)->Arg(1024);
+    benchmark::RegisterBenchmark("BM_RenderPassFramebuffer", BM_RenderPassFramebuffer)->Arg(0)->Arg(1);
+    benchmark::RegisterBenchmark("BM_OffscreenFrame", BM_OffscreenFrame)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+void ReleaseVulkanBenchmarks()
+{
+    g_BenchmarkGfx.reset();
+}
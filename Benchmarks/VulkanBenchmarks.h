@@ -0,0 +1,6 @@
+#pragma once
+
+// End-to-end benchmarks on a headless VulkanGfx, only registered when a Vulkan driver is asked for.
+void RegisterVulkanBenchmarks();
+
+void ReleaseVulkanBenchmarks();
@@ -0,0 +1,64 @@
+#include "AllocationCounter.h"
+#include "Memory/Memory.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every operator new of the process, worker threads included.
+static std::atomic<uint64_t> g_AllocationCount{ 0 };
+
+static void *CountedAllocate(size_t size)
+{
+    g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+static void *CountedAllocateAligned(size_t size, std::align_val_t alignment)
+{
+    g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+#if defined(_WIN32)
+    void *memory = _aligned_malloc(size > 0 ? size : 1, align);
+#else
+    void *memory = std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+    if (memory != nullptr)
+    {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+static void FreeAligned(void *memory)
+{
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void *operator new(size_t size) { return CountedAllocate(size); }
+void *operator new[](size_t size) { return CountedAllocate(size); }
+void *operator new(size_t size, std::align_val_t alignment) { return CountedAllocateAligned(size, alignment); }
+void *operator new[](size_t size, std::align_val_t alignment) { return CountedAllocateAligned(size, alignment); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void *memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+
+namespace AllocationCounter
+{
+    uint64_t GetCount()
+    {
+        return g_AllocationCount.load(std::memory_order_relaxed) + Memory::GetHeapAllocationCount();
+    }
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+// Linking AllocationCounter.cpp replaces the global operator new and delete of the executable with
+// counting versions.
+namespace AllocationCounter
+{
+    // operator new calls plus heap allocations of the engine allocators, worker threads included.
+    uint64_t GetCount();
+}
@@ -0,0 +1,375 @@
+// Asset streamer test. Streams files written to a temporary directory, once through io_uring when the
+// build and kernel have it and once through the pread() fallback. Fails when queued assets are read
+// out of priority and distance order, when a cancelled asset still arrives or keeps bytes in flight,
+// when the streamer starts a read past its in-flight byte budget, when data or its decompression comes
+// back wrong, or when decompression jobs the worker pool abandons keep the streamer from shutting down.
+// Needs no GPU.
+//
+//   NextRenderAssetStreaming [--assets <count>]
+
+#include "Common/Logging.h"
+#include "Streaming/AssetStreamer.h"
+#include "Thread/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+static constexpr uint64_t g_AssetSize = 64 << 10;
+
+static constexpr uint32_t g_BudgetAssets = 4;
+
+static std::vector<uint8_t> GetContent(uint32_t asset)
+{
+    std::vector<uint8_t> content(g_AssetSize);
+    for (uint64_t index = 0; index < content.size(); ++index)
+    {
+        content[index] = static_cast<uint8_t>(asset * 131 + index * 7 + (index >> 8));
+    }
+    return content;
+}
+
+// Stands in for a real codec, the payload comes back reversed.
+static bool Reverse(const std::vector<uint8_t> &compressed, std::vector<uint8_t> &decompressed)
+{
+    decompressed.assign(compressed.rbegin(), compressed.rend());
+    return true;
+}
+
+static bool WaitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+    }
+    return true;
+}
+
+static bool PumpUntilIdle(AssetStreamer &streamer)
+{
+    return WaitFor([&streamer]()
+    {
+        streamer.PumpUploads();
+        return streamer.IsIdle();
+    });
+}
+
+static uint32_t CountState(const AssetStreamer &streamer, const std::vector<StreamRequestId> &requests, StreamState state)
+{
+    return static_cast<uint32_t>(std::count_if(requests.begin(), requests.end(), [&](StreamRequestId id) { return streamer.GetState(id) == state; }));
+}
+
+// A budget of one byte lets a single read through at a time, so arrival order is read order. The first
+// asset is held back from the upload path, which keeps the rest queued until their priorities settle.
+static bool TestPriorityOrder(const char *backend, const std::vector<std::string> &paths, bool useIoUring)
+{
+    AssetStreamer streamer{ *g_WorkerThreadPool, 1, 8, useIoUring };
+
+    uint32_t assetCount = static_cast<uint32_t>(paths.size());
+    std::vector<uint32_t> arrived;
+    bool intact = true;
+
+    auto request = [&](uint32_t asset, StreamPriority priority, float distance)
+    {
+        StreamRequestDesc desc{};
+        desc.path = paths[asset];
+        desc.priority = priority;
+        desc.distance = distance;
+        desc.onComplete = [&arrived, &intact, asset](StreamedAsset &streamed)
+        {
+            arrived.push_back(asset);
+            intact = intact && streamed.succeeded && streamed.data == GetContent(asset);
+        };
+        return streamer.Request(std::move(desc));
+    };
+
+    StreamRequestId blocker = request(0, StreamPriority::Low, 0.0f);
+    if (!WaitFor([&]() { return streamer.GetState(blocker) == StreamState::ReadyForUpload; }))
+    {
+        LOGE("{}: the first asset never became ready", backend);
+        return false;
+    }
+
+    std::mt19937 random{ 23 };
+
+    // Distinct distances, so the order is fully determined.
+    std::vector<float> distances(assetCount);
+    for (uint32_t asset = 0; asset < assetCount; ++asset)
+    {
+        distances[asset] = static_cast<float>(asset);
+    }
+    std::shuffle(distances.begin(), distances.end(), random);
+
+    std::vector<StreamPriority> priorities(assetCount);
+    std::vector<StreamRequestId> requests(assetCount, InvalidStreamRequestId);
+    for (uint32_t asset = 1; asset < assetCount; ++asset)
+    {
+        priorities[asset] = static_cast<StreamPriority>(random() % 4);
+        requests[asset] = request(asset, priorities[asset], distances[asset]);
+    }
+
+    std::vector<std::tuple<StreamPriority, float, uint32_t>> expected;
+    uint32_t cancelledCount = 0;
+
+    for (uint32_t asset = 1; asset < assetCount; ++asset)
+    {
+        if (asset % 5 == 0)
+        {
+            // Cancelling twice reports that nothing was left to cancel.
+            if (!streamer.Cancel(requests[asset]) || streamer.GetState(requests[asset]) != StreamState::Retired || streamer.Cancel(requests[asset]))
+            {
+                LOGE("{}: cancelling queued asset {} failed", backend, asset);
+                return false;
+            }
+            ++cancelledCount;
+            continue;
+        }
+
+        // Every third asset moves, the way SceneLoader follows the camera.
+        if (asset % 3 == 0)
+        {
+            priorities[asset] = static_cast<StreamPriority>(random() % 4);
+            distances[asset] += 0.5f;
+            streamer.UpdatePriority(requests[asset], priorities[asset], distances[asset]);
+        }
+        expected.emplace_back(priorities[asset], distances[asset], asset);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    // Nothing past the held back asset fits the budget.
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+    uint32_t queuedCount = CountState(streamer, requests, StreamState::Queued);
+    if (queuedCount != expected.size())
+    {
+        LOGE("{}: {} of {} assets are still queued behind a full budget", backend, queuedCount, expected.size());
+        return false;
+    }
+
+    if (!PumpUntilIdle(streamer))
+    {
+        LOGE("{}: the streamer didn't finish", backend);
+        return false;
+    }
+
+    std::vector<uint32_t> expectedOrder{ 0 };
+    for (const auto &entry : expected)
+    {
+        expectedOrder.push_back(std::get<2>(entry));
+    }
+
+    if (arrived != expectedOrder)
+    {
+        for (size_t index = 0; index < std::min(arrived.size(), expectedOrder.size()); ++index)
+        {
+            if (arrived[index] != expectedOrder[index])
+            {
+                LOGE("{}: asset {} arrived in place {}, expected asset {}", backend, arrived[index], index, expectedOrder[index]);
+                break;
+            }
+        }
+        LOGE("{}: {} assets arrived, expected {}", backend, arrived.size(), expectedOrder.size());
+        return false;
+    }
+
+    StreamingStats stats = streamer.GetStats();
+    if (!intact || stats.completedCount != expectedOrder.size() || stats.cancelledCount != cancelledCount || stats.failedCount != 0 ||
+        stats.inFlightBytes != 0 || stats.peakInFlightBytes != g_AssetSize)
+    {
+        LOGE("{}: {} completed, {} cancelled, {} failed, {} bytes left in flight, {} at peak", backend, stats.completedCount, stats.cancelledCount,
+            stats.failedCount, stats.inFlightBytes, stats.peakInFlightBytes);
+        return false;
+    }
+
+    LOGI("{}: {} assets in priority order, {} cancelled", backend, arrived.size(), cancelledCount);
+    return true;
+}
+
+// Assets stay in flight until they are pumped, so with nothing pumped the streamer stops at the budget.
+static bool TestBudget(const char *backend, const std::vector<std::string> &paths, bool useIoUring)
+{
+    uint64_t budget = g_BudgetAssets * g_AssetSize;
+    AssetStreamer streamer{ *g_WorkerThreadPool, budget, 8, useIoUring };
+
+    uint32_t assetCount = static_cast<uint32_t>(paths.size());
+    uint32_t arrivedCount = 0;
+    bool intact = true;
+
+    std::vector<StreamRequestId> requests;
+    for (uint32_t asset = 0; asset < assetCount; ++asset)
+    {
+        StreamRequestDesc desc{};
+        desc.path = paths[asset];
+        desc.distance = static_cast<float>(asset);
+        desc.decompress = Reverse;
+        desc.onComplete = [&arrivedCount, &intact, asset](StreamedAsset &streamed)
+        {
+            std::vector<uint8_t> content = GetContent(asset);
+            std::reverse(content.begin(), content.end());
+
+            ++arrivedCount;
+            intact = intact && streamed.succeeded && streamed.data == content;
+        };
+        requests.push_back(streamer.Request(std::move(desc)));
+    }
+
+    if (!WaitFor([&]() { return CountState(streamer, requests, StreamState::ReadyForUpload) == g_BudgetAssets; }))
+    {
+        LOGE("{}: {} assets became ready, the budget holds {}", backend, CountState(streamer, requests, StreamState::ReadyForUpload), g_BudgetAssets);
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+    StreamingStats stats = streamer.GetStats();
+    if (CountState(streamer, requests, StreamState::ReadyForUpload) != g_BudgetAssets || stats.inFlightBytes != budget)
+    {
+        LOGE("{}: {} assets ready with {} bytes in flight, the budget is {} bytes", backend, CountState(streamer, requests, StreamState::ReadyForUpload),
+            stats.inFlightBytes, budget);
+        return false;
+    }
+
+    // Cancelling a ready asset hands its bytes back, the next one takes its place.
+    StreamRequestId cancelled = requests[0];
+    if (streamer.GetState(cancelled) != StreamState::ReadyForUpload || !streamer.Cancel(cancelled) ||
+        !WaitFor([&]() { return CountState(streamer, requests, StreamState::ReadyForUpload) == g_BudgetAssets; }))
+    {
+        LOGE("{}: cancelling a ready asset didn't free its budget", backend);
+        return false;
+    }
+
+    if (!PumpUntilIdle(streamer))
+    {
+        LOGE("{}: the streamer didn't finish", backend);
+        return false;
+    }
+
+    stats = streamer.GetStats();
+    if (!intact || arrivedCount != assetCount - 1 || stats.cancelledCount != 1 || stats.peakInFlightBytes > budget || stats.inFlightBytes != 0 ||
+        stats.bytesDecompressed != g_AssetSize * assetCount)
+    {
+        LOGE("{}: {} of {} assets arrived {}, {} bytes at peak of a {} byte budget", backend, arrivedCount, assetCount - 1, intact ? "intact" : "damaged",
+            stats.peakInFlightBytes, budget);
+        return false;
+    }
+
+    LOGI("{}: {} assets within a {} KiB budget, {} KiB at peak", backend, arrivedCount, budget >> 10, stats.peakInFlightBytes >> 10);
+    return true;
+}
+
+// A single worker with slow decompression, shut down while most jobs still wait. The abandoned assets
+// arrive as failed and the streamer's destructor returns.
+static bool TestAbandonedDecompression(const std::vector<std::string> &paths)
+{
+    uint32_t assetCount = static_cast<uint32_t>(paths.size());
+
+    WorkerThreadPool pool;
+    pool.Create(1, 0);
+
+    AssetStreamer streamer{ pool };
+
+    uint32_t succeededCount = 0;
+    uint32_t failedCount = 0;
+    for (uint32_t asset = 0; asset < assetCount; ++asset)
+    {
+        StreamRequestDesc desc{};
+        desc.path = paths[asset];
+        desc.decompress = [](const std::vector<uint8_t> &compressed, std::vector<uint8_t> &decompressed)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+            return Reverse(compressed, decompressed);
+        };
+        desc.onComplete = [&succeededCount, &failedCount](StreamedAsset &streamed)
+        {
+            ++(streamed.succeeded ? succeededCount : failedCount);
+        };
+        streamer.Request(std::move(desc));
+    }
+
+    if (!WaitFor([&]() { return streamer.GetStats().bytesRead == g_AssetSize * assetCount; }))
+    {
+        LOGE("Abandon: the assets were never read");
+        return false;
+    }
+
+    pool.Destory();
+
+    if (!PumpUntilIdle(streamer))
+    {
+        LOGE("Abandon: abandoned decompressions never came back");
+        return false;
+    }
+
+    if (succeededCount + failedCount != assetCount || failedCount == 0)
+    {
+        LOGE("Abandon: {} assets decompressed and {} failed out of {}", succeededCount, failedCount, assetCount);
+        return false;
+    }
+
+    LOGI("Abandon: {} assets decompressed before the pool shut down, {} failed", succeededCount, failedCount);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t assetCount = 32;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--assets") == 0 && index + 1 < argc)
+        {
+            assetCount = std::max(static_cast<uint32_t>(std::stoul(argv[++index])), g_BudgetAssets + 2);
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "NextRenderAssetStreaming";
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::string> paths;
+    for (uint32_t asset = 0; asset < assetCount; ++asset)
+    {
+        paths.push_back((directory / ("Asset" + std::to_string(asset) + ".bin")).string());
+
+        std::vector<uint8_t> content = GetContent(asset);
+        std::ofstream file{ paths.back(), std::ios::binary };
+        file.write(reinterpret_cast<const char *>(content.data()), content.size());
+        if (!file)
+        {
+            LOGE("Failed to write {}", paths.back());
+            return EXIT_FAILURE;
+        }
+    }
+
+    g_WorkerThreadPool->Create(0, 0);
+
+    bool passed = true;
+    for (bool useIoUring : { true, false })
+    {
+        const char *backend = useIoUring ? "Default" : "pread";
+        passed = passed && TestPriorityOrder(backend, paths, useIoUring) && TestBudget(backend, paths, useIoUring);
+    }
+    passed = passed && TestAbandonedDecompression(paths);
+
+    g_WorkerThreadPool->Destory();
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
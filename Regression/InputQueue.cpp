@@ -0,0 +1,195 @@
+// Input queue test. A producer thread pushes numbered events into an InputEventQueue while another
+// thread drains it, first directly and then through the FrameLoop's simulation thread feeding
+// Application::ProcessInput(). Fails when an event arrives out of order or twice, when received and
+// dropped events don't add up to the pushed ones, or when the frame loop reports no input latency.
+// Needs no GPU.
+//
+//   NextRenderInputQueue [--events <count>]
+
+#include "Application.h"
+#include "Common/Logging.h"
+#include "InputEvents.h"
+#include "Platform/FrameLoop.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Floats hold integers exactly up to 2^24, the sequence number is split over both coordinates.
+static void PushNumbered(InputEventQueue &queue, uint32_t number)
+{
+    queue.PushMouseMove(static_cast<float>(number & 0xFFFF), static_cast<float>(number >> 16));
+}
+
+static uint32_t GetNumber(const InputEventRecord &event)
+{
+    return static_cast<uint32_t>(event.x) | static_cast<uint32_t>(event.y) << 16;
+}
+
+// Checks that numbers only grow, gaps are events the full ring dropped.
+class SequenceChecker
+{
+public:
+
+    bool Add(const InputEventRecord *events, uint32_t count)
+    {
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            uint32_t number = GetNumber(events[index]);
+            if (events[index].type != InputEventType::MouseMove || (m_Count > 0 && number <= m_Last))
+            {
+                LOGE("Event {} arrived after event {}", number, m_Last);
+                m_Ordered = false;
+            }
+            m_Last = number;
+            ++m_Count;
+        }
+        m_Received.store(m_Count, std::memory_order_release);
+        return m_Ordered;
+    }
+
+    bool IsOrdered() const { return m_Ordered; }
+
+    uint64_t GetReceived() const { return m_Received.load(std::memory_order_acquire); }
+
+private:
+
+    uint32_t m_Last{ 0 };
+
+    uint64_t m_Count{ 0 };
+
+    std::atomic<uint64_t> m_Received{ 0 };
+
+    bool m_Ordered{ true };
+};
+
+class InputApplication : public Application
+{
+public:
+
+    void ProcessInput(const InputEventRecord *events, uint32_t count) override
+    {
+        m_Checker.Add(events, count);
+    }
+
+    SequenceChecker m_Checker;
+};
+
+static bool CheckTotals(const char *pass, uint64_t pushed, uint64_t received, const InputLatencyStats &stats)
+{
+    if (received + stats.droppedCount != pushed || stats.eventCount != received)
+    {
+        LOGE("{}: {} events pushed, {} received, {} dropped, the queue counted {}", pass, pushed, received, stats.droppedCount, stats.eventCount);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t eventCount = 200000;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--events") == 0 && index + 1 < argc)
+        {
+            eventCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // As fast as both threads go, the ring overflows whenever the consumer falls behind.
+    {
+        InputEventQueue queue;
+        SequenceChecker checker;
+        std::atomic<bool> producing{ true };
+
+        std::thread producer{ [&queue, &producing, eventCount]()
+        {
+            for (uint32_t number = 0; number < eventCount; ++number)
+            {
+                PushNumbered(queue, number);
+            }
+            producing.store(false, std::memory_order_release);
+        } };
+
+        std::vector<InputEventRecord> events(InputEventQueue::Capacity);
+        bool done = false;
+        while (!done)
+        {
+            // Once the producer is done, one more drain empties the ring.
+            done = !producing.load(std::memory_order_acquire);
+            uint32_t count = queue.Drain(events.data(), static_cast<uint32_t>(events.size()));
+            checker.Add(events.data(), count);
+            queue.RecordFrame();
+        }
+        producer.join();
+
+        InputLatencyStats stats = queue.GetStats();
+        if (!checker.IsOrdered() || !CheckTotals("Direct", eventCount, checker.GetReceived(), stats))
+        {
+            return EXIT_FAILURE;
+        }
+        LOGI("Direct: {} of {} events received, {} dropped, {:.3f} ms average latency", checker.GetReceived(), eventCount, stats.droppedCount,
+            stats.averageLatency * 1000.0);
+    }
+
+    // Paced below what 240 steps per second drain, so the frame loop keeps up.
+    {
+        InputEventQueue queue;
+        InputApplication application;
+
+        FrameLoopDesc desc{};
+        desc.fixedTimestep = 1.0 / 240.0;
+        desc.targetFrameRate = 60.0;
+
+        FrameLoop loop;
+        loop.Start(application, desc, &queue);
+
+        uint32_t pacedCount = std::min(eventCount, 20000u);
+        for (uint32_t number = 0; number < pacedCount; ++number)
+        {
+            PushNumbered(queue, number);
+            if (number % 100 == 99)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+            }
+        }
+
+        // The simulation thread picks up the rest within a few steps.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+        while (application.m_Checker.GetReceived() + queue.GetStats().droppedCount < pacedCount && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+        }
+
+        // One more step publishes the stats of the last drain.
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+        loop.Stop();
+
+        FrameLoopStats stats = loop.GetStats();
+        if (!application.m_Checker.IsOrdered() || !CheckTotals("Frame loop", pacedCount, application.m_Checker.GetReceived(), stats.input))
+        {
+            return EXIT_FAILURE;
+        }
+
+        if (stats.input.averageLatency <= 0.0 || stats.input.maxLatency < stats.input.averageLatency)
+        {
+            LOGE("Frame loop: latency of {:.3f} ms average, {:.3f} ms max", stats.input.averageLatency * 1000.0, stats.input.maxLatency * 1000.0);
+            return EXIT_FAILURE;
+        }
+
+        LOGI("Frame loop: {} events over {} steps, {} dropped, {:.3f} ms average and {:.3f} ms max latency", stats.input.eventCount, stats.stepCount,
+            stats.input.droppedCount, stats.input.averageLatency * 1000.0, stats.input.maxLatency * 1000.0);
+    }
+
+    return EXIT_SUCCESS;
+}
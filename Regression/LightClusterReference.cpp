@@ -0,0 +1,218 @@
+// Light clustering reference test. Bins 5000 point and spot lights with LightClusterBuilder, through
+// SSE2 where the build has it and through the scalar path, and compares both cluster for cluster with
+// a brute-force pass testing every light against every cluster. Fails when a cluster's light set
+// differs from the reference, or when the builder drops a light reference the limits had room for.
+// Lights within a rounding error of a cluster's boundary may fall either way. Needs no GPU.
+//
+//   NextRenderLightClusterReference [--lights <count>]
+
+#include "Common/Logging.h"
+#include "Render/LightClusters.h"
+#include "Thread/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Relative change of a light's range that counts as rounding when its result flips.
+static constexpr float g_BoundaryTolerance = 1e-4f;
+
+struct ViewLight
+{
+    glm::vec3 position;
+
+    glm::vec3 axis;
+
+    float range;
+
+    float cosAngle;
+};
+
+static std::vector<GpuLight> CreateLights(uint32_t lightCount)
+{
+    // Fixed seed, every run tests the same lights.
+    std::mt19937 random{ 11 };
+    std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+
+    std::vector<GpuLight> lights(lightCount);
+    for (GpuLight &light : lights)
+    {
+        light.position = glm::vec3{ unit(random) * 1000.0f - 500.0f, unit(random) * 40.0f - 5.0f, unit(random) * 1000.0f - 500.0f };
+        light.range = 0.5f + unit(random) * 30.0f;
+
+        // Half spot lights, pointing anywhere, from narrow cones to nearly a hemisphere.
+        if (unit(random) < 0.5f)
+        {
+            glm::vec3 direction{ unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f };
+            light.direction = glm::length(direction) > 1e-3f ? glm::normalize(direction) : glm::vec3{ 0.0f, -1.0f, 0.0f };
+            light.spotCosAngle = std::cos(0.05f + unit(random) * 1.5f);
+        }
+    }
+    return lights;
+}
+
+// Same view space transform Build() applies.
+static ViewLight ToView(const GpuLight &light, const glm::mat4 &view)
+{
+    ViewLight viewLight{};
+    viewLight.position = glm::vec3{ view * glm::vec4{ light.position, 1.0f } };
+    viewLight.axis = glm::normalize(glm::mat3{ view } * light.direction);
+    viewLight.range = light.range;
+    viewLight.cosAngle = std::max(light.spotCosAngle, -1.0f);
+    return viewLight;
+}
+
+static bool Intersects(const LightClusterBounds &bounds, const ViewLight &light, float range)
+{
+    return LightClusterBuilder::IntersectsSphere(bounds, light.position, range) &&
+        LightClusterBuilder::IntersectsCone(bounds, light.position, light.axis, range, light.cosAngle);
+}
+
+// Sorted light indices of every cluster.
+static std::vector<std::vector<uint32_t>> BuildReference(const std::vector<LightClusterBounds> &clusterBounds, const std::vector<ViewLight> &lights)
+{
+    std::vector<std::vector<uint32_t>> clusters(clusterBounds.size());
+    for (size_t cluster = 0; cluster < clusterBounds.size(); ++cluster)
+    {
+        for (uint32_t light = 0; light < lights.size(); ++light)
+        {
+            if (Intersects(clusterBounds[cluster], lights[light], lights[light].range))
+            {
+                clusters[cluster].push_back(light);
+            }
+        }
+    }
+    return clusters;
+}
+
+// Number of cluster and light pairs that differ from the reference beyond rounding.
+static uint32_t CompareWithReference(const LightClusterBuilder &builder, const std::vector<std::vector<uint32_t>> &reference, const std::vector<ViewLight> &lights,
+    uint32_t &boundaryCount)
+{
+    const std::vector<LightClusterBounds> &clusterBounds = builder.GetClusterBounds();
+    const std::vector<LightClusterRange> &ranges = builder.GetClusterRanges();
+    const std::vector<uint32_t> &indices = builder.GetLightIndices();
+
+    uint32_t mismatchCount = 0;
+    std::vector<uint32_t> built;
+    std::vector<uint32_t> difference;
+
+    for (size_t cluster = 0; cluster < reference.size(); ++cluster)
+    {
+        const LightClusterRange &range = ranges[cluster];
+        built.assign(indices.begin() + range.offset, indices.begin() + range.offset + range.count);
+        std::sort(built.begin(), built.end());
+
+        difference.clear();
+        std::set_symmetric_difference(built.begin(), built.end(), reference[cluster].begin(), reference[cluster].end(), std::back_inserter(difference));
+
+        for (uint32_t light : difference)
+        {
+            const ViewLight &viewLight = lights[light];
+            bool inflated = Intersects(clusterBounds[cluster], viewLight, viewLight.range * (1.0f + g_BoundaryTolerance));
+            bool deflated = Intersects(clusterBounds[cluster], viewLight, viewLight.range * (1.0f - g_BoundaryTolerance));
+            if (inflated != deflated)
+            {
+                ++boundaryCount;
+                continue;
+            }
+
+            if (mismatchCount < 8)
+            {
+                bool inBuilt = std::binary_search(built.begin(), built.end(), light);
+                LOGE("Cluster {}: light {} is {} the build but {} the reference", cluster, light, inBuilt ? "in" : "missing from", inBuilt ? "missing from" : "in");
+            }
+            ++mismatchCount;
+        }
+    }
+    return mismatchCount;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t lightCount = 5000;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--lights") == 0 && index + 1 < argc)
+        {
+            lightCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<GpuLight> lights = CreateLights(lightCount);
+
+    glm::vec3 cameraPosition{ 0.0f, 10.0f, -200.0f };
+    glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+    glm::mat4 projection = glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    projection[1][1] *= -1.0f;
+
+    // Room for every light in every cluster, so nothing the reference holds may be dropped.
+    LightClusterGrid grid{};
+    grid.maxLightsPerCluster = lightCount;
+    grid.maxLightIndices = grid.GetClusterCount() * lightCount;
+
+    std::vector<ViewLight> viewLights;
+    viewLights.reserve(lights.size());
+    for (const GpuLight &light : lights)
+    {
+        viewLights.push_back(ToView(light, view));
+    }
+
+    g_WorkerThreadPool->Create(0, 0);
+
+    LightClusterBuilder builder;
+    builder.SetView(grid, projection);
+    std::vector<std::vector<uint32_t>> reference = BuildReference(builder.GetClusterBounds(), viewLights);
+
+    size_t referenceCount = 0;
+    for (const std::vector<uint32_t> &cluster : reference)
+    {
+        referenceCount += cluster.size();
+    }
+
+    bool passed = true;
+    for (bool simd : { true, false })
+    {
+        if (simd && !LightClusterBuilder::IsSimdSupported())
+        {
+            LOGW("Built without SSE2, only the scalar path is tested");
+            continue;
+        }
+
+        builder.SetSimdEnabled(simd);
+        builder.Build(*g_WorkerThreadPool, lights.data(), lightCount, view);
+
+        const LightClusterStats &stats = builder.GetStats();
+        uint32_t boundaryCount = 0;
+        uint32_t mismatchCount = CompareWithReference(builder, reference, viewLights, boundaryCount);
+
+        LOGI("{}: {} lights, {} of {} reference indices, {} at a boundary, {} per cluster at most, built in {:.2f} ms", simd ? "SSE2" : "Scalar", stats.lightCount,
+            stats.indexCount, referenceCount, boundaryCount, stats.maxClusterLights, stats.buildSeconds * 1000.0);
+
+        if (stats.droppedCount > 0)
+        {
+            LOGE("{} light references were dropped", stats.droppedCount);
+            passed = false;
+        }
+
+        if (mismatchCount > 0)
+        {
+            LOGE("{} cluster and light pairs differ from the reference", mismatchCount);
+            passed = false;
+        }
+    }
+
+    g_WorkerThreadPool->Destory();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,265 @@
+// Frame-time regression harness. Flies a scripted camera over a reference scene on a headless
+// device and measures CPU and GPU frame-time percentiles, allocations per frame and Vulkan object
+// counts, then compares them against a stored baseline.
+//
+//   NextRenderFrameRegression <script.json> [--baseline <file>] [--output <file>] [--update-baseline] [--lavapipe]
+//
+// --update-baseline writes the results to the baseline file instead of comparing. --lavapipe selects
+// Mesa's software driver, the configuration baselines for CPU-only CI machines are recorded with.
+// The exit code is non-zero when any metric regressed beyond the script's tolerances or when the
+// baseline to compare against doesn't exist.
+
+#include "AllocationCounter.h"
+#include "ReferenceScene.h"
+#include "RegressionReport.h"
+#include "RegressionScript.h"
+#include "Common/Logging.h"
+#include "Gfx/Vulkan/VulkanDevice.h"
+#include "Gfx/Vulkan/VulkanGfx.h"
+#include "Gfx/Vulkan/VulkanGpuProfiler.h"
+#include "Gfx/Vulkan/VulkanObjectTracker.h"
+#include "Gfx/Vulkan/VulkanOffscreenRenderer.h"
+#include "Gfx/Vulkan/VulkanPhysicalDevice.h"
+#include "Render/LodSelector.h"
+#include "Thread/ThreadPool.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if !defined(_WIN32)
+// Where Debian, Ubuntu and Fedora install the lavapipe ICD manifest.
+static const char *g_LavapipeIcd = "/usr/share/vulkan/icd.d/lvp_icd.x86_64.json";
+#endif
+
+static bool RunScript(const RegressionScript &script, RegressionResult &result)
+{
+    VulkanGfx gfx{ "NextRenderFrameRegression", std::unordered_map<const char *, bool>{}, std::vector<const char *>{}, true };
+    VulkanOffscreenRenderer &renderer = gfx.GetOffscreenRenderer();
+    VulkanGpuProfiler *profiler = gfx.GetGpuProfiler();
+
+    ReferenceScene scene{ gfx.GetDevice(), renderer.GetRenderPass(), script.scene };
+    if (!scene.IsLoaded())
+    {
+        return false;
+    }
+
+    LOGI("Rendering {} instances, {} warm-up and {} measured frames at {}x{}", scene.GetInstanceCount(), script.warmupFrames, script.frameCount, script.width, script.height);
+
+    result.script = script.name;
+    result.device = gfx.GetDevice().GetGpu().GetProperties().deviceName;
+    result.frameCount = script.frameCount;
+    result.width = script.width;
+    result.height = script.height;
+
+    float aspect = static_cast<float>(script.width) / static_cast<float>(script.height);
+    glm::mat4 projection = glm::perspective(glm::radians(script.fieldOfView), aspect, script.nearPlane, script.farPlane);
+    projection[1][1] *= -1.0f;
+
+    LodSelectionParams lodParams{};
+    lodParams.verticalFov = glm::radians(script.fieldOfView);
+    lodParams.viewportHeight = static_cast<float>(script.height);
+
+    // Built once and pointed at per-frame state, so the harness itself allocates nothing per frame.
+    glm::mat4 viewProjection{ 1.0f };
+    GpuCullParams cullParams{};
+
+    OffscreenRenderJob job{};
+    job.width = script.width;
+    job.height = script.height;
+    job.clearColor = { { 0.45f, 0.6f, 0.75f, 1.0f } };
+    job.prepare = [&scene, &cullParams](VkCommandBuffer commandBuffer) { scene.Cull(commandBuffer, cullParams); };
+    job.record = [&scene, &viewProjection](VkCommandBuffer commandBuffer) { scene.Draw(commandBuffer, viewProjection); };
+
+    std::vector<double> cpuFrameMs;
+    std::vector<double> gpuFrameMs;
+    std::vector<double> allocations;
+    cpuFrameMs.reserve(script.frameCount);
+    gpuFrameMs.reserve(script.frameCount);
+    allocations.reserve(script.frameCount);
+
+    // Renderer frames count from 0 in submission order, the same as the loop.
+    uint64_t lastGpuFrame = ~0ull;
+    VulkanObjectCounts countsBefore{};
+
+    uint32_t totalFrames = script.warmupFrames + script.frameCount;
+    for (uint32_t frame = 0; frame < totalFrames; ++frame)
+    {
+        if (frame == script.warmupFrames)
+        {
+            countsBefore = VulkanObjectTracker::GetCounts();
+        }
+
+        CameraPose pose = script.camera.Evaluate(script.GetFrameTime(frame));
+        viewProjection = projection * pose.GetViewMatrix();
+        cullParams = GpuCullParams::FromView(viewProjection, pose.position, lodParams);
+
+        uint64_t allocationsBefore = AllocationCounter::GetCount();
+        auto begin = std::chrono::steady_clock::now();
+
+        gfx.BeginFrame();
+        renderer.Submit(job);
+        gfx.EndFrame();
+
+        auto end = std::chrono::steady_clock::now();
+        uint64_t allocationsAfter = AllocationCounter::GetCount();
+
+        if (frame >= script.warmupFrames)
+        {
+            cpuFrameMs.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+            allocations.push_back(static_cast<double>(allocationsAfter - allocationsBefore));
+        }
+
+        const GpuFrameResult *gpuFrame = profiler != nullptr ? profiler->GetLatestFrame() : nullptr;
+        if (gpuFrame != nullptr && gpuFrame->frameIndex != lastGpuFrame && !gpuFrame->zones.empty())
+        {
+            lastGpuFrame = gpuFrame->frameIndex;
+            if (gpuFrame->frameIndex >= script.warmupFrames)
+            {
+                const GpuZoneResult &zone = gpuFrame->zones[0];
+                gpuFrameMs.push_back(static_cast<double>(zone.endNanoseconds - zone.beginNanoseconds) * 1e-6);
+            }
+        }
+    }
+
+    renderer.Flush();
+
+    VulkanObjectCounts countsAfter = VulkanObjectTracker::GetCounts();
+    result.vulkanObjects = countsAfter;
+    result.vulkanObjectsCreated = countsAfter.GetCreatedTotal() - countsBefore.GetCreatedTotal();
+
+    result.cpuFrameMs = FrameStatistics::Compute(cpuFrameMs);
+    result.gpuFrameMs = FrameStatistics::Compute(gpuFrameMs);
+    result.allocationsPerFrame = FrameStatistics::Compute(allocations);
+
+    if (profiler != nullptr && profiler->GetDroppedFrameCount() > 0)
+    {
+        LOGW("{} GPU frames had no results in time and are missing from the GPU percentiles", profiler->GetDroppedFrameCount());
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::string scriptPath;
+    std::string baselinePath;
+    std::string outputPath;
+    bool updateBaseline = false;
+    bool lavapipe = false;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--baseline") == 0 && index + 1 < argc)
+        {
+            baselinePath = argv[++index];
+        }
+        else if (strcmp(argv[index], "--output") == 0 && index + 1 < argc)
+        {
+            outputPath = argv[++index];
+        }
+        else if (strcmp(argv[index], "--update-baseline") == 0)
+        {
+            updateBaseline = true;
+        }
+        else if (strcmp(argv[index], "--lavapipe") == 0)
+        {
+            lavapipe = true;
+        }
+        else if (argv[index][0] != '-' && scriptPath.empty())
+        {
+            scriptPath = argv[index];
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (scriptPath.empty())
+    {
+        LOGE("Usage: NextRenderFrameRegression <script.json> [--baseline <file>] [--output <file>] [--update-baseline] [--lavapipe]");
+        return EXIT_FAILURE;
+    }
+
+    // A gate without a baseline has nothing to compare against, fail before spending the frames.
+    if (!baselinePath.empty() && !updateBaseline && !std::filesystem::exists(baselinePath))
+    {
+        LOGE("No baseline {}, record one with the UpdateFrameRegressionBaselines target", baselinePath);
+        return EXIT_FAILURE;
+    }
+
+    if (lavapipe)
+    {
+#if !defined(_WIN32)
+        // An explicit driver choice in the environment wins.
+        setenv("VK_DRIVER_FILES", g_LavapipeIcd, 0);
+        setenv("VK_ICD_FILENAMES", g_LavapipeIcd, 0);
+#endif
+    }
+
+    RegressionScript script;
+    if (!script.Load(scriptPath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Before the device exists, it installs the counting entry points when created.
+    VulkanObjectTracker::SetEnabled(true);
+
+    g_WorkerThreadPool->Create(0, 0);
+
+    RegressionResult result{};
+    bool rendered = RunScript(script, result);
+
+    g_WorkerThreadPool->Destory();
+
+    if (!rendered)
+    {
+        return EXIT_FAILURE;
+    }
+
+    LOGI("CPU frame ms: p50 {:.3f}, p95 {:.3f}, p99 {:.3f}", result.cpuFrameMs.p50, result.cpuFrameMs.p95, result.cpuFrameMs.p99);
+    LOGI("GPU frame ms: p50 {:.3f}, p95 {:.3f}, p99 {:.3f} ({} frames)", result.gpuFrameMs.p50, result.gpuFrameMs.p95, result.gpuFrameMs.p99, result.gpuFrameMs.sampleCount);
+    LOGI("Allocations per frame: mean {:.2f}, max {}", result.allocationsPerFrame.mean, result.allocationsPerFrame.max);
+    LOGI("Vulkan objects: {} alive, {} created while measuring", result.vulkanObjects.GetLiveTotal(), result.vulkanObjectsCreated);
+
+    if (!outputPath.empty() && !RegressionReport::Write(result, outputPath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (baselinePath.empty())
+    {
+        return EXIT_SUCCESS;
+    }
+
+    if (updateBaseline)
+    {
+        if (!RegressionReport::Write(result, baselinePath))
+        {
+            return EXIT_FAILURE;
+        }
+        LOGI("Baseline {} updated", baselinePath);
+        return EXIT_SUCCESS;
+    }
+
+    RegressionResult baseline{};
+    if (!RegressionReport::ReadBaseline(baselinePath, baseline))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (!RegressionReport::Compare(result, baseline, script.tolerances))
+    {
+        LOGE("{} regressed against {}", script.name, baselinePath);
+        return EXIT_FAILURE;
+    }
+
+    LOGI("{} is within tolerance of {}", script.name, baselinePath);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+// Mesh optimizer report. Imports a glTF file twice, as is and with GltfImporter::SetOptimizeMeshes(),
+// and reports ACMR, ATVR and overfetch before and after. Fails when the optimised meshes don't hold the
+// same triangles with the same winding, or when the vertex cache got worse by more than the overdraw
+// threshold allows. Without --mesh a sphere exported in scrambled triangle order stands in for a mesh
+// that never went through an optimizer. Needs no GPU.
+//
+//   NextRenderMeshOptimizerReport [--mesh <file.gltf|file.glb>]
+
+#include "Common/Logging.h"
+#include "Render/Mesh.h"
+#include "Scene/GltfImporter.h"
+#include "Scene/Scene.h"
+#include "Thread/ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Same bound the importer passes to MeshOptimizer::OptimizeMesh().
+static constexpr float g_OverdrawThreshold = 1.05f;
+
+using Triangle = std::array<float, 9>;
+
+static std::string WriteScrambledSphere(uint32_t rings, uint32_t segments)
+{
+    std::vector<glm::vec3> positions;
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        float theta = 3.14159265f * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            float phi = 6.2831853f * static_cast<float>(segment) / static_cast<float>(segments);
+            positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+        }
+    }
+    std::vector<glm::vec3> normals = positions;
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            uint32_t corner = ring * (segments + 1) + segment;
+            triangles.push_back({ corner, corner + 1, corner + segments + 1 });
+            triangles.push_back({ corner + 1, corner + segments + 2, corner + segments + 1 });
+        }
+    }
+
+    // Fixed seed, every run reports the same numbers.
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937{ 7 });
+
+    std::vector<uint32_t> indices;
+    for (const std::array<uint32_t, 3> &triangle : triangles)
+    {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "NextRenderRegression";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path gltfPath = directory / "ScrambledSphere.gltf";
+
+    size_t positionBytes = positions.size() * sizeof(glm::vec3);
+    size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+    {
+        std::ofstream bin{ directory / "ScrambledSphere.bin", std::ios::binary | std::ios::trunc };
+        bin.write(reinterpret_cast<const char *>(positions.data()), positionBytes);
+        bin.write(reinterpret_cast<const char *>(normals.data()), positionBytes);
+        bin.write(reinterpret_cast<const char *>(indices.data()), indexBytes);
+    }
+
+    std::ofstream gltf{ gltfPath, std::ios::trunc };
+    gltf << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\n"
+        << "\"buffers\":[{\"uri\":\"ScrambledSphere.bin\",\"byteLength\":" << positionBytes * 2 + indexBytes << "}],\n"
+        << "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << positionBytes << "},"
+        << "{\"buffer\":0,\"byteOffset\":" << positionBytes << ",\"byteLength\":" << positionBytes << "},"
+        << "{\"buffer\":0,\"byteOffset\":" << positionBytes * 2 << ",\"byteLength\":" << indexBytes << "}],\n"
+        << "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" << positions.size() << ",\"type\":\"VEC3\",\"min\":[-1,-1,-1],\"max\":[1,1,1]},"
+        << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << normals.size() << ",\"type\":\"VEC3\"},"
+        << "{\"bufferView\":2,\"componentType\":5125,\"count\":" << indices.size() << ",\"type\":\"SCALAR\"}],\n"
+        << "\"meshes\":[{\"name\":\"Sphere\",\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1},\"indices\":2}]}],\n"
+        << "\"nodes\":[{\"name\":\"Sphere\",\"mesh\":0}],\n"
+        << "\"scenes\":[{\"nodes\":[0]}]}\n";
+
+    return gltfPath.string();
+}
+
+// Triangles of a submesh by their positions, each rotated to start at its smallest corner so the
+// winding is kept, then sorted. Equal lists mean the same surface whatever the index order.
+static std::vector<Triangle> GetTriangles(const Mesh &mesh, const SubMesh &subMesh)
+{
+    const std::vector<glm::vec3> &positions = mesh.GetPositions();
+    const std::vector<uint32_t> &indices = mesh.GetIndices();
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(subMesh.indexCount / 3);
+
+    for (uint32_t index = 0; index + 2 < subMesh.indexCount; index += 3)
+    {
+        std::array<glm::vec3, 3> corners;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            corners[corner] = positions[indices[subMesh.indexOffset + index + corner]];
+        }
+
+        auto less = [](const glm::vec3 &a, const glm::vec3 &b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+        uint32_t first = static_cast<uint32_t>(std::min_element(corners.begin(), corners.end(), less) - corners.begin());
+
+        Triangle triangle;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const glm::vec3 &position = corners[(first + corner) % 3];
+            triangle[corner * 3 + 0] = position.x;
+            triangle[corner * 3 + 1] = position.y;
+            triangle[corner * 3 + 2] = position.z;
+        }
+        triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static uint32_t CountChangedSubMeshes(const Scene &source, const Scene &optimized)
+{
+    const std::vector<std::unique_ptr<Mesh>> &sourceMeshes = source.GetMeshes();
+    const std::vector<std::unique_ptr<Mesh>> &optimizedMeshes = optimized.GetMeshes();
+    if (sourceMeshes.size() != optimizedMeshes.size())
+    {
+        return static_cast<uint32_t>(std::max(sourceMeshes.size(), optimizedMeshes.size()));
+    }
+
+    uint32_t changedCount = 0;
+    for (size_t meshIndex = 0; meshIndex < sourceMeshes.size(); ++meshIndex)
+    {
+        const Mesh &sourceMesh = *sourceMeshes[meshIndex];
+        const Mesh &optimizedMesh = *optimizedMeshes[meshIndex];
+        if (sourceMesh.GetSubMeshes().size() != optimizedMesh.GetSubMeshes().size())
+        {
+            ++changedCount;
+            continue;
+        }
+
+        for (size_t subMesh = 0; subMesh < sourceMesh.GetSubMeshes().size(); ++subMesh)
+        {
+            if (GetTriangles(sourceMesh, sourceMesh.GetSubMeshes()[subMesh]) != GetTriangles(optimizedMesh, optimizedMesh.GetSubMeshes()[subMesh]))
+            {
+                LOGE("Submesh {} of mesh {} changed its triangles", subMesh, sourceMesh.GetName());
+                ++changedCount;
+            }
+        }
+    }
+    return changedCount;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--mesh") == 0 && index + 1 < argc)
+        {
+            path = argv[++index];
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (path.empty())
+    {
+        path = WriteScrambledSphere(96, 192);
+    }
+
+    g_WorkerThreadPool->Create(0, 0);
+
+    Scene source;
+    Scene optimized;
+    GltfImportStats stats{};
+
+    GltfImporter importer{ *g_WorkerThreadPool };
+    bool imported = importer.Import(path, source);
+    importer.SetOptimizeMeshes(true);
+    imported = imported && importer.Import(path, optimized, &stats);
+
+    g_WorkerThreadPool->Destory();
+
+    if (!imported)
+    {
+        LOGE("Failed to import {}", path);
+        return EXIT_FAILURE;
+    }
+
+    const MeshOptimizerReport &report = stats.optimizerReport;
+    LOGI("{}: {} meshes, {} triangles, {} vertices, optimized in {:.2f} ms", path, stats.meshCount, report.cacheBefore.triangleCount,
+        report.cacheBefore.vertexCount, stats.optimizeSeconds * 1000.0);
+    LOGI("ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", report.cacheBefore.acmr, report.cacheAfter.acmr, report.cacheBefore.atvr, report.cacheAfter.atvr);
+    LOGI("Overfetch {:.3f} -> {:.3f}, {} -> {} bytes per vertex", report.fetchBefore.overfetch, report.fetchAfter.overfetch,
+        report.vertexStrideBefore, report.vertexStrideAfter);
+
+    uint32_t changedCount = CountChangedSubMeshes(source, optimized);
+    if (changedCount > 0)
+    {
+        LOGE("{} submeshes lost or changed triangles", changedCount);
+        return EXIT_FAILURE;
+    }
+
+    if (report.cacheAfter.acmr > report.cacheBefore.acmr * g_OverdrawThreshold)
+    {
+        LOGE("ACMR degraded beyond the overdraw threshold of {}", g_OverdrawThreshold);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
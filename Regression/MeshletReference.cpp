@@ -0,0 +1,275 @@
+// Meshlet reference test. Builds meshlets for a sphere in scrambled triangle order and for the same
+// sphere unwelded, then checks them and MeshletCuller against brute force. Fails when a meshlet
+// exceeds MaxMeshletVertices or MaxMeshletTriangles, when the meshlets don't hold every triangle
+// exactly once with its winding, when a bounding sphere misses one of its vertices, when the cone
+// test culls a meshlet with a triangle facing the camera, or when Cull() draws a different set than
+// IsVisible() decides. Needs no GPU.
+//
+//   NextRenderMeshletReference [--cameras <count>]
+
+#include "Common/Logging.h"
+#include "Render/Meshlet.h"
+#include "Render/MeshletCuller.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Relative slack for the bounding sphere and facing tests, the builder works in floats as well.
+static constexpr float g_Tolerance = 1e-4f;
+
+using Triangle = std::array<uint32_t, 3>;
+
+struct TestMesh
+{
+    const char *name;
+
+    std::vector<glm::vec3> positions;
+
+    std::vector<uint32_t> indices;
+};
+
+static TestMesh CreateSphere(uint32_t rings, uint32_t segments)
+{
+    TestMesh mesh{ "Sphere" };
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        float theta = 3.14159265f * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            float phi = 6.2831853f * static_cast<float>(segment) / static_cast<float>(segments);
+            mesh.positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+        }
+    }
+
+    std::vector<Triangle> triangles;
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            uint32_t corner = ring * (segments + 1) + segment;
+            triangles.push_back({ corner, corner + 1, corner + segments + 1 });
+            triangles.push_back({ corner + 1, corner + segments + 2, corner + segments + 1 });
+        }
+    }
+
+    // Fixed seed, every run tests the same order.
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937{ 5 });
+
+    for (const Triangle &triangle : triangles)
+    {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+// Three vertices of its own per triangle, no triangle shares an index with another.
+static TestMesh Unweld(const TestMesh &source)
+{
+    TestMesh mesh{ "Unwelded sphere" };
+    for (uint32_t index : source.indices)
+    {
+        mesh.indices.push_back(static_cast<uint32_t>(mesh.positions.size()));
+        mesh.positions.push_back(source.positions[index]);
+    }
+    return mesh;
+}
+
+// Rotated to start at the smallest index, which keeps the winding.
+static Triangle Canonical(uint32_t a, uint32_t b, uint32_t c)
+{
+    if (b < a && b < c)
+    {
+        return { b, c, a };
+    }
+    if (c < a && c < b)
+    {
+        return { c, a, b };
+    }
+    return { a, b, c };
+}
+
+static std::vector<Triangle> GetTriangles(const std::vector<uint32_t> &indices)
+{
+    std::vector<Triangle> triangles;
+    for (size_t index = 0; index + 2 < indices.size(); index += 3)
+    {
+        triangles.push_back(Canonical(indices[index], indices[index + 1], indices[index + 2]));
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static bool CheckMeshlets(const TestMesh &mesh, const MeshletData &meshletData)
+{
+    for (size_t index = 0; index < meshletData.meshlets.size(); ++index)
+    {
+        const Meshlet &meshlet = meshletData.meshlets[index];
+        if (meshlet.vertexCount > MaxMeshletVertices || meshlet.triangleCount > MaxMeshletTriangles || meshlet.triangleCount == 0)
+        {
+            LOGE("{}: meshlet {} has {} vertices and {} triangles", mesh.name, index, meshlet.vertexCount, meshlet.triangleCount);
+            return false;
+        }
+
+        const MeshletBounds &bounds = meshletData.bounds[index];
+        for (uint32_t vertex = 0; vertex < meshlet.vertexCount; ++vertex)
+        {
+            const glm::vec3 &position = mesh.positions[meshletData.vertices[meshlet.vertexOffset + vertex]];
+            float distance = glm::length(position - bounds.center);
+            if (distance > bounds.radius * (1.0f + g_Tolerance) + g_Tolerance)
+            {
+                LOGE("{}: vertex {} of meshlet {} is {} from the center, the radius is {}", mesh.name, vertex, index, distance, bounds.radius);
+                return false;
+            }
+        }
+    }
+
+    // Equal sorted lists mean every triangle appears exactly once.
+    if (GetTriangles(meshletData.BuildIndexBuffer()) != GetTriangles(mesh.indices))
+    {
+        LOGE("{}: the meshlets don't hold each triangle of the mesh exactly once", mesh.name);
+        return false;
+    }
+    return true;
+}
+
+// Whether any triangle of the meshlet faces a viewer at position.
+static bool IsAnyTriangleFacing(const TestMesh &mesh, const MeshletData &meshletData, uint32_t meshletIndex, const glm::vec3 &position)
+{
+    const Meshlet &meshlet = meshletData.meshlets[meshletIndex];
+    for (uint32_t triangle = 0; triangle < meshlet.triangleCount; ++triangle)
+    {
+        const uint8_t *corners = &meshletData.triangles[(meshlet.triangleOffset + triangle) * 3];
+        const glm::vec3 &a = mesh.positions[meshletData.vertices[meshlet.vertexOffset + corners[0]]];
+        const glm::vec3 &b = mesh.positions[meshletData.vertices[meshlet.vertexOffset + corners[1]]];
+        const glm::vec3 &c = mesh.positions[meshletData.vertices[meshlet.vertexOffset + corners[2]]];
+
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float area = glm::length(normal);
+        if (area > 0.0f && glm::dot(normal / area, position - a) > g_Tolerance)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns how many meshlets the cone culled, or -1 on a failure.
+static int64_t CheckCulling(const TestMesh &mesh, const MeshletData &meshletData, uint32_t cameraCount, uint32_t &backFacingCount)
+{
+    std::vector<GpuMeshlet> gpuMeshlets = meshletData.BuildGpuMeshlets();
+    uint32_t meshletCount = static_cast<uint32_t>(gpuMeshlets.size());
+
+    // Planes everything is inside of, so only the cone decides.
+    MeshletCullParams params{};
+    for (glm::vec4 &plane : params.frustum.planes)
+    {
+        plane = glm::vec4{ 0.0f, 0.0f, 0.0f, 1.0f };
+    }
+
+    std::mt19937 random{ 17 };
+    std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+    int64_t coneCulled = 0;
+    std::vector<DrawIndexedIndirectCommand> draws;
+
+    for (uint32_t camera = 0; camera < cameraCount; ++camera)
+    {
+        // Outside the sphere at varying distances, the first camera inside it.
+        glm::vec3 direction{ unit(random), unit(random), unit(random) };
+        float distance = camera == 0 ? 0.0f : 1.2f + (unit(random) + 1.0f) * 4.0f;
+        params.cameraPosition = glm::length(direction) > 1e-3f ? glm::normalize(direction) * distance : glm::vec3{ 0.0f, 0.0f, distance };
+
+        MeshletCullStats stats{};
+        draws.clear();
+        MeshletCuller::Cull(gpuMeshlets.data(), meshletCount, params, draws, &stats);
+
+        size_t drawIndex = 0;
+        for (uint32_t meshlet = 0; meshlet < meshletCount; ++meshlet)
+        {
+            bool facing = IsAnyTriangleFacing(mesh, meshletData, meshlet, params.cameraPosition);
+            bool visible = MeshletCuller::IsVisible(gpuMeshlets[meshlet], params);
+            backFacingCount += facing ? 0 : 1;
+
+            if (facing && !visible)
+            {
+                LOGE("{}: meshlet {} is cone culled from ({}, {}, {}) with a triangle facing the camera", mesh.name, meshlet, params.cameraPosition.x,
+                    params.cameraPosition.y, params.cameraPosition.z);
+                return -1;
+            }
+
+            if (!visible)
+            {
+                continue;
+            }
+
+            // Draws come out in meshlet order.
+            const Meshlet &source = meshletData.meshlets[meshlet];
+            if (drawIndex >= draws.size() || draws[drawIndex].firstInstance != meshlet || draws[drawIndex].instanceCount != 1 ||
+                draws[drawIndex].firstIndex != source.triangleOffset * 3 || draws[drawIndex].indexCount != source.triangleCount * 3)
+            {
+                LOGE("{}: draw {} of Cull() doesn't match visible meshlet {}", mesh.name, drawIndex, meshlet);
+                return -1;
+            }
+            ++drawIndex;
+        }
+
+        if (drawIndex != draws.size() || stats.visibleCount != draws.size() || stats.frustumCulled != 0)
+        {
+            LOGE("{}: Cull() drew {} meshlets, IsVisible() passes {}", mesh.name, draws.size(), drawIndex);
+            return -1;
+        }
+        coneCulled += stats.coneCulled;
+    }
+    return coneCulled;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t cameraCount = 64;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--cameras") == 0 && index + 1 < argc)
+        {
+            cameraCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    TestMesh sphere = CreateSphere(48, 96);
+    TestMesh unwelded = Unweld(CreateSphere(16, 32));
+
+    for (const TestMesh *mesh : { &sphere, &unwelded })
+    {
+        MeshletData meshletData;
+        MeshletBuilder::Build(mesh->indices.data(), static_cast<uint32_t>(mesh->indices.size()), mesh->positions.data(),
+            static_cast<uint32_t>(mesh->positions.size()), meshletData);
+
+        if (!CheckMeshlets(*mesh, meshletData))
+        {
+            return EXIT_FAILURE;
+        }
+
+        uint32_t backFacingCount = 0;
+        int64_t coneCulled = CheckCulling(*mesh, meshletData, cameraCount, backFacingCount);
+        if (coneCulled < 0)
+        {
+            return EXIT_FAILURE;
+        }
+
+        uint32_t triangleCount = static_cast<uint32_t>(mesh->indices.size() / 3);
+        LOGI("{}: {} triangles in {} meshlets, {:.1f} per meshlet, cone culled {} of {} back facing meshlets over {} cameras", mesh->name, triangleCount,
+            meshletData.meshlets.size(), static_cast<double>(triangleCount) / meshletData.meshlets.size(), coneCulled, backFacingCount, cameraCount);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+// Multi device offscreen rendering test. Creates a VulkanMultiDeviceRenderer over at least two
+// devices and clears every render to a colour unique to its job, first handing jobs to the devices in
+// turn, then letting RenderBatch() split them. Fails when fewer than two devices exist, when a render
+// is delivered zero or several times, or when any pixel of a readback isn't its job's colour. On a
+// machine with one GPU, --devices-per-gpu 2 gives it two logical devices.
+//
+//   NextRenderMultiDeviceRender [--jobs <count>] [--devices-per-gpu <count>] [--lavapipe]
+
+#include "Common/Logging.h"
+#include "Gfx/Vulkan/VulkanDevice.h"
+#include "Gfx/Vulkan/VulkanInstance.h"
+#include "Gfx/Vulkan/VulkanMultiDeviceRenderer.h"
+#include "Gfx/Vulkan/VulkanPhysicalDevice.h"
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+// Where Debian, Ubuntu and Fedora install the lavapipe ICD manifest.
+static const char *g_LavapipeIcd = "/usr/share/vulkan/icd.d/lvp_icd.x86_64.json";
+#endif
+
+static constexpr uint32_t g_Width = 64;
+
+static constexpr uint32_t g_Height = 48;
+
+using Color = std::array<uint8_t, 4>;
+
+// Distinct for the first 65536 jobs. Multiples of 1/255 convert back to the same UNORM bytes.
+static Color GetJobColor(uint32_t jobIndex)
+{
+    return Color{ static_cast<uint8_t>(jobIndex & 0xFF), static_cast<uint8_t>((jobIndex >> 8) & 0xFF), static_cast<uint8_t>(255 - (jobIndex * 7 & 0xFF)), 255 };
+}
+
+static bool CheckPixels(const OffscreenReadback &readback, const Color &expected)
+{
+    if (readback.width != g_Width || readback.height != g_Height)
+    {
+        LOGE("Render {} is {}x{}, expected {}x{}", readback.ticket, readback.width, readback.height, g_Width, g_Height);
+        return false;
+    }
+
+    for (uint32_t y = 0; y < readback.height; ++y)
+    {
+        const uint8_t *row = readback.pixels + static_cast<size_t>(y) * readback.rowPitch;
+        for (uint32_t x = 0; x < readback.width; ++x)
+        {
+            if (std::memcmp(row + x * 4, expected.data(), 4) != 0)
+            {
+                const uint8_t *texel = row + x * 4;
+                LOGE("Render {} has ({}, {}, {}, {}) at ({}, {}), expected ({}, {}, {}, {})", readback.ticket, texel[0], texel[1], texel[2], texel[3], x, y,
+                    expected[0], expected[1], expected[2], expected[3]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct JobResults
+{
+    // Per job, how many times it was delivered and whether every delivery held its colour.
+    std::vector<uint32_t> deliveries;
+
+    std::vector<uint8_t> correct;
+
+    // Per device.
+    std::vector<uint32_t> jobCounts;
+
+    void Reset(uint32_t jobCount, uint32_t deviceCount)
+    {
+        deliveries.assign(jobCount, 0);
+        correct.assign(jobCount, 1);
+        jobCounts.assign(deviceCount, 0);
+    }
+
+    bool Check(const char *pass) const
+    {
+        for (size_t jobIndex = 0; jobIndex < deliveries.size(); ++jobIndex)
+        {
+            if (deliveries[jobIndex] != 1 || correct[jobIndex] == 0)
+            {
+                LOGE("{}: job {} was delivered {} times, {}", pass, jobIndex, deliveries[jobIndex], correct[jobIndex] != 0 ? "correctly" : "with wrong pixels");
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+static OffscreenRenderJob BuildJob(uint32_t jobIndex, uint32_t deviceIndex, JobResults &results)
+{
+    ++results.jobCounts[deviceIndex];
+
+    Color color = GetJobColor(jobIndex);
+
+    OffscreenRenderJob job{};
+    job.width = g_Width;
+    job.height = g_Height;
+    for (uint32_t channel = 0; channel < 4; ++channel)
+    {
+        job.clearColor.float32[channel] = static_cast<float>(color[channel]) / 255.0f;
+    }
+
+    job.onReadback = [&results, jobIndex, color](const OffscreenReadback &readback)
+    {
+        ++results.deliveries[jobIndex];
+        if (!CheckPixels(readback, color))
+        {
+            results.correct[jobIndex] = 0;
+        }
+    };
+    return job;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t jobCount = 48;
+    uint32_t devicesPerGpu = 1;
+    bool lavapipe = false;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--jobs") == 0 && index + 1 < argc)
+        {
+            jobCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else if (strcmp(argv[index], "--devices-per-gpu") == 0 && index + 1 < argc)
+        {
+            devicesPerGpu = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else if (strcmp(argv[index], "--lavapipe") == 0)
+        {
+            lavapipe = true;
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (lavapipe)
+    {
+#if !defined(_WIN32)
+        // An explicit driver choice in the environment wins.
+        setenv("VK_DRIVER_FILES", g_LavapipeIcd, 0);
+        setenv("VK_ICD_FILENAMES", g_LavapipeIcd, 0);
+#endif
+    }
+
+    VulkanInstance instance{ "NextRenderMultiDeviceRender", std::unordered_map<const char *, bool>{}, std::vector<const char *>{}, true };
+
+    // Lavapipe is a CPU device, left out unless asked for.
+    MultiDeviceRendererDesc desc{};
+    desc.includeCpuDevices = lavapipe;
+    desc.devicesPerGpu = devicesPerGpu;
+
+    VulkanMultiDeviceRenderer renderer{ instance, desc };
+    uint32_t deviceCount = renderer.GetDeviceCount();
+    if (deviceCount < 2)
+    {
+        LOGE("{} device, the test needs at least two. Pass --devices-per-gpu 2 on a single GPU", deviceCount);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t deviceIndex = 0; deviceIndex < deviceCount; ++deviceIndex)
+    {
+        LOGI("Device {}: {}", deviceIndex, renderer.GetDevice(deviceIndex).GetGpu().GetProperties().deviceName);
+    }
+
+    JobResults results;
+
+    // In turn, so every device renders and reads back whatever the timing.
+    results.Reset(jobCount, deviceCount);
+    for (uint32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+    {
+        uint32_t deviceIndex = jobIndex % deviceCount;
+        renderer.Submit(deviceIndex, BuildJob(jobIndex, deviceIndex, results));
+    }
+    renderer.Flush();
+
+    if (!results.Check("Round robin"))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Split by load, how many each device gets depends on how fast it drains.
+    results.Reset(jobCount, deviceCount);
+    renderer.RenderBatch(jobCount, [&results](uint32_t jobIndex, uint32_t deviceIndex) { return BuildJob(jobIndex, deviceIndex, results); });
+
+    if (!results.Check("Batch"))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::string split;
+    for (uint32_t deviceIndex = 0; deviceIndex < deviceCount; ++deviceIndex)
+    {
+        split += (deviceIndex > 0 ? ", " : "") + std::to_string(results.jobCounts[deviceIndex]);
+    }
+    LOGI("{} renders on each of {} devices, then {} split as {}", jobCount / deviceCount, deviceCount, jobCount, split);
+
+    return EXIT_SUCCESS;
+}
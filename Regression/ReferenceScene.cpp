@@ -0,0 +1,413 @@
+#include "ReferenceScene.h"
+#include "Common/Logging.h"
+#include "Gfx/Vulkan/VulkanBuffer.h"
+#include "Gfx/Vulkan/VulkanDevice.h"
+#include "Gfx/Vulkan/VulkanGpuScene.h"
+#include "Gfx/Vulkan/VulkanShader.h"
+#include "Gfx/Vulkan/VulkanUtils.h"
+#include "Scene/GltfImporter.h"
+#include "Scene/MeshRenderer.h"
+#include "Scene/Transform.h"
+#include "Thread/ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <glm/gtc/quaternion.hpp>
+
+static const char *g_ReferenceVertexShader = R"(
+#version 450
+
+struct Instance
+{
+    mat4 world;
+    uint geometryIndex;
+    uint pipelineIndex;
+    uint objectId;
+    float maxScale;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances
+{
+    Instance instances[];
+};
+
+layout(push_constant) uniform DrawConstants
+{
+    mat4 viewProjection;
+} constants;
+
+layout(location = 0) in vec3 position;
+
+layout(location = 0) out vec3 worldPosition;
+layout(location = 1) flat out uint objectId;
+
+void main()
+{
+    // firstInstance of every culled draw is the instance index.
+    Instance instance = instances[gl_InstanceIndex];
+    vec4 world = instance.world * vec4(position, 1.0);
+
+    worldPosition = world.xyz;
+    objectId = instance.objectId;
+    gl_Position = constants.viewProjection * world;
+}
+)";
+
+static const char *g_ReferenceFragmentShader = R"(
+#version 450
+
+layout(location = 0) in vec3 worldPosition;
+layout(location = 1) flat in uint objectId;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+    // Faceted from the screen space derivatives, so meshes without normals shade the same way.
+    vec3 normal = normalize(cross(dFdx(worldPosition), dFdy(worldPosition)));
+    float light = abs(dot(normal, normalize(vec3(0.4, 1.0, 0.3)))) * 0.8 + 0.2;
+
+    uint hash = objectId * 2654435761u;
+    vec3 albedo = vec3(hash & 255u, (hash >> 8) & 255u, (hash >> 16) & 255u) / 255.0 * 0.6 + 0.4;
+
+    color = vec4(albedo * light, 1.0);
+}
+)";
+
+// The procedural scene has to come out the same on every standard library, which rules out the distributions.
+static float NextFloat(std::mt19937 &random)
+{
+    return static_cast<float>(random() >> 8) * (1.0f / 16777216.0f);
+}
+
+static std::unique_ptr<Mesh> CreateTerrainTile(uint32_t cells, float frequency)
+{
+    auto mesh = std::make_unique<Mesh>("Tile");
+
+    std::vector<glm::vec3> &positions = mesh->GetPositions();
+    std::vector<uint32_t> &indices = mesh->GetIndices();
+
+    uint32_t rowLength = cells + 1;
+    float cellSize = 1.0f / static_cast<float>(cells);
+
+    for (uint32_t z = 0; z < rowLength; ++z)
+    {
+        for (uint32_t x = 0; x < rowLength; ++x)
+        {
+            float u = static_cast<float>(x) * cellSize - 0.5f;
+            float v = static_cast<float>(z) * cellSize - 0.5f;
+            positions.push_back({ u, 0.15f * std::sin(u * frequency) * std::cos(v * frequency), v });
+        }
+    }
+
+    for (uint32_t z = 0; z < cells; ++z)
+    {
+        for (uint32_t x = 0; x < cells; ++x)
+        {
+            uint32_t corner = z * rowLength + x;
+            indices.insert(indices.end(), { corner, corner + rowLength, corner + 1, corner + 1, corner + rowLength, corner + rowLength + 1 });
+        }
+    }
+
+    SubMesh subMesh{};
+    subMesh.indexCount = static_cast<uint32_t>(indices.size());
+    mesh->GetSubMeshes().push_back(subMesh);
+    mesh->ComputeBounds();
+    return mesh;
+}
+
+ReferenceScene::ReferenceScene(VulkanDevice &device, VkRenderPass renderPass, const ReferenceSceneDesc &desc) :
+    m_Device{ device }
+{
+    if (desc.gltfPath.empty())
+    {
+        BuildProceduralScene(desc);
+    }
+    else
+    {
+        GltfImporter importer{ *g_WorkerThreadPool };
+        if (!importer.Import(desc.gltfPath, m_Scene))
+        {
+            LOGE("Failed to import reference scene {}", desc.gltfPath);
+            return;
+        }
+    }
+
+    m_Scene.UpdateTransforms();
+
+    BuildGpuScene();
+    if (m_GpuScene.GetInstances().empty())
+    {
+        LOGE("Reference scene has nothing to draw");
+        return;
+    }
+
+    m_VulkanGpuScene = std::make_unique<VulkanGpuScene>(m_Device, m_GpuScene);
+
+    CreatePipeline(renderPass);
+}
+
+ReferenceScene::~ReferenceScene()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    if (m_Pipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, m_Pipeline, nullptr);
+        vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+    }
+}
+
+bool ReferenceScene::IsLoaded() const
+{
+    return m_Pipeline != VK_NULL_HANDLE;
+}
+
+void ReferenceScene::BuildProceduralScene(const ReferenceSceneDesc &desc)
+{
+    std::mt19937 random{ 1 };
+
+    // A few tessellation levels, so the vertex and raster load isn't one repeated draw.
+    uint32_t meshCount = 4;
+    for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+    {
+        m_Scene.AddMesh(CreateTerrainTile(std::max(desc.gridCells >> mesh, 2u), 6.0f + 4.0f * static_cast<float>(mesh)));
+    }
+
+    for (uint32_t index = 0; index < desc.objectCount; ++index)
+    {
+        GameObject &gameObject = m_Scene.CreateGameObject("Tile");
+        gameObject.AddComponent<MeshRenderer>(index % meshCount);
+
+        Transform &transform = *gameObject.GetComponent<Transform>();
+        transform.SetTranslation({ (NextFloat(random) - 0.5f) * desc.extent, NextFloat(random) * 8.0f, (NextFloat(random) - 0.5f) * desc.extent });
+        transform.SetRotation(glm::angleAxis(NextFloat(random) * 6.2831853f, glm::vec3{ 0.0f, 1.0f, 0.0f }));
+        transform.SetScale(glm::vec3{ 2.0f + NextFloat(random) * 6.0f });
+    }
+}
+
+void ReferenceScene::BuildGpuScene()
+{
+    const std::vector<std::unique_ptr<Mesh>> &meshes = m_Scene.GetMeshes();
+
+    // Every mesh goes into one vertex and one index buffer, geometries record where.
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> firstGeometries(meshes.size());
+
+    for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        const Mesh &mesh = *meshes[meshIndex];
+
+        uint32_t firstIndex = static_cast<uint32_t>(indices.size());
+        int32_t vertexOffset = static_cast<int32_t>(positions.size());
+
+        positions.insert(positions.end(), mesh.GetPositions().begin(), mesh.GetPositions().end());
+        indices.insert(indices.end(), mesh.GetIndices().begin(), mesh.GetIndices().end());
+
+        firstGeometries[meshIndex] = static_cast<uint32_t>(m_GpuScene.GetGeometries().size());
+        for (uint32_t subMesh = 0; subMesh < mesh.GetSubMeshes().size(); ++subMesh)
+        {
+            m_GpuScene.AddGeometry(mesh, subMesh, firstIndex, vertexOffset);
+        }
+    }
+
+    uint32_t objectId = 0;
+    for (const std::unique_ptr<GameObject> &gameObject : m_Scene.GetGameObjects())
+    {
+        MeshRenderer *renderer = gameObject->GetComponent<MeshRenderer>();
+        if (renderer == nullptr || renderer->GetMeshIndex() >= meshes.size())
+        {
+            continue;
+        }
+
+        uint32_t meshIndex = renderer->GetMeshIndex();
+        const glm::mat4 &world = gameObject->GetComponent<Transform>()->GetWorldMatrix();
+
+        for (uint32_t subMesh = 0; subMesh < meshes[meshIndex]->GetSubMeshes().size(); ++subMesh)
+        {
+            m_GpuScene.AddInstance(firstGeometries[meshIndex] + subMesh, 0, world, objectId);
+        }
+        ++objectId;
+    }
+
+    if (positions.empty() || indices.empty())
+    {
+        return;
+    }
+
+    VkDeviceSize vertexSize = positions.size() * sizeof(glm::vec3);
+    m_VertexBuffer = std::make_unique<VulkanBuffer>(m_Device, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_VertexBuffer->Update(positions.data(), vertexSize);
+
+    VkDeviceSize indexSize = indices.size() * sizeof(uint32_t);
+    m_IndexBuffer = std::make_unique<VulkanBuffer>(m_Device, indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_IndexBuffer->Update(indices.data(), indexSize);
+}
+
+void ReferenceScene::CreatePipeline(VkRenderPass renderPass)
+{
+    VkDevice device = m_Device.GetHandle();
+
+    std::string vertexSource{ g_ReferenceVertexShader };
+    std::string fragmentSource{ g_ReferenceFragmentShader };
+    m_VertexShader = std::make_unique<VulkanShader>(m_Device, VertexShader, "main", std::vector<uint8_t>{ vertexSource.begin(), vertexSource.end() }, std::vector<std::string>{});
+    m_FragmentShader = std::make_unique<VulkanShader>(m_Device, FragmentShader, "main", std::vector<uint8_t>{ fragmentSource.begin(), fragmentSource.end() }, std::vector<std::string>{});
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    setLayoutInfo.bindingCount = 1;
+    setLayoutInfo.pBindings = &binding;
+    VK_CHECK(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &m_DescriptorSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(glm::mat4);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+    VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocateInfo.descriptorPool = m_DescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+    VK_CHECK(vkAllocateDescriptorSets(device, &allocateInfo, &m_DescriptorSet));
+
+    VkDescriptorBufferInfo instanceBufferInfo{ m_VulkanGpuScene->GetInstanceBuffer().GetHandle(), 0, VK_WHOLE_SIZE };
+
+    VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = m_DescriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &instanceBufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+    VkPipelineShaderStageCreateInfo stages[2]{};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = m_VertexShader->GetHandle();
+    stages[0].pName = m_VertexShader->GetEntryPoint().c_str();
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = m_FragmentShader->GetHandle();
+    stages[1].pName = m_FragmentShader->GetEntryPoint().c_str();
+
+    VkVertexInputBindingDescription vertexBinding{ 0, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX };
+    VkVertexInputAttributeDescription positionAttribute{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 };
+
+    VkPipelineVertexInputStateCreateInfo vertexInput{ VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+    vertexInput.vertexBindingDescriptionCount = 1;
+    vertexInput.pVertexBindingDescriptions = &vertexBinding;
+    vertexInput.vertexAttributeDescriptionCount = 1;
+    vertexInput.pVertexAttributeDescriptions = &positionAttribute;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{ VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{ VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    // Terrain tiles are single sided surfaces seen from both sides.
+    VkPipelineRasterizationStateCreateInfo rasterization{ VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = VK_CULL_MODE_NONE;
+    rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterization.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample{ VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{ VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineColorBlendAttachmentState blendAttachment{};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlend{ VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+    colorBlend.attachmentCount = 1;
+    colorBlend.pAttachments = &blendAttachment;
+
+    VkDynamicState dynamicStates[2]{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    VkPipelineDynamicStateCreateInfo dynamicState{ VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterization;
+    pipelineInfo.pMultisampleState = &multisample;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlend;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = m_PipelineLayout;
+    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.subpass = 0;
+    VK_CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_Pipeline));
+}
+
+void ReferenceScene::Cull(VkCommandBuffer commandBuffer, const GpuCullParams &params)
+{
+    assert(IsLoaded());
+    m_VulkanGpuScene->Upload(commandBuffer, m_GpuScene);
+    m_VulkanGpuScene->Cull(commandBuffer, params);
+}
+
+void ReferenceScene::Draw(VkCommandBuffer commandBuffer, const glm::mat4 &viewProjection)
+{
+    assert(IsLoaded());
+
+    VkBuffer vertexBuffer = m_VertexBuffer->GetHandle();
+    VkDeviceSize vertexOffset = 0;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &viewProjection);
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &vertexOffset);
+    vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer->GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+
+    for (uint32_t pipeline = 0; pipeline < m_VulkanGpuScene->GetPipelineCount(); ++pipeline)
+    {
+        m_VulkanGpuScene->Draw(commandBuffer, pipeline);
+    }
+}
+
+uint32_t ReferenceScene::GetInstanceCount() const
+{
+    return static_cast<uint32_t>(m_GpuScene.GetInstances().size());
+}
+
+uint32_t ReferenceScene::GetGeometryCount() const
+{
+    return static_cast<uint32_t>(m_GpuScene.GetGeometries().size());
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Render/GpuScene.h"
+#include "Scene/Scene.h"
+#include <memory>
+#include <string>
+#include <glm/glm.hpp>
+#include <volk.h>
+
+class VulkanDevice;
+
+class VulkanBuffer;
+
+class VulkanGpuScene;
+
+class VulkanShader;
+
+struct ReferenceSceneDesc
+{
+    // A .gltf or .glb file, empty builds the procedural scene below.
+    std::string gltfPath;
+
+    // Procedural scene: displaced grid tiles scattered over a square of the given size.
+    uint32_t objectCount{ 4096 };
+
+    uint32_t gridCells{ 16 };
+
+    float extent{ 400.0f };
+};
+
+// Fixed content for the frame regression harness, drawn GPU driven through VulkanGpuScene with a
+// flat shaded pipeline. The procedural scene comes from a fixed seed, so every run draws the same.
+class ReferenceScene : public NonCopyable
+{
+public:
+
+    ReferenceScene(VulkanDevice &device, VkRenderPass renderPass, const ReferenceSceneDesc &desc);
+
+    ~ReferenceScene();
+
+    // False when the glTF file failed to import or holds no meshes.
+    bool IsLoaded() const;
+
+    // Uploads the instances the first time, then culls. Recorded outside the render pass.
+    void Cull(VkCommandBuffer commandBuffer, const GpuCullParams &params);
+
+    // Recorded inside renderPass, with dynamic viewport and scissor already set.
+    void Draw(VkCommandBuffer commandBuffer, const glm::mat4 &viewProjection);
+
+    uint32_t GetInstanceCount() const;
+
+    uint32_t GetGeometryCount() const;
+
+private:
+
+    void BuildProceduralScene(const ReferenceSceneDesc &desc);
+
+    void BuildGpuScene();
+
+    void CreatePipeline(VkRenderPass renderPass);
+
+    VulkanDevice &m_Device;
+
+    Scene m_Scene;
+
+    GpuScene m_GpuScene;
+
+    std::unique_ptr<VulkanBuffer> m_VertexBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_IndexBuffer;
+
+    std::unique_ptr<VulkanGpuScene> m_VulkanGpuScene;
+
+    std::unique_ptr<VulkanShader> m_VertexShader;
+
+    std::unique_ptr<VulkanShader> m_FragmentShader;
+
+    VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+
+    VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+
+    VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+
+    VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+
+    VkPipeline m_Pipeline{ VK_NULL_HANDLE };
+};
@@ -0,0 +1,226 @@
+#include "RegressionReport.h"
+#include "Common/Json.h"
+#include "Common/Logging.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <spdlog/fmt/fmt.h>
+
+static constexpr uint32_t g_ObjectTypeCount = static_cast<uint32_t>(VulkanObjectType::Count);
+
+static void AppendStatistics(fmt::memory_buffer &buffer, const char *name, const FrameStatistics &statistics)
+{
+    fmt::format_to(std::back_inserter(buffer), "  \"{}\": {{ \"samples\": {}, \"mean\": {:.6f}, \"p50\": {:.6f}, \"p95\": {:.6f}, \"p99\": {:.6f}, \"max\": {:.6f} }},\n",
+        name, statistics.sampleCount, statistics.mean, statistics.p50, statistics.p95, statistics.p99, statistics.max);
+}
+
+static void AppendString(fmt::memory_buffer &buffer, const std::string &value)
+{
+    buffer.push_back('"');
+    for (char character : value)
+    {
+        if (character == '"' || character == '\\')
+        {
+            buffer.push_back('\\');
+        }
+        if (static_cast<unsigned char>(character) >= 0x20)
+        {
+            buffer.push_back(character);
+        }
+    }
+    buffer.push_back('"');
+}
+
+static FrameStatistics ReadStatistics(const JsonValue &value)
+{
+    FrameStatistics statistics{};
+    statistics.sampleCount = static_cast<uint32_t>(value["samples"].AsInt());
+    statistics.mean = value["mean"].AsNumber();
+    statistics.p50 = value["p50"].AsNumber();
+    statistics.p95 = value["p95"].AsNumber();
+    statistics.p99 = value["p99"].AsNumber();
+    statistics.max = value["max"].AsNumber();
+    return statistics;
+}
+
+static bool CheckTimes(const char *name, const FrameStatistics &result, const FrameStatistics &baseline, double tolerance)
+{
+    if (result.sampleCount == 0 || baseline.sampleCount == 0)
+    {
+        LOGW("{}: no samples to compare, skipped", name);
+        return true;
+    }
+
+    bool passed = true;
+
+    const char *percentileNames[3]{ "p50", "p95", "p99" };
+    double results[3]{ result.p50, result.p95, result.p99 };
+    double baselines[3]{ baseline.p50, baseline.p95, baseline.p99 };
+
+    for (uint32_t index = 0; index < 3; ++index)
+    {
+        double limit = baselines[index] * (1.0 + tolerance);
+        if (results[index] > limit)
+        {
+            LOGE("{} {}: {:.3f} ms, baseline {:.3f} ms, limit {:.3f} ms  REGRESSED", name, percentileNames[index], results[index], baselines[index], limit);
+            passed = false;
+        }
+        else
+        {
+            LOGI("{} {}: {:.3f} ms, baseline {:.3f} ms, limit {:.3f} ms", name, percentileNames[index], results[index], baselines[index], limit);
+        }
+    }
+
+    return passed;
+}
+
+static bool CheckCount(const char *name, double result, double baseline, double tolerance)
+{
+    double limit = baseline + tolerance;
+    if (result > limit)
+    {
+        LOGE("{}: {}, baseline {}, limit {}  REGRESSED", name, result, baseline, limit);
+        return false;
+    }
+
+    LOGI("{}: {}, baseline {}, limit {}", name, result, baseline, limit);
+    return true;
+}
+
+namespace RegressionReport
+{
+    std::string ToJson(const RegressionResult &result)
+    {
+        fmt::memory_buffer buffer;
+
+        buffer.append(fmt::string_view{ "{\n  \"script\": " });
+        AppendString(buffer, result.script);
+        buffer.append(fmt::string_view{ ",\n  \"device\": " });
+        AppendString(buffer, result.device);
+        fmt::format_to(std::back_inserter(buffer), ",\n  \"frames\": {},\n  \"width\": {},\n  \"height\": {},\n", result.frameCount, result.width, result.height);
+
+        AppendStatistics(buffer, "cpuFrameMs", result.cpuFrameMs);
+        AppendStatistics(buffer, "gpuFrameMs", result.gpuFrameMs);
+        AppendStatistics(buffer, "allocationsPerFrame", result.allocationsPerFrame);
+
+        fmt::format_to(std::back_inserter(buffer), "  \"vulkanObjects\": {{\n    \"liveTotal\": {},\n    \"created\": {},\n    \"live\": {{",
+            result.vulkanObjects.GetLiveTotal(), result.vulkanObjectsCreated);
+        for (uint32_t type = 0; type < g_ObjectTypeCount; ++type)
+        {
+            fmt::format_to(std::back_inserter(buffer), "{} \"{}\": {}", type > 0 ? "," : "", VulkanObjectTracker::GetTypeName(static_cast<VulkanObjectType>(type)),
+                result.vulkanObjects.live[type]);
+        }
+        buffer.append(fmt::string_view{ " }\n  }\n}\n" });
+
+        return fmt::to_string(buffer);
+    }
+
+    bool Write(const RegressionResult &result, const std::string &path)
+    {
+        // The first baseline of a script usually goes into a directory that doesn't exist yet.
+        std::filesystem::path directory = std::filesystem::path{ path }.parent_path();
+        std::error_code error;
+        if (!directory.empty())
+        {
+            std::filesystem::create_directories(directory, error);
+        }
+
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        if (!file)
+        {
+            LOGE("Couldn't open {} for writing", path);
+            return false;
+        }
+
+        std::string json = ToJson(result);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+
+        if (!file)
+        {
+            LOGE("Couldn't write results {}", path);
+            return false;
+        }
+        return true;
+    }
+
+    bool ReadBaseline(const std::string &path, RegressionResult &baseline)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        if (!file)
+        {
+            LOGE("Couldn't open baseline {}", path);
+            return false;
+        }
+
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string text = stream.str();
+
+        JsonValue root;
+        std::string error;
+        if (!JsonValue::Parse(text.data(), text.size(), root, &error))
+        {
+            LOGE("Baseline {} is not valid JSON: {}", path, error);
+            return false;
+        }
+
+        baseline.script = root["script"].IsString() ? root["script"].AsString() : std::string{};
+        baseline.device = root["device"].IsString() ? root["device"].AsString() : std::string{};
+        baseline.frameCount = static_cast<uint32_t>(root["frames"].AsInt());
+        baseline.width = static_cast<uint32_t>(root["width"].AsInt());
+        baseline.height = static_cast<uint32_t>(root["height"].AsInt());
+        baseline.cpuFrameMs = ReadStatistics(root["cpuFrameMs"]);
+        baseline.gpuFrameMs = ReadStatistics(root["gpuFrameMs"]);
+        baseline.allocationsPerFrame = ReadStatistics(root["allocationsPerFrame"]);
+
+        const JsonValue &objects = root["vulkanObjects"];
+        baseline.vulkanObjectsCreated = static_cast<uint64_t>(objects["created"].AsInt());
+        for (uint32_t type = 0; type < g_ObjectTypeCount; ++type)
+        {
+            baseline.vulkanObjects.live[type] = static_cast<uint64_t>(objects["live"][VulkanObjectTracker::GetTypeName(static_cast<VulkanObjectType>(type))].AsInt());
+        }
+
+        return true;
+    }
+
+    bool Compare(const RegressionResult &result, const RegressionResult &baseline, const RegressionTolerances &tolerances)
+    {
+        // Different content or resolution makes every number incomparable.
+        if (result.frameCount != baseline.frameCount || result.width != baseline.width || result.height != baseline.height)
+        {
+            LOGE("Baseline was recorded with {} frames at {}x{}, this run has {} frames at {}x{}", baseline.frameCount, baseline.width, baseline.height,
+                result.frameCount, result.width, result.height);
+            return false;
+        }
+
+        if (result.device != baseline.device)
+        {
+            LOGW("Baseline was recorded on {}, this run uses {}", baseline.device, result.device);
+        }
+
+        bool passed = true;
+        passed &= CheckTimes("CPU frame", result.cpuFrameMs, baseline.cpuFrameMs, tolerances.cpuFrameTime);
+        passed &= CheckTimes("GPU frame", result.gpuFrameMs, baseline.gpuFrameMs, tolerances.gpuFrameTime);
+        passed &= CheckCount("Allocations per frame, mean", result.allocationsPerFrame.mean, baseline.allocationsPerFrame.mean, tolerances.allocationsPerFrame);
+        passed &= CheckCount("Allocations per frame, max", result.allocationsPerFrame.max, baseline.allocationsPerFrame.max, tolerances.allocationsPerFrame);
+
+        double objectTolerance = static_cast<double>(tolerances.vulkanObjects);
+        passed &= CheckCount("Vulkan objects created", static_cast<double>(result.vulkanObjectsCreated), static_cast<double>(baseline.vulkanObjectsCreated), objectTolerance);
+
+        if (!CheckCount("Vulkan objects alive", static_cast<double>(result.vulkanObjects.GetLiveTotal()), static_cast<double>(baseline.vulkanObjects.GetLiveTotal()), objectTolerance))
+        {
+            for (uint32_t type = 0; type < g_ObjectTypeCount; ++type)
+            {
+                if (result.vulkanObjects.live[type] != baseline.vulkanObjects.live[type])
+                {
+                    LOGE("  {}: {}, baseline {}", VulkanObjectTracker::GetTypeName(static_cast<VulkanObjectType>(type)), result.vulkanObjects.live[type],
+                        baseline.vulkanObjects.live[type]);
+                }
+            }
+            passed = false;
+        }
+
+        return passed;
+    }
+}
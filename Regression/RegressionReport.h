@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Gfx/Vulkan/VulkanObjectTracker.h"
+#include "Profiling/FrameStatistics.h"
+#include <cstdint>
+#include <string>
+
+struct RegressionTolerances
+{
+    // Relative, 0.1 lets a percentile be 10% slower than the baseline. Faster never fails.
+    double cpuFrameTime{ 0.15 };
+
+    double gpuFrameTime{ 0.15 };
+
+    // Absolute, on the mean and the worst frame.
+    double allocationsPerFrame{ 0.0 };
+
+    // Absolute, on the objects alive at the end and the objects created during the measured frames.
+    uint64_t vulkanObjects{ 0 };
+};
+
+struct RegressionResult
+{
+    std::string script;
+
+    std::string device;
+
+    uint32_t frameCount{ 0 };
+
+    uint32_t width{ 0 };
+
+    uint32_t height{ 0 };
+
+    // Milliseconds from BeginFrame() to EndFrame() return, including waits for a free offscreen slot.
+    FrameStatistics cpuFrameMs;
+
+    // Milliseconds of the whole GPU frame, no samples without the GPU profiler.
+    FrameStatistics gpuFrameMs;
+
+    // operator new calls between BeginFrame() and EndFrame() return.
+    FrameStatistics allocationsPerFrame;
+
+    // Alive after the last measured frame.
+    VulkanObjectCounts vulkanObjects;
+
+    // Created during the measured frames, steady state rendering should create none.
+    uint64_t vulkanObjectsCreated{ 0 };
+};
+
+// Results are written as JSON, and a previous result file is the baseline of the next run.
+namespace RegressionReport
+{
+    std::string ToJson(const RegressionResult &result);
+
+    bool Write(const RegressionResult &result, const std::string &path);
+
+    bool ReadBaseline(const std::string &path, RegressionResult &baseline);
+
+    // Logs every check against the baseline. Returns false when any of them regressed.
+    bool Compare(const RegressionResult &result, const RegressionResult &baseline, const RegressionTolerances &tolerances);
+}
@@ -0,0 +1,82 @@
+#include "RegressionScript.h"
+#include "Common/Json.h"
+#include "Common/Logging.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+bool RegressionScript::Load(const std::string &path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    if (!file)
+    {
+        LOGE("Couldn't open regression script {}", path);
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string text = stream.str();
+
+    JsonValue root;
+    std::string error;
+    if (!JsonValue::Parse(text.data(), text.size(), root, &error))
+    {
+        LOGE("Regression script {} is not valid JSON: {}", path, error);
+        return false;
+    }
+
+    std::filesystem::path scriptPath{ path };
+    name = root["name"].IsString() ? root["name"].AsString() : scriptPath.stem().string();
+
+    const JsonValue &sceneValue = root["scene"];
+    if (sceneValue["gltf"].IsString())
+    {
+        std::filesystem::path gltfPath{ sceneValue["gltf"].AsString() };
+        scene.gltfPath = gltfPath.is_absolute() ? gltfPath.string() : (scriptPath.parent_path() / gltfPath).string();
+    }
+    scene.objectCount = static_cast<uint32_t>(sceneValue["objects"].AsInt(scene.objectCount));
+    scene.gridCells = static_cast<uint32_t>(sceneValue["gridCells"].AsInt(scene.gridCells));
+    scene.extent = static_cast<float>(sceneValue["extent"].AsNumber(scene.extent));
+
+    width = static_cast<uint32_t>(root["width"].AsInt(width));
+    height = static_cast<uint32_t>(root["height"].AsInt(height));
+    warmupFrames = static_cast<uint32_t>(root["warmupFrames"].AsInt(warmupFrames));
+    frameCount = static_cast<uint32_t>(root["frames"].AsInt(frameCount));
+    timeStep = static_cast<float>(root["timeStep"].AsNumber(timeStep));
+
+    const JsonValue &cameraValue = root["camera"];
+    fieldOfView = static_cast<float>(cameraValue["fov"].AsNumber(fieldOfView));
+    nearPlane = static_cast<float>(cameraValue["near"].AsNumber(nearPlane));
+    farPlane = static_cast<float>(cameraValue["far"].AsNumber(farPlane));
+
+    if (!camera.Load(cameraValue["keyframes"]) || camera.GetKeyframes().empty())
+    {
+        LOGE("Regression script {} has no usable camera keyframes", path);
+        return false;
+    }
+
+    const JsonValue &toleranceValue = root["tolerances"];
+    tolerances.cpuFrameTime = toleranceValue["cpuFrameTime"].AsNumber(tolerances.cpuFrameTime);
+    tolerances.gpuFrameTime = toleranceValue["gpuFrameTime"].AsNumber(tolerances.gpuFrameTime);
+    tolerances.allocationsPerFrame = toleranceValue["allocationsPerFrame"].AsNumber(tolerances.allocationsPerFrame);
+    tolerances.vulkanObjects = static_cast<uint64_t>(toleranceValue["vulkanObjects"].AsInt(static_cast<int64_t>(tolerances.vulkanObjects)));
+
+    if (width == 0 || height == 0 || frameCount == 0)
+    {
+        LOGE("Regression script {} needs a non-empty resolution and frame count", path);
+        return false;
+    }
+
+    if (timeStep <= 0.0f)
+    {
+        timeStep = frameCount > 1 ? camera.GetDuration() / static_cast<float>(frameCount - 1) : 0.0f;
+    }
+
+    return true;
+}
+
+float RegressionScript::GetFrameTime(uint32_t frame) const
+{
+    return frame < warmupFrames ? 0.0f : static_cast<float>(frame - warmupFrames) * timeStep;
+}
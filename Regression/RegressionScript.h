@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "ReferenceScene.h"
+#include "RegressionReport.h"
+#include "Render/CameraPath.h"
+#include <string>
+
+// One regression run: the scene, the camera flight over it and how much the results may drift from
+// the baseline. See Scripts/ for the format.
+struct RegressionScript : public NonCopyable
+{
+    // A relative glTF path is resolved against the script's directory.
+    bool Load(const std::string &path);
+
+    // Camera time of a frame. Warm-up frames hold the first pose, the measured frames fly the path.
+    float GetFrameTime(uint32_t frame) const;
+
+    std::string name;
+
+    ReferenceSceneDesc scene{};
+
+    uint32_t width{ 640 };
+
+    uint32_t height{ 360 };
+
+    // Rendered before measuring, so pipeline creation and first use costs stay out of the numbers.
+    uint32_t warmupFrames{ 30 };
+
+    uint32_t frameCount{ 300 };
+
+    // Seconds of camera time per frame, 0 spreads the measured frames over the whole path.
+    float timeStep{ 0.0f };
+
+    // Vertical, in degrees.
+    float fieldOfView{ 60.0f };
+
+    float nearPlane{ 0.1f };
+
+    float farPlane{ 2000.0f };
+
+    CameraPath camera;
+
+    RegressionTolerances tolerances{};
+};
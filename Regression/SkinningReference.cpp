@@ -0,0 +1,196 @@
+// Skinning reference test. Skins a random mesh of 1001 vertices, one AVX2 block short of a multiple of
+// eight, with linear blend and dual quaternion skinning through the AVX2 and the scalar kernels, with
+// and without normals. Fails when a position or normal of the AVX2 kernels differs from the scalar one
+// beyond rounding, or when a kernel writes past the last vertex. Skipped on CPUs without AVX2. Needs no
+// GPU.
+//
+//   NextRenderSkinningReference [--vertices <count>]
+
+#include "Animation/Skinning.h"
+#include "Common/Logging.h"
+#include "Render/Mesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t g_JointCount = 24;
+
+// Relative difference that counts as rounding, the kernels sum in a different order.
+static constexpr float g_Tolerance = 1e-4f;
+
+// Written past the last vertex, a kernel storing a whole block over it fails the test.
+static const glm::vec3 g_Sentinel{ 1234.5f, -678.25f, 91.125f };
+
+// Rotation about a random axis by a random angle with translation, scaled for linear blending only.
+static SkinMatrix CreateSkinMatrix(std::mt19937 &random, float scale)
+{
+    std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+    glm::vec3 axis{ unit(random), unit(random), unit(random) };
+    axis = glm::length(axis) > 1e-3f ? glm::normalize(axis) : glm::vec3{ 0.0f, 1.0f, 0.0f };
+    float angle = unit(random) * 3.14159265f;
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    float t = 1.0f - c;
+
+    // Rodrigues' rotation formula.
+    float rotation[3][3]{
+        { t * axis.x * axis.x + c, t * axis.x * axis.y - s * axis.z, t * axis.x * axis.z + s * axis.y },
+        { t * axis.x * axis.y + s * axis.z, t * axis.y * axis.y + c, t * axis.y * axis.z - s * axis.x },
+        { t * axis.x * axis.z - s * axis.y, t * axis.y * axis.z + s * axis.x, t * axis.z * axis.z + c } };
+
+    SkinMatrix matrix{};
+    for (uint32_t row = 0; row < 3; ++row)
+    {
+        matrix.rows[row] = glm::vec4{ rotation[row][0] * scale, rotation[row][1] * scale, rotation[row][2] * scale, unit(random) * 4.0f };
+    }
+    return matrix;
+}
+
+static void CreateMesh(uint32_t vertexCount, bool withNormals, std::mt19937 &random, Mesh &mesh, std::vector<JointInfluence> &influences)
+{
+    std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+    std::uniform_int_distribution<uint32_t> joint{ 0, g_JointCount - 1 };
+    std::uniform_int_distribution<uint32_t> influenceCount{ 1, MaxJointInfluences };
+
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        mesh.GetPositions().push_back(glm::vec3{ unit(random), unit(random), unit(random) } * 2.0f);
+        if (withNormals)
+        {
+            glm::vec3 normal{ unit(random), unit(random), unit(random) };
+            mesh.GetNormals().push_back(glm::length(normal) > 1e-3f ? glm::normalize(normal) : glm::vec3{ 0.0f, 0.0f, 1.0f });
+        }
+
+        // Weights left unnormalised, SkinnedMesh rescales them the way it does for exported meshes.
+        JointInfluence influence{};
+        uint32_t count = influenceCount(random);
+        for (uint32_t slot = 0; slot < count; ++slot)
+        {
+            influence.joints[slot] = static_cast<uint16_t>(joint(random));
+            influence.weights[slot] = 0.05f + (unit(random) + 1.0f) * 0.5f;
+        }
+        influences.push_back(influence);
+    }
+}
+
+// Returns the number of vertices differing between the kernels, or the vertex count when the tail was overwritten.
+static uint32_t Compare(const std::vector<glm::vec3> &simd, const std::vector<glm::vec3> &scalar, uint32_t vertexCount, float &maxError)
+{
+    for (size_t vertex = vertexCount; vertex < simd.size(); ++vertex)
+    {
+        if (simd[vertex].x != g_Sentinel.x || simd[vertex].y != g_Sentinel.y || simd[vertex].z != g_Sentinel.z ||
+            scalar[vertex].x != g_Sentinel.x || scalar[vertex].y != g_Sentinel.y || scalar[vertex].z != g_Sentinel.z)
+        {
+            LOGE("Vertex {} past the end of the mesh was written", vertex);
+            return vertexCount;
+        }
+    }
+
+    uint32_t mismatchCount = 0;
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        float error = glm::length(simd[vertex] - scalar[vertex]);
+        maxError = std::max(maxError, error);
+        if (!(error <= g_Tolerance * (1.0f + glm::length(scalar[vertex]))))
+        {
+            if (mismatchCount == 0)
+            {
+                LOGE("Vertex {}: AVX2 ({}, {}, {}), scalar ({}, {}, {})", vertex, simd[vertex].x, simd[vertex].y, simd[vertex].z, scalar[vertex].x,
+                    scalar[vertex].y, scalar[vertex].z);
+            }
+            ++mismatchCount;
+        }
+    }
+    return mismatchCount;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t vertexCount = 1001;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--vertices") == 0 && index + 1 < argc)
+        {
+            vertexCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!Skinning::IsAvx2Supported())
+    {
+        LOGW("CPU without AVX2, the scalar kernels have nothing to be compared with");
+        return EXIT_SUCCESS;
+    }
+
+    std::mt19937 random{ 31 };
+    std::uniform_real_distribution<float> scale{ 0.8f, 1.25f };
+
+    std::vector<SkinMatrix> scaledMatrices;
+    std::vector<SkinMatrix> rigidMatrices;
+    for (uint32_t joint = 0; joint < g_JointCount; ++joint)
+    {
+        scaledMatrices.push_back(CreateSkinMatrix(random, scale(random)));
+        rigidMatrices.push_back(CreateSkinMatrix(random, 1.0f));
+    }
+
+    std::vector<DualQuaternion> dualQuaternions(g_JointCount);
+    Skinning::ComputeDualQuaternions(rigidMatrices.data(), g_JointCount, dualQuaternions.data());
+
+    bool passed = true;
+    for (bool withNormals : { true, false })
+    {
+        Mesh mesh{ withNormals ? "WithNormals" : "PositionsOnly" };
+        std::vector<JointInfluence> influences;
+        CreateMesh(vertexCount, withNormals, random, mesh, influences);
+        SkinnedMesh skinnedMesh{ mesh, influences.data() };
+
+        for (SkinningMethod method : { SkinningMethod::LinearBlend, SkinningMethod::DualQuaternion })
+        {
+            // One block of slack past the end for the overwrite check.
+            size_t outputCount = vertexCount + SkinnedMesh::VertexAlignment;
+            std::vector<glm::vec3> positions[2]{ std::vector<glm::vec3>(outputCount, g_Sentinel), std::vector<glm::vec3>(outputCount, g_Sentinel) };
+            std::vector<glm::vec3> normals[2]{ std::vector<glm::vec3>(outputCount, g_Sentinel), std::vector<glm::vec3>(outputCount, g_Sentinel) };
+
+            SkinningKernel kernels[2]{ SkinningKernel::Auto, SkinningKernel::Scalar };
+            for (uint32_t kernel = 0; kernel < 2; ++kernel)
+            {
+                if (method == SkinningMethod::LinearBlend)
+                {
+                    Skinning::SkinLinearBlend(skinnedMesh, scaledMatrices.data(), positions[kernel].data(), normals[kernel].data(), kernels[kernel]);
+                }
+                else
+                {
+                    Skinning::SkinDualQuaternion(skinnedMesh, dualQuaternions.data(), positions[kernel].data(), normals[kernel].data(), kernels[kernel]);
+                }
+            }
+
+            const char *methodName = method == SkinningMethod::LinearBlend ? "Linear blend" : "Dual quaternion";
+            float maxError = 0.0f;
+            uint32_t positionMismatches = Compare(positions[0], positions[1], vertexCount, maxError);
+
+            // Without normals in the mesh neither kernel writes any, the sentinels have to survive.
+            uint32_t normalMismatches = Compare(normals[0], normals[1], withNormals ? vertexCount : 0, maxError);
+
+            LOGI("{}, {}: {} vertices, {} positions and {} normals differ, {:.2e} largest difference", methodName, mesh.GetName(), vertexCount,
+                positionMismatches, normalMismatches, maxError);
+
+            if (positionMismatches > 0 || normalMismatches > 0)
+            {
+                LOGE("{}, {}: the AVX2 kernel differs from the scalar one", methodName, mesh.GetName());
+                passed = false;
+            }
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+// Steady-state allocation test. Runs the CPU side of a frame on the worker pool - pooled jobs,
+// ParallelFor, frame allocator scratch, pmr containers and a RenderQueue sort - and fails when any
+// frame after the warm-up reaches the heap. Needs no GPU.
+//
+//   NextRenderSteadyStateAllocations [--frames <count>]
+
+#include "AllocationCounter.h"
+#include "Common/Logging.h"
+#include "Memory/FrameAllocator.h"
+#include "Memory/LinearArena.h"
+#include "Memory/Memory.h"
+#include "Memory/MemoryResources.h"
+#include "Memory/SmallObjectPool.h"
+#include "Render/RenderQueue.h"
+#include "Thread/ParallelFor.h"
+#include "Thread/ThreadPool.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+static constexpr uint32_t g_DrawCount = 16384;
+
+static constexpr uint32_t g_JobCount = 64;
+
+// Long enough for every thread's pool cache and the depot to settle.
+static constexpr uint32_t g_WarmupFrames = 60;
+
+static void RunFrame(RenderQueue &queue, uint32_t frame)
+{
+    queue.Reset(g_DrawCount, 1000.0f);
+
+    ParallelFor(*g_WorkerThreadPool, g_DrawCount, 512, [&queue, frame](uint32_t begin, uint32_t end)
+    {
+        // Per batch scratch from the frame allocator, freed wholesale by Reset().
+        float *depths = g_FrameAllocator->AllocateArray<float>(end - begin);
+        for (uint32_t index = begin; index < end; ++index)
+        {
+            depths[index - begin] = static_cast<float>((index * 7919u + frame * 31u) % 1000u);
+        }
+
+        for (uint32_t index = begin; index < end; ++index)
+        {
+            DrawItem item{};
+            item.pipelineIndex = static_cast<uint16_t>(index % 3);
+            item.materialIndex = index % 11;
+            item.meshIndex = index % 13;
+            item.depth = depths[index - begin];
+            item.objectId = index;
+            queue.Submit(item);
+        }
+    });
+
+    queue.Sort(*g_WorkerThreadPool);
+    queue.BuildBatches();
+
+    // Small jobs with captures the size of a typical streaming or update callback.
+    std::atomic<uint32_t> pendingJobs{ g_JobCount };
+    std::atomic<uint64_t> checksum{ 0 };
+    for (uint32_t job = 0; job < g_JobCount; ++job)
+    {
+        g_WorkerThreadPool->DispatchThreadJob([&pendingJobs, &checksum, job, frame]()
+        {
+            std::pmr::vector<uint32_t> values{ Memory::GetFrameResource() };
+            for (uint32_t value = 0; value < 32; ++value)
+            {
+                values.push_back(value * job + frame);
+            }
+
+            ArenaScope scratchScope{ Memory::GetThreadScratch() };
+            uint32_t *scratch = Memory::GetThreadScratch().AllocateArray<uint32_t>(values.size());
+            uint64_t sum = 0;
+            for (size_t index = 0; index < values.size(); ++index)
+            {
+                scratch[index] = values[index] ^ job;
+                sum += scratch[index];
+            }
+
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+            pendingJobs.fetch_sub(1, std::memory_order_release);
+        }, "SteadyStateJob");
+    }
+
+    while (pendingJobs.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+
+    g_FrameAllocator->Reset();
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frameCount = 300;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frameCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    g_WorkerThreadPool->Create(0, 0);
+    uint32_t workerCount = g_WorkerThreadPool->GetThreadNum();
+
+    RenderQueue queue;
+    uint32_t allocatingFrames = 0;
+    uint64_t allocations = 0;
+
+    for (uint32_t frame = 0; frame < g_WarmupFrames + frameCount; ++frame)
+    {
+        uint64_t allocationsBefore = AllocationCounter::GetCount();
+        RunFrame(queue, frame);
+        uint64_t allocationsAfter = AllocationCounter::GetCount();
+
+        if (frame >= g_WarmupFrames && allocationsAfter != allocationsBefore)
+        {
+            ++allocatingFrames;
+            allocations += allocationsAfter - allocationsBefore;
+        }
+    }
+
+    g_WorkerThreadPool->Destory();
+
+    LOGI("{} frames on {} workers, {} draws in {} batches, frame allocator peak {} bytes, {} bytes of pool pages",
+        frameCount, workerCount, queue.GetDrawCount(), queue.GetBatches().size(), g_FrameAllocator->GetPeakBytes(),
+        SmallObjectPool::GetReservedBytes());
+    Memory::LogTagStats();
+
+    if (allocatingFrames > 0)
+    {
+        LOGE("{} of {} frames reached the heap, {} allocations in total", allocatingFrames, frameCount, allocations);
+        return EXIT_FAILURE;
+    }
+
+    LOGI("No heap allocations after {} warm-up frames", g_WarmupFrames);
+    return EXIT_SUCCESS;
+}
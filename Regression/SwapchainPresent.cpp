@@ -0,0 +1,168 @@
+// Swapchain presentation test. Creates a VK_EXT_headless_surface surface, presents frames through
+// VulkanGfx, then resizes the swapchain and changes its present mode. Fails when frames stop
+// completing, when an image can't be acquired outside of a recreate, when the resize doesn't
+// recreate the swapchain at the new extent, or when the chosen present mode isn't one the surface
+// supports. Needs a driver with VK_EXT_headless_surface, lavapipe has it.
+//
+//   NextRenderSwapchainPresent [--frames <count>] [--lavapipe]
+
+#include "Common/Logging.h"
+#include "Gfx/Vulkan/VulkanDevice.h"
+#include "Gfx/Vulkan/VulkanGfx.h"
+#include "Gfx/Vulkan/VulkanPhysicalDevice.h"
+#include "Gfx/Vulkan/VulkanSwapchain.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+// Where Debian, Ubuntu and Fedora install the lavapipe ICD manifest.
+static const char *g_LavapipeIcd = "/usr/share/vulkan/icd.d/lvp_icd.x86_64.json";
+#endif
+
+static constexpr VkExtent2D g_InitialExtent{ 64, 48 };
+
+static constexpr VkExtent2D g_ResizedExtent{ 96, 80 };
+
+// Presents frameCount frames, returns how many had no image.
+static uint32_t PresentFrames(VulkanGfx &gfx, uint32_t frameCount)
+{
+    uint32_t skipped = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        gfx.BeginFrame();
+        skipped += gfx.AcquireImage() ? 0 : 1;
+        gfx.EndFrame();
+    }
+    return skipped;
+}
+
+static bool CheckExtent(const VulkanSwapchain &swapchain, VkExtent2D expected)
+{
+    VkExtent2D extent = swapchain.GetExtent();
+    if (extent.width != expected.width || extent.height != expected.height)
+    {
+        LOGE("Swapchain is {}x{}, expected {}x{}", extent.width, extent.height, expected.width, expected.height);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frameCount = 30;
+    bool lavapipe = false;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frameCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else if (strcmp(argv[index], "--lavapipe") == 0)
+        {
+            lavapipe = true;
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (lavapipe)
+    {
+#if !defined(_WIN32)
+        // An explicit driver choice in the environment wins.
+        setenv("VK_DRIVER_FILES", g_LavapipeIcd, 0);
+        setenv("VK_ICD_FILENAMES", g_LavapipeIcd, 0);
+#endif
+    }
+
+    // The headless instance enables the extension when the driver has it.
+    GfxPresentDesc present{};
+    present.extent = g_InitialExtent;
+    present.createSurface = [](VkInstance instance)
+    {
+        VkSurfaceKHR surface = VK_NULL_HANDLE;
+        if (vkCreateHeadlessSurfaceEXT != nullptr)
+        {
+            VkHeadlessSurfaceCreateInfoEXT surfaceInfo{ VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT };
+            vkCreateHeadlessSurfaceEXT(instance, &surfaceInfo, nullptr, &surface);
+        }
+        return surface;
+    };
+
+    VulkanGfx gfx{ "NextRenderSwapchainPresent", std::unordered_map<const char *, bool>{}, std::vector<const char *>{}, true, std::string{}, present };
+    VulkanSwapchain *swapchain = gfx.GetSwapchain();
+    if (swapchain == nullptr)
+    {
+        LOGE("No swapchain on {}, VK_EXT_headless_surface is missing or the device can't present to it",
+            gfx.GetDevice().GetGpu().GetProperties().deviceName);
+        return EXIT_FAILURE;
+    }
+
+    if (!CheckExtent(*swapchain, g_InitialExtent))
+    {
+        return EXIT_FAILURE;
+    }
+
+    uint32_t skipped = PresentFrames(gfx, frameCount);
+    if (skipped > 0)
+    {
+        LOGE("{} of {} frames had no image", skipped, frameCount);
+        return EXIT_FAILURE;
+    }
+
+    // The GPU keeps up to framesInFlight frames, every earlier one must have completed.
+    uint64_t framesInFlight = SwapchainDesc{}.framesInFlight;
+    if (swapchain->GetCompletedFrame() + framesInFlight < swapchain->GetFrameNumber())
+    {
+        LOGE("Only frame {} of {} completed", swapchain->GetCompletedFrame(), swapchain->GetFrameNumber());
+        return EXIT_FAILURE;
+    }
+
+    // Recreated at the next acquire, which this frame skips at most.
+    gfx.Resize(g_ResizedExtent);
+    skipped = PresentFrames(gfx, frameCount);
+    if (skipped > 1 || !CheckExtent(*swapchain, g_ResizedExtent) || swapchain->ComputeStats().recreateCount < 1)
+    {
+        LOGE("Resize recreated the swapchain {} times, {} frames had no image", swapchain->ComputeStats().recreateCount, skipped);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t modeCount = 0;
+    VkPhysicalDevice gpu = gfx.GetDevice().GetGpu().GetHandle();
+    vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, gfx.GetSurface(), &modeCount, nullptr);
+    std::vector<VkPresentModeKHR> supportedModes(modeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, gfx.GetSurface(), &modeCount, supportedModes.data());
+
+    for (VkPresentModeKHR presentMode : { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR })
+    {
+        swapchain->SetPresentMode(presentMode);
+        skipped = PresentFrames(gfx, frameCount);
+        if (skipped > 1)
+        {
+            LOGE("{} frames had no image after switching present modes", skipped);
+            return EXIT_FAILURE;
+        }
+
+        // A supported mode is taken as is, others fall back to one the surface has.
+        bool requestedSupported = std::find(supportedModes.begin(), supportedModes.end(), presentMode) != supportedModes.end();
+        VkPresentModeKHR chosen = swapchain->GetPresentMode();
+        bool chosenSupported = std::find(supportedModes.begin(), supportedModes.end(), chosen) != supportedModes.end();
+        if (!chosenSupported || (requestedSupported && chosen != presentMode))
+        {
+            LOGE("Present mode {} was requested, {} was chosen", static_cast<int>(presentMode), static_cast<int>(chosen));
+            return EXIT_FAILURE;
+        }
+    }
+
+    SwapchainStats stats = swapchain->ComputeStats();
+    LOGI("{} frames presented, {} recreates, {} skipped, median frame {:.3f} ms", swapchain->GetFrameNumber(), stats.recreateCount, stats.skippedFrames,
+        stats.frameSeconds.p50 * 1000.0);
+
+    return EXIT_SUCCESS;
+}
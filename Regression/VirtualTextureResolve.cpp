@@ -0,0 +1,234 @@
+// Virtual texture residency test. Flies a synthetic view over a 64k x 64k virtual texture whose page
+// cache holds 256 pages, resolves the feedback it would write and loads the requested pages with a few
+// frames of latency. Fails when the page table points at a slot that doesn't hold the page (or an
+// ancestor of it) the entry claims, when a request names a resident page or comes out finer before
+// coarser, or when the view doesn't become fully resident once it stops. Needs no GPU or files.
+//
+//   NextRenderVirtualTextureResolve [--frames <count>]
+
+#include "Common/Logging.h"
+#include "Render/VirtualTexture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+static constexpr uint32_t g_FeedbackWidth = 64;
+
+static constexpr uint32_t g_FeedbackHeight = 36;
+
+// Frames between a request and its page arriving.
+static constexpr uint32_t g_LoadLatency = 3;
+
+static constexpr uint32_t g_SettleFrames = 30;
+
+// Feedback of a view looking at a window of the texture, texel density falling off towards the top
+// rows like a tilted camera over terrain. Mirrors the feedback shader: one entry per 8x8 pixel tile.
+static void WriteFeedback(const VirtualTexture &texture, const glm::vec2 &center, float extent, std::vector<uint32_t> &feedback)
+{
+    const VirtualTextureDesc &desc = texture.GetDesc();
+    feedback.resize(g_FeedbackWidth * g_FeedbackHeight);
+
+    for (uint32_t y = 0; y < g_FeedbackHeight; ++y)
+    {
+        float rowScale = 1.0f + 4.0f * static_cast<float>(g_FeedbackHeight - 1 - y) / static_cast<float>(g_FeedbackHeight);
+        float rowExtent = extent * rowScale;
+        float texelsPerPixel = rowExtent * static_cast<float>(desc.width) / static_cast<float>(g_FeedbackWidth * 8);
+        uint32_t mip = static_cast<uint32_t>(std::clamp(std::floor(std::log2(std::max(texelsPerPixel, 1.0f))), 0.0f, static_cast<float>(texture.GetMipCount() - 1)));
+
+        for (uint32_t x = 0; x < g_FeedbackWidth; ++x)
+        {
+            glm::vec2 uv{
+                center.x + (static_cast<float>(x) / g_FeedbackWidth - 0.5f) * rowExtent,
+                center.y + (static_cast<float>(y) / g_FeedbackHeight - 0.5f) * extent * 2.0f };
+
+            // Like the shader, some tiles see no virtual textured surface.
+            feedback[y * g_FeedbackWidth + x] = (x + y) % 17 == 0 ? InvalidVirtualPage : texture.GetPage(uv, mip);
+        }
+    }
+}
+
+static bool CheckPageTable(const VirtualTexture &texture, uint32_t frame)
+{
+    const VirtualTextureDesc &desc = texture.GetDesc();
+
+    for (uint32_t mip = 0; mip < texture.GetMipCount(); ++mip)
+    {
+        for (uint32_t y = 0; y < texture.GetPagesY(mip); ++y)
+        {
+            for (uint32_t x = 0; x < texture.GetPagesX(mip); ++x)
+            {
+                uint32_t entry = texture.GetPageTableEntry(VirtualPage::Pack(mip, x, y));
+                uint32_t mappedMip = VirtualPageEntry::GetMip(entry);
+                uint32_t slot = VirtualPageEntry::GetSlotY(entry) * desc.physicalPagesX + VirtualPageEntry::GetSlotX(entry);
+
+                uint32_t shift = mappedMip - mip;
+                uint32_t expected = VirtualPage::Pack(mappedMip, x >> shift, y >> shift);
+                if (mappedMip < mip || slot >= texture.GetSlotCount() || texture.GetSlotPage(slot) != expected)
+                {
+                    LOGE("Frame {}: page table entry of mip {} page ({}, {}) shows slot {} at mip {}, which holds page {}",
+                        frame, mip, x, y, slot, mappedMip, slot < texture.GetSlotCount() ? texture.GetSlotPage(slot) : InvalidVirtualPage);
+                    return false;
+                }
+
+                // The entry must show the finest resident page covering it.
+                for (uint32_t finer = mip; finer < mappedMip; ++finer)
+                {
+                    if (texture.IsResident(VirtualPage::Pack(finer, x >> (finer - mip), y >> (finer - mip))))
+                    {
+                        LOGE("Frame {}: page table entry of mip {} page ({}, {}) shows mip {} while mip {} is resident", frame, mip, x, y, mappedMip, finer);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool CheckRequests(const VirtualTexture &texture, const std::vector<uint32_t> &requests, uint32_t frame)
+{
+    for (size_t index = 0; index < requests.size(); ++index)
+    {
+        if (texture.IsResident(requests[index]))
+        {
+            LOGE("Frame {}: resident page {} was requested", frame, requests[index]);
+            return false;
+        }
+
+        if (index > 0 && VirtualPage::GetMip(requests[index]) > VirtualPage::GetMip(requests[index - 1]))
+        {
+            LOGE("Frame {}: page {} was requested after the finer page {}", frame, requests[index], requests[index - 1]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frameCount = 600;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frameCount = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else
+        {
+            LOGE("Unknown argument {}", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    VirtualTextureDesc desc{};
+    desc.width = 65536;
+    desc.height = 65536;
+    desc.bytesPerTexel = 1;
+    desc.physicalPagesX = 16;
+    desc.physicalPagesY = 16;
+    desc.maxRequestsPerFrame = 24;
+
+    VirtualTexture texture{ desc, nullptr };
+
+    struct PendingLoad
+    {
+        uint32_t readyFrame;
+
+        uint32_t page;
+    };
+
+    std::deque<PendingLoad> loads;
+    std::unordered_set<uint32_t> loading;
+    std::vector<uint32_t> feedback;
+    std::vector<uint32_t> requests;
+    std::vector<uint32_t> unique;
+    uint64_t totalMapped = 0;
+    uint64_t totalEvicted = 0;
+    uint64_t totalRejected = 0;
+
+    texture.BeginFrame(0);
+    texture.MapPage(VirtualPage::Pack(texture.GetMipCount() - 1, 0, 0), std::vector<uint8_t>(texture.GetPageBytes()));
+
+    for (uint32_t frame = 1; frame <= frameCount + g_SettleFrames; ++frame)
+    {
+        texture.BeginFrame(frame);
+
+        // A figure of eight across the texture, zooming in and out, then standing still.
+        float time = static_cast<float>(std::min(frame, frameCount)) * 0.01f;
+        glm::vec2 center{ 0.5f + 0.35f * std::sin(time), 0.5f + 0.2f * std::sin(time * 2.0f) };
+        float extent = 0.02f + 0.015f * std::sin(time * 0.7f);
+        WriteFeedback(texture, center, extent, feedback);
+
+        // The streamer would remember what is loading, this stands in for it.
+        texture.ResolveFeedback(feedback.data(), static_cast<uint32_t>(feedback.size()), requests);
+        if (!CheckRequests(texture, requests, frame))
+        {
+            return EXIT_FAILURE;
+        }
+
+        while (!loads.empty() && loads.front().readyFrame <= frame)
+        {
+            totalRejected += texture.MapPage(loads.front().page, std::vector<uint8_t>(texture.GetPageBytes())) ? 0 : 1;
+            loading.erase(loads.front().page);
+            loads.pop_front();
+        }
+        totalMapped += texture.GetStats().mappedPages;
+        totalEvicted += texture.GetStats().evictedPages;
+
+        // Requests were resolved before this frame's pages arrived, skip the ones that just did.
+        for (uint32_t page : requests)
+        {
+            if (!texture.IsResident(page) && loading.insert(page).second)
+            {
+                loads.push_back(PendingLoad{ frame + g_LoadLatency, page });
+            }
+        }
+
+        texture.ClearUploads();
+        texture.ClearDirtyRange();
+
+        if ((frame % 25 == 0 || frame == frameCount + g_SettleFrames) && !CheckPageTable(texture, frame))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // After standing still every page the view asks for must be resident.
+    unique.assign(feedback.begin(), feedback.end());
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+    unique.erase(std::remove(unique.begin(), unique.end(), InvalidVirtualPage), unique.end());
+
+    uint32_t missingCount = 0;
+    for (uint32_t page : unique)
+    {
+        if (!texture.IsResident(page))
+        {
+            ++missingCount;
+        }
+    }
+
+    uint64_t virtualBytes = 0;
+    for (uint32_t mip = 0; mip < texture.GetMipCount(); ++mip)
+    {
+        virtualBytes += static_cast<uint64_t>(texture.GetPagesX(mip)) * texture.GetPagesY(mip) * texture.GetPageBytes();
+    }
+
+    LOGI("{} frames, {} mips, {} pages mapped, {} evicted, {} rejected, {} of {} visible pages resident, {} KB of pages for {} MB virtual",
+        frameCount + g_SettleFrames, texture.GetMipCount(), totalMapped, totalEvicted, totalRejected, unique.size() - missingCount, unique.size(),
+        static_cast<uint64_t>(texture.GetSlotCount()) * texture.GetPageBytes() / 1024, virtualBytes >> 20);
+
+    if (missingCount > 0)
+    {
+        LOGE("{} pages of the still view are not resident after {} frames", missingCount, g_SettleFrames);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include "AnimationClip.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+AnimationClip::AnimationClip(const std::string &name, uint32_t jointCount, uint32_t frameCount, float frameRate) :
+    m_Name{ name },
+    m_FrameRate{ frameRate },
+    m_Frames(frameCount)
+{
+    assert(frameCount > 0 && frameRate > 0.0f);
+
+    for (AnimationPose &frame : m_Frames)
+    {
+        frame.Resize(jointCount);
+    }
+}
+
+const std::string &AnimationClip::GetName() const
+{
+    return m_Name;
+}
+
+uint32_t AnimationClip::GetJointCount() const
+{
+    return m_Frames[0].GetJointCount();
+}
+
+uint32_t AnimationClip::GetFrameCount() const
+{
+    return static_cast<uint32_t>(m_Frames.size());
+}
+
+float AnimationClip::GetFrameRate() const
+{
+    return m_FrameRate;
+}
+
+float AnimationClip::GetDuration() const
+{
+    return static_cast<float>(m_Frames.size() - 1) / m_FrameRate;
+}
+
+AnimationPose &AnimationClip::GetFrame(uint32_t frame)
+{
+    assert(frame < m_Frames.size());
+    return m_Frames[frame];
+}
+
+const AnimationPose &AnimationClip::GetFrame(uint32_t frame) const
+{
+    assert(frame < m_Frames.size());
+    return m_Frames[frame];
+}
+
+void AnimationClip::Sample(float time, bool loop, AnimationPose &pose) const
+{
+    assert(pose.GetJointCount() == GetJointCount());
+
+    uint32_t frameCount = GetFrameCount();
+    if (frameCount == 1)
+    {
+        PoseBlend::Lerp(m_Frames[0], m_Frames[0], 0.0f, pose);
+        return;
+    }
+
+    float position = time * m_FrameRate;
+    float lastFrame = static_cast<float>(frameCount - 1);
+    position = loop ? position - std::floor(position / lastFrame) * lastFrame : std::clamp(position, 0.0f, lastFrame);
+
+    uint32_t frame = std::min(static_cast<uint32_t>(position), frameCount - 2);
+    PoseBlend::Lerp(m_Frames[frame], m_Frames[frame + 1], position - static_cast<float>(frame), pose);
+}
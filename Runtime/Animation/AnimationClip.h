@@ -0,0 +1,43 @@
+#pragma once
+
+#include "AnimationPose.h"
+#include "Common/Utils.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Joint animation resampled at a fixed rate, every key frame a full SoA pose. Sampling blends the two
+// surrounding frames, so playback costs the same whatever the source curves looked like.
+class AnimationClip : public NonCopyable
+{
+public:
+
+    // frameCount >= 1 frames of jointCount joints, all at identity.
+    AnimationClip(const std::string &name, uint32_t jointCount, uint32_t frameCount, float frameRate);
+
+    const std::string &GetName() const;
+
+    uint32_t GetJointCount() const;
+
+    uint32_t GetFrameCount() const;
+
+    float GetFrameRate() const;
+
+    // Time of the last frame, a looping clip wraps back to the first one after it.
+    float GetDuration() const;
+
+    AnimationPose &GetFrame(uint32_t frame);
+
+    const AnimationPose &GetFrame(uint32_t frame) const;
+
+    // time is wrapped into the clip when looping and clamped otherwise.
+    void Sample(float time, bool loop, AnimationPose &pose) const;
+
+private:
+
+    std::string m_Name;
+
+    float m_FrameRate{ 30.0f };
+
+    std::vector<AnimationPose> m_Frames;
+};
@@ -0,0 +1,189 @@
+#include "AnimationPose.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POSE_BLEND_SSE 1
+#include <emmintrin.h>
+#endif
+
+void AnimationPose::Resize(uint32_t jointCount)
+{
+    m_JointCount = jointCount;
+    m_PaddedCount = (jointCount + JointAlignment - 1) / JointAlignment * JointAlignment;
+    m_Data.resize(static_cast<size_t>(m_PaddedCount) * PoseStreamCount);
+    SetIdentity();
+}
+
+void AnimationPose::SetIdentity()
+{
+    std::fill(m_Data.begin(), m_Data.end(), 0.0f);
+    for (PoseStream stream : { PoseRotationW, PoseScaleX, PoseScaleY, PoseScaleZ })
+    {
+        std::fill_n(GetStream(stream), m_PaddedCount, 1.0f);
+    }
+}
+
+uint32_t AnimationPose::GetJointCount() const
+{
+    return m_JointCount;
+}
+
+uint32_t AnimationPose::GetPaddedCount() const
+{
+    return m_PaddedCount;
+}
+
+float *AnimationPose::GetStream(PoseStream stream)
+{
+    return m_Data.data() + static_cast<size_t>(stream) * m_PaddedCount;
+}
+
+const float *AnimationPose::GetStream(PoseStream stream) const
+{
+    return m_Data.data() + static_cast<size_t>(stream) * m_PaddedCount;
+}
+
+JointTransform AnimationPose::GetJoint(uint32_t joint) const
+{
+    assert(joint < m_JointCount);
+
+    JointTransform transform{};
+    transform.translation = glm::vec3{ GetStream(PoseTranslationX)[joint], GetStream(PoseTranslationY)[joint], GetStream(PoseTranslationZ)[joint] };
+    transform.rotation = glm::quat{ GetStream(PoseRotationW)[joint], GetStream(PoseRotationX)[joint], GetStream(PoseRotationY)[joint], GetStream(PoseRotationZ)[joint] };
+    transform.scale = glm::vec3{ GetStream(PoseScaleX)[joint], GetStream(PoseScaleY)[joint], GetStream(PoseScaleZ)[joint] };
+    return transform;
+}
+
+void AnimationPose::SetJoint(uint32_t joint, const JointTransform &transform)
+{
+    assert(joint < m_JointCount);
+
+    GetStream(PoseTranslationX)[joint] = transform.translation.x;
+    GetStream(PoseTranslationY)[joint] = transform.translation.y;
+    GetStream(PoseTranslationZ)[joint] = transform.translation.z;
+    GetStream(PoseRotationX)[joint] = transform.rotation.x;
+    GetStream(PoseRotationY)[joint] = transform.rotation.y;
+    GetStream(PoseRotationZ)[joint] = transform.rotation.z;
+    GetStream(PoseRotationW)[joint] = transform.rotation.w;
+    GetStream(PoseScaleX)[joint] = transform.scale.x;
+    GetStream(PoseScaleY)[joint] = transform.scale.y;
+    GetStream(PoseScaleZ)[joint] = transform.scale.z;
+}
+
+namespace PoseBlend
+{
+#if !POSE_BLEND_SSE
+    static void LerpScalar(const AnimationPose &a, const AnimationPose &b, float weight, AnimationPose &out, uint32_t begin, uint32_t end)
+    {
+        for (PoseStream stream : { PoseTranslationX, PoseTranslationY, PoseTranslationZ, PoseScaleX, PoseScaleY, PoseScaleZ })
+        {
+            const float *sourceA = a.GetStream(stream);
+            const float *sourceB = b.GetStream(stream);
+            float *destination = out.GetStream(stream);
+            for (uint32_t joint = begin; joint < end; ++joint)
+            {
+                destination[joint] = sourceA[joint] + (sourceB[joint] - sourceA[joint]) * weight;
+            }
+        }
+
+        for (uint32_t joint = begin; joint < end; ++joint)
+        {
+            float rotationA[4];
+            float rotationB[4];
+            float dot = 0.0f;
+            for (uint32_t component = 0; component < 4; ++component)
+            {
+                rotationA[component] = a.GetStream(static_cast<PoseStream>(PoseRotationX + component))[joint];
+                rotationB[component] = b.GetStream(static_cast<PoseStream>(PoseRotationX + component))[joint];
+                dot += rotationA[component] * rotationB[component];
+            }
+
+            float weightB = dot < 0.0f ? -weight : weight;
+            float blended[4];
+            float lengthSquared = 0.0f;
+            for (uint32_t component = 0; component < 4; ++component)
+            {
+                blended[component] = rotationA[component] * (1.0f - weight) + rotationB[component] * weightB;
+                lengthSquared += blended[component] * blended[component];
+            }
+
+            float inverseLength = 1.0f / std::sqrt(std::max(lengthSquared, 1e-12f));
+            for (uint32_t component = 0; component < 4; ++component)
+            {
+                out.GetStream(static_cast<PoseStream>(PoseRotationX + component))[joint] = blended[component] * inverseLength;
+            }
+        }
+    }
+#endif
+
+    void Lerp(const AnimationPose &a, const AnimationPose &b, float weight, AnimationPose &out)
+    {
+        assert(a.GetJointCount() == b.GetJointCount() && a.GetJointCount() == out.GetJointCount());
+
+        uint32_t count = a.GetPaddedCount();
+
+#if POSE_BLEND_SSE
+        const __m128 weightB = _mm_set1_ps(weight);
+        const __m128 weightA = _mm_set1_ps(1.0f - weight);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 epsilon = _mm_set1_ps(1e-12f);
+
+        for (PoseStream stream : { PoseTranslationX, PoseTranslationY, PoseTranslationZ, PoseScaleX, PoseScaleY, PoseScaleZ })
+        {
+            const float *sourceA = a.GetStream(stream);
+            const float *sourceB = b.GetStream(stream);
+            float *destination = out.GetStream(stream);
+            for (uint32_t joint = 0; joint < count; joint += 4)
+            {
+                __m128 valueA = _mm_loadu_ps(sourceA + joint);
+                __m128 valueB = _mm_loadu_ps(sourceB + joint);
+                _mm_storeu_ps(destination + joint, _mm_add_ps(_mm_mul_ps(valueA, weightA), _mm_mul_ps(valueB, weightB)));
+            }
+        }
+
+        const float *rotationA[4];
+        const float *rotationB[4];
+        float *rotationOut[4];
+        for (uint32_t component = 0; component < 4; ++component)
+        {
+            PoseStream stream = static_cast<PoseStream>(PoseRotationX + component);
+            rotationA[component] = a.GetStream(stream);
+            rotationB[component] = b.GetStream(stream);
+            rotationOut[component] = out.GetStream(stream);
+        }
+
+        // Four joints per iteration: flip b where it lies on the other hemisphere, blend, renormalise.
+        for (uint32_t joint = 0; joint < count; joint += 4)
+        {
+            __m128 ax = _mm_loadu_ps(rotationA[0] + joint);
+            __m128 ay = _mm_loadu_ps(rotationA[1] + joint);
+            __m128 az = _mm_loadu_ps(rotationA[2] + joint);
+            __m128 aw = _mm_loadu_ps(rotationA[3] + joint);
+            __m128 bx = _mm_loadu_ps(rotationB[0] + joint);
+            __m128 by = _mm_loadu_ps(rotationB[1] + joint);
+            __m128 bz = _mm_loadu_ps(rotationB[2] + joint);
+            __m128 bw = _mm_loadu_ps(rotationB[3] + joint);
+
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+            __m128 signedWeight = _mm_xor_ps(weightB, _mm_and_ps(dot, signMask));
+
+            __m128 x = _mm_add_ps(_mm_mul_ps(ax, weightA), _mm_mul_ps(bx, signedWeight));
+            __m128 y = _mm_add_ps(_mm_mul_ps(ay, weightA), _mm_mul_ps(by, signedWeight));
+            __m128 z = _mm_add_ps(_mm_mul_ps(az, weightA), _mm_mul_ps(bz, signedWeight));
+            __m128 w = _mm_add_ps(_mm_mul_ps(aw, weightA), _mm_mul_ps(bw, signedWeight));
+
+            __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+            __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(lengthSquared, epsilon)));
+
+            _mm_storeu_ps(rotationOut[0] + joint, _mm_mul_ps(x, inverseLength));
+            _mm_storeu_ps(rotationOut[1] + joint, _mm_mul_ps(y, inverseLength));
+            _mm_storeu_ps(rotationOut[2] + joint, _mm_mul_ps(z, inverseLength));
+            _mm_storeu_ps(rotationOut[3] + joint, _mm_mul_ps(w, inverseLength));
+        }
+#else
+        LerpScalar(a, b, weight, out, 0, count);
+#endif
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Local transform of one joint relative to its parent.
+struct JointTransform
+{
+    glm::vec3 translation{ 0.0f };
+
+    glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+
+    glm::vec3 scale{ 1.0f };
+};
+
+enum PoseStream
+{
+    PoseTranslationX,
+
+    PoseTranslationY,
+
+    PoseTranslationZ,
+
+    PoseRotationX,
+
+    PoseRotationY,
+
+    PoseRotationZ,
+
+    PoseRotationW,
+
+    PoseScaleX,
+
+    PoseScaleY,
+
+    PoseScaleZ,
+
+    PoseStreamCount,
+};
+
+// Local joint transforms of a skeleton as SoA: one stream per component, each padded to a multiple of
+// eight joints with identity transforms so blending can run a full SIMD register at a time.
+class AnimationPose
+{
+public:
+
+    static constexpr uint32_t JointAlignment = 8;
+
+    // Resets every joint to identity.
+    void Resize(uint32_t jointCount);
+
+    void SetIdentity();
+
+    uint32_t GetJointCount() const;
+
+    // Length of every stream.
+    uint32_t GetPaddedCount() const;
+
+    float *GetStream(PoseStream stream);
+
+    const float *GetStream(PoseStream stream) const;
+
+    JointTransform GetJoint(uint32_t joint) const;
+
+    void SetJoint(uint32_t joint, const JointTransform &transform);
+
+private:
+
+    uint32_t m_JointCount{ 0 };
+
+    uint32_t m_PaddedCount{ 0 };
+
+    std::vector<float> m_Data;
+};
+
+namespace PoseBlend
+{
+    // out = a * (1 - weight) + b * weight per joint, rotations along the shorter arc and renormalised
+    // (nlerp). The poses must have the same joint count; out may be a or b.
+    void Lerp(const AnimationPose &a, const AnimationPose &b, float weight, AnimationPose &out);
+}
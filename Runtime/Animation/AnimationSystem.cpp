@@ -0,0 +1,179 @@
+#include "AnimationSystem.h"
+#include "AnimationClip.h"
+#include "Skeleton.h"
+#include "Memory/LinearArena.h"
+#include "Thread/ParallelFor.h"
+#include <cassert>
+
+// Characters per job, a 100 joint character is roughly 10us of work.
+static constexpr uint32_t CharacterBatchSize = 4;
+
+uint32_t AnimationSystem::AddCharacter(const Skeleton &skeleton, const SkinnedMesh *mesh)
+{
+    assert(mesh == nullptr || mesh->GetMaxJoint() < skeleton.GetJointCount());
+
+    Character character;
+    character.skeleton = &skeleton;
+    character.mesh = mesh;
+    character.jointOffset = static_cast<uint32_t>(m_SkinMatrices.size());
+    character.vertexOffset = static_cast<uint32_t>(m_SkinnedPositions.size());
+    character.pose = skeleton.GetRestPose();
+    character.layerPose = skeleton.GetRestPose();
+
+    m_SkinMatrices.resize(m_SkinMatrices.size() + skeleton.GetJointCount());
+    m_DualQuaternions.resize(m_SkinMatrices.size());
+
+    if (mesh != nullptr)
+    {
+        m_SkinnedPositions.resize(m_SkinnedPositions.size() + mesh->GetVertexCount());
+        m_SkinnedNormals.resize(m_SkinnedPositions.size());
+    }
+
+    m_Characters.push_back(std::move(character));
+    return static_cast<uint32_t>(m_Characters.size() - 1);
+}
+
+void AnimationSystem::SetPlayback(uint32_t character, uint32_t layer, const AnimationPlayback &playback)
+{
+    assert(character < m_Characters.size() && layer < MaxLayers);
+    assert(playback.clip == nullptr || playback.clip->GetJointCount() == m_Characters[character].skeleton->GetJointCount());
+    m_Characters[character].layers[layer] = playback;
+}
+
+void AnimationSystem::SetBlendWeight(uint32_t character, float weight)
+{
+    assert(character < m_Characters.size());
+    m_Characters[character].blendWeight = weight;
+}
+
+void AnimationSystem::Update(WorkerThreadPool &pool, float deltaTime, SkinningMethod method, bool skinOnCpu)
+{
+    ParallelFor(pool, static_cast<uint32_t>(m_Characters.size()), CharacterBatchSize, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t character = begin; character < end; ++character)
+        {
+            UpdateCharacter(m_Characters[character], deltaTime, method, skinOnCpu);
+        }
+    });
+}
+
+void AnimationSystem::UpdateCharacter(Character &character, float deltaTime, SkinningMethod method, bool skinOnCpu)
+{
+    const Skeleton &skeleton = *character.skeleton;
+
+    for (AnimationPlayback &layer : character.layers)
+    {
+        layer.time += deltaTime * layer.speed;
+    }
+
+    // Layer 0 falls back to the rest pose, layer 1 only counts with a clip and some weight.
+    const AnimationPlayback &base = character.layers[0];
+    const AnimationPlayback &overlay = character.layers[1];
+    if (base.clip != nullptr)
+    {
+        base.clip->Sample(base.time, base.loop, character.pose);
+    }
+    else
+    {
+        character.pose = skeleton.GetRestPose();
+    }
+
+    if (overlay.clip != nullptr && character.blendWeight > 0.0f)
+    {
+        overlay.clip->Sample(overlay.time, overlay.loop, character.layerPose);
+        PoseBlend::Lerp(character.pose, character.layerPose, character.blendWeight, character.pose);
+    }
+
+    LinearArena &scratch = Memory::GetThreadScratch();
+    ArenaScope scope{ scratch };
+
+    glm::mat4 *modelMatrices = scratch.AllocateArray<glm::mat4>(skeleton.GetJointCount());
+    SkinMatrix *skinMatrices = m_SkinMatrices.data() + character.jointOffset;
+    DualQuaternion *dualQuaternions = m_DualQuaternions.data() + character.jointOffset;
+
+    Skinning::ComputeModelMatrices(skeleton, character.pose, modelMatrices);
+    Skinning::ComputeSkinMatrices(skeleton, modelMatrices, skinMatrices);
+    if (method == SkinningMethod::DualQuaternion)
+    {
+        Skinning::ComputeDualQuaternions(skinMatrices, skeleton.GetJointCount(), dualQuaternions);
+    }
+
+    if (skinOnCpu && character.mesh != nullptr)
+    {
+        glm::vec3 *positions = m_SkinnedPositions.data() + character.vertexOffset;
+        glm::vec3 *normals = m_SkinnedNormals.data() + character.vertexOffset;
+        if (method == SkinningMethod::DualQuaternion)
+        {
+            Skinning::SkinDualQuaternion(*character.mesh, dualQuaternions, positions, normals);
+        }
+        else
+        {
+            Skinning::SkinLinearBlend(*character.mesh, skinMatrices, positions, normals);
+        }
+    }
+}
+
+uint32_t AnimationSystem::GetCharacterCount() const
+{
+    return static_cast<uint32_t>(m_Characters.size());
+}
+
+const Skeleton &AnimationSystem::GetSkeleton(uint32_t character) const
+{
+    assert(character < m_Characters.size());
+    return *m_Characters[character].skeleton;
+}
+
+const SkinnedMesh *AnimationSystem::GetMesh(uint32_t character) const
+{
+    assert(character < m_Characters.size());
+    return m_Characters[character].mesh;
+}
+
+const AnimationPose &AnimationSystem::GetPose(uint32_t character) const
+{
+    assert(character < m_Characters.size());
+    return m_Characters[character].pose;
+}
+
+uint32_t AnimationSystem::GetJointOffset(uint32_t character) const
+{
+    assert(character < m_Characters.size());
+    return m_Characters[character].jointOffset;
+}
+
+uint32_t AnimationSystem::GetVertexOffset(uint32_t character) const
+{
+    assert(character < m_Characters.size());
+    return m_Characters[character].vertexOffset;
+}
+
+uint32_t AnimationSystem::GetJointCount() const
+{
+    return static_cast<uint32_t>(m_SkinMatrices.size());
+}
+
+uint32_t AnimationSystem::GetVertexCount() const
+{
+    return static_cast<uint32_t>(m_SkinnedPositions.size());
+}
+
+const std::vector<SkinMatrix> &AnimationSystem::GetSkinMatrices() const
+{
+    return m_SkinMatrices;
+}
+
+const std::vector<DualQuaternion> &AnimationSystem::GetDualQuaternions() const
+{
+    return m_DualQuaternions;
+}
+
+const std::vector<glm::vec3> &AnimationSystem::GetSkinnedPositions() const
+{
+    return m_SkinnedPositions;
+}
+
+const std::vector<glm::vec3> &AnimationSystem::GetSkinnedNormals() const
+{
+    return m_SkinnedNormals;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AnimationPose.h"
+#include "Skinning.h"
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class AnimationClip;
+
+class WorkerThreadPool;
+
+struct AnimationPlayback
+{
+    const AnimationClip *clip{ nullptr };
+
+    float time{ 0.0f };
+
+    float speed{ 1.0f };
+
+    bool loop{ true };
+};
+
+// Animates every character of a scene in one pass across the worker threads: samples and blends two
+// playback layers, builds the skin matrices (and dual quaternions) into one joint array shared by all
+// characters, and optionally skins the vertices on the CPU. VulkanSkinning uploads the joint array
+// for the compute path.
+class AnimationSystem : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t MaxLayers = 2;
+
+    // skeleton and mesh must outlive the system, mesh may be null when only the joints are needed.
+    uint32_t AddCharacter(const Skeleton &skeleton, const SkinnedMesh *mesh);
+
+    void SetPlayback(uint32_t character, uint32_t layer, const AnimationPlayback &playback);
+
+    // Weight of layer 1 over layer 0.
+    void SetBlendWeight(uint32_t character, float weight);
+
+    // Advances playback by deltaTime seconds. Dual quaternions are only built for that method, vertices
+    // only skinned when skinOnCpu is set.
+    void Update(WorkerThreadPool &pool, float deltaTime, SkinningMethod method, bool skinOnCpu);
+
+    uint32_t GetCharacterCount() const;
+
+    const Skeleton &GetSkeleton(uint32_t character) const;
+
+    const SkinnedMesh *GetMesh(uint32_t character) const;
+
+    const AnimationPose &GetPose(uint32_t character) const;
+
+    // Offsets of the character in the joint and vertex arrays.
+    uint32_t GetJointOffset(uint32_t character) const;
+
+    uint32_t GetVertexOffset(uint32_t character) const;
+
+    uint32_t GetJointCount() const;
+
+    uint32_t GetVertexCount() const;
+
+    const std::vector<SkinMatrix> &GetSkinMatrices() const;
+
+    const std::vector<DualQuaternion> &GetDualQuaternions() const;
+
+    const std::vector<glm::vec3> &GetSkinnedPositions() const;
+
+    const std::vector<glm::vec3> &GetSkinnedNormals() const;
+
+private:
+
+    struct Character
+    {
+        const Skeleton *skeleton{ nullptr };
+
+        const SkinnedMesh *mesh{ nullptr };
+
+        uint32_t jointOffset{ 0 };
+
+        uint32_t vertexOffset{ 0 };
+
+        AnimationPlayback layers[MaxLayers];
+
+        float blendWeight{ 0.0f };
+
+        AnimationPose pose;
+
+        AnimationPose layerPose;
+    };
+
+    void UpdateCharacter(Character &character, float deltaTime, SkinningMethod method, bool skinOnCpu);
+
+    std::vector<Character> m_Characters;
+
+    std::vector<SkinMatrix> m_SkinMatrices;
+
+    std::vector<DualQuaternion> m_DualQuaternions;
+
+    std::vector<glm::vec3> m_SkinnedPositions;
+
+    std::vector<glm::vec3> m_SkinnedNormals;
+};
@@ -0,0 +1,60 @@
+#include "Skeleton.h"
+#include <cassert>
+
+uint32_t Skeleton::AddJoint(const std::string &name, int32_t parent, const JointTransform &restPose, const glm::mat4 &inverseBindMatrix)
+{
+    uint32_t joint = static_cast<uint32_t>(m_Parents.size());
+    assert(parent < static_cast<int32_t>(joint) && "Parents must be added before their children.");
+
+    m_Names.push_back(name);
+    m_Parents.push_back(parent);
+    m_InverseBindMatrices.push_back(inverseBindMatrix);
+    m_RestTransforms.push_back(restPose);
+
+    // Joints are added once while loading, rebuilding the SoA pose each time keeps it simple.
+    m_RestPose.Resize(joint + 1);
+    for (uint32_t index = 0; index <= joint; ++index)
+    {
+        m_RestPose.SetJoint(index, m_RestTransforms[index]);
+    }
+
+    return joint;
+}
+
+uint32_t Skeleton::GetJointCount() const
+{
+    return static_cast<uint32_t>(m_Parents.size());
+}
+
+const std::vector<int32_t> &Skeleton::GetParents() const
+{
+    return m_Parents;
+}
+
+const std::vector<glm::mat4> &Skeleton::GetInverseBindMatrices() const
+{
+    return m_InverseBindMatrices;
+}
+
+const AnimationPose &Skeleton::GetRestPose() const
+{
+    return m_RestPose;
+}
+
+const std::string &Skeleton::GetJointName(uint32_t joint) const
+{
+    assert(joint < m_Names.size());
+    return m_Names[joint];
+}
+
+int32_t Skeleton::FindJoint(const std::string &name) const
+{
+    for (size_t joint = 0; joint < m_Names.size(); ++joint)
+    {
+        if (m_Names[joint] == name)
+        {
+            return static_cast<int32_t>(joint);
+        }
+    }
+    return -1;
+}
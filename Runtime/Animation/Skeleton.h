@@ -0,0 +1,43 @@
+#pragma once
+
+#include "AnimationPose.h"
+#include "Common/Utils.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Joint hierarchy with its rest pose and inverse bind matrices. Joints are stored parents first, so
+// walking them in order visits every parent before its children.
+class Skeleton : public NonCopyable
+{
+public:
+
+    // parent is -1 for a root and must be an existing joint otherwise. Returns the joint index.
+    uint32_t AddJoint(const std::string &name, int32_t parent, const JointTransform &restPose, const glm::mat4 &inverseBindMatrix);
+
+    uint32_t GetJointCount() const;
+
+    const std::vector<int32_t> &GetParents() const;
+
+    const std::vector<glm::mat4> &GetInverseBindMatrices() const;
+
+    const AnimationPose &GetRestPose() const;
+
+    const std::string &GetJointName(uint32_t joint) const;
+
+    // -1 when there is no joint of that name.
+    int32_t FindJoint(const std::string &name) const;
+
+private:
+
+    std::vector<std::string> m_Names;
+
+    std::vector<int32_t> m_Parents;
+
+    std::vector<glm::mat4> m_InverseBindMatrices;
+
+    std::vector<JointTransform> m_RestTransforms;
+
+    AnimationPose m_RestPose;
+};
@@ -0,0 +1,576 @@
+#include "Skinning.h"
+#include "AnimationPose.h"
+#include "Skeleton.h"
+#include "Render/Mesh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// AVX2 kernels are compiled for x86-64 whatever the target flags and only run after a CPU check, so
+// one binary works on older CPUs too.
+#if defined(__x86_64__) || defined(_M_X64)
+#define SKINNING_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SKINNING_AVX2_FUNCTION
+#else
+#define SKINNING_AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#endif
+
+SkinnedMesh::SkinnedMesh(const Mesh &mesh, const JointInfluence *influences) :
+    m_VertexCount{ mesh.GetVertexCount() },
+    m_PaddedCount{ (mesh.GetVertexCount() + VertexAlignment - 1) / VertexAlignment * VertexAlignment },
+    m_HasNormals{ !mesh.GetNormals().empty() }
+{
+    const std::vector<glm::vec3> &positions = mesh.GetPositions();
+    const std::vector<glm::vec3> &normals = mesh.GetNormals();
+
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        m_Positions[axis].resize(m_PaddedCount, 0.0f);
+        if (m_HasNormals)
+        {
+            m_Normals[axis].resize(m_PaddedCount, 0.0f);
+        }
+    }
+
+    for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+    {
+        m_Joints[slot].resize(m_PaddedCount, 0);
+        m_Weights[slot].resize(m_PaddedCount, 0.0f);
+    }
+
+    for (uint32_t vertex = 0; vertex < m_VertexCount; ++vertex)
+    {
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            m_Positions[axis][vertex] = positions[vertex][axis];
+            if (m_HasNormals)
+            {
+                m_Normals[axis][vertex] = normals[vertex][axis];
+            }
+        }
+
+        // Weights are renormalised, exporters often leave them summing to slightly off one.
+        const JointInfluence &influence = influences[vertex];
+        float weightSum = 0.0f;
+        for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+        {
+            weightSum += influence.weights[slot];
+        }
+        float weightScale = weightSum > 0.0f ? 1.0f / weightSum : 0.0f;
+
+        for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+        {
+            m_Joints[slot][vertex] = influence.joints[slot];
+            m_Weights[slot][vertex] = influence.weights[slot] * weightScale;
+            if (influence.weights[slot] > 0.0f)
+            {
+                m_MaxJoint = std::max<uint32_t>(m_MaxJoint, influence.joints[slot]);
+            }
+        }
+    }
+}
+
+uint32_t SkinnedMesh::GetVertexCount() const
+{
+    return m_VertexCount;
+}
+
+uint32_t SkinnedMesh::GetPaddedCount() const
+{
+    return m_PaddedCount;
+}
+
+bool SkinnedMesh::HasNormals() const
+{
+    return m_HasNormals;
+}
+
+const float *SkinnedMesh::GetPositions(uint32_t axis) const
+{
+    assert(axis < 3);
+    return m_Positions[axis].data();
+}
+
+const float *SkinnedMesh::GetNormals(uint32_t axis) const
+{
+    assert(axis < 3 && m_HasNormals);
+    return m_Normals[axis].data();
+}
+
+const int32_t *SkinnedMesh::GetJoints(uint32_t slot) const
+{
+    assert(slot < MaxJointInfluences);
+    return m_Joints[slot].data();
+}
+
+const float *SkinnedMesh::GetWeights(uint32_t slot) const
+{
+    assert(slot < MaxJointInfluences);
+    return m_Weights[slot].data();
+}
+
+uint32_t SkinnedMesh::GetMaxJoint() const
+{
+    return m_MaxJoint;
+}
+
+static void SkinLinearBlendScalar(const SkinnedMesh &mesh, const SkinMatrix *skinMatrices, glm::vec3 *positions, glm::vec3 *normals)
+{
+    const float *matrices = &skinMatrices[0].rows[0].x;
+
+    for (uint32_t vertex = 0; vertex < mesh.GetVertexCount(); ++vertex)
+    {
+        float blended[12]{};
+        for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+        {
+            float weight = mesh.GetWeights(slot)[vertex];
+            if (weight == 0.0f)
+            {
+                continue;
+            }
+
+            const float *matrix = matrices + mesh.GetJoints(slot)[vertex] * 12;
+            for (uint32_t element = 0; element < 12; ++element)
+            {
+                blended[element] += matrix[element] * weight;
+            }
+        }
+
+        float x = mesh.GetPositions(0)[vertex];
+        float y = mesh.GetPositions(1)[vertex];
+        float z = mesh.GetPositions(2)[vertex];
+        positions[vertex] = glm::vec3{
+            blended[0] * x + blended[1] * y + blended[2] * z + blended[3],
+            blended[4] * x + blended[5] * y + blended[6] * z + blended[7],
+            blended[8] * x + blended[9] * y + blended[10] * z + blended[11] };
+
+        if (normals != nullptr && mesh.HasNormals())
+        {
+            x = mesh.GetNormals(0)[vertex];
+            y = mesh.GetNormals(1)[vertex];
+            z = mesh.GetNormals(2)[vertex];
+            glm::vec3 normal{
+                blended[0] * x + blended[1] * y + blended[2] * z,
+                blended[4] * x + blended[5] * y + blended[6] * z,
+                blended[8] * x + blended[9] * y + blended[10] * z };
+            float length = glm::length(normal);
+            normals[vertex] = length > 0.0f ? normal / length : normal;
+        }
+    }
+}
+
+static glm::vec3 Cross(const glm::vec3 &a, const glm::vec3 &b)
+{
+    return glm::vec3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static void SkinDualQuaternionScalar(const SkinnedMesh &mesh, const DualQuaternion *dualQuaternions, glm::vec3 *positions, glm::vec3 *normals)
+{
+    for (uint32_t vertex = 0; vertex < mesh.GetVertexCount(); ++vertex)
+    {
+        glm::vec4 real{ 0.0f };
+        glm::vec4 dual{ 0.0f };
+        glm::vec4 firstReal = dualQuaternions[mesh.GetJoints(0)[vertex]].real;
+
+        for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+        {
+            float weight = mesh.GetWeights(slot)[vertex];
+            if (weight == 0.0f)
+            {
+                continue;
+            }
+
+            // Quaternions on the other hemisphere than the first influence would blend the long way round.
+            const DualQuaternion &dualQuaternion = dualQuaternions[mesh.GetJoints(slot)[vertex]];
+            if (glm::dot(dualQuaternion.real, firstReal) < 0.0f)
+            {
+                weight = -weight;
+            }
+            real += dualQuaternion.real * weight;
+            dual += dualQuaternion.dual * weight;
+        }
+
+        float length = glm::length(real);
+        if (length > 0.0f)
+        {
+            real *= 1.0f / length;
+            dual *= 1.0f / length;
+        }
+
+        glm::vec3 axis{ real.x, real.y, real.z };
+        glm::vec3 translation = (glm::vec3{ dual.x, dual.y, dual.z } * real.w - axis * dual.w + Cross(axis, glm::vec3{ dual.x, dual.y, dual.z })) * 2.0f;
+
+        glm::vec3 position{ mesh.GetPositions(0)[vertex], mesh.GetPositions(1)[vertex], mesh.GetPositions(2)[vertex] };
+        positions[vertex] = position + Cross(axis, Cross(axis, position) + position * real.w) * 2.0f + translation;
+
+        if (normals != nullptr && mesh.HasNormals())
+        {
+            glm::vec3 normal{ mesh.GetNormals(0)[vertex], mesh.GetNormals(1)[vertex], mesh.GetNormals(2)[vertex] };
+            normals[vertex] = normal + Cross(axis, Cross(axis, normal) + normal * real.w) * 2.0f;
+        }
+    }
+}
+
+#if SKINNING_AVX2
+
+struct Vector3x8
+{
+    __m256 x;
+
+    __m256 y;
+
+    __m256 z;
+};
+
+static SKINNING_AVX2_FUNCTION inline Vector3x8 Cross8(const Vector3x8 &a, const Vector3x8 &b)
+{
+    return Vector3x8{
+        _mm256_sub_ps(_mm256_mul_ps(a.y, b.z), _mm256_mul_ps(a.z, b.y)),
+        _mm256_sub_ps(_mm256_mul_ps(a.z, b.x), _mm256_mul_ps(a.x, b.z)),
+        _mm256_sub_ps(_mm256_mul_ps(a.x, b.y), _mm256_mul_ps(a.y, b.x)) };
+}
+
+static SKINNING_AVX2_FUNCTION inline Vector3x8 Load8(const SkinnedMesh &mesh, bool normal, uint32_t vertex)
+{
+    return normal ?
+        Vector3x8{ _mm256_loadu_ps(mesh.GetNormals(0) + vertex), _mm256_loadu_ps(mesh.GetNormals(1) + vertex), _mm256_loadu_ps(mesh.GetNormals(2) + vertex) } :
+        Vector3x8{ _mm256_loadu_ps(mesh.GetPositions(0) + vertex), _mm256_loadu_ps(mesh.GetPositions(1) + vertex), _mm256_loadu_ps(mesh.GetPositions(2) + vertex) };
+}
+
+// The output is AoS, transposed through the stack since only the tail block is partial.
+static SKINNING_AVX2_FUNCTION inline void Store8(const Vector3x8 &value, glm::vec3 *output, uint32_t count)
+{
+    alignas(32) float x[8];
+    alignas(32) float y[8];
+    alignas(32) float z[8];
+    _mm256_store_ps(x, value.x);
+    _mm256_store_ps(y, value.y);
+    _mm256_store_ps(z, value.z);
+
+    for (uint32_t lane = 0; lane < count; ++lane)
+    {
+        output[lane] = glm::vec3{ x[lane], y[lane], z[lane] };
+    }
+}
+
+static SKINNING_AVX2_FUNCTION inline Vector3x8 Normalize8(const Vector3x8 &value)
+{
+    __m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(value.x, value.x), _mm256_mul_ps(value.y, value.y)), _mm256_mul_ps(value.z, value.z));
+    __m256 inverseLength = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(lengthSquared, _mm256_set1_ps(1e-24f))));
+    return Vector3x8{ _mm256_mul_ps(value.x, inverseLength), _mm256_mul_ps(value.y, inverseLength), _mm256_mul_ps(value.z, inverseLength) };
+}
+
+static SKINNING_AVX2_FUNCTION void SkinLinearBlendAvx2(const SkinnedMesh &mesh, const SkinMatrix *skinMatrices, glm::vec3 *positions, glm::vec3 *normals)
+{
+    const float *matrices = &skinMatrices[0].rows[0].x;
+    bool skinNormals = normals != nullptr && mesh.HasNormals();
+
+    for (uint32_t vertex = 0; vertex < mesh.GetVertexCount(); vertex += SkinnedMesh::VertexAlignment)
+    {
+        // Eight blended matrices, one gather per element and influence.
+        __m256 blended[12];
+        for (__m256 &element : blended)
+        {
+            element = _mm256_setzero_ps();
+        }
+
+        for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+        {
+            __m256i joints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mesh.GetJoints(slot) + vertex));
+            __m256i offsets = _mm256_add_epi32(_mm256_slli_epi32(joints, 3), _mm256_slli_epi32(joints, 2));
+            __m256 weights = _mm256_loadu_ps(mesh.GetWeights(slot) + vertex);
+
+            for (uint32_t element = 0; element < 12; ++element)
+            {
+                __m256 value = _mm256_i32gather_ps(matrices + element, offsets, 4);
+                blended[element] = _mm256_add_ps(blended[element], _mm256_mul_ps(value, weights));
+            }
+        }
+
+        uint32_t count = std::min(SkinnedMesh::VertexAlignment, mesh.GetVertexCount() - vertex);
+
+        Vector3x8 position = Load8(mesh, false, vertex);
+        Vector3x8 result{};
+        __m256 *rows[3]{ &result.x, &result.y, &result.z };
+        for (uint32_t row = 0; row < 3; ++row)
+        {
+            *rows[row] = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(blended[row * 4], position.x), _mm256_mul_ps(blended[row * 4 + 1], position.y)),
+                _mm256_add_ps(_mm256_mul_ps(blended[row * 4 + 2], position.z), blended[row * 4 + 3]));
+        }
+        Store8(result, positions + vertex, count);
+
+        if (skinNormals)
+        {
+            Vector3x8 normal = Load8(mesh, true, vertex);
+            for (uint32_t row = 0; row < 3; ++row)
+            {
+                *rows[row] = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(blended[row * 4], normal.x), _mm256_mul_ps(blended[row * 4 + 1], normal.y)),
+                    _mm256_mul_ps(blended[row * 4 + 2], normal.z));
+            }
+            Store8(Normalize8(result), normals + vertex, count);
+        }
+    }
+}
+
+static SKINNING_AVX2_FUNCTION void SkinDualQuaternionAvx2(const SkinnedMesh &mesh, const DualQuaternion *dualQuaternions, glm::vec3 *positions, glm::vec3 *normals)
+{
+    const float *base = &dualQuaternions[0].real.x;
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    bool skinNormals = normals != nullptr && mesh.HasNormals();
+
+    for (uint32_t vertex = 0; vertex < mesh.GetVertexCount(); vertex += SkinnedMesh::VertexAlignment)
+    {
+        __m256 real[4];
+        __m256 dual[4];
+        __m256 firstReal[4];
+        for (uint32_t component = 0; component < 4; ++component)
+        {
+            real[component] = _mm256_setzero_ps();
+            dual[component] = _mm256_setzero_ps();
+        }
+
+        for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+        {
+            __m256i joints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mesh.GetJoints(slot) + vertex));
+            __m256i offsets = _mm256_slli_epi32(joints, 3);
+            __m256 weights = _mm256_loadu_ps(mesh.GetWeights(slot) + vertex);
+
+            __m256 jointReal[4];
+            for (uint32_t component = 0; component < 4; ++component)
+            {
+                jointReal[component] = _mm256_i32gather_ps(base + component, offsets, 4);
+            }
+
+            if (slot == 0)
+            {
+                for (uint32_t component = 0; component < 4; ++component)
+                {
+                    firstReal[component] = jointReal[component];
+                }
+            }
+            else
+            {
+                // Flip the weight where the quaternion lies on the other hemisphere than the first one.
+                __m256 dot = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(jointReal[0], firstReal[0]), _mm256_mul_ps(jointReal[1], firstReal[1])),
+                    _mm256_add_ps(_mm256_mul_ps(jointReal[2], firstReal[2]), _mm256_mul_ps(jointReal[3], firstReal[3])));
+                weights = _mm256_xor_ps(weights, _mm256_and_ps(dot, signMask));
+            }
+
+            for (uint32_t component = 0; component < 4; ++component)
+            {
+                __m256 jointDual = _mm256_i32gather_ps(base + 4 + component, offsets, 4);
+                real[component] = _mm256_add_ps(real[component], _mm256_mul_ps(jointReal[component], weights));
+                dual[component] = _mm256_add_ps(dual[component], _mm256_mul_ps(jointDual, weights));
+            }
+        }
+
+        __m256 lengthSquared = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(real[0], real[0]), _mm256_mul_ps(real[1], real[1])),
+            _mm256_add_ps(_mm256_mul_ps(real[2], real[2]), _mm256_mul_ps(real[3], real[3])));
+        __m256 inverseLength = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(lengthSquared, _mm256_set1_ps(1e-24f))));
+        for (uint32_t component = 0; component < 4; ++component)
+        {
+            real[component] = _mm256_mul_ps(real[component], inverseLength);
+            dual[component] = _mm256_mul_ps(dual[component], inverseLength);
+        }
+
+        Vector3x8 axis{ real[0], real[1], real[2] };
+        Vector3x8 dualAxis{ dual[0], dual[1], dual[2] };
+        __m256 two = _mm256_set1_ps(2.0f);
+
+        // translation = 2 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz))
+        Vector3x8 translation = Cross8(axis, dualAxis);
+        translation.x = _mm256_mul_ps(two, _mm256_add_ps(translation.x, _mm256_sub_ps(_mm256_mul_ps(real[3], dualAxis.x), _mm256_mul_ps(dual[3], axis.x))));
+        translation.y = _mm256_mul_ps(two, _mm256_add_ps(translation.y, _mm256_sub_ps(_mm256_mul_ps(real[3], dualAxis.y), _mm256_mul_ps(dual[3], axis.y))));
+        translation.z = _mm256_mul_ps(two, _mm256_add_ps(translation.z, _mm256_sub_ps(_mm256_mul_ps(real[3], dualAxis.z), _mm256_mul_ps(dual[3], axis.z))));
+
+        uint32_t count = std::min(SkinnedMesh::VertexAlignment, mesh.GetVertexCount() - vertex);
+
+        for (uint32_t stream = 0; stream < (skinNormals ? 2u : 1u); ++stream)
+        {
+            // v + 2 * cross(real.xyz, cross(real.xyz, v) + real.w * v)
+            Vector3x8 value = Load8(mesh, stream == 1, vertex);
+            Vector3x8 inner = Cross8(axis, value);
+            inner.x = _mm256_add_ps(inner.x, _mm256_mul_ps(real[3], value.x));
+            inner.y = _mm256_add_ps(inner.y, _mm256_mul_ps(real[3], value.y));
+            inner.z = _mm256_add_ps(inner.z, _mm256_mul_ps(real[3], value.z));
+            Vector3x8 outer = Cross8(axis, inner);
+
+            Vector3x8 result{
+                _mm256_add_ps(value.x, _mm256_mul_ps(two, outer.x)),
+                _mm256_add_ps(value.y, _mm256_mul_ps(two, outer.y)),
+                _mm256_add_ps(value.z, _mm256_mul_ps(two, outer.z)) };
+
+            if (stream == 0)
+            {
+                result.x = _mm256_add_ps(result.x, translation.x);
+                result.y = _mm256_add_ps(result.y, translation.y);
+                result.z = _mm256_add_ps(result.z, translation.z);
+                Store8(result, positions + vertex, count);
+            }
+            else
+            {
+                Store8(result, normals + vertex, count);
+            }
+        }
+    }
+}
+
+#endif
+
+namespace Skinning
+{
+    bool IsAvx2Supported()
+    {
+#if SKINNING_AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+        static const bool supported = []
+        {
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+
+            // AVX needs OS support for saving the YMM registers as well.
+            __cpuid(info, 1);
+            bool osSupport = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+
+            __cpuidex(info, 7, 0);
+            return osSupport && (info[1] & (1 << 5)) != 0;
+        }();
+        return supported;
+#else
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#endif
+#else
+        return false;
+#endif
+    }
+
+    void ComputeModelMatrices(const Skeleton &skeleton, const AnimationPose &pose, glm::mat4 *modelMatrices)
+    {
+        assert(pose.GetJointCount() == skeleton.GetJointCount());
+
+        const std::vector<int32_t> &parents = skeleton.GetParents();
+        const float *translation[3]{ pose.GetStream(PoseTranslationX), pose.GetStream(PoseTranslationY), pose.GetStream(PoseTranslationZ) };
+        const float *rotation[4]{ pose.GetStream(PoseRotationX), pose.GetStream(PoseRotationY), pose.GetStream(PoseRotationZ), pose.GetStream(PoseRotationW) };
+        const float *scale[3]{ pose.GetStream(PoseScaleX), pose.GetStream(PoseScaleY), pose.GetStream(PoseScaleZ) };
+
+        for (uint32_t joint = 0; joint < skeleton.GetJointCount(); ++joint)
+        {
+            float x = rotation[0][joint];
+            float y = rotation[1][joint];
+            float z = rotation[2][joint];
+            float w = rotation[3][joint];
+
+            // Translation * rotation * scale, written out.
+            glm::mat4 local{ 1.0f };
+            local[0] = glm::vec4{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f } * scale[0][joint];
+            local[1] = glm::vec4{ 2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f } * scale[1][joint];
+            local[2] = glm::vec4{ 2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f } * scale[2][joint];
+            local[3] = glm::vec4{ translation[0][joint], translation[1][joint], translation[2][joint], 1.0f };
+
+            modelMatrices[joint] = parents[joint] >= 0 ? modelMatrices[parents[joint]] * local : local;
+        }
+    }
+
+    void ComputeSkinMatrices(const Skeleton &skeleton, const glm::mat4 *modelMatrices, SkinMatrix *skinMatrices)
+    {
+        const std::vector<glm::mat4> &inverseBindMatrices = skeleton.GetInverseBindMatrices();
+
+        for (uint32_t joint = 0; joint < skeleton.GetJointCount(); ++joint)
+        {
+            glm::mat4 matrix = modelMatrices[joint] * inverseBindMatrices[joint];
+            for (uint32_t row = 0; row < 3; ++row)
+            {
+                skinMatrices[joint].rows[row] = glm::vec4{ matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row] };
+            }
+        }
+    }
+
+    void ComputeDualQuaternions(const SkinMatrix *skinMatrices, uint32_t jointCount, DualQuaternion *dualQuaternions)
+    {
+        for (uint32_t joint = 0; joint < jointCount; ++joint)
+        {
+            const glm::vec4 *rows = skinMatrices[joint].rows;
+
+            // Rotation with the scale of every column taken out.
+            float m[3][3];
+            for (uint32_t column = 0; column < 3; ++column)
+            {
+                float length = std::sqrt(rows[0][column] * rows[0][column] + rows[1][column] * rows[1][column] + rows[2][column] * rows[2][column]);
+                float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+                for (uint32_t row = 0; row < 3; ++row)
+                {
+                    m[row][column] = rows[row][column] * inverseLength;
+                }
+            }
+
+            glm::vec4 q;
+            float trace = m[0][0] + m[1][1] + m[2][2];
+            if (trace > 0.0f)
+            {
+                float s = std::sqrt(trace + 1.0f) * 2.0f;
+                q = glm::vec4{ (m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s, 0.25f * s };
+            }
+            else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+            {
+                float s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+                q = glm::vec4{ 0.25f * s, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s, (m[2][1] - m[1][2]) / s };
+            }
+            else if (m[1][1] > m[2][2])
+            {
+                float s = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+                q = glm::vec4{ (m[0][1] + m[1][0]) / s, 0.25f * s, (m[1][2] + m[2][1]) / s, (m[0][2] - m[2][0]) / s };
+            }
+            else
+            {
+                float s = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+                q = glm::vec4{ (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, 0.25f * s, (m[1][0] - m[0][1]) / s };
+            }
+            q = glm::normalize(q);
+
+            // dual = 0.5 * (translation, 0) * real
+            glm::vec3 translation{ rows[0].w, rows[1].w, rows[2].w };
+            glm::vec3 axis{ q.x, q.y, q.z };
+            glm::vec3 dualAxis = (translation * q.w + Cross(translation, axis)) * 0.5f;
+
+            dualQuaternions[joint].real = q;
+            dualQuaternions[joint].dual = glm::vec4{ dualAxis, -0.5f * glm::dot(translation, axis) };
+        }
+    }
+
+    void SkinLinearBlend(const SkinnedMesh &mesh, const SkinMatrix *skinMatrices, glm::vec3 *positions, glm::vec3 *normals, SkinningKernel kernel)
+    {
+#if SKINNING_AVX2
+        if (kernel == SkinningKernel::Auto && IsAvx2Supported())
+        {
+            SkinLinearBlendAvx2(mesh, skinMatrices, positions, normals);
+            return;
+        }
+#endif
+        SkinLinearBlendScalar(mesh, skinMatrices, positions, normals);
+    }
+
+    void SkinDualQuaternion(const SkinnedMesh &mesh, const DualQuaternion *dualQuaternions, glm::vec3 *positions, glm::vec3 *normals, SkinningKernel kernel)
+    {
+#if SKINNING_AVX2
+        if (kernel == SkinningKernel::Auto && IsAvx2Supported())
+        {
+            SkinDualQuaternionAvx2(mesh, dualQuaternions, positions, normals);
+            return;
+        }
+#endif
+        SkinDualQuaternionScalar(mesh, dualQuaternions, positions, normals);
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class AnimationPose;
+
+class Mesh;
+
+class Skeleton;
+
+static constexpr uint32_t MaxJointInfluences = 4;
+
+// Joints of one vertex with their weights, unused slots have a weight of 0.
+struct JointInfluence
+{
+    uint16_t joints[MaxJointInfluences]{};
+
+    float weights[MaxJointInfluences]{};
+};
+
+// Model space joint transform times its inverse bind matrix as three rows of a 3x4 matrix, the std430
+// layout of the compute skinning joint buffer.
+struct SkinMatrix
+{
+    glm::vec4 rows[3];
+};
+
+// Rigid part of a SkinMatrix as a unit dual quaternion, xyzw components. Scale is dropped.
+struct DualQuaternion
+{
+    glm::vec4 real;
+
+    glm::vec4 dual;
+};
+
+enum class SkinningMethod
+{
+    LinearBlend,
+
+    DualQuaternion,
+};
+
+enum class SkinningKernel
+{
+    // AVX2 when the CPU has it, scalar otherwise.
+    Auto,
+
+    Scalar,
+};
+
+// Bind pose positions, normals and influences of a mesh as SoA, padded to eight vertices with
+// zero weight entries for the AVX2 kernels.
+class SkinnedMesh : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t VertexAlignment = 8;
+
+    // influences has one entry per vertex of mesh. Meshes without normals skin positions only.
+    SkinnedMesh(const Mesh &mesh, const JointInfluence *influences);
+
+    uint32_t GetVertexCount() const;
+
+    uint32_t GetPaddedCount() const;
+
+    bool HasNormals() const;
+
+    // x, y and z streams of the bind pose.
+    const float *GetPositions(uint32_t axis) const;
+
+    const float *GetNormals(uint32_t axis) const;
+
+    // Joint index and weight streams of influence slot.
+    const int32_t *GetJoints(uint32_t slot) const;
+
+    const float *GetWeights(uint32_t slot) const;
+
+    // Largest joint index referenced, the skeleton must have more joints than this.
+    uint32_t GetMaxJoint() const;
+
+private:
+
+    uint32_t m_VertexCount{ 0 };
+
+    uint32_t m_PaddedCount{ 0 };
+
+    bool m_HasNormals{ false };
+
+    uint32_t m_MaxJoint{ 0 };
+
+    std::vector<float> m_Positions[3];
+
+    std::vector<float> m_Normals[3];
+
+    std::vector<int32_t> m_Joints[MaxJointInfluences];
+
+    std::vector<float> m_Weights[MaxJointInfluences];
+};
+
+namespace Skinning
+{
+    bool IsAvx2Supported();
+
+    // Local pose to model space, parents first.
+    void ComputeModelMatrices(const Skeleton &skeleton, const AnimationPose &pose, glm::mat4 *modelMatrices);
+
+    void ComputeSkinMatrices(const Skeleton &skeleton, const glm::mat4 *modelMatrices, SkinMatrix *skinMatrices);
+
+    void ComputeDualQuaternions(const SkinMatrix *skinMatrices, uint32_t jointCount, DualQuaternion *dualQuaternions);
+
+    // Writes GetVertexCount() positions and, when the mesh has them, normals.
+    void SkinLinearBlend(const SkinnedMesh &mesh, const SkinMatrix *skinMatrices, glm::vec3 *positions, glm::vec3 *normals, SkinningKernel kernel = SkinningKernel::Auto);
+
+    // Dual quaternion skinning keeps the volume around twisting joints that linear blending collapses.
+    void SkinDualQuaternion(const SkinnedMesh &mesh, const DualQuaternion *dualQuaternions, glm::vec3 *positions, glm::vec3 *normals, SkinningKernel kernel = SkinningKernel::Auto);
+}
@@ -8,4 +8,29 @@ const std::string& Application::GetName() const
 void Application::SetName(const std::string &name)
 {
     m_Name = name;
-}
\ No newline at end of file
+}
+
+bool Application::Prepare(Platform &platform)
+{
+    return true;
+}
+
+void Application::ProcessInput(const InputEventRecord *events, uint32_t count)
+{
+}
+
+void Application::FixedUpdate(double deltaTime)
+{
+}
+
+void Application::Render(double deltaTime, double alpha)
+{
+}
+
+void Application::Resize(uint32_t width, uint32_t height)
+{
+}
+
+void Application::Finish()
+{
+}
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include "Common/Utils.h"
 
+class Platform;
+
+struct InputEventRecord;
+
 class Application : public NonCopyable
 {
 public:
@@ -15,7 +20,27 @@ public:
 
     void SetName(const std::string &name);
 
+    // Platform thread, after the window (if any) exists and before the frame loop starts.
+    virtual bool Prepare(Platform &platform);
+
+    // Simulation thread, right before FixedUpdate(), with the input events that arrived since the
+    // previous step, oldest first. Not called for steps without events.
+    virtual void ProcessInput(const InputEventRecord *events, uint32_t count);
+
+    // Simulation thread, once per fixed timestep.
+    virtual void FixedUpdate(double deltaTime);
+
+    // Render thread. alpha in [0, 1] is how far the clock is past the latest simulation step, in steps.
+    virtual void Render(double deltaTime, double alpha);
+
+    // Render thread, before the first Render() after the framebuffer changed size. 0 x 0 while the
+    // window is minimised.
+    virtual void Resize(uint32_t width, uint32_t height);
+
+    // Platform thread, once the frame loop has stopped.
+    virtual void Finish();
+
 private:
 
     std::string m_Name{};
-};
\ No newline at end of file
+};
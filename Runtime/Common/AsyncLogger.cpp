@@ -0,0 +1,343 @@
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+AsyncLogger g_AsyncLogger;
+
+// How long the logger thread sleeps between passes when nobody asks for a flush.
+static constexpr std::chrono::milliseconds PollInterval{ 2 };
+
+struct LogThreadRing
+{
+    LogRing ring;
+
+    // Set when the owning thread exits; the logger frees the ring once it is drained.
+    std::atomic<bool> retired{ false };
+
+    uint32_t reportedDroppedCount{ 0 };
+};
+
+// Retires the calling thread's ring when the thread exits.
+struct LogThreadRingHandle
+{
+    LogThreadRing *ring{ nullptr };
+
+    uint32_t generation{ 0 };
+
+    ~LogThreadRingHandle()
+    {
+        if (ring != nullptr && generation == g_AsyncLogger.GetGeneration())
+        {
+            ring->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local LogThreadRingHandle t_ThreadRing;
+
+static spdlog::level::level_enum ToSpdlogLevel(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Debug: return spdlog::level::debug;
+    case LogLevel::Info: return spdlog::level::info;
+    case LogLevel::Warning: return spdlog::level::warn;
+    default: return spdlog::level::err;
+    }
+}
+
+bool LogRateLimiter::Allow(uint64_t timestamp, uint32_t &suppressedCount)
+{
+    uint64_t windowStart = m_WindowStart.load(std::memory_order_relaxed);
+    if (timestamp - windowStart >= WindowNanoseconds && m_WindowStart.compare_exchange_strong(windowStart, timestamp, std::memory_order_relaxed))
+    {
+        m_Count.store(0, std::memory_order_relaxed);
+    }
+
+    if (m_Count.fetch_add(1, std::memory_order_relaxed) >= MaxMessagesPerWindow)
+    {
+        m_Suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressedCount = m_Suppressed.load(std::memory_order_relaxed) != 0 ? m_Suppressed.exchange(0, std::memory_order_relaxed) : 0;
+    return true;
+}
+
+LogRecord *LogRing::Reserve(uint32_t size)
+{
+    assert(size % 8 == 0 && size <= Capacity / 2);
+
+    uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+    uint32_t offset = tail & (Capacity - 1);
+    uint32_t contiguous = Capacity - offset;
+    uint32_t required = size <= contiguous ? size : contiguous + size;
+
+    if (Capacity - (tail - m_CachedHead) < required)
+    {
+        m_CachedHead = m_Head.load(std::memory_order_acquire);
+        if (Capacity - (tail - m_CachedHead) < required)
+        {
+            return nullptr;
+        }
+    }
+
+    if (size > contiguous)
+    {
+        // Only the first 8 bytes of the header are written, the smallest gap there can be.
+        LogRecord *padding = reinterpret_cast<LogRecord *>(m_Buffer + offset);
+        padding->size = contiguous;
+        padding->padding = 1;
+        offset = 0;
+    }
+
+    m_PendingTail = tail + required;
+    return reinterpret_cast<LogRecord *>(m_Buffer + offset);
+}
+
+void LogRing::Commit()
+{
+    m_Tail.store(m_PendingTail, std::memory_order_release);
+}
+
+const LogRecord *LogRing::Peek()
+{
+    while (true)
+    {
+        if (m_ReadPosition == m_CachedTail)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (m_ReadPosition == m_CachedTail)
+            {
+                return nullptr;
+            }
+        }
+
+        const LogRecord *record = reinterpret_cast<const LogRecord *>(m_Buffer + (m_ReadPosition & (Capacity - 1)));
+        m_ReadPosition += record->size;
+        if (!record->padding)
+        {
+            return record;
+        }
+    }
+}
+
+void LogRing::Release()
+{
+    m_Head.store(m_ReadPosition, std::memory_order_release);
+}
+
+void LogRing::CountDropped()
+{
+    m_DroppedCount.store(m_DroppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+uint32_t LogRing::GetDroppedCount() const
+{
+    return m_DroppedCount.load(std::memory_order_relaxed);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    Stop();
+}
+
+void AsyncLogger::Start()
+{
+    std::lock_guard<std::mutex> lock{ m_Mutex };
+    if (m_Thread.joinable())
+    {
+        return;
+    }
+
+    m_StopRequested = false;
+    m_Thread = std::thread{ &AsyncLogger::Run, this };
+    m_Running.store(true, std::memory_order_release);
+}
+
+void AsyncLogger::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_Mutex };
+        if (!m_Thread.joinable())
+        {
+            return;
+        }
+
+        m_Running.store(false, std::memory_order_release);
+        m_StopRequested = true;
+    }
+    m_Wake.notify_all();
+    m_Thread.join();
+
+    std::lock_guard<std::mutex> lock{ m_Mutex };
+    m_Rings.clear();
+    m_Generation.fetch_add(1, std::memory_order_release);
+
+    spdlog::default_logger_raw()->flush();
+}
+
+bool AsyncLogger::IsRunning() const
+{
+    return m_Running.load(std::memory_order_acquire);
+}
+
+uint32_t AsyncLogger::GetGeneration() const
+{
+    return m_Generation.load(std::memory_order_acquire);
+}
+
+void AsyncLogger::Flush()
+{
+    std::unique_lock<std::mutex> lock{ m_Mutex };
+    if (!m_Thread.joinable())
+    {
+        return;
+    }
+
+    uint64_t target = ++m_FlushRequested;
+    m_Wake.notify_all();
+    m_Flushed.wait(lock, [this, target]() { return m_FlushCompleted >= target || m_StopRequested; });
+}
+
+bool AsyncLogger::ShouldLog(LogLevel level)
+{
+    return spdlog::default_logger_raw()->should_log(ToSpdlogLevel(level));
+}
+
+int64_t AsyncLogger::GetTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch()).count();
+}
+
+LogRing *AsyncLogger::GetThreadRing()
+{
+    uint32_t generation = GetGeneration();
+    if (t_ThreadRing.ring != nullptr && t_ThreadRing.generation == generation)
+    {
+        return &t_ThreadRing.ring->ring;
+    }
+
+    // First message from this thread in this run.
+    std::unique_ptr<LogThreadRing> ring = std::make_unique<LogThreadRing>();
+    t_ThreadRing.ring = ring.get();
+    t_ThreadRing.generation = generation;
+
+    std::lock_guard<std::mutex> lock{ m_Mutex };
+    m_Rings.push_back(std::move(ring));
+    return &t_ThreadRing.ring->ring;
+}
+
+void AsyncLogger::WriteNow(const LogRecord &record)
+{
+    fmt::memory_buffer buffer;
+    Write(record, buffer);
+}
+
+void AsyncLogger::Write(const LogRecord &record, fmt::memory_buffer &buffer)
+{
+    buffer.clear();
+
+    if (record.level == LogLevel::Error)
+    {
+        fmt::format_to(std::back_inserter(buffer), "[{}:{}] ", record.file, record.line);
+    }
+
+    try
+    {
+        record.decode(buffer, record.format, reinterpret_cast<const uint8_t *>(&record + 1));
+    }
+    catch (const fmt::format_error &error)
+    {
+        fmt::format_to(std::back_inserter(buffer), "(bad log format \"{}\": {})", record.format, error.what());
+    }
+
+    if (record.suppressedCount > 0)
+    {
+        fmt::format_to(std::back_inserter(buffer), " ({} similar messages suppressed)", record.suppressedCount);
+    }
+
+    spdlog::log_clock::time_point time{ std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds{ record.timestamp }) };
+    spdlog::default_logger_raw()->log(time, spdlog::source_loc{}, ToSpdlogLevel(record.level), spdlog::string_view_t{ buffer.data(), buffer.size() });
+}
+
+void AsyncLogger::Run()
+{
+    std::vector<LogThreadRing *> rings;
+    std::vector<LogThreadRing *> retiredRings;
+    fmt::memory_buffer buffer;
+
+    std::unique_lock<std::mutex> lock{ m_Mutex };
+    while (true)
+    {
+        uint64_t flushTarget = m_FlushRequested;
+        bool stop = m_StopRequested;
+
+        // A ring seen retired before the pass has nothing more coming and can go after it.
+        rings.clear();
+        retiredRings.clear();
+        for (const std::unique_ptr<LogThreadRing> &ring : m_Rings)
+        {
+            rings.push_back(ring.get());
+            if (ring->retired.load(std::memory_order_acquire))
+            {
+                retiredRings.push_back(ring.get());
+            }
+        }
+        lock.unlock();
+
+        DrainRings(rings, buffer);
+
+        lock.lock();
+        m_Rings.erase(std::remove_if(m_Rings.begin(), m_Rings.end(), [&retiredRings](const std::unique_ptr<LogThreadRing> &ring)
+            {
+                return std::find(retiredRings.begin(), retiredRings.end(), ring.get()) != retiredRings.end();
+            }), m_Rings.end());
+
+        m_FlushCompleted = flushTarget;
+        m_Flushed.notify_all();
+
+        if (stop)
+        {
+            break;
+        }
+
+        m_Wake.wait_for(lock, PollInterval, [this, flushTarget]() { return m_StopRequested || m_FlushRequested != flushTarget; });
+    }
+}
+
+void AsyncLogger::DrainRings(const std::vector<LogThreadRing *> &rings, fmt::memory_buffer &buffer)
+{
+    // Messages from different threads are merged by capture time.
+    std::vector<const LogRecord *> &records = m_PendingRecords;
+    records.clear();
+
+    for (LogThreadRing *ring : rings)
+    {
+        while (const LogRecord *record = ring->ring.Peek())
+        {
+            records.push_back(record);
+        }
+    }
+
+    std::stable_sort(records.begin(), records.end(), [](const LogRecord *a, const LogRecord *b) { return a->timestamp < b->timestamp; });
+
+    for (const LogRecord *record : records)
+    {
+        Write(*record, buffer);
+    }
+
+    for (LogThreadRing *ring : rings)
+    {
+        ring->ring.Release();
+
+        uint32_t droppedCount = ring->ring.GetDroppedCount();
+        if (droppedCount != ring->reportedDroppedCount)
+        {
+            spdlog::warn("{} log messages dropped, a thread outran the logger", droppedCount - ring->reportedDroppedCount);
+            ring->reportedDroppedCount = droppedCount;
+        }
+    }
+}
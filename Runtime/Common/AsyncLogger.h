@@ -0,0 +1,354 @@
+#pragma once
+
+#include "Utils.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <spdlog/fmt/fmt.h>
+
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Caps how often one call site may log, so a message repeated every frame can't flood the logger.
+// Approximate under contention, which is fine for its purpose.
+class LogRateLimiter : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t MaxMessagesPerWindow = 32;
+
+    static constexpr uint64_t WindowNanoseconds = 1000000000;
+
+    constexpr LogRateLimiter() = default;
+
+    // On success suppressedCount receives how many messages were dropped since the last one let through.
+    bool Allow(uint64_t timestamp, uint32_t &suppressedCount);
+
+private:
+
+    std::atomic<uint64_t> m_WindowStart{ 0 };
+
+    std::atomic<uint32_t> m_Count{ 0 };
+
+    std::atomic<uint32_t> m_Suppressed{ 0 };
+};
+
+using LogDecodeFn = void (*)(fmt::memory_buffer &out, const char *format, const uint8_t *payload);
+
+// Header of a captured message. The encoded arguments follow it, and are decoded and formatted on the
+// logger thread by the decode function instantiated for the call's argument types.
+struct LogRecord
+{
+    // Header plus payload, rounded up to 8 bytes.
+    uint32_t size;
+
+    LogLevel level;
+
+    uint8_t padding;
+
+    uint32_t line;
+
+    uint32_t suppressedCount;
+
+    int64_t timestamp;
+
+    const char *format;
+
+    const char *file;
+
+    LogDecodeFn decode;
+};
+
+// Single producer, single consumer ring of variable sized LogRecords. A record never wraps, the tail
+// end of the buffer is skipped with a padding record instead.
+class LogRing : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t Capacity = 64 * 1024;
+
+    // Producer only. Returns nullptr when the ring is full.
+    LogRecord *Reserve(uint32_t size);
+
+    // Producer only. Publishes the record returned by the last Reserve().
+    void Commit();
+
+    // Consumer only. Returns the next unread record without giving its space back.
+    const LogRecord *Peek();
+
+    // Consumer only. Gives back the space of every record returned by Peek() so far.
+    void Release();
+
+    // Producer only.
+    void CountDropped();
+
+    uint32_t GetDroppedCount() const;
+
+private:
+
+    static constexpr size_t CacheLineSize = 64;
+
+    alignas(CacheLineSize) std::atomic<uint32_t> m_Head{ 0 };
+
+    uint32_t m_ReadPosition{ 0 };
+
+    uint32_t m_CachedTail{ 0 };
+
+    alignas(CacheLineSize) std::atomic<uint32_t> m_Tail{ 0 };
+
+    uint32_t m_CachedHead{ 0 };
+
+    uint32_t m_PendingTail{ 0 };
+
+    std::atomic<uint32_t> m_DroppedCount{ 0 };
+
+    alignas(CacheLineSize) uint8_t m_Buffer[Capacity];
+};
+
+namespace LogArgs
+{
+    template <typename T, typename = void>
+    struct Codec;
+
+    // Arithmetic types, enums and pointers are copied as they are.
+    template <typename T>
+    struct Codec<T, std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value || (std::is_pointer<T>::value && !std::is_same<std::remove_cv_t<std::remove_pointer_t<T>>, char>::value)>>
+    {
+        using Decoded = T;
+
+        static constexpr size_t FixedSize = sizeof(T);
+
+        static size_t StringSize(const T &) { return 0; }
+
+        static void Write(uint8_t *&cursor, size_t &, const T &value)
+        {
+            memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+        }
+
+        static T Read(const uint8_t *&cursor)
+        {
+            T value;
+            memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+    };
+
+    // Strings are copied into the record, their storage may be gone by the time it is formatted.
+    struct StringCodec
+    {
+        using Decoded = fmt::string_view;
+
+        static constexpr size_t FixedSize = sizeof(uint32_t);
+
+        static void WriteString(uint8_t *&cursor, size_t &budget, const char *data, size_t length)
+        {
+            uint32_t size = static_cast<uint32_t>(length < budget ? length : budget);
+            budget -= size;
+
+            memcpy(cursor, &size, sizeof(size));
+            memcpy(cursor + sizeof(size), data, size);
+            cursor += sizeof(size) + size;
+        }
+
+        static fmt::string_view Read(const uint8_t *&cursor)
+        {
+            uint32_t size;
+            memcpy(&size, cursor, sizeof(size));
+            fmt::string_view value{ reinterpret_cast<const char *>(cursor + sizeof(size)), size };
+            cursor += sizeof(size) + size;
+            return value;
+        }
+    };
+
+    template <typename T>
+    struct Codec<T, std::enable_if_t<std::is_pointer<T>::value && std::is_same<std::remove_cv_t<std::remove_pointer_t<T>>, char>::value>> : StringCodec
+    {
+        static size_t StringSize(const char *value) { return value ? strlen(value) : 6; }
+
+        static void Write(uint8_t *&cursor, size_t &budget, const char *value)
+        {
+            WriteString(cursor, budget, value ? value : "(null)", StringSize(value));
+        }
+    };
+
+    template <typename T>
+    struct Codec<T, std::enable_if_t<std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value || std::is_same<T, fmt::string_view>::value>> : StringCodec
+    {
+        static size_t StringSize(const T &value) { return value.size(); }
+
+        static void Write(uint8_t *&cursor, size_t &budget, const T &value)
+        {
+            WriteString(cursor, budget, value.data(), value.size());
+        }
+    };
+
+    // Anything else is formatted on the calling thread. Only reached by types with a custom formatter.
+    template <typename T>
+    struct Codec<T, std::enable_if_t<std::is_class<T>::value && !std::is_same<T, std::string>::value && !std::is_same<T, std::string_view>::value && !std::is_same<T, fmt::string_view>::value>> : StringCodec
+    {
+        static size_t StringSize(const T &value) { return fmt::formatted_size("{}", value); }
+
+        static void Write(uint8_t *&cursor, size_t &budget, const T &value)
+        {
+            fmt::basic_memory_buffer<char, 256> buffer;
+            fmt::format_to(std::back_inserter(buffer), "{}", value);
+            WriteString(cursor, budget, buffer.data(), buffer.size());
+        }
+    };
+
+    template <typename T>
+    using CodecOf = Codec<std::decay_t<T>>;
+
+    template <typename... Args>
+    void Decode(fmt::memory_buffer &out, const char *format, const uint8_t *payload)
+    {
+        const uint8_t *cursor = payload;
+        (void)cursor;
+
+        // Braced initialisation reads the arguments left to right.
+        std::tuple<typename CodecOf<Args>::Decoded...> values{ CodecOf<Args>::Read(cursor)... };
+        std::apply([&](auto &...decoded) { fmt::vformat_to(std::back_inserter(out), fmt::string_view{ format }, fmt::make_format_args(decoded...)); }, values);
+    }
+}
+
+struct LogThreadRing;
+
+// Asynchronous logging backend behind the LOG macros. Each thread that logs gets its own LogRing, so
+// logging costs an argument copy and a release store; formatting and the spdlog sinks run on the
+// logger thread. When the ring is full the message is dropped and counted, the caller never blocks.
+// Before Start() and after Stop() messages are formatted and written synchronously.
+class AsyncLogger : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t MaxRecordSize = 2048;
+
+    AsyncLogger() = default;
+
+    ~AsyncLogger();
+
+    void Start();
+
+    // Writes everything still queued. Call once the other threads have stopped logging.
+    void Stop();
+
+    bool IsRunning() const;
+
+    // Bumped by every Stop(), thread rings from an earlier run are registered again.
+    uint32_t GetGeneration() const;
+
+    // Blocks until every message logged before the call has been written.
+    void Flush();
+
+    template <typename... Args>
+    void Log(LogLevel level, const char *file, uint32_t line, LogRateLimiter &limiter, const char *format, const Args &...args)
+    {
+        if (!ShouldLog(level))
+        {
+            return;
+        }
+
+        int64_t timestamp = GetTimestamp();
+        uint32_t suppressedCount = 0;
+        if (!limiter.Allow(static_cast<uint64_t>(timestamp), suppressedCount))
+        {
+            return;
+        }
+
+        constexpr size_t fixedSize = sizeof(LogRecord) + (size_t{ 0 } + ... + LogArgs::CodecOf<Args>::FixedSize);
+        static_assert(fixedSize <= MaxRecordSize, "Too many arguments for one log message");
+
+        size_t budget = (size_t{ 0 } + ... + LogArgs::CodecOf<Args>::StringSize(args));
+        budget = budget < MaxRecordSize - fixedSize ? budget : MaxRecordSize - fixedSize;
+        uint32_t size = static_cast<uint32_t>((fixedSize + budget + 7) & ~size_t{ 7 });
+
+        alignas(LogRecord) uint8_t localRecord[MaxRecordSize];
+        LogRing *ring = IsRunning() ? GetThreadRing() : nullptr;
+        LogRecord *record = ring ? ring->Reserve(size) : reinterpret_cast<LogRecord *>(localRecord);
+        if (record == nullptr)
+        {
+            ring->CountDropped();
+            return;
+        }
+
+        record->size = size;
+        record->level = level;
+        record->padding = 0;
+        record->line = line;
+        record->suppressedCount = suppressedCount;
+        record->timestamp = timestamp;
+        record->format = format;
+        record->file = file;
+        record->decode = &LogArgs::Decode<Args...>;
+
+        uint8_t *cursor = reinterpret_cast<uint8_t *>(record + 1);
+        (void)cursor;
+        (LogArgs::CodecOf<Args>::Write(cursor, budget, args), ...);
+
+        if (ring)
+        {
+            ring->Commit();
+        }
+        else
+        {
+            WriteNow(*record);
+        }
+    }
+
+private:
+
+    static bool ShouldLog(LogLevel level);
+
+    static int64_t GetTimestamp();
+
+    LogRing *GetThreadRing();
+
+    void WriteNow(const LogRecord &record);
+
+    void Write(const LogRecord &record, fmt::memory_buffer &buffer);
+
+    void Run();
+
+    void DrainRings(const std::vector<LogThreadRing *> &rings, fmt::memory_buffer &buffer);
+
+    std::mutex m_Mutex;
+
+    std::condition_variable m_Wake;
+
+    std::condition_variable m_Flushed;
+
+    std::thread m_Thread;
+
+    std::atomic<bool> m_Running{ false };
+
+    bool m_StopRequested{ false };
+
+    std::atomic<uint32_t> m_Generation{ 0 };
+
+    uint64_t m_FlushRequested{ 0 };
+
+    uint64_t m_FlushCompleted{ 0 };
+
+    std::vector<std::unique_ptr<LogThreadRing>> m_Rings;
+
+    // Logger thread only.
+    std::vector<const LogRecord *> m_PendingRecords;
+};
+
+extern AsyncLogger g_AsyncLogger;
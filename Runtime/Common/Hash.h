@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Non-cryptographic 64-bit hashing for cache keys. Hashes raw bytes, so keys must not contain
+// uninitialised padding.
+namespace Hash
+{
+    static constexpr uint64_t DefaultSeed = 0x9e3779b97f4a7c15ull;
+
+    // Final mix of MurmurHash3.
+    inline uint64_t Mix(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    inline uint64_t Combine(uint64_t seed, uint64_t value)
+    {
+        return Mix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+    }
+
+    inline uint64_t Bytes(const void *data, size_t size, uint64_t seed = DefaultSeed)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        uint64_t hash = seed ^ (size * 0x87c37b91114253d5ull);
+
+        while (size >= sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            hash = (hash ^ Mix(word)) * 0x4cf5ad432745937full;
+            bytes += sizeof(word);
+            size -= sizeof(word);
+        }
+
+        if (size > 0)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes, size);
+            hash = (hash ^ Mix(word)) * 0x4cf5ad432745937full;
+        }
+
+        return Mix(hash);
+    }
+
+    inline uint64_t String(const std::string &value, uint64_t seed = DefaultSeed)
+    {
+        return Bytes(value.data(), value.size(), seed);
+    }
+}
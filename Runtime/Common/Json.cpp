@@ -0,0 +1,471 @@
+#include "Json.h"
+#include <cstring>
+#include <cstdlib>
+
+static const JsonValue s_NullValue{};
+
+static const std::string s_EmptyString{};
+
+class JsonParser
+{
+public:
+
+    JsonParser(const char *text, size_t length) :
+        m_Cursor{ text },
+        m_End{ text + length }
+    {
+    }
+
+    bool ParseDocument(JsonValue &result)
+    {
+        SkipWhitespace();
+        if (!ParseValue(result, 0))
+        {
+            return false;
+        }
+
+        SkipWhitespace();
+        return m_Cursor == m_End || Fail("Unexpected trailing characters");
+    }
+
+    const std::string &GetError() const
+    {
+        return m_Error;
+    }
+
+private:
+
+    static constexpr uint32_t MaxDepth = 256;
+
+    bool Fail(const char *message)
+    {
+        if (m_Error.empty())
+        {
+            m_Error = message;
+        }
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\n' || *m_Cursor == '\r'))
+        {
+            ++m_Cursor;
+        }
+    }
+
+    bool Consume(const char *literal)
+    {
+        size_t length = strlen(literal);
+        if (static_cast<size_t>(m_End - m_Cursor) < length || memcmp(m_Cursor, literal, length) != 0)
+        {
+            return false;
+        }
+
+        m_Cursor += length;
+        return true;
+    }
+
+    bool ParseValue(JsonValue &value, uint32_t depth)
+    {
+        if (depth > MaxDepth)
+        {
+            return Fail("Nesting too deep");
+        }
+
+        if (m_Cursor >= m_End)
+        {
+            return Fail("Unexpected end of input");
+        }
+
+        switch (*m_Cursor)
+        {
+        case '{':
+            return ParseObject(value, depth);
+        case '[':
+            return ParseArray(value, depth);
+        case '"':
+            value.m_Type = JsonValue::String;
+            return ParseString(value.m_String);
+        case 't':
+            value.m_Type = JsonValue::Bool;
+            value.m_Bool = true;
+            return Consume("true") || Fail("Invalid literal");
+        case 'f':
+            value.m_Type = JsonValue::Bool;
+            value.m_Bool = false;
+            return Consume("false") || Fail("Invalid literal");
+        case 'n':
+            value.m_Type = JsonValue::Null;
+            return Consume("null") || Fail("Invalid literal");
+        default:
+            return ParseNumber(value);
+        }
+    }
+
+    bool ParseNumber(JsonValue &value)
+    {
+        // strtod needs a terminated buffer, numbers are short so copy them out.
+        char buffer[64];
+        size_t length = 0;
+        while (m_Cursor + length < m_End && length < sizeof(buffer) - 1 && strchr("+-0123456789.eE", m_Cursor[length]) != nullptr)
+        {
+            buffer[length] = m_Cursor[length];
+            ++length;
+        }
+        buffer[length] = '\0';
+
+        char *end = nullptr;
+        value.m_Number = strtod(buffer, &end);
+        if (length == 0 || end != buffer + length)
+        {
+            return Fail("Invalid number");
+        }
+
+        value.m_Type = JsonValue::Number;
+        m_Cursor += length;
+        return true;
+    }
+
+    static void AppendUtf8(std::string &out, uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+        {
+            out.push_back(static_cast<char>(codepoint));
+        }
+        else if (codepoint < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else if (codepoint < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    bool ParseHex4(uint32_t &codepoint)
+    {
+        if (m_End - m_Cursor < 4)
+        {
+            return Fail("Truncated unicode escape");
+        }
+
+        codepoint = 0;
+        for (int digit = 0; digit < 4; ++digit)
+        {
+            char c = *m_Cursor++;
+            codepoint <<= 4;
+            if (c >= '0' && c <= '9')
+            {
+                codepoint |= c - '0';
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                codepoint |= c - 'a' + 10;
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                codepoint |= c - 'A' + 10;
+            }
+            else
+            {
+                return Fail("Invalid unicode escape");
+            }
+        }
+        return true;
+    }
+
+    bool ParseString(std::string &out)
+    {
+        ++m_Cursor;
+
+        while (m_Cursor < m_End && *m_Cursor != '"')
+        {
+            char c = *m_Cursor++;
+            if (c != '\\')
+            {
+                out.push_back(c);
+                continue;
+            }
+
+            if (m_Cursor >= m_End)
+            {
+                break;
+            }
+
+            char escape = *m_Cursor++;
+            switch (escape)
+            {
+            case '"':  out.push_back('"');  break;
+            case '\\': out.push_back('\\'); break;
+            case '/':  out.push_back('/');  break;
+            case 'b':  out.push_back('\b'); break;
+            case 'f':  out.push_back('\f'); break;
+            case 'n':  out.push_back('\n'); break;
+            case 'r':  out.push_back('\r'); break;
+            case 't':  out.push_back('\t'); break;
+            case 'u':
+            {
+                uint32_t codepoint = 0;
+                if (!ParseHex4(codepoint))
+                {
+                    return false;
+                }
+
+                // Surrogate pair
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF && Consume("\\u"))
+                {
+                    uint32_t low = 0;
+                    if (!ParseHex4(low))
+                    {
+                        return false;
+                    }
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                AppendUtf8(out, codepoint);
+                break;
+            }
+            default:
+                return Fail("Invalid escape sequence");
+            }
+        }
+
+        if (m_Cursor >= m_End)
+        {
+            return Fail("Unterminated string");
+        }
+
+        ++m_Cursor;
+        return true;
+    }
+
+    bool ParseArray(JsonValue &value, uint32_t depth)
+    {
+        value.m_Type = JsonValue::Array;
+        ++m_Cursor;
+
+        SkipWhitespace();
+        if (m_Cursor < m_End && *m_Cursor == ']')
+        {
+            ++m_Cursor;
+            return true;
+        }
+
+        while (true)
+        {
+            value.m_Elements.emplace_back();
+
+            SkipWhitespace();
+            if (!ParseValue(value.m_Elements.back(), depth + 1))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_Cursor < m_End && *m_Cursor == ',')
+            {
+                ++m_Cursor;
+                continue;
+            }
+
+            if (m_Cursor < m_End && *m_Cursor == ']')
+            {
+                ++m_Cursor;
+                return true;
+            }
+
+            return Fail("Expected ',' or ']'");
+        }
+    }
+
+    bool ParseObject(JsonValue &value, uint32_t depth)
+    {
+        value.m_Type = JsonValue::Object;
+        ++m_Cursor;
+
+        SkipWhitespace();
+        if (m_Cursor < m_End && *m_Cursor == '}')
+        {
+            ++m_Cursor;
+            return true;
+        }
+
+        while (true)
+        {
+            SkipWhitespace();
+            if (m_Cursor >= m_End || *m_Cursor != '"')
+            {
+                return Fail("Expected member name");
+            }
+
+            value.m_Members.emplace_back();
+            auto &member = value.m_Members.back();
+
+            if (!ParseString(member.first))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_Cursor >= m_End || *m_Cursor != ':')
+            {
+                return Fail("Expected ':'");
+            }
+            ++m_Cursor;
+
+            SkipWhitespace();
+            if (!ParseValue(member.second, depth + 1))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_Cursor < m_End && *m_Cursor == ',')
+            {
+                ++m_Cursor;
+                continue;
+            }
+
+            if (m_Cursor < m_End && *m_Cursor == '}')
+            {
+                ++m_Cursor;
+                return true;
+            }
+
+            return Fail("Expected ',' or '}'");
+        }
+    }
+
+    const char *m_Cursor{ nullptr };
+
+    const char *m_End{ nullptr };
+
+    std::string m_Error{};
+};
+
+bool JsonValue::Parse(const char *text, size_t length, JsonValue &result, std::string *error)
+{
+    result = JsonValue{};
+
+    JsonParser parser{ text, length };
+    if (!parser.ParseDocument(result))
+    {
+        if (error != nullptr)
+        {
+            *error = parser.GetError();
+        }
+        result = JsonValue{};
+        return false;
+    }
+
+    return true;
+}
+
+JsonValue::Type JsonValue::GetType() const
+{
+    return m_Type;
+}
+
+bool JsonValue::IsNull() const
+{
+    return m_Type == Null;
+}
+
+bool JsonValue::IsNumber() const
+{
+    return m_Type == Number;
+}
+
+bool JsonValue::IsString() const
+{
+    return m_Type == String;
+}
+
+bool JsonValue::IsArray() const
+{
+    return m_Type == Array;
+}
+
+bool JsonValue::IsObject() const
+{
+    return m_Type == Object;
+}
+
+bool JsonValue::AsBool(bool fallback) const
+{
+    return m_Type == Bool ? m_Bool : fallback;
+}
+
+double JsonValue::AsNumber(double fallback) const
+{
+    return m_Type == Number ? m_Number : fallback;
+}
+
+int64_t JsonValue::AsInt(int64_t fallback) const
+{
+    return m_Type == Number ? static_cast<int64_t>(m_Number) : fallback;
+}
+
+const std::string &JsonValue::AsString() const
+{
+    return m_Type == String ? m_String : s_EmptyString;
+}
+
+size_t JsonValue::Size() const
+{
+    if (m_Type == Array)
+    {
+        return m_Elements.size();
+    }
+    if (m_Type == Object)
+    {
+        return m_Members.size();
+    }
+    return 0;
+}
+
+const JsonValue &JsonValue::At(size_t index) const
+{
+    return (m_Type == Array && index < m_Elements.size()) ? m_Elements[index] : s_NullValue;
+}
+
+const JsonValue &JsonValue::operator[](const char *key) const
+{
+    if (m_Type == Object)
+    {
+        for (const auto &member : m_Members)
+        {
+            if (member.first == key)
+            {
+                return member.second;
+            }
+        }
+    }
+    return s_NullValue;
+}
+
+bool JsonValue::Has(const char *key) const
+{
+    return !(*this)[key].IsNull();
+}
+
+const std::vector<JsonValue> &JsonValue::GetElements() const
+{
+    return m_Elements;
+}
+
+const std::vector<std::pair<std::string, JsonValue>> &JsonValue::GetMembers() const
+{
+    return m_Members;
+}
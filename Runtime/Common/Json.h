@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+// Minimal read-only JSON document, enough for asset manifests such as glTF.
+class JsonValue
+{
+public:
+
+    enum Type
+    {
+        Null,
+
+        Bool,
+
+        Number,
+
+        String,
+
+        Array,
+
+        Object,
+    };
+
+    static bool Parse(const char *text, size_t length, JsonValue &result, std::string *error = nullptr);
+
+    Type GetType() const;
+
+    bool IsNull() const;
+
+    bool IsNumber() const;
+
+    bool IsString() const;
+
+    bool IsArray() const;
+
+    bool IsObject() const;
+
+    bool AsBool(bool fallback = false) const;
+
+    double AsNumber(double fallback = 0.0) const;
+
+    int64_t AsInt(int64_t fallback = 0) const;
+
+    const std::string &AsString() const;
+
+    size_t Size() const;
+
+    // Array element; returns a null value when out of range.
+    const JsonValue &At(size_t index) const;
+
+    // Object member; returns a null value when missing.
+    const JsonValue &operator[](const char *key) const;
+
+    bool Has(const char *key) const;
+
+    const std::vector<JsonValue> &GetElements() const;
+
+    const std::vector<std::pair<std::string, JsonValue>> &GetMembers() const;
+
+private:
+
+    friend class JsonParser;
+
+    Type m_Type{ Null };
+
+    bool m_Bool{ false };
+
+    double m_Number{ 0.0 };
+
+    std::string m_String{};
+
+    std::vector<JsonValue> m_Elements{};
+
+    std::vector<std::pair<std::string, JsonValue>> m_Members{};
+};
@@ -1,14 +1,56 @@
-
 #pragma once
 
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/spdlog.h>
+#include "AsyncLogger.h"
 
 #define LOGGER_FORMAT "[%^%l%$] %v"
 
 #define __FILENAME__ (static_cast<const char *>(__FILE__)/* + ROOT_PATH_SIZE*/)
 
-#define LOGI(...) spdlog::info(__VA_ARGS__);
-#define LOGW(...) spdlog::warn(__VA_ARGS__);
-#define LOGE(...) spdlog::error("[{}:{}] {}", __FILENAME__, __LINE__, fmt::format(__VA_ARGS__));
-#define LOGD(...) spdlog::debug(__VA_ARGS__);
+// Messages below NEXT_RENDER_LOG_LEVEL are compiled out, arguments included.
+#define NEXT_RENDER_LOG_LEVEL_DEBUG 0
+#define NEXT_RENDER_LOG_LEVEL_INFO 1
+#define NEXT_RENDER_LOG_LEVEL_WARNING 2
+#define NEXT_RENDER_LOG_LEVEL_ERROR 3
+#define NEXT_RENDER_LOG_LEVEL_OFF 4
+
+#ifndef NEXT_RENDER_LOG_LEVEL
+#ifdef NDEBUG
+#define NEXT_RENDER_LOG_LEVEL NEXT_RENDER_LOG_LEVEL_INFO
+#else
+#define NEXT_RENDER_LOG_LEVEL NEXT_RENDER_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// The format must be a string literal, it is only read when the logger thread formats the message.
+#define NEXT_RENDER_LOG(level, ...)                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        static LogRateLimiter logRateLimiter;                                           \
+        g_AsyncLogger.Log(level, __FILENAME__, __LINE__, logRateLimiter, __VA_ARGS__);  \
+    } while (0)
+
+#if NEXT_RENDER_LOG_LEVEL <= NEXT_RENDER_LOG_LEVEL_INFO
+#define LOGI(...) NEXT_RENDER_LOG(LogLevel::Info, __VA_ARGS__);
+#else
+#define LOGI(...)
+#endif
+
+#if NEXT_RENDER_LOG_LEVEL <= NEXT_RENDER_LOG_LEVEL_WARNING
+#define LOGW(...) NEXT_RENDER_LOG(LogLevel::Warning, __VA_ARGS__);
+#else
+#define LOGW(...)
+#endif
+
+#if NEXT_RENDER_LOG_LEVEL <= NEXT_RENDER_LOG_LEVEL_ERROR
+#define LOGE(...) NEXT_RENDER_LOG(LogLevel::Error, __VA_ARGS__);
+#else
+#define LOGE(...)
+#endif
+
+#if NEXT_RENDER_LOG_LEVEL <= NEXT_RENDER_LOG_LEVEL_DEBUG
+#define LOGD(...) NEXT_RENDER_LOG(LogLevel::Debug, __VA_ARGS__);
+#else
+#define LOGD(...)
+#endif
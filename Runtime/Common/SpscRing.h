@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Utils.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Fixed capacity lock-free queue for exactly one producer and one consumer thread. Elements are
+// copied in and out, so T must be trivially copyable; nothing is ever allocated after construction.
+template <typename T, uint32_t Capacity>
+class SpscRing : public NonCopyable
+{
+public:
+
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing elements are copied with plain stores");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    // Producer only. Returns false when the ring is full.
+    bool Push(const T &element)
+    {
+        uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead == Capacity)
+        {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail - m_CachedHead == Capacity)
+            {
+                return false;
+            }
+        }
+
+        m_Elements[tail & (Capacity - 1)] = element;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when the ring is empty.
+    bool Pop(T &element)
+    {
+        uint32_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_CachedTail)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (head == m_CachedTail)
+            {
+                return false;
+            }
+        }
+
+        element = m_Elements[head & (Capacity - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Pops up to maxCount elements with a single release of the slots.
+    uint32_t PopBatch(T *elements, uint32_t maxCount)
+    {
+        uint32_t head = m_Head.load(std::memory_order_relaxed);
+        m_CachedTail = m_Tail.load(std::memory_order_acquire);
+
+        uint32_t count = m_CachedTail - head;
+        count = count < maxCount ? count : maxCount;
+
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            elements[index] = m_Elements[(head + index) & (Capacity - 1)];
+        }
+
+        m_Head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate when called concurrently with the other side.
+    uint32_t GetSize() const
+    {
+        return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire);
+    }
+
+    static constexpr uint32_t GetCapacity()
+    {
+        return Capacity;
+    }
+
+private:
+
+    static constexpr size_t CacheLineSize = 64;
+
+    // Head and tail on separate lines so the two threads don't false share, each side caches the
+    // other's index to avoid touching its line on every call.
+    alignas(CacheLineSize) std::atomic<uint32_t> m_Head{ 0 };
+
+    uint32_t m_CachedTail{ 0 };
+
+    alignas(CacheLineSize) std::atomic<uint32_t> m_Tail{ 0 };
+
+    uint32_t m_CachedHead{ 0 };
+
+    alignas(CacheLineSize) T m_Elements[Capacity];
+};
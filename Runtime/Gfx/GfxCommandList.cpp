@@ -0,0 +1,196 @@
+#include "GfxCommandList.h"
+#include "../Memory/Memory.h"
+#include <algorithm>
+
+static constexpr uint32_t CommandAlignment = 4;
+
+static uint32_t AlignCommandSize(uint32_t size)
+{
+    return (size + CommandAlignment - 1) & ~(CommandAlignment - 1);
+}
+
+static constexpr uint32_t ChunkHeaderSize = 16;
+
+GfxCommandList::GfxCommandList(uint32_t chunkSize) :
+    m_ChunkSize{ chunkSize }
+{
+    static_assert(sizeof(Chunk) <= ChunkHeaderSize, "Chunk header must fit before the commands");
+    assert(chunkSize > ChunkHeaderSize + sizeof(GfxCommandHeader) + sizeof(GfxPushConstantsCommand) + MaxPushConstantsSize);
+}
+
+GfxCommandList::~GfxCommandList()
+{
+    Chunk *chunk = m_FirstChunk;
+    while (chunk != nullptr)
+    {
+        Chunk *next = chunk->next;
+        Memory::Free(chunk, ChunkHeaderSize + chunk->capacity, alignof(Chunk), MemoryTag::Gfx);
+        chunk = next;
+    }
+}
+
+uint8_t *GfxCommandList::GetChunkData(Chunk *chunk)
+{
+    return reinterpret_cast<uint8_t *>(chunk) + ChunkHeaderSize;
+}
+
+void GfxCommandList::Reset()
+{
+    m_CurrentChunk = m_FirstChunk;
+    if (m_CurrentChunk != nullptr)
+    {
+        m_CurrentChunk->used = 0;
+    }
+    m_CommandCount = 0;
+    m_FullChunkBytes = 0;
+}
+
+void *GfxCommandList::Allocate(GfxCommandType type, uint32_t payloadSize)
+{
+    uint32_t size = AlignCommandSize(sizeof(GfxCommandHeader) + payloadSize);
+    assert(size <= 0xffff);
+
+    // Commands never straddle chunks, the rest of a chunk that is too small stays unused.
+    if (m_CurrentChunk == nullptr || m_CurrentChunk->used + size > m_CurrentChunk->capacity)
+    {
+        Chunk *next = m_CurrentChunk != nullptr ? m_CurrentChunk->next : m_FirstChunk;
+        if (next == nullptr)
+        {
+            uint32_t capacity = std::max(m_ChunkSize - ChunkHeaderSize, size);
+            next = static_cast<Chunk *>(Memory::Allocate(ChunkHeaderSize + capacity, alignof(Chunk), MemoryTag::Gfx));
+            next->next = nullptr;
+            next->capacity = capacity;
+            m_Capacity += capacity;
+
+            if (m_CurrentChunk != nullptr)
+            {
+                m_CurrentChunk->next = next;
+            }
+            else
+            {
+                m_FirstChunk = next;
+            }
+        }
+
+        if (m_CurrentChunk != nullptr)
+        {
+            m_FullChunkBytes += m_CurrentChunk->used;
+        }
+        m_CurrentChunk = next;
+        m_CurrentChunk->used = 0;
+    }
+
+    GfxCommandHeader *header = reinterpret_cast<GfxCommandHeader *>(GetChunkData(m_CurrentChunk) + m_CurrentChunk->used);
+    header->type = type;
+    header->padding = 0;
+    header->size = static_cast<uint16_t>(size);
+
+    m_CurrentChunk->used += size;
+    ++m_CommandCount;
+    return header + 1;
+}
+
+void GfxCommandList::BindPipeline(uint32_t pipeline)
+{
+    Push<GfxBindPipelineCommand>(GfxCommandType::BindPipeline) = GfxBindPipelineCommand{ pipeline };
+}
+
+void GfxCommandList::BindDescriptorSet(uint32_t slot, uint32_t set)
+{
+    assert(slot < MaxDescriptorSets);
+    Push<GfxBindDescriptorSetCommand>(GfxCommandType::BindDescriptorSet) = GfxBindDescriptorSetCommand{ slot, set };
+}
+
+void GfxCommandList::BindVertexBuffer(uint32_t binding, uint32_t buffer, uint32_t offset)
+{
+    assert(binding < MaxVertexBuffers);
+    Push<GfxBindVertexBufferCommand>(GfxCommandType::BindVertexBuffer) = GfxBindVertexBufferCommand{ binding, buffer, offset };
+}
+
+void GfxCommandList::BindIndexBuffer(uint32_t buffer, uint32_t offset, GfxIndexType indexType)
+{
+    Push<GfxBindIndexBufferCommand>(GfxCommandType::BindIndexBuffer) = GfxBindIndexBufferCommand{ buffer, offset, indexType };
+}
+
+void GfxCommandList::SetViewport(const GfxViewport &viewport)
+{
+    Push<GfxViewport>(GfxCommandType::SetViewport) = viewport;
+}
+
+void GfxCommandList::SetScissor(const GfxScissor &scissor)
+{
+    Push<GfxScissor>(GfxCommandType::SetScissor) = scissor;
+}
+
+void GfxCommandList::PushConstants(uint32_t offset, const void *data, uint32_t size)
+{
+    assert(offset + size <= MaxPushConstantsSize);
+
+    void *payload = Allocate(GfxCommandType::PushConstants, sizeof(GfxPushConstantsCommand) + size);
+    GfxPushConstantsCommand *command = static_cast<GfxPushConstantsCommand *>(payload);
+    command->offset = static_cast<uint16_t>(offset);
+    command->size = static_cast<uint16_t>(size);
+    std::memcpy(command + 1, data, size);
+}
+
+void GfxCommandList::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    Push<GfxDrawCommand>(GfxCommandType::Draw) = GfxDrawCommand{ vertexCount, instanceCount, firstVertex, firstInstance };
+}
+
+void GfxCommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    Push<GfxDrawIndexedCommand>(GfxCommandType::DrawIndexed) = GfxDrawIndexedCommand{ indexCount, instanceCount, firstIndex, vertexOffset, firstInstance };
+}
+
+void GfxCommandList::DrawIndexedIndirect(uint32_t buffer, uint32_t offset, uint32_t drawCount, uint32_t stride)
+{
+    Push<GfxDrawIndexedIndirectCommand>(GfxCommandType::DrawIndexedIndirect) = GfxDrawIndexedIndirectCommand{ buffer, offset, drawCount, stride };
+}
+
+void GfxCommandList::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    Push<GfxDispatchCommand>(GfxCommandType::Dispatch) = GfxDispatchCommand{ groupCountX, groupCountY, groupCountZ };
+}
+
+uint32_t GfxCommandList::GetCommandCount() const
+{
+    return m_CommandCount;
+}
+
+size_t GfxCommandList::GetUsedBytes() const
+{
+    return m_FullChunkBytes + (m_CurrentChunk != nullptr ? m_CurrentChunk->used : 0);
+}
+
+size_t GfxCommandList::GetCapacity() const
+{
+    return m_Capacity;
+}
+
+GfxCommandList::Reader::Reader(const GfxCommandList &commandList) :
+    m_CommandList{ commandList },
+    m_Chunk{ commandList.m_CommandCount > 0 ? commandList.m_FirstChunk : nullptr }
+{
+}
+
+const GfxCommandHeader *GfxCommandList::Reader::Next()
+{
+    const Chunk *chunk = static_cast<const Chunk *>(m_Chunk);
+
+    while (chunk != nullptr && m_Offset >= chunk->used)
+    {
+        chunk = chunk != m_CommandList.m_CurrentChunk ? chunk->next : nullptr;
+        m_Offset = 0;
+    }
+
+    m_Chunk = chunk;
+    if (chunk == nullptr)
+    {
+        return nullptr;
+    }
+
+    const GfxCommandHeader *header = reinterpret_cast<const GfxCommandHeader *>(reinterpret_cast<const uint8_t *>(chunk) + ChunkHeaderSize + m_Offset);
+    m_Offset += header->size;
+    return header;
+}
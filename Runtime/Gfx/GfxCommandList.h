@@ -0,0 +1,477 @@
+#pragma once
+
+#include "../Common/Utils.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+enum class GfxCommandType : uint8_t
+{
+    BindPipeline,
+
+    BindDescriptorSet,
+
+    BindVertexBuffer,
+
+    BindIndexBuffer,
+
+    SetViewport,
+
+    SetScissor,
+
+    PushConstants,
+
+    Draw,
+
+    DrawIndexed,
+
+    DrawIndexedIndirect,
+
+    Dispatch,
+};
+
+enum class GfxIndexType : uint8_t
+{
+    Uint16,
+
+    Uint32,
+};
+
+// Every command is this header followed by its payload, both 4-byte aligned. size covers the header.
+struct GfxCommandHeader
+{
+    GfxCommandType type;
+
+    uint8_t padding;
+
+    uint16_t size;
+
+    template <typename T>
+    const T &GetPayload() const
+    {
+        return *reinterpret_cast<const T *>(this + 1);
+    }
+};
+
+// Pipelines, descriptor sets and buffers are indices into tables the backend resolves when translating,
+// so recording never touches backend objects.
+struct GfxBindPipelineCommand
+{
+    uint32_t pipeline;
+};
+
+struct GfxBindDescriptorSetCommand
+{
+    uint32_t slot;
+
+    uint32_t set;
+};
+
+struct GfxBindVertexBufferCommand
+{
+    uint32_t binding;
+
+    uint32_t buffer;
+
+    uint32_t offset;
+};
+
+struct GfxBindIndexBufferCommand
+{
+    uint32_t buffer;
+
+    uint32_t offset;
+
+    GfxIndexType indexType;
+};
+
+struct GfxViewport
+{
+    float x;
+
+    float y;
+
+    float width;
+
+    float height;
+
+    float minDepth;
+
+    float maxDepth;
+};
+
+struct GfxScissor
+{
+    int32_t x;
+
+    int32_t y;
+
+    uint32_t width;
+
+    uint32_t height;
+};
+
+// Followed by size bytes of data, padded to 4.
+struct GfxPushConstantsCommand
+{
+    uint16_t offset;
+
+    uint16_t size;
+};
+
+struct GfxDrawCommand
+{
+    uint32_t vertexCount;
+
+    uint32_t instanceCount;
+
+    uint32_t firstVertex;
+
+    uint32_t firstInstance;
+};
+
+struct GfxDrawIndexedCommand
+{
+    uint32_t indexCount;
+
+    uint32_t instanceCount;
+
+    uint32_t firstIndex;
+
+    int32_t vertexOffset;
+
+    uint32_t firstInstance;
+};
+
+struct GfxDrawIndexedIndirectCommand
+{
+    uint32_t buffer;
+
+    uint32_t offset;
+
+    uint32_t drawCount;
+
+    uint32_t stride;
+};
+
+struct GfxDispatchCommand
+{
+    uint32_t groupCountX;
+
+    uint32_t groupCountY;
+
+    uint32_t groupCountZ;
+};
+
+// Backend independent list of draw and dispatch commands, packed as opcode plus payload into chunks the
+// list keeps across Reset(), so recording a frame no larger than an earlier one never allocates. A list
+// is recorded by one thread at a time; record one list per worker and translate them in order.
+//
+// Byte offsets are 32-bit, buffers bound through a command list must stay below 4 GB.
+class GfxCommandList : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t MaxDescriptorSets = 4;
+
+    static constexpr uint32_t MaxVertexBuffers = 4;
+
+    static constexpr uint32_t MaxPushConstantsSize = 128;
+
+    explicit GfxCommandList(uint32_t chunkSize = 16 * 1024);
+
+    ~GfxCommandList();
+
+    // Drops the commands, keeps the chunks.
+    void Reset();
+
+    void BindPipeline(uint32_t pipeline);
+
+    void BindDescriptorSet(uint32_t slot, uint32_t set);
+
+    void BindVertexBuffer(uint32_t binding, uint32_t buffer, uint32_t offset = 0);
+
+    void BindIndexBuffer(uint32_t buffer, uint32_t offset, GfxIndexType indexType);
+
+    void SetViewport(const GfxViewport &viewport);
+
+    void SetScissor(const GfxScissor &scissor);
+
+    void PushConstants(uint32_t offset, const void *data, uint32_t size);
+
+    void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+
+    void DrawIndexedIndirect(uint32_t buffer, uint32_t offset, uint32_t drawCount, uint32_t stride);
+
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+    uint32_t GetCommandCount() const;
+
+    // Bytes of recorded commands, headers included.
+    size_t GetUsedBytes() const;
+
+    size_t GetCapacity() const;
+
+    // Walks the commands in record order. The list must not be recorded to meanwhile.
+    class Reader
+    {
+    public:
+
+        explicit Reader(const GfxCommandList &commandList);
+
+        // Null after the last command.
+        const GfxCommandHeader *Next();
+
+    private:
+
+        const GfxCommandList &m_CommandList;
+
+        const void *m_Chunk{ nullptr };
+
+        uint32_t m_Offset{ 0 };
+    };
+
+private:
+
+    struct Chunk
+    {
+        Chunk *next;
+
+        uint32_t capacity;
+
+        // Bytes recorded into the chunk, only meaningful up to the current chunk.
+        uint32_t used;
+    };
+
+    static uint8_t *GetChunkData(Chunk *chunk);
+
+    void *Allocate(GfxCommandType type, uint32_t payloadSize);
+
+    template <typename T>
+    T &Push(GfxCommandType type)
+    {
+        static_assert(alignof(T) <= 4, "Command payloads are 4-byte aligned");
+        return *static_cast<T *>(Allocate(type, sizeof(T)));
+    }
+
+    uint32_t m_ChunkSize{ 0 };
+
+    Chunk *m_FirstChunk{ nullptr };
+
+    Chunk *m_CurrentChunk{ nullptr };
+
+    uint32_t m_CommandCount{ 0 };
+
+    // Bytes in the chunks before the current one.
+    size_t m_FullChunkBytes{ 0 };
+
+    size_t m_Capacity{ 0 };
+};
+
+struct GfxCommandReplayStats
+{
+    uint32_t commandCount{ 0 };
+
+    // State changes dropped because the state was already bound.
+    uint32_t skippedCount{ 0 };
+};
+
+// Replays command lists into a backend visitor in one pass, dropping state changes that bind what is
+// already bound. The visitor provides:
+//
+//     bool BindPipeline(uint32_t pipeline)    true when the descriptor sets must be bound again
+//     void BindDescriptorSet(uint32_t slot, uint32_t set)
+//     void BindVertexBuffer(uint32_t binding, uint32_t buffer, uint32_t offset)
+//     void BindIndexBuffer(uint32_t buffer, uint32_t offset, GfxIndexType indexType)
+//     void SetViewport(const GfxViewport &viewport)
+//     void SetScissor(const GfxScissor &scissor)
+//     void PushConstants(uint32_t offset, const void *data, uint32_t size)
+//     void Draw(const GfxDrawCommand &command), and likewise DrawIndexed, DrawIndexedIndirect and Dispatch
+//
+// The bound state carries over between Replay() calls, call Invalidate() when starting a new backend
+// command buffer.
+class GfxCommandReplayer : public NonCopyable
+{
+public:
+
+    void Invalidate()
+    {
+        m_Pipeline = InvalidIndex;
+        InvalidateDescriptorSets();
+        for (VertexBufferState &vertexBuffer : m_VertexBuffers)
+        {
+            vertexBuffer.buffer = InvalidIndex;
+        }
+        m_IndexBuffer.buffer = InvalidIndex;
+        m_HasViewport = false;
+        m_HasScissor = false;
+    }
+
+    template <typename Visitor>
+    void Replay(const GfxCommandList &commandList, Visitor &visitor)
+    {
+        GfxCommandList::Reader reader{ commandList };
+        while (const GfxCommandHeader *header = reader.Next())
+        {
+            ++m_Stats.commandCount;
+
+            switch (header->type)
+            {
+            case GfxCommandType::BindPipeline:
+            {
+                uint32_t pipeline = header->GetPayload<GfxBindPipelineCommand>().pipeline;
+                if (pipeline == m_Pipeline)
+                {
+                    ++m_Stats.skippedCount;
+                    break;
+                }
+
+                m_Pipeline = pipeline;
+                if (visitor.BindPipeline(pipeline))
+                {
+                    InvalidateDescriptorSets();
+                }
+                break;
+            }
+            case GfxCommandType::BindDescriptorSet:
+            {
+                const GfxBindDescriptorSetCommand &command = header->GetPayload<GfxBindDescriptorSetCommand>();
+                assert(command.slot < GfxCommandList::MaxDescriptorSets);
+                if (m_DescriptorSets[command.slot] == command.set)
+                {
+                    ++m_Stats.skippedCount;
+                    break;
+                }
+
+                m_DescriptorSets[command.slot] = command.set;
+                visitor.BindDescriptorSet(command.slot, command.set);
+                break;
+            }
+            case GfxCommandType::BindVertexBuffer:
+            {
+                const GfxBindVertexBufferCommand &command = header->GetPayload<GfxBindVertexBufferCommand>();
+                assert(command.binding < GfxCommandList::MaxVertexBuffers);
+                VertexBufferState &state = m_VertexBuffers[command.binding];
+                if (state.buffer == command.buffer && state.offset == command.offset)
+                {
+                    ++m_Stats.skippedCount;
+                    break;
+                }
+
+                state.buffer = command.buffer;
+                state.offset = command.offset;
+                visitor.BindVertexBuffer(command.binding, command.buffer, command.offset);
+                break;
+            }
+            case GfxCommandType::BindIndexBuffer:
+            {
+                const GfxBindIndexBufferCommand &command = header->GetPayload<GfxBindIndexBufferCommand>();
+                if (m_IndexBuffer.buffer == command.buffer && m_IndexBuffer.offset == command.offset && m_IndexBuffer.indexType == command.indexType)
+                {
+                    ++m_Stats.skippedCount;
+                    break;
+                }
+
+                m_IndexBuffer = command;
+                visitor.BindIndexBuffer(command.buffer, command.offset, command.indexType);
+                break;
+            }
+            case GfxCommandType::SetViewport:
+            {
+                const GfxViewport &viewport = header->GetPayload<GfxViewport>();
+                if (m_HasViewport && std::memcmp(&m_Viewport, &viewport, sizeof(GfxViewport)) == 0)
+                {
+                    ++m_Stats.skippedCount;
+                    break;
+                }
+
+                m_Viewport = viewport;
+                m_HasViewport = true;
+                visitor.SetViewport(viewport);
+                break;
+            }
+            case GfxCommandType::SetScissor:
+            {
+                const GfxScissor &scissor = header->GetPayload<GfxScissor>();
+                if (m_HasScissor && std::memcmp(&m_Scissor, &scissor, sizeof(GfxScissor)) == 0)
+                {
+                    ++m_Stats.skippedCount;
+                    break;
+                }
+
+                m_Scissor = scissor;
+                m_HasScissor = true;
+                visitor.SetScissor(scissor);
+                break;
+            }
+            case GfxCommandType::PushConstants:
+            {
+                const GfxPushConstantsCommand &command = header->GetPayload<GfxPushConstantsCommand>();
+                visitor.PushConstants(command.offset, &command + 1, command.size);
+                break;
+            }
+            case GfxCommandType::Draw:
+                visitor.Draw(header->GetPayload<GfxDrawCommand>());
+                break;
+            case GfxCommandType::DrawIndexed:
+                visitor.DrawIndexed(header->GetPayload<GfxDrawIndexedCommand>());
+                break;
+            case GfxCommandType::DrawIndexedIndirect:
+                visitor.DrawIndexedIndirect(header->GetPayload<GfxDrawIndexedIndirectCommand>());
+                break;
+            case GfxCommandType::Dispatch:
+                visitor.Dispatch(header->GetPayload<GfxDispatchCommand>());
+                break;
+            }
+        }
+    }
+
+    const GfxCommandReplayStats &GetStats() const
+    {
+        return m_Stats;
+    }
+
+    void ResetStats()
+    {
+        m_Stats = GfxCommandReplayStats{};
+    }
+
+private:
+
+    static constexpr uint32_t InvalidIndex = 0xffffffffu;
+
+    struct VertexBufferState
+    {
+        uint32_t buffer{ InvalidIndex };
+
+        uint32_t offset{ 0 };
+    };
+
+    void InvalidateDescriptorSets()
+    {
+        for (uint32_t &set : m_DescriptorSets)
+        {
+            set = InvalidIndex;
+        }
+    }
+
+    uint32_t m_Pipeline{ InvalidIndex };
+
+    uint32_t m_DescriptorSets[GfxCommandList::MaxDescriptorSets]{ InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex };
+
+    VertexBufferState m_VertexBuffers[GfxCommandList::MaxVertexBuffers];
+
+    GfxBindIndexBufferCommand m_IndexBuffer{ InvalidIndex, 0, GfxIndexType::Uint32 };
+
+    GfxViewport m_Viewport{};
+
+    GfxScissor m_Scissor{};
+
+    bool m_HasViewport{ false };
+
+    bool m_HasScissor{ false };
+
+    GfxCommandReplayStats m_Stats{};
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// 32-bit reference to a pooled resource: 20 bits of slot index and 12 bits of generation. The
+// generation changes whenever a slot is released, so a stale handle is caught by one compare instead
+// of reaching whatever took the slot over. Generation 0 is never used, a zero handle is always null.
+template <typename Tag>
+struct GfxHandle
+{
+    static constexpr uint32_t IndexBits = 20;
+
+    static constexpr uint32_t GenerationBits = 32 - IndexBits;
+
+    static constexpr uint32_t MaxIndex = (1u << IndexBits) - 1;
+
+    static constexpr uint32_t MaxGeneration = (1u << GenerationBits) - 1;
+
+    uint32_t value{ 0 };
+
+    static GfxHandle Make(uint32_t index, uint32_t generation)
+    {
+        return GfxHandle{ (generation << IndexBits) | index };
+    }
+
+    uint32_t GetIndex() const { return value & MaxIndex; }
+
+    uint32_t GetGeneration() const { return value >> IndexBits; }
+
+    bool IsNull() const { return value == 0; }
+
+    explicit operator bool() const { return value != 0; }
+
+    bool operator==(const GfxHandle &other) const { return value == other.value; }
+
+    bool operator!=(const GfxHandle &other) const { return value != other.value; }
+};
+
+struct ShaderHandleTag;
+
+struct TextureHandleTag;
+
+struct BufferHandleTag;
+
+struct SamplerHandleTag;
+
+using ShaderHandle = GfxHandle<ShaderHandleTag>;
+
+using TextureHandle = GfxHandle<TextureHandleTag>;
+
+using BufferHandle = GfxHandle<BufferHandleTag>;
+
+using SamplerHandle = GfxHandle<SamplerHandleTag>;
+
+static_assert(sizeof(ShaderHandle) == sizeof(uint32_t), "Handles must stay 32-bit");
+
+namespace std
+{
+    template <typename Tag>
+    struct hash<GfxHandle<Tag>>
+    {
+        size_t operator()(const GfxHandle<Tag> &handle) const { return std::hash<uint32_t>{}(handle.value); }
+    };
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "../Common/Utils.h"
+#include "GfxHandle.h"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Owns objects of type T in fixed pages of slots and hands out generational handles to them. Objects
+// never move, Get() is lock free and a stale handle returns null. Create and release take a mutex.
+//
+// Release() invalidates a handle at once but keeps the object alive until CollectReleased() is told
+// the frame it was released in has finished on the GPU, so in-flight command buffers can still use it.
+template <typename T, typename Handle>
+class GfxHandlePool : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t PageSize = 256;
+
+    static constexpr uint32_t MaxPages = (Handle::MaxIndex + 1) / PageSize;
+
+    GfxHandlePool() :
+        m_Pages{ new std::atomic<Page *>[MaxPages] {} }
+    {
+    }
+
+    ~GfxHandlePool()
+    {
+        Clear();
+
+        for (uint32_t page = 0; page < MaxPages; ++page)
+        {
+            delete m_Pages[page].load(std::memory_order_relaxed);
+        }
+    }
+
+    template <typename... Args>
+    Handle Create(Args &&...args)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        uint32_t index = m_FreeHead;
+        if (index != InvalidIndex)
+        {
+            m_FreeHead = GetSlot(index).nextFree;
+        }
+        else
+        {
+            index = m_SlotCount;
+            assert(index <= Handle::MaxIndex && "Out of handle slots");
+
+            uint32_t page = index / PageSize;
+            if (m_Pages[page].load(std::memory_order_relaxed) == nullptr)
+            {
+                m_Pages[page].store(new Page{}, std::memory_order_release);
+            }
+            ++m_SlotCount;
+        }
+
+        Slot &slot = GetSlot(index);
+        new (slot.storage) T(std::forward<Args>(args)...);
+
+        // Skips generation 0, which marks a slot without a live handle.
+        slot.lastGeneration = slot.lastGeneration % Handle::MaxGeneration + 1;
+        slot.generation.store(slot.lastGeneration, std::memory_order_release);
+        ++m_LiveCount;
+
+        return Handle::Make(index, slot.lastGeneration);
+    }
+
+    T *Get(Handle handle) const
+    {
+        if (handle.IsNull())
+        {
+            return nullptr;
+        }
+
+        const Page *page = m_Pages[handle.GetIndex() / PageSize].load(std::memory_order_acquire);
+        if (page == nullptr)
+        {
+            return nullptr;
+        }
+
+        const Slot &slot = page->slots[handle.GetIndex() % PageSize];
+        if (slot.generation.load(std::memory_order_acquire) != handle.GetGeneration())
+        {
+            return nullptr;
+        }
+
+        return std::launder(reinterpret_cast<T *>(const_cast<unsigned char *>(slot.storage)));
+    }
+
+    bool IsValid(Handle handle) const
+    {
+        return Get(handle) != nullptr;
+    }
+
+    // The object is destroyed by the first CollectReleased() with completedFrame >= releaseFrame.
+    void Release(Handle handle, uint64_t releaseFrame)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        if (!Invalidate(handle))
+        {
+            return;
+        }
+
+        m_PendingReleases.push_back(PendingRelease{ handle.GetIndex(), releaseFrame });
+    }
+
+    // Destroys the object right away, only for objects the GPU cannot be using.
+    void Destroy(Handle handle)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        if (Invalidate(handle))
+        {
+            FreeSlot(handle.GetIndex());
+        }
+    }
+
+    void CollectReleased(uint64_t completedFrame)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        size_t kept = 0;
+        for (size_t index = 0; index < m_PendingReleases.size(); ++index)
+        {
+            const PendingRelease &release = m_PendingReleases[index];
+            if (release.frame <= completedFrame)
+            {
+                FreeSlot(release.slot);
+            }
+            else
+            {
+                m_PendingReleases[kept++] = release;
+            }
+        }
+        m_PendingReleases.resize(kept);
+    }
+
+    // Destroys every object, pending releases included. Outstanding handles turn stale.
+    void Clear()
+    {
+        std::lock_guard lock(m_Mutex);
+
+        for (uint32_t index = 0; index < m_SlotCount; ++index)
+        {
+            Slot &slot = GetSlot(index);
+            if (slot.generation.load(std::memory_order_relaxed) != 0)
+            {
+                slot.generation.store(0, std::memory_order_release);
+                --m_LiveCount;
+                FreeSlot(index);
+            }
+        }
+
+        for (const PendingRelease &release : m_PendingReleases)
+        {
+            FreeSlot(release.slot);
+        }
+        m_PendingReleases.clear();
+    }
+
+    // Objects with a valid handle, pending releases excluded.
+    uint32_t GetCount() const
+    {
+        std::lock_guard lock(m_Mutex);
+        return m_LiveCount;
+    }
+
+    uint32_t GetPendingReleaseCount() const
+    {
+        std::lock_guard lock(m_Mutex);
+        return static_cast<uint32_t>(m_PendingReleases.size());
+    }
+
+private:
+
+    static constexpr uint32_t InvalidIndex = ~0u;
+
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        // Generation of the live handle, 0 while the slot is free or pending release.
+        std::atomic<uint32_t> generation{ 0 };
+
+        uint32_t lastGeneration{ 0 };
+
+        uint32_t nextFree{ InvalidIndex };
+    };
+
+    struct Page
+    {
+        Slot slots[PageSize];
+    };
+
+    struct PendingRelease
+    {
+        uint32_t slot;
+
+        uint64_t frame;
+    };
+
+    Slot &GetSlot(uint32_t index) const
+    {
+        return m_Pages[index / PageSize].load(std::memory_order_relaxed)->slots[index % PageSize];
+    }
+
+    // Called with m_Mutex held.
+    bool Invalidate(Handle handle)
+    {
+        if (handle.IsNull() || handle.GetIndex() >= m_SlotCount)
+        {
+            return false;
+        }
+
+        Slot &slot = GetSlot(handle.GetIndex());
+        if (slot.generation.load(std::memory_order_relaxed) != handle.GetGeneration())
+        {
+            return false;
+        }
+
+        slot.generation.store(0, std::memory_order_release);
+        --m_LiveCount;
+        return true;
+    }
+
+    // Called with m_Mutex held.
+    void FreeSlot(uint32_t index)
+    {
+        Slot &slot = GetSlot(index);
+        std::launder(reinterpret_cast<T *>(slot.storage))->~T();
+
+        slot.nextFree = m_FreeHead;
+        m_FreeHead = index;
+    }
+
+    std::unique_ptr<std::atomic<Page *>[]> m_Pages;
+
+    mutable std::mutex m_Mutex;
+
+    uint32_t m_SlotCount{ 0 };
+
+    uint32_t m_FreeHead{ InvalidIndex };
+
+    uint32_t m_LiveCount{ 0 };
+
+    std::vector<PendingRelease> m_PendingReleases;
+};
@@ -1,13 +0,0 @@
-PipelineState m_State 
-
-begineRenderPass
-{
-}
-bindXXState();
-bindProgram()'
-bindRenderPrimitive()
-{}
-flush()
-{
-	
-}
\ No newline at end of file
@@ -1,10 +1,119 @@
-#include "GfxResourceManager.h
+#include "GfxResourceManager.h"
+#include "../Common/Hash.h"
 #include <cassert>
 
-GfxShaderPtr GfxResourceManager::RequestShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions)
+GfxResourceManager::GfxResourceManager()
 {
-    assert(!entry_point.empty());
+
+}
+
+ShaderHandle GfxResourceManager::RequestShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions)
+{
+    assert(!entryPoint.empty());
     assert(!source.empty());
 
-    return std::make_ptr();
-}
\ No newline at end of file
+    uint64_t key = HashShaderRequest(shaderType, entryPoint, source, definitions);
+
+    std::lock_guard<std::mutex> lock{ m_ShaderMutex };
+
+    auto found = m_Shaders.find(key);
+    if (found != m_Shaders.end())
+    {
+        return found->second;
+    }
+
+    ShaderHandle shader = m_ShaderPool.Create(shaderType, entryPoint, source, definitions);
+    m_Shaders.emplace(key, shader);
+    return shader;
+}
+
+GfxShader *GfxResourceManager::GetShader(ShaderHandle handle) const
+{
+    return m_ShaderPool.Get(handle);
+}
+
+void GfxResourceManager::ReleaseShader(ShaderHandle handle, uint64_t releaseFrame)
+{
+    std::lock_guard<std::mutex> lock{ m_ShaderMutex };
+
+    // Releasing is rare, a reverse map isn't worth keeping.
+    for (auto entry = m_Shaders.begin(); entry != m_Shaders.end(); ++entry)
+    {
+        if (entry->second == handle)
+        {
+            m_Shaders.erase(entry);
+            break;
+        }
+    }
+
+    m_ShaderPool.Release(handle, releaseFrame);
+}
+
+uint32_t GfxResourceManager::GetShaderCount() const
+{
+    std::lock_guard<std::mutex> lock{ m_ShaderMutex };
+    return static_cast<uint32_t>(m_Shaders.size());
+}
+
+void GfxResourceManager::ClearShaders()
+{
+    std::lock_guard<std::mutex> lock{ m_ShaderMutex };
+    m_Shaders.clear();
+    m_ShaderPool.Clear();
+}
+
+SamplerHandle GfxResourceManager::RequestSampler(const SamplerDesc &desc)
+{
+    std::lock_guard<std::mutex> lock{ m_SamplerMutex };
+
+    auto found = m_Samplers.find(desc);
+    if (found != m_Samplers.end())
+    {
+        return found->second;
+    }
+
+    SamplerHandle sampler = m_SamplerPool.Create(desc);
+    m_Samplers.emplace(desc, sampler);
+    return sampler;
+}
+
+GfxSampler *GfxResourceManager::GetSampler(SamplerHandle handle) const
+{
+    return m_SamplerPool.Get(handle);
+}
+
+TextureHandle GfxResourceManager::CreateTexture(const TextureDesc &desc)
+{
+    return m_TexturePool.Create(desc);
+}
+
+GfxTexture *GfxResourceManager::GetTexture(TextureHandle handle) const
+{
+    return m_TexturePool.Get(handle);
+}
+
+void GfxResourceManager::ReleaseTexture(TextureHandle handle, uint64_t releaseFrame)
+{
+    m_TexturePool.Release(handle, releaseFrame);
+}
+
+void GfxResourceManager::CollectReleased(uint64_t completedFrame)
+{
+    m_ShaderPool.CollectReleased(completedFrame);
+    m_TexturePool.CollectReleased(completedFrame);
+}
+
+uint64_t GfxResourceManager::HashShaderRequest(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions)
+{
+    uint64_t hash = Hash::Combine(Hash::DefaultSeed, static_cast<uint64_t>(shaderType));
+    hash = Hash::Combine(hash, Hash::String(entryPoint));
+    hash = Hash::Combine(hash, Hash::Bytes(source.data(), source.size()));
+
+    // Order matters, a later definition can override an earlier one.
+    for (const std::string &definition : definitions)
+    {
+        hash = Hash::Combine(hash, Hash::String(definition));
+    }
+
+    return hash;
+}
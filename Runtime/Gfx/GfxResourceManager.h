@@ -1,22 +1,68 @@
 #pragma once
 
 #include "../Common/Utils.h"
+#include "GfxHandlePool.h"
+#include "GfxSampler.h"
 #include "GfxShader.h"
+#include "GfxTexture.h"
 //#include <algorithm>
 #include <vector>
+#include <mutex>
+#include <unordered_map>
 //#include <string>
 
-
-
+// Owns the backend independent resources and hands out handles to them. Handles are plain 32-bit
+// values, cheap to copy across threads; resolve them with the Get functions when recording.
 class GfxResourceManager : public NonCopyable
 {
 public:
 
     GfxResourceManager();
 
-    GfxShaderPtr RequestShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions);
+    // Returns the shader created by an earlier request with the same stage, entry point, source and
+    // definitions. Safe to call from several threads at once.
+    ShaderHandle RequestShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions);
+
+    // Null for stale handles.
+    GfxShader *GetShader(ShaderHandle handle) const;
+
+    // Drops the shader from the cache now and destroys it once releaseFrame has completed.
+    void ReleaseShader(ShaderHandle handle, uint64_t releaseFrame);
+
+    uint32_t GetShaderCount() const;
+
+    void ClearShaders();
+
+    // Deduplicated like shaders, equal descriptions share one sampler.
+    SamplerHandle RequestSampler(const SamplerDesc &desc);
+
+    GfxSampler *GetSampler(SamplerHandle handle) const;
+
+    TextureHandle CreateTexture(const TextureDesc &desc);
+
+    GfxTexture *GetTexture(TextureHandle handle) const;
+
+    void ReleaseTexture(TextureHandle handle, uint64_t releaseFrame);
+
+    // Destroys released resources whose frame has finished on the GPU.
+    void CollectReleased(uint64_t completedFrame);
+
+    // 64-bit key of a shader request, equal keys are taken to be the same shader.
+    static uint64_t HashShaderRequest(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions);
 
 private:
 
+    mutable std::mutex m_ShaderMutex;
+
+    std::unordered_map<uint64_t, ShaderHandle> m_Shaders;
+
+    GfxHandlePool<GfxShader, ShaderHandle> m_ShaderPool;
+
+    std::mutex m_SamplerMutex;
+
+    std::unordered_map<SamplerDesc, SamplerHandle> m_Samplers;
+
+    GfxHandlePool<GfxSampler, SamplerHandle> m_SamplerPool;
 
-};
\ No newline at end of file
+    GfxHandlePool<GfxTexture, TextureHandle> m_TexturePool;
+};
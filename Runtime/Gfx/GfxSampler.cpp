@@ -1,18 +1,41 @@
 #include "GfxSampler.h"
+#include "../Common/Hash.h"
+#include <cstring>
 
+SamplerDesc::SamplerDesc() :
+    magFilter{ 1 },
+    minFilter{ 1 },
+    mipmapMode{ 1 },
+    addressModeU{ 0 },
+    addressModeV{ 0 },
+    addressModeW{ 0 },
+    compareEnabled{ 0 },
+    compareOp{ 0 }
+{
+}
 
-size_t SamplerDesc::hash() const
+size_t SamplerDesc::Hash() const
 {
-    return angle::ComputeGenericHash(*this);
+    return static_cast<size_t>(Hash::Bytes(this, sizeof(SamplerDesc)));
 }
 
 bool SamplerDesc::operator==(const SamplerDesc &other) const
 {
-    return (memcmp(this, &other, sizeof(SamplerDesc)) == 0);
+    return std::memcmp(this, &other, sizeof(SamplerDesc)) == 0;
 }
 
-GfxSampler::GfxSampler()
+bool SamplerDesc::operator!=(const SamplerDesc &other) const
+{
+    return !(*this == other);
+}
+
+GfxSampler::GfxSampler(const SamplerDesc &desc) :
+    m_Desc{ desc }
 {
 
 }
 
+const SamplerDesc &GfxSampler::GetDesc() const
+{
+    return m_Desc;
+}
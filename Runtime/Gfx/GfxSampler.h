@@ -1,47 +1,50 @@
 #pragma once
 
 #include "../Common/Utils.h"
-//#include <algorithm>
-#include <vector>
-#include <string>
-#include <memory>
+#include <cstdint>
+#include <functional>
 
-
-struct SamplerDesc : : public NonCopyable
+// Hashed and compared as raw bytes; the bit fields fill their 16 bits exactly, so there is no padding
+// left undefined. Enumerants use the Vulkan values.
+struct SamplerDesc
 {
-private:
+    SamplerDesc();
+
+    float mipLodBias{ 0.0f };
 
-    float m_MipLodBias = 0.0f;
+    float maxAnisotropy{ 0.0f };
 
-    float m_MaxAnisotropy = 0.0f;
+    float minLod{ 0.0f };
 
-    float m_MinLod = 0.0f;
+    // VK_LOD_CLAMP_NONE.
+    float maxLod{ 1000.0f };
 
-    float m_MaxLod = 0.0f;
+    uint16_t magFilter : 1;
 
-    uint16_t mMagFilter : 1 = 1;
+    uint16_t minFilter : 1;
 
-    uint16_t mMinFilter : 1 = 1;
+    uint16_t mipmapMode : 1;
 
-    uint16_t mMipmapMode : 1 = 1;
+    uint16_t addressModeU : 3;
 
-    uint16_t mAddressModeU : 3 = 1;
+    uint16_t addressModeV : 3;
 
-    uint16_t mAddressModeV : 3 = 1;
+    uint16_t addressModeW : 3;
 
-    uint16_t mAddressModeW : 3 = 1;
+    uint16_t compareEnabled : 1;
 
-    uint16_t mCompareEnabled : 1 = 1;
+    uint16_t compareOp : 3;
 
-    uint16_t mCompareOp : 3 = 1;
+    uint16_t padding{ 0 };
 
     size_t Hash() const;
 
     bool operator==(const SamplerDesc &other) const;
 
+    bool operator!=(const SamplerDesc &other) const;
 };
 
-static_assert(sizeof(SamplerDesc) == 18, "Unexpected SamplerDesc size");
+static_assert(sizeof(SamplerDesc) == 20, "Unexpected SamplerDesc size");
 
 namespace std
 {
@@ -56,9 +59,11 @@ class GfxSampler : public NonCopyable
 {
 public:
 
-    GfxSampler();
+    explicit GfxSampler(const SamplerDesc &desc);
 
-protected:
+    const SamplerDesc &GetDesc() const;
 
+protected:
 
-};
\ No newline at end of file
+    SamplerDesc m_Desc;
+};
@@ -5,4 +5,14 @@ GfxShader::GfxShader(ShaderType shaderType, const std::string &entryPoint, const
     , m_EntryPoint{ entryPoint }
 {
 
-}
\ No newline at end of file
+}
+
+ShaderType GfxShader::GetShaderType() const
+{
+    return m_ShaderType;
+}
+
+const std::string &GfxShader::GetEntryPoint() const
+{
+    return m_EntryPoint;
+}
@@ -4,17 +4,14 @@
 //#include <algorithm>
 #include <vector>
 #include <string>
-#include <memory>
-
-class GfxShader;
-
-using  GfxShaderPtr = std::shared_ptr<GfxShader>;//TODO
 
 enum ShaderType
 {
     VertexShader,
 
     FragmentShader,
+
+    ComputeShader,
 };
 
 class GfxShader : public NonCopyable
@@ -23,6 +20,10 @@ public:
 
     GfxShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions);
 
+    ShaderType GetShaderType() const;
+
+    const std::string &GetEntryPoint() const;
+
 protected:
 
     ShaderType m_ShaderType;
@@ -1,8 +1,12 @@
-#include "GfxShader.h"
+#include "GfxTexture.h"
 
-GfxShader::GfxShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions) :
-    m_ShaderType{ shaderType }
-    , m_EntryPoint{ entryPoint }
+GfxTexture::GfxTexture(const TextureDesc &desc) :
+    m_Desc{ desc }
 {
 
-}
\ No newline at end of file
+}
+
+const TextureDesc &GfxTexture::GetDesc() const
+{
+    return m_Desc;
+}
@@ -1,32 +1,31 @@
 #pragma once
 
 #include "../Common/Utils.h"
-//#include <algorithm>
-#include <vector>
-#include <string>
-#include <memory>
+#include <cstdint>
 
-class GfxShader;
+struct TextureDesc
+{
+    uint32_t width{ 1 };
 
-using  GfxShaderPtr = std::shared_ptr<GfxShader>;
+    uint32_t height{ 1 };
 
-enum ShaderType
-{
-    VertexShader,
+    uint32_t mipLevels{ 1 };
 
-    FragmentShader,
+    uint32_t arrayLayers{ 1 };
+
+    // VkFormat value.
+    uint32_t format{ 0 };
 };
 
-class GfxShader : public NonCopyable
+class GfxTexture : public NonCopyable
 {
 public:
 
-    GfxShader(ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions);
+    explicit GfxTexture(const TextureDesc &desc);
 
-protected:
+    const TextureDesc &GetDesc() const;
 
-    ShaderType m_ShaderType;
-
-    std::string m_EntryPoint;
+protected:
 
-};
\ No newline at end of file
+    TextureDesc m_Desc;
+};
@@ -0,0 +1,70 @@
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanUtils.h"
+#include <cassert>
+#include <cstring>
+
+VulkanBuffer::VulkanBuffer(VulkanDevice &device, VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags flags) :
+    m_Device{ device },
+    m_Size{ size }
+{
+    assert(size > 0);
+
+    VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = memoryUsage;
+    allocationInfo.flags = flags;
+
+    if (memoryUsage == VMA_MEMORY_USAGE_CPU_ONLY || memoryUsage == VMA_MEMORY_USAGE_CPU_TO_GPU || memoryUsage == VMA_MEMORY_USAGE_GPU_TO_CPU)
+    {
+        allocationInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
+
+    VmaAllocationInfo allocatedInfo{};
+    VK_CHECK(vmaCreateBuffer(m_Device.GetMemoryAllocator(), &bufferInfo, &allocationInfo, &m_Handle, &m_Allocation, &allocatedInfo));
+
+    m_MappedData = static_cast<uint8_t *>(allocatedInfo.pMappedData);
+}
+
+VulkanBuffer::~VulkanBuffer()
+{
+    if (m_Handle != VK_NULL_HANDLE)
+    {
+        vmaDestroyBuffer(m_Device.GetMemoryAllocator(), m_Handle, m_Allocation);
+    }
+}
+
+VkBuffer VulkanBuffer::GetHandle() const
+{
+    return m_Handle;
+}
+
+VkDeviceSize VulkanBuffer::GetSize() const
+{
+    return m_Size;
+}
+
+uint8_t *VulkanBuffer::GetMappedData() const
+{
+    return m_MappedData;
+}
+
+void VulkanBuffer::Update(const void *data, VkDeviceSize size, VkDeviceSize offset)
+{
+    assert(m_MappedData != nullptr && "Only host visible buffers can be updated directly.");
+    assert(offset + size <= m_Size);
+
+    memcpy(m_MappedData + offset, data, static_cast<size_t>(size));
+    vmaFlushAllocation(m_Device.GetMemoryAllocator(), m_Allocation, offset, size);
+}
+
+void VulkanBuffer::Invalidate(VkDeviceSize offset, VkDeviceSize size)
+{
+    assert(m_MappedData != nullptr && "Only host visible buffers can be invalidated.");
+
+    vmaInvalidateAllocation(m_Device.GetMemoryAllocator(), m_Allocation, offset, size);
+}
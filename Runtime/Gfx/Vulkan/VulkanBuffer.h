@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+class VulkanDevice;
+
+// VMA backed buffer. Host visible memory stays mapped for the lifetime of the buffer.
+class VulkanBuffer : public NonCopyable
+{
+public:
+
+    VulkanBuffer(VulkanDevice &device, VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags flags = 0);
+
+    ~VulkanBuffer();
+
+    VkBuffer GetHandle() const;
+
+    VkDeviceSize GetSize() const;
+
+    // nullptr unless the memory is host visible.
+    uint8_t *GetMappedData() const;
+
+    // Copies into mapped memory and flushes it for non-coherent heaps.
+    void Update(const void *data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+    // Makes GPU writes visible to GetMappedData() on non-coherent heaps.
+    void Invalidate(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+private:
+
+    VulkanDevice &m_Device;
+
+    VkBuffer m_Handle{ VK_NULL_HANDLE };
+
+    VmaAllocation m_Allocation{ VK_NULL_HANDLE };
+
+    VkDeviceSize m_Size{ 0 };
+
+    uint8_t *m_MappedData{ nullptr };
+};
@@ -0,0 +1,131 @@
+#include "VulkanCommandTranslator.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include <cassert>
+
+namespace
+{
+    class VulkanCommandVisitor
+    {
+    public:
+
+        VulkanCommandVisitor(VkCommandBuffer commandBuffer, const VulkanCommandTables &tables) :
+            m_CommandBuffer{ commandBuffer },
+            m_Tables{ tables }
+        {
+        }
+
+        bool BindPipeline(uint32_t pipeline)
+        {
+            assert(pipeline < m_Tables.pipelines.size());
+
+            const VulkanCommandPipeline *previous = m_Pipeline;
+            m_Pipeline = &m_Tables.pipelines[pipeline];
+            vkCmdBindPipeline(m_CommandBuffer, m_Pipeline->bindPoint, m_Pipeline->pipeline);
+
+            // Sets stay bound across pipelines of the same layout and bind point only.
+            return previous == nullptr || previous->layout != m_Pipeline->layout || previous->bindPoint != m_Pipeline->bindPoint;
+        }
+
+        void BindDescriptorSet(uint32_t slot, uint32_t set)
+        {
+            assert(m_Pipeline != nullptr && "Bind a pipeline before its descriptor sets");
+            assert(set < m_Tables.descriptorSets.size());
+
+            vkCmdBindDescriptorSets(m_CommandBuffer, m_Pipeline->bindPoint, m_Pipeline->layout, slot, 1, &m_Tables.descriptorSets[set], 0, nullptr);
+        }
+
+        void BindVertexBuffer(uint32_t binding, uint32_t buffer, uint32_t offset)
+        {
+            assert(buffer < m_Tables.buffers.size());
+
+            VkDeviceSize deviceOffset = offset;
+            vkCmdBindVertexBuffers(m_CommandBuffer, binding, 1, &m_Tables.buffers[buffer], &deviceOffset);
+        }
+
+        void BindIndexBuffer(uint32_t buffer, uint32_t offset, GfxIndexType indexType)
+        {
+            assert(buffer < m_Tables.buffers.size());
+
+            vkCmdBindIndexBuffer(m_CommandBuffer, m_Tables.buffers[buffer], offset, indexType == GfxIndexType::Uint16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+        }
+
+        void SetViewport(const GfxViewport &viewport)
+        {
+            VkViewport vkViewport{ viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+            vkCmdSetViewport(m_CommandBuffer, 0, 1, &vkViewport);
+        }
+
+        void SetScissor(const GfxScissor &scissor)
+        {
+            VkRect2D rect{ { scissor.x, scissor.y }, { scissor.width, scissor.height } };
+            vkCmdSetScissor(m_CommandBuffer, 0, 1, &rect);
+        }
+
+        void PushConstants(uint32_t offset, const void *data, uint32_t size)
+        {
+            assert(m_Pipeline != nullptr && "Bind a pipeline before pushing constants");
+
+            vkCmdPushConstants(m_CommandBuffer, m_Pipeline->layout, m_Pipeline->pushConstantStages, offset, size, data);
+        }
+
+        void Draw(const GfxDrawCommand &command)
+        {
+            vkCmdDraw(m_CommandBuffer, command.vertexCount, command.instanceCount, command.firstVertex, command.firstInstance);
+        }
+
+        void DrawIndexed(const GfxDrawIndexedCommand &command)
+        {
+            vkCmdDrawIndexed(m_CommandBuffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+        }
+
+        void DrawIndexedIndirect(const GfxDrawIndexedIndirectCommand &command)
+        {
+            assert(command.buffer < m_Tables.buffers.size());
+
+            vkCmdDrawIndexedIndirect(m_CommandBuffer, m_Tables.buffers[command.buffer], command.offset, command.drawCount, command.stride);
+        }
+
+        void Dispatch(const GfxDispatchCommand &command)
+        {
+            vkCmdDispatch(m_CommandBuffer, command.groupCountX, command.groupCountY, command.groupCountZ);
+        }
+
+    private:
+
+        VkCommandBuffer m_CommandBuffer;
+
+        const VulkanCommandTables &m_Tables;
+
+        const VulkanCommandPipeline *m_Pipeline{ nullptr };
+    };
+}
+
+VulkanCommandTranslator::VulkanCommandTranslator(VulkanDevice &device) :
+    m_Device{ device }
+{
+}
+
+void VulkanCommandTranslator::Translate(VkCommandBuffer commandBuffer, const VulkanCommandTables &tables, const GfxCommandList *const *commandLists, uint32_t commandListCount)
+{
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "CommandTranslator");
+
+    // Nothing is known about what the command buffer has bound before.
+    m_Replayer.Invalidate();
+
+    VulkanCommandVisitor visitor{ commandBuffer, tables };
+    for (uint32_t index = 0; index < commandListCount; ++index)
+    {
+        m_Replayer.Replay(*commandLists[index], visitor);
+    }
+}
+
+const GfxCommandReplayStats &VulkanCommandTranslator::GetStats() const
+{
+    return m_Replayer.GetStats();
+}
+
+void VulkanCommandTranslator::ResetStats()
+{
+    m_Replayer.ResetStats();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Gfx/GfxCommandList.h"
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+struct VulkanCommandPipeline
+{
+    VkPipeline pipeline{ VK_NULL_HANDLE };
+
+    VkPipelineLayout layout{ VK_NULL_HANDLE };
+
+    VkPipelineBindPoint bindPoint{ VK_PIPELINE_BIND_POINT_GRAPHICS };
+
+    VkShaderStageFlags pushConstantStages{ 0 };
+};
+
+// Vulkan objects the indices recorded into GfxCommandLists refer to.
+struct VulkanCommandTables
+{
+    std::vector<VulkanCommandPipeline> pipelines;
+
+    std::vector<VkDescriptorSet> descriptorSets;
+
+    std::vector<VkBuffer> buffers;
+};
+
+// Emits the vkCmd* calls of recorded command lists into a command buffer, one pass over the lists with
+// redundant state changes dropped. Lists recorded in parallel are translated in the order given, the
+// bound state carries over from one list to the next.
+class VulkanCommandTranslator : public NonCopyable
+{
+public:
+
+    explicit VulkanCommandTranslator(VulkanDevice &device);
+
+    void Translate(VkCommandBuffer commandBuffer, const VulkanCommandTables &tables, const GfxCommandList *const *commandLists, uint32_t commandListCount);
+
+    // Totals since the last ResetStats().
+    const GfxCommandReplayStats &GetStats() const;
+
+    void ResetStats();
+
+private:
+
+    VulkanDevice &m_Device;
+
+    GfxCommandReplayer m_Replayer;
+};
@@ -1,7 +1,9 @@
 #include "VulkanDevice.h"
 #include "VulkanPhysicalDevice.h"
+#include "VulkanObjectTracker.h"
 #include "Common/Logging.h"
 #include "VulkanUtils.h"
+#include <cstring>
 #include <volk.h>
 //VKBP_DISABLE_WARNINGS()
 #define VMA_IMPLEMENTATION
@@ -13,6 +15,9 @@ VulkanDevice::VulkanDevice(const VulkanPhysicalDevice &gpu, VkSurfaceKHR surface
 
     LOGI("Selected GPU: {}", gpu.GetProperties().deviceName);
 
+    // Ahead of vkCreateDevice and VMA picking up the entry points, so everything of this device is counted.
+    VulkanObjectTracker::Install();
+
     // Prepare the device queues
     uint32_t queueFamilyPropertiesCount = /*to_u32*/(gpu.GetQueueFamilyProperties().size());
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos(queueFamilyPropertiesCount, { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO });
@@ -57,10 +62,88 @@ VulkanDevice::VulkanDevice(const VulkanPhysicalDevice &gpu, VkSurfaceKHR surface
         LOGI("Dedicated Allocation enabled");
     }
 
+    // Optional features are queried and enabled through one pNext chain. Their dependencies are core
+    // from 1.2 on, older devices go without them.
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR };
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+    VkPhysicalDeviceVulkan12Features vulkan12Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+    void *enabledFeatures = nullptr;
+
+    bool swapchainRequested = std::any_of(requestedExtensions.begin(), requestedExtensions.end(),
+        [](const std::pair<const char *const, bool> &extension) { return std::strcmp(extension.first, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0; });
+    if (surface != VK_NULL_HANDLE && !swapchainRequested && IsExtensionSupported(VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+    {
+        m_EnabledExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
+    if (gpu.GetProperties().apiVersion >= VK_API_VERSION_1_2 && vkGetPhysicalDeviceFeatures2 != nullptr)
+    {
+        bool canPresentWait = surface != VK_NULL_HANDLE && IsExtensionSupported(VK_KHR_PRESENT_ID_EXTENSION_NAME) && IsExtensionSupported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
+        VkPhysicalDeviceFeatures2 features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        features.pNext = &dynamicRenderingFeatures;
+        dynamicRenderingFeatures.pNext = &presentIdFeatures;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        presentWaitFeatures.pNext = &vulkan12Features;
+        vkGetPhysicalDeviceFeatures2(gpu.GetHandle(), &features);
+        dynamicRenderingFeatures.pNext = nullptr;
+        presentIdFeatures.pNext = nullptr;
+        presentWaitFeatures.pNext = nullptr;
+
+        // Render passes and framebuffers become optional with dynamic rendering.
+        if (IsExtensionSupported(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) && dynamicRenderingFeatures.dynamicRendering == VK_TRUE)
+        {
+            m_EnabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+            dynamicRenderingFeatures.pNext = enabledFeatures;
+            enabledFeatures = &dynamicRenderingFeatures;
+            m_DynamicRenderingEnabled = true;
+            LOGI("Dynamic rendering enabled");
+        }
+
+        // Lets the swapchain wait for a frame to reach the display instead of only for the GPU.
+        if (canPresentWait && presentIdFeatures.presentId == VK_TRUE && presentWaitFeatures.presentWait == VK_TRUE)
+        {
+            m_EnabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            m_EnabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            presentIdFeatures.pNext = enabledFeatures;
+            presentWaitFeatures.pNext = &presentIdFeatures;
+            enabledFeatures = &presentWaitFeatures;
+            m_PresentWaitEnabled = true;
+            LOGI("Present wait enabled");
+        }
+
+        // Only the draw count of the 1.2 features is wanted, the others stay off.
+        if (vulkan12Features.drawIndirectCount == VK_TRUE)
+        {
+            VkBool32 drawIndirectCount = vulkan12Features.drawIndirectCount;
+            vulkan12Features = VkPhysicalDeviceVulkan12Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+            vulkan12Features.drawIndirectCount = drawIndirectCount;
+            vulkan12Features.pNext = enabledFeatures;
+            enabledFeatures = &vulkan12Features;
+            m_DrawIndexedIndirectCount = vkCmdDrawIndexedIndirectCount;
+            LOGI("Draw indirect count enabled");
+        }
+    }
+
+    // Devices before 1.2 may still have the extension the feature was promoted from.
+    if (m_DrawIndexedIndirectCount == nullptr && IsExtensionSupported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+    {
+        m_EnabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        m_DrawIndexedIndirectCount = vkCmdDrawIndexedIndirectCountKHR;
+        LOGI("{} enabled", VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+
     // Check that extensions are supported before trying to create the device
     std::vector<const char *> unsupportedExtensions{};
     for (auto &extension : requestedExtensions)
     {
+        // Enabled above already, naming it twice is invalid.
+        if (IsExtensionEnabled(extension.first))
+        {
+            continue;
+        }
+
         if (IsExtensionSupported(extension.first))
         {
             m_EnabledExtensions.emplace_back(extension.first);
@@ -101,6 +184,7 @@ VulkanDevice::VulkanDevice(const VulkanPhysicalDevice &gpu, VkSurfaceKHR surface
 
     // Latest requested feature will have the pNext's all set up for device creation.
     //createInfo.pNext = gpu.GetRequestedExtensionFeatures(); TODO
+    createInfo.pNext = enabledFeatures;
 
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.queueCreateInfoCount = /*to_u32*/(queueCreateInfos.size());
@@ -202,10 +286,88 @@ VkDevice VulkanDevice::GetHandle() const
     return m_Handle;
 }
 
+const VulkanPhysicalDevice &VulkanDevice::GetGpu() const
+{
+    return mGPU;
+}
+
+VmaAllocator VulkanDevice::GetMemoryAllocator() const
+{
+    return m_MemoryAllocator;
+}
+
+const VulkanQueue &VulkanDevice::GetQueueByFlags(VkQueueFlags queueFlags, uint32_t queueIndex) const
+{
+    for (const std::vector<VulkanQueue> &familyQueues : m_Queues)
+    {
+        if (familyQueues.empty())
+        {
+            continue;
+        }
+
+        const VkQueueFamilyProperties &properties = familyQueues[0].GetProperties();
+        if ((properties.queueFlags & queueFlags) == queueFlags && queueIndex < properties.queueCount)
+        {
+            return familyQueues[queueIndex];
+        }
+    }
+
+    LOGE("Could not find a queue with flags {}", queueFlags);
+    abort();
+}
+
+void VulkanDevice::WaitIdle() const
+{
+    VK_CHECK(vkDeviceWaitIdle(m_Handle));
+}
+
+void VulkanDevice::SetGpuProfiler(VulkanGpuProfiler *profiler)
+{
+    m_GpuProfiler = profiler;
+}
+
+VulkanGpuProfiler *VulkanDevice::GetGpuProfiler() const
+{
+    return m_GpuProfiler;
+}
+
+bool VulkanDevice::IsDynamicRenderingEnabled() const
+{
+    return m_DynamicRenderingEnabled;
+}
+
+bool VulkanDevice::IsPresentWaitEnabled() const
+{
+    return m_PresentWaitEnabled;
+}
+
+bool VulkanDevice::IsMultiDrawIndirectEnabled() const
+{
+    return mGPU.GetRequestedFeatures().multiDrawIndirect == VK_TRUE;
+}
+
+bool VulkanDevice::IsDrawIndirectFirstInstanceEnabled() const
+{
+    return mGPU.GetRequestedFeatures().drawIndirectFirstInstance == VK_TRUE;
+}
+
+PFN_vkCmdDrawIndexedIndirectCount VulkanDevice::GetDrawIndexedIndirectCount() const
+{
+    return m_DrawIndexedIndirectCount;
+}
+
 bool VulkanDevice::IsExtensionSupported(const std::string &requestedExtension)
 {
     return std::find_if(m_DeviceExtensions.begin(), m_DeviceExtensions.end(),
         [requestedExtension](auto &deviceExtension) {
         return std::strcmp(deviceExtension.extensionName, requestedExtension.c_str()) == 0;
     }) != m_DeviceExtensions.end();
+}
+
+bool VulkanDevice::IsExtensionEnabled(const std::string &extension) const
+{
+    return std::find_if(m_EnabledExtensions.begin(), m_EnabledExtensions.end(),
+        [&extension](const char *enabledExtension) {
+        return std::strcmp(enabledExtension, extension.c_str()) == 0;
+    }) != m_EnabledExtensions.end();
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 
 class VulkanPhysicalDevice;
 
+class VulkanGpuProfiler;
+
 class VulkanDevice : public NonCopyable
 {
 public:
@@ -23,8 +25,41 @@ public:
 
     bool IsExtensionSupported(const std::string &requestedExtension);
 
+    bool IsExtensionEnabled(const std::string &extension) const;
+
     VkDevice GetHandle() const;
 
+    const VulkanPhysicalDevice &GetGpu() const;
+
+    VmaAllocator GetMemoryAllocator() const;
+
+    // First queue of a family supporting all of queueFlags.
+    const VulkanQueue &GetQueueByFlags(VkQueueFlags queueFlags, uint32_t queueIndex = 0) const;
+
+    void WaitIdle() const;
+
+    // Profiler that GPU_PROFILE_SCOPE in device level code records into, nullptr when there is none.
+    void SetGpuProfiler(VulkanGpuProfiler *profiler);
+
+    VulkanGpuProfiler *GetGpuProfiler() const;
+
+    // VK_KHR_dynamic_rendering is enabled, see VulkanRenderPassCache.
+    bool IsDynamicRenderingEnabled() const;
+
+    // VK_KHR_present_id and VK_KHR_present_wait are enabled, only with a surface.
+    bool IsPresentWaitEnabled() const;
+
+    // vkCmdDrawIndexedIndirect takes a drawCount above 1.
+    bool IsMultiDrawIndirectEnabled() const;
+
+    // Indirect draws may start at a non-zero firstInstance.
+    bool IsDrawIndirectFirstInstanceEnabled() const;
+
+    // vkCmdDrawIndexedIndirectCount of Vulkan 1.2 or of VK_KHR_draw_indirect_count, whichever the
+    // device enabled, nullptr without either. Volk loads both through the instance, so the entry
+    // points alone don't say whether the device has them.
+    PFN_vkCmdDrawIndexedIndirectCount GetDrawIndexedIndirectCount() const;
+
 private:
 
     const VulkanPhysicalDevice &mGPU;
@@ -43,4 +78,12 @@ private:
 
     VmaAllocator m_MemoryAllocator{ VK_NULL_HANDLE };
 
+    VulkanGpuProfiler *m_GpuProfiler{ nullptr };
+
+    bool m_DynamicRenderingEnabled{ false };
+
+    bool m_PresentWaitEnabled{ false };
+
+    PFN_vkCmdDrawIndexedIndirectCount m_DrawIndexedIndirectCount{ nullptr };
+
 };
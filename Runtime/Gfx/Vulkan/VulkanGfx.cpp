@@ -1,21 +1,317 @@
 #include "VulkanGfx.h"
 #include <cassert>
 #include "VulkanUtils.h"
+#include "VulkanInstance.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanOffscreenRenderer.h"
+#include "VulkanQueue.h"
+#include "Common/Logging.h"
+#include "Profiling/CpuProfiler.h"
+#include "Memory/FrameAllocator.h"
 
-VulkanGfx::VulkanGfx(const std::string &application_name, const std::unordered_map<const char *, bool> &required_extensions, const std::vector<const char *> &required_validation_layers, bool headless)
+VulkanGfx::VulkanGfx(const std::string &application_name, const std::unordered_map<const char *, bool> &required_extensions, const std::vector<const char *> &required_validation_layers, bool headless,
+                     const std::string &preferred_gpu, const GfxPresentDesc &present) :
+    m_Headless{ headless }
 {
+    std::unordered_map<const char *, bool> instance_extensions{ required_extensions };
+    for (const char *extension : present.instanceExtensions)
+    {
+        instance_extensions.emplace(extension, false);
+    }
+    m_Instance = std::make_unique<VulkanInstance>(application_name, instance_extensions, required_validation_layers, headless);
+
+    // The platform window's surface, or none for offscreen rendering.
+    if (present.createSurface)
+    {
+        m_Surface = present.createSurface(m_Instance->GetHandle());
+    }
+
+    // Calibrated timestamps put GPU zones on the CPU timeline without a blocking submit.
+    m_Device = std::make_unique<VulkanDevice>(m_Instance->GetSuitableGpu(preferred_gpu), m_Surface, std::unordered_map<const char *, bool>{ { VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, true } });
+
+    OffscreenRendererDesc offscreenDesc{};
+
+#if defined(NEXT_RENDER_PROFILER)
+    // One query range per offscreen slot, the renderer opens a profiler frame per submit.
+    GpuProfilerDesc profilerDesc{};
+    profilerDesc.framesInFlight = offscreenDesc.slotCount;
+    m_GpuProfiler = std::make_unique<VulkanGpuProfiler>(*m_Device, m_Device->GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT), profilerDesc);
+    if (m_GpuProfiler->IsSupported())
+    {
+        m_Device->SetGpuProfiler(m_GpuProfiler.get());
+    }
+    else
+    {
+        m_GpuProfiler.reset();
+    }
+#endif
+
+    if (m_Headless)
+    {
+        m_OffscreenRenderer = std::make_unique<VulkanOffscreenRenderer>(*m_Device, offscreenDesc);
+    }
+
+    if (m_Surface == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    const VulkanQueue &queue = m_Device->GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT);
+    if (!queue.CanPresent())
+    {
+        LOGE("The graphics queue can't present to the surface, rendering offscreen only.");
+        return;
+    }
+    m_PresentQueue = &queue;
+
+    m_Swapchain = std::make_unique<VulkanSwapchain>(*m_Device, m_Surface, present.extent, present.swapchain);
+
+    m_FramePools.resize(present.swapchain.framesInFlight);
+    m_FrameCommandBuffers.resize(present.swapchain.framesInFlight * 2);
+    for (uint32_t slot = 0; slot < present.swapchain.framesInFlight; ++slot)
+    {
+        VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = queue.GetFamilyIndex();
+        VK_CHECK(vkCreateCommandPool(m_Device->GetHandle(), &poolInfo, nullptr, &m_FramePools[slot]));
+
+        VkCommandBufferAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+        allocateInfo.commandPool = m_FramePools[slot];
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 2;
+        VK_CHECK(vkAllocateCommandBuffers(m_Device->GetHandle(), &allocateInfo, &m_FrameCommandBuffers[slot * 2]));
+    }
 }
 
 VulkanGfx::~VulkanGfx()
 {
+    if (m_Device != nullptr)
+    {
+        m_Device->WaitIdle();
+    }
+
+    m_Swapchain.reset();
+    for (VkCommandPool pool : m_FramePools)
+    {
+        vkDestroyCommandPool(m_Device->GetHandle(), pool, nullptr);
+    }
+
+    m_OffscreenRenderer.reset();
+
+    if (m_Device != nullptr)
+    {
+        m_Device->SetGpuProfiler(nullptr);
+    }
+    m_GpuProfiler.reset();
+
+    m_Device.reset();
+
+    if (m_Surface != VK_NULL_HANDLE)
+    {
+        vkDestroySurfaceKHR(m_Instance->GetHandle(), m_Surface, nullptr);
+    }
+    m_Instance.reset();
 }
 
 void VulkanGfx::BeginFrame()
 {
+    PROFILE_FRAME_BEGIN(m_CurrentFrameIndex);
+
+    if (m_Swapchain == nullptr)
+    {
+        return;
+    }
+
+    m_FrameSlot = m_Swapchain->BeginFrame();
+    VK_CHECK(vkResetCommandPool(m_Device->GetHandle(), m_FramePools[m_FrameSlot], 0));
+
+    m_CommandBufferIndex = 0;
+    m_ImageAcquired = false;
+    m_AcquireAttempted = false;
+
+    VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(GetFrameCommandBuffer(), &beginInfo));
+}
+
+bool VulkanGfx::AcquireImage()
+{
+    if (m_Swapchain == nullptr || m_AcquireAttempted)
+    {
+        return m_ImageAcquired;
+    }
+    m_AcquireAttempted = true;
+
+    // The frame's work so far doesn't need the image, so it doesn't wait for the presentation engine.
+    // The fence of the final submit covers this one as well.
+    VkCommandBuffer commandBuffer = GetFrameCommandBuffer();
+    VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    VK_CHECK(vkQueueSubmit(m_PresentQueue->GetHandle(), 1, &submitInfo, VK_NULL_HANDLE));
+
+    m_CommandBufferIndex = 1;
+    commandBuffer = GetFrameCommandBuffer();
+
+    VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+    {
+        PROFILE_SCOPE("AcquireImage");
+        m_ImageAcquired = m_Swapchain->AcquireImage(m_ImageIndex);
+    }
+
+    if (!m_ImageAcquired)
+    {
+        return false;
+    }
+
+    // The previous contents are dropped. The submit waits for the acquire at the transfer stage,
+    // which the transition below starts from.
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_Swapchain->GetImage(m_ImageIndex);
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
+    vkCmdClearColorImage(commandBuffer, barrier.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &m_ClearColor, 1, &barrier.subresourceRange);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    return true;
 }
 
 void VulkanGfx::EndFrame()
 {
+    if (m_Swapchain != nullptr)
+    {
+        AcquireImage();
+
+        VkCommandBuffer commandBuffer = GetFrameCommandBuffer();
+
+        if (m_ImageAcquired)
+        {
+            VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+            barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = m_Swapchain->GetImage(m_ImageIndex);
+            barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+        // Without an image the frame's work still runs and signals the fence.
+        VkSemaphore acquireSemaphore = m_Swapchain->GetAcquireSemaphore();
+        VkSemaphore presentSemaphore = m_ImageAcquired ? m_Swapchain->GetPresentSemaphore(m_ImageIndex) : VK_NULL_HANDLE;
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+        submitInfo.waitSemaphoreCount = m_ImageAcquired ? 1 : 0;
+        submitInfo.pWaitSemaphores = &acquireSemaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        submitInfo.signalSemaphoreCount = m_ImageAcquired ? 1 : 0;
+        submitInfo.pSignalSemaphores = &presentSemaphore;
+        VK_CHECK(vkQueueSubmit(m_PresentQueue->GetHandle(), 1, &submitInfo, m_Swapchain->GetFrameFence()));
+
+        if (m_ImageAcquired)
+        {
+            m_Swapchain->Present(*m_PresentQueue, m_ImageIndex);
+        }
+    }
+
+    if (m_OffscreenRenderer != nullptr)
+    {
+        PROFILE_SCOPE("PollReadbacks");
+        m_OffscreenRenderer->PollReadbacks();
+    }
+
+    // Frame memory handed to jobs of this frame is dead by now.
+    g_FrameAllocator->Reset();
 
-}
\ No newline at end of file
+    PROFILE_FRAME_END();
+    ++m_CurrentFrameIndex;
+}
+
+bool VulkanGfx::IsHeadless() const
+{
+    return m_Headless;
+}
+
+VulkanInstance &VulkanGfx::GetInstance() const
+{
+    return *m_Instance;
+}
+
+VulkanDevice &VulkanGfx::GetDevice() const
+{
+    return *m_Device;
+}
+
+VulkanGpuProfiler *VulkanGfx::GetGpuProfiler() const
+{
+    return m_GpuProfiler.get();
+}
+
+VulkanOffscreenRenderer &VulkanGfx::GetOffscreenRenderer() const
+{
+    assert(m_OffscreenRenderer != nullptr && "The offscreen renderer only exists in headless mode.");
+    return *m_OffscreenRenderer;
+}
+
+VkSurfaceKHR VulkanGfx::GetSurface() const
+{
+    return m_Surface;
+}
+
+VulkanSwapchain *VulkanGfx::GetSwapchain() const
+{
+    return m_Swapchain.get();
+}
+
+VkCommandBuffer VulkanGfx::GetFrameCommandBuffer() const
+{
+    assert(m_Swapchain != nullptr && "Frame command buffers only exist with a swapchain.");
+    return m_FrameCommandBuffers[m_FrameSlot * 2 + m_CommandBufferIndex];
+}
+
+bool VulkanGfx::IsImageAcquired() const
+{
+    return m_ImageAcquired;
+}
+
+uint32_t VulkanGfx::GetImageIndex() const
+{
+    return m_ImageIndex;
+}
+
+void VulkanGfx::Resize(VkExtent2D extent)
+{
+    if (m_Swapchain != nullptr)
+    {
+        m_Swapchain->Resize(extent);
+    }
+}
+
+void VulkanGfx::SetClearColor(const VkClearColorValue &clearColor)
+{
+    m_ClearColor = clearColor;
+}
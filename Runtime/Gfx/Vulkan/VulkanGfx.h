@@ -1,23 +1,130 @@
 #pragma once
 
 #include <volk.h>
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "Common/Utils.h"
+#include "VulkanSwapchain.h"
+
+class VulkanInstance;
+
+class VulkanDevice;
+
+class VulkanOffscreenRenderer;
+
+class VulkanGpuProfiler;
+
+class VulkanQueue;
+
+// Where VulkanGfx presents. Without createSurface it only renders offscreen.
+struct GfxPresentDesc
+{
+    // Instance extensions the surface needs, see VulkanWindow::GetRequiredInstanceExtensions().
+    std::vector<const char *> instanceExtensions;
+
+    // Called once the instance exists, see VulkanWindow::CreateSurface(). VulkanGfx destroys the surface.
+    std::function<VkSurfaceKHR(VkInstance instance)> createSurface;
+
+    VkExtent2D extent{ 0, 0 };
+
+    SwapchainDesc swapchain{};
+};
 
 class VulkanGfx : public NonCopyable
 {
 public:
 
-    VulkanGfx(const std::string &applicationName, const std::unordered_map<const char *, bool> &requiredExtensions = {}, const std::vector<const char *> &requiredValidationLayers = {}, bool headless = false);
+    // preferredGpu overrides the GPU choice, see VulkanInstance::GetSuitableGpu(). With a surface from
+    // present the device and a swapchain are created for it, headless or not.
+    VulkanGfx(const std::string &applicationName, const std::unordered_map<const char *, bool> &requiredExtensions = {}, const std::vector<const char *> &requiredValidationLayers = {}, bool headless = false,
+              const std::string &preferredGpu = {}, const GfxPresentDesc &present = {});
 
     ~VulkanGfx();
 
+    // With a swapchain, waits for the frame slot and begins its command buffer. Work that doesn't
+    // touch the swapchain image goes first, then AcquireImage().
     void BeginFrame();
 
+    // Acquires the frame's image, as late as possible: right before the first pass that writes to it.
+    // Work recorded up to here is submitted without waiting for the image, which is then cleared and
+    // left in COLOR_ATTACHMENT_OPTIMAL. False when the frame has no image, see
+    // VulkanSwapchain::AcquireImage(). Only the first call of a frame acquires.
+    bool AcquireImage();
+
+    // With a swapchain, acquires if AcquireImage() wasn't called, moves the image to PRESENT_SRC,
+    // submits the frame's command buffer and presents.
     void EndFrame();
 
+    // New framebuffer size, the swapchain is recreated at the next acquire. Render thread.
+    void Resize(VkExtent2D extent);
+
+    // VK_NULL_HANDLE without one.
+    VkSurfaceKHR GetSurface() const;
+
+    // nullptr without a surface.
+    VulkanSwapchain *GetSwapchain() const;
+
+    // Recording between BeginFrame() and EndFrame(), swapchain frames only. AcquireImage() switches to
+    // another one.
+    VkCommandBuffer GetFrameCommandBuffer() const;
+
+    // False before AcquireImage() and when this frame has no image to draw to.
+    bool IsImageAcquired() const;
+
+    uint32_t GetImageIndex() const;
+
+    void SetClearColor(const VkClearColorValue &clearColor);
+
+    bool IsHeadless() const;
+
+    VulkanInstance &GetInstance() const;
+
+    VulkanDevice &GetDevice() const;
+
+    // Only created in headless mode, renders go to offscreen images that are read back to the host.
+    VulkanOffscreenRenderer &GetOffscreenRenderer() const;
+
+    // nullptr unless built with NEXT_RENDER_PROFILER and the graphics queue supports timestamps.
+    VulkanGpuProfiler *GetGpuProfiler() const;
+
 private:
 
     uint32_t m_CurrentFrameIndex{ 0 };
-};
\ No newline at end of file
+
+    bool m_Headless{ false };
+
+    std::unique_ptr<VulkanInstance> m_Instance;
+
+    std::unique_ptr<VulkanDevice> m_Device;
+
+    std::unique_ptr<VulkanGpuProfiler> m_GpuProfiler;
+
+    std::unique_ptr<VulkanOffscreenRenderer> m_OffscreenRenderer;
+
+    VkSurfaceKHR m_Surface{ VK_NULL_HANDLE };
+
+    std::unique_ptr<VulkanSwapchain> m_Swapchain;
+
+    // One pool per swapchain frame slot, reset once the slot's fence has signalled.
+    std::vector<VkCommandPool> m_FramePools;
+
+    // Two per slot, for the work before and after the acquire.
+    std::vector<VkCommandBuffer> m_FrameCommandBuffers;
+
+    uint32_t m_CommandBufferIndex{ 0 };
+
+    const VulkanQueue *m_PresentQueue{ nullptr };
+
+    uint32_t m_FrameSlot{ 0 };
+
+    uint32_t m_ImageIndex{ 0 };
+
+    bool m_ImageAcquired{ false };
+
+    bool m_AcquireAttempted{ false };
+
+    VkClearColorValue m_ClearColor{ { 0.0f, 0.0f, 0.0f, 1.0f } };
+};
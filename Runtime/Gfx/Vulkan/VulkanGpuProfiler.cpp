@@ -0,0 +1,460 @@
+#include "VulkanGpuProfiler.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include "VulkanDevice.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanQueue.h"
+#include "VulkanUtils.h"
+#include "Common/Logging.h"
+#include "Profiling/ChromeTraceWriter.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+// Trace process of the GPU track, next to the CPU profiler's.
+static constexpr uint32_t GpuTraceProcessId = 2;
+
+// With VK_EXT_calibrated_timestamps the clocks are re-correlated this often to follow drift.
+static constexpr uint64_t CalibrationInterval = 64;
+
+static const char *g_PipelineStatisticNames[] = {
+    "inputAssemblyVertices",
+    "inputAssemblyPrimitives",
+    "vertexShaderInvocations",
+    "clippingInvocations",
+    "clippingPrimitives",
+    "fragmentShaderInvocations",
+    "computeShaderInvocations",
+};
+
+static int64_t GetSteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+VulkanGpuProfiler::VulkanGpuProfiler(VulkanDevice &device, const VulkanQueue &queue, const GpuProfilerDesc &desc) :
+    m_Device{ device },
+    m_Queue{ queue },
+    m_Desc{ desc }
+{
+    assert(m_Desc.framesInFlight > 0 && m_Desc.maxZonesPerFrame > 0 && m_Desc.historyFrameCount > 0);
+
+    const VulkanPhysicalDevice &gpu = m_Device.GetGpu();
+
+    uint32_t validBits = m_Queue.GetProperties().timestampValidBits;
+    if (validBits == 0)
+    {
+        LOGW("Queue family {} has no timestamp support, GPU profiling is disabled", m_Queue.GetFamilyIndex());
+        return;
+    }
+    m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    m_TimestampPeriod = gpu.GetProperties().limits.timestampPeriod;
+
+    // One begin and one end per zone, plus one query for calibrating without the extension.
+    VkQueryPoolCreateInfo timestampInfo{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+    timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    timestampInfo.queryCount = m_Desc.framesInFlight * m_Desc.maxZonesPerFrame * 2 + 1;
+    VK_CHECK(vkCreateQueryPool(m_Device.GetHandle(), &timestampInfo, nullptr, &m_TimestampPool));
+
+    if (gpu.GetRequestedFeatures().pipelineStatisticsQuery)
+    {
+        if (m_Queue.GetProperties().queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            m_StatisticFlags = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+            m_StatisticOrder = { GpuPipelineStatistic::InputAssemblyVertices, GpuPipelineStatistic::InputAssemblyPrimitives, GpuPipelineStatistic::VertexShaderInvocations,
+                GpuPipelineStatistic::ClippingInvocations, GpuPipelineStatistic::ClippingPrimitives, GpuPipelineStatistic::FragmentShaderInvocations };
+        }
+
+        // Results come back in bit order, compute is the highest bit used.
+        m_StatisticFlags |= VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+        m_StatisticOrder.push_back(GpuPipelineStatistic::ComputeShaderInvocations);
+        m_StatisticCount = static_cast<uint32_t>(m_StatisticOrder.size());
+
+        VkQueryPoolCreateInfo statisticsInfo{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+        statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsInfo.queryCount = m_Desc.framesInFlight * m_Desc.maxZonesPerFrame;
+        statisticsInfo.pipelineStatistics = m_StatisticFlags;
+        VK_CHECK(vkCreateQueryPool(m_Device.GetHandle(), &statisticsInfo, nullptr, &m_StatisticsPool));
+    }
+
+    m_Slots.resize(m_Desc.framesInFlight);
+    for (FrameSlot &slot : m_Slots)
+    {
+        slot.names.resize(m_Desc.maxZonesPerFrame);
+        slot.depths.resize(m_Desc.maxZonesPerFrame);
+        slot.statisticsQueries.resize(m_Desc.maxZonesPerFrame);
+    }
+
+    // Value and availability for every query of a slot.
+    m_TimestampResults.resize(m_Desc.maxZonesPerFrame * 2 * 2);
+    m_StatisticsResults.resize(m_Desc.maxZonesPerFrame * (m_StatisticCount + 1));
+
+    m_History.resize(m_Desc.historyFrameCount);
+    for (GpuFrameResult &frame : m_History)
+    {
+        frame.zones.reserve(m_Desc.maxZonesPerFrame);
+    }
+
+    // Both clocks have to be readable together for the calibrated path.
+#if defined(_WIN32)
+    m_HostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+    m_HostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+    if (m_Device.IsExtensionEnabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) && vkGetPhysicalDeviceCalibrateableTimeDomainsEXT != nullptr && vkGetCalibratedTimestampsEXT != nullptr)
+    {
+        uint32_t domainCount = 0;
+        VK_CHECK(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(gpu.GetHandle(), &domainCount, nullptr));
+        std::vector<VkTimeDomainEXT> domains(domainCount);
+        VK_CHECK(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(gpu.GetHandle(), &domainCount, domains.data()));
+
+        m_CalibratedTimestamps = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end() &&
+            std::find(domains.begin(), domains.end(), m_HostTimeDomain) != domains.end();
+    }
+
+    Calibrate();
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler()
+{
+    if (m_StatisticsPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(m_Device.GetHandle(), m_StatisticsPool, nullptr);
+    }
+
+    if (m_TimestampPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(m_Device.GetHandle(), m_TimestampPool, nullptr);
+    }
+}
+
+bool VulkanGpuProfiler::IsSupported() const
+{
+    return m_TimestampPool != VK_NULL_HANDLE;
+}
+
+bool VulkanGpuProfiler::HasPipelineStatistics() const
+{
+    return m_StatisticsPool != VK_NULL_HANDLE;
+}
+
+void VulkanGpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint64_t frameIndex)
+{
+    if (!IsSupported())
+    {
+        return;
+    }
+
+    assert(m_CurrentSlot == nullptr && "EndFrame() wasn't called for the previous frame.");
+
+    uint32_t slotIndex = static_cast<uint32_t>(frameIndex % m_Desc.framesInFlight);
+    FrameSlot &slot = m_Slots[slotIndex];
+    if (slot.pending)
+    {
+        Resolve(slot, slotIndex);
+    }
+
+    if (m_CalibratedTimestamps && frameIndex % CalibrationInterval == 0)
+    {
+        Calibrate();
+    }
+
+    vkCmdResetQueryPool(commandBuffer, m_TimestampPool, slotIndex * m_Desc.maxZonesPerFrame * 2, m_Desc.maxZonesPerFrame * 2);
+    if (m_StatisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, m_StatisticsPool, slotIndex * m_Desc.maxZonesPerFrame, m_Desc.maxZonesPerFrame);
+    }
+
+    slot.frameIndex = frameIndex;
+    slot.zoneCount = 0;
+    slot.statisticsCount = 0;
+    slot.pending = false;
+
+    m_CurrentSlot = &slot;
+    m_CurrentDepth = 0;
+    m_StatisticsActive = false;
+
+    BeginZone(commandBuffer, "Frame");
+}
+
+void VulkanGpuProfiler::EndFrame(VkCommandBuffer commandBuffer)
+{
+    if (m_CurrentSlot == nullptr)
+    {
+        return;
+    }
+
+    assert(m_CurrentDepth == 1 && "GPU zones are still open at the end of the frame.");
+
+    EndZone(commandBuffer, 0);
+
+    m_CurrentSlot->pending = true;
+    m_CurrentSlot = nullptr;
+}
+
+uint32_t VulkanGpuProfiler::BeginZone(VkCommandBuffer commandBuffer, const char *name, bool pipelineStatistics)
+{
+    if (m_CurrentSlot == nullptr || m_CurrentSlot->zoneCount == m_Desc.maxZonesPerFrame)
+    {
+        return InvalidZone;
+    }
+
+    FrameSlot &slot = *m_CurrentSlot;
+    uint32_t slotIndex = static_cast<uint32_t>(&slot - m_Slots.data());
+    uint32_t zone = slot.zoneCount++;
+
+    slot.names[zone] = name;
+    slot.depths[zone] = m_CurrentDepth++;
+    slot.statisticsQueries[zone] = InvalidZone;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampPool, (slotIndex * m_Desc.maxZonesPerFrame + zone) * 2);
+
+    if (pipelineStatistics && m_StatisticsPool != VK_NULL_HANDLE && !m_StatisticsActive)
+    {
+        uint32_t query = slot.statisticsCount++;
+        slot.statisticsQueries[zone] = query;
+        m_StatisticsActive = true;
+
+        vkCmdBeginQuery(commandBuffer, m_StatisticsPool, slotIndex * m_Desc.maxZonesPerFrame + query, 0);
+    }
+
+    return zone;
+}
+
+void VulkanGpuProfiler::EndZone(VkCommandBuffer commandBuffer, uint32_t zone)
+{
+    if (m_CurrentSlot == nullptr || zone == InvalidZone)
+    {
+        return;
+    }
+
+    FrameSlot &slot = *m_CurrentSlot;
+    uint32_t slotIndex = static_cast<uint32_t>(&slot - m_Slots.data());
+
+    uint32_t query = slot.statisticsQueries[zone];
+    if (query != InvalidZone)
+    {
+        vkCmdEndQuery(commandBuffer, m_StatisticsPool, slotIndex * m_Desc.maxZonesPerFrame + query);
+        m_StatisticsActive = false;
+    }
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampPool, (slotIndex * m_Desc.maxZonesPerFrame + zone) * 2 + 1);
+    --m_CurrentDepth;
+}
+
+const GpuFrameResult *VulkanGpuProfiler::GetLatestFrame() const
+{
+    if (m_ResolvedFrameCount == 0)
+    {
+        return nullptr;
+    }
+
+    return &m_History[(m_ResolvedFrameCount - 1) % m_History.size()];
+}
+
+uint64_t VulkanGpuProfiler::GetDroppedFrameCount() const
+{
+    return m_DroppedFrameCount;
+}
+
+void VulkanGpuProfiler::Capture(ChromeTraceWriter &writer) const
+{
+    if (m_ResolvedFrameCount == 0)
+    {
+        return;
+    }
+
+    writer.SetProcessName(GpuTraceProcessId, "GPU");
+    writer.SetThreadName(GpuTraceProcessId, m_Queue.GetFamilyIndex(), "Queue family " + std::to_string(m_Queue.GetFamilyIndex()), 0);
+
+    uint64_t historySize = m_History.size();
+    uint64_t first = m_ResolvedFrameCount > historySize ? m_ResolvedFrameCount - historySize : 0;
+
+    TraceArg arguments[static_cast<uint32_t>(GpuPipelineStatistic::Count)];
+    for (uint64_t index = first; index < m_ResolvedFrameCount; ++index)
+    {
+        const GpuFrameResult &frame = m_History[index % historySize];
+        for (const GpuZoneResult &zone : frame.zones)
+        {
+            uint32_t argumentCount = 0;
+            if (zone.hasStatistics)
+            {
+                for (GpuPipelineStatistic statistic : m_StatisticOrder)
+                {
+                    uint32_t statisticIndex = static_cast<uint32_t>(statistic);
+                    arguments[argumentCount++] = { g_PipelineStatisticNames[statisticIndex], static_cast<double>(zone.statistics[statisticIndex]) };
+                }
+            }
+
+            writer.AddCompleteEvent(GpuTraceProcessId, m_Queue.GetFamilyIndex(), "gpu", zone.name, zone.beginNanoseconds, zone.endNanoseconds - zone.beginNanoseconds, arguments, argumentCount);
+        }
+    }
+}
+
+void VulkanGpuProfiler::Calibrate()
+{
+    if (!m_CalibratedTimestamps)
+    {
+        CalibrateWithSubmit();
+        return;
+    }
+
+    VkCalibratedTimestampInfoEXT infos[2]{ { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT }, { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT } };
+    infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    infos[1].timeDomain = m_HostTimeDomain;
+
+    uint64_t timestamps[2]{};
+    uint64_t maxDeviation = 0;
+    VK_CHECK(vkGetCalibratedTimestampsEXT(m_Device.GetHandle(), 2, infos, timestamps, &maxDeviation));
+
+    m_CalibrationGpuTicks = timestamps[0] & m_TimestampMask;
+
+#if defined(_WIN32)
+    // steady_clock is the performance counter on Windows.
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_CalibrationNanoseconds = static_cast<int64_t>(static_cast<double>(timestamps[1]) * 1e9 / static_cast<double>(frequency.QuadPart));
+#else
+    m_CalibrationNanoseconds = static_cast<int64_t>(timestamps[1]);
+#endif
+}
+
+void VulkanGpuProfiler::CalibrateWithSubmit()
+{
+    // Writes a timestamp and takes the middle of the CPU times around the submit as its host time. Off
+    // by at most half the round trip, which is fine for lining tracks up.
+    VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_Queue.GetFamilyIndex();
+
+    VkCommandPool commandPool{ VK_NULL_HANDLE };
+    VK_CHECK(vkCreateCommandPool(m_Device.GetHandle(), &poolInfo, nullptr, &commandPool));
+
+    VkCommandBufferAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocateInfo.commandPool = commandPool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+    VK_CHECK(vkAllocateCommandBuffers(m_Device.GetHandle(), &allocateInfo, &commandBuffer));
+
+    uint32_t query = m_Desc.framesInFlight * m_Desc.maxZonesPerFrame * 2;
+
+    VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+    vkCmdResetQueryPool(commandBuffer, m_TimestampPool, query, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampPool, query);
+    VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+    VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    VkFence fence{ VK_NULL_HANDLE };
+    VK_CHECK(vkCreateFence(m_Device.GetHandle(), &fenceInfo, nullptr, &fence));
+
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    int64_t submitTime = GetSteadyNanoseconds();
+    VK_CHECK(vkQueueSubmit(m_Queue.GetHandle(), 1, &submitInfo, fence));
+    VK_CHECK(vkWaitForFences(m_Device.GetHandle(), 1, &fence, VK_TRUE, UINT64_MAX));
+    int64_t completeTime = GetSteadyNanoseconds();
+
+    uint64_t timestamp = 0;
+    VK_CHECK(vkGetQueryPoolResults(m_Device.GetHandle(), m_TimestampPool, query, 1, sizeof(timestamp), &timestamp, sizeof(timestamp), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+    m_CalibrationGpuTicks = timestamp & m_TimestampMask;
+    m_CalibrationNanoseconds = submitTime + (completeTime - submitTime) / 2;
+
+    vkDestroyFence(m_Device.GetHandle(), fence, nullptr);
+    vkDestroyCommandPool(m_Device.GetHandle(), commandPool, nullptr);
+}
+
+void VulkanGpuProfiler::Resolve(FrameSlot &slot, uint32_t slotIndex)
+{
+    slot.pending = false;
+    if (slot.zoneCount == 0)
+    {
+        return;
+    }
+
+    // Never waits: a frame the GPU hasn't finished is dropped rather than stalling this one.
+    VkResult result = vkGetQueryPoolResults(m_Device.GetHandle(), m_TimestampPool, slotIndex * m_Desc.maxZonesPerFrame * 2, slot.zoneCount * 2,
+        m_TimestampResults.size() * sizeof(uint64_t), m_TimestampResults.data(), 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result == VK_NOT_READY)
+    {
+        ++m_DroppedFrameCount;
+        return;
+    }
+    VK_CHECK(result);
+
+    if (slot.statisticsCount > 0)
+    {
+        uint32_t stride = m_StatisticCount + 1;
+        result = vkGetQueryPoolResults(m_Device.GetHandle(), m_StatisticsPool, slotIndex * m_Desc.maxZonesPerFrame, slot.statisticsCount,
+            m_StatisticsResults.size() * sizeof(uint64_t), m_StatisticsResults.data(), stride * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result == VK_NOT_READY)
+        {
+            ++m_DroppedFrameCount;
+            return;
+        }
+        VK_CHECK(result);
+    }
+
+    GpuFrameResult &frame = m_History[m_ResolvedFrameCount % m_History.size()];
+    frame.frameIndex = slot.frameIndex;
+    frame.zones.clear();
+
+    for (uint32_t zone = 0; zone < slot.zoneCount; ++zone)
+    {
+        GpuZoneResult zoneResult{};
+        zoneResult.name = slot.names[zone];
+        zoneResult.depth = slot.depths[zone];
+        zoneResult.beginNanoseconds = ToNanoseconds(m_TimestampResults[zone * 4] & m_TimestampMask);
+        zoneResult.endNanoseconds = ToNanoseconds(m_TimestampResults[zone * 4 + 2] & m_TimestampMask);
+
+        uint32_t query = slot.statisticsQueries[zone];
+        if (query != InvalidZone)
+        {
+            const uint64_t *values = &m_StatisticsResults[query * (m_StatisticCount + 1)];
+            for (uint32_t index = 0; index < m_StatisticCount; ++index)
+            {
+                zoneResult.statistics[static_cast<uint32_t>(m_StatisticOrder[index])] = values[index];
+            }
+            zoneResult.hasStatistics = true;
+        }
+
+        frame.zones.push_back(zoneResult);
+    }
+
+    ++m_ResolvedFrameCount;
+}
+
+int64_t VulkanGpuProfiler::ToNanoseconds(uint64_t gpuTicks) const
+{
+    int64_t ticks = static_cast<int64_t>(gpuTicks - m_CalibrationGpuTicks);
+    return m_CalibrationNanoseconds + static_cast<int64_t>(static_cast<double>(ticks) * m_TimestampPeriod);
+}
+
+GpuProfileScope::GpuProfileScope(VulkanGpuProfiler *profiler, VkCommandBuffer commandBuffer, const char *name, bool pipelineStatistics) :
+    m_Profiler{ profiler },
+    m_CommandBuffer{ commandBuffer }
+{
+    if (m_Profiler != nullptr)
+    {
+        m_Zone = m_Profiler->BeginZone(m_CommandBuffer, name, pipelineStatistics);
+    }
+}
+
+GpuProfileScope::~GpuProfileScope()
+{
+    if (m_Profiler != nullptr)
+    {
+        m_Profiler->EndZone(m_CommandBuffer, m_Zone);
+    }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class VulkanQueue;
+
+class ChromeTraceWriter;
+
+struct GpuProfilerDesc
+{
+    // Frames recorded before a slot's queries are reused; results are read this many frames later.
+    uint32_t framesInFlight{ 3 };
+
+    uint32_t maxZonesPerFrame{ 256 };
+
+    // Resolved frames kept for GetFrame() and Capture().
+    uint32_t historyFrameCount{ 240 };
+};
+
+enum class GpuPipelineStatistic : uint32_t
+{
+    InputAssemblyVertices,
+    InputAssemblyPrimitives,
+    VertexShaderInvocations,
+    ClippingInvocations,
+    ClippingPrimitives,
+    FragmentShaderInvocations,
+    ComputeShaderInvocations,
+    Count
+};
+
+struct GpuZoneResult
+{
+    const char *name{ nullptr };
+
+    uint32_t depth{ 0 };
+
+    // Nanoseconds on std::chrono::steady_clock, the timeline of the CPU profiler.
+    int64_t beginNanoseconds{ 0 };
+
+    int64_t endNanoseconds{ 0 };
+
+    bool hasStatistics{ false };
+
+    uint64_t statistics[static_cast<uint32_t>(GpuPipelineStatistic::Count)]{};
+};
+
+struct GpuFrameResult
+{
+    uint64_t frameIndex{ 0 };
+
+    // zones[0] spans the whole frame, the rest follow in the order they began.
+    std::vector<GpuZoneResult> zones;
+};
+
+// Times GPU work with timestamp queries, optionally with pipeline statistics, one query range per
+// frame in flight. Results are read when a slot comes round again, so nothing ever waits on the GPU.
+// Meant for the thread recording the frame's command buffers.
+class VulkanGpuProfiler : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t InvalidZone = ~0u;
+
+    VulkanGpuProfiler(VulkanDevice &device, const VulkanQueue &queue, const GpuProfilerDesc &desc = {});
+
+    ~VulkanGpuProfiler();
+
+    // False when the queue has no timestamp support, every call is then a no-op.
+    bool IsSupported() const;
+
+    bool HasPipelineStatistics() const;
+
+    // Call outside a render pass, once the fence of the frame that last used this slot has signalled.
+    // Reads that frame's results if they are available and resets the slot's queries.
+    void BeginFrame(VkCommandBuffer commandBuffer, uint64_t frameIndex);
+
+    void EndFrame(VkCommandBuffer commandBuffer);
+
+    // Statistics zones don't nest, an inner request only gets timestamps. A statistics zone has to end
+    // on the same side of a render pass boundary as it began.
+    uint32_t BeginZone(VkCommandBuffer commandBuffer, const char *name, bool pipelineStatistics = false);
+
+    void EndZone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+    // Most recently resolved frame, nullptr before the first one.
+    const GpuFrameResult *GetLatestFrame() const;
+
+    // Frames whose results weren't available when their slot was reused.
+    uint64_t GetDroppedFrameCount() const;
+
+    // Adds the resolved history as a GPU track on the CPU profiler's timeline.
+    void Capture(ChromeTraceWriter &writer) const;
+
+private:
+
+    struct FrameSlot
+    {
+        uint64_t frameIndex{ 0 };
+
+        bool pending{ false };
+
+        uint32_t zoneCount{ 0 };
+
+        uint32_t statisticsCount{ 0 };
+
+        std::vector<const char *> names;
+
+        std::vector<uint32_t> depths;
+
+        // Statistics query of each zone, InvalidZone when it has none.
+        std::vector<uint32_t> statisticsQueries;
+    };
+
+    void Calibrate();
+
+    void CalibrateWithSubmit();
+
+    void Resolve(FrameSlot &slot, uint32_t slotIndex);
+
+    int64_t ToNanoseconds(uint64_t gpuTicks) const;
+
+    VulkanDevice &m_Device;
+
+    const VulkanQueue &m_Queue;
+
+    GpuProfilerDesc m_Desc;
+
+    VkQueryPool m_TimestampPool{ VK_NULL_HANDLE };
+
+    VkQueryPool m_StatisticsPool{ VK_NULL_HANDLE };
+
+    VkQueryPipelineStatisticFlags m_StatisticFlags{ 0 };
+
+    uint32_t m_StatisticCount{ 0 };
+
+    // Which GpuPipelineStatistic each of the m_StatisticCount query results is.
+    std::vector<GpuPipelineStatistic> m_StatisticOrder;
+
+    uint64_t m_TimestampMask{ 0 };
+
+    double m_TimestampPeriod{ 1.0 };
+
+    bool m_CalibratedTimestamps{ false };
+
+    VkTimeDomainEXT m_HostTimeDomain{ VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT };
+
+    uint64_t m_CalibrationGpuTicks{ 0 };
+
+    int64_t m_CalibrationNanoseconds{ 0 };
+
+    std::vector<FrameSlot> m_Slots;
+
+    FrameSlot *m_CurrentSlot{ nullptr };
+
+    uint32_t m_CurrentDepth{ 0 };
+
+    bool m_StatisticsActive{ false };
+
+    std::vector<uint64_t> m_TimestampResults;
+
+    std::vector<uint64_t> m_StatisticsResults;
+
+    std::vector<GpuFrameResult> m_History;
+
+    uint64_t m_ResolvedFrameCount{ 0 };
+
+    uint64_t m_DroppedFrameCount{ 0 };
+};
+
+class GpuProfileScope : public NonCopyable
+{
+public:
+
+    GpuProfileScope(VulkanGpuProfiler *profiler, VkCommandBuffer commandBuffer, const char *name, bool pipelineStatistics = false);
+
+    ~GpuProfileScope();
+
+private:
+
+    VulkanGpuProfiler *m_Profiler;
+
+    VkCommandBuffer m_CommandBuffer;
+
+    uint32_t m_Zone{ VulkanGpuProfiler::InvalidZone };
+};
+
+#if defined(NEXT_RENDER_PROFILER)
+#define NEXT_RENDER_GPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define NEXT_RENDER_GPU_PROFILE_CONCAT(a, b) NEXT_RENDER_GPU_PROFILE_CONCAT_INNER(a, b)
+
+// profiler may be nullptr.
+#define GPU_PROFILE_SCOPE(profiler, commandBuffer, name) GpuProfileScope NEXT_RENDER_GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__){ profiler, commandBuffer, name }
+#define GPU_PROFILE_SCOPE_STATISTICS(profiler, commandBuffer, name) GpuProfileScope NEXT_RENDER_GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__){ profiler, commandBuffer, name, true }
+#else
+#define GPU_PROFILE_SCOPE(profiler, commandBuffer, name)
+#define GPU_PROFILE_SCOPE_STATISTICS(profiler, commandBuffer, name)
+#endif
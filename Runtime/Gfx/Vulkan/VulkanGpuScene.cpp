@@ -0,0 +1,474 @@
+#include "VulkanGpuScene.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanUtils.h"
+#include "Render/GpuScene.h"
+#include <algorithm>
+#include <cassert>
+
+static const char *g_GpuSceneCullShader = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct LodRange
+{
+    uint firstIndex;
+    uint indexCount;
+    float error;
+    uint padding;
+};
+
+struct Geometry
+{
+    vec4 boundingSphere;
+    uint lodCount;
+    int vertexOffset;
+    uint padding0;
+    uint padding1;
+    LodRange lods[MAX_MESH_LODS];
+};
+
+struct Instance
+{
+    mat4 world;
+    uint geometryIndex;
+    uint pipelineIndex;
+    uint objectId;
+    float maxScale;
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Geometries
+{
+    Geometry geometries[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances
+{
+    Instance instances[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer DrawOffsets
+{
+    uint drawOffsets[];
+};
+
+layout(std430, set = 0, binding = 3) writeonly buffer DrawCommands
+{
+    DrawCommand drawCommands[];
+};
+
+layout(std430, set = 0, binding = 4) buffer DrawCounts
+{
+    uint drawCounts[];
+};
+
+layout(push_constant) uniform CullConstants
+{
+    vec4 frustumPlanes[6];
+    // w is the LOD scale, pixels per world unit at distance 1.
+    vec4 cameraPosition;
+    float maxScreenError;
+    uint instanceCount;
+    // Draw slot and count of the view being culled, see VulkanGpuScene::Cull().
+    uint drawBase;
+    uint countBase;
+} constants;
+
+void main()
+{
+    uint instanceIndex = gl_GlobalInvocationID.x;
+    if (instanceIndex >= constants.instanceCount)
+    {
+        return;
+    }
+
+    Instance instance = instances[instanceIndex];
+    Geometry geometry = geometries[instance.geometryIndex];
+
+    vec3 center = (instance.world * vec4(geometry.boundingSphere.xyz, 1.0)).xyz;
+    float radius = geometry.boundingSphere.w * instance.maxScale;
+
+    if (geometry.lodCount == 0)
+    {
+        return;
+    }
+
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        if (dot(constants.frustumPlanes[plane].xyz, center) + constants.frustumPlanes[plane].w < -radius)
+        {
+            return;
+        }
+    }
+
+    float distance = max(length(center - constants.cameraPosition.xyz) - radius, 1e-4);
+    float scale = instance.maxScale * constants.cameraPosition.w / distance;
+
+    uint lod = 0;
+    while (lod + 1 < geometry.lodCount && geometry.lods[lod + 1].error * scale <= constants.maxScreenError)
+    {
+        ++lod;
+    }
+
+    uint drawIndex = constants.drawBase + drawOffsets[instance.pipelineIndex] + atomicAdd(drawCounts[constants.countBase + instance.pipelineIndex], 1);
+    drawCommands[drawIndex] = DrawCommand(geometry.lods[lod].indexCount, 1, geometry.lods[lod].firstIndex, geometry.vertexOffset, instanceIndex);
+}
+)";
+
+static constexpr uint32_t GpuSceneCullGroupSize = 64;
+
+static constexpr uint32_t GpuSceneBindingCount = 5;
+
+// Matches CullConstants.
+struct GpuSceneCullConstants
+{
+    glm::vec4 frustumPlanes[Frustum::PlaneCount];
+
+    glm::vec4 cameraPosition;
+
+    float maxScreenError;
+
+    uint32_t instanceCount;
+
+    uint32_t drawBase;
+
+    uint32_t countBase;
+};
+
+static_assert(sizeof(GpuSceneCullConstants) <= 128, "Culling push constants exceed the guaranteed minimum");
+
+VulkanGpuScene::VulkanGpuScene(VulkanDevice &device, GpuScene &scene, uint32_t viewCount, uint32_t framesInFlight) :
+    m_Device{ device },
+    m_InstanceCount{ static_cast<uint32_t>(scene.GetInstances().size()) },
+    m_ViewCount{ viewCount },
+    m_DrawOffsets{ scene.GetDrawOffsets() }
+{
+    assert(m_InstanceCount > 0);
+    assert(m_ViewCount > 0);
+    assert(framesInFlight > 0);
+
+    const std::vector<GpuDrawGeometry> &geometries = scene.GetGeometries();
+    const std::vector<GpuInstance> &instances = scene.GetInstances();
+
+    // The culling shader stores the instance index in firstInstance, there is no way around it.
+    if (!m_Device.IsDrawIndirectFirstInstanceEnabled())
+    {
+        LOGE("{} lacks drawIndirectFirstInstance, VulkanGpuScene can't draw on it", m_Device.GetGpu().GetProperties().deviceName);
+        abort();
+    }
+
+    m_DrawIndexedIndirectCount = m_Device.GetDrawIndexedIndirectCount();
+    if (m_DrawIndexedIndirectCount == nullptr)
+    {
+        LOGW("vkCmdDrawIndexedIndirectCount is unavailable, drawing every instance slot with vkCmdDrawIndexedIndirect.");
+    }
+
+    m_MultiDrawIndirect = m_Device.IsMultiDrawIndirectEnabled();
+
+    VkDeviceSize geometrySize = geometries.size() * sizeof(GpuDrawGeometry);
+    m_GeometryBuffer = std::make_unique<VulkanBuffer>(m_Device, geometrySize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_GeometryBuffer->Update(geometries.data(), geometrySize);
+
+    VkDeviceSize instanceSize = instances.size() * sizeof(GpuInstance);
+    m_InstanceBuffer = std::make_unique<VulkanBuffer>(m_Device, instanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    // Whole size each, the dirty range lands at its own offset.
+    for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+    {
+        m_StagingBuffers.push_back(std::make_unique<VulkanBuffer>(m_Device, instanceSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY));
+    }
+
+    VkDeviceSize drawOffsetSize = m_DrawOffsets.size() * sizeof(uint32_t);
+    m_DrawOffsetBuffer = std::make_unique<VulkanBuffer>(m_Device, drawOffsetSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_DrawOffsetBuffer->Update(m_DrawOffsets.data(), drawOffsetSize);
+
+    m_DrawBuffer = std::make_unique<VulkanBuffer>(m_Device, static_cast<VkDeviceSize>(m_ViewCount) * m_InstanceCount * sizeof(DrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    m_DrawCountBuffer = std::make_unique<VulkanBuffer>(m_Device, m_ViewCount * GetPipelineCount() * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    std::string shaderSource{ g_GpuSceneCullShader };
+    std::vector<std::string> definitions{ "MAX_MESH_LODS " + std::to_string(MaxMeshLods) };
+    m_Shader = std::make_unique<VulkanShader>(m_Device, ComputeShader, "main", std::vector<uint8_t>{ shaderSource.begin(), shaderSource.end() }, definitions);
+
+    VkDescriptorSetLayoutBinding bindings[GpuSceneBindingCount]{};
+    for (uint32_t binding = 0; binding < GpuSceneBindingCount; ++binding)
+    {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    setLayoutInfo.bindingCount = GpuSceneBindingCount;
+    setLayoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(m_Device.GetHandle(), &setLayoutInfo, nullptr, &m_DescriptorSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GpuSceneCullConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(m_Device.GetHandle(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = m_Shader->GetHandle();
+    pipelineInfo.stage.pName = m_Shader->GetEntryPoint().c_str();
+    pipelineInfo.layout = m_PipelineLayout;
+    VK_CHECK(vkCreateComputePipelines(m_Device.GetHandle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_Pipeline));
+
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, GpuSceneBindingCount };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(m_Device.GetHandle(), &poolInfo, nullptr, &m_DescriptorPool));
+
+    VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocateInfo.descriptorPool = m_DescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+    VK_CHECK(vkAllocateDescriptorSets(m_Device.GetHandle(), &allocateInfo, &m_DescriptorSet));
+
+    VkDescriptorBufferInfo bufferInfos[GpuSceneBindingCount]{
+        { m_GeometryBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+        { m_InstanceBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+        { m_DrawOffsetBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+        { m_DrawBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+        { m_DrawCountBuffer->GetHandle(), 0, VK_WHOLE_SIZE } };
+
+    VkWriteDescriptorSet writes[GpuSceneBindingCount]{};
+    for (uint32_t binding = 0; binding < GpuSceneBindingCount; ++binding)
+    {
+        writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[binding].dstSet = m_DescriptorSet;
+        writes[binding].dstBinding = binding;
+        writes[binding].descriptorCount = 1;
+        writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+    vkUpdateDescriptorSets(m_Device.GetHandle(), GpuSceneBindingCount, writes, 0, nullptr);
+}
+
+VulkanGpuScene::~VulkanGpuScene()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    vkDestroyPipeline(device, m_Pipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+}
+
+void VulkanGpuScene::Upload(VkCommandBuffer commandBuffer, GpuScene &scene)
+{
+    const std::vector<GpuInstance> &instances = scene.GetInstances();
+    assert(instances.size() == m_InstanceCount && "Instances were added after the GPU scene was created.");
+
+    uint32_t dirtyBegin = m_FullUploadPending ? 0 : scene.GetDirtyBegin();
+    uint32_t dirtyEnd = m_FullUploadPending ? m_InstanceCount : std::min(scene.GetDirtyEnd(), m_InstanceCount);
+    m_FullUploadPending = false;
+    scene.ClearDirtyRange();
+
+    if (dirtyBegin >= dirtyEnd)
+    {
+        return;
+    }
+
+    // Last written framesInFlight uploads ago, the GPU is done copying from it.
+    VulkanBuffer &staging = *m_StagingBuffers[m_StagingIndex];
+    m_StagingIndex = (m_StagingIndex + 1) % static_cast<uint32_t>(m_StagingBuffers.size());
+
+    VkBufferCopy region{};
+    region.srcOffset = static_cast<VkDeviceSize>(dirtyBegin) * sizeof(GpuInstance);
+    region.dstOffset = region.srcOffset;
+    region.size = static_cast<VkDeviceSize>(dirtyEnd - dirtyBegin) * sizeof(GpuInstance);
+    staging.Update(&instances[dirtyBegin], region.size, region.srcOffset);
+
+    // Culling and vertex shaders of earlier frames read the instances being overwritten.
+    VkBufferMemoryBarrier barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = m_InstanceBuffer->GetHandle();
+    barrier.offset = region.dstOffset;
+    barrier.size = region.size;
+
+    VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    vkCmdPipelineBarrier(commandBuffer, shaderStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    vkCmdCopyBuffer(commandBuffer, staging.GetHandle(), m_InstanceBuffer->GetHandle(), 1, &region);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, shaderStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void VulkanGpuScene::Cull(VkCommandBuffer commandBuffer, const GpuCullParams &params, uint32_t view)
+{
+    Cull(commandBuffer, &params, view, 1);
+}
+
+void VulkanGpuScene::Cull(VkCommandBuffer commandBuffer, const GpuCullParams *params, uint32_t firstView, uint32_t viewCount)
+{
+    assert(viewCount > 0 && firstView + viewCount <= m_ViewCount);
+
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "GpuScene::Cull");
+
+    // The draws of an earlier frame still in flight read the buffers this pass rewrites.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    // Views are contiguous, so the culled ones are reset with one fill per buffer.
+    VkDeviceSize countSize = GetPipelineCount() * sizeof(uint32_t);
+    VkDeviceSize drawSize = m_InstanceCount * sizeof(DrawIndexedIndirectCommand);
+
+    VkBufferMemoryBarrier resetBarriers[2]{};
+    for (VkBufferMemoryBarrier &barrier : resetBarriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    }
+    resetBarriers[0].buffer = m_DrawCountBuffer->GetHandle();
+    resetBarriers[0].offset = firstView * countSize;
+    resetBarriers[0].size = viewCount * countSize;
+    resetBarriers[1].buffer = m_DrawBuffer->GetHandle();
+    resetBarriers[1].offset = firstView * drawSize;
+    resetBarriers[1].size = viewCount * drawSize;
+
+    vkCmdFillBuffer(commandBuffer, m_DrawCountBuffer->GetHandle(), resetBarriers[0].offset, resetBarriers[0].size, 0);
+    if (m_DrawIndexedIndirectCount == nullptr)
+    {
+        vkCmdFillBuffer(commandBuffer, m_DrawBuffer->GetHandle(), resetBarriers[1].offset, resetBarriers[1].size, 0);
+    }
+
+    uint32_t resetBarrierCount = m_DrawIndexedIndirectCount == nullptr ? 2 : 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, resetBarrierCount, resetBarriers, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+
+    for (uint32_t index = 0; index < viewCount; ++index)
+    {
+        const GpuCullParams &viewParams = params[index];
+        uint32_t view = firstView + index;
+
+        GpuSceneCullConstants constants{};
+        for (uint32_t plane = 0; plane < Frustum::PlaneCount; ++plane)
+        {
+            constants.frustumPlanes[plane] = viewParams.frustum.planes[plane];
+        }
+        constants.cameraPosition = glm::vec4{ viewParams.cameraPosition, viewParams.lodScale };
+        constants.maxScreenError = viewParams.maxScreenError;
+        constants.instanceCount = m_InstanceCount;
+        constants.drawBase = view * m_InstanceCount;
+        constants.countBase = view * GetPipelineCount();
+
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+        vkCmdDispatch(commandBuffer, (m_InstanceCount + GpuSceneCullGroupSize - 1) / GpuSceneCullGroupSize, 1, 1);
+    }
+
+    VkBufferMemoryBarrier drawBarriers[2]{};
+    for (VkBufferMemoryBarrier &barrier : drawBarriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    }
+    drawBarriers[0].buffer = m_DrawBuffer->GetHandle();
+    drawBarriers[0].offset = resetBarriers[1].offset;
+    drawBarriers[0].size = resetBarriers[1].size;
+    drawBarriers[1].buffer = m_DrawCountBuffer->GetHandle();
+    drawBarriers[1].offset = resetBarriers[0].offset;
+    drawBarriers[1].size = resetBarriers[0].size;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 2, drawBarriers, 0, nullptr);
+}
+
+void VulkanGpuScene::Draw(VkCommandBuffer commandBuffer, uint32_t pipelineIndex, uint32_t view)
+{
+    assert(pipelineIndex < GetPipelineCount());
+    assert(view < m_ViewCount);
+
+    uint32_t firstDraw = m_DrawOffsets[pipelineIndex];
+    uint32_t maxDrawCount = m_DrawOffsets[pipelineIndex + 1] - firstDraw;
+    if (maxDrawCount == 0)
+    {
+        return;
+    }
+
+    VkDeviceSize drawOffset = (static_cast<VkDeviceSize>(view) * m_InstanceCount + firstDraw) * sizeof(DrawIndexedIndirectCommand);
+    VkDeviceSize countOffset = (view * GetPipelineCount() + pipelineIndex) * sizeof(uint32_t);
+
+    if (m_DrawIndexedIndirectCount != nullptr)
+    {
+        m_DrawIndexedIndirectCount(commandBuffer, m_DrawBuffer->GetHandle(), drawOffset, m_DrawCountBuffer->GetHandle(), countOffset, maxDrawCount, sizeof(DrawIndexedIndirectCommand));
+    }
+    else if (m_MultiDrawIndirect)
+    {
+        vkCmdDrawIndexedIndirect(commandBuffer, m_DrawBuffer->GetHandle(), drawOffset, maxDrawCount, sizeof(DrawIndexedIndirectCommand));
+    }
+    else
+    {
+        for (uint32_t draw = 0; draw < maxDrawCount; ++draw)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, m_DrawBuffer->GetHandle(), drawOffset + draw * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+        }
+    }
+}
+
+uint32_t VulkanGpuScene::GetInstanceCount() const
+{
+    return m_InstanceCount;
+}
+
+uint32_t VulkanGpuScene::GetViewCount() const
+{
+    return m_ViewCount;
+}
+
+uint32_t VulkanGpuScene::GetPipelineCount() const
+{
+    return static_cast<uint32_t>(m_DrawOffsets.size() - 1);
+}
+
+const VulkanBuffer &VulkanGpuScene::GetInstanceBuffer() const
+{
+    return *m_InstanceBuffer;
+}
+
+const VulkanBuffer &VulkanGpuScene::GetDrawBuffer() const
+{
+    return *m_DrawBuffer;
+}
+
+const VulkanBuffer &VulkanGpuScene::GetDrawCountBuffer() const
+{
+    return *m_DrawCountBuffer;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "VulkanBuffer.h"
+#include "VulkanShader.h"
+#include <memory>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class GpuScene;
+
+struct GpuCullParams;
+
+// GPU driven submission of a whole GpuScene. A compute pass culls every instance, selects its LOD and
+// appends a draw into the region of its pipeline, then each pipeline is drawn with one
+// vkCmdDrawIndexedIndirectCount. Per frame CPU work is the push constants plus staging the instances
+// touched since the last Upload(), whatever the instance count.
+//
+// Every view (a camera, a shadow cascade, a shadow atlas tile) has its own draw and count region, so
+// several views can be culled back to back and drawn later in one render pass.
+class VulkanGpuScene : public NonCopyable
+{
+public:
+
+    // Buffers are sized for the instances and geometries the scene holds now, create a new one after
+    // adding more. The draw buffer holds viewCount * instance count commands. framesInFlight is the
+    // most command buffers recording an Upload() the GPU may run at once.
+    VulkanGpuScene(VulkanDevice &device, GpuScene &scene, uint32_t viewCount = 1, uint32_t framesInFlight = 3);
+
+    ~VulkanGpuScene();
+
+    // Records a copy of the dirty instance range into the instance buffer, all instances the first
+    // time. The range goes through the next of framesInFlight staging buffers, so frames still in
+    // flight keep their data. Must be recorded outside a render pass, before the first Cull().
+    void Upload(VkCommandBuffer commandBuffer, GpuScene &scene);
+
+    // Resets the draw counts of view and dispatches the culling shader. Must be recorded outside a
+    // render pass.
+    void Cull(VkCommandBuffer commandBuffer, const GpuCullParams &params, uint32_t view = 0);
+
+    // Culls params[i] into view firstView + i, with one reset and one barrier for all of them.
+    void Cull(VkCommandBuffer commandBuffer, const GpuCullParams *params, uint32_t firstView, uint32_t viewCount);
+
+    // Issues the draws of one pipeline. The caller binds the pipeline, the shared vertex and index
+    // buffers, and GetInstanceBuffer() for the vertex shader; firstInstance of every draw is the
+    // instance index.
+    void Draw(VkCommandBuffer commandBuffer, uint32_t pipelineIndex, uint32_t view = 0);
+
+    uint32_t GetInstanceCount() const;
+
+    uint32_t GetViewCount() const;
+
+    uint32_t GetPipelineCount() const;
+
+    const VulkanBuffer &GetInstanceBuffer() const;
+
+    const VulkanBuffer &GetDrawBuffer() const;
+
+    const VulkanBuffer &GetDrawCountBuffer() const;
+
+private:
+
+    VulkanDevice &m_Device;
+
+    uint32_t m_InstanceCount{ 0 };
+
+    uint32_t m_ViewCount{ 1 };
+
+    std::vector<uint32_t> m_DrawOffsets;
+
+    // Without vkCmdDrawIndexedIndirectCount the whole region is drawn and culled slots keep a zero
+    // instance count.
+    PFN_vkCmdDrawIndexedIndirectCount m_DrawIndexedIndirectCount{ nullptr };
+
+    // Without multiDrawIndirect that region is drawn one command per call.
+    bool m_MultiDrawIndirect{ false };
+
+    bool m_FullUploadPending{ true };
+
+    uint32_t m_StagingIndex{ 0 };
+
+    std::unique_ptr<VulkanBuffer> m_GeometryBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_InstanceBuffer;
+
+    std::vector<std::unique_ptr<VulkanBuffer>> m_StagingBuffers;
+
+    std::unique_ptr<VulkanBuffer> m_DrawOffsetBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_DrawBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_DrawCountBuffer;
+
+    std::unique_ptr<VulkanShader> m_Shader;
+
+    VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+
+    VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+
+    VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+
+    VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+
+    VkPipeline m_Pipeline{ VK_NULL_HANDLE };
+};
@@ -0,0 +1,72 @@
+#include "VulkanImage.h"
+#include "VulkanDevice.h"
+#include "VulkanUtils.h"
+#include <cassert>
+
+VulkanImage::VulkanImage(VulkanDevice &device, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VmaMemoryUsage memoryUsage) :
+    m_Device{ device },
+    m_Extent{ extent },
+    m_Format{ format }
+{
+    assert(extent.width > 0 && extent.height > 0);
+
+    VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = { extent.width, extent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = memoryUsage;
+
+    VK_CHECK(vmaCreateImage(m_Device.GetMemoryAllocator(), &imageInfo, &allocationInfo, &m_Handle, &m_Allocation, nullptr));
+
+    VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    viewInfo.image = m_Handle;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspect;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VK_CHECK(vkCreateImageView(m_Device.GetHandle(), &viewInfo, nullptr, &m_View));
+}
+
+VulkanImage::~VulkanImage()
+{
+    if (m_View != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(m_Device.GetHandle(), m_View, nullptr);
+    }
+
+    if (m_Handle != VK_NULL_HANDLE)
+    {
+        vmaDestroyImage(m_Device.GetMemoryAllocator(), m_Handle, m_Allocation);
+    }
+}
+
+VkImage VulkanImage::GetHandle() const
+{
+    return m_Handle;
+}
+
+VkImageView VulkanImage::GetView() const
+{
+    return m_View;
+}
+
+VkExtent2D VulkanImage::GetExtent() const
+{
+    return m_Extent;
+}
+
+VkFormat VulkanImage::GetFormat() const
+{
+    return m_Format;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+class VulkanDevice;
+
+// VMA backed 2D image with a view covering its single mip level.
+class VulkanImage : public NonCopyable
+{
+public:
+
+    VulkanImage(VulkanDevice &device, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY);
+
+    ~VulkanImage();
+
+    VkImage GetHandle() const;
+
+    VkImageView GetView() const;
+
+    VkExtent2D GetExtent() const;
+
+    VkFormat GetFormat() const;
+
+private:
+
+    VulkanDevice &m_Device;
+
+    VkImage m_Handle{ VK_NULL_HANDLE };
+
+    VkImageView m_View{ VK_NULL_HANDLE };
+
+    VmaAllocation m_Allocation{ VK_NULL_HANDLE };
+
+    VkExtent2D m_Extent{};
+
+    VkFormat m_Format{ VK_FORMAT_UNDEFINED };
+};
@@ -2,6 +2,10 @@
 #include "Common/Logging.h"
 #include "VulkanUtils.h"
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 
 #if defined(VKB_DEBUG) || defined(VKB_VALIDATION_LAYERS)
 
@@ -149,6 +153,9 @@ VulkanInstance::VulkanInstance(const std::string &applicationName,
             headlessExtension = true;
             LOGI("{} is available, enabling it", VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
             m_EnabledExtensions.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+
+            // Headless surfaces are VkSurfaceKHR, the extension depends on it.
+            m_EnabledExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
         }
         else
         {
@@ -166,6 +173,14 @@ VulkanInstance::VulkanInstance(const std::string &applicationName,
         auto extensionName = extension.first;
         auto extensionIsOptional = extension.second;
 
+        // Window systems ask for VK_KHR_surface as well.
+        bool alreadyEnabled = std::any_of(m_EnabledExtensions.begin(), m_EnabledExtensions.end(),
+            [extensionName](const char *enabled) { return std::strcmp(enabled, extensionName) == 0; });
+        if (alreadyEnabled)
+        {
+            continue;
+        }
+
         if (!IsExtensionSupported(extensionName))
         {
             if (extensionIsOptional)
@@ -219,7 +234,9 @@ VulkanInstance::VulkanInstance(const std::string &applicationName,
     appInfo.applicationVersion = 0;
     appInfo.pEngineName = "Vulkan Samples";
     appInfo.engineVersion = 0;
-    appInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    // Shaders are compiled for Vulkan 1.1, and 1.2 brings vkCmdDrawIndexedIndirectCount into core.
+    m_ApiVersion = std::min(volkGetInstanceVersion(), static_cast<uint32_t>(VK_API_VERSION_1_2));
+    appInfo.apiVersion = m_ApiVersion;
 
     VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
 
@@ -300,23 +317,189 @@ void VulkanInstance::QueryGpus()
     }
 }
 
-/*PhysicalDevice &Instance::getSuitableGpu()
+VkInstance VulkanInstance::GetHandle() const
+{
+    return m_Handle;
+}
+
+uint32_t VulkanInstance::GetApiVersion() const
+{
+    return m_ApiVersion;
+}
+
+const std::vector<std::unique_ptr<VulkanPhysicalDevice>> &VulkanInstance::GetGpus() const
 {
-    assert(!gpus.empty() && "No physical devices were found on the system.");
+    return m_GPUs;
+}
+
+VulkanPhysicalDevice &VulkanInstance::GetSuitableGpu(const std::string &preferredGpu)
+{
+    assert(!m_GPUs.empty() && "No physical devices were found on the system.");
+
+    for (const std::unique_ptr<VulkanPhysicalDevice> &gpu : m_GPUs)
+    {
+        LOGI("GPU {} scores {}", gpu->GetProperties().deviceName, ScoreGpu(*gpu));
+    }
 
-    // Find a discrete GPU
-    for (auto &gpu : gpus)
+    std::string preferred = preferredGpu;
+    if (preferred.empty())
     {
-        if (gpu->get_properties().deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+        const char *environment = std::getenv("NEXT_RENDER_GPU");
+        preferred = environment != nullptr ? environment : "";
+    }
+
+    if (!preferred.empty())
+    {
+        VulkanPhysicalDevice *gpu = FindGpu(preferred);
+        if (gpu != nullptr)
         {
+            if (ScoreGpu(*gpu) == 0)
+            {
+                LOGW("Preferred GPU {} lacks what the renderer needs, using it anyway", gpu->GetProperties().deviceName);
+            }
             return *gpu;
         }
+        LOGW("Preferred GPU {} not found, picking by score", preferred);
+    }
+
+    std::vector<VulkanPhysicalDevice *> gpus = GetGpusByScore();
+    if (gpus.empty())
+    {
+        LOGW("No GPU can run the renderer, picking default GPU");
+        return *m_GPUs.at(0);
+    }
+    return *gpus[0];
+}
+
+std::vector<VulkanPhysicalDevice *> VulkanInstance::GetGpusByScore(bool includeCpuDevices) const
+{
+    std::vector<std::pair<uint64_t, VulkanPhysicalDevice *>> scored;
+    std::vector<std::pair<uint64_t, VulkanPhysicalDevice *>> cpuDevices;
+    for (const std::unique_ptr<VulkanPhysicalDevice> &gpu : m_GPUs)
+    {
+        uint64_t score = ScoreGpu(*gpu);
+        if (score == 0)
+        {
+            continue;
+        }
+
+        if (gpu->GetProperties().deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU && !includeCpuDevices)
+        {
+            cpuDevices.emplace_back(score, gpu.get());
+        }
+        else
+        {
+            scored.emplace_back(score, gpu.get());
+        }
+    }
+
+    // A software rasterizer only beats having nothing at all.
+    if (scored.empty())
+    {
+        scored = std::move(cpuDevices);
+    }
+
+    // Stable, so equal GPUs keep the enumeration order.
+    std::stable_sort(scored.begin(), scored.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    std::vector<VulkanPhysicalDevice *> gpus;
+    gpus.reserve(scored.size());
+    for (const auto &entry : scored)
+    {
+        gpus.push_back(entry.second);
+    }
+    return gpus;
+}
+
+uint64_t VulkanInstance::ScoreGpu(const VulkanPhysicalDevice &gpu)
+{
+    const VkPhysicalDeviceProperties &properties = gpu.GetProperties();
+
+    // Shaders are compiled for Vulkan 1.1.
+    if (properties.apiVersion < VK_API_VERSION_1_1)
+    {
+        return 0;
+    }
+
+    bool hasGraphics = false;
+    bool hasAsyncCompute = false;
+    bool hasTransfer = false;
+    for (const VkQueueFamilyProperties &family : gpu.GetQueueFamilyProperties())
+    {
+        if ((family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0)
+        {
+            hasGraphics = true;
+        }
+        else if ((family.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0)
+        {
+            hasAsyncCompute = true;
+        }
+        else if ((family.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0)
+        {
+            hasTransfer = true;
+        }
+    }
+
+    if (!hasGraphics)
+    {
+        return 0;
+    }
+
+    // Steps of 2^21 leave room for a TiB of memory plus the queue bonus, memory never outweighs the type.
+    uint64_t typeRank = 1;
+    switch (properties.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        typeRank = 5;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        typeRank = 4;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        typeRank = 3;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        typeRank = 2;
+        break;
+    default:
+        break;
+    }
+
+    uint64_t memoryMiB = std::min<uint64_t>(gpu.GetDeviceLocalMemorySize() >> 20, (1ull << 20) - 1);
+
+    // Worth about as much as 256 MiB each, they only settle otherwise close GPUs.
+    uint64_t queueBonus = (hasAsyncCompute ? 256 : 0) + (hasTransfer ? 256 : 0);
+
+    return (typeRank << 21) + memoryMiB + queueBonus;
+}
+
+VulkanPhysicalDevice *VulkanInstance::FindGpu(const std::string &preferredGpu) const
+{
+    // An index when the whole string parses as one, a name otherwise, also when it overflows.
+    size_t index = 0;
+    const char *end = preferredGpu.data() + preferredGpu.size();
+    std::from_chars_result parsed = std::from_chars(preferredGpu.data(), end, index);
+    if (parsed.ec == std::errc{} && parsed.ptr == end)
+    {
+        return index < m_GPUs.size() ? m_GPUs[index].get() : nullptr;
     }
 
-    // Otherwise just pick the first one
-    LOGW("Couldn't find a discrete physical device, picking default GPU");
-    return *gpus.at(0);
-}*/
+    auto toLower = [](std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    };
+
+    std::string name = toLower(preferredGpu);
+    for (const std::unique_ptr<VulkanPhysicalDevice> &gpu : m_GPUs)
+    {
+        if (toLower(gpu->GetProperties().deviceName).find(name) != std::string::npos)
+        {
+            return gpu.get();
+        }
+    }
+    return nullptr;
+}
 
 VulkanInstance::~VulkanInstance()
 {
@@ -19,10 +19,31 @@ public:
 
     ~VulkanInstance();
 
+    VkInstance GetHandle() const;
+
+    // Vulkan version the instance was created with.
+    uint32_t GetApiVersion() const;
+
+    const std::vector<std::unique_ptr<VulkanPhysicalDevice>> &GetGpus() const;
+
+    // Unless overridden, the highest scoring GPU. preferredGpu, or the NEXT_RENDER_GPU environment variable
+    // when empty, selects one by index in GetGpus() or by a case insensitive part of its name.
+    VulkanPhysicalDevice &GetSuitableGpu(const std::string &preferredGpu = {});
+
+    // Usable GPUs, best first. CPU devices such as lavapipe only when includeCpuDevices is set or
+    // nothing else can run the renderer.
+    std::vector<VulkanPhysicalDevice *> GetGpusByScore(bool includeCpuDevices = false) const;
+
+    // Device type first, then device local memory in MiB, then dedicated compute and transfer queue
+    // families. 0 when the GPU can't run the renderer: no graphics queue or older than Vulkan 1.1.
+    static uint64_t ScoreGpu(const VulkanPhysicalDevice &gpu);
+
 private:
 
     void QueryGpus();
 
+    VulkanPhysicalDevice *FindGpu(const std::string &preferredGpu) const;
+
     bool IsExtensionSupported(const std::string &requestedExtension);
 
     bool IsValidationLayerSupported(const std::string &requestedValidationLayer);
@@ -30,6 +51,8 @@ private:
 
     VkInstance m_Handle{ VK_NULL_HANDLE };
 
+    uint32_t m_ApiVersion{ VK_API_VERSION_1_0 };
+
     std::vector<const char *> m_EnabledExtensions;
 
 #if defined(VKB_DEBUG) || defined(VKB_VALIDATION_LAYERS)
@@ -0,0 +1,356 @@
+#include "VulkanLightClusters.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanUtils.h"
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+// One workgroup per cluster. Every invocation tests a strided share of the lights, survivors are
+// gathered in shared memory and written out behind a single atomic per cluster.
+static const char *g_LightClusterShader = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct Light
+{
+    vec4 positionRange;
+    vec4 directionCosAngle;
+    vec4 colorIntensity;
+};
+
+struct ClusterBounds
+{
+    vec4 minimum;
+    vec4 maximum;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+
+layout(std430, set = 0, binding = 1) writeonly buffer Ranges
+{
+    uvec2 ranges[];
+};
+
+layout(std430, set = 0, binding = 2) writeonly buffer Indices
+{
+    uint lightIndices[];
+};
+
+layout(std430, set = 0, binding = 3) readonly buffer Bounds
+{
+    ClusterBounds bounds[];
+};
+
+layout(std430, set = 0, binding = 4) buffer Counter
+{
+    uint indexCount;
+};
+
+layout(push_constant) uniform ClusterConstants
+{
+    mat4 view;
+    uint lightCount;
+    uint maxLightIndices;
+} constants;
+
+shared uint clusterLights[MAX_LIGHTS_PER_CLUSTER];
+shared uint clusterCount;
+shared uint clusterOffset;
+
+void main()
+{
+    uint cluster = gl_WorkGroupID.x;
+    if (gl_LocalInvocationIndex == 0)
+    {
+        clusterCount = 0;
+    }
+    barrier();
+
+    vec3 minimum = bounds[cluster].minimum.xyz;
+    vec3 maximum = bounds[cluster].maximum.xyz;
+    vec3 center = (minimum + maximum) * 0.5;
+    float radius = length(maximum - minimum) * 0.5;
+
+    for (uint light = gl_LocalInvocationIndex; light < constants.lightCount; light += gl_WorkGroupSize.x)
+    {
+        vec3 position = (constants.view * vec4(lights[light].positionRange.xyz, 1.0)).xyz;
+        float range = lights[light].positionRange.w;
+
+        vec3 distance = max(max(minimum - position, position - maximum), vec3(0.0));
+        if (dot(distance, distance) > range * range)
+        {
+            continue;
+        }
+
+        float cosAngle = max(lights[light].directionCosAngle.w, -1.0);
+        if (cosAngle > -1.0)
+        {
+            vec3 axis = normalize(mat3(constants.view) * lights[light].directionCosAngle.xyz);
+            float sinAngle = sqrt(max(1.0 - cosAngle * cosAngle, 0.0));
+            vec3 toCenter = center - position;
+            float alongAxis = dot(toCenter, axis);
+            float fromAxis = sqrt(max(dot(toCenter, toCenter) - alongAxis * alongAxis, 0.0));
+            if (cosAngle * fromAxis - alongAxis * sinAngle > radius || alongAxis > radius + range || alongAxis < -radius)
+            {
+                continue;
+            }
+        }
+
+        uint slot = atomicAdd(clusterCount, 1);
+        if (slot < MAX_LIGHTS_PER_CLUSTER)
+        {
+            clusterLights[slot] = light;
+        }
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        uint count = min(clusterCount, MAX_LIGHTS_PER_CLUSTER);
+        uint offset = atomicAdd(indexCount, count);
+        count = offset < constants.maxLightIndices ? min(count, constants.maxLightIndices - offset) : 0;
+        offset = min(offset, constants.maxLightIndices);
+
+        ranges[cluster] = uvec2(offset, count);
+        clusterOffset = offset;
+        clusterCount = count;
+    }
+    barrier();
+
+    for (uint index = gl_LocalInvocationIndex; index < clusterCount; index += gl_WorkGroupSize.x)
+    {
+        lightIndices[clusterOffset + index] = clusterLights[index];
+    }
+}
+)";
+
+static constexpr uint32_t LightClusterBindingCount = 5;
+
+// Matches ClusterConstants.
+struct LightClusterConstants
+{
+    glm::mat4 view;
+
+    uint32_t lightCount;
+
+    uint32_t maxLightIndices;
+};
+
+static_assert(sizeof(LightClusterConstants) <= 128, "Light cluster push constants exceed the guaranteed minimum");
+
+VulkanLightClusters::VulkanLightClusters(VulkanDevice &device, const LightClusterGrid &grid, uint32_t maxLights, uint32_t framesInFlight) :
+    m_Device{ device },
+    m_Grid{ grid },
+    m_MaxLights{ maxLights }
+{
+    assert(maxLights > 0 && framesInFlight > 0);
+
+    uint32_t clusterCount = grid.GetClusterCount();
+
+    // Bounds start out empty, the compute path finds no lights until SetClusterBounds().
+    m_BoundsBuffer = std::make_unique<VulkanBuffer>(m_Device, clusterCount * sizeof(LightClusterBounds), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    std::vector<LightClusterBounds> emptyBounds(clusterCount, LightClusterBounds{ glm::vec3{ 0.0f }, 0.0f, glm::vec3{ 0.0f }, 0.0f });
+    m_BoundsBuffer->Update(emptyBounds.data(), emptyBounds.size() * sizeof(LightClusterBounds));
+
+    // Both paths write through mapped memory, there is no staging path yet.
+    m_Frames.resize(framesInFlight);
+    for (FrameBuffers &frame : m_Frames)
+    {
+        frame.lightBuffer = std::make_unique<VulkanBuffer>(m_Device, maxLights * sizeof(GpuLight), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+        frame.rangeBuffer = std::make_unique<VulkanBuffer>(m_Device, clusterCount * sizeof(LightClusterRange), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+        frame.indexBuffer = std::make_unique<VulkanBuffer>(m_Device, grid.maxLightIndices * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+        frame.counterBuffer = std::make_unique<VulkanBuffer>(m_Device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+
+    std::string shaderSource{ g_LightClusterShader };
+    m_Shader = std::make_unique<VulkanShader>(m_Device, ComputeShader, "main", std::vector<uint8_t>{ shaderSource.begin(), shaderSource.end() },
+        std::vector<std::string>{ "MAX_LIGHTS_PER_CLUSTER " + std::to_string(grid.maxLightsPerCluster) + "u" });
+
+    VkDescriptorSetLayoutBinding bindings[LightClusterBindingCount]{};
+    for (uint32_t binding = 0; binding < LightClusterBindingCount; ++binding)
+    {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    setLayoutInfo.bindingCount = LightClusterBindingCount;
+    setLayoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(m_Device.GetHandle(), &setLayoutInfo, nullptr, &m_DescriptorSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(LightClusterConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(m_Device.GetHandle(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = m_Shader->GetHandle();
+    pipelineInfo.stage.pName = m_Shader->GetEntryPoint().c_str();
+    pipelineInfo.layout = m_PipelineLayout;
+    VK_CHECK(vkCreateComputePipelines(m_Device.GetHandle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_Pipeline));
+
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, LightClusterBindingCount * framesInFlight };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = framesInFlight;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(m_Device.GetHandle(), &poolInfo, nullptr, &m_DescriptorPool));
+
+    for (FrameBuffers &frame : m_Frames)
+    {
+        VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocateInfo.descriptorPool = m_DescriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+        VK_CHECK(vkAllocateDescriptorSets(m_Device.GetHandle(), &allocateInfo, &frame.descriptorSet));
+
+        VkDescriptorBufferInfo bufferInfos[LightClusterBindingCount]{
+            { frame.lightBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { frame.rangeBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { frame.indexBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { m_BoundsBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { frame.counterBuffer->GetHandle(), 0, VK_WHOLE_SIZE } };
+
+        VkWriteDescriptorSet writes[LightClusterBindingCount]{};
+        for (uint32_t binding = 0; binding < LightClusterBindingCount; ++binding)
+        {
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = frame.descriptorSet;
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[binding].pBufferInfo = &bufferInfos[binding];
+        }
+        vkUpdateDescriptorSets(m_Device.GetHandle(), LightClusterBindingCount, writes, 0, nullptr);
+    }
+}
+
+VulkanLightClusters::~VulkanLightClusters()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    vkDestroyPipeline(device, m_Pipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+}
+
+void VulkanLightClusters::SetClusterBounds(const std::vector<LightClusterBounds> &bounds)
+{
+    assert(bounds.size() == m_Grid.GetClusterCount());
+    m_BoundsBuffer->Update(bounds.data(), bounds.size() * sizeof(LightClusterBounds));
+}
+
+uint32_t VulkanLightClusters::CopyLights(FrameBuffers &frame, const GpuLight *lights, uint32_t lightCount)
+{
+    if (lightCount > m_MaxLights)
+    {
+        LOGW("{} lights exceed the light cluster capacity of {}, the rest are ignored", lightCount, m_MaxLights);
+        lightCount = m_MaxLights;
+    }
+
+    if (lightCount > 0)
+    {
+        frame.lightBuffer->Update(lights, lightCount * sizeof(GpuLight));
+    }
+    return lightCount;
+}
+
+void VulkanLightClusters::Upload(uint32_t frame, const GpuLight *lights, uint32_t lightCount, const LightClusterBuilder &builder)
+{
+    assert(frame < m_Frames.size());
+    assert(builder.GetClusterRanges().size() == m_Grid.GetClusterCount());
+    assert(lightCount <= m_MaxLights && "The builder indexes lights the buffer cannot hold");
+
+    FrameBuffers &buffers = m_Frames[frame];
+    CopyLights(buffers, lights, lightCount);
+
+    const std::vector<LightClusterRange> &ranges = builder.GetClusterRanges();
+    buffers.rangeBuffer->Update(ranges.data(), ranges.size() * sizeof(LightClusterRange));
+
+    const std::vector<uint32_t> &indices = builder.GetLightIndices();
+    size_t indexCount = std::min<size_t>(indices.size(), m_Grid.maxLightIndices);
+    if (indexCount > 0)
+    {
+        buffers.indexBuffer->Update(indices.data(), indexCount * sizeof(uint32_t));
+    }
+}
+
+void VulkanLightClusters::Cull(VkCommandBuffer commandBuffer, uint32_t frame, const GpuLight *lights, uint32_t lightCount, const glm::mat4 &view)
+{
+    assert(frame < m_Frames.size());
+
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "LightClusters::Cull");
+
+    FrameBuffers &buffers = m_Frames[frame];
+
+    LightClusterConstants constants{};
+    constants.view = view;
+    constants.lightCount = CopyLights(buffers, lights, lightCount);
+    constants.maxLightIndices = m_Grid.maxLightIndices;
+
+    vkCmdFillBuffer(commandBuffer, buffers.counterBuffer->GetHandle(), 0, sizeof(uint32_t), 0);
+
+    VkBufferMemoryBarrier resetBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.buffer = buffers.counterBuffer->GetHandle();
+    resetBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &resetBarrier, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &buffers.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(commandBuffer, m_Grid.GetClusterCount(), 1, 1);
+
+    VkBufferMemoryBarrier clusterBarriers[2]{};
+    for (VkBufferMemoryBarrier &barrier : clusterBarriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.size = VK_WHOLE_SIZE;
+    }
+    clusterBarriers[0].buffer = buffers.rangeBuffer->GetHandle();
+    clusterBarriers[1].buffer = buffers.indexBuffer->GetHandle();
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 2, clusterBarriers, 0, nullptr);
+}
+
+const LightClusterGrid &VulkanLightClusters::GetGrid() const
+{
+    return m_Grid;
+}
+
+VkDescriptorSetLayout VulkanLightClusters::GetDescriptorSetLayout() const
+{
+    return m_DescriptorSetLayout;
+}
+
+VkDescriptorSet VulkanLightClusters::GetDescriptorSet(uint32_t frame) const
+{
+    assert(frame < m_Frames.size());
+    return m_Frames[frame].descriptorSet;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Render/LightClusters.h"
+#include "VulkanBuffer.h"
+#include "VulkanShader.h"
+#include <memory>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+// Per frame light cluster buffers for the shading passes. Filled either from a LightClusterBuilder
+// (Upload) or by the culling shader (Cull); both produce the same layout, bound as one set:
+//
+//     binding 0  GpuLight lights[]
+//     binding 1  uvec2 ranges[clusterCount]    offset and count into lightIndices
+//     binding 2  uint lightIndices[]
+//     binding 3  cluster bounds, compute path only
+//     binding 4  index counter, compute path only
+//
+// Light indices within a cluster come out in light order from the CPU and in any order from the GPU.
+class VulkanLightClusters : public NonCopyable
+{
+public:
+
+    VulkanLightClusters(VulkanDevice &device, const LightClusterGrid &grid, uint32_t maxLights, uint32_t framesInFlight);
+
+    ~VulkanLightClusters();
+
+    // Bounds from LightClusterBuilder::SetView() for the compute path. They are shared between frames,
+    // so this must happen while no frame is in flight.
+    void SetClusterBounds(const std::vector<LightClusterBounds> &bounds);
+
+    // Copies the lights and a finished CPU build into the buffers of frame.
+    void Upload(uint32_t frame, const GpuLight *lights, uint32_t lightCount, const LightClusterBuilder &builder);
+
+    // Copies the lights and records the culling dispatch for frame. Must be recorded outside a render pass.
+    void Cull(VkCommandBuffer commandBuffer, uint32_t frame, const GpuLight *lights, uint32_t lightCount, const glm::mat4 &view);
+
+    const LightClusterGrid &GetGrid() const;
+
+    VkDescriptorSetLayout GetDescriptorSetLayout() const;
+
+    VkDescriptorSet GetDescriptorSet(uint32_t frame) const;
+
+private:
+
+    struct FrameBuffers
+    {
+        std::unique_ptr<VulkanBuffer> lightBuffer;
+
+        std::unique_ptr<VulkanBuffer> rangeBuffer;
+
+        std::unique_ptr<VulkanBuffer> indexBuffer;
+
+        std::unique_ptr<VulkanBuffer> counterBuffer;
+
+        VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+    };
+
+    uint32_t CopyLights(FrameBuffers &frame, const GpuLight *lights, uint32_t lightCount);
+
+    VulkanDevice &m_Device;
+
+    LightClusterGrid m_Grid{};
+
+    uint32_t m_MaxLights{ 0 };
+
+    std::vector<FrameBuffers> m_Frames;
+
+    std::unique_ptr<VulkanBuffer> m_BoundsBuffer;
+
+    std::unique_ptr<VulkanShader> m_Shader;
+
+    VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+
+    VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+
+    VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+
+    VkPipeline m_Pipeline{ VK_NULL_HANDLE };
+};
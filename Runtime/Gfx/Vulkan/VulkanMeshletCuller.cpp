@@ -0,0 +1,318 @@
+#include "VulkanMeshletCuller.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanUtils.h"
+#include "Render/Meshlet.h"
+#include "Render/MeshletCuller.h"
+#include <cassert>
+
+static const char *g_MeshletCullShader = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct Meshlet
+{
+    vec4 boundingSphere;
+    vec4 coneApex;
+    vec4 coneAxisCutoff;
+    uint firstIndex;
+    uint indexCount;
+    uint padding0;
+    uint padding1;
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Meshlets
+{
+    Meshlet meshlets[];
+};
+
+layout(std430, set = 0, binding = 1) writeonly buffer DrawCommands
+{
+    DrawCommand drawCommands[];
+};
+
+layout(std430, set = 0, binding = 2) buffer DrawCount
+{
+    uint drawCount;
+};
+
+layout(push_constant) uniform CullConstants
+{
+    vec4 frustumPlanes[6];
+    // w is 1 when cone culling is enabled.
+    vec4 cameraPosition;
+    uint meshletCount;
+} constants;
+
+void main()
+{
+    uint meshletIndex = gl_GlobalInvocationID.x;
+    if (meshletIndex >= constants.meshletCount)
+    {
+        return;
+    }
+
+    Meshlet meshlet = meshlets[meshletIndex];
+
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        if (dot(constants.frustumPlanes[plane].xyz, meshlet.boundingSphere.xyz) + constants.frustumPlanes[plane].w < -meshlet.boundingSphere.w)
+        {
+            return;
+        }
+    }
+
+    float cutoff = meshlet.coneAxisCutoff.w;
+    if (constants.cameraPosition.w > 0.0 && cutoff <= 1.0)
+    {
+        vec3 direction = meshlet.coneApex.xyz - constants.cameraPosition.xyz;
+        float distance = length(direction);
+        if (distance > 0.0 && dot(direction / distance, meshlet.coneAxisCutoff.xyz) >= cutoff)
+        {
+            return;
+        }
+    }
+
+    uint drawIndex = atomicAdd(drawCount, 1);
+    drawCommands[drawIndex] = DrawCommand(meshlet.indexCount, 1, meshlet.firstIndex, 0, meshletIndex);
+}
+)";
+
+static constexpr uint32_t MeshletCullGroupSize = 64;
+
+// Matches CullConstants, 128 bytes is the smallest push constant size the spec guarantees.
+struct MeshletCullConstants
+{
+    glm::vec4 frustumPlanes[Frustum::PlaneCount];
+
+    glm::vec4 cameraPosition;
+
+    uint32_t meshletCount;
+
+    uint32_t padding[3];
+};
+
+static_assert(sizeof(MeshletCullConstants) <= 128, "Culling push constants exceed the guaranteed minimum");
+
+VulkanMeshletCuller::VulkanMeshletCuller(VulkanDevice &device, const MeshletData &meshletData) :
+    m_Device{ device },
+    m_MeshletCount{ static_cast<uint32_t>(meshletData.meshlets.size()) }
+{
+    assert(m_MeshletCount > 0);
+
+    // The culling shader stores the meshlet index in firstInstance.
+    if (!m_Device.IsDrawIndirectFirstInstanceEnabled())
+    {
+        LOGE("{} lacks drawIndirectFirstInstance, VulkanMeshletCuller can't draw on it", m_Device.GetGpu().GetProperties().deviceName);
+        abort();
+    }
+
+    m_DrawIndexedIndirectCount = m_Device.GetDrawIndexedIndirectCount();
+    if (m_DrawIndexedIndirectCount == nullptr)
+    {
+        LOGW("vkCmdDrawIndexedIndirectCount is unavailable, drawing every meshlet slot with vkCmdDrawIndexedIndirect.");
+    }
+
+    m_MultiDrawIndirect = m_Device.IsMultiDrawIndirectEnabled();
+
+    std::vector<GpuMeshlet> gpuMeshlets = meshletData.BuildGpuMeshlets();
+    std::vector<uint32_t> indices = meshletData.BuildIndexBuffer();
+
+    // Static data is written once through mapped memory, there is no staging path yet.
+    VkDeviceSize meshletSize = gpuMeshlets.size() * sizeof(GpuMeshlet);
+    m_MeshletBuffer = std::make_unique<VulkanBuffer>(m_Device, meshletSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_MeshletBuffer->Update(gpuMeshlets.data(), meshletSize);
+
+    VkDeviceSize indexSize = indices.size() * sizeof(uint32_t);
+    m_IndexBuffer = std::make_unique<VulkanBuffer>(m_Device, indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_IndexBuffer->Update(indices.data(), indexSize);
+
+    m_DrawBuffer = std::make_unique<VulkanBuffer>(m_Device, m_MeshletCount * sizeof(DrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    m_DrawCountBuffer = std::make_unique<VulkanBuffer>(m_Device, sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    std::string shaderSource{ g_MeshletCullShader };
+    m_Shader = std::make_unique<VulkanShader>(m_Device, ComputeShader, "main", std::vector<uint8_t>{ shaderSource.begin(), shaderSource.end() }, std::vector<std::string>{});
+
+    VkDescriptorSetLayoutBinding bindings[3]{};
+    for (uint32_t binding = 0; binding < 3; ++binding)
+    {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    setLayoutInfo.bindingCount = 3;
+    setLayoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(m_Device.GetHandle(), &setLayoutInfo, nullptr, &m_DescriptorSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(MeshletCullConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK(vkCreatePipelineLayout(m_Device.GetHandle(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = m_Shader->GetHandle();
+    pipelineInfo.stage.pName = m_Shader->GetEntryPoint().c_str();
+    pipelineInfo.layout = m_PipelineLayout;
+    VK_CHECK(vkCreateComputePipelines(m_Device.GetHandle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_Pipeline));
+
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(m_Device.GetHandle(), &poolInfo, nullptr, &m_DescriptorPool));
+
+    VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocateInfo.descriptorPool = m_DescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+    VK_CHECK(vkAllocateDescriptorSets(m_Device.GetHandle(), &allocateInfo, &m_DescriptorSet));
+
+    VkDescriptorBufferInfo bufferInfos[3]{
+        { m_MeshletBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+        { m_DrawBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+        { m_DrawCountBuffer->GetHandle(), 0, VK_WHOLE_SIZE } };
+
+    VkWriteDescriptorSet writes[3]{};
+    for (uint32_t binding = 0; binding < 3; ++binding)
+    {
+        writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[binding].dstSet = m_DescriptorSet;
+        writes[binding].dstBinding = binding;
+        writes[binding].descriptorCount = 1;
+        writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+    vkUpdateDescriptorSets(m_Device.GetHandle(), 3, writes, 0, nullptr);
+}
+
+VulkanMeshletCuller::~VulkanMeshletCuller()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    vkDestroyPipeline(device, m_Pipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+}
+
+void VulkanMeshletCuller::Cull(VkCommandBuffer commandBuffer, const MeshletCullParams &params)
+{
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "MeshletCuller::Cull");
+
+    // The draws of an earlier frame still in flight read the buffers this pass rewrites.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    VkBufferMemoryBarrier resetBarriers[2]{};
+    for (VkBufferMemoryBarrier &barrier : resetBarriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.size = VK_WHOLE_SIZE;
+    }
+    resetBarriers[0].buffer = m_DrawCountBuffer->GetHandle();
+    resetBarriers[1].buffer = m_DrawBuffer->GetHandle();
+
+    vkCmdFillBuffer(commandBuffer, m_DrawCountBuffer->GetHandle(), 0, sizeof(uint32_t), 0);
+    if (m_DrawIndexedIndirectCount == nullptr)
+    {
+        vkCmdFillBuffer(commandBuffer, m_DrawBuffer->GetHandle(), 0, VK_WHOLE_SIZE, 0);
+    }
+
+    uint32_t resetBarrierCount = m_DrawIndexedIndirectCount == nullptr ? 2 : 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, resetBarrierCount, resetBarriers, 0, nullptr);
+
+    MeshletCullConstants constants{};
+    for (uint32_t plane = 0; plane < Frustum::PlaneCount; ++plane)
+    {
+        constants.frustumPlanes[plane] = params.frustum.planes[plane];
+    }
+    constants.cameraPosition = glm::vec4{ params.cameraPosition, params.coneCulling ? 1.0f : 0.0f };
+    constants.meshletCount = m_MeshletCount;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(commandBuffer, (m_MeshletCount + MeshletCullGroupSize - 1) / MeshletCullGroupSize, 1, 1);
+
+    VkBufferMemoryBarrier drawBarriers[2]{};
+    for (VkBufferMemoryBarrier &barrier : drawBarriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.size = VK_WHOLE_SIZE;
+    }
+    drawBarriers[0].buffer = m_DrawBuffer->GetHandle();
+    drawBarriers[1].buffer = m_DrawCountBuffer->GetHandle();
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 2, drawBarriers, 0, nullptr);
+}
+
+void VulkanMeshletCuller::Draw(VkCommandBuffer commandBuffer)
+{
+    vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer->GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+
+    if (m_DrawIndexedIndirectCount != nullptr)
+    {
+        m_DrawIndexedIndirectCount(commandBuffer, m_DrawBuffer->GetHandle(), 0, m_DrawCountBuffer->GetHandle(), 0, m_MeshletCount, sizeof(DrawIndexedIndirectCommand));
+    }
+    else if (m_MultiDrawIndirect)
+    {
+        vkCmdDrawIndexedIndirect(commandBuffer, m_DrawBuffer->GetHandle(), 0, m_MeshletCount, sizeof(DrawIndexedIndirectCommand));
+    }
+    else
+    {
+        for (uint32_t draw = 0; draw < m_MeshletCount; ++draw)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, m_DrawBuffer->GetHandle(), draw * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+        }
+    }
+}
+
+uint32_t VulkanMeshletCuller::GetMeshletCount() const
+{
+    return m_MeshletCount;
+}
+
+const VulkanBuffer &VulkanMeshletCuller::GetDrawBuffer() const
+{
+    return *m_DrawBuffer;
+}
+
+const VulkanBuffer &VulkanMeshletCuller::GetDrawCountBuffer() const
+{
+    return *m_DrawCountBuffer;
+}
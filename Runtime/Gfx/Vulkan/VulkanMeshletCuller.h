@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "VulkanBuffer.h"
+#include "VulkanShader.h"
+#include <memory>
+#include <volk.h>
+
+class VulkanDevice;
+
+struct MeshletData;
+
+struct MeshletCullParams;
+
+// Culls the meshlets of one mesh on the GPU and draws the survivors with a single
+// vkCmdDrawIndexedIndirectCount. Mirrors MeshletCuller::Cull() on the CPU. Needs
+// drawIndirectFirstInstance; without a count draw every meshlet slot is drawn and culled ones have a
+// zero instance count.
+class VulkanMeshletCuller : public NonCopyable
+{
+public:
+
+    VulkanMeshletCuller(VulkanDevice &device, const MeshletData &meshletData);
+
+    ~VulkanMeshletCuller();
+
+    // Resets the draw count and dispatches the culling shader. Must be recorded outside a render pass.
+    void Cull(VkCommandBuffer commandBuffer, const MeshletCullParams &params);
+
+    // Binds the meshlet index buffer and issues the indirect draw. The caller binds the pipeline and
+    // the vertex buffers of the mesh; firstInstance of every draw is the meshlet index.
+    void Draw(VkCommandBuffer commandBuffer);
+
+    uint32_t GetMeshletCount() const;
+
+    const VulkanBuffer &GetDrawBuffer() const;
+
+    const VulkanBuffer &GetDrawCountBuffer() const;
+
+private:
+
+    VulkanDevice &m_Device;
+
+    uint32_t m_MeshletCount{ 0 };
+
+    PFN_vkCmdDrawIndexedIndirectCount m_DrawIndexedIndirectCount{ nullptr };
+
+    bool m_MultiDrawIndirect{ false };
+
+    std::unique_ptr<VulkanBuffer> m_MeshletBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_IndexBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_DrawBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_DrawCountBuffer;
+
+    std::unique_ptr<VulkanShader> m_Shader;
+
+    VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+
+    VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+
+    VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+
+    VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+
+    VkPipeline m_Pipeline{ VK_NULL_HANDLE };
+};
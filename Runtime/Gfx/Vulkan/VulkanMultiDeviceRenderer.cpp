@@ -0,0 +1,104 @@
+#include "VulkanMultiDeviceRenderer.h"
+#include "VulkanDevice.h"
+#include "VulkanInstance.h"
+#include "Common/Logging.h"
+#include <cassert>
+
+VulkanMultiDeviceRenderer::VulkanMultiDeviceRenderer(VulkanInstance &instance, const MultiDeviceRendererDesc &desc)
+{
+    std::vector<VulkanPhysicalDevice *> gpus = instance.GetGpusByScore(desc.includeCpuDevices);
+    if (desc.maxDevices > 0 && gpus.size() > desc.maxDevices)
+    {
+        gpus.resize(desc.maxDevices);
+    }
+    assert(!gpus.empty() && "No GPU can run the renderer.");
+    assert(desc.devicesPerGpu > 0);
+
+    for (VulkanPhysicalDevice *gpu : gpus)
+    {
+        for (uint32_t copy = 0; copy < desc.devicesPerGpu; ++copy)
+        {
+            m_Devices.push_back(std::make_unique<VulkanDevice>(*gpu, VK_NULL_HANDLE));
+            m_Renderers.push_back(std::make_unique<VulkanOffscreenRenderer>(*m_Devices.back(), desc.offscreen));
+        }
+    }
+
+    LOGI("Offscreen rendering on {} devices", m_Devices.size());
+}
+
+VulkanMultiDeviceRenderer::~VulkanMultiDeviceRenderer()
+{
+    for (const std::unique_ptr<VulkanDevice> &device : m_Devices)
+    {
+        device->WaitIdle();
+    }
+
+    m_Renderers.clear();
+    m_Devices.clear();
+}
+
+uint32_t VulkanMultiDeviceRenderer::GetDeviceCount() const
+{
+    return static_cast<uint32_t>(m_Devices.size());
+}
+
+VulkanDevice &VulkanMultiDeviceRenderer::GetDevice(uint32_t deviceIndex) const
+{
+    assert(deviceIndex < m_Devices.size());
+    return *m_Devices[deviceIndex];
+}
+
+VulkanOffscreenRenderer &VulkanMultiDeviceRenderer::GetRenderer(uint32_t deviceIndex) const
+{
+    assert(deviceIndex < m_Renderers.size());
+    return *m_Renderers[deviceIndex];
+}
+
+uint32_t VulkanMultiDeviceRenderer::ChooseDevice()
+{
+    PollReadbacks();
+
+    uint32_t chosen = 0;
+    for (uint32_t index = 1; index < m_Renderers.size(); ++index)
+    {
+        if (m_Renderers[index]->GetPendingCount() < m_Renderers[chosen]->GetPendingCount())
+        {
+            chosen = index;
+        }
+    }
+    return chosen;
+}
+
+uint64_t VulkanMultiDeviceRenderer::Submit(uint32_t deviceIndex, const OffscreenRenderJob &job)
+{
+    return GetRenderer(deviceIndex).Submit(job);
+}
+
+uint32_t VulkanMultiDeviceRenderer::PollReadbacks()
+{
+    uint32_t delivered = 0;
+    for (const std::unique_ptr<VulkanOffscreenRenderer> &renderer : m_Renderers)
+    {
+        delivered += renderer->PollReadbacks();
+    }
+    return delivered;
+}
+
+void VulkanMultiDeviceRenderer::Flush()
+{
+    for (const std::unique_ptr<VulkanOffscreenRenderer> &renderer : m_Renderers)
+    {
+        renderer->Flush();
+    }
+}
+
+void VulkanMultiDeviceRenderer::RenderBatch(uint32_t jobCount, const std::function<OffscreenRenderJob(uint32_t jobIndex, uint32_t deviceIndex)> &buildJob)
+{
+    for (uint32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+    {
+        uint32_t deviceIndex = ChooseDevice();
+        Submit(deviceIndex, buildJob(jobIndex, deviceIndex));
+    }
+
+    Flush();
+}
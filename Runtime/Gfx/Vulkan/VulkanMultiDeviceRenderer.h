@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "VulkanOffscreenRenderer.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+class VulkanInstance;
+
+class VulkanDevice;
+
+struct MultiDeviceRendererDesc
+{
+    // Devices created from the best scoring GPUs, 0 for every usable one.
+    uint32_t maxDevices{ 0 };
+
+    // Software rasterizers are slower than any GPU and would only hold back a batch, unless they are
+    // all there is or are asked for, as in tests on CPU-only machines.
+    bool includeCpuDevices{ false };
+
+    // Logical devices per GPU. Above 1 only to exercise the multi device path on a single GPU.
+    uint32_t devicesPerGpu{ 1 };
+
+    OffscreenRendererDesc offscreen{};
+};
+
+// Spreads independent offscreen renders over one VulkanDevice per GPU. Pipelines, buffers and other
+// objects belong to a single device, so jobs are built for the device they are given to; there is no
+// sharing or synchronisation between devices. Results come in submission order per device only.
+class VulkanMultiDeviceRenderer : public NonCopyable
+{
+public:
+
+    VulkanMultiDeviceRenderer(VulkanInstance &instance, const MultiDeviceRendererDesc &desc = {});
+
+    ~VulkanMultiDeviceRenderer();
+
+    uint32_t GetDeviceCount() const;
+
+    VulkanDevice &GetDevice(uint32_t deviceIndex) const;
+
+    VulkanOffscreenRenderer &GetRenderer(uint32_t deviceIndex) const;
+
+    // Delivers finished renders, then picks the device with the fewest renders in flight, the better
+    // GPU on a tie. Faster devices drain sooner and so take a bigger share.
+    uint32_t ChooseDevice();
+
+    // Ticket of the device's renderer, as in its readbacks.
+    uint64_t Submit(uint32_t deviceIndex, const OffscreenRenderJob &job);
+
+    uint32_t PollReadbacks();
+
+    void Flush();
+
+    // Builds and submits jobCount jobs on the chosen devices, then waits for all of them.
+    void RenderBatch(uint32_t jobCount, const std::function<OffscreenRenderJob(uint32_t jobIndex, uint32_t deviceIndex)> &buildJob);
+
+private:
+
+    // Best GPU first.
+    std::vector<std::unique_ptr<VulkanDevice>> m_Devices;
+
+    std::vector<std::unique_ptr<VulkanOffscreenRenderer>> m_Renderers;
+};
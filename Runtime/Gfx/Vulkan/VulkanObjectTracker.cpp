@@ -0,0 +1,267 @@
+#include "VulkanObjectTracker.h"
+#include <atomic>
+
+static constexpr uint32_t g_ObjectTypeCount = static_cast<uint32_t>(VulkanObjectType::Count);
+
+static std::atomic<bool> g_TrackerEnabled{ false };
+
+static std::atomic<uint64_t> g_LiveObjects[g_ObjectTypeCount];
+
+static std::atomic<uint64_t> g_CreatedObjects[g_ObjectTypeCount];
+
+static void OnCreated(VulkanObjectType type)
+{
+    g_LiveObjects[static_cast<uint32_t>(type)].fetch_add(1, std::memory_order_relaxed);
+    g_CreatedObjects[static_cast<uint32_t>(type)].fetch_add(1, std::memory_order_relaxed);
+}
+
+static void OnDestroyed(VulkanObjectType type)
+{
+    g_LiveObjects[static_cast<uint32_t>(type)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Every object whose entry points follow vkCreateX(device, VkXCreateInfo *, allocator, VkX *) and
+// vkDestroyX(device, VkX, allocator).
+#define TRACKED_OBJECT(Type)                                                                                                         \
+    static PFN_vkCreate##Type g_Create##Type = nullptr;                                                                              \
+    static PFN_vkDestroy##Type g_Destroy##Type = nullptr;                                                                            \
+    static VKAPI_ATTR VkResult VKAPI_CALL TrackedCreate##Type(VkDevice device, const Vk##Type##CreateInfo *createInfo,               \
+        const VkAllocationCallbacks *allocator, Vk##Type *object)                                                                    \
+    {                                                                                                                                \
+        VkResult result = g_Create##Type(device, createInfo, allocator, object);                                                     \
+        if (result == VK_SUCCESS)                                                                                                    \
+        {                                                                                                                            \
+            OnCreated(VulkanObjectType::Type);                                                                                       \
+        }                                                                                                                            \
+        return result;                                                                                                               \
+    }                                                                                                                                \
+    static VKAPI_ATTR void VKAPI_CALL TrackedDestroy##Type(VkDevice device, Vk##Type object, const VkAllocationCallbacks *allocator) \
+    {                                                                                                                                \
+        if (object != VK_NULL_HANDLE)                                                                                                \
+        {                                                                                                                            \
+            OnDestroyed(VulkanObjectType::Type);                                                                                     \
+        }                                                                                                                            \
+        g_Destroy##Type(device, object, allocator);                                                                                  \
+    }
+
+TRACKED_OBJECT(Buffer)
+TRACKED_OBJECT(Image)
+TRACKED_OBJECT(ImageView)
+TRACKED_OBJECT(Sampler)
+TRACKED_OBJECT(ShaderModule)
+TRACKED_OBJECT(PipelineLayout)
+TRACKED_OBJECT(DescriptorSetLayout)
+TRACKED_OBJECT(DescriptorPool)
+TRACKED_OBJECT(RenderPass)
+TRACKED_OBJECT(Framebuffer)
+TRACKED_OBJECT(CommandPool)
+TRACKED_OBJECT(Fence)
+TRACKED_OBJECT(Semaphore)
+TRACKED_OBJECT(QueryPool)
+
+#undef TRACKED_OBJECT
+
+static PFN_vkCreateGraphicsPipelines g_CreateGraphicsPipelines = nullptr;
+
+static PFN_vkCreateComputePipelines g_CreateComputePipelines = nullptr;
+
+static PFN_vkDestroyPipeline g_DestroyPipeline = nullptr;
+
+static PFN_vkAllocateMemory g_AllocateMemory = nullptr;
+
+static PFN_vkFreeMemory g_FreeMemory = nullptr;
+
+// A failed batch may still have created some of the pipelines, the others come back as VK_NULL_HANDLE.
+static void OnPipelinesCreated(uint32_t count, const VkPipeline *pipelines)
+{
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        if (pipelines[index] != VK_NULL_HANDLE)
+        {
+            OnCreated(VulkanObjectType::Pipeline);
+        }
+    }
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL TrackedCreateGraphicsPipelines(VkDevice device, VkPipelineCache cache, uint32_t count,
+    const VkGraphicsPipelineCreateInfo *createInfos, const VkAllocationCallbacks *allocator, VkPipeline *pipelines)
+{
+    VkResult result = g_CreateGraphicsPipelines(device, cache, count, createInfos, allocator, pipelines);
+    OnPipelinesCreated(count, pipelines);
+    return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL TrackedCreateComputePipelines(VkDevice device, VkPipelineCache cache, uint32_t count,
+    const VkComputePipelineCreateInfo *createInfos, const VkAllocationCallbacks *allocator, VkPipeline *pipelines)
+{
+    VkResult result = g_CreateComputePipelines(device, cache, count, createInfos, allocator, pipelines);
+    OnPipelinesCreated(count, pipelines);
+    return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL TrackedDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *allocator)
+{
+    if (pipeline != VK_NULL_HANDLE)
+    {
+        OnDestroyed(VulkanObjectType::Pipeline);
+    }
+    g_DestroyPipeline(device, pipeline, allocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL TrackedAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *allocateInfo, const VkAllocationCallbacks *allocator,
+    VkDeviceMemory *memory)
+{
+    VkResult result = g_AllocateMemory(device, allocateInfo, allocator, memory);
+    if (result == VK_SUCCESS)
+    {
+        OnCreated(VulkanObjectType::DeviceMemory);
+    }
+    return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL TrackedFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *allocator)
+{
+    if (memory != VK_NULL_HANDLE)
+    {
+        OnDestroyed(VulkanObjectType::DeviceMemory);
+    }
+    g_FreeMemory(device, memory, allocator);
+}
+
+uint64_t VulkanObjectCounts::GetLiveTotal() const
+{
+    uint64_t total = 0;
+    for (uint64_t count : live)
+    {
+        total += count;
+    }
+    return total;
+}
+
+uint64_t VulkanObjectCounts::GetCreatedTotal() const
+{
+    uint64_t total = 0;
+    for (uint64_t count : created)
+    {
+        total += count;
+    }
+    return total;
+}
+
+namespace VulkanObjectTracker
+{
+    void SetEnabled(bool enabled)
+    {
+        g_TrackerEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled()
+    {
+        return g_TrackerEnabled.load(std::memory_order_relaxed);
+    }
+
+    void Install()
+    {
+        if (!IsEnabled())
+        {
+            return;
+        }
+
+        // volkLoadInstance() of another instance reloads the pointers, which is why the check is
+        // per entry point rather than a flag.
+#define INSTALL_WRAPPER(Function)              \
+        if (vk##Function != Tracked##Function) \
+        {                                      \
+            g_##Function = vk##Function;       \
+            vk##Function = Tracked##Function;  \
+        }
+
+        INSTALL_WRAPPER(CreateBuffer)
+        INSTALL_WRAPPER(DestroyBuffer)
+        INSTALL_WRAPPER(CreateImage)
+        INSTALL_WRAPPER(DestroyImage)
+        INSTALL_WRAPPER(CreateImageView)
+        INSTALL_WRAPPER(DestroyImageView)
+        INSTALL_WRAPPER(CreateSampler)
+        INSTALL_WRAPPER(DestroySampler)
+        INSTALL_WRAPPER(CreateShaderModule)
+        INSTALL_WRAPPER(DestroyShaderModule)
+        INSTALL_WRAPPER(CreateGraphicsPipelines)
+        INSTALL_WRAPPER(CreateComputePipelines)
+        INSTALL_WRAPPER(DestroyPipeline)
+        INSTALL_WRAPPER(CreatePipelineLayout)
+        INSTALL_WRAPPER(DestroyPipelineLayout)
+        INSTALL_WRAPPER(CreateDescriptorSetLayout)
+        INSTALL_WRAPPER(DestroyDescriptorSetLayout)
+        INSTALL_WRAPPER(CreateDescriptorPool)
+        INSTALL_WRAPPER(DestroyDescriptorPool)
+        INSTALL_WRAPPER(CreateRenderPass)
+        INSTALL_WRAPPER(DestroyRenderPass)
+        INSTALL_WRAPPER(CreateFramebuffer)
+        INSTALL_WRAPPER(DestroyFramebuffer)
+        INSTALL_WRAPPER(CreateCommandPool)
+        INSTALL_WRAPPER(DestroyCommandPool)
+        INSTALL_WRAPPER(CreateFence)
+        INSTALL_WRAPPER(DestroyFence)
+        INSTALL_WRAPPER(CreateSemaphore)
+        INSTALL_WRAPPER(DestroySemaphore)
+        INSTALL_WRAPPER(CreateQueryPool)
+        INSTALL_WRAPPER(DestroyQueryPool)
+        INSTALL_WRAPPER(AllocateMemory)
+        INSTALL_WRAPPER(FreeMemory)
+
+#undef INSTALL_WRAPPER
+    }
+
+    VulkanObjectCounts GetCounts()
+    {
+        VulkanObjectCounts counts{};
+        for (uint32_t type = 0; type < g_ObjectTypeCount; ++type)
+        {
+            counts.live[type] = g_LiveObjects[type].load(std::memory_order_relaxed);
+            counts.created[type] = g_CreatedObjects[type].load(std::memory_order_relaxed);
+        }
+        return counts;
+    }
+
+    const char *GetTypeName(VulkanObjectType type)
+    {
+        switch (type)
+        {
+        case VulkanObjectType::Buffer:
+            return "buffer";
+        case VulkanObjectType::Image:
+            return "image";
+        case VulkanObjectType::ImageView:
+            return "imageView";
+        case VulkanObjectType::Sampler:
+            return "sampler";
+        case VulkanObjectType::ShaderModule:
+            return "shaderModule";
+        case VulkanObjectType::Pipeline:
+            return "pipeline";
+        case VulkanObjectType::PipelineLayout:
+            return "pipelineLayout";
+        case VulkanObjectType::DescriptorSetLayout:
+            return "descriptorSetLayout";
+        case VulkanObjectType::DescriptorPool:
+            return "descriptorPool";
+        case VulkanObjectType::RenderPass:
+            return "renderPass";
+        case VulkanObjectType::Framebuffer:
+            return "framebuffer";
+        case VulkanObjectType::CommandPool:
+            return "commandPool";
+        case VulkanObjectType::Fence:
+            return "fence";
+        case VulkanObjectType::Semaphore:
+            return "semaphore";
+        case VulkanObjectType::QueryPool:
+            return "queryPool";
+        case VulkanObjectType::DeviceMemory:
+            return "deviceMemory";
+        default:
+            return "unknown";
+        }
+    }
+}
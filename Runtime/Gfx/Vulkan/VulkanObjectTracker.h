@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <volk.h>
+
+enum class VulkanObjectType : uint32_t
+{
+    Buffer,
+
+    Image,
+
+    ImageView,
+
+    Sampler,
+
+    ShaderModule,
+
+    Pipeline,
+
+    PipelineLayout,
+
+    DescriptorSetLayout,
+
+    DescriptorPool,
+
+    RenderPass,
+
+    Framebuffer,
+
+    CommandPool,
+
+    Fence,
+
+    Semaphore,
+
+    QueryPool,
+
+    DeviceMemory,
+
+    Count,
+};
+
+struct VulkanObjectCounts
+{
+    // Objects alive right now.
+    uint64_t live[static_cast<uint32_t>(VulkanObjectType::Count)]{};
+
+    // Objects created since tracking was enabled, live or not.
+    uint64_t created[static_cast<uint32_t>(VulkanObjectType::Count)]{};
+
+    uint64_t GetLiveTotal() const;
+
+    uint64_t GetCreatedTotal() const;
+};
+
+// Counts device objects by wrapping volk's global create and destroy entry points, which also covers
+// the memory VMA allocates. Meant for leak and churn checks in tests, the wrappers cost an atomic
+// increment per call.
+namespace VulkanObjectTracker
+{
+    // Has to happen before the device is created, VulkanDevice installs the wrappers when enabled.
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled();
+
+    // Wraps the entry points loaded by volk. Does nothing unless enabled, and nothing twice.
+    void Install();
+
+    VulkanObjectCounts GetCounts();
+
+    const char *GetTypeName(VulkanObjectType type);
+}
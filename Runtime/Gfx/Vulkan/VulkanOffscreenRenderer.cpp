@@ -0,0 +1,377 @@
+#include "VulkanOffscreenRenderer.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanQueue.h"
+#include "VulkanUtils.h"
+#include <cassert>
+#include <cstdint>
+
+static uint32_t GetTexelSize(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        return 4;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return 8;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        return 16;
+    default:
+        LOGE("Unsupported offscreen color format {}", format);
+        abort();
+    }
+}
+
+VulkanOffscreenRenderer::VulkanOffscreenRenderer(VulkanDevice &device, const OffscreenRendererDesc &desc) :
+    m_Device{ device },
+    m_Queue{ device.GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT) },
+    m_Desc{ desc },
+    m_TexelSize{ GetTexelSize(desc.colorFormat) }
+{
+    assert(desc.slotCount > 0);
+
+    VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = m_Queue.GetFamilyIndex();
+    VK_CHECK(vkCreateCommandPool(m_Device.GetHandle(), &poolInfo, nullptr, &m_CommandPool));
+
+    CreateRenderPass();
+
+    m_Slots.resize(desc.slotCount);
+
+    std::vector<VkCommandBuffer> commandBuffers(desc.slotCount);
+
+    VkCommandBufferAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocateInfo.commandPool = m_CommandPool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = desc.slotCount;
+    VK_CHECK(vkAllocateCommandBuffers(m_Device.GetHandle(), &allocateInfo, commandBuffers.data()));
+
+    for (uint32_t index = 0; index < desc.slotCount; ++index)
+    {
+        m_Slots[index].commandBuffer = commandBuffers[index];
+
+        VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        VK_CHECK(vkCreateFence(m_Device.GetHandle(), &fenceInfo, nullptr, &m_Slots[index].fence));
+    }
+}
+
+VulkanOffscreenRenderer::~VulkanOffscreenRenderer()
+{
+    Flush();
+
+    VkDevice device = m_Device.GetHandle();
+
+    for (Slot &slot : m_Slots)
+    {
+        if (slot.framebuffer != VK_NULL_HANDLE)
+        {
+            vkDestroyFramebuffer(device, slot.framebuffer, nullptr);
+        }
+        vkDestroyFence(device, slot.fence, nullptr);
+    }
+    m_Slots.clear();
+
+    vkDestroyRenderPass(device, m_RenderPass, nullptr);
+    vkDestroyCommandPool(device, m_CommandPool, nullptr);
+}
+
+void VulkanOffscreenRenderer::CreateRenderPass()
+{
+    VkAttachmentDescription attachments[2]{};
+
+    attachments[0].format = m_Desc.colorFormat;
+    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    attachments[1].format = m_Desc.depthFormat;
+    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorReference{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    VkAttachmentReference depthReference{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorReference;
+    subpass.pDepthStencilAttachment = &depthReference;
+
+    VkSubpassDependency dependencies[2]{};
+
+    // The previous use of the slot read the color image with a copy.
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+    renderPassInfo.attachmentCount = 2;
+    renderPassInfo.pAttachments = attachments;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = dependencies;
+
+    VK_CHECK(vkCreateRenderPass(m_Device.GetHandle(), &renderPassInfo, nullptr, &m_RenderPass));
+}
+
+void VulkanOffscreenRenderer::PrepareTargets(Slot &slot, uint32_t width, uint32_t height)
+{
+    if (slot.colorImage != nullptr && slot.colorImage->GetExtent().width == width && slot.colorImage->GetExtent().height == height)
+    {
+        return;
+    }
+
+    if (slot.framebuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyFramebuffer(m_Device.GetHandle(), slot.framebuffer, nullptr);
+        slot.framebuffer = VK_NULL_HANDLE;
+    }
+
+    VkExtent2D extent{ width, height };
+    slot.colorImage = std::make_unique<VulkanImage>(m_Device, extent, m_Desc.colorFormat,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+    slot.depthImage = std::make_unique<VulkanImage>(m_Device, extent, m_Desc.depthFormat,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    VkImageView views[2]{ slot.colorImage->GetView(), slot.depthImage->GetView() };
+
+    VkFramebufferCreateInfo framebufferInfo{ VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+    framebufferInfo.renderPass = m_RenderPass;
+    framebufferInfo.attachmentCount = 2;
+    framebufferInfo.pAttachments = views;
+    framebufferInfo.width = width;
+    framebufferInfo.height = height;
+    framebufferInfo.layers = 1;
+    VK_CHECK(vkCreateFramebuffer(m_Device.GetHandle(), &framebufferInfo, nullptr, &slot.framebuffer));
+
+    // Keep the larger buffer around, thumbnails of mixed sizes would otherwise reallocate constantly.
+    VkDeviceSize readbackSize = static_cast<VkDeviceSize>(width) * height * m_TexelSize;
+    if (slot.readbackBuffer == nullptr || slot.readbackBuffer->GetSize() < readbackSize)
+    {
+        slot.readbackBuffer = std::make_unique<VulkanBuffer>(m_Device, readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+    }
+}
+
+uint64_t VulkanOffscreenRenderer::Submit(const OffscreenRenderJob &job)
+{
+    assert(job.width > 0 && job.height > 0);
+
+    Slot &slot = m_Slots[m_NextSlot];
+    if (slot.pending)
+    {
+        VK_CHECK(vkWaitForFences(m_Device.GetHandle(), 1, &slot.fence, VK_TRUE, UINT64_MAX));
+        Deliver(slot);
+    }
+
+    PrepareTargets(slot, job.width, job.height);
+
+    VK_CHECK(vkResetFences(m_Device.GetHandle(), 1, &slot.fence));
+    VK_CHECK(vkResetCommandBuffer(slot.commandBuffer, 0));
+
+    VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(slot.commandBuffer, &beginInfo));
+
+    // Tickets cycle through the slots the same way the profiler's frames do, and this slot's fence has
+    // signalled, so its queries are free to reuse.
+    VulkanGpuProfiler *profiler = m_Device.GetGpuProfiler();
+    if (profiler != nullptr)
+    {
+        profiler->BeginFrame(slot.commandBuffer, m_NextTicket - 1);
+    }
+
+    if (job.prepare)
+    {
+        job.prepare(slot.commandBuffer);
+    }
+
+    VkClearValue clearValues[2]{};
+    clearValues[0].color = job.clearColor;
+    clearValues[1].depthStencil = { 1.0f, 0 };
+
+    VkRenderPassBeginInfo renderPassBegin{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+    renderPassBegin.renderPass = m_RenderPass;
+    renderPassBegin.framebuffer = slot.framebuffer;
+    renderPassBegin.renderArea.extent = { job.width, job.height };
+    renderPassBegin.clearValueCount = 2;
+    renderPassBegin.pClearValues = clearValues;
+
+    uint32_t passZone = profiler != nullptr ? profiler->BeginZone(slot.commandBuffer, "OffscreenPass", true) : VulkanGpuProfiler::InvalidZone;
+    vkCmdBeginRenderPass(slot.commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{ 0.0f, 0.0f, static_cast<float>(job.width), static_cast<float>(job.height), 0.0f, 1.0f };
+    VkRect2D scissor{ { 0, 0 }, { job.width, job.height } };
+    vkCmdSetViewport(slot.commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(slot.commandBuffer, 0, 1, &scissor);
+
+    if (job.record)
+    {
+        job.record(slot.commandBuffer);
+    }
+
+    vkCmdEndRenderPass(slot.commandBuffer);
+    if (profiler != nullptr)
+    {
+        profiler->EndZone(slot.commandBuffer, passZone);
+    }
+
+    uint32_t readbackZone = profiler != nullptr ? profiler->BeginZone(slot.commandBuffer, "Readback") : VulkanGpuProfiler::InvalidZone;
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = { job.width, job.height, 1 };
+    vkCmdCopyImageToBuffer(slot.commandBuffer, slot.colorImage->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.readbackBuffer->GetHandle(), 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = slot.readbackBuffer->GetHandle();
+    hostBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    if (profiler != nullptr)
+    {
+        profiler->EndZone(slot.commandBuffer, readbackZone);
+        profiler->EndFrame(slot.commandBuffer);
+    }
+
+    VK_CHECK(vkEndCommandBuffer(slot.commandBuffer));
+
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+    VK_CHECK(vkQueueSubmit(m_Queue.GetHandle(), 1, &submitInfo, slot.fence));
+
+    slot.pending = true;
+    ++m_PendingCount;
+    slot.ticket = m_NextTicket++;
+    slot.onReadback = job.onReadback;
+
+    m_NextSlot = (m_NextSlot + 1) % static_cast<uint32_t>(m_Slots.size());
+
+    return slot.ticket;
+}
+
+uint32_t VulkanOffscreenRenderer::PollReadbacks()
+{
+    uint32_t slotCount = static_cast<uint32_t>(m_Slots.size());
+    uint32_t delivered = 0;
+
+    // Oldest first, stopping at the first unfinished render keeps results in submission order.
+    for (uint32_t offset = 0; offset < slotCount; ++offset)
+    {
+        Slot &slot = m_Slots[(m_NextSlot + offset) % slotCount];
+        if (!slot.pending)
+        {
+            continue;
+        }
+
+        VkResult status = vkGetFenceStatus(m_Device.GetHandle(), slot.fence);
+        if (status == VK_NOT_READY)
+        {
+            break;
+        }
+        VK_CHECK(status);
+
+        Deliver(slot);
+        ++delivered;
+    }
+
+    return delivered;
+}
+
+void VulkanOffscreenRenderer::Flush()
+{
+    uint32_t slotCount = static_cast<uint32_t>(m_Slots.size());
+
+    for (uint32_t offset = 0; offset < slotCount; ++offset)
+    {
+        Slot &slot = m_Slots[(m_NextSlot + offset) % slotCount];
+        if (!slot.pending)
+        {
+            continue;
+        }
+
+        VK_CHECK(vkWaitForFences(m_Device.GetHandle(), 1, &slot.fence, VK_TRUE, UINT64_MAX));
+        Deliver(slot);
+    }
+}
+
+void VulkanOffscreenRenderer::RenderBatch(const std::vector<OffscreenRenderJob> &jobs)
+{
+    for (const OffscreenRenderJob &job : jobs)
+    {
+        Submit(job);
+        PollReadbacks();
+    }
+
+    Flush();
+}
+
+uint32_t VulkanOffscreenRenderer::GetPendingCount() const
+{
+    return m_PendingCount;
+}
+
+VkRenderPass VulkanOffscreenRenderer::GetRenderPass() const
+{
+    return m_RenderPass;
+}
+
+const OffscreenRendererDesc &VulkanOffscreenRenderer::GetDesc() const
+{
+    return m_Desc;
+}
+
+void VulkanOffscreenRenderer::Deliver(Slot &slot)
+{
+    slot.pending = false;
+    --m_PendingCount;
+
+    if (!slot.onReadback)
+    {
+        return;
+    }
+
+    VkExtent2D extent = slot.colorImage->GetExtent();
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * m_TexelSize;
+    slot.readbackBuffer->Invalidate(0, size);
+
+    OffscreenReadback readback{};
+    readback.ticket = slot.ticket;
+    readback.width = extent.width;
+    readback.height = extent.height;
+    readback.rowPitch = extent.width * m_TexelSize;
+    readback.pixels = slot.readbackBuffer->GetMappedData();
+
+    slot.onReadback(readback);
+    slot.onReadback = nullptr;
+}
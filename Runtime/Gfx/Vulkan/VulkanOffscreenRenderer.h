@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class VulkanQueue;
+
+struct OffscreenRendererDesc
+{
+    // Renders in flight at once, each owns its targets and readback buffer.
+    uint32_t slotCount{ 3 };
+
+    VkFormat colorFormat{ VK_FORMAT_R8G8B8A8_UNORM };
+
+    VkFormat depthFormat{ VK_FORMAT_D32_SFLOAT };
+};
+
+// Pixels of a finished render. Only valid for the duration of the readback callback.
+struct OffscreenReadback
+{
+    uint64_t ticket{ 0 };
+
+    uint32_t width{ 0 };
+
+    uint32_t height{ 0 };
+
+    // Rows are tightly packed, rowPitch = width * texel size.
+    uint32_t rowPitch{ 0 };
+
+    const uint8_t *pixels{ nullptr };
+};
+
+struct OffscreenRenderJob
+{
+    uint32_t width{ 0 };
+
+    uint32_t height{ 0 };
+
+    VkClearColorValue clearColor{};
+
+    // Optional, records work that has to happen before the render pass, such as culling dispatches.
+    std::function<void(VkCommandBuffer commandBuffer)> prepare;
+
+    // Records the draws, called inside GetRenderPass() with the viewport and scissor set to the job
+    // size. Pipelines must use dynamic viewport and scissor state.
+    std::function<void(VkCommandBuffer commandBuffer)> record;
+
+    // Must not submit to the renderer, copy the pixels out and hand them to another thread instead.
+    std::function<void(const OffscreenReadback &readback)> onReadback;
+};
+
+// Renders into offscreen images without a surface and copies them into persistently mapped host
+// buffers. Submit() returns once the work is queued; results are handed out by PollReadbacks() or
+// Flush() in submission order, so recording the next job overlaps with the GPU rendering and
+// copying the previous ones.
+class VulkanOffscreenRenderer : public NonCopyable
+{
+public:
+
+    VulkanOffscreenRenderer(VulkanDevice &device, const OffscreenRendererDesc &desc = {});
+
+    ~VulkanOffscreenRenderer();
+
+    // Blocks only when every slot is still in flight, delivering the oldest result to free one.
+    uint64_t Submit(const OffscreenRenderJob &job);
+
+    // Delivers the finished renders without waiting. Returns how many were delivered.
+    uint32_t PollReadbacks();
+
+    // Waits for and delivers every render in flight.
+    void Flush();
+
+    // Submits all jobs and waits for their results.
+    void RenderBatch(const std::vector<OffscreenRenderJob> &jobs);
+
+    // Submitted renders not delivered yet.
+    uint32_t GetPendingCount() const;
+
+    VkRenderPass GetRenderPass() const;
+
+    const OffscreenRendererDesc &GetDesc() const;
+
+private:
+
+    struct Slot
+    {
+        VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+
+        VkFence fence{ VK_NULL_HANDLE };
+
+        std::unique_ptr<VulkanImage> colorImage;
+
+        std::unique_ptr<VulkanImage> depthImage;
+
+        VkFramebuffer framebuffer{ VK_NULL_HANDLE };
+
+        std::unique_ptr<VulkanBuffer> readbackBuffer;
+
+        bool pending{ false };
+
+        uint64_t ticket{ 0 };
+
+        std::function<void(const OffscreenReadback &readback)> onReadback;
+    };
+
+    void CreateRenderPass();
+
+    void PrepareTargets(Slot &slot, uint32_t width, uint32_t height);
+
+    void Deliver(Slot &slot);
+
+    VulkanDevice &m_Device;
+
+    const VulkanQueue &m_Queue;
+
+    OffscreenRendererDesc m_Desc{};
+
+    uint32_t m_TexelSize{ 4 };
+
+    VkCommandPool m_CommandPool{ VK_NULL_HANDLE };
+
+    VkRenderPass m_RenderPass{ VK_NULL_HANDLE };
+
+    std::vector<Slot> m_Slots;
+
+    // Slot the next job goes into, also the oldest one in flight.
+    uint32_t m_NextSlot{ 0 };
+
+    uint64_t m_NextTicket{ 1 };
+
+    uint32_t m_PendingCount{ 0 };
+};
@@ -5,9 +5,9 @@
 
 VulkanPhysicalDevice::VulkanPhysicalDevice(const VulkanInstance &instance, VkPhysicalDevice physicalDevice) : m_Instance{ instance }, m_Handle{ physicalDevice }
 {
-   //vkGetPhysicalDeviceFeatures(physical_device, &features);
+    vkGetPhysicalDeviceFeatures(m_Handle, &m_Features);
     vkGetPhysicalDeviceProperties(m_Handle, &m_Properties);
-     //vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+    vkGetPhysicalDeviceMemoryProperties(m_Handle, &m_MemoryProperties);
 
     LOGI("Found GPU: {}", m_Properties.deviceName);
 
@@ -15,6 +15,15 @@ VulkanPhysicalDevice::VulkanPhysicalDevice(const VulkanInstance &instance, VkPhy
     vkGetPhysicalDeviceQueueFamilyProperties(m_Handle, &queueFamilyPropertiesCount, nullptr);
     m_QueueFamilyProperties.resize(queueFamilyPropertiesCount);
     vkGetPhysicalDeviceQueueFamilyProperties(m_Handle, &queueFamilyPropertiesCount, m_QueueFamilyProperties.data());
+
+    // Free when unused, the GPU profiler reads them per zone.
+    m_RequestedFeatures.pipelineStatisticsQuery = m_Features.pipelineStatisticsQuery;
+
+    // VulkanGpuScene draws a pipeline's instances with one indirect call when it is there.
+    m_RequestedFeatures.multiDrawIndirect = m_Features.multiDrawIndirect;
+
+    // GPU driven draws carry their instance index in firstInstance, VulkanDevice reports it missing.
+    m_RequestedFeatures.drawIndirectFirstInstance = m_Features.drawIndirectFirstInstance;
 }
 
 const VkPhysicalDeviceProperties &VulkanPhysicalDevice::GetProperties() const
@@ -22,11 +31,35 @@ const VkPhysicalDeviceProperties &VulkanPhysicalDevice::GetProperties() const
     return m_Properties;
 }
 
+const VkPhysicalDeviceFeatures &VulkanPhysicalDevice::GetFeatures() const
+{
+    return m_Features;
+}
+
 const std::vector<VkQueueFamilyProperties> &VulkanPhysicalDevice::GetQueueFamilyProperties() const
 {
     return m_QueueFamilyProperties;
 }
 
+const VkPhysicalDeviceMemoryProperties &VulkanPhysicalDevice::GetMemoryProperties() const
+{
+    return m_MemoryProperties;
+}
+
+VkDeviceSize VulkanPhysicalDevice::GetDeviceLocalMemorySize() const
+{
+    VkDeviceSize size = 0;
+    for (uint32_t index = 0; index < m_MemoryProperties.memoryHeapCount; ++index)
+    {
+        const VkMemoryHeap &heap = m_MemoryProperties.memoryHeaps[index];
+        if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0)
+        {
+            size = std::max(size, heap.size);
+        }
+    }
+    return size;
+}
+
 VkPhysicalDevice VulkanPhysicalDevice::GetHandle() const
 {
     return m_Handle;
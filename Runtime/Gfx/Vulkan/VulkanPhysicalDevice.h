@@ -16,8 +16,15 @@ public:
 
     const VkPhysicalDeviceProperties &GetProperties() const;
 
+    const VkPhysicalDeviceFeatures &GetFeatures() const;
+
     const std::vector<VkQueueFamilyProperties> &GetQueueFamilyProperties() const;
 
+    const VkPhysicalDeviceMemoryProperties &GetMemoryProperties() const;
+
+    // Size of the largest device local heap.
+    VkDeviceSize GetDeviceLocalMemorySize() const;
+
     VkPhysicalDevice GetHandle() const;
 
     //const  VulkanInstance &GetVulkanInstance() const;
@@ -37,6 +44,10 @@ private:
 
     VkPhysicalDeviceProperties m_Properties;
 
+    VkPhysicalDeviceFeatures m_Features{};
+
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+
     std::vector<VkQueueFamilyProperties> m_QueueFamilyProperties;
 
     void * m_LastRequestedExtensionFeature{ nullptr };
@@ -24,4 +24,29 @@ VulkanQueue::VulkanQueue(VulkanQueue &&other) :
     other.m_Properties = {};
     other.m_CanPresent = VK_FALSE;
     other.m_Index = 0;
-}
\ No newline at end of file
+}
+
+VkQueue VulkanQueue::GetHandle() const
+{
+    return m_Handle;
+}
+
+uint32_t VulkanQueue::GetFamilyIndex() const
+{
+    return m_FamilyIndex;
+}
+
+uint32_t VulkanQueue::GetIndex() const
+{
+    return m_Index;
+}
+
+const VkQueueFamilyProperties &VulkanQueue::GetProperties() const
+{
+    return m_Properties;
+}
+
+VkBool32 VulkanQueue::CanPresent() const
+{
+    return m_CanPresent;
+}
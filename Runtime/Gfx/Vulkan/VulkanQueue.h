@@ -22,6 +22,16 @@ public:
 
     VulkanQueue &operator=(VulkanQueue &&) = delete;
 
+    VkQueue GetHandle() const;
+
+    uint32_t GetFamilyIndex() const;
+
+    uint32_t GetIndex() const;
+
+    const VkQueueFamilyProperties &GetProperties() const;
+
+    VkBool32 CanPresent() const;
+
 private:
 
     VulkanDevice &m_Device;
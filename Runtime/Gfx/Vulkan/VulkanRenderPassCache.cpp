@@ -0,0 +1,369 @@
+#include "VulkanRenderPassCache.h"
+#include "VulkanDevice.h"
+#include "VulkanUtils.h"
+#include "Common/Hash.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+static uint32_t EncodeOperations(const VulkanAttachment &attachment)
+{
+    // Extension ops such as LOAD_OP_NONE would need more bits.
+    assert(attachment.loadOp <= VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    assert(attachment.storeOp <= VK_ATTACHMENT_STORE_OP_DONT_CARE);
+
+    return static_cast<uint32_t>(attachment.loadOp) | (static_cast<uint32_t>(attachment.storeOp) << 2);
+}
+
+static bool HasStencil(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_S8_UINT;
+}
+
+VulkanRenderPassKey VulkanRenderPassKey::Make(const VulkanRenderingDesc &desc)
+{
+    assert(desc.colorCount <= MaxColorAttachments);
+
+    VulkanRenderPassKey key{};
+    key.colorCount = desc.colorCount;
+    for (uint32_t index = 0; index < desc.colorCount; ++index)
+    {
+        key.colorFormats[index] = desc.colors[index].format;
+        key.operations |= EncodeOperations(desc.colors[index]) << (index * 3);
+    }
+
+    if (desc.depth.view != VK_NULL_HANDLE)
+    {
+        key.depthFormat = desc.depth.format;
+        key.operations |= EncodeOperations(desc.depth) << (MaxColorAttachments * 3);
+    }
+    return key;
+}
+
+bool VulkanRenderPassKey::operator==(const VulkanRenderPassKey &other) const
+{
+    return std::memcmp(this, &other, sizeof(VulkanRenderPassKey)) == 0;
+}
+
+size_t VulkanRenderPassKey::Hasher::operator()(const VulkanRenderPassKey &key) const
+{
+    return static_cast<size_t>(Hash::Bytes(&key, sizeof(VulkanRenderPassKey)));
+}
+
+bool VulkanRenderPassCache::FramebufferKey::operator==(const FramebufferKey &other) const
+{
+    return std::memcmp(this, &other, sizeof(FramebufferKey)) == 0;
+}
+
+size_t VulkanRenderPassCache::FramebufferKey::Hasher::operator()(const FramebufferKey &key) const
+{
+    return static_cast<size_t>(Hash::Bytes(&key, sizeof(FramebufferKey)));
+}
+
+VulkanRenderPassCache::VulkanRenderPassCache(VulkanDevice &device, bool allowDynamicRendering) :
+    m_Device{ device },
+    m_UseDynamicRendering{ allowDynamicRendering && device.IsDynamicRenderingEnabled() }
+{
+    static_assert(sizeof(VulkanRenderPassKey) == (MaxColorAttachments + 3) * sizeof(uint32_t), "VulkanRenderPassKey is hashed as bytes and must not have padding");
+    static_assert(sizeof(FramebufferKey) == sizeof(VkRenderPass) + (MaxColorAttachments + 1) * sizeof(VkImageView) + 2 * sizeof(uint32_t),
+        "FramebufferKey is hashed as bytes and must not have padding");
+}
+
+VulkanRenderPassCache::~VulkanRenderPassCache()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    for (const PendingRelease &release : m_PendingReleases)
+    {
+        vkDestroyFramebuffer(device, release.framebuffer, nullptr);
+    }
+
+    for (auto &[key, framebuffer] : m_Framebuffers)
+    {
+        vkDestroyFramebuffer(device, framebuffer.handle, nullptr);
+    }
+
+    for (auto &[key, renderPass] : m_RenderPasses)
+    {
+        vkDestroyRenderPass(device, renderPass, nullptr);
+    }
+}
+
+bool VulkanRenderPassCache::UsesDynamicRendering() const
+{
+    return m_UseDynamicRendering;
+}
+
+void VulkanRenderPassCache::BeginFrame(uint64_t frame)
+{
+    m_Frame = frame;
+}
+
+void VulkanRenderPassCache::Begin(VkCommandBuffer commandBuffer, const VulkanRenderingDesc &desc)
+{
+    assert(desc.colorCount <= MaxColorAttachments);
+    assert(!m_InPass && "End() the previous pass first");
+
+    m_InPass = true;
+
+    if (m_UseDynamicRendering)
+    {
+        BeginDynamicRendering(commandBuffer, desc);
+        return;
+    }
+
+    VkRenderPass renderPass = GetRenderPass(VulkanRenderPassKey::Make(desc));
+
+    VkClearValue clearValues[MaxColorAttachments + 1];
+    uint32_t attachmentCount = desc.colorCount;
+    for (uint32_t index = 0; index < desc.colorCount; ++index)
+    {
+        clearValues[index] = desc.colors[index].clearValue;
+    }
+    if (desc.depth.view != VK_NULL_HANDLE)
+    {
+        clearValues[attachmentCount++] = desc.depth.clearValue;
+    }
+
+    VkRenderPassBeginInfo beginInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+    beginInfo.renderPass = renderPass;
+    beginInfo.framebuffer = GetFramebuffer(renderPass, desc);
+    beginInfo.renderArea.extent = desc.extent;
+    beginInfo.clearValueCount = attachmentCount;
+    beginInfo.pClearValues = clearValues;
+    vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void VulkanRenderPassCache::End(VkCommandBuffer commandBuffer)
+{
+    assert(m_InPass && "End() without Begin()");
+    m_InPass = false;
+
+    if (m_UseDynamicRendering)
+    {
+        vkCmdEndRenderingKHR(commandBuffer);
+    }
+    else
+    {
+        vkCmdEndRenderPass(commandBuffer);
+    }
+}
+
+void VulkanRenderPassCache::BeginDynamicRendering(VkCommandBuffer commandBuffer, const VulkanRenderingDesc &desc) const
+{
+    VkRenderingAttachmentInfoKHR colorAttachments[MaxColorAttachments]{};
+    for (uint32_t index = 0; index < desc.colorCount; ++index)
+    {
+        const VulkanAttachment &color = desc.colors[index];
+
+        VkRenderingAttachmentInfoKHR &attachment = colorAttachments[index];
+        attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        attachment.imageView = color.view;
+        attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachment.loadOp = color.loadOp;
+        attachment.storeOp = color.storeOp;
+        attachment.clearValue = color.clearValue;
+    }
+
+    VkRenderingAttachmentInfoKHR depthAttachment{ VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR };
+    depthAttachment.imageView = desc.depth.view;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = desc.depth.loadOp;
+    depthAttachment.storeOp = desc.depth.storeOp;
+    depthAttachment.clearValue = desc.depth.clearValue;
+
+    bool hasDepth = desc.depth.view != VK_NULL_HANDLE;
+
+    VkRenderingInfoKHR renderingInfo{ VK_STRUCTURE_TYPE_RENDERING_INFO_KHR };
+    renderingInfo.renderArea.extent = desc.extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = desc.colorCount;
+    renderingInfo.pColorAttachments = colorAttachments;
+    renderingInfo.pDepthAttachment = hasDepth ? &depthAttachment : nullptr;
+    renderingInfo.pStencilAttachment = hasDepth && HasStencil(desc.depth.format) ? &depthAttachment : nullptr;
+    vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+}
+
+VkRenderPass VulkanRenderPassCache::GetRenderPass(const VulkanRenderPassKey &key)
+{
+    auto found = m_RenderPasses.find(key);
+    if (found != m_RenderPasses.end())
+    {
+        return found->second;
+    }
+
+    VkRenderPass renderPass = CreateRenderPass(key);
+    m_RenderPasses.emplace(key, renderPass);
+    m_Stats.renderPassCount = static_cast<uint32_t>(m_RenderPasses.size());
+    return renderPass;
+}
+
+VkRenderPass VulkanRenderPassCache::CreateRenderPass(const VulkanRenderPassKey &key) const
+{
+    VkAttachmentDescription attachments[MaxColorAttachments + 1]{};
+    VkAttachmentReference colorReferences[MaxColorAttachments]{};
+    VkAttachmentReference depthReference{};
+
+    // Same contract as dynamic rendering: attachments enter and leave in their attachment layout.
+    // Nothing to preserve without LOAD, so UNDEFINED lets the driver skip the transition.
+    auto describe = [&key](VkAttachmentDescription &attachment, uint32_t format, uint32_t slot, VkImageLayout layout)
+    {
+        uint32_t operations = key.operations >> (slot * 3);
+        attachment.format = static_cast<VkFormat>(format);
+        attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        attachment.loadOp = static_cast<VkAttachmentLoadOp>(operations & 3);
+        attachment.storeOp = static_cast<VkAttachmentStoreOp>((operations >> 2) & 1);
+        attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.initialLayout = attachment.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? layout : VK_IMAGE_LAYOUT_UNDEFINED;
+        attachment.finalLayout = layout;
+    };
+
+    uint32_t attachmentCount = key.colorCount;
+    for (uint32_t index = 0; index < key.colorCount; ++index)
+    {
+        describe(attachments[index], key.colorFormats[index], index, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        colorReferences[index] = { index, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    }
+
+    bool hasDepth = key.depthFormat != VK_FORMAT_UNDEFINED;
+    if (hasDepth)
+    {
+        VkAttachmentDescription &depth = attachments[attachmentCount];
+        describe(depth, key.depthFormat, MaxColorAttachments, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+        if (HasStencil(static_cast<VkFormat>(key.depthFormat)))
+        {
+            depth.stencilLoadOp = depth.loadOp;
+            depth.stencilStoreOp = depth.storeOp;
+        }
+        depthReference = { attachmentCount++, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+    }
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = key.colorCount;
+    subpass.pColorAttachments = colorReferences;
+    subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+    VkRenderPassCreateInfo renderPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+    renderPassInfo.attachmentCount = attachmentCount;
+    renderPassInfo.pAttachments = attachments;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    VkRenderPass renderPass{ VK_NULL_HANDLE };
+    VK_CHECK(vkCreateRenderPass(m_Device.GetHandle(), &renderPassInfo, nullptr, &renderPass));
+    return renderPass;
+}
+
+VkFramebuffer VulkanRenderPassCache::GetFramebuffer(VkRenderPass renderPass, const VulkanRenderingDesc &desc)
+{
+    FramebufferKey key{};
+    key.renderPass = renderPass;
+    key.width = desc.extent.width;
+    key.height = desc.extent.height;
+
+    uint32_t attachmentCount = desc.colorCount;
+    for (uint32_t index = 0; index < desc.colorCount; ++index)
+    {
+        key.views[index] = desc.colors[index].view;
+    }
+    if (desc.depth.view != VK_NULL_HANDLE)
+    {
+        key.views[attachmentCount++] = desc.depth.view;
+    }
+
+    auto found = m_Framebuffers.find(key);
+    if (found != m_Framebuffers.end())
+    {
+        found->second.lastUsedFrame = m_Frame;
+        return found->second.handle;
+    }
+
+    VkFramebufferCreateInfo framebufferInfo{ VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+    framebufferInfo.renderPass = renderPass;
+    framebufferInfo.attachmentCount = attachmentCount;
+    framebufferInfo.pAttachments = key.views;
+    framebufferInfo.width = desc.extent.width;
+    framebufferInfo.height = desc.extent.height;
+    framebufferInfo.layers = 1;
+
+    Framebuffer framebuffer{};
+    framebuffer.lastUsedFrame = m_Frame;
+    VK_CHECK(vkCreateFramebuffer(m_Device.GetHandle(), &framebufferInfo, nullptr, &framebuffer.handle));
+
+    m_Framebuffers.emplace(key, framebuffer);
+    ++m_Stats.framebuffersCreated;
+    m_Stats.framebufferCount = static_cast<uint32_t>(m_Framebuffers.size());
+    return framebuffer.handle;
+}
+
+void VulkanRenderPassCache::ReleaseImageView(VkImageView view, uint64_t releaseFrame)
+{
+    for (auto entry = m_Framebuffers.begin(); entry != m_Framebuffers.end();)
+    {
+        const VkImageView *views = entry->first.views;
+        if (std::find(views, views + MaxColorAttachments + 1, view) != views + MaxColorAttachments + 1)
+        {
+            m_PendingReleases.push_back(PendingRelease{ entry->second.handle, releaseFrame });
+            entry = m_Framebuffers.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+    m_Stats.framebufferCount = static_cast<uint32_t>(m_Framebuffers.size());
+}
+
+void VulkanRenderPassCache::ReleaseFramebuffers(uint64_t releaseFrame)
+{
+    for (auto &[key, framebuffer] : m_Framebuffers)
+    {
+        m_PendingReleases.push_back(PendingRelease{ framebuffer.handle, releaseFrame });
+    }
+    m_Framebuffers.clear();
+    m_Stats.framebufferCount = 0;
+}
+
+void VulkanRenderPassCache::CollectReleased(uint64_t completedFrame)
+{
+    VkDevice device = m_Device.GetHandle();
+
+    size_t kept = 0;
+    for (size_t index = 0; index < m_PendingReleases.size(); ++index)
+    {
+        const PendingRelease &release = m_PendingReleases[index];
+        if (release.frame <= completedFrame)
+        {
+            vkDestroyFramebuffer(device, release.framebuffer, nullptr);
+            ++m_Stats.framebuffersDestroyed;
+        }
+        else
+        {
+            m_PendingReleases[kept++] = release;
+        }
+    }
+    m_PendingReleases.resize(kept);
+
+    // Idle ones are past the GPU already, their last frame has completed.
+    for (auto entry = m_Framebuffers.begin(); entry != m_Framebuffers.end();)
+    {
+        if (entry->second.lastUsedFrame + MaxIdleFrames <= completedFrame)
+        {
+            vkDestroyFramebuffer(device, entry->second.handle, nullptr);
+            ++m_Stats.framebuffersDestroyed;
+            entry = m_Framebuffers.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+    m_Stats.framebufferCount = static_cast<uint32_t>(m_Framebuffers.size());
+}
+
+const VulkanRenderPassCacheStats &VulkanRenderPassCache::GetStats() const
+{
+    return m_Stats;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+static constexpr uint32_t MaxColorAttachments = 4;
+
+struct VulkanAttachment
+{
+    // Null for an unused depth attachment.
+    VkImageView view{ VK_NULL_HANDLE };
+
+    VkFormat format{ VK_FORMAT_UNDEFINED };
+
+    VkAttachmentLoadOp loadOp{ VK_ATTACHMENT_LOAD_OP_CLEAR };
+
+    VkAttachmentStoreOp storeOp{ VK_ATTACHMENT_STORE_OP_STORE };
+
+    VkClearValue clearValue{};
+};
+
+// Attachments must be in COLOR_ATTACHMENT_OPTIMAL, or DEPTH_STENCIL_ATTACHMENT_OPTIMAL, before Begin()
+// and are left in it by End(); transitions around the pass are up to the caller on both paths.
+struct VulkanRenderingDesc
+{
+    VkExtent2D extent{ 0, 0 };
+
+    uint32_t colorCount{ 0 };
+
+    VulkanAttachment colors[MaxColorAttachments];
+
+    VulkanAttachment depth;
+};
+
+// Attachment formats and operations, all a pipeline needs to know about the pass it draws in.
+struct VulkanRenderPassKey
+{
+    uint32_t colorCount{ 0 };
+
+    uint32_t colorFormats[MaxColorAttachments]{};
+
+    uint32_t depthFormat{ VK_FORMAT_UNDEFINED };
+
+    // Load op in bits 0-1 and store op in bit 2 of each attachment, colors first and depth last.
+    uint32_t operations{ 0 };
+
+    static VulkanRenderPassKey Make(const VulkanRenderingDesc &desc);
+
+    bool operator==(const VulkanRenderPassKey &other) const;
+
+    struct Hasher
+    {
+        size_t operator()(const VulkanRenderPassKey &key) const;
+    };
+};
+
+struct VulkanRenderPassCacheStats
+{
+    uint32_t renderPassCount{ 0 };
+
+    uint32_t framebufferCount{ 0 };
+
+    uint32_t framebuffersCreated{ 0 };
+
+    uint32_t framebuffersDestroyed{ 0 };
+};
+
+// Begins and ends passes without the caller owning any VkRenderPass or VkFramebuffer. Uses
+// VK_KHR_dynamic_rendering when the device has it enabled. Otherwise render passes are created once per
+// attachment formats and operations, and framebuffers once per render pass, views and extent, both found
+// again by hash.
+//
+// Framebuffers die with their views: call ReleaseImageView() before destroying a view, for instance for
+// every swapchain and render target view on resize, and CollectReleased() with the last completed frame.
+// Framebuffers left unused for a while are dropped as well. Single threaded.
+class VulkanRenderPassCache : public NonCopyable
+{
+public:
+
+    static constexpr uint64_t MaxIdleFrames = 64;
+
+    VulkanRenderPassCache(VulkanDevice &device, bool allowDynamicRendering = true);
+
+    ~VulkanRenderPassCache();
+
+    bool UsesDynamicRendering() const;
+
+    // Frame the passes begun from now on belong to, for the idle framebuffer eviction.
+    void BeginFrame(uint64_t frame);
+
+    void Begin(VkCommandBuffer commandBuffer, const VulkanRenderingDesc &desc);
+
+    void End(VkCommandBuffer commandBuffer);
+
+    // Compatible render pass for pipelines created without dynamic rendering, created on first use.
+    VkRenderPass GetRenderPass(const VulkanRenderPassKey &key);
+
+    VkFramebuffer GetFramebuffer(VkRenderPass renderPass, const VulkanRenderingDesc &desc);
+
+    // Framebuffers using view are destroyed by the first CollectReleased() with completedFrame >= releaseFrame.
+    void ReleaseImageView(VkImageView view, uint64_t releaseFrame);
+
+    // Releases every framebuffer, render passes are kept.
+    void ReleaseFramebuffers(uint64_t releaseFrame);
+
+    // Destroys released framebuffers whose frame has finished, and those idle for MaxIdleFrames.
+    void CollectReleased(uint64_t completedFrame);
+
+    const VulkanRenderPassCacheStats &GetStats() const;
+
+private:
+
+    struct FramebufferKey
+    {
+        VkRenderPass renderPass{ VK_NULL_HANDLE };
+
+        VkImageView views[MaxColorAttachments + 1]{};
+
+        uint32_t width{ 0 };
+
+        uint32_t height{ 0 };
+
+        bool operator==(const FramebufferKey &other) const;
+
+        struct Hasher
+        {
+            size_t operator()(const FramebufferKey &key) const;
+        };
+    };
+
+    struct Framebuffer
+    {
+        VkFramebuffer handle{ VK_NULL_HANDLE };
+
+        uint64_t lastUsedFrame{ 0 };
+    };
+
+    struct PendingRelease
+    {
+        VkFramebuffer framebuffer;
+
+        uint64_t frame;
+    };
+
+    VkRenderPass CreateRenderPass(const VulkanRenderPassKey &key) const;
+
+    void BeginDynamicRendering(VkCommandBuffer commandBuffer, const VulkanRenderingDesc &desc) const;
+
+    VulkanDevice &m_Device;
+
+    bool m_UseDynamicRendering{ false };
+
+    uint64_t m_Frame{ 0 };
+
+    // Set between Begin() and End().
+    bool m_InPass{ false };
+
+    std::unordered_map<VulkanRenderPassKey, VkRenderPass, VulkanRenderPassKey::Hasher> m_RenderPasses;
+
+    std::unordered_map<FramebufferKey, Framebuffer, FramebufferKey::Hasher> m_Framebuffers;
+
+    std::vector<PendingRelease> m_PendingReleases;
+
+    VulkanRenderPassCacheStats m_Stats{};
+};
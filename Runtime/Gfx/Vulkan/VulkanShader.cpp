@@ -1,58 +1,76 @@
 #include "VulkanShader.h"
 #include "VulkanDevice.h"
+#include "VulkanShaderCompiler.h"
+#include "Common/Logging.h"
 #include <cassert>
-//#include "glsl_compiler.h"
 //#include "spirv_reflection.h"
 
-VulkanShader::VulkanShader(VulkanDevice &device, ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions) : 
-    m_Device{device}, 
-    GfxShader{ shaderType, entryPoint, source, definitions }
+static VkShaderStageFlagBits GetShaderStage(ShaderType shaderType)
 {
-    //VkPipelineShaderStageCreateInfo stage_create_info{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+    switch (shaderType)
+    {
+    case VertexShader:
+        return VK_SHADER_STAGE_VERTEX_BIT;
+    case FragmentShader:
+        return VK_SHADER_STAGE_FRAGMENT_BIT;
+    case ComputeShader:
+        return VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    return VK_SHADER_STAGE_VERTEX_BIT;
+}
+
+VulkanShader::VulkanShader(VulkanDevice &device, ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions) :
+    GfxShader{ shaderType, entryPoint, source, definitions },
+    m_Device{ device },
+    m_Stage{ GetShaderStage(shaderType) }
+{
+    std::vector<uint32_t> spirv;
+    std::string infoLog;
 
-    //stage_create_info.stage = shader_module->get_stage();
-    //stage_create_info.pName = shader_module->get_entry_point().c_str();
+    // Compile the GLSL source
+    if (!VulkanShaderCompiler::CompileToSpirv(m_Stage, std::string{ source.begin(), source.end() }, entryPoint, definitions, spirv, infoLog))
+    {
+        LOGE("Shader compilation failed:\n{}", infoLog);
+        return;
+    }
 
     // Create the Vulkan handle
     VkShaderModuleCreateInfo vkCreateInfo{ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
 
-    //vk_create_info.codeSize = shader_module->get_binary().size() * sizeof(uint32_t);
-    //vk_create_info.pCode = shader_module->get_binary().data();
+    vkCreateInfo.codeSize = spirv.size() * sizeof(uint32_t);
+    vkCreateInfo.pCode = spirv.data();
 
     VkResult result = vkCreateShaderModule(m_Device.GetHandle(), &vkCreateInfo, nullptr, &m_Handle);
 
     assert(result == VK_SUCCESS);
 
-    //stage_create_info.pSpecializationInfo = &specialization_info;
-
-    //stage_create_infos.push_back(stage_create_info);
-    //shader_modules.push_back(stage_create_info.module);
-
-
-    //GLSLCompiler glsl_compiler;
-
-    // Compile the GLSL source
-    /*if (!glsl_compiler.compile_to_spirv(stage, glsl_source.get_data(), entry_point, shader_variant, spirv, info_log))
-    {
-        if (glsl_source.get_filename().empty())
-        {
-            throw VulkanException{ VK_ERROR_INITIALIZATION_FAILED, "Shader compilation failed:\n" + info_log };
-        }
-        else
-        {
-            throw VulkanException{ VK_ERROR_INITIALIZATION_FAILED, "Compilation failed for shader \"" + glsl_source.get_filename() + "\":\n" + info_log };
-        }
-    }
-
-    SPIRVReflection spirv_reflection;
-    */
     // Reflect all shader resouces
     /*if (!spirv_reflection.reflect_shader_resources(stage, spirv, resources, shader_variant))
     {
         throw VulkanException{ VK_ERROR_INITIALIZATION_FAILED };
     }
     */
-    // Generate a unique id, determined by source and variant
-    //std::hash<std::string> hasher{};
-    //id = hasher(std::string{ spirv.cbegin(), spirv.cend() });
-}
\ No newline at end of file
+}
+
+VulkanShader::~VulkanShader()
+{
+    if (m_Handle != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(m_Device.GetHandle(), m_Handle, nullptr);
+    }
+}
+
+VkShaderModule VulkanShader::GetHandle() const
+{
+    return m_Handle;
+}
+
+VkShaderStageFlagBits VulkanShader::GetStage() const
+{
+    return m_Stage;
+}
+
+const std::string &VulkanShader::GetEntryPoint() const
+{
+    return m_EntryPoint;
+}
@@ -13,11 +13,22 @@ class VulkanShader : public GfxShader
 {
 public:
 
+    // source is GLSL text, compiled to SPIR-V with definitions injected as #defines.
     VulkanShader(VulkanDevice &device, ShaderType shaderType, const std::string &entryPoint, const std::vector<uint8_t> &source, const std::vector<std::string> &definitions);
 
+    ~VulkanShader();
+
+    VkShaderModule GetHandle() const;
+
+    VkShaderStageFlagBits GetStage() const;
+
+    const std::string &GetEntryPoint() const;
+
 private:
 
     VulkanDevice &m_Device;
 
     VkShaderModule m_Handle{ VK_NULL_HANDLE };
+
+    VkShaderStageFlagBits m_Stage{ VK_SHADER_STAGE_VERTEX_BIT };
 };
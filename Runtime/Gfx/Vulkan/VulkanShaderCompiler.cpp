@@ -0,0 +1,88 @@
+#include "VulkanShaderCompiler.h"
+#include <mutex>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <StandAlone/ResourceLimits.h>
+
+static EShLanguage FindShaderLanguage(VkShaderStageFlagBits stage)
+{
+    switch (stage)
+    {
+    case VK_SHADER_STAGE_VERTEX_BIT:
+        return EShLangVertex;
+    case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+        return EShLangTessControl;
+    case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+        return EShLangTessEvaluation;
+    case VK_SHADER_STAGE_GEOMETRY_BIT:
+        return EShLangGeometry;
+    case VK_SHADER_STAGE_FRAGMENT_BIT:
+        return EShLangFragment;
+    case VK_SHADER_STAGE_COMPUTE_BIT:
+        return EShLangCompute;
+    default:
+        return EShLangVertex;
+    }
+}
+
+bool VulkanShaderCompiler::CompileToSpirv(VkShaderStageFlagBits stage, const std::string &source, const std::string &entryPoint, const std::vector<std::string> &definitions, std::vector<uint32_t> &spirv, std::string &infoLog)
+{
+    // glslang keeps process wide tables, initialise them once and keep them alive.
+    static std::once_flag initializeOnce;
+    std::call_once(initializeOnce, []() { glslang::InitializeProcess(); });
+
+    EShMessages messages = static_cast<EShMessages>(EShMsgDefault | EShMsgVulkanRules | EShMsgSpvRules);
+    EShLanguage language = FindShaderLanguage(stage);
+
+    std::string preamble;
+    for (const std::string &definition : definitions)
+    {
+        preamble += "#define " + definition + "\n";
+    }
+
+    const char *shaderSource = source.c_str();
+    int shaderLength = static_cast<int>(source.size());
+
+    glslang::TShader shader(language);
+    shader.setStringsWithLengths(&shaderSource, &shaderLength, 1);
+    shader.setPreamble(preamble.c_str());
+    shader.setEntryPoint(entryPoint.c_str());
+    shader.setSourceEntryPoint(entryPoint.c_str());
+    shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientVulkan, 100);
+    shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_1);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_3);
+
+    if (!shader.parse(&glslang::DefaultTBuiltInResource, 100, false, messages))
+    {
+        infoLog = std::string(shader.getInfoLog()) + "\n" + shader.getInfoDebugLog();
+        return false;
+    }
+
+    glslang::TProgram program;
+    program.addShader(&shader);
+
+    if (!program.link(messages))
+    {
+        infoLog = std::string(program.getInfoLog()) + "\n" + program.getInfoDebugLog();
+        return false;
+    }
+
+    if (shader.getInfoLog())
+    {
+        infoLog += std::string(shader.getInfoLog()) + "\n" + shader.getInfoDebugLog();
+    }
+
+    glslang::TIntermediate *intermediate = program.getIntermediate(language);
+    if (intermediate == nullptr)
+    {
+        infoLog += "Failed to get shared intermediate code.\n";
+        return false;
+    }
+
+    spv::SpvBuildLogger logger;
+    glslang::GlslangToSpv(*intermediate, spirv, &logger);
+
+    infoLog += logger.getAllMessages();
+
+    return true;
+}
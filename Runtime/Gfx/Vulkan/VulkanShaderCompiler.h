@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <volk.h>
+
+// GLSL to SPIR-V through glslang.
+class VulkanShaderCompiler
+{
+public:
+
+    // definitions are injected as "#define <definition>" lines after the #version directive.
+    static bool CompileToSpirv(VkShaderStageFlagBits stage, const std::string &source, const std::string &entryPoint, const std::vector<std::string> &definitions, std::vector<uint32_t> &spirv, std::string &infoLog);
+};
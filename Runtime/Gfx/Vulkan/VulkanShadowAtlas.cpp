@@ -0,0 +1,277 @@
+#include "VulkanShadowAtlas.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanGpuScene.h"
+#include "VulkanUtils.h"
+#include <algorithm>
+#include <cassert>
+
+static void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+static constexpr VkPipelineStageFlags DepthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+static constexpr VkAccessFlags DepthAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+VulkanShadowAtlas::VulkanShadowAtlas(VulkanDevice &device, uint32_t atlasSize, VkFormat depthFormat) :
+    m_Device{ device },
+    m_AtlasSize{ atlasSize }
+{
+    VkExtent2D extent{ atlasSize, atlasSize };
+    m_StaticAtlas = std::make_unique<VulkanImage>(m_Device, extent, depthFormat,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+    m_ShadowMap = std::make_unique<VulkanImage>(m_Device, extent, depthFormat,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    CreateRenderPass(depthFormat);
+    m_StaticFramebuffer = CreateFramebuffer(*m_StaticAtlas);
+    m_ShadowFramebuffer = CreateFramebuffer(*m_ShadowMap);
+}
+
+VulkanShadowAtlas::~VulkanShadowAtlas()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    vkDestroyFramebuffer(device, m_ShadowFramebuffer, nullptr);
+    vkDestroyFramebuffer(device, m_StaticFramebuffer, nullptr);
+    vkDestroyRenderPass(device, m_RenderPass, nullptr);
+}
+
+void VulkanShadowAtlas::CreateRenderPass(VkFormat depthFormat)
+{
+    // Tiles are cleared and drawn one by one, the rest of the atlas is kept. Layout transitions and
+    // dependencies are recorded around the pass.
+    VkAttachmentDescription attachment{};
+    attachment.format = depthFormat;
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthReference{ 0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.pDepthStencilAttachment = &depthReference;
+
+    VkRenderPassCreateInfo renderPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &attachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    VK_CHECK(vkCreateRenderPass(m_Device.GetHandle(), &renderPassInfo, nullptr, &m_RenderPass));
+}
+
+VkFramebuffer VulkanShadowAtlas::CreateFramebuffer(const VulkanImage &image)
+{
+    VkImageView view = image.GetView();
+
+    VkFramebufferCreateInfo framebufferInfo{ VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+    framebufferInfo.renderPass = m_RenderPass;
+    framebufferInfo.attachmentCount = 1;
+    framebufferInfo.pAttachments = &view;
+    framebufferInfo.width = m_AtlasSize;
+    framebufferInfo.height = m_AtlasSize;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateFramebuffer(m_Device.GetHandle(), &framebufferInfo, nullptr, &framebuffer));
+    return framebuffer;
+}
+
+void VulkanShadowAtlas::Initialize(VkCommandBuffer commandBuffer)
+{
+    VkClearDepthStencilValue clearValue{ 1.0f, 0 };
+
+    VkImageSubresourceRange range{};
+    range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    range.levelCount = 1;
+    range.layerCount = 1;
+
+    for (const VulkanImage *image : { m_StaticAtlas.get(), m_ShadowMap.get() })
+    {
+        TransitionImage(commandBuffer, image->GetHandle(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdClearDepthStencilImage(commandBuffer, image->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearValue, 1, &range);
+    }
+
+    TransitionImage(commandBuffer, m_StaticAtlas->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, DepthStages, DepthAccess);
+    TransitionImage(commandBuffer, m_ShadowMap->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    m_Initialized = true;
+}
+
+void VulkanShadowAtlas::RenderViews(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, const std::vector<ShadowView> &views, const GpuCullParams &cameraParams,
+    const ShadowCasterSet &casters, bool clear)
+{
+    uint32_t viewCount = static_cast<uint32_t>(m_ViewList.size());
+    uint32_t batchSize = casters.scene != nullptr ? casters.scene->GetViewCount() : viewCount;
+
+    for (uint32_t first = 0; first < viewCount; first += batchSize)
+    {
+        uint32_t count = std::min(batchSize, viewCount - first);
+
+        // The previous batch wrote other tiles of the same atlas, which this pass loads and stores again.
+        if (first > 0)
+        {
+            VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+            barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+            VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            vkCmdPipelineBarrier(commandBuffer, depthStages, depthStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        if (casters.scene != nullptr)
+        {
+            m_CullParams.resize(count);
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                m_CullParams[index] = views[m_ViewList[first + index]].GetCullParams(cameraParams);
+            }
+            casters.scene->Cull(commandBuffer, m_CullParams.data(), 0, count);
+        }
+
+        VkRenderPassBeginInfo renderPassBegin{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+        renderPassBegin.renderPass = m_RenderPass;
+        renderPassBegin.framebuffer = framebuffer;
+        renderPassBegin.renderArea.extent = { m_AtlasSize, m_AtlasSize };
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            const ShadowView &view = views[m_ViewList[first + index]];
+            const ShadowAtlasTile &tile = view.tile;
+
+            VkViewport viewport{ static_cast<float>(tile.x), static_cast<float>(tile.y), static_cast<float>(tile.size), static_cast<float>(tile.size), 0.0f, 1.0f };
+            VkRect2D scissor{ { static_cast<int32_t>(tile.x), static_cast<int32_t>(tile.y) }, { tile.size, tile.size } };
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+            if (clear)
+            {
+                VkClearAttachment clearAttachment{};
+                clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+                clearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+                VkClearRect clearRect{ scissor, 0, 1 };
+                vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+            }
+
+            if (casters.scene != nullptr && casters.draw)
+            {
+                casters.draw(commandBuffer, view, index);
+            }
+        }
+
+        vkCmdEndRenderPass(commandBuffer);
+    }
+}
+
+void VulkanShadowAtlas::Render(VkCommandBuffer commandBuffer, const std::vector<ShadowView> &views, const GpuCullParams &cameraParams,
+    const ShadowCasterSet &staticCasters, const ShadowCasterSet &dynamicCasters)
+{
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "ShadowAtlas::Render");
+
+    if (!m_Initialized)
+    {
+        Initialize(commandBuffer);
+    }
+
+    m_ViewList.clear();
+    for (uint32_t index = 0; index < views.size(); ++index)
+    {
+        if (views[index].renderStatic)
+        {
+            m_ViewList.push_back(index);
+        }
+    }
+
+    if (!m_ViewList.empty())
+    {
+        GPU_PROFILE_SCOPE(m_Device.GetGpuProfiler(), commandBuffer, "ShadowAtlas::Static");
+        RenderViews(commandBuffer, m_StaticFramebuffer, views, cameraParams, staticCasters, true);
+    }
+
+    m_Copies.clear();
+    for (const ShadowView &view : views)
+    {
+        if (view.refresh)
+        {
+            VkImageCopy copy{};
+            copy.srcSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 0, 1 };
+            copy.srcOffset = { static_cast<int32_t>(view.tile.x), static_cast<int32_t>(view.tile.y), 0 };
+            copy.dstSubresource = copy.srcSubresource;
+            copy.dstOffset = copy.srcOffset;
+            copy.extent = { view.tile.size, view.tile.size, 1 };
+            m_Copies.push_back(copy);
+        }
+    }
+
+    // Untouched tiles keep last frame's contents, there is nothing to do.
+    if (m_Copies.empty())
+    {
+        return;
+    }
+
+    TransitionImage(commandBuffer, m_StaticAtlas->GetHandle(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    TransitionImage(commandBuffer, m_ShadowMap->GetHandle(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    vkCmdCopyImage(commandBuffer, m_StaticAtlas->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_ShadowMap->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(m_Copies.size()), m_Copies.data());
+
+    TransitionImage(commandBuffer, m_StaticAtlas->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, DepthStages, DepthAccess);
+    TransitionImage(commandBuffer, m_ShadowMap->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, DepthStages, DepthAccess);
+
+    m_ViewList.clear();
+    for (uint32_t index = 0; index < views.size(); ++index)
+    {
+        if (views[index].refresh && views[index].hasDynamicCasters)
+        {
+            m_ViewList.push_back(index);
+        }
+    }
+
+    if (!m_ViewList.empty())
+    {
+        GPU_PROFILE_SCOPE(m_Device.GetGpuProfiler(), commandBuffer, "ShadowAtlas::Dynamic");
+        RenderViews(commandBuffer, m_ShadowFramebuffer, views, cameraParams, dynamicCasters, false);
+    }
+
+    TransitionImage(commandBuffer, m_ShadowMap->GetHandle(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        DepthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
+VkRenderPass VulkanShadowAtlas::GetRenderPass() const
+{
+    return m_RenderPass;
+}
+
+const VulkanImage &VulkanShadowAtlas::GetShadowMap() const
+{
+    return *m_ShadowMap;
+}
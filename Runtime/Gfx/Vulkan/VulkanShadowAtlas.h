@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Render/ShadowCache.h"
+#include "VulkanImage.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class VulkanGpuScene;
+
+// Casters drawn into shadow views, culled per view through VulkanGpuScene.
+struct ShadowCasterSet
+{
+    // Views are culled in batches of its view count. Null draws nothing.
+    VulkanGpuScene *scene{ nullptr };
+
+    // Binds a depth only pipeline compatible with VulkanShadowAtlas::GetRenderPass(), pushes
+    // view.viewProjection and issues scene->Draw(..., cullView) for its pipelines. Called inside the
+    // render pass with the viewport and scissor set to the tile.
+    std::function<void(VkCommandBuffer commandBuffer, const ShadowView &view, uint32_t cullView)> draw;
+};
+
+// Depth atlases for a ShadowCache. The static atlas holds the static casters of every tile and is only
+// redrawn where the cache asks for it; refreshed tiles are copied from it into the shadow map and get
+// the dynamic casters on top.
+class VulkanShadowAtlas : public NonCopyable
+{
+public:
+
+    VulkanShadowAtlas(VulkanDevice &device, uint32_t atlasSize, VkFormat depthFormat = VK_FORMAT_D32_SFLOAT);
+
+    ~VulkanShadowAtlas();
+
+    // Records the static and dynamic passes for views, from ShadowCache::GetViews(). Must be recorded
+    // outside a render pass; afterwards the shadow map is in
+    // VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL for the fragment shaders.
+    void Render(VkCommandBuffer commandBuffer, const std::vector<ShadowView> &views, const GpuCullParams &cameraParams,
+        const ShadowCasterSet &staticCasters, const ShadowCasterSet &dynamicCasters);
+
+    VkRenderPass GetRenderPass() const;
+
+    const VulkanImage &GetShadowMap() const;
+
+private:
+
+    void CreateRenderPass(VkFormat depthFormat);
+
+    VkFramebuffer CreateFramebuffer(const VulkanImage &image);
+
+    void Initialize(VkCommandBuffer commandBuffer);
+
+    // Culls and draws the views of m_ViewList in batches, clearing every tile first when clear is set.
+    void RenderViews(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, const std::vector<ShadowView> &views, const GpuCullParams &cameraParams,
+        const ShadowCasterSet &casters, bool clear);
+
+    VulkanDevice &m_Device;
+
+    uint32_t m_AtlasSize{ 0 };
+
+    std::unique_ptr<VulkanImage> m_StaticAtlas;
+
+    std::unique_ptr<VulkanImage> m_ShadowMap;
+
+    VkRenderPass m_RenderPass{ VK_NULL_HANDLE };
+
+    VkFramebuffer m_StaticFramebuffer{ VK_NULL_HANDLE };
+
+    VkFramebuffer m_ShadowFramebuffer{ VK_NULL_HANDLE };
+
+    // Both atlases start out undefined and are cleared by the first Render().
+    bool m_Initialized{ false };
+
+    // Scratch kept between frames.
+    std::vector<uint32_t> m_ViewList;
+
+    std::vector<GpuCullParams> m_CullParams;
+
+    std::vector<VkImageCopy> m_Copies;
+};
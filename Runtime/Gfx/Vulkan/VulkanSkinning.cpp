@@ -0,0 +1,333 @@
+#include "VulkanSkinning.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanUtils.h"
+#include "Animation/AnimationSystem.h"
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+static const char *g_SkinningShader = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct SourceVertex
+{
+    vec4 position;
+    vec4 normal;
+    uvec4 joints;
+    vec4 weights;
+};
+
+struct Character
+{
+    uint sourceOffset;
+    uint vertexCount;
+    uint jointOffset;
+    uint outputOffset;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer SourceVertices
+{
+    SourceVertex sourceVertices[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Characters
+{
+    Character characters[];
+};
+
+// Three rows of a 3x4 matrix per joint, or the real and dual part of a dual quaternion.
+layout(std430, set = 0, binding = 2) readonly buffer Joints
+{
+    vec4 joints[];
+};
+
+layout(std430, set = 0, binding = 3) writeonly buffer Outputs
+{
+    float outputs[];
+};
+
+void main()
+{
+    Character character = characters[gl_WorkGroupID.y];
+    uint vertexIndex = gl_GlobalInvocationID.x;
+    if (vertexIndex >= character.vertexCount)
+    {
+        return;
+    }
+
+    SourceVertex source = sourceVertices[character.sourceOffset + vertexIndex];
+
+#if DUAL_QUATERNION
+    vec4 firstReal = joints[(character.jointOffset + source.joints.x) * 2];
+    vec4 real = vec4(0.0);
+    vec4 dual = vec4(0.0);
+    for (int slot = 0; slot < 4; ++slot)
+    {
+        uint joint = (character.jointOffset + source.joints[slot]) * 2;
+        vec4 jointReal = joints[joint];
+        float weight = dot(jointReal, firstReal) < 0.0 ? -source.weights[slot] : source.weights[slot];
+        real += jointReal * weight;
+        dual += joints[joint + 1] * weight;
+    }
+
+    float inverseLength = 1.0 / max(length(real), 1e-12);
+    real *= inverseLength;
+    dual *= inverseLength;
+
+    vec3 translation = 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+    vec3 position = source.position.xyz + 2.0 * cross(real.xyz, cross(real.xyz, source.position.xyz) + real.w * source.position.xyz) + translation;
+    vec3 normal = source.normal.xyz + 2.0 * cross(real.xyz, cross(real.xyz, source.normal.xyz) + real.w * source.normal.xyz);
+#else
+    vec4 rows[3] = vec4[3](vec4(0.0), vec4(0.0), vec4(0.0));
+    for (int slot = 0; slot < 4; ++slot)
+    {
+        uint joint = (character.jointOffset + source.joints[slot]) * 3;
+        rows[0] += joints[joint] * source.weights[slot];
+        rows[1] += joints[joint + 1] * source.weights[slot];
+        rows[2] += joints[joint + 2] * source.weights[slot];
+    }
+
+    vec4 sourcePosition = vec4(source.position.xyz, 1.0);
+    vec3 position = vec3(dot(rows[0], sourcePosition), dot(rows[1], sourcePosition), dot(rows[2], sourcePosition));
+    vec3 normal = vec3(dot(rows[0].xyz, source.normal.xyz), dot(rows[1].xyz, source.normal.xyz), dot(rows[2].xyz, source.normal.xyz));
+    normal *= 1.0 / max(length(normal), 1e-12);
+#endif
+
+    uint outputIndex = (character.outputOffset + vertexIndex) * 6;
+    outputs[outputIndex + 0] = position.x;
+    outputs[outputIndex + 1] = position.y;
+    outputs[outputIndex + 2] = position.z;
+    outputs[outputIndex + 3] = normal.x;
+    outputs[outputIndex + 4] = normal.y;
+    outputs[outputIndex + 5] = normal.z;
+}
+)";
+
+static constexpr uint32_t SkinningGroupSize = 64;
+
+static constexpr uint32_t SkinningBindingCount = 4;
+
+// Matches SourceVertex.
+struct SkinningSourceVertex
+{
+    glm::vec4 position;
+
+    glm::vec4 normal;
+
+    glm::uvec4 joints;
+
+    glm::vec4 weights;
+};
+
+// Matches Character.
+struct SkinningCharacter
+{
+    uint32_t sourceOffset;
+
+    uint32_t vertexCount;
+
+    uint32_t jointOffset;
+
+    uint32_t outputOffset;
+};
+
+VulkanSkinning::VulkanSkinning(VulkanDevice &device, const AnimationSystem &system, uint32_t framesInFlight) :
+    m_Device{ device },
+    m_JointCount{ system.GetJointCount() }
+{
+    assert(framesInFlight > 0 && m_JointCount > 0);
+
+    // Characters without a mesh only need joints, they are left out of the dispatch.
+    std::unordered_map<const SkinnedMesh *, uint32_t> sourceOffsets;
+    std::vector<SkinningSourceVertex> sourceVertices;
+    std::vector<SkinningCharacter> characters;
+
+    for (uint32_t character = 0; character < system.GetCharacterCount(); ++character)
+    {
+        const SkinnedMesh *mesh = system.GetMesh(character);
+        if (mesh == nullptr)
+        {
+            continue;
+        }
+
+        auto source = sourceOffsets.find(mesh);
+        if (source == sourceOffsets.end())
+        {
+            source = sourceOffsets.emplace(mesh, static_cast<uint32_t>(sourceVertices.size())).first;
+            for (uint32_t vertex = 0; vertex < mesh->GetVertexCount(); ++vertex)
+            {
+                SkinningSourceVertex sourceVertex{};
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    sourceVertex.position[axis] = mesh->GetPositions(axis)[vertex];
+                    sourceVertex.normal[axis] = mesh->HasNormals() ? mesh->GetNormals(axis)[vertex] : 0.0f;
+                }
+                for (uint32_t slot = 0; slot < MaxJointInfluences; ++slot)
+                {
+                    sourceVertex.joints[slot] = static_cast<uint32_t>(mesh->GetJoints(slot)[vertex]);
+                    sourceVertex.weights[slot] = mesh->GetWeights(slot)[vertex];
+                }
+                sourceVertices.push_back(sourceVertex);
+            }
+        }
+
+        characters.push_back(SkinningCharacter{ source->second, mesh->GetVertexCount(), system.GetJointOffset(character), system.GetVertexOffset(character) });
+        m_MaxVertexCount = std::max(m_MaxVertexCount, mesh->GetVertexCount());
+    }
+
+    m_CharacterCount = static_cast<uint32_t>(characters.size());
+    assert(m_CharacterCount > 0 && "No character has a skinned mesh.");
+
+    VkDeviceSize sourceSize = sourceVertices.size() * sizeof(SkinningSourceVertex);
+    m_SourceBuffer = std::make_unique<VulkanBuffer>(m_Device, sourceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_SourceBuffer->Update(sourceVertices.data(), sourceSize);
+
+    VkDeviceSize characterSize = characters.size() * sizeof(SkinningCharacter);
+    m_CharacterBuffer = std::make_unique<VulkanBuffer>(m_Device, characterSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_CharacterBuffer->Update(characters.data(), characterSize);
+
+    // Sized for matrices, the dual quaternions take the first two thirds.
+    VkDeviceSize jointSize = static_cast<VkDeviceSize>(m_JointCount) * sizeof(SkinMatrix);
+    for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+    {
+        m_JointBuffers.push_back(std::make_unique<VulkanBuffer>(m_Device, jointSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU));
+    }
+
+    m_OutputBuffer = std::make_unique<VulkanBuffer>(m_Device, static_cast<VkDeviceSize>(std::max(system.GetVertexCount(), 1u)) * OutputStride,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    std::string shaderSource{ g_SkinningShader };
+    std::vector<uint8_t> shaderCode{ shaderSource.begin(), shaderSource.end() };
+    m_LinearBlendShader = std::make_unique<VulkanShader>(m_Device, ComputeShader, "main", shaderCode, std::vector<std::string>{ "DUAL_QUATERNION 0" });
+    m_DualQuaternionShader = std::make_unique<VulkanShader>(m_Device, ComputeShader, "main", shaderCode, std::vector<std::string>{ "DUAL_QUATERNION 1" });
+
+    VkDescriptorSetLayoutBinding bindings[SkinningBindingCount]{};
+    for (uint32_t binding = 0; binding < SkinningBindingCount; ++binding)
+    {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    setLayoutInfo.bindingCount = SkinningBindingCount;
+    setLayoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(m_Device.GetHandle(), &setLayoutInfo, nullptr, &m_DescriptorSetLayout));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+    VK_CHECK(vkCreatePipelineLayout(m_Device.GetHandle(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    const VulkanShader *shaders[2]{ m_LinearBlendShader.get(), m_DualQuaternionShader.get() };
+    VkPipeline *pipelines[2]{ &m_LinearBlendPipeline, &m_DualQuaternionPipeline };
+    for (uint32_t index = 0; index < 2; ++index)
+    {
+        VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shaders[index]->GetHandle();
+        pipelineInfo.stage.pName = shaders[index]->GetEntryPoint().c_str();
+        pipelineInfo.layout = m_PipelineLayout;
+        VK_CHECK(vkCreateComputePipelines(m_Device.GetHandle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, pipelines[index]));
+    }
+
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SkinningBindingCount * framesInFlight };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = framesInFlight;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(m_Device.GetHandle(), &poolInfo, nullptr, &m_DescriptorPool));
+
+    std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, m_DescriptorSetLayout);
+    m_DescriptorSets.resize(framesInFlight);
+
+    VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocateInfo.descriptorPool = m_DescriptorPool;
+    allocateInfo.descriptorSetCount = framesInFlight;
+    allocateInfo.pSetLayouts = setLayouts.data();
+    VK_CHECK(vkAllocateDescriptorSets(m_Device.GetHandle(), &allocateInfo, m_DescriptorSets.data()));
+
+    for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+    {
+        VkDescriptorBufferInfo bufferInfos[SkinningBindingCount]{
+            { m_SourceBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { m_CharacterBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { m_JointBuffers[frame]->GetHandle(), 0, VK_WHOLE_SIZE },
+            { m_OutputBuffer->GetHandle(), 0, VK_WHOLE_SIZE } };
+
+        VkWriteDescriptorSet writes[SkinningBindingCount]{};
+        for (uint32_t binding = 0; binding < SkinningBindingCount; ++binding)
+        {
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = m_DescriptorSets[frame];
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[binding].pBufferInfo = &bufferInfos[binding];
+        }
+        vkUpdateDescriptorSets(m_Device.GetHandle(), SkinningBindingCount, writes, 0, nullptr);
+    }
+}
+
+VulkanSkinning::~VulkanSkinning()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    vkDestroyPipeline(device, m_LinearBlendPipeline, nullptr);
+    vkDestroyPipeline(device, m_DualQuaternionPipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+}
+
+void VulkanSkinning::Upload(uint32_t frame, const AnimationSystem &system, SkinningMethod method)
+{
+    assert(frame < m_JointBuffers.size());
+    assert(system.GetJointCount() == m_JointCount && "Characters were added after the skinning buffers were created.");
+
+    if (method == SkinningMethod::DualQuaternion)
+    {
+        m_JointBuffers[frame]->Update(system.GetDualQuaternions().data(), m_JointCount * sizeof(DualQuaternion));
+    }
+    else
+    {
+        m_JointBuffers[frame]->Update(system.GetSkinMatrices().data(), m_JointCount * sizeof(SkinMatrix));
+    }
+}
+
+void VulkanSkinning::Dispatch(VkCommandBuffer commandBuffer, uint32_t frame, SkinningMethod method)
+{
+    assert(frame < m_DescriptorSets.size());
+
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "Skinning::Dispatch");
+
+    // The previous frame's draws may still read the output this pass rewrites.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, method == SkinningMethod::DualQuaternion ? m_DualQuaternionPipeline : m_LinearBlendPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSets[frame], 0, nullptr);
+
+    // One row of groups per character, groups past a smaller character's vertices return at once.
+    vkCmdDispatch(commandBuffer, (m_MaxVertexCount + SkinningGroupSize - 1) / SkinningGroupSize, m_CharacterCount, 1);
+
+    VkBufferMemoryBarrier barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = m_OutputBuffer->GetHandle();
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+const VulkanBuffer &VulkanSkinning::GetOutputBuffer() const
+{
+    return *m_OutputBuffer;
+}
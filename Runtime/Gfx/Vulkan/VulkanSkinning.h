@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "VulkanBuffer.h"
+#include "VulkanShader.h"
+#include "Animation/Skinning.h"
+#include <memory>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class AnimationSystem;
+
+// Compute skinning of every character of an AnimationSystem, the GPU counterpart of the CPU kernels.
+// Bind pose vertices are uploaded once (characters sharing a SkinnedMesh share them), each frame only
+// uploads the joint array. The output holds position and normal per vertex, 24 bytes, at the
+// character's vertex offset, ready to bind as a vertex buffer.
+class VulkanSkinning : public NonCopyable
+{
+public:
+
+    static constexpr uint32_t OutputStride = 6 * sizeof(float);
+
+    // Buffers are sized for the characters the system holds now, create a new one after adding more.
+    // Joint buffers are per frame in flight so an upload never races the GPU.
+    VulkanSkinning(VulkanDevice &device, const AnimationSystem &system, uint32_t framesInFlight);
+
+    ~VulkanSkinning();
+
+    // Copies the skin matrices, or the dual quaternions, written by the last AnimationSystem::Update()
+    // into the joint buffer of frame.
+    void Upload(uint32_t frame, const AnimationSystem &system, SkinningMethod method);
+
+    // Skins every character with the joints of frame. Must be recorded outside a render pass; the
+    // output is ready for vertex input afterwards.
+    void Dispatch(VkCommandBuffer commandBuffer, uint32_t frame, SkinningMethod method);
+
+    const VulkanBuffer &GetOutputBuffer() const;
+
+private:
+
+    VulkanDevice &m_Device;
+
+    uint32_t m_CharacterCount{ 0 };
+
+    uint32_t m_JointCount{ 0 };
+
+    uint32_t m_MaxVertexCount{ 0 };
+
+    std::unique_ptr<VulkanBuffer> m_SourceBuffer;
+
+    std::unique_ptr<VulkanBuffer> m_CharacterBuffer;
+
+    std::vector<std::unique_ptr<VulkanBuffer>> m_JointBuffers;
+
+    std::unique_ptr<VulkanBuffer> m_OutputBuffer;
+
+    std::unique_ptr<VulkanShader> m_LinearBlendShader;
+
+    std::unique_ptr<VulkanShader> m_DualQuaternionShader;
+
+    VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+
+    VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+
+    std::vector<VkDescriptorSet> m_DescriptorSets;
+
+    VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+
+    VkPipeline m_LinearBlendPipeline{ VK_NULL_HANDLE };
+
+    VkPipeline m_DualQuaternionPipeline{ VK_NULL_HANDLE };
+};
@@ -0,0 +1,526 @@
+#include "VulkanSwapchain.h"
+#include "VulkanDevice.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanQueue.h"
+#include "VulkanRenderPassCache.h"
+#include "VulkanUtils.h"
+#include "Common/Logging.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+// Long enough for any display rate, short enough that a stalled present engine can't hang the frame.
+static constexpr uint64_t PresentWaitTimeout = 100'000'000;
+
+static int64_t GetTicks()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static double GetSecondsSince(int64_t startTicks)
+{
+    return static_cast<double>(GetTicks() - startTicks) * 1e-9;
+}
+
+static const char *GetPresentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode)
+    {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "fifo relaxed";
+    default:
+        return "unknown";
+    }
+}
+
+VulkanSwapchain::VulkanSwapchain(VulkanDevice &device, VkSurfaceKHR surface, VkExtent2D extent, const SwapchainDesc &desc) :
+    m_Device{ device },
+    m_Surface{ surface },
+    m_Desc{ desc },
+    m_RequestedExtent{ extent }
+{
+    assert(surface != VK_NULL_HANDLE);
+    assert(desc.framesInFlight > 0);
+
+    m_Slots.resize(desc.framesInFlight);
+    for (FrameSlot &slot : m_Slots)
+    {
+        // Signalled, the first wait on every slot returns at once.
+        VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        VK_CHECK(vkCreateFence(m_Device.GetHandle(), &fenceInfo, nullptr, &slot.fence));
+
+        VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        VK_CHECK(vkCreateSemaphore(m_Device.GetHandle(), &semaphoreInfo, nullptr, &slot.acquireSemaphore));
+    }
+
+    m_TimingHistory.reserve(TimingHistory);
+    m_StatisticsScratch.reserve(TimingHistory);
+
+    Recreate();
+}
+
+VulkanSwapchain::~VulkanSwapchain()
+{
+    // Teardown only, frames in flight may still reference anything owned here.
+    m_Device.WaitIdle();
+
+    Retire();
+    DestroyRetired(true);
+
+    for (FrameSlot &slot : m_Slots)
+    {
+        vkDestroyFence(m_Device.GetHandle(), slot.fence, nullptr);
+        vkDestroySemaphore(m_Device.GetHandle(), slot.acquireSemaphore, nullptr);
+    }
+}
+
+uint32_t VulkanSwapchain::BeginFrame()
+{
+    if (m_FrameNumber > 0)
+    {
+        RecordTiming();
+    }
+
+    ++m_FrameNumber;
+    m_CurrentSlot = static_cast<uint32_t>(m_FrameNumber % m_Slots.size());
+    FrameSlot &slot = m_Slots[m_CurrentSlot];
+
+    int64_t waitStart = GetTicks();
+    VK_CHECK(vkWaitForFences(m_Device.GetHandle(), 1, &slot.fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK(vkResetFences(m_Device.GetHandle(), 1, &slot.fence));
+    m_CurrentTiming.fenceWaitSeconds = GetSecondsSince(waitStart);
+
+    // Fences signal in submission order, the slot's previous frame is the latest one finished.
+    m_CompletedFrame = std::max(m_CompletedFrame, slot.frameNumber);
+    slot.frameNumber = m_FrameNumber;
+
+    // Waiting for the display rather than the GPU keeps FIFO from queueing whole frames of latency.
+    // Ids before the current swapchain's first present were never given to it.
+    if (m_Device.IsPresentWaitEnabled() && m_Desc.maxPresentLatency > 0 && m_FrameNumber > m_Desc.maxPresentLatency)
+    {
+        uint64_t presentId = m_FrameNumber - m_Desc.maxPresentLatency;
+        if (m_Handle != VK_NULL_HANDLE && m_FirstPresentId != 0 && presentId >= m_FirstPresentId && presentId <= m_LastPresentId)
+        {
+            waitStart = GetTicks();
+            VkResult result = vkWaitForPresentKHR(m_Device.GetHandle(), m_Handle, presentId, PresentWaitTimeout);
+            m_CurrentTiming.presentWaitSeconds = GetSecondsSince(waitStart);
+
+            if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_ERROR_SURFACE_LOST_KHR)
+            {
+                m_NeedsRecreate = true;
+            }
+            else if (result != VK_TIMEOUT)
+            {
+                VK_CHECK(result);
+            }
+        }
+    }
+
+    DestroyRetired(false);
+
+    m_FrameStartTicks = GetTicks();
+    return m_CurrentSlot;
+}
+
+bool VulkanSwapchain::AcquireImage(uint32_t &imageIndex)
+{
+    if (m_NeedsRecreate)
+    {
+        Recreate();
+    }
+
+    if (m_Handle == VK_NULL_HANDLE || m_NeedsRecreate)
+    {
+        ++m_SkippedFrames;
+        return false;
+    }
+
+    int64_t acquireStart = GetTicks();
+    VkResult result = vkAcquireNextImageKHR(m_Device.GetHandle(), m_Handle, UINT64_MAX, m_Slots[m_CurrentSlot].acquireSemaphore, VK_NULL_HANDLE, &imageIndex);
+    m_CurrentTiming.acquireSeconds = GetSecondsSince(acquireStart);
+
+    // Nothing was signalled, the semaphore stays usable for the next attempt.
+    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        Recreate();
+        ++m_SkippedFrames;
+        return false;
+    }
+
+    // Still presentable, recreated after this frame.
+    if (result == VK_SUBOPTIMAL_KHR)
+    {
+        m_NeedsRecreate = true;
+        return true;
+    }
+
+    VK_CHECK(result);
+    return true;
+}
+
+bool VulkanSwapchain::Present(const VulkanQueue &queue, uint32_t imageIndex)
+{
+    assert(imageIndex < m_Images.size());
+
+    VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &m_PresentSemaphores[imageIndex];
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &m_Handle;
+    presentInfo.pImageIndices = &imageIndex;
+
+    VkPresentIdKHR presentId{ VK_STRUCTURE_TYPE_PRESENT_ID_KHR };
+    if (m_Device.IsPresentWaitEnabled())
+    {
+        presentId.swapchainCount = 1;
+        presentId.pPresentIds = &m_FrameNumber;
+        presentInfo.pNext = &presentId;
+
+        m_FirstPresentId = m_FirstPresentId != 0 ? m_FirstPresentId : m_FrameNumber;
+        m_LastPresentId = m_FrameNumber;
+    }
+
+    VkResult result = vkQueuePresentKHR(queue.GetHandle(), &presentInfo);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+    {
+        m_NeedsRecreate = true;
+        return false;
+    }
+
+    VK_CHECK(result);
+    return !m_NeedsRecreate;
+}
+
+void VulkanSwapchain::SkipFrame(const VulkanQueue &queue)
+{
+    VK_CHECK(vkQueueSubmit(queue.GetHandle(), 0, nullptr, m_Slots[m_CurrentSlot].fence));
+}
+
+void VulkanSwapchain::Resize(VkExtent2D extent)
+{
+    if (extent.width != m_RequestedExtent.width || extent.height != m_RequestedExtent.height)
+    {
+        m_RequestedExtent = extent;
+        m_NeedsRecreate = true;
+    }
+}
+
+void VulkanSwapchain::SetPresentMode(VkPresentModeKHR presentMode)
+{
+    m_Desc.presentMode = presentMode;
+    m_NeedsRecreate = true;
+}
+
+VkPresentModeKHR VulkanSwapchain::GetPresentMode() const
+{
+    return m_PresentMode;
+}
+
+void VulkanSwapchain::SetRenderPassCache(VulkanRenderPassCache *cache)
+{
+    m_RenderPassCache = cache;
+}
+
+VkPresentModeKHR VulkanSwapchain::ChoosePresentMode(VkPresentModeKHR requested) const
+{
+    VkPhysicalDevice gpu = m_Device.GetGpu().GetHandle();
+
+    uint32_t modeCount = 0;
+    VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, m_Surface, &modeCount, nullptr));
+    std::vector<VkPresentModeKHR> modes(modeCount);
+    VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, m_Surface, &modeCount, modes.data()));
+
+    auto isSupported = [&modes](VkPresentModeKHR mode) { return std::find(modes.begin(), modes.end(), mode) != modes.end(); };
+
+    if (isSupported(requested))
+    {
+        return requested;
+    }
+
+    // FIFO is the one mode every surface has.
+    VkPresentModeKHR fallback = requested != VK_PRESENT_MODE_MAILBOX_KHR && isSupported(VK_PRESENT_MODE_MAILBOX_KHR) ? VK_PRESENT_MODE_MAILBOX_KHR : VK_PRESENT_MODE_FIFO_KHR;
+    LOGW("Present mode {} not supported, using {}", GetPresentModeName(requested), GetPresentModeName(fallback));
+    return fallback;
+}
+
+void VulkanSwapchain::Recreate()
+{
+    VkPhysicalDevice gpu = m_Device.GetGpu().GetHandle();
+
+    VkSurfaceCapabilitiesKHR capabilities{};
+    VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(gpu, m_Surface, &capabilities));
+
+    VkExtent2D extent = capabilities.currentExtent;
+    if (extent.width == 0xffffffffu)
+    {
+        extent.width = std::clamp(m_RequestedExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+        extent.height = std::clamp(m_RequestedExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+    }
+
+    // Minimised, keep what there is and try again next frame.
+    if (extent.width == 0 || extent.height == 0)
+    {
+        m_NeedsRecreate = true;
+        return;
+    }
+
+    uint32_t formatCount = 0;
+    VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(gpu, m_Surface, &formatCount, nullptr));
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(gpu, m_Surface, &formatCount, formats.data()));
+    assert(!formats.empty());
+
+    VkSurfaceFormatKHR surfaceFormat = formats[0];
+    for (const VkSurfaceFormatKHR &format : formats)
+    {
+        if (format.format == m_Desc.format && format.colorSpace == m_Desc.colorSpace)
+        {
+            surfaceFormat = format;
+            break;
+        }
+    }
+
+    uint32_t imageCount = std::max(m_Desc.imageCount, capabilities.minImageCount);
+    if (capabilities.maxImageCount > 0)
+    {
+        imageCount = std::min(imageCount, capabilities.maxImageCount);
+    }
+
+    VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    if ((capabilities.supportedCompositeAlpha & compositeAlpha) == 0)
+    {
+        compositeAlpha = static_cast<VkCompositeAlphaFlagBitsKHR>(capabilities.supportedCompositeAlpha & ~(capabilities.supportedCompositeAlpha - 1));
+    }
+
+    m_PresentMode = ChoosePresentMode(m_Desc.presentMode);
+
+    // Handing over the old swapchain lets the driver reuse its resources and the old images finish
+    // presenting, no device idle needed.
+    VkSwapchainCreateInfoKHR createInfo{ VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
+    createInfo.surface = m_Surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = m_Desc.imageUsage & capabilities.supportedUsageFlags;
+    createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = compositeAlpha;
+    createInfo.presentMode = m_PresentMode;
+    createInfo.clipped = VK_TRUE;
+    createInfo.oldSwapchain = m_Handle;
+
+    VkSwapchainKHR swapchain{ VK_NULL_HANDLE };
+    VK_CHECK(vkCreateSwapchainKHR(m_Device.GetHandle(), &createInfo, nullptr, &swapchain));
+
+    if (m_Handle != VK_NULL_HANDLE)
+    {
+        ++m_RecreateCount;
+    }
+    Retire();
+
+    m_Handle = swapchain;
+    m_Format = surfaceFormat.format;
+    m_Extent = extent;
+    m_FirstPresentId = 0;
+    m_LastPresentId = 0;
+    m_NeedsRecreate = false;
+
+    VK_CHECK(vkGetSwapchainImagesKHR(m_Device.GetHandle(), m_Handle, &imageCount, nullptr));
+    m_Images.resize(imageCount);
+    VK_CHECK(vkGetSwapchainImagesKHR(m_Device.GetHandle(), m_Handle, &imageCount, m_Images.data()));
+
+    m_ImageViews.resize(imageCount);
+    m_PresentSemaphores.resize(imageCount);
+    for (uint32_t index = 0; index < imageCount; ++index)
+    {
+        VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        viewInfo.image = m_Images[index];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = m_Format;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        VK_CHECK(vkCreateImageView(m_Device.GetHandle(), &viewInfo, nullptr, &m_ImageViews[index]));
+
+        VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        VK_CHECK(vkCreateSemaphore(m_Device.GetHandle(), &semaphoreInfo, nullptr, &m_PresentSemaphores[index]));
+    }
+
+    LOGI("Swapchain {}x{}, {} images, {} present", m_Extent.width, m_Extent.height, imageCount, GetPresentModeName(m_PresentMode));
+}
+
+void VulkanSwapchain::Retire()
+{
+    if (m_Handle == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // Frames up to the current one may have used the images.
+    RetiredSwapchain retired{};
+    retired.swapchain = m_Handle;
+    retired.views = std::move(m_ImageViews);
+    retired.presentSemaphores = std::move(m_PresentSemaphores);
+    retired.lastFrame = m_FrameNumber;
+
+    if (m_RenderPassCache != nullptr)
+    {
+        for (VkImageView view : retired.views)
+        {
+            m_RenderPassCache->ReleaseImageView(view, retired.lastFrame);
+        }
+    }
+
+    m_Retired.push_back(std::move(retired));
+    m_Handle = VK_NULL_HANDLE;
+    m_ImageViews.clear();
+    m_PresentSemaphores.clear();
+    m_Images.clear();
+}
+
+void VulkanSwapchain::DestroyRetired(bool force)
+{
+    VkDevice device = m_Device.GetHandle();
+
+    size_t kept = 0;
+    for (size_t index = 0; index < m_Retired.size(); ++index)
+    {
+        RetiredSwapchain &retired = m_Retired[index];
+
+        // The GPU being done is not enough, the last presents may still wait on their semaphores; a
+        // full round of slots later they have been consumed.
+        if (!force && retired.lastFrame + m_Slots.size() > m_CompletedFrame)
+        {
+            m_Retired[kept++] = std::move(retired);
+            continue;
+        }
+
+        for (VkImageView view : retired.views)
+        {
+            vkDestroyImageView(device, view, nullptr);
+        }
+        for (VkSemaphore semaphore : retired.presentSemaphores)
+        {
+            vkDestroySemaphore(device, semaphore, nullptr);
+        }
+        vkDestroySwapchainKHR(device, retired.swapchain, nullptr);
+    }
+    m_Retired.resize(kept);
+}
+
+void VulkanSwapchain::RecordTiming()
+{
+    m_CurrentTiming.frameSeconds = GetSecondsSince(m_FrameStartTicks);
+    m_LastTiming = m_CurrentTiming;
+    m_CurrentTiming = SwapchainFrameTiming{};
+
+    if (m_TimingHistory.size() < TimingHistory)
+    {
+        m_TimingHistory.push_back(m_LastTiming);
+    }
+    else
+    {
+        m_TimingHistory[m_TimingCursor] = m_LastTiming;
+        m_TimingCursor = (m_TimingCursor + 1) % TimingHistory;
+    }
+}
+
+VkSemaphore VulkanSwapchain::GetAcquireSemaphore() const
+{
+    return m_Slots[m_CurrentSlot].acquireSemaphore;
+}
+
+VkSemaphore VulkanSwapchain::GetPresentSemaphore(uint32_t imageIndex) const
+{
+    assert(imageIndex < m_PresentSemaphores.size());
+    return m_PresentSemaphores[imageIndex];
+}
+
+VkFence VulkanSwapchain::GetFrameFence() const
+{
+    return m_Slots[m_CurrentSlot].fence;
+}
+
+uint64_t VulkanSwapchain::GetFrameNumber() const
+{
+    return m_FrameNumber;
+}
+
+uint64_t VulkanSwapchain::GetCompletedFrame() const
+{
+    return m_CompletedFrame;
+}
+
+VkSwapchainKHR VulkanSwapchain::GetHandle() const
+{
+    return m_Handle;
+}
+
+VkFormat VulkanSwapchain::GetFormat() const
+{
+    return m_Format;
+}
+
+VkExtent2D VulkanSwapchain::GetExtent() const
+{
+    return m_Extent;
+}
+
+uint32_t VulkanSwapchain::GetImageCount() const
+{
+    return static_cast<uint32_t>(m_Images.size());
+}
+
+VkImage VulkanSwapchain::GetImage(uint32_t imageIndex) const
+{
+    assert(imageIndex < m_Images.size());
+    return m_Images[imageIndex];
+}
+
+VkImageView VulkanSwapchain::GetImageView(uint32_t imageIndex) const
+{
+    assert(imageIndex < m_ImageViews.size());
+    return m_ImageViews[imageIndex];
+}
+
+bool VulkanSwapchain::IsPresentWaitEnabled() const
+{
+    return m_Device.IsPresentWaitEnabled();
+}
+
+const SwapchainFrameTiming &VulkanSwapchain::GetLastFrameTiming() const
+{
+    return m_LastTiming;
+}
+
+SwapchainStats VulkanSwapchain::ComputeStats()
+{
+    SwapchainStats stats{};
+    stats.recreateCount = m_RecreateCount;
+    stats.skippedFrames = m_SkippedFrames;
+
+    auto compute = [this](double SwapchainFrameTiming::*member)
+    {
+        m_StatisticsScratch.clear();
+        for (const SwapchainFrameTiming &timing : m_TimingHistory)
+        {
+            m_StatisticsScratch.push_back(timing.*member);
+        }
+        return FrameStatistics::Compute(m_StatisticsScratch);
+    };
+
+    stats.frameSeconds = compute(&SwapchainFrameTiming::frameSeconds);
+    stats.fenceWaitSeconds = compute(&SwapchainFrameTiming::fenceWaitSeconds);
+    stats.presentWaitSeconds = compute(&SwapchainFrameTiming::presentWaitSeconds);
+    stats.acquireSeconds = compute(&SwapchainFrameTiming::acquireSeconds);
+    return stats;
+}
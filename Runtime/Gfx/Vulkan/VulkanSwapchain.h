@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Profiling/FrameStatistics.h"
+#include <cstdint>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class VulkanQueue;
+
+class VulkanRenderPassCache;
+
+struct SwapchainDesc
+{
+    // FIFO never tears and throttles to the display. MAILBOX never tears either but keeps rendering,
+    // replacing queued images, for lower latency at the cost of wasted frames. IMMEDIATE has the lowest
+    // latency and tears. Unsupported modes fall back to MAILBOX, then FIFO.
+    VkPresentModeKHR presentMode{ VK_PRESENT_MODE_FIFO_KHR };
+
+    // Clamped to what the surface allows. MAILBOX needs 3 to ever replace an image.
+    uint32_t imageCount{ 3 };
+
+    // Frames the CPU records ahead of the GPU. Fewer is lower latency, more hides CPU spikes.
+    uint32_t framesInFlight{ 2 };
+
+    // With present wait, BeginFrame() also blocks until frame number - maxPresentLatency has reached the
+    // display, so input is sampled at most this many frames before it shows. 0 only waits for the GPU.
+    uint32_t maxPresentLatency{ 0 };
+
+    // Used when the surface supports it, the first format it reports otherwise.
+    VkFormat format{ VK_FORMAT_B8G8R8A8_SRGB };
+
+    VkColorSpaceKHR colorSpace{ VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+
+    VkImageUsageFlags imageUsage{ VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+};
+
+// Seconds one frame spent in each blocking call.
+struct SwapchainFrameTiming
+{
+    // BeginFrame() to BeginFrame().
+    double frameSeconds{ 0.0 };
+
+    // Waiting for the GPU to finish the frame that used the same slot, GPU bound when large.
+    double fenceWaitSeconds{ 0.0 };
+
+    double presentWaitSeconds{ 0.0 };
+
+    double acquireSeconds{ 0.0 };
+};
+
+struct SwapchainStats
+{
+    FrameStatistics frameSeconds;
+
+    FrameStatistics fenceWaitSeconds;
+
+    FrameStatistics presentWaitSeconds;
+
+    FrameStatistics acquireSeconds;
+
+    uint32_t recreateCount{ 0 };
+
+    // Frames that could not acquire an image, while minimised or right after a resize.
+    uint32_t skippedFrames{ 0 };
+};
+
+// Presents to a surface with a chosen present mode, and owns the per frame synchronisation.
+//
+//     uint32_t slot = swapchain.BeginFrame();            waits for the slot's previous frame
+//     ... simulation, culling, work not writing to the image ...
+//     if (swapchain.AcquireImage(imageIndex))            as late as possible
+//     {
+//         ... record the passes writing GetImage(imageIndex) ...
+//         submit waiting on GetAcquireSemaphore() at COLOR_ATTACHMENT_OUTPUT, signalling
+//         GetPresentSemaphore(imageIndex) and GetFrameFence()
+//         swapchain.Present(queue, imageIndex);
+//     }
+//     else submit the frame's other work with GetFrameFence(), or call SkipFrame()
+//
+// Resize() and out of date surfaces recreate the swapchain from the old one without waiting for the
+// device to idle; the old swapchain and its views are destroyed once the frames that used them are done.
+class VulkanSwapchain : public NonCopyable
+{
+public:
+
+    VulkanSwapchain(VulkanDevice &device, VkSurfaceKHR surface, VkExtent2D extent, const SwapchainDesc &desc = {});
+
+    ~VulkanSwapchain();
+
+    // Starts frame GetFrameNumber() + 1 and returns its slot in [0, framesInFlight).
+    uint32_t BeginFrame();
+
+    // False when no image can be presented this frame: the surface is zero sized, or was out of date and
+    // got recreated, in which case the caller retries next frame.
+    bool AcquireImage(uint32_t &imageIndex);
+
+    // False when the swapchain was recreated, the frame was still shown unless out of date.
+    bool Present(const VulkanQueue &queue, uint32_t imageIndex);
+
+    // Signals the frame fence with an empty submit, for frames that have nothing to submit.
+    void SkipFrame(const VulkanQueue &queue);
+
+    // Recreated at the next AcquireImage().
+    void Resize(VkExtent2D extent);
+
+    // Takes effect at the next recreate, which this forces.
+    void SetPresentMode(VkPresentModeKHR presentMode);
+
+    VkPresentModeKHR GetPresentMode() const;
+
+    // Views of retired swapchains are released from cache with the frame they were last used in.
+    void SetRenderPassCache(VulkanRenderPassCache *cache);
+
+    VkSemaphore GetAcquireSemaphore() const;
+
+    VkSemaphore GetPresentSemaphore(uint32_t imageIndex) const;
+
+    VkFence GetFrameFence() const;
+
+    uint64_t GetFrameNumber() const;
+
+    // Latest frame the GPU has finished.
+    uint64_t GetCompletedFrame() const;
+
+    VkSwapchainKHR GetHandle() const;
+
+    VkFormat GetFormat() const;
+
+    VkExtent2D GetExtent() const;
+
+    uint32_t GetImageCount() const;
+
+    VkImage GetImage(uint32_t imageIndex) const;
+
+    VkImageView GetImageView(uint32_t imageIndex) const;
+
+    bool IsPresentWaitEnabled() const;
+
+    // Timing of the last finished frame.
+    const SwapchainFrameTiming &GetLastFrameTiming() const;
+
+    // Distribution over the last TimingHistory frames.
+    SwapchainStats ComputeStats();
+
+    static constexpr uint32_t TimingHistory = 240;
+
+private:
+
+    struct FrameSlot
+    {
+        VkFence fence{ VK_NULL_HANDLE };
+
+        VkSemaphore acquireSemaphore{ VK_NULL_HANDLE };
+
+        uint64_t frameNumber{ 0 };
+    };
+
+    struct RetiredSwapchain
+    {
+        VkSwapchainKHR swapchain{ VK_NULL_HANDLE };
+
+        std::vector<VkImageView> views;
+
+        std::vector<VkSemaphore> presentSemaphores;
+
+        // Destroyed once this frame has completed.
+        uint64_t lastFrame{ 0 };
+    };
+
+    void Recreate();
+
+    void Retire();
+
+    void DestroyRetired(bool force);
+
+    VkPresentModeKHR ChoosePresentMode(VkPresentModeKHR requested) const;
+
+    void RecordTiming();
+
+    VulkanDevice &m_Device;
+
+    VkSurfaceKHR m_Surface{ VK_NULL_HANDLE };
+
+    SwapchainDesc m_Desc{};
+
+    VkExtent2D m_RequestedExtent{ 0, 0 };
+
+    VkSwapchainKHR m_Handle{ VK_NULL_HANDLE };
+
+    VkFormat m_Format{ VK_FORMAT_UNDEFINED };
+
+    VkExtent2D m_Extent{ 0, 0 };
+
+    VkPresentModeKHR m_PresentMode{ VK_PRESENT_MODE_FIFO_KHR };
+
+    std::vector<VkImage> m_Images;
+
+    std::vector<VkImageView> m_ImageViews;
+
+    // One per image: a semaphore can only be signalled again once the present waiting on it is done,
+    // which is known when its image is acquired again.
+    std::vector<VkSemaphore> m_PresentSemaphores;
+
+    std::vector<FrameSlot> m_Slots;
+
+    uint32_t m_CurrentSlot{ 0 };
+
+    uint64_t m_FrameNumber{ 0 };
+
+    uint64_t m_CompletedFrame{ 0 };
+
+    bool m_NeedsRecreate{ false };
+
+    // Present ids are frame numbers; the first one presented with the current swapchain and the last.
+    uint64_t m_FirstPresentId{ 0 };
+
+    uint64_t m_LastPresentId{ 0 };
+
+    std::vector<RetiredSwapchain> m_Retired;
+
+    VulkanRenderPassCache *m_RenderPassCache{ nullptr };
+
+    int64_t m_FrameStartTicks{ 0 };
+
+    SwapchainFrameTiming m_CurrentTiming{};
+
+    SwapchainFrameTiming m_LastTiming{};
+
+    std::vector<SwapchainFrameTiming> m_TimingHistory;
+
+    uint32_t m_TimingCursor{ 0 };
+
+    std::vector<double> m_StatisticsScratch;
+
+    uint32_t m_RecreateCount{ 0 };
+
+    uint32_t m_SkippedFrames{ 0 };
+};
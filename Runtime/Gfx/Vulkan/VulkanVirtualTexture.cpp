@@ -0,0 +1,355 @@
+#include "VulkanVirtualTexture.h"
+#include "VulkanDevice.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanUtils.h"
+#include "Render/VirtualTexture.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+static const char *g_VirtualTextureShaderSource = R"(
+layout(std430, set = VIRTUAL_TEXTURE_SET, binding = 0) readonly buffer VirtualTextureInfo
+{
+    // width, height, page size, page border
+    uvec4 vtSize;
+    // padded page size, physical width, physical height, mip count
+    uvec4 vtPhysical;
+    // entry count, lane of the tile that writes this frame, tiles per row
+    uvec4 vtFeedback;
+    uint vtPageTableOffsets[16];
+    uint vtPagesX[16];
+};
+
+layout(std430, set = VIRTUAL_TEXTURE_SET, binding = 1) readonly buffer VirtualTexturePageTable
+{
+    uint vtPageTable[];
+};
+
+layout(set = VIRTUAL_TEXTURE_SET, binding = 2) uniform sampler2D vtPhysicalTexture;
+
+layout(std430, set = VIRTUAL_TEXTURE_SET, binding = 3) writeonly buffer VirtualTextureFeedback
+{
+    uint vtFeedbackEntries[];
+};
+
+uint VirtualTextureMip(vec2 uv)
+{
+    vec2 texels = uv * vec2(vtSize.xy);
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1.0));
+    return min(uint(lod), vtPhysical.w - 1);
+}
+
+uvec2 VirtualTexturePage(vec2 uv, uint mip)
+{
+    uvec2 mipSize = max(vtSize.xy >> mip, uvec2(1));
+    uvec2 pages = (mipSize + vtSize.z - 1) / vtSize.z;
+    return min(uvec2(clamp(uv, 0.0, 1.0) * vec2(mipSize)) / vtSize.z, pages - 1);
+}
+
+vec4 VirtualTextureSample(vec2 uv)
+{
+    uint mip = VirtualTextureMip(uv);
+    uvec2 page = VirtualTexturePage(uv, mip);
+    uint entry = vtPageTable[vtPageTableOffsets[mip] + page.y * vtPagesX[mip] + page.x];
+
+    // The entry may show a coarser page, position uv within that one.
+    uint mappedMip = entry >> 24;
+    uvec2 slot = uvec2(entry & 0xfffu, (entry >> 12) & 0xfffu);
+    vec2 mappedTexels = clamp(uv, 0.0, 1.0) * vec2(max(vtSize.xy >> mappedMip, uvec2(1)));
+    vec2 inPage = mappedTexels - vec2(VirtualTexturePage(uv, mappedMip) * vtSize.z);
+
+    vec2 texel = vec2(slot * vtPhysical.x) + float(vtSize.w) + inPage;
+    return textureLod(vtPhysicalTexture, texel / vec2(vtPhysical.yz), 0.0);
+}
+
+void VirtualTextureFeedback(vec2 uv)
+{
+    uint mip = VirtualTextureMip(uv);
+    uvec2 pixel = uvec2(gl_FragCoord.xy);
+    if ((pixel.x & 7u) + (pixel.y & 7u) * 8u != vtFeedback.y)
+    {
+        return;
+    }
+
+    uint index = (pixel.y >> 3) * vtFeedback.z + (pixel.x >> 3);
+    if (index < vtFeedback.x)
+    {
+        uvec2 page = VirtualTexturePage(uv, mip);
+        vtFeedbackEntries[index] = (mip << 28) | (page.y << 14) | page.x;
+    }
+}
+)";
+
+static constexpr uint32_t VirtualTextureBindingCount = 4;
+
+// Matches VirtualTextureInfo.
+struct VirtualTextureGpuInfo
+{
+    glm::uvec4 size;
+
+    glm::uvec4 physical;
+
+    glm::uvec4 feedback;
+
+    uint32_t pageTableOffsets[MaxVirtualTextureMips];
+
+    uint32_t pagesX[MaxVirtualTextureMips];
+};
+
+VulkanVirtualTexture::VulkanVirtualTexture(VulkanDevice &device, const VirtualTexture &texture, uint32_t framesInFlight, VkExtent2D feedbackExtent, VkFormat format) :
+    m_Device{ device },
+    m_PageBytes{ texture.GetPageBytes() },
+    m_PaddedPageSize{ texture.GetPaddedPageSize() },
+    m_MaxUploads{ texture.GetDesc().maxUploadsPerFrame }
+{
+    assert(framesInFlight > 0);
+
+    const VirtualTextureDesc &desc = texture.GetDesc();
+
+    m_FeedbackTilesX = (feedbackExtent.width + 7) / 8;
+    m_FeedbackCount = m_FeedbackTilesX * ((feedbackExtent.height + 7) / 8);
+
+    VkExtent2D physicalExtent{ desc.physicalPagesX * m_PaddedPageSize, desc.physicalPagesY * m_PaddedPageSize };
+    m_PhysicalTexture = std::make_unique<VulkanImage>(m_Device, physicalExtent, format,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    VkDeviceSize pageTableSize = texture.GetPageTable().size() * sizeof(uint32_t);
+    m_PageTableBuffer = std::make_unique<VulkanBuffer>(m_Device, pageTableSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    // Pages carry their own border, so filtering stays inside the slot without any wrapping.
+    VkSamplerCreateInfo samplerInfo{ VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    VK_CHECK(vkCreateSampler(m_Device.GetHandle(), &samplerInfo, nullptr, &m_Sampler));
+
+    VkDescriptorSetLayoutBinding bindings[VirtualTextureBindingCount]{};
+    for (uint32_t binding = 0; binding < VirtualTextureBindingCount; ++binding)
+    {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = binding == 2 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    setLayoutInfo.bindingCount = VirtualTextureBindingCount;
+    setLayoutInfo.pBindings = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(m_Device.GetHandle(), &setLayoutInfo, nullptr, &m_DescriptorSetLayout));
+
+    VkDescriptorPoolSize poolSizes[2]{
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * framesInFlight },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight } };
+
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.maxSets = framesInFlight;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    VK_CHECK(vkCreateDescriptorPool(m_Device.GetHandle(), &poolInfo, nullptr, &m_DescriptorPool));
+
+    VirtualTextureGpuInfo info{};
+    info.size = glm::uvec4{ desc.width, desc.height, desc.pageSize, desc.pageBorder };
+    info.physical = glm::uvec4{ m_PaddedPageSize, physicalExtent.width, physicalExtent.height, texture.GetMipCount() };
+    info.feedback = glm::uvec4{ m_FeedbackCount, 0, m_FeedbackTilesX, 0 };
+    for (uint32_t mip = 0; mip < texture.GetMipCount(); ++mip)
+    {
+        info.pageTableOffsets[mip] = texture.GetPageTableOffset(mip);
+        info.pagesX[mip] = texture.GetPagesX(mip);
+    }
+
+    m_Frames.resize(framesInFlight);
+    for (FrameResources &frame : m_Frames)
+    {
+        frame.infoBuffer = std::make_unique<VulkanBuffer>(m_Device, sizeof(VirtualTextureGpuInfo), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+        frame.infoBuffer->Update(&info, sizeof(info));
+
+        frame.feedbackBuffer = std::make_unique<VulkanBuffer>(m_Device, m_FeedbackCount * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+        std::memset(frame.feedbackBuffer->GetMappedData(), 0xff, m_FeedbackCount * sizeof(uint32_t));
+
+        frame.stagingBuffer = std::make_unique<VulkanBuffer>(m_Device, static_cast<VkDeviceSize>(m_MaxUploads) * m_PageBytes + pageTableSize,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+        VkDescriptorSetAllocateInfo allocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocateInfo.descriptorPool = m_DescriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+        VK_CHECK(vkAllocateDescriptorSets(m_Device.GetHandle(), &allocateInfo, &frame.descriptorSet));
+
+        VkDescriptorBufferInfo bufferInfos[3]{
+            { frame.infoBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { m_PageTableBuffer->GetHandle(), 0, VK_WHOLE_SIZE },
+            { frame.feedbackBuffer->GetHandle(), 0, VK_WHOLE_SIZE } };
+        VkDescriptorImageInfo imageInfo{ m_Sampler, m_PhysicalTexture->GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+        VkWriteDescriptorSet writes[VirtualTextureBindingCount]{};
+        for (uint32_t binding = 0; binding < VirtualTextureBindingCount; ++binding)
+        {
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = frame.descriptorSet;
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = bindings[binding].descriptorType;
+        }
+        writes[0].pBufferInfo = &bufferInfos[0];
+        writes[1].pBufferInfo = &bufferInfos[1];
+        writes[2].pImageInfo = &imageInfo;
+        writes[3].pBufferInfo = &bufferInfos[2];
+        vkUpdateDescriptorSets(m_Device.GetHandle(), VirtualTextureBindingCount, writes, 0, nullptr);
+    }
+}
+
+VulkanVirtualTexture::~VulkanVirtualTexture()
+{
+    VkDevice device = m_Device.GetHandle();
+
+    vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+    vkDestroySampler(device, m_Sampler, nullptr);
+}
+
+const uint32_t *VulkanVirtualTexture::ReadFeedback(uint32_t frame)
+{
+    assert(frame < m_Frames.size());
+
+    VulkanBuffer &feedbackBuffer = *m_Frames[frame].feedbackBuffer;
+    feedbackBuffer.Invalidate();
+    return reinterpret_cast<const uint32_t *>(feedbackBuffer.GetMappedData());
+}
+
+uint32_t VulkanVirtualTexture::GetFeedbackCount() const
+{
+    return m_FeedbackCount;
+}
+
+void VulkanVirtualTexture::Upload(VkCommandBuffer commandBuffer, uint32_t frame, VirtualTexture &texture)
+{
+    assert(frame < m_Frames.size());
+
+    GPU_PROFILE_SCOPE_STATISTICS(m_Device.GetGpuProfiler(), commandBuffer, "VirtualTexture::Upload");
+
+    FrameResources &resources = m_Frames[frame];
+    std::vector<VirtualPageUpload> &uploads = texture.GetUploads();
+    assert(uploads.size() <= m_MaxUploads && "VirtualTexture maps at most maxUploadsPerFrame pages between uploads.");
+
+    // A different pixel of every tile reports each frame, over 64 frames the whole tile is covered.
+    m_FeedbackLane = (m_FeedbackLane + 1) % 64;
+    resources.infoBuffer->Update(&m_FeedbackLane, sizeof(uint32_t), offsetof(VirtualTextureGpuInfo, feedback) + sizeof(uint32_t));
+
+    // Earlier frames still sampling the cache and the page table, and the previous readback of this
+    // frame's feedback, must be done before they are rewritten.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vkCmdFillBuffer(commandBuffer, resources.feedbackBuffer->GetHandle(), 0, VK_WHOLE_SIZE, InvalidVirtualPage);
+
+    std::vector<VkBufferImageCopy> copies;
+    copies.reserve(uploads.size());
+    for (size_t index = 0; index < uploads.size(); ++index)
+    {
+        VkDeviceSize offset = index * m_PageBytes;
+        resources.stagingBuffer->Update(uploads[index].data.data(), m_PageBytes, offset);
+
+        VkBufferImageCopy copy{};
+        copy.bufferOffset = offset;
+        copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        copy.imageOffset = { static_cast<int32_t>(uploads[index].slotX * m_PaddedPageSize), static_cast<int32_t>(uploads[index].slotY * m_PaddedPageSize), 0 };
+        copy.imageExtent = { m_PaddedPageSize, m_PaddedPageSize, 1 };
+        copies.push_back(copy);
+    }
+
+    uint32_t dirtyBegin = texture.GetDirtyBegin();
+    uint32_t dirtyEnd = texture.GetDirtyEnd();
+    VkDeviceSize pageTableOffset = static_cast<VkDeviceSize>(m_MaxUploads) * m_PageBytes;
+    if (dirtyBegin < dirtyEnd)
+    {
+        VkDeviceSize size = (dirtyEnd - dirtyBegin) * sizeof(uint32_t);
+        resources.stagingBuffer->Update(&texture.GetPageTable()[dirtyBegin], size, pageTableOffset);
+
+        VkBufferCopy copy{ pageTableOffset, dirtyBegin * sizeof(uint32_t), size };
+        vkCmdCopyBuffer(commandBuffer, resources.stagingBuffer->GetHandle(), m_PageTableBuffer->GetHandle(), 1, &copy);
+    }
+
+    if (!copies.empty() || !m_PhysicalTextureReady)
+    {
+        VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = m_PhysicalTextureReady ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_PhysicalTexture->GetHandle();
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        // Slots are sampled as soon as the root page's table entries exist, black until it arrives.
+        if (!m_PhysicalTextureReady)
+        {
+            VkClearColorValue black{};
+            vkCmdClearColorImage(commandBuffer, m_PhysicalTexture->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &black, 1, &barrier.subresourceRange);
+            m_PhysicalTextureReady = true;
+        }
+
+        if (!copies.empty())
+        {
+            vkCmdCopyBufferToImage(commandBuffer, resources.stagingBuffer->GetHandle(), m_PhysicalTexture->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<uint32_t>(copies.size()), copies.data());
+        }
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    VkMemoryBarrier memoryBarrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    texture.ClearUploads();
+    texture.ClearDirtyRange();
+}
+
+void VulkanVirtualTexture::FinishFeedback(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    assert(frame < m_Frames.size());
+
+    VkBufferMemoryBarrier barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = m_Frames[frame].feedbackBuffer->GetHandle();
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+VkDescriptorSetLayout VulkanVirtualTexture::GetDescriptorSetLayout() const
+{
+    return m_DescriptorSetLayout;
+}
+
+VkDescriptorSet VulkanVirtualTexture::GetDescriptorSet(uint32_t frame) const
+{
+    assert(frame < m_Frames.size());
+    return m_Frames[frame].descriptorSet;
+}
+
+const VulkanImage &VulkanVirtualTexture::GetPhysicalTexture() const
+{
+    return *m_PhysicalTexture;
+}
+
+const char *VulkanVirtualTexture::GetShaderSource()
+{
+    return g_VirtualTextureShaderSource;
+}
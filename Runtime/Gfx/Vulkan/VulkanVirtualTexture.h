@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include <memory>
+#include <vector>
+#include <volk.h>
+
+class VulkanDevice;
+
+class VirtualTexture;
+
+// GPU side of a VirtualTexture: the physical page cache texture, the page table and a feedback buffer
+// per frame in flight. Shaders sampling the texture include GetShaderSource() and bind one set:
+//
+//     binding 0  info, sizes, page table offsets and the feedback lane of the frame
+//     binding 1  uint pageTable[]            see VirtualPageEntry
+//     binding 2  sampler2D physicalTexture
+//     binding 3  uint feedback[]             one page id per 8x8 pixel tile, see VirtualPage
+//
+// The feedback is written by the passes that sample the texture, one pixel of every tile per frame
+// with the pixel cycling over the tile, and read back once the frame's fence has signalled:
+//
+//     texture.Update(frame, gpu.ReadFeedback(index), gpu.GetFeedbackCount());
+//     gpu.Upload(cmd, index, texture);
+//     ... passes sampling the texture ...
+//     gpu.FinishFeedback(cmd, index);
+class VulkanVirtualTexture : public NonCopyable
+{
+public:
+
+    // feedbackExtent is the framebuffer size of the passes writing feedback.
+    VulkanVirtualTexture(VulkanDevice &device, const VirtualTexture &texture, uint32_t framesInFlight, VkExtent2D feedbackExtent, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+
+    ~VulkanVirtualTexture();
+
+    // Feedback the GPU wrote the last time frame was recorded, InvalidVirtualPage before that. Only
+    // valid once the fence of that submission has signalled.
+    const uint32_t *ReadFeedback(uint32_t frame);
+
+    uint32_t GetFeedbackCount() const;
+
+    // Copies the pages mapped since the last call and the dirty page table range, then clears both on
+    // texture, and resets the feedback of frame. Must be recorded outside a render pass.
+    void Upload(VkCommandBuffer commandBuffer, uint32_t frame, VirtualTexture &texture);
+
+    // Makes the feedback written by the passes since Upload() visible to ReadFeedback().
+    void FinishFeedback(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    VkDescriptorSetLayout GetDescriptorSetLayout() const;
+
+    VkDescriptorSet GetDescriptorSet(uint32_t frame) const;
+
+    const VulkanImage &GetPhysicalTexture() const;
+
+    // GLSL functions for the shaders, expects VIRTUAL_TEXTURE_SET to be defined to the set index:
+    //
+    //     vec4 VirtualTextureSample(vec2 uv)
+    //     void VirtualTextureFeedback(vec2 uv)    call from uniform control flow
+    static const char *GetShaderSource();
+
+private:
+
+    struct FrameResources
+    {
+        std::unique_ptr<VulkanBuffer> infoBuffer;
+
+        std::unique_ptr<VulkanBuffer> feedbackBuffer;
+
+        std::unique_ptr<VulkanBuffer> stagingBuffer;
+
+        VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+    };
+
+    VulkanDevice &m_Device;
+
+    uint32_t m_FeedbackCount{ 0 };
+
+    uint32_t m_FeedbackTilesX{ 0 };
+
+    uint32_t m_PageBytes{ 0 };
+
+    uint32_t m_PaddedPageSize{ 0 };
+
+    uint32_t m_MaxUploads{ 0 };
+
+    uint32_t m_FeedbackLane{ 0 };
+
+    bool m_PhysicalTextureReady{ false };
+
+    std::vector<FrameResources> m_Frames;
+
+    std::unique_ptr<VulkanBuffer> m_PageTableBuffer;
+
+    std::unique_ptr<VulkanImage> m_PhysicalTexture;
+
+    VkSampler m_Sampler{ VK_NULL_HANDLE };
+
+    VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+
+    VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+};
@@ -0,0 +1,219 @@
+#include "AsyncFileReader.h"
+#include "FileHandle.h"
+#include "Common/Logging.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(NEXT_RENDER_IO_URING)
+#include <liburing.h>
+
+static constexpr uint64_t MaxReadChunk = 1ull << 30;
+#endif
+
+struct AsyncFileReader::Ring
+{
+#if defined(NEXT_RENDER_IO_URING)
+    io_uring ring{};
+
+    uint32_t pendingSubmits{ 0 };
+#endif
+};
+
+AsyncFileReader::AsyncFileReader(uint32_t queueDepth, bool useIoUring) :
+    m_QueueDepth{ queueDepth }
+{
+    assert(queueDepth > 0);
+
+    m_Slots.resize(queueDepth);
+    m_FreeSlots.reserve(queueDepth);
+    for (uint32_t slot = queueDepth; slot > 0; --slot)
+    {
+        m_FreeSlots.push_back(slot - 1);
+    }
+
+#if defined(NEXT_RENDER_IO_URING)
+    if (useIoUring)
+    {
+        auto ring = std::make_unique<Ring>();
+        int result = io_uring_queue_init(queueDepth, &ring->ring, 0);
+        if (result == 0)
+        {
+            m_Ring = std::move(ring);
+        }
+        else
+        {
+            LOGW("io_uring is not available ({}), falling back to pread", strerror(-result));
+        }
+    }
+#else
+    (void)useIoUring;
+#endif
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    // Reads still owned by the kernel write into caller memory, drain them before going away.
+    std::vector<FileReadResult> results;
+    while (m_InFlightCount > 0)
+    {
+        Poll(results, true);
+    }
+
+#if defined(NEXT_RENDER_IO_URING)
+    if (m_Ring)
+    {
+        io_uring_queue_exit(&m_Ring->ring);
+    }
+#endif
+}
+
+bool AsyncFileReader::IsUsingIoUring() const
+{
+    return m_Ring != nullptr;
+}
+
+uint32_t AsyncFileReader::GetQueueDepth() const
+{
+    return m_QueueDepth;
+}
+
+uint32_t AsyncFileReader::GetInFlightCount() const
+{
+    return m_InFlightCount;
+}
+
+bool AsyncFileReader::CanSubmit() const
+{
+    return !m_FreeSlots.empty();
+}
+
+bool AsyncFileReader::Submit(const FileReadRequest &request)
+{
+    assert(request.file != nullptr && request.file->IsOpen());
+    assert(request.destination != nullptr || request.size == 0);
+
+    if (!IsUsingIoUring())
+    {
+        FileReadResult result{};
+        result.userData = request.userData;
+        result.bytesRead = request.file->Read(request.offset, request.size, request.destination);
+        m_Completed.push_back(result);
+        return true;
+    }
+
+    if (m_FreeSlots.empty())
+    {
+        return false;
+    }
+
+    uint32_t slot = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+
+    InFlightRead &read = m_Slots[slot];
+    read.request = request;
+    read.bytesDone = 0;
+    read.used = true;
+
+    ++m_InFlightCount;
+    QueueRead(slot);
+
+    return true;
+}
+
+void AsyncFileReader::QueueRead(uint32_t slot)
+{
+#if defined(NEXT_RENDER_IO_URING)
+    InFlightRead &read = m_Slots[slot];
+
+    io_uring_sqe *sqe = io_uring_get_sqe(&m_Ring->ring);
+    if (sqe == nullptr)
+    {
+        // Submission ring is full, push what we have to the kernel and retry.
+        io_uring_submit(&m_Ring->ring);
+        m_Ring->pendingSubmits = 0;
+        sqe = io_uring_get_sqe(&m_Ring->ring);
+    }
+    assert(sqe != nullptr);
+
+    uint8_t *destination = static_cast<uint8_t *>(read.request.destination) + read.bytesDone;
+    uint64_t remaining = read.request.size - read.bytesDone;
+
+    // The length is 32 bits and a completion reports at most INT32_MAX bytes, larger reads continue
+    // as short reads.
+    unsigned length = static_cast<unsigned>(std::min<uint64_t>(remaining, MaxReadChunk));
+
+    io_uring_prep_read(sqe, static_cast<int>(read.request.file->GetNativeHandle()), destination, length, read.request.offset + read.bytesDone);
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(static_cast<uintptr_t>(slot)));
+
+    ++m_Ring->pendingSubmits;
+#else
+    (void)slot;
+#endif
+}
+
+uint32_t AsyncFileReader::Poll(std::vector<FileReadResult> &results, bool wait)
+{
+    uint32_t completedCount = static_cast<uint32_t>(m_Completed.size());
+
+    results.insert(results.end(), m_Completed.begin(), m_Completed.end());
+    m_Completed.clear();
+
+#if defined(NEXT_RENDER_IO_URING)
+    if (!m_Ring)
+    {
+        return completedCount;
+    }
+
+    if (m_Ring->pendingSubmits > 0)
+    {
+        io_uring_submit(&m_Ring->ring);
+        m_Ring->pendingSubmits = 0;
+    }
+
+    bool shouldWait = wait && completedCount == 0;
+
+    while (m_InFlightCount > 0)
+    {
+        io_uring_cqe *cqe = nullptr;
+        int result = shouldWait ? io_uring_wait_cqe(&m_Ring->ring, &cqe) : io_uring_peek_cqe(&m_Ring->ring, &cqe);
+        if (result != 0 || cqe == nullptr)
+        {
+            break;
+        }
+
+        uint32_t slot = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+        int32_t bytes = cqe->res;
+        io_uring_cqe_seen(&m_Ring->ring, cqe);
+
+        InFlightRead &read = m_Slots[slot];
+        assert(read.used);
+
+        if (bytes > 0 && read.bytesDone + bytes < read.request.size)
+        {
+            // Short read, queue the remainder in the same slot.
+            read.bytesDone += bytes;
+            QueueRead(slot);
+            io_uring_submit(&m_Ring->ring);
+            m_Ring->pendingSubmits = 0;
+            continue;
+        }
+
+        FileReadResult completed{};
+        completed.userData = read.request.userData;
+        completed.bytesRead = bytes < 0 ? -1 : static_cast<int64_t>(read.bytesDone + bytes);
+        results.push_back(completed);
+
+        read.used = false;
+        m_FreeSlots.push_back(slot);
+        --m_InFlightCount;
+        ++completedCount;
+
+        shouldWait = false;
+    }
+#else
+    (void)wait;
+#endif
+
+    return completedCount;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class FileHandle;
+
+struct FileReadRequest
+{
+    const FileHandle *file{ nullptr };
+
+    uint64_t offset{ 0 };
+
+    uint64_t size{ 0 };
+
+    void *destination{ nullptr };
+
+    uint64_t userData{ 0 };
+};
+
+struct FileReadResult
+{
+    uint64_t userData{ 0 };
+
+    // Bytes read, or -1 when the read failed.
+    int64_t bytesRead{ -1 };
+};
+
+// Positional read queue. Uses io_uring when built with NEXT_RENDER_IO_URING and the kernel supports it,
+// otherwise every request is served by a blocking pread() at submission time. useIoUring false forces
+// the pread() path.
+class AsyncFileReader : public NonCopyable
+{
+public:
+
+    explicit AsyncFileReader(uint32_t queueDepth = 64, bool useIoUring = true);
+
+    ~AsyncFileReader();
+
+    bool IsUsingIoUring() const;
+
+    uint32_t GetQueueDepth() const;
+
+    uint32_t GetInFlightCount() const;
+
+    bool CanSubmit() const;
+
+    bool Submit(const FileReadRequest &request);
+
+    // Collects finished reads; blocks until at least one completes when wait is set and reads are in flight.
+    uint32_t Poll(std::vector<FileReadResult> &results, bool wait);
+
+private:
+
+    struct InFlightRead
+    {
+        FileReadRequest request{};
+
+        uint64_t bytesDone{ 0 };
+
+        bool used{ false };
+    };
+
+    void QueueRead(uint32_t slot);
+
+    uint32_t m_QueueDepth{ 0 };
+
+    uint32_t m_InFlightCount{ 0 };
+
+    std::vector<InFlightRead> m_Slots;
+
+    std::vector<uint32_t> m_FreeSlots;
+
+    std::vector<FileReadResult> m_Completed;
+
+    // Defined next to the io_uring code so liburing.h stays out of this header, nullptr on the pread() path.
+    struct Ring;
+
+    std::unique_ptr<Ring> m_Ring;
+};
@@ -0,0 +1,134 @@
+#include "FileHandle.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+FileHandle::~FileHandle()
+{
+    Close();
+}
+
+bool FileHandle::Open(const std::string &path)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(handle, &size);
+
+    m_Handle = reinterpret_cast<intptr_t>(handle);
+    m_Size = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_Handle = fd;
+    m_Size = static_cast<uint64_t>(status.st_size);
+#endif
+
+    m_Path = path;
+    return true;
+}
+
+void FileHandle::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    CloseHandle(reinterpret_cast<HANDLE>(m_Handle));
+#else
+    close(static_cast<int>(m_Handle));
+#endif
+
+    m_Handle = -1;
+    m_Size = 0;
+    m_Path.clear();
+}
+
+bool FileHandle::IsOpen() const
+{
+    return m_Handle != -1;
+}
+
+uint64_t FileHandle::GetSize() const
+{
+    return m_Size;
+}
+
+int64_t FileHandle::Read(uint64_t offset, uint64_t size, void *destination) const
+{
+    uint8_t *cursor = static_cast<uint8_t *>(destination);
+    uint64_t remaining = size;
+
+    while (remaining > 0)
+    {
+#if defined(_WIN32)
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD chunk = static_cast<DWORD>(std::min<uint64_t>(remaining, 1u << 30));
+        DWORD bytesRead = 0;
+        if (!ReadFile(reinterpret_cast<HANDLE>(m_Handle), cursor, chunk, &bytesRead, &overlapped))
+        {
+            return -1;
+        }
+#else
+        ssize_t bytesRead = pread(static_cast<int>(m_Handle), cursor, remaining, static_cast<off_t>(offset));
+        if (bytesRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+#endif
+        if (bytesRead == 0)
+        {
+            break;
+        }
+
+        cursor += bytesRead;
+        offset += bytesRead;
+        remaining -= bytesRead;
+    }
+
+    return static_cast<int64_t>(size - remaining);
+}
+
+intptr_t FileHandle::GetNativeHandle() const
+{
+    return m_Handle;
+}
+
+const std::string &FileHandle::GetPath() const
+{
+    return m_Path;
+}
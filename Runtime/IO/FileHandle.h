@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <string>
+#include <cstdint>
+
+// Thin wrapper over a native read-only file descriptor supporting positional reads.
+class FileHandle : public NonCopyable
+{
+public:
+
+    FileHandle() = default;
+
+    ~FileHandle();
+
+    bool Open(const std::string &path);
+
+    void Close();
+
+    bool IsOpen() const;
+
+    uint64_t GetSize() const;
+
+    // Blocking positional read, returns the number of bytes read or -1 on error.
+    int64_t Read(uint64_t offset, uint64_t size, void *destination) const;
+
+    intptr_t GetNativeHandle() const;
+
+    const std::string &GetPath() const;
+
+private:
+
+    intptr_t m_Handle{ -1 };
+
+    uint64_t m_Size{ 0 };
+
+    std::string m_Path{};
+};
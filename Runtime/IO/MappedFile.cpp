@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string &path)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file, &size);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_Data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_Data == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_File = file;
+    m_Mapping = mapping;
+    m_Size = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || status.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    madvise(data, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+
+    m_Data = static_cast<const uint8_t *>(data);
+    m_Size = static_cast<uint64_t>(status.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data == nullptr)
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_Mapping);
+    CloseHandle(m_File);
+    m_Mapping = nullptr;
+    m_File = nullptr;
+#else
+    munmap(const_cast<uint8_t *>(m_Data), static_cast<size_t>(m_Size));
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+    return m_Data != nullptr;
+}
+
+const uint8_t *MappedFile::GetData() const
+{
+    return m_Data;
+}
+
+uint64_t MappedFile::GetSize() const
+{
+    return m_Size;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <string>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file. The view stays valid until Close() or destruction.
+class MappedFile : public NonCopyable
+{
+public:
+
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    bool Open(const std::string &path);
+
+    void Close();
+
+    bool IsOpen() const;
+
+    const uint8_t *GetData() const;
+
+    uint64_t GetSize() const;
+
+private:
+
+    const uint8_t *m_Data{ nullptr };
+
+    uint64_t m_Size{ 0 };
+
+#if defined(_WIN32)
+    void *m_File{ nullptr };
+
+    void *m_Mapping{ nullptr };
+#endif
+};
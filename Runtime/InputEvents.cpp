@@ -1,4 +1,6 @@
 #include "InputEvents.h"
+#include <algorithm>
+#include <chrono>
 
 InputEvent::InputEvent(Platform &platform, EventSource source) :
     platform{platform},
@@ -96,3 +98,82 @@ float TouchInputEvent::get_pos_y() const
 {
 	return pos_y;
 }
+
+uint64_t InputEventQueue::GetTimestamp()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void InputEventQueue::Push(const InputEventRecord &event)
+{
+	if (!ring.Push(event))
+	{
+		dropped_count.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void InputEventQueue::PushKey(KeyCode code, KeyAction action)
+{
+	Push({GetTimestamp(), InputEventType::Key, static_cast<uint8_t>(action), static_cast<uint16_t>(code), 0.0f, 0.0f});
+}
+
+void InputEventQueue::PushMouseButton(MouseButton button, MouseAction action, float pos_x, float pos_y)
+{
+	Push({GetTimestamp(), InputEventType::MouseButton, static_cast<uint8_t>(action), static_cast<uint16_t>(button), pos_x, pos_y});
+}
+
+void InputEventQueue::PushMouseMove(float pos_x, float pos_y)
+{
+	Push({GetTimestamp(), InputEventType::MouseMove, static_cast<uint8_t>(MouseAction::Move), static_cast<uint16_t>(MouseButton::Unknown), pos_x, pos_y});
+}
+
+void InputEventQueue::PushMouseScroll(float offset_x, float offset_y)
+{
+	Push({GetTimestamp(), InputEventType::MouseScroll, static_cast<uint8_t>(MouseAction::Unknown), static_cast<uint16_t>(MouseButton::Unknown), offset_x, offset_y});
+}
+
+void InputEventQueue::PushResize(uint32_t width, uint32_t height)
+{
+	Push({GetTimestamp(), InputEventType::Resize, 0, 0, static_cast<float>(width), static_cast<float>(height)});
+}
+
+void InputEventQueue::PushFocus(bool focused)
+{
+	Push({GetTimestamp(), InputEventType::Focus, 0, 0, focused ? 1.0f : 0.0f, 0.0f});
+}
+
+uint32_t InputEventQueue::Drain(InputEventRecord *events, uint32_t max_count)
+{
+	uint32_t count = ring.PopBatch(events, max_count);
+
+	if (count > 0 && oldest_pending_timestamp == 0)
+	{
+		oldest_pending_timestamp = events[0].timestamp;
+	}
+	stats.eventCount += count;
+
+	return count;
+}
+
+void InputEventQueue::RecordFrame(uint64_t frame_timestamp)
+{
+	if (oldest_pending_timestamp == 0)
+	{
+		return;
+	}
+
+	double latency = frame_timestamp > oldest_pending_timestamp ? (frame_timestamp - oldest_pending_timestamp) * 1e-9 : 0.0;
+	oldest_pending_timestamp = 0;
+
+	++frame_count;
+	stats.lastLatency = latency;
+	stats.maxLatency = std::max(stats.maxLatency, latency);
+	stats.averageLatency += (latency - stats.averageLatency) / static_cast<double>(frame_count);
+}
+
+InputLatencyStats InputEventQueue::GetStats() const
+{
+	InputLatencyStats result = stats;
+	result.droppedCount = dropped_count.load(std::memory_order_relaxed);
+	return result;
+}
@@ -2,6 +2,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <atomic>
+#include <type_traits>
+#include "Common/SpscRing.h"
 
 class Platform;
 
@@ -236,3 +239,98 @@ class TouchInputEvent : public InputEvent
 
 	float pos_y;
 };
+
+enum class InputEventType : uint8_t
+{
+	Key,
+	MouseButton,
+	MouseMove,
+	MouseScroll,
+	Touch,
+	Resize,
+	Focus
+};
+
+// Compact, allocation free form of the events above, as they travel from the platform thread to the
+// thread running the game.
+struct InputEventRecord
+{
+	// Nanoseconds on InputEventQueue::GetTimestamp()'s clock, taken when the OS delivered the event.
+	uint64_t timestamp;
+
+	InputEventType type;
+
+	// KeyAction, MouseAction or TouchAction.
+	uint8_t action;
+
+	// KeyCode, MouseButton, or the touch pointer id.
+	uint16_t code;
+
+	// Cursor position, scroll offsets, new framebuffer size, or 1 / 0 for focus gained / lost.
+	float x;
+
+	float y;
+};
+
+static_assert(std::is_trivially_copyable<InputEventRecord>::value, "InputEventRecord must stay POD");
+static_assert(sizeof(InputEventRecord) == 24, "InputEventRecord should stay compact");
+
+struct InputLatencyStats
+{
+	uint64_t eventCount{0};
+
+	// Events lost because the consumer fell InputEventQueue::Capacity events behind.
+	uint64_t droppedCount{0};
+
+	// Seconds from the oldest event consumed by a frame to that frame's RecordFrame().
+	double lastLatency{0.0};
+
+	double averageLatency{0.0};
+
+	double maxLatency{0.0};
+};
+
+// Single producer (platform thread), single consumer (game thread) queue of input events.
+class InputEventQueue : public NonCopyable
+{
+  public:
+	static constexpr uint32_t Capacity = 4096;
+
+	static uint64_t GetTimestamp();
+
+	// Producer side.
+	void Push(const InputEventRecord &event);
+
+	void PushKey(KeyCode code, KeyAction action);
+
+	void PushMouseButton(MouseButton button, MouseAction action, float pos_x, float pos_y);
+
+	void PushMouseMove(float pos_x, float pos_y);
+
+	void PushMouseScroll(float offset_x, float offset_y);
+
+	void PushResize(uint32_t width, uint32_t height);
+
+	void PushFocus(bool focused);
+
+	// Consumer side. Copies out up to max_count events, oldest first.
+	uint32_t Drain(InputEventRecord *events, uint32_t max_count);
+
+	// Consumer side. Call when the frame that used the drained events is submitted; measures the
+	// latency of the oldest of them.
+	void RecordFrame(uint64_t frame_timestamp = GetTimestamp());
+
+	InputLatencyStats GetStats() const;
+
+  private:
+	SpscRing<InputEventRecord, Capacity> ring;
+
+	std::atomic<uint64_t> dropped_count{0};
+
+	// Consumer owned.
+	uint64_t oldest_pending_timestamp{0};
+
+	uint64_t frame_count{0};
+
+	InputLatencyStats stats{};
+};
@@ -0,0 +1,80 @@
+#include "FrameAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+FrameAllocator *g_FrameAllocator = new FrameAllocator();
+
+FrameAllocator::FrameAllocator(size_t capacity) :
+    m_Capacity{ capacity },
+    m_Overflow{ 256 * 1024, MemoryTag::Frame }
+{
+    m_Block = static_cast<uint8_t *>(Memory::Allocate(m_Capacity, Memory::DefaultAlignment, MemoryTag::Frame));
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    Memory::Free(m_Block, m_Capacity, Memory::DefaultAlignment, MemoryTag::Frame);
+}
+
+void *FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_Block);
+    size_t offset = m_Offset.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        size_t begin = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+        size_t end = begin + size;
+        if (end > m_Capacity)
+        {
+            break;
+        }
+
+        if (m_Offset.compare_exchange_weak(offset, end, std::memory_order_relaxed))
+        {
+            return m_Block + begin;
+        }
+    }
+
+    std::lock_guard lock(m_OverflowMutex);
+    m_OverflowBytes.fetch_add(size + alignment, std::memory_order_relaxed);
+    return m_Overflow.Allocate(size, alignment);
+}
+
+void FrameAllocator::Reset()
+{
+    size_t used = GetUsedBytes();
+    m_PeakBytes = std::max(m_PeakBytes, used);
+
+    if (m_OverflowBytes.load(std::memory_order_relaxed) > 0)
+    {
+        // Room for the whole frame plus some slack, the overflow chunks go back to the heap.
+        size_t capacity = std::max(m_Capacity * 2, used + used / 2);
+
+        Memory::Free(m_Block, m_Capacity, Memory::DefaultAlignment, MemoryTag::Frame);
+        m_Block = static_cast<uint8_t *>(Memory::Allocate(capacity, Memory::DefaultAlignment, MemoryTag::Frame));
+        m_Capacity = capacity;
+
+        m_Overflow.Release();
+        m_OverflowBytes.store(0, std::memory_order_relaxed);
+    }
+
+    m_Offset.store(0, std::memory_order_relaxed);
+}
+
+size_t FrameAllocator::GetUsedBytes() const
+{
+    return m_Offset.load(std::memory_order_relaxed) + m_OverflowBytes.load(std::memory_order_relaxed);
+}
+
+size_t FrameAllocator::GetCapacity() const
+{
+    return m_Capacity;
+}
+
+size_t FrameAllocator::GetPeakBytes() const
+{
+    return m_PeakBytes;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "LinearArena.h"
+#include "Memory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Linear allocator for memory that lives until the end of the frame, safe to use from worker jobs.
+// Allocations bump an atomic offset into one block; whatever doesn't fit goes to overflow chunks, and
+// Reset() folds a frame's overflow into a larger block, so steady state frames never reach the heap.
+class FrameAllocator : public NonCopyable
+{
+public:
+
+    explicit FrameAllocator(size_t capacity = 1024 * 1024);
+
+    ~FrameAllocator();
+
+    void *Allocate(size_t size, size_t alignment = Memory::DefaultAlignment);
+
+    template <typename T>
+    T *AllocateArray(size_t count)
+    {
+        return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Frees everything allocated this frame. Nothing may be allocating concurrently. VulkanGfx calls
+    // this from EndFrame().
+    void Reset();
+
+    // Bytes allocated since the last Reset(), counting alignment padding.
+    size_t GetUsedBytes() const;
+
+    size_t GetCapacity() const;
+
+    // Largest frame seen.
+    size_t GetPeakBytes() const;
+
+private:
+
+    uint8_t *m_Block{ nullptr };
+
+    size_t m_Capacity{ 0 };
+
+    std::atomic<size_t> m_Offset{ 0 };
+
+    std::mutex m_OverflowMutex;
+
+    LinearArena m_Overflow;
+
+    std::atomic<size_t> m_OverflowBytes{ 0 };
+
+    size_t m_PeakBytes{ 0 };
+};
+
+extern FrameAllocator *g_FrameAllocator;
@@ -0,0 +1,161 @@
+#include "LinearArena.h"
+#include <algorithm>
+#include <cassert>
+
+static size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+LinearArena::LinearArena(size_t chunkSize, MemoryTag tag) :
+    m_ChunkSize{ chunkSize },
+    m_Tag{ tag }
+{
+    assert(chunkSize > sizeof(Chunk));
+}
+
+LinearArena::~LinearArena()
+{
+    Release();
+}
+
+uint8_t *LinearArena::GetChunkData(Chunk *chunk) const
+{
+    return reinterpret_cast<uint8_t *>(chunk) + AlignUp(sizeof(Chunk), Memory::DefaultAlignment);
+}
+
+LinearArena::Chunk *LinearArena::GetChunk(uint32_t index) const
+{
+    Chunk *chunk = m_FirstChunk;
+    for (uint32_t current = 0; current < index && chunk != nullptr; ++current)
+    {
+        chunk = chunk->next;
+    }
+    return chunk;
+}
+
+void *LinearArena::Allocate(size_t size, size_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    while (m_CurrentChunk != nullptr)
+    {
+        uint8_t *data = GetChunkData(m_CurrentChunk);
+        uintptr_t address = AlignUp(reinterpret_cast<uintptr_t>(data) + m_Offset, alignment);
+        size_t end = address - reinterpret_cast<uintptr_t>(data) + size;
+
+        if (end <= m_CurrentChunk->size)
+        {
+            m_Offset = end;
+            return reinterpret_cast<void *>(address);
+        }
+
+        if (m_CurrentChunk->next == nullptr)
+        {
+            break;
+        }
+
+        // The rest of this chunk is wasted, the next kept one may be large enough.
+        m_FullChunkBytes += m_CurrentChunk->size;
+        m_CurrentChunk = m_CurrentChunk->next;
+        ++m_CurrentIndex;
+        m_Offset = 0;
+    }
+
+    size_t headerSize = AlignUp(sizeof(Chunk), Memory::DefaultAlignment);
+    size_t dataSize = std::max(m_ChunkSize - headerSize, size + alignment);
+
+    Chunk *chunk = static_cast<Chunk *>(Memory::Allocate(headerSize + dataSize, Memory::DefaultAlignment, m_Tag));
+    chunk->next = nullptr;
+    chunk->size = dataSize;
+    m_Capacity += dataSize;
+
+    if (m_CurrentChunk == nullptr)
+    {
+        m_FirstChunk = chunk;
+        m_CurrentIndex = 0;
+    }
+    else
+    {
+        m_FullChunkBytes += m_CurrentChunk->size;
+        m_CurrentChunk->next = chunk;
+        ++m_CurrentIndex;
+    }
+
+    m_CurrentChunk = chunk;
+    m_Offset = 0;
+
+    return Allocate(size, alignment);
+}
+
+LinearArena::Marker LinearArena::GetMarker() const
+{
+    return Marker{ m_CurrentIndex, m_Offset };
+}
+
+void LinearArena::Rewind(const Marker &marker)
+{
+    assert(marker.chunk < m_CurrentIndex || (marker.chunk == m_CurrentIndex && marker.offset <= m_Offset));
+
+    if (m_FirstChunk == nullptr)
+    {
+        return;
+    }
+
+    m_CurrentIndex = marker.chunk;
+    m_CurrentChunk = GetChunk(marker.chunk);
+    m_Offset = marker.offset;
+
+    m_FullChunkBytes = 0;
+    for (Chunk *chunk = m_FirstChunk; chunk != m_CurrentChunk; chunk = chunk->next)
+    {
+        m_FullChunkBytes += chunk->size;
+    }
+}
+
+void LinearArena::Reset()
+{
+    m_CurrentChunk = m_FirstChunk;
+    m_CurrentIndex = 0;
+    m_Offset = 0;
+    m_FullChunkBytes = 0;
+}
+
+void LinearArena::Release()
+{
+    size_t headerSize = AlignUp(sizeof(Chunk), Memory::DefaultAlignment);
+
+    Chunk *chunk = m_FirstChunk;
+    while (chunk != nullptr)
+    {
+        Chunk *next = chunk->next;
+        Memory::Free(chunk, headerSize + chunk->size, Memory::DefaultAlignment, m_Tag);
+        chunk = next;
+    }
+
+    m_FirstChunk = nullptr;
+    m_CurrentChunk = nullptr;
+    m_CurrentIndex = 0;
+    m_Offset = 0;
+    m_FullChunkBytes = 0;
+    m_Capacity = 0;
+}
+
+size_t LinearArena::GetUsedBytes() const
+{
+    return m_FullChunkBytes + m_Offset;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+    return m_Capacity;
+}
+
+namespace Memory
+{
+    LinearArena &GetThreadScratch()
+    {
+        static thread_local LinearArena t_ScratchArena{ 256 * 1024, MemoryTag::Scratch };
+        return t_ScratchArena;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstdint>
+
+// Bump allocator over a chain of chunks, single threaded. Individual allocations are never freed;
+// Rewind() drops everything after a marker and Reset() everything, both keeping the chunks, so an
+// arena that has seen its peak usage once never touches the heap again.
+class LinearArena : public NonCopyable
+{
+public:
+
+    struct Marker
+    {
+        uint32_t chunk{ 0 };
+
+        size_t offset{ 0 };
+    };
+
+    explicit LinearArena(size_t chunkSize = 64 * 1024, MemoryTag tag = MemoryTag::Scratch);
+
+    ~LinearArena();
+
+    void *Allocate(size_t size, size_t alignment = Memory::DefaultAlignment);
+
+    template <typename T>
+    T *AllocateArray(size_t count)
+    {
+        return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    Marker GetMarker() const;
+
+    void Rewind(const Marker &marker);
+
+    void Reset();
+
+    // Returns every chunk to the heap.
+    void Release();
+
+    // Bytes handed out since the last Reset(), counting alignment padding.
+    size_t GetUsedBytes() const;
+
+    size_t GetCapacity() const;
+
+private:
+
+    struct Chunk
+    {
+        Chunk *next;
+
+        size_t size;
+    };
+
+    uint8_t *GetChunkData(Chunk *chunk) const;
+
+    Chunk *GetChunk(uint32_t index) const;
+
+    size_t m_ChunkSize{ 0 };
+
+    MemoryTag m_Tag{ MemoryTag::Scratch };
+
+    Chunk *m_FirstChunk{ nullptr };
+
+    Chunk *m_CurrentChunk{ nullptr };
+
+    uint32_t m_CurrentIndex{ 0 };
+
+    size_t m_Offset{ 0 };
+
+    // Bytes in the chunks before the current one, they are full.
+    size_t m_FullChunkBytes{ 0 };
+
+    size_t m_Capacity{ 0 };
+};
+
+// Rewinds the arena to where it was on construction.
+class ArenaScope : public NonCopyable
+{
+public:
+
+    explicit ArenaScope(LinearArena &arena) :
+        m_Arena{ arena },
+        m_Marker{ arena.GetMarker() }
+    {
+    }
+
+    ~ArenaScope()
+    {
+        m_Arena.Rewind(m_Marker);
+    }
+
+private:
+
+    LinearArena &m_Arena;
+
+    LinearArena::Marker m_Marker;
+};
+
+namespace Memory
+{
+    // Per thread arena for temporaries that die before the function returns, use with ArenaScope.
+    LinearArena &GetThreadScratch();
+}
@@ -0,0 +1,160 @@
+#include "Memory.h"
+#include "Common/Logging.h"
+#include <atomic>
+#include <cstdlib>
+
+static constexpr uint32_t g_MemoryTagCount = static_cast<uint32_t>(MemoryTag::Count);
+
+struct MemoryTagCounters
+{
+    std::atomic<uint64_t> liveBytes{ 0 };
+
+    std::atomic<uint64_t> liveCount{ 0 };
+
+    std::atomic<uint64_t> totalCount{ 0 };
+
+    std::atomic<uint64_t> peakBytes{ 0 };
+};
+
+static MemoryTagCounters g_MemoryTagCounters[g_MemoryTagCount];
+
+static std::atomic<uint64_t> g_HeapAllocationCount{ 0 };
+
+namespace Memory
+{
+    void *Allocate(size_t size, size_t alignment, MemoryTag tag)
+    {
+        void *memory = nullptr;
+        if (alignment <= DefaultAlignment)
+        {
+            memory = std::malloc(size > 0 ? size : 1);
+        }
+        else
+        {
+#if defined(_WIN32)
+            memory = _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+            memory = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+        }
+
+        if (memory == nullptr)
+        {
+            LOGE("Out of memory allocating {} bytes for {}", size, GetTagName(tag));
+            abort();
+        }
+
+        TrackHeapAllocation();
+        TrackAllocation(tag, size);
+        return memory;
+    }
+
+    void Free(void *memory, size_t size, size_t alignment, MemoryTag tag)
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+
+        TrackFree(tag, size);
+
+#if defined(_WIN32)
+        if (alignment > DefaultAlignment)
+        {
+            _aligned_free(memory);
+            return;
+        }
+#else
+        (void)alignment;
+#endif
+        std::free(memory);
+    }
+
+    void TrackAllocation(MemoryTag tag, size_t size)
+    {
+        MemoryTagCounters &counters = g_MemoryTagCounters[static_cast<uint32_t>(tag)];
+
+        uint64_t liveBytes = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        counters.liveCount.fetch_add(1, std::memory_order_relaxed);
+        counters.totalCount.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+        while (liveBytes > peakBytes && !counters.peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void TrackFree(MemoryTag tag, size_t size)
+    {
+        TrackRelease(tag, size, 1);
+    }
+
+    void TrackRelease(MemoryTag tag, size_t size, uint64_t count)
+    {
+        MemoryTagCounters &counters = g_MemoryTagCounters[static_cast<uint32_t>(tag)];
+        counters.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+        counters.liveCount.fetch_sub(count, std::memory_order_relaxed);
+    }
+
+    MemoryTagStats GetTagStats(MemoryTag tag)
+    {
+        const MemoryTagCounters &counters = g_MemoryTagCounters[static_cast<uint32_t>(tag)];
+
+        MemoryTagStats stats{};
+        stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+        stats.liveCount = counters.liveCount.load(std::memory_order_relaxed);
+        stats.totalCount = counters.totalCount.load(std::memory_order_relaxed);
+        stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    uint64_t GetHeapAllocationCount()
+    {
+        return g_HeapAllocationCount.load(std::memory_order_relaxed);
+    }
+
+    void TrackHeapAllocation()
+    {
+        g_HeapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const char *GetTagName(MemoryTag tag)
+    {
+        switch (tag)
+        {
+        case MemoryTag::General:
+            return "General";
+        case MemoryTag::Frame:
+            return "Frame";
+        case MemoryTag::Scratch:
+            return "Scratch";
+        case MemoryTag::Thread:
+            return "Thread";
+        case MemoryTag::Scene:
+            return "Scene";
+        case MemoryTag::Render:
+            return "Render";
+        case MemoryTag::Gfx:
+            return "Gfx";
+        case MemoryTag::Streaming:
+            return "Streaming";
+        default:
+            return "Unknown";
+        }
+    }
+
+    void LogTagStats()
+    {
+        for (uint32_t tag = 0; tag < g_MemoryTagCount; ++tag)
+        {
+            MemoryTagStats stats = GetTagStats(static_cast<MemoryTag>(tag));
+            if (stats.totalCount == 0)
+            {
+                continue;
+            }
+
+            LOGI("{:<10} {:>12} bytes in {:>8} allocations, peak {:>12} bytes, {:>10} allocations total", GetTagName(static_cast<MemoryTag>(tag)),
+                stats.liveBytes, stats.liveCount, stats.peakBytes, stats.totalCount);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Subsystem an allocation is charged to.
+enum class MemoryTag : uint8_t
+{
+    General,
+
+    Frame,
+
+    Scratch,
+
+    Thread,
+
+    Scene,
+
+    Render,
+
+    Gfx,
+
+    Streaming,
+
+    Count,
+};
+
+struct MemoryTagStats
+{
+    // Bytes and allocations alive right now. Arenas report their chunks, not what is carved out of them.
+    uint64_t liveBytes{ 0 };
+
+    uint64_t liveCount{ 0 };
+
+    // Every allocation ever made with the tag.
+    uint64_t totalCount{ 0 };
+
+    uint64_t peakBytes{ 0 };
+};
+
+// Tagged heap allocation and the per-tag accounting every allocator in this directory reports to.
+// Counters are relaxed atomics, cheap enough to stay on in release builds.
+namespace Memory
+{
+    static constexpr size_t DefaultAlignment = alignof(std::max_align_t);
+
+    void *Allocate(size_t size, size_t alignment, MemoryTag tag);
+
+    // size, alignment and tag must match the Allocate() call.
+    void Free(void *memory, size_t size, size_t alignment, MemoryTag tag);
+
+    void TrackAllocation(MemoryTag tag, size_t size);
+
+    void TrackFree(MemoryTag tag, size_t size);
+
+    // Releases count allocations totalling size bytes at once, for arenas dropping a frame's worth.
+    void TrackRelease(MemoryTag tag, size_t size, uint64_t count);
+
+    MemoryTagStats GetTagStats(MemoryTag tag);
+
+    // Calls into the system heap made by Allocate() and by the pools reserving pages. Together with a
+    // counting operator new this tells whether a frame reached the heap at all.
+    uint64_t GetHeapAllocationCount();
+
+    void TrackHeapAllocation();
+
+    const char *GetTagName(MemoryTag tag);
+
+    // One line per tag with live memory.
+    void LogTagStats();
+}
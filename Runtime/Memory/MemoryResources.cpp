@@ -0,0 +1,111 @@
+#include "MemoryResources.h"
+#include "FrameAllocator.h"
+#include "LinearArena.h"
+#include "SmallObjectPool.h"
+
+TaggedMemoryResource::TaggedMemoryResource(MemoryTag tag) :
+    m_Tag{ tag }
+{
+}
+
+void *TaggedMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    return Memory::Allocate(bytes, alignment, m_Tag);
+}
+
+void TaggedMemoryResource::do_deallocate(void *memory, size_t bytes, size_t alignment)
+{
+    Memory::Free(memory, bytes, alignment, m_Tag);
+}
+
+bool TaggedMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    // Every tagged resource frees with the same heap, only the accounting differs.
+    return dynamic_cast<const TaggedMemoryResource *>(&other) != nullptr;
+}
+
+PoolMemoryResource::PoolMemoryResource(MemoryTag tag) :
+    m_Tag{ tag }
+{
+}
+
+void *PoolMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (alignment > Memory::DefaultAlignment)
+    {
+        return Memory::Allocate(bytes, alignment, m_Tag);
+    }
+    return SmallObjectPool::Allocate(bytes, m_Tag);
+}
+
+void PoolMemoryResource::do_deallocate(void *memory, size_t bytes, size_t alignment)
+{
+    if (alignment > Memory::DefaultAlignment)
+    {
+        Memory::Free(memory, bytes, alignment, m_Tag);
+        return;
+    }
+    SmallObjectPool::Free(memory, bytes, m_Tag);
+}
+
+bool PoolMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    const PoolMemoryResource *pool = dynamic_cast<const PoolMemoryResource *>(&other);
+    return pool != nullptr && pool->m_Tag == m_Tag;
+}
+
+ArenaMemoryResource::ArenaMemoryResource(LinearArena &arena) :
+    m_Arena{ arena }
+{
+}
+
+void *ArenaMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    return m_Arena.Allocate(bytes, alignment);
+}
+
+void ArenaMemoryResource::do_deallocate(void *, size_t, size_t)
+{
+}
+
+bool ArenaMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+void *FrameMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    return g_FrameAllocator->Allocate(bytes, alignment);
+}
+
+void FrameMemoryResource::do_deallocate(void *, size_t, size_t)
+{
+}
+
+bool FrameMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return dynamic_cast<const FrameMemoryResource *>(&other) != nullptr;
+}
+
+namespace Memory
+{
+    FrameMemoryResource *GetFrameResource()
+    {
+        static FrameMemoryResource frameResource;
+        return &frameResource;
+    }
+
+    PoolMemoryResource *GetPoolResource(MemoryTag tag)
+    {
+        static PoolMemoryResource poolResources[static_cast<uint32_t>(MemoryTag::Count)]{
+            PoolMemoryResource{ MemoryTag::General },
+            PoolMemoryResource{ MemoryTag::Frame },
+            PoolMemoryResource{ MemoryTag::Scratch },
+            PoolMemoryResource{ MemoryTag::Thread },
+            PoolMemoryResource{ MemoryTag::Scene },
+            PoolMemoryResource{ MemoryTag::Render },
+            PoolMemoryResource{ MemoryTag::Gfx },
+            PoolMemoryResource{ MemoryTag::Streaming } };
+        return &poolResources[static_cast<uint32_t>(tag)];
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Memory.h"
+#include <memory_resource>
+#include <vector>
+
+class LinearArena;
+
+// std::pmr adapters, so standard containers can sit on the engine allocators:
+//
+//     std::pmr::vector<uint32_t> visible{ Memory::GetFrameResource() };
+
+// Heap memory charged to a tag.
+class TaggedMemoryResource : public std::pmr::memory_resource
+{
+public:
+
+    explicit TaggedMemoryResource(MemoryTag tag);
+
+private:
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    MemoryTag m_Tag;
+};
+
+// Small blocks from SmallObjectPool, anything larger from the tagged heap. For node based containers.
+class PoolMemoryResource : public std::pmr::memory_resource
+{
+public:
+
+    explicit PoolMemoryResource(MemoryTag tag);
+
+private:
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    MemoryTag m_Tag;
+};
+
+// Allocates from a LinearArena, deallocation is a no-op until the arena is reset.
+class ArenaMemoryResource : public std::pmr::memory_resource
+{
+public:
+
+    explicit ArenaMemoryResource(LinearArena &arena);
+
+private:
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    LinearArena &m_Arena;
+};
+
+// Allocates from g_FrameAllocator, the memory is gone after EndFrame().
+class FrameMemoryResource : public std::pmr::memory_resource
+{
+private:
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+};
+
+namespace Memory
+{
+    FrameMemoryResource *GetFrameResource();
+
+    // Shared pooled resource per tag.
+    PoolMemoryResource *GetPoolResource(MemoryTag tag);
+}
+
+template <typename T>
+using FrameVector = std::pmr::vector<T>;
@@ -0,0 +1,211 @@
+#include "SmallObjectPool.h"
+#include "Common/Logging.h"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+static constexpr uint32_t g_SizeClassCount = 4;
+
+static constexpr size_t g_SizeClasses[g_SizeClassCount]{ 32, 64, 128, 256 };
+
+// Blocks moved between a thread and the depot at once.
+static constexpr uint32_t g_BatchSize = 64;
+
+static constexpr size_t g_PageSize = 64 * 1024;
+
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+// First block of a batch in the depot, the rest of the batch hangs off next. Fits the smallest class.
+struct FreeBatch
+{
+    FreeBlock *next;
+
+    FreeBatch *nextBatch;
+
+    uint32_t count;
+};
+
+static_assert(sizeof(FreeBatch) <= 32, "A batch header must fit the smallest size class");
+
+struct PoolDepot
+{
+    std::mutex mutex;
+
+    FreeBatch *batches{ nullptr };
+};
+
+static PoolDepot g_Depots[g_SizeClassCount];
+
+static std::atomic<size_t> g_ReservedBytes{ 0 };
+
+static uint32_t GetSizeClass(size_t size)
+{
+    for (uint32_t sizeClass = 0; sizeClass < g_SizeClassCount; ++sizeClass)
+    {
+        if (size <= g_SizeClasses[sizeClass])
+        {
+            return sizeClass;
+        }
+    }
+    return g_SizeClassCount;
+}
+
+static void PushBatch(uint32_t sizeClass, FreeBlock *head, uint32_t count)
+{
+    FreeBatch *batch = reinterpret_cast<FreeBatch *>(head);
+    batch->count = count;
+
+    PoolDepot &depot = g_Depots[sizeClass];
+    std::lock_guard lock(depot.mutex);
+    batch->nextBatch = depot.batches;
+    depot.batches = batch;
+}
+
+static FreeBlock *PopBatch(uint32_t sizeClass, uint32_t &count)
+{
+    PoolDepot &depot = g_Depots[sizeClass];
+    std::lock_guard lock(depot.mutex);
+
+    FreeBatch *batch = depot.batches;
+    if (batch == nullptr)
+    {
+        count = 0;
+        return nullptr;
+    }
+
+    depot.batches = batch->nextBatch;
+    count = batch->count;
+    return reinterpret_cast<FreeBlock *>(batch);
+}
+
+// Free lists of one thread. On thread exit the blocks go to the depot for the other threads.
+struct ThreadPoolCache
+{
+    FreeBlock *heads[g_SizeClassCount]{};
+
+    uint32_t counts[g_SizeClassCount]{};
+
+    ~ThreadPoolCache()
+    {
+        for (uint32_t sizeClass = 0; sizeClass < g_SizeClassCount; ++sizeClass)
+        {
+            if (heads[sizeClass] != nullptr)
+            {
+                PushBatch(sizeClass, heads[sizeClass], counts[sizeClass]);
+            }
+        }
+    }
+
+    void Refill(uint32_t sizeClass)
+    {
+        heads[sizeClass] = PopBatch(sizeClass, counts[sizeClass]);
+        if (heads[sizeClass] != nullptr)
+        {
+            return;
+        }
+
+        size_t blockSize = g_SizeClasses[sizeClass];
+        uint32_t blockCount = static_cast<uint32_t>(g_PageSize / blockSize);
+        // Not charged to a tag, the blocks are charged to their users instead.
+        uint8_t *page = static_cast<uint8_t *>(std::malloc(g_PageSize));
+        if (page == nullptr)
+        {
+            LOGE("Out of memory reserving a small object page");
+            abort();
+        }
+        g_ReservedBytes.fetch_add(g_PageSize, std::memory_order_relaxed);
+        Memory::TrackHeapAllocation();
+
+        FreeBlock *head = nullptr;
+        for (uint32_t block = blockCount; block-- > 0;)
+        {
+            FreeBlock *freeBlock = reinterpret_cast<FreeBlock *>(page + block * blockSize);
+            freeBlock->next = head;
+            head = freeBlock;
+        }
+
+        heads[sizeClass] = head;
+        counts[sizeClass] = blockCount;
+    }
+
+    // Keeps one batch worth, the rest goes to the depot.
+    void Trim(uint32_t sizeClass)
+    {
+        FreeBlock *head = heads[sizeClass];
+        FreeBlock *last = head;
+        for (uint32_t block = 1; block < g_BatchSize; ++block)
+        {
+            last = last->next;
+        }
+
+        heads[sizeClass] = last->next;
+        counts[sizeClass] -= g_BatchSize;
+        last->next = nullptr;
+
+        PushBatch(sizeClass, head, g_BatchSize);
+    }
+};
+
+static thread_local ThreadPoolCache t_PoolCache;
+
+namespace SmallObjectPool
+{
+    void *Allocate(size_t size, MemoryTag tag)
+    {
+        uint32_t sizeClass = GetSizeClass(size);
+        if (sizeClass == g_SizeClassCount)
+        {
+            return Memory::Allocate(size, Memory::DefaultAlignment, tag);
+        }
+
+        ThreadPoolCache &cache = t_PoolCache;
+        if (cache.heads[sizeClass] == nullptr)
+        {
+            cache.Refill(sizeClass);
+        }
+
+        FreeBlock *block = cache.heads[sizeClass];
+        cache.heads[sizeClass] = block->next;
+        --cache.counts[sizeClass];
+
+        Memory::TrackAllocation(tag, g_SizeClasses[sizeClass]);
+        return block;
+    }
+
+    void Free(void *memory, size_t size, MemoryTag tag)
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+
+        uint32_t sizeClass = GetSizeClass(size);
+        if (sizeClass == g_SizeClassCount)
+        {
+            Memory::Free(memory, size, Memory::DefaultAlignment, tag);
+            return;
+        }
+
+        Memory::TrackFree(tag, g_SizeClasses[sizeClass]);
+
+        ThreadPoolCache &cache = t_PoolCache;
+        FreeBlock *block = static_cast<FreeBlock *>(memory);
+        block->next = cache.heads[sizeClass];
+        cache.heads[sizeClass] = block;
+
+        if (++cache.counts[sizeClass] >= 2 * g_BatchSize)
+        {
+            cache.Trim(sizeClass);
+        }
+    }
+
+    size_t GetReservedBytes()
+    {
+        return g_ReservedBytes.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Memory.h"
+#include <cstddef>
+#include <new>
+
+// Fixed size blocks for small, short lived objects, kept in a free list per size class and thread.
+// Blocks may be freed on any thread: a thread collecting too many hands them back in batches through
+// a shared depot, so producer and consumer threads settle into reusing the same blocks instead of
+// growing. Pages are never returned to the heap.
+namespace SmallObjectPool
+{
+    // Larger requests, and alignments above Memory::DefaultAlignment, go to the tagged heap.
+    static constexpr size_t MaxSize = 256;
+
+    void *Allocate(size_t size, MemoryTag tag);
+
+    void Free(void *memory, size_t size, MemoryTag tag);
+
+    // Bytes of pages carved into blocks so far, across all threads.
+    size_t GetReservedBytes();
+}
+
+// Gives a class pooled operator new and delete, charged to Tag.
+template <MemoryTag Tag>
+class PoolAllocated
+{
+public:
+
+    static void *operator new(size_t size)
+    {
+        return SmallObjectPool::Allocate(size, Tag);
+    }
+
+    static void operator delete(void *memory, size_t size)
+    {
+        SmallObjectPool::Free(memory, size, Tag);
+    }
+};
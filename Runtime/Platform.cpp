@@ -1 +1,67 @@
-#include "Platform.h"
\ No newline at end of file
+#include "Platform.h"
+#include "Common/AsyncLogger.h"
+
+void Platform::SetFrameLoopDesc(const FrameLoopDesc &desc)
+{
+    m_FrameLoopDesc = desc;
+}
+
+const FrameLoopDesc &Platform::GetFrameLoopDesc() const
+{
+    return m_FrameLoopDesc;
+}
+
+void Platform::RequestClose()
+{
+    m_FrameLoop.RequestStop();
+}
+
+void Platform::RequestResize(uint32_t width, uint32_t height)
+{
+    m_FrameLoop.RequestResize(width, height);
+}
+
+FrameLoopStats Platform::GetFrameLoopStats() const
+{
+    return m_FrameLoop.GetStats();
+}
+
+InputEventQueue &Platform::GetInputQueue()
+{
+    return m_InputQueue;
+}
+
+const VulkanWindow *Platform::GetVulkanWindow() const
+{
+    return nullptr;
+}
+
+bool Platform::StartApplication()
+{
+    // From here on logging must not stall the frame loop threads.
+    g_AsyncLogger.Start();
+
+    if (!m_CurrentApplication->Prepare(*this))
+    {
+        g_AsyncLogger.Stop();
+        return false;
+    }
+
+    m_FrameLoop.Start(*m_CurrentApplication, m_FrameLoopDesc, &m_InputQueue);
+    m_ApplicationStarted = true;
+    return true;
+}
+
+void Platform::StopApplication()
+{
+    if (!m_ApplicationStarted)
+    {
+        return;
+    }
+
+    m_FrameLoop.Stop();
+    m_CurrentApplication->Finish();
+    m_ApplicationStarted = false;
+
+    g_AsyncLogger.Stop();
+}
@@ -3,6 +3,10 @@
 #include <memory>
 #include "Application.h"
 #include "Common/Utils.h"
+#include "InputEvents.h"
+#include "Platform/FrameLoop.h"
+
+class VulkanWindow;
 
 class Platform : public NonCopyable
 {
@@ -20,8 +24,40 @@ public:
 
     virtual void Tick() = 0;
 
+    // Takes effect on the next Initialize().
+    void SetFrameLoopDesc(const FrameLoopDesc &desc);
+
+    const FrameLoopDesc &GetFrameLoopDesc() const;
+
+    // Safe from any thread, MainLoop() returns once the platform thread notices.
+    void RequestClose();
+
+    FrameLoopStats GetFrameLoopStats() const;
+
+    // Safe from any thread, forwards a new framebuffer size to Application::Resize() on the render thread.
+    void RequestResize(uint32_t width, uint32_t height);
+
+    // Filled by the platform thread, drained by the frame loop's simulation thread.
+    InputEventQueue &GetInputQueue();
+
+    // Window to present to, nullptr when the platform has none.
+    virtual const VulkanWindow *GetVulkanWindow() const;
+
 protected:
 
+    // Prepares the application and starts the simulation and render threads.
+    bool StartApplication();
+
+    // Stops the threads and finishes the application.
+    void StopApplication();
+
     std::unique_ptr<Application> m_CurrentApplication{ nullptr };
 
-};
\ No newline at end of file
+    FrameLoopDesc m_FrameLoopDesc{};
+
+    FrameLoop m_FrameLoop;
+
+    InputEventQueue m_InputQueue;
+
+    bool m_ApplicationStarted{ false };
+};
@@ -0,0 +1,223 @@
+#include "FrameLoop.h"
+#include "Application.h"
+#include <algorithm>
+#include <cassert>
+#include "Profiling/CpuProfiler.h"
+
+// Below this the scheduler can't be trusted to wake us in time.
+static constexpr std::chrono::microseconds SpinThreshold{ 1000 };
+
+static constexpr uint64_t NoPendingResize = ~0ull;
+
+void FrameLimiter::SetTargetFrameRate(double framesPerSecond)
+{
+    m_Period = framesPerSecond > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond)) : Clock::duration::zero();
+    m_NextDeadline = Clock::now() + m_Period;
+}
+
+void FrameLimiter::Wait()
+{
+    if (m_Period == Clock::duration::zero())
+    {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (now > m_NextDeadline + m_Period)
+    {
+        m_NextDeadline = now + m_Period;
+        return;
+    }
+
+    if (m_NextDeadline - now > SpinThreshold)
+    {
+        std::this_thread::sleep_until(m_NextDeadline - SpinThreshold);
+    }
+
+    while (Clock::now() < m_NextDeadline)
+    {
+        std::this_thread::yield();
+    }
+
+    m_NextDeadline += m_Period;
+}
+
+FrameLoop::~FrameLoop()
+{
+    Stop();
+}
+
+void FrameLoop::Start(Application &application, const FrameLoopDesc &desc, InputEventQueue *inputQueue)
+{
+    assert(!m_SimulationThread.joinable() && "The frame loop is already running.");
+    assert(desc.fixedTimestep > 0.0);
+
+    m_Application = &application;
+    m_InputQueue = inputQueue;
+    m_InputEvents.resize(inputQueue != nullptr ? InputEventQueue::Capacity : 0);
+    m_InputStats = InputLatencyStats{};
+    m_Desc = desc;
+    m_StopRequested = false;
+    m_SimulationTime = 0;
+    m_FrameCount = 0;
+    m_StepCount = 0;
+    m_DroppedTime = 0;
+    m_PendingResize = NoPendingResize;
+    m_StartTime = Clock::now();
+
+    m_SimulationThread = std::thread{ &FrameLoop::RunSimulation, this };
+    m_RenderThread = std::thread{ &FrameLoop::RunRender, this };
+}
+
+void FrameLoop::Stop()
+{
+    RequestStop();
+
+    if (m_SimulationThread.joinable())
+    {
+        m_SimulationThread.join();
+    }
+
+    if (m_RenderThread.joinable())
+    {
+        m_RenderThread.join();
+    }
+}
+
+void FrameLoop::RequestStop()
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_StopMutex };
+        m_StopRequested = true;
+    }
+    m_StopEvent.notify_all();
+}
+
+bool FrameLoop::IsStopRequested() const
+{
+    return m_StopRequested.load(std::memory_order_acquire);
+}
+
+void FrameLoop::WaitForStopRequest(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock{ m_StopMutex };
+    m_StopEvent.wait_for(lock, timeout, [this]() { return m_StopRequested.load(); });
+}
+
+void FrameLoop::RequestResize(uint32_t width, uint32_t height)
+{
+    m_PendingResize.store(static_cast<uint64_t>(width) << 32 | height, std::memory_order_release);
+}
+
+FrameLoopStats FrameLoop::GetStats() const
+{
+    FrameLoopStats stats{};
+    stats.frameCount = m_FrameCount.load(std::memory_order_relaxed);
+    stats.stepCount = m_StepCount.load(std::memory_order_relaxed);
+    stats.droppedSeconds = std::chrono::duration<double>(Clock::duration{ m_DroppedTime.load(std::memory_order_relaxed) }).count();
+
+    std::lock_guard<std::mutex> lock{ m_InputStatsMutex };
+    stats.input = m_InputStats;
+    return stats;
+}
+
+void FrameLoop::RunSimulation()
+{
+    Clock::duration timestep = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_Desc.fixedTimestep));
+    Clock::time_point nextStep = m_StartTime;
+
+    PROFILE_THREAD_NAME("Simulation");
+
+    while (!IsStopRequested())
+    {
+        Clock::time_point now = Clock::now();
+
+        uint32_t steps = 0;
+        while (now >= nextStep && steps < m_Desc.maxStepsPerUpdate)
+        {
+            uint32_t eventCount = 0;
+            if (m_InputQueue != nullptr)
+            {
+                PROFILE_SCOPE("ProcessInput");
+                eventCount = m_InputQueue->Drain(m_InputEvents.data(), static_cast<uint32_t>(m_InputEvents.size()));
+                if (eventCount > 0)
+                {
+                    m_Application->ProcessInput(m_InputEvents.data(), eventCount);
+                }
+            }
+
+            {
+                PROFILE_SCOPE("FixedUpdate");
+                m_Application->FixedUpdate(m_Desc.fixedTimestep);
+            }
+
+            if (eventCount > 0)
+            {
+                m_InputQueue->RecordFrame();
+
+                std::lock_guard<std::mutex> lock{ m_InputStatsMutex };
+                m_InputStats = m_InputQueue->GetStats();
+            }
+
+            nextStep += timestep;
+            ++steps;
+
+            m_SimulationTime.store((nextStep - timestep - m_StartTime).count(), std::memory_order_release);
+            m_StepCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Too slow to keep up: drop the backlog instead of spiralling further behind.
+        if (now >= nextStep)
+        {
+            m_DroppedTime.fetch_add((now - nextStep).count(), std::memory_order_relaxed);
+            nextStep = now;
+        }
+
+        std::unique_lock<std::mutex> lock{ m_StopMutex };
+        m_StopEvent.wait_until(lock, nextStep, [this]() { return m_StopRequested.load(); });
+    }
+}
+
+void FrameLoop::RunRender()
+{
+    FrameLimiter limiter;
+    limiter.SetTargetFrameRate(m_Desc.targetFrameRate);
+
+    Clock::time_point lastFrame = Clock::now();
+
+    PROFILE_THREAD_NAME("Render");
+
+    while (!IsStopRequested())
+    {
+        Clock::time_point now = Clock::now();
+        double deltaTime = std::chrono::duration<double>(now - lastFrame).count();
+        lastFrame = now;
+
+        // How far the clock has moved past the latest simulation state, in steps.
+        Clock::duration simulationTime{ m_SimulationTime.load(std::memory_order_acquire) };
+        double alpha = std::chrono::duration<double>(now - m_StartTime - simulationTime).count() / m_Desc.fixedTimestep;
+        alpha = std::min(std::max(alpha, 0.0), 1.0);
+
+        uint64_t resize = m_PendingResize.exchange(NoPendingResize, std::memory_order_acq_rel);
+        if (resize != NoPendingResize)
+        {
+            PROFILE_SCOPE("Resize");
+            m_Application->Resize(static_cast<uint32_t>(resize >> 32), static_cast<uint32_t>(resize));
+        }
+
+        {
+            PROFILE_SCOPE("Render");
+            m_Application->Render(deltaTime, alpha);
+        }
+
+        uint64_t frameCount = m_FrameCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (m_Desc.maxFrames > 0 && frameCount >= m_Desc.maxFrames)
+        {
+            RequestStop();
+            break;
+        }
+
+        PROFILE_SCOPE("FrameLimiter");
+        limiter.Wait();
+    }
+}
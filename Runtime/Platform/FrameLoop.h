@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "InputEvents.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Application;
+
+struct FrameLoopDesc
+{
+    // Seconds advanced by every Application::FixedUpdate().
+    double fixedTimestep{ 1.0 / 60.0 };
+
+    // Steps run back to back before the simulation drops time to catch up with the clock.
+    uint32_t maxStepsPerUpdate{ 5 };
+
+    // 0 renders as fast as the application allows.
+    double targetFrameRate{ 0.0 };
+
+    // Stops the loop after this many rendered frames, 0 runs until Stop().
+    uint64_t maxFrames{ 0 };
+};
+
+struct FrameLoopStats
+{
+    uint64_t frameCount{ 0 };
+
+    uint64_t stepCount{ 0 };
+
+    // Simulation time thrown away because the steps could not keep up.
+    double droppedSeconds{ 0.0 };
+
+    // Latency from the OS delivering an event to the end of the step that consumed it.
+    InputLatencyStats input{};
+};
+
+// Sleeps the calling thread until the next frame deadline. Sleeps coarse and spins the last
+// millisecond, and resynchronises instead of bursting when a frame overran by more than a period.
+class FrameLimiter
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    void SetTargetFrameRate(double framesPerSecond);
+
+    void Wait();
+
+private:
+
+    Clock::duration m_Period{ Clock::duration::zero() };
+
+    Clock::time_point m_NextDeadline{};
+};
+
+// Runs the application on a simulation thread with a fixed timestep and a render thread paced
+// by a frame limiter, leaving the platform thread free to pump OS events. Neither thread waits on
+// the other, sharing state between FixedUpdate() and Render() is up to the application. The
+// simulation thread is the consumer of the input queue, it drains it once per step.
+class FrameLoop : public NonCopyable
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    ~FrameLoop();
+
+    // inputQueue may be nullptr, the loop then runs without input.
+    void Start(Application &application, const FrameLoopDesc &desc, InputEventQueue *inputQueue = nullptr);
+
+    // Joins both threads, the application is not called once this returns.
+    void Stop();
+
+    // Asks the loop to stop from any thread, including the application callbacks.
+    void RequestStop();
+
+    bool IsStopRequested() const;
+
+    // Safe from any thread. The render thread hands the latest size to Application::Resize() before
+    // its next frame, sizes requested in between are skipped.
+    void RequestResize(uint32_t width, uint32_t height);
+
+    // Blocks until RequestStop() or maxFrames, or returns after timeout.
+    void WaitForStopRequest(std::chrono::milliseconds timeout);
+
+    FrameLoopStats GetStats() const;
+
+private:
+
+    void RunSimulation();
+
+    void RunRender();
+
+    Application *m_Application{ nullptr };
+
+    InputEventQueue *m_InputQueue{ nullptr };
+
+    // Simulation thread owned, sized once at Start() so draining never allocates.
+    std::vector<InputEventRecord> m_InputEvents;
+
+    // Copy of the queue's stats for GetStats() on other threads.
+    mutable std::mutex m_InputStatsMutex;
+
+    InputLatencyStats m_InputStats{};
+
+    FrameLoopDesc m_Desc{};
+
+    std::thread m_SimulationThread;
+
+    std::thread m_RenderThread;
+
+    std::atomic<bool> m_StopRequested{ false };
+
+    std::mutex m_StopMutex;
+
+    std::condition_variable m_StopEvent;
+
+    Clock::time_point m_StartTime{};
+
+    // Clock time, relative to m_StartTime, the latest simulation state corresponds to.
+    std::atomic<int64_t> m_SimulationTime{ 0 };
+
+    std::atomic<uint64_t> m_FrameCount{ 0 };
+
+    std::atomic<uint64_t> m_StepCount{ 0 };
+
+    std::atomic<int64_t> m_DroppedTime{ 0 };
+
+    // Width in the high and height in the low 32 bits, NoPendingResize when there is none.
+    std::atomic<uint64_t> m_PendingResize{ ~0ull };
+};
@@ -0,0 +1,170 @@
+#include "GlfwInput.h"
+#include "Platform.h"
+#include <GLFW/glfw3.h>
+
+static Platform &GetPlatform(GLFWwindow *window)
+{
+    return *static_cast<Platform *>(glfwGetWindowUserPointer(window));
+}
+
+static InputEventQueue &GetInputQueue(GLFWwindow *window)
+{
+    return GetPlatform(window).GetInputQueue();
+}
+
+static inline KeyCode translate_key_code(int key)
+{
+    switch (key)
+    {
+    case GLFW_KEY_SPACE: return KeyCode::Space;
+    case GLFW_KEY_APOSTROPHE: return KeyCode::Apostrophe;
+    case GLFW_KEY_COMMA: return KeyCode::Comma;
+    case GLFW_KEY_MINUS: return KeyCode::Minus;
+    case GLFW_KEY_PERIOD: return KeyCode::Period;
+    case GLFW_KEY_SLASH: return KeyCode::Slash;
+    case GLFW_KEY_SEMICOLON: return KeyCode::Semicolon;
+    case GLFW_KEY_EQUAL: return KeyCode::Equal;
+    case GLFW_KEY_LEFT_BRACKET: return KeyCode::LeftBracket;
+    case GLFW_KEY_BACKSLASH: return KeyCode::Backslash;
+    case GLFW_KEY_RIGHT_BRACKET: return KeyCode::RightBracket;
+    case GLFW_KEY_GRAVE_ACCENT: return KeyCode::GraveAccent;
+    case GLFW_KEY_ESCAPE: return KeyCode::Escape;
+    case GLFW_KEY_ENTER: return KeyCode::Enter;
+    case GLFW_KEY_TAB: return KeyCode::Tab;
+    case GLFW_KEY_BACKSPACE: return KeyCode::Backspace;
+    case GLFW_KEY_INSERT: return KeyCode::Insert;
+    case GLFW_KEY_DELETE: return KeyCode::DelKey;
+    case GLFW_KEY_RIGHT: return KeyCode::Right;
+    case GLFW_KEY_LEFT: return KeyCode::Left;
+    case GLFW_KEY_DOWN: return KeyCode::Down;
+    case GLFW_KEY_UP: return KeyCode::Up;
+    case GLFW_KEY_PAGE_UP: return KeyCode::PageUp;
+    case GLFW_KEY_PAGE_DOWN: return KeyCode::PageDown;
+    case GLFW_KEY_HOME: return KeyCode::Home;
+    case GLFW_KEY_END: return KeyCode::End;
+    case GLFW_KEY_CAPS_LOCK: return KeyCode::CapsLock;
+    case GLFW_KEY_SCROLL_LOCK: return KeyCode::ScrollLock;
+    case GLFW_KEY_NUM_LOCK: return KeyCode::NumLock;
+    case GLFW_KEY_PRINT_SCREEN: return KeyCode::PrintScreen;
+    case GLFW_KEY_PAUSE: return KeyCode::Pause;
+    case GLFW_KEY_KP_DECIMAL: return KeyCode::KP_Decimal;
+    case GLFW_KEY_KP_DIVIDE: return KeyCode::KP_Divide;
+    case GLFW_KEY_KP_MULTIPLY: return KeyCode::KP_Multiply;
+    case GLFW_KEY_KP_SUBTRACT: return KeyCode::KP_Subtract;
+    case GLFW_KEY_KP_ADD: return KeyCode::KP_Add;
+    case GLFW_KEY_KP_ENTER: return KeyCode::KP_Enter;
+    case GLFW_KEY_KP_EQUAL: return KeyCode::KP_Equal;
+    case GLFW_KEY_LEFT_SHIFT: return KeyCode::LeftShift;
+    case GLFW_KEY_LEFT_CONTROL: return KeyCode::LeftControl;
+    case GLFW_KEY_LEFT_ALT: return KeyCode::LeftAlt;
+    case GLFW_KEY_RIGHT_SHIFT: return KeyCode::RightShift;
+    case GLFW_KEY_RIGHT_CONTROL: return KeyCode::RightControl;
+    case GLFW_KEY_RIGHT_ALT: return KeyCode::RightAlt;
+    default: break;
+    }
+
+    // The contiguous GLFW ranges map onto contiguous KeyCode ranges.
+    if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9)
+    {
+        return static_cast<KeyCode>(static_cast<int>(KeyCode::_0) + (key - GLFW_KEY_0));
+    }
+    if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z)
+    {
+        return static_cast<KeyCode>(static_cast<int>(KeyCode::A) + (key - GLFW_KEY_A));
+    }
+    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F12)
+    {
+        return static_cast<KeyCode>(static_cast<int>(KeyCode::F1) + (key - GLFW_KEY_F1));
+    }
+    if (key >= GLFW_KEY_KP_0 && key <= GLFW_KEY_KP_9)
+    {
+        return static_cast<KeyCode>(static_cast<int>(KeyCode::KP_0) + (key - GLFW_KEY_KP_0));
+    }
+
+    return KeyCode::Unknown;
+}
+
+static inline KeyAction translate_key_action(int action)
+{
+    switch (action)
+    {
+    case GLFW_PRESS: return KeyAction::Down;
+    case GLFW_RELEASE: return KeyAction::Up;
+    case GLFW_REPEAT: return KeyAction::Repeat;
+    default: return KeyAction::Unknown;
+    }
+}
+
+static inline MouseButton translate_mouse_button(int button)
+{
+    switch (button)
+    {
+    case GLFW_MOUSE_BUTTON_LEFT: return MouseButton::Left;
+    case GLFW_MOUSE_BUTTON_RIGHT: return MouseButton::Right;
+    case GLFW_MOUSE_BUTTON_MIDDLE: return MouseButton::Middle;
+    case GLFW_MOUSE_BUTTON_4: return MouseButton::Back;
+    case GLFW_MOUSE_BUTTON_5: return MouseButton::Forward;
+    default: return MouseButton::Unknown;
+    }
+}
+
+static inline MouseAction translate_mouse_action(int action)
+{
+    switch (action)
+    {
+    case GLFW_PRESS: return MouseAction::Down;
+    case GLFW_RELEASE: return MouseAction::Up;
+    default: return MouseAction::Unknown;
+    }
+}
+
+static void framebuffer_size_callback(GLFWwindow *window, int width, int height)
+{
+    GetInputQueue(window).PushResize(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    GetPlatform(window).RequestResize(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+}
+
+static void window_focus_callback(GLFWwindow *window, int focused)
+{
+    GetInputQueue(window).PushFocus(focused == GLFW_TRUE);
+}
+
+static void key_callback(GLFWwindow *window, int key, int /*scancode*/, int action, int /*mods*/)
+{
+    GetInputQueue(window).PushKey(translate_key_code(key), translate_key_action(action));
+}
+
+static void cursor_position_callback(GLFWwindow *window, double xpos, double ypos)
+{
+    GetInputQueue(window).PushMouseMove(static_cast<float>(xpos), static_cast<float>(ypos));
+}
+
+static void mouse_button_callback(GLFWwindow *window, int button, int action, int /*mods*/)
+{
+    double xpos = 0.0;
+    double ypos = 0.0;
+    glfwGetCursorPos(window, &xpos, &ypos);
+
+    GetInputQueue(window).PushMouseButton(translate_mouse_button(button), translate_mouse_action(action), static_cast<float>(xpos), static_cast<float>(ypos));
+}
+
+static void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
+{
+    GetInputQueue(window).PushMouseScroll(static_cast<float>(xoffset), static_cast<float>(yoffset));
+}
+
+void GlfwInput::InstallCallbacks(GLFWwindow *window)
+{
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowFocusCallback(window, window_focus_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // Unaccelerated motion where the platform supports it, high rate mice report every count.
+    if (glfwRawMouseMotionSupported())
+    {
+        glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+struct GLFWwindow;
+
+// Routes GLFW window and input callbacks into the InputEventQueue of the Platform stored as the
+// window user pointer. Shared by every GLFW based platform.
+namespace GlfwInput
+{
+    void InstallCallbacks(GLFWwindow *window);
+}
@@ -0,0 +1,38 @@
+#include "GlfwSurface.h"
+#include "Common/Logging.h"
+// After volk, so GLFW declares its Vulkan functions with volk's types.
+#include <GLFW/glfw3.h>
+
+std::vector<const char *> GlfwSurface::GetRequiredInstanceExtensions()
+{
+    uint32_t extensionCount = 0;
+    const char **extensions = glfwGetRequiredInstanceExtensions(&extensionCount);
+    if (extensions == nullptr)
+    {
+        LOGE("GLFW can't present with Vulkan on this system.");
+        return {};
+    }
+
+    // Owned by GLFW until glfwTerminate().
+    return std::vector<const char *>(extensions, extensions + extensionCount);
+}
+
+VkSurfaceKHR GlfwSurface::CreateSurface(GLFWwindow *window, VkInstance instance)
+{
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    VkResult result = glfwCreateWindowSurface(instance, window, nullptr, &surface);
+    if (result != VK_SUCCESS)
+    {
+        LOGE("Couldn't create a Vulkan surface for the window ({}).", static_cast<int>(result));
+        return VK_NULL_HANDLE;
+    }
+    return surface;
+}
+
+VkExtent2D GlfwSurface::GetFramebufferExtent(GLFWwindow *window)
+{
+    int width = 0;
+    int height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    return VkExtent2D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include <volk.h>
+
+struct GLFWwindow;
+
+// Vulkan presentation through a GLFW window. Shared by every GLFW based platform, platform thread only.
+namespace GlfwSurface
+{
+    // Surface extensions of the window system GLFW runs on, empty when GLFW found no Vulkan loader.
+    std::vector<const char *> GetRequiredInstanceExtensions();
+
+    // VK_NULL_HANDLE on failure. The caller destroys the surface before the instance.
+    VkSurfaceKHR CreateSurface(GLFWwindow *window, VkInstance instance);
+
+    VkExtent2D GetFramebufferExtent(GLFWwindow *window);
+}
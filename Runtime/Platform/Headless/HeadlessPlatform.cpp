@@ -0,0 +1,32 @@
+#include "HeadlessPlatform.h"
+
+HeadlessPlatform::~HeadlessPlatform()
+{
+    StopApplication();
+}
+
+bool HeadlessPlatform::Initialize(std::unique_ptr<Application> &&application)
+{
+    m_CurrentApplication = std::move(application);
+
+    return StartApplication();
+}
+
+void HeadlessPlatform::MainLoop()
+{
+    while (!m_FrameLoop.IsStopRequested())
+    {
+        Tick();
+    }
+}
+
+void HeadlessPlatform::Terminate()
+{
+    StopApplication();
+}
+
+void HeadlessPlatform::Tick()
+{
+    // Nothing to pump, just sleep until the frame loop asks to stop.
+    m_FrameLoop.WaitForStopRequest(std::chrono::milliseconds{ 100 });
+}
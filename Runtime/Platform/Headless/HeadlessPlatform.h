@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Platform.h"
+
+// No window and no event queue, for render farms and CI. Runs until the application calls
+// RequestClose() or FrameLoopDesc::maxFrames frames have been rendered.
+class HeadlessPlatform : public Platform
+{
+public:
+
+    HeadlessPlatform() = default;
+
+    ~HeadlessPlatform();
+
+    virtual bool Initialize(std::unique_ptr<Application> &&application) override;
+
+    virtual void MainLoop() override;
+
+    virtual void Terminate() override;
+
+    virtual void Tick() override;
+};
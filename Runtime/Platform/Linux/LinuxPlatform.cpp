@@ -0,0 +1,122 @@
+#include "LinuxPlatform.h"
+#include <GLFW/glfw3.h>
+#include "Common/Logging.h"
+#include "Platform/GlfwInput.h"
+#include "Platform/GlfwSurface.h"
+
+// Upper bound on how long the platform thread sleeps in the event queue, so a close requested from
+// the frame loop threads is noticed quickly.
+static constexpr double EventWaitTimeout = 0.01;
+
+static void error_callback(int error, const char *description)
+{
+    LOGE("GLFW Error (code {}): {}", error, description);
+}
+
+static void window_close_callback(GLFWwindow *window)
+{
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+}
+
+LinuxPlatform::LinuxPlatform(uint32_t width, uint32_t height) :
+    m_Width{ width },
+    m_Height{ height }
+{
+
+}
+
+LinuxPlatform::~LinuxPlatform()
+{
+
+}
+
+bool LinuxPlatform::Initialize(std::unique_ptr<Application> &&application)
+{
+    glfwSetErrorCallback(error_callback);
+
+    if (!glfwInit())
+    {
+        LOGE("GLFW couldn't be initialized.");
+        return false;
+    }
+    m_CurrentApplication = std::move(application);
+
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+
+    m_Handle = glfwCreateWindow(static_cast<int>(m_Width), static_cast<int>(m_Height), m_CurrentApplication->GetName().c_str(), NULL, NULL);
+    if (!m_Handle)
+    {
+        LOGE("Couldn't create glfw window.");
+        return false;
+    }
+
+    glfwSetWindowUserPointer(m_Handle, this);
+
+    glfwSetWindowCloseCallback(m_Handle, window_close_callback);
+    GlfwInput::InstallCallbacks(m_Handle);
+
+    glfwSetInputMode(m_Handle, GLFW_STICKY_KEYS, 1);
+    glfwSetInputMode(m_Handle, GLFW_STICKY_MOUSE_BUTTONS, 1);
+
+    return StartApplication();
+}
+
+void LinuxPlatform::MainLoop()
+{
+    while (!ShouldClose())
+    {
+        Tick();
+    }
+}
+
+void LinuxPlatform::Terminate()
+{
+    StopApplication();
+
+    if (m_Handle != nullptr)
+    {
+        glfwDestroyWindow(m_Handle);
+        m_Handle = nullptr;
+    }
+    glfwTerminate();
+}
+
+void LinuxPlatform::Tick()
+{
+    ProcesEvents();
+}
+
+GLFWwindow *LinuxPlatform::GetWindowHandle() const
+{
+    return m_Handle;
+}
+
+const VulkanWindow *LinuxPlatform::GetVulkanWindow() const
+{
+    return this;
+}
+
+std::vector<const char *> LinuxPlatform::GetRequiredInstanceExtensions() const
+{
+    return GlfwSurface::GetRequiredInstanceExtensions();
+}
+
+VkSurfaceKHR LinuxPlatform::CreateSurface(VkInstance instance) const
+{
+    return GlfwSurface::CreateSurface(m_Handle, instance);
+}
+
+VkExtent2D LinuxPlatform::GetWindowExtent() const
+{
+    return GlfwSurface::GetFramebufferExtent(m_Handle);
+}
+
+bool LinuxPlatform::ShouldClose()
+{
+    return glfwWindowShouldClose(m_Handle) || m_FrameLoop.IsStopRequested();
+}
+
+void LinuxPlatform::ProcesEvents()
+{
+    glfwWaitEventsTimeout(EventWaitTimeout);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Platform.h"
+#include "Platform/VulkanWindow.h"
+#include <cstdint>
+
+struct GLFWwindow;
+
+// GLFW window on X11 or Wayland. The platform thread only pumps events, the application runs on the
+// frame loop threads so a slow event queue never holds back rendering.
+class LinuxPlatform : public Platform, public VulkanWindow
+{
+public:
+
+    LinuxPlatform(uint32_t width = 1024, uint32_t height = 768);
+
+    ~LinuxPlatform();
+
+    virtual bool Initialize(std::unique_ptr<Application> &&application) override;
+
+    virtual void MainLoop() override;
+
+    virtual void Terminate() override;
+
+    virtual void Tick() override;
+
+    virtual const VulkanWindow *GetVulkanWindow() const override;
+
+    virtual std::vector<const char *> GetRequiredInstanceExtensions() const override;
+
+    virtual VkSurfaceKHR CreateSurface(VkInstance instance) const override;
+
+    virtual VkExtent2D GetWindowExtent() const override;
+
+    GLFWwindow *GetWindowHandle() const;
+
+private:
+
+    bool ShouldClose();
+
+    void ProcesEvents();
+
+private:
+
+    uint32_t m_Width{ 1024 };
+
+    uint32_t m_Height{ 768 };
+
+    GLFWwindow* m_Handle = nullptr;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include <volk.h>
+
+// Presentation side of a platform with a window. Kept out of Platform.h so code that only drives the
+// frame loop doesn't need the Vulkan headers. Platform thread only, like Application::Prepare().
+class VulkanWindow
+{
+public:
+
+    virtual ~VulkanWindow() = default;
+
+    // Instance extensions CreateSurface() needs, empty when the window system has no Vulkan support.
+    virtual std::vector<const char *> GetRequiredInstanceExtensions() const = 0;
+
+    // VK_NULL_HANDLE on failure. The caller destroys the surface before the instance.
+    virtual VkSurfaceKHR CreateSurface(VkInstance instance) const = 0;
+
+    // Framebuffer size in pixels.
+    virtual VkExtent2D GetWindowExtent() const = 0;
+};
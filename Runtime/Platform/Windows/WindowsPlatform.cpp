@@ -1,7 +1,8 @@
 #include "WindowsPlatform.h"
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
-#include "../../InputEvents.h"
+#include "Platform/GlfwInput.h"
+#include "Platform/GlfwSurface.h"
 
 static void error_callback(int error, const char *description)
 {
@@ -13,47 +14,6 @@ static void window_close_callback(GLFWwindow *window)
     glfwSetWindowShouldClose(window, GLFW_TRUE);
 }
 
-static void window_size_callback(GLFWwindow *window, int width, int height)
-{
-
-}
-
-static void window_focus_callback(GLFWwindow *window, int focused)
-{
-
-}
-
-static inline KeyCode translate_key_code(int key)
-{
-    return KeyCode::Unknown;
-}
-
-static inline KeyAction translate_key_action(int action)
-{
-    return KeyAction::Unknown;
-}
-
-static void key_callback(GLFWwindow *window, int key, int /*scancode*/, int action, int /*mods*/)
-{
-}
-
-static inline MouseButton translate_mouse_button(int button)
-{
-    return MouseButton::Unknown;
-}
-
-static inline MouseAction translate_mouse_action(int action)
-{
-    return MouseAction::Unknown;
-}
-
-static void cursor_position_callback(GLFWwindow *window, double xpos, double ypos)
-{
-}
-
-static void mouse_button_callback(GLFWwindow *window, int button, int action, int /*mods*/)
-{
-}
 WindowsPlatform::WindowsPlatform(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine, INT nCmdShow)
 {
 
@@ -90,16 +50,12 @@ bool WindowsPlatform::Initialize(std::unique_ptr<Application> &&application)
     glfwSetWindowUserPointer(m_Handle, this);
 
     glfwSetWindowCloseCallback(m_Handle, window_close_callback);
-    glfwSetWindowSizeCallback(m_Handle, window_size_callback);
-    glfwSetWindowFocusCallback(m_Handle, window_focus_callback);
-    glfwSetKeyCallback(m_Handle, key_callback);
-    glfwSetCursorPosCallback(m_Handle, cursor_position_callback);
-    glfwSetMouseButtonCallback(m_Handle, mouse_button_callback);
+    GlfwInput::InstallCallbacks(m_Handle);
 
     glfwSetInputMode(m_Handle, GLFW_STICKY_KEYS, 1);
     glfwSetInputMode(m_Handle, GLFW_STICKY_MOUSE_BUTTONS, 1);
 
-    return true;
+    return StartApplication();
 }
 
 void WindowsPlatform::MainLoop()
@@ -113,13 +69,35 @@ void WindowsPlatform::MainLoop()
 
 void WindowsPlatform::Terminate()
 {
+    StopApplication();
+
     glfwDestroyWindow(m_Handle);
     glfwTerminate();
 }
 
+const VulkanWindow *WindowsPlatform::GetVulkanWindow() const
+{
+    return this;
+}
+
+std::vector<const char *> WindowsPlatform::GetRequiredInstanceExtensions() const
+{
+    return GlfwSurface::GetRequiredInstanceExtensions();
+}
+
+VkSurfaceKHR WindowsPlatform::CreateSurface(VkInstance instance) const
+{
+    return GlfwSurface::CreateSurface(m_Handle, instance);
+}
+
+VkExtent2D WindowsPlatform::GetWindowExtent() const
+{
+    return GlfwSurface::GetFramebufferExtent(m_Handle);
+}
+
 bool WindowsPlatform::ShouldClose()
 {
-    return glfwWindowShouldClose(m_Handle);
+    return glfwWindowShouldClose(m_Handle) || m_FrameLoop.IsStopRequested();
 }
 
 void WindowsPlatform::ProcesEvents()
@@ -2,11 +2,12 @@
 
 
 #include "Platform.h"
+#include "Platform/VulkanWindow.h"
 #include <Windows.h>
 
 struct GLFWwindow;
 
-class WindowsPlatform : public Platform
+class WindowsPlatform : public Platform, public VulkanWindow
 {
 public:
 
@@ -22,6 +23,14 @@ public:
 
     virtual void Tick() override;
 
+    virtual const VulkanWindow *GetVulkanWindow() const override;
+
+    virtual std::vector<const char *> GetRequiredInstanceExtensions() const override;
+
+    virtual VkSurfaceKHR CreateSurface(VkInstance instance) const override;
+
+    virtual VkExtent2D GetWindowExtent() const override;
+
 private:
 
     bool ShouldClose();
@@ -0,0 +1,140 @@
+#include "ChromeTraceWriter.h"
+#include <fstream>
+#include "Common/Logging.h"
+
+void ChromeTraceWriter::SetTimeOrigin(int64_t nanoseconds)
+{
+    m_TimeOrigin = nanoseconds;
+}
+
+void ChromeTraceWriter::SetProcessName(uint32_t processId, const std::string &name)
+{
+    BeginEvent();
+    fmt::format_to(std::back_inserter(m_Events), "{{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":{},\"args\":{{\"name\":", processId);
+    AppendString(name.c_str());
+    fmt::format_to(std::back_inserter(m_Events), "}}}}");
+}
+
+void ChromeTraceWriter::SetThreadName(uint32_t processId, uint32_t threadId, const std::string &name, int32_t sortIndex)
+{
+    BeginEvent();
+    fmt::format_to(std::back_inserter(m_Events), "{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":", processId, threadId);
+    AppendString(name.c_str());
+    fmt::format_to(std::back_inserter(m_Events), "}}}}");
+
+    BeginEvent();
+    fmt::format_to(std::back_inserter(m_Events), "{{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":{},\"tid\":{},\"args\":{{\"sort_index\":{}}}}}", processId, threadId, sortIndex);
+}
+
+void ChromeTraceWriter::AddCompleteEvent(uint32_t processId, uint32_t threadId, const char *category, const char *name, int64_t beginNanoseconds, int64_t durationNanoseconds,
+    const TraceArg *args, uint32_t argCount)
+{
+    BeginEvent();
+    fmt::format_to(std::back_inserter(m_Events), "{{\"ph\":\"X\",\"pid\":{},\"tid\":{},\"cat\":", processId, threadId);
+    AppendString(category);
+    fmt::format_to(std::back_inserter(m_Events), ",\"name\":");
+    AppendString(name);
+    fmt::format_to(std::back_inserter(m_Events), ",\"ts\":");
+    AppendTimestamp(beginNanoseconds - m_TimeOrigin);
+    fmt::format_to(std::back_inserter(m_Events), ",\"dur\":");
+    AppendTimestamp(durationNanoseconds);
+    if (argCount > 0)
+    {
+        fmt::format_to(std::back_inserter(m_Events), ",\"args\":{{");
+        for (uint32_t index = 0; index < argCount; ++index)
+        {
+            if (index > 0)
+            {
+                m_Events.push_back(',');
+            }
+            AppendString(args[index].name);
+            fmt::format_to(std::back_inserter(m_Events), ":{}", args[index].value);
+        }
+        m_Events.push_back('}');
+    }
+    m_Events.push_back('}');
+}
+
+void ChromeTraceWriter::AddCounter(uint32_t processId, const char *name, int64_t nanoseconds, double value)
+{
+    BeginEvent();
+    fmt::format_to(std::back_inserter(m_Events), "{{\"ph\":\"C\",\"pid\":{},\"name\":", processId);
+    AppendString(name);
+    fmt::format_to(std::back_inserter(m_Events), ",\"ts\":");
+    AppendTimestamp(nanoseconds - m_TimeOrigin);
+    fmt::format_to(std::back_inserter(m_Events), ",\"args\":{{\"value\":{}}}}}", value);
+}
+
+uint32_t ChromeTraceWriter::GetEventCount() const
+{
+    return m_EventCount;
+}
+
+bool ChromeTraceWriter::Write(const std::string &path) const
+{
+    std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+    if (!file)
+    {
+        LOGE("Couldn't open {} for writing", path);
+        return false;
+    }
+
+    static const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    static const char footer[] = "\n]}\n";
+
+    file.write(header, sizeof(header) - 1);
+    file.write(m_Events.data(), static_cast<std::streamsize>(m_Events.size()));
+    file.write(footer, sizeof(footer) - 1);
+
+    if (!file)
+    {
+        LOGE("Couldn't write trace {}", path);
+        return false;
+    }
+    return true;
+}
+
+void ChromeTraceWriter::BeginEvent()
+{
+    if (m_EventCount++ > 0)
+    {
+        m_Events.append(fmt::string_view{ ",\n" });
+    }
+}
+
+void ChromeTraceWriter::AppendString(const char *value)
+{
+    m_Events.push_back('"');
+    for (const char *character = value; *character != '\0'; ++character)
+    {
+        switch (*character)
+        {
+        case '"': m_Events.append(fmt::string_view{ "\\\"" }); break;
+        case '\\': m_Events.append(fmt::string_view{ "\\\\" }); break;
+        case '\n': m_Events.append(fmt::string_view{ "\\n" }); break;
+        case '\t': m_Events.append(fmt::string_view{ "\\t" }); break;
+        default:
+            if (static_cast<unsigned char>(*character) < 0x20)
+            {
+                fmt::format_to(std::back_inserter(m_Events), "\\u{:04x}", static_cast<unsigned>(*character));
+            }
+            else
+            {
+                m_Events.push_back(*character);
+            }
+            break;
+        }
+    }
+    m_Events.push_back('"');
+}
+
+void ChromeTraceWriter::AppendTimestamp(int64_t nanoseconds)
+{
+    // Trace timestamps are microseconds, keep nanosecond precision in the fraction.
+    if (nanoseconds < 0)
+    {
+        m_Events.push_back('-');
+        nanoseconds = -nanoseconds;
+    }
+    fmt::format_to(std::back_inserter(m_Events), "{}.{:03}", nanoseconds / 1000, nanoseconds % 1000);
+}
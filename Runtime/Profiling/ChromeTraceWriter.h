@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <string>
+#include <spdlog/fmt/fmt.h>
+
+struct TraceArg
+{
+    const char *name;
+
+    double value;
+};
+
+// Builds a Chrome trace event JSON file, which chrome://tracing and ui.perfetto.dev both open. Times
+// are nanoseconds on one clock, written relative to the time origin.
+class ChromeTraceWriter : public NonCopyable
+{
+public:
+
+    ChromeTraceWriter() = default;
+
+    void SetTimeOrigin(int64_t nanoseconds);
+
+    void SetProcessName(uint32_t processId, const std::string &name);
+
+    // Tracks are laid out by sortIndex, lowest first.
+    void SetThreadName(uint32_t processId, uint32_t threadId, const std::string &name, int32_t sortIndex);
+
+    void AddCompleteEvent(uint32_t processId, uint32_t threadId, const char *category, const char *name, int64_t beginNanoseconds, int64_t durationNanoseconds,
+        const TraceArg *args = nullptr, uint32_t argCount = 0);
+
+    void AddCounter(uint32_t processId, const char *name, int64_t nanoseconds, double value);
+
+    uint32_t GetEventCount() const;
+
+    bool Write(const std::string &path) const;
+
+private:
+
+    void BeginEvent();
+
+    void AppendString(const char *value);
+
+    void AppendTimestamp(int64_t nanoseconds);
+
+    fmt::memory_buffer m_Events;
+
+    uint32_t m_EventCount{ 0 };
+
+    int64_t m_TimeOrigin{ 0 };
+};
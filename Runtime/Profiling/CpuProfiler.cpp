@@ -0,0 +1,276 @@
+#include "CpuProfiler.h"
+
+#if defined(NEXT_RENDER_PROFILER)
+
+#include <algorithm>
+#include "ChromeTraceWriter.h"
+#include "Common/Logging.h"
+
+CpuProfiler g_CpuProfiler;
+
+struct CpuProfilerZone
+{
+    std::atomic<const char *> name{ nullptr };
+
+    std::atomic<uint64_t> beginTicks{ 0 };
+
+    std::atomic<uint64_t> endTicks{ 0 };
+};
+
+// Written only by its thread. A slot is claimed before it is overwritten and published after, so a
+// capture running concurrently can tell which of the zones it copied may have been torn.
+struct CpuProfilerThreadBuffer
+{
+    uint32_t threadId{ 0 };
+
+    // Guarded by the profiler mutex.
+    std::string name;
+
+    std::atomic<uint64_t> claimed{ 0 };
+
+    std::atomic<uint64_t> published{ 0 };
+
+    CpuProfilerZone zones[CpuProfiler::ThreadCapacity];
+};
+
+static thread_local CpuProfilerThreadBuffer *t_ThreadBuffer = nullptr;
+
+// First position of [begin, end) that the writer can't have overwritten while it was being copied.
+static uint64_t GetFirstIntactPosition(uint64_t begin, uint64_t claimed, uint32_t capacity)
+{
+    return std::max(begin, claimed > capacity ? claimed - capacity : 0);
+}
+
+CpuProfiler::CpuProfiler() :
+    m_StartTicks{ GetTicks() },
+    m_StartNanoseconds{ GetNanoseconds() },
+    m_Frames{ std::make_unique<FrameMarker[]>(FrameCapacity) }
+{
+}
+
+CpuProfiler::~CpuProfiler()
+{
+}
+
+int64_t CpuProfiler::GetNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CpuProfiler::SetEnabled(bool enabled)
+{
+    m_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::IsEnabled() const
+{
+    return m_Enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetThreadName(const std::string &name)
+{
+    CpuProfilerThreadBuffer *buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock{ m_Mutex };
+    buffer->name = name;
+}
+
+void CpuProfiler::RecordZone(const char *name, uint64_t beginTicks, uint64_t endTicks)
+{
+    if (!m_Enabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    CpuProfilerThreadBuffer *buffer = GetThreadBuffer();
+
+    uint64_t position = buffer->claimed.load(std::memory_order_relaxed);
+    buffer->claimed.store(position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    CpuProfilerZone &zone = buffer->zones[position & (ThreadCapacity - 1)];
+    zone.name.store(name, std::memory_order_relaxed);
+    zone.beginTicks.store(beginTicks, std::memory_order_relaxed);
+    zone.endTicks.store(endTicks, std::memory_order_relaxed);
+
+    buffer->published.store(position + 1, std::memory_order_release);
+}
+
+void CpuProfiler::BeginFrame(uint64_t frameIndex)
+{
+    m_PendingFrameIndex = frameIndex;
+    m_PendingFrameBegin = GetTicks();
+}
+
+void CpuProfiler::EndFrame()
+{
+    if (!m_Enabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    uint64_t position = m_FrameClaimIndex.load(std::memory_order_relaxed);
+    m_FrameClaimIndex.store(position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    FrameMarker &frame = m_Frames[position & (FrameCapacity - 1)];
+    frame.frameIndex.store(m_PendingFrameIndex, std::memory_order_relaxed);
+    frame.beginTicks.store(m_PendingFrameBegin, std::memory_order_relaxed);
+    frame.endTicks.store(GetTicks(), std::memory_order_relaxed);
+
+    m_FrameWriteIndex.store(position + 1, std::memory_order_release);
+}
+
+int64_t CpuProfiler::TicksToNanoseconds(uint64_t ticks) const
+{
+    double nanosecondsPerTick = 1.0;
+    uint64_t originTicks = 0;
+    int64_t originNanoseconds = 0;
+    Calibrate(nanosecondsPerTick, originTicks, originNanoseconds);
+
+    return originNanoseconds + static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(ticks - originTicks)) * nanosecondsPerTick);
+}
+
+void CpuProfiler::Capture(ChromeTraceWriter &writer) const
+{
+    double nanosecondsPerTick = 1.0;
+    uint64_t originTicks = 0;
+    int64_t originNanoseconds = 0;
+    Calibrate(nanosecondsPerTick, originTicks, originNanoseconds);
+
+    auto toNanoseconds = [&](uint64_t ticks)
+    {
+        return originNanoseconds + static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(ticks - originTicks)) * nanosecondsPerTick);
+    };
+
+    writer.SetProcessName(ProcessId, "CPU");
+    writer.SetThreadName(ProcessId, FrameTrackId, "Frames", -1);
+
+    // Frames.
+    {
+        uint64_t end = m_FrameWriteIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > FrameCapacity ? end - FrameCapacity : 0;
+
+        struct FrameCopy
+        {
+            uint64_t frameIndex;
+            uint64_t beginTicks;
+            uint64_t endTicks;
+        };
+        std::vector<FrameCopy> frames;
+        frames.reserve(static_cast<size_t>(end - begin));
+        for (uint64_t position = begin; position < end; ++position)
+        {
+            const FrameMarker &frame = m_Frames[position & (FrameCapacity - 1)];
+            frames.push_back({ frame.frameIndex.load(std::memory_order_relaxed), frame.beginTicks.load(std::memory_order_relaxed), frame.endTicks.load(std::memory_order_relaxed) });
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t intact = GetFirstIntactPosition(begin, m_FrameClaimIndex.load(std::memory_order_relaxed), FrameCapacity);
+
+        std::string name;
+        for (uint64_t position = intact; position < end; ++position)
+        {
+            const FrameCopy &frame = frames[static_cast<size_t>(position - begin)];
+            name = "Frame " + std::to_string(frame.frameIndex);
+
+            int64_t beginNanoseconds = toNanoseconds(frame.beginTicks);
+            writer.AddCompleteEvent(ProcessId, FrameTrackId, "frame", name.c_str(), beginNanoseconds, toNanoseconds(frame.endTicks) - beginNanoseconds);
+        }
+    }
+
+    // Zones, one track per thread.
+    std::lock_guard<std::mutex> lock{ m_Mutex };
+
+    std::vector<CpuProfilerThreadBuffer *> threads;
+    for (const std::unique_ptr<CpuProfilerThreadBuffer> &thread : m_Threads)
+    {
+        threads.push_back(thread.get());
+    }
+
+    struct ZoneCopy
+    {
+        const char *name;
+        uint64_t beginTicks;
+        uint64_t endTicks;
+    };
+    std::vector<ZoneCopy> zones;
+
+    for (CpuProfilerThreadBuffer *thread : threads)
+    {
+        writer.SetThreadName(ProcessId, thread->threadId, thread->name.empty() ? "Thread " + std::to_string(thread->threadId) : thread->name, static_cast<int32_t>(thread->threadId));
+
+        uint64_t end = thread->published.load(std::memory_order_acquire);
+        uint64_t begin = end > ThreadCapacity ? end - ThreadCapacity : 0;
+
+        zones.clear();
+        for (uint64_t position = begin; position < end; ++position)
+        {
+            const CpuProfilerZone &zone = thread->zones[position & (ThreadCapacity - 1)];
+            zones.push_back({ zone.name.load(std::memory_order_relaxed), zone.beginTicks.load(std::memory_order_relaxed), zone.endTicks.load(std::memory_order_relaxed) });
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t intact = GetFirstIntactPosition(begin, thread->claimed.load(std::memory_order_relaxed), ThreadCapacity);
+
+        for (uint64_t position = intact; position < end; ++position)
+        {
+            const ZoneCopy &zone = zones[static_cast<size_t>(position - begin)];
+
+            int64_t beginNanoseconds = toNanoseconds(zone.beginTicks);
+            writer.AddCompleteEvent(ProcessId, thread->threadId, "cpu", zone.name, beginNanoseconds, toNanoseconds(zone.endTicks) - beginNanoseconds);
+        }
+    }
+}
+
+bool CpuProfiler::ExportChromeTrace(const std::string &path) const
+{
+    ChromeTraceWriter writer;
+    writer.SetTimeOrigin(m_StartNanoseconds);
+    Capture(writer);
+
+    if (!writer.Write(path))
+    {
+        return false;
+    }
+
+    LOGI("Wrote {} trace events to {}", writer.GetEventCount(), path);
+    return true;
+}
+
+CpuProfilerThreadBuffer *CpuProfiler::GetThreadBuffer()
+{
+    if (t_ThreadBuffer != nullptr)
+    {
+        return t_ThreadBuffer;
+    }
+
+    // Kept after the thread exits so its zones still show up in later captures.
+    std::unique_ptr<CpuProfilerThreadBuffer> buffer = std::make_unique<CpuProfilerThreadBuffer>();
+    t_ThreadBuffer = buffer.get();
+
+    std::lock_guard<std::mutex> lock{ m_Mutex };
+    buffer->threadId = static_cast<uint32_t>(m_Threads.size()) + 1;
+    m_Threads.push_back(std::move(buffer));
+    return t_ThreadBuffer;
+}
+
+void CpuProfiler::Calibrate(double &nanosecondsPerTick, uint64_t &originTicks, int64_t &originNanoseconds) const
+{
+    uint64_t ticks = GetTicks();
+    int64_t nanoseconds = GetNanoseconds();
+
+    originTicks = m_StartTicks;
+    originNanoseconds = m_StartNanoseconds;
+
+#if defined(NEXT_RENDER_PROFILER_RDTSC)
+    // The longer the profiler has been running the better the estimate of the TSC rate.
+    nanosecondsPerTick = ticks > m_StartTicks ? static_cast<double>(nanoseconds - m_StartNanoseconds) / static_cast<double>(ticks - m_StartTicks) : 1.0;
+#else
+    (void)ticks;
+    (void)nanoseconds;
+    nanosecondsPerTick = 1.0;
+#endif
+}
+
+#endif
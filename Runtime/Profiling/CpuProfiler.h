@@ -0,0 +1,160 @@
+#pragma once
+
+// Scoped CPU zones, frame markers and thread names, exported as a Chrome trace. Everything, macros
+// included, compiles to nothing unless NEXT_RENDER_PROFILER is defined.
+
+#if defined(NEXT_RENDER_PROFILER)
+
+#include "Common/Utils.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define NEXT_RENDER_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NEXT_RENDER_PROFILER_RDTSC 1
+#endif
+
+class ChromeTraceWriter;
+
+struct CpuProfilerThreadBuffer;
+
+class CpuProfiler : public NonCopyable
+{
+public:
+
+    // Zones kept per thread, older ones are overwritten; 24 bytes each.
+    static constexpr uint32_t ThreadCapacity = 1 << 15;
+
+    static constexpr uint32_t FrameCapacity = 1024;
+
+    // Trace process and track ids used by Capture().
+    static constexpr uint32_t ProcessId = 1;
+
+    static constexpr uint32_t FrameTrackId = 0;
+
+    CpuProfiler();
+
+    ~CpuProfiler();
+
+    // Raw timestamp, invariant TSC where available.
+    static uint64_t GetTicks()
+    {
+#if defined(NEXT_RENDER_PROFILER_RDTSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Nanoseconds on std::chrono::steady_clock, the timeline every exported event uses.
+    static int64_t GetNanoseconds();
+
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const;
+
+    // Names the calling thread's track.
+    void SetThreadName(const std::string &name);
+
+    // name must outlive the capture, string literals and __func__ do.
+    void RecordZone(const char *name, uint64_t beginTicks, uint64_t endTicks);
+
+    // Render thread only.
+    void BeginFrame(uint64_t frameIndex);
+
+    void EndFrame();
+
+    // Uses the TSC rate measured since construction.
+    int64_t TicksToNanoseconds(uint64_t ticks) const;
+
+    // Appends every buffered zone and frame to writer.
+    void Capture(ChromeTraceWriter &writer) const;
+
+    bool ExportChromeTrace(const std::string &path) const;
+
+private:
+
+    struct FrameMarker
+    {
+        std::atomic<uint64_t> frameIndex{ 0 };
+
+        std::atomic<uint64_t> beginTicks{ 0 };
+
+        std::atomic<uint64_t> endTicks{ 0 };
+    };
+
+    CpuProfilerThreadBuffer *GetThreadBuffer();
+
+    void Calibrate(double &nanosecondsPerTick, uint64_t &originTicks, int64_t &originNanoseconds) const;
+
+    std::atomic<bool> m_Enabled{ true };
+
+    uint64_t m_StartTicks{ 0 };
+
+    int64_t m_StartNanoseconds{ 0 };
+
+    mutable std::mutex m_Mutex;
+
+    std::vector<std::unique_ptr<CpuProfilerThreadBuffer>> m_Threads;
+
+    uint64_t m_PendingFrameIndex{ 0 };
+
+    uint64_t m_PendingFrameBegin{ 0 };
+
+    std::atomic<uint64_t> m_FrameClaimIndex{ 0 };
+
+    std::atomic<uint64_t> m_FrameWriteIndex{ 0 };
+
+    std::unique_ptr<FrameMarker[]> m_Frames;
+};
+
+extern CpuProfiler g_CpuProfiler;
+
+class ProfileScope : public NonCopyable
+{
+public:
+
+    explicit ProfileScope(const char *name) :
+        m_Name{ name },
+        m_BeginTicks{ CpuProfiler::GetTicks() }
+    {
+    }
+
+    ~ProfileScope()
+    {
+        g_CpuProfiler.RecordZone(m_Name, m_BeginTicks, CpuProfiler::GetTicks());
+    }
+
+private:
+
+    const char *m_Name;
+
+    uint64_t m_BeginTicks;
+};
+
+#define NEXT_RENDER_PROFILE_CONCAT_INNER(a, b) a##b
+#define NEXT_RENDER_PROFILE_CONCAT(a, b) NEXT_RENDER_PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_SCOPE(name) ProfileScope NEXT_RENDER_PROFILE_CONCAT(profileScope, __LINE__){ name }
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(name) g_CpuProfiler.SetThreadName(name)
+#define PROFILE_FRAME_BEGIN(frameIndex) g_CpuProfiler.BeginFrame(frameIndex)
+#define PROFILE_FRAME_END() g_CpuProfiler.EndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_FRAME_BEGIN(frameIndex)
+#define PROFILE_FRAME_END()
+
+#endif
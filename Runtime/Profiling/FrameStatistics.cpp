@@ -0,0 +1,40 @@
+#include "FrameStatistics.h"
+#include <algorithm>
+#include <cmath>
+
+FrameStatistics FrameStatistics::Compute(std::vector<double> &samples)
+{
+    FrameStatistics statistics{};
+    if (samples.empty())
+    {
+        return statistics;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples)
+    {
+        sum += sample;
+    }
+
+    statistics.sampleCount = static_cast<uint32_t>(samples.size());
+    statistics.mean = sum / static_cast<double>(samples.size());
+    statistics.p50 = Percentile(samples, 50.0);
+    statistics.p95 = Percentile(samples, 95.0);
+    statistics.p99 = Percentile(samples, 99.0);
+    statistics.max = samples.back();
+    return statistics;
+}
+
+double FrameStatistics::Percentile(const std::vector<double> &sortedSamples, double percentile)
+{
+    if (sortedSamples.empty())
+    {
+        return 0.0;
+    }
+
+    double rank = std::ceil(percentile / 100.0 * static_cast<double>(sortedSamples.size()));
+    size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    return sortedSamples[std::min(index, sortedSamples.size() - 1)];
+}
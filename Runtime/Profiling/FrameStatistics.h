@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Distribution of a per-frame measurement, in the unit of the samples.
+struct FrameStatistics
+{
+    uint32_t sampleCount{ 0 };
+
+    double mean{ 0.0 };
+
+    double p50{ 0.0 };
+
+    double p95{ 0.0 };
+
+    double p99{ 0.0 };
+
+    double max{ 0.0 };
+
+    // Sorts samples in place. Percentiles use the nearest rank, so they are always one of the samples.
+    static FrameStatistics Compute(std::vector<double> &samples);
+
+    // percentile in [0, 100], samples sorted ascending.
+    static double Percentile(const std::vector<double> &sortedSamples, double percentile);
+};
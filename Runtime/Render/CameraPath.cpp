@@ -0,0 +1,135 @@
+#include "CameraPath.h"
+#include "Common/Json.h"
+#include "Common/Logging.h"
+#include <algorithm>
+#include <cassert>
+#include <glm/gtc/matrix_transform.hpp>
+
+static glm::vec3 CatmullRom(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3, float t)
+{
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+static bool ReadVec3(const JsonValue &value, glm::vec3 &result)
+{
+    if (!value.IsArray() || value.Size() != 3)
+    {
+        return false;
+    }
+
+    for (uint32_t component = 0; component < 3; ++component)
+    {
+        if (!value.At(component).IsNumber())
+        {
+            return false;
+        }
+        result[component] = static_cast<float>(value.At(component).AsNumber());
+    }
+    return true;
+}
+
+glm::mat4 CameraPose::GetViewMatrix() const
+{
+    // Straight up or down the world up axis is degenerate for lookAt, tilt the up vector instead.
+    glm::vec3 forward = target - position;
+    glm::vec3 up{ 0.0f, 1.0f, 0.0f };
+    if (glm::length(glm::cross(forward, up)) < 1e-6f * glm::length(forward))
+    {
+        up = glm::vec3{ 0.0f, 0.0f, -1.0f };
+    }
+    return glm::lookAt(position, target, up);
+}
+
+bool CameraPath::Load(const JsonValue &keyframes)
+{
+    m_Keyframes.clear();
+
+    if (!keyframes.IsArray())
+    {
+        LOGE("Camera path keyframes must be an array");
+        return false;
+    }
+
+    std::vector<CameraKeyframe> loaded;
+    loaded.reserve(keyframes.Size());
+
+    for (const JsonValue &entry : keyframes.GetElements())
+    {
+        CameraKeyframe keyframe{};
+        keyframe.time = static_cast<float>(entry["time"].AsNumber(-1.0));
+
+        if (keyframe.time < 0.0f || !ReadVec3(entry["position"], keyframe.position) || !ReadVec3(entry["target"], keyframe.target))
+        {
+            LOGE("Malformed camera keyframe {}", loaded.size());
+            return false;
+        }
+
+        if (!loaded.empty() && keyframe.time <= loaded.back().time)
+        {
+            LOGE("Camera keyframe {} does not come after the previous one", loaded.size());
+            return false;
+        }
+
+        loaded.push_back(keyframe);
+    }
+
+    m_Keyframes = std::move(loaded);
+    return true;
+}
+
+void CameraPath::AddKeyframe(const CameraKeyframe &keyframe)
+{
+    assert((m_Keyframes.empty() || keyframe.time > m_Keyframes.back().time) && "Keyframes must be added in time order");
+    m_Keyframes.push_back(keyframe);
+}
+
+CameraPose CameraPath::Evaluate(float time) const
+{
+    CameraPose pose{};
+    if (m_Keyframes.empty())
+    {
+        return pose;
+    }
+
+    if (time <= m_Keyframes.front().time || m_Keyframes.size() == 1)
+    {
+        pose.position = m_Keyframes.front().position;
+        pose.target = m_Keyframes.front().target;
+        return pose;
+    }
+
+    if (time >= m_Keyframes.back().time)
+    {
+        pose.position = m_Keyframes.back().position;
+        pose.target = m_Keyframes.back().target;
+        return pose;
+    }
+
+    // First keyframe after time, the segment runs from the one before it.
+    auto next = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), time, [](float value, const CameraKeyframe &keyframe) { return value < keyframe.time; });
+    size_t segment = static_cast<size_t>(next - m_Keyframes.begin()) - 1;
+    size_t last = m_Keyframes.size() - 1;
+
+    // The end points are repeated, which makes the spline start and stop on the first and last keyframes.
+    const CameraKeyframe &k0 = m_Keyframes[segment > 0 ? segment - 1 : 0];
+    const CameraKeyframe &k1 = m_Keyframes[segment];
+    const CameraKeyframe &k2 = m_Keyframes[segment + 1];
+    const CameraKeyframe &k3 = m_Keyframes[std::min(segment + 2, last)];
+
+    float t = (time - k1.time) / (k2.time - k1.time);
+    pose.position = CatmullRom(k0.position, k1.position, k2.position, k3.position, t);
+    pose.target = CatmullRom(k0.target, k1.target, k2.target, k3.target, t);
+    return pose;
+}
+
+float CameraPath::GetDuration() const
+{
+    return m_Keyframes.empty() ? 0.0f : m_Keyframes.back().time;
+}
+
+const std::vector<CameraKeyframe> &CameraPath::GetKeyframes() const
+{
+    return m_Keyframes;
+}
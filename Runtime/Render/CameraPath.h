@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <vector>
+#include <glm/glm.hpp>
+
+class JsonValue;
+
+struct CameraKeyframe
+{
+    // Seconds from the start of the path, strictly increasing between keyframes.
+    float time{ 0.0f };
+
+    glm::vec3 position{ 0.0f };
+
+    glm::vec3 target{ 0.0f, 0.0f, -1.0f };
+};
+
+struct CameraPose
+{
+    glm::vec3 position{ 0.0f };
+
+    glm::vec3 target{ 0.0f, 0.0f, -1.0f };
+
+    glm::mat4 GetViewMatrix() const;
+};
+
+// Scripted camera flight, a Catmull-Rom spline through the positions and targets of the keyframes.
+// Evaluation is a pure function of the time, so a path replays identically at any frame rate.
+class CameraPath : public NonCopyable
+{
+public:
+
+    CameraPath() = default;
+
+    // Reads [{ "time": 0, "position": [x, y, z], "target": [x, y, z] }, ...]. Returns false and leaves
+    // the path empty when an entry is malformed or the times don't increase.
+    bool Load(const JsonValue &keyframes);
+
+    void AddKeyframe(const CameraKeyframe &keyframe);
+
+    // Times before the first or after the last keyframe clamp to the ends.
+    CameraPose Evaluate(float time) const;
+
+    float GetDuration() const;
+
+    const std::vector<CameraKeyframe> &GetKeyframes() const;
+
+private:
+
+    std::vector<CameraKeyframe> m_Keyframes;
+};
@@ -0,0 +1,60 @@
+#include "Frustum.h"
+#include "Mesh.h"
+
+static glm::vec4 GetRow(const glm::mat4 &matrix, int row)
+{
+    return glm::vec4{ matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row] };
+}
+
+static glm::vec4 NormalizePlane(const glm::vec4 &plane)
+{
+    float length = glm::length(glm::vec3{ plane.x, plane.y, plane.z });
+    return length > 0.0f ? plane / length : plane;
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4 &viewProjection)
+{
+    glm::vec4 row0 = GetRow(viewProjection, 0);
+    glm::vec4 row1 = GetRow(viewProjection, 1);
+    glm::vec4 row2 = GetRow(viewProjection, 2);
+    glm::vec4 row3 = GetRow(viewProjection, 3);
+
+    Frustum frustum;
+    frustum.planes[Left] = NormalizePlane(row3 + row0);
+    frustum.planes[Right] = NormalizePlane(row3 - row0);
+    frustum.planes[Bottom] = NormalizePlane(row3 + row1);
+    frustum.planes[Top] = NormalizePlane(row3 - row1);
+    frustum.planes[Near] = NormalizePlane(row2);
+    frustum.planes[Far] = NormalizePlane(row3 - row2);
+    return frustum;
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3 &center, float radius) const
+{
+    for (const glm::vec4 &plane : planes)
+    {
+        if (glm::dot(glm::vec3{ plane.x, plane.y, plane.z }, center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::IntersectsBox(const BoundingBox &box) const
+{
+    for (const glm::vec4 &plane : planes)
+    {
+        // Test the corner furthest along the plane normal.
+        glm::vec3 corner{
+            plane.x >= 0.0f ? box.max.x : box.min.x,
+            plane.y >= 0.0f ? box.max.y : box.min.y,
+            plane.z >= 0.0f ? box.max.z : box.min.z };
+
+        if (glm::dot(glm::vec3{ plane.x, plane.y, plane.z }, corner) + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
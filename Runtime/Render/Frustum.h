@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+struct BoundingBox;
+
+// Six normalised planes pointing inwards, stored as (normal, distance).
+struct Frustum
+{
+    enum Plane
+    {
+        Left,
+
+        Right,
+
+        Bottom,
+
+        Top,
+
+        Near,
+
+        Far,
+
+        PlaneCount,
+    };
+
+    glm::vec4 planes[PlaneCount];
+
+    // Extracts the planes of a Vulkan style clip space (depth in [0, 1]). Passing
+    // viewProjection * world yields the planes in the object space of world.
+    static Frustum FromMatrix(const glm::mat4 &viewProjection);
+
+    bool IntersectsSphere(const glm::vec3 &center, float radius) const;
+
+    bool IntersectsBox(const BoundingBox &box) const;
+};
@@ -0,0 +1,215 @@
+#include "GpuScene.h"
+#include "LodSelector.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+static float GetMaxScale(const glm::mat4 &world)
+{
+    float scaleX = glm::dot(glm::vec3{ world[0] }, glm::vec3{ world[0] });
+    float scaleY = glm::dot(glm::vec3{ world[1] }, glm::vec3{ world[1] });
+    float scaleZ = glm::dot(glm::vec3{ world[2] }, glm::vec3{ world[2] });
+    return std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+}
+
+GpuCullParams GpuCullParams::FromView(const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition, const LodSelectionParams &lodParams)
+{
+    GpuCullParams params{};
+    params.frustum = Frustum::FromMatrix(viewProjection);
+    params.cameraPosition = cameraPosition;
+    params.lodScale = lodParams.viewportHeight / (2.0f * std::tan(lodParams.verticalFov * 0.5f));
+    params.maxScreenError = lodParams.maxScreenError;
+    return params;
+}
+
+uint32_t GpuScene::AddGeometry(const Mesh &mesh, uint32_t subMeshIndex, uint32_t firstIndex, int32_t vertexOffset)
+{
+    assert(subMeshIndex < mesh.GetSubMeshes().size());
+
+    const BoundingBox &bounds = mesh.GetBounds();
+
+    GpuDrawGeometry geometry{};
+    geometry.boundingSphere = glm::vec4{ (bounds.min + bounds.max) * 0.5f, glm::length(bounds.max - bounds.min) * 0.5f };
+    geometry.vertexOffset = vertexOffset;
+
+    uint32_t lodCount = std::min(mesh.GetLodCount(), MaxMeshLods);
+    for (uint32_t lod = 0; lod < lodCount; ++lod)
+    {
+        const std::vector<SubMesh> &subMeshes = mesh.GetLodSubMeshes(lod);
+        if (subMeshIndex >= subMeshes.size() || subMeshes[subMeshIndex].indexCount == 0)
+        {
+            break;
+        }
+
+        GpuLodRange &range = geometry.lods[geometry.lodCount++];
+        range.firstIndex = firstIndex + subMeshes[subMeshIndex].indexOffset;
+        range.indexCount = subMeshes[subMeshIndex].indexCount;
+        range.error = mesh.GetLodError(lod);
+    }
+
+    m_Geometries.push_back(geometry);
+    return static_cast<uint32_t>(m_Geometries.size() - 1);
+}
+
+uint32_t GpuScene::AddInstance(uint32_t geometryIndex, uint32_t pipelineIndex, const glm::mat4 &world, uint32_t objectId)
+{
+    assert(geometryIndex < m_Geometries.size());
+
+    GpuInstance instance{};
+    instance.world = world;
+    instance.geometryIndex = geometryIndex;
+    instance.pipelineIndex = pipelineIndex;
+    instance.objectId = objectId;
+    instance.maxScale = GetMaxScale(world);
+    m_Instances.push_back(instance);
+
+    if (pipelineIndex >= m_PipelineInstanceCounts.size())
+    {
+        m_PipelineInstanceCounts.resize(pipelineIndex + 1, 0);
+    }
+    ++m_PipelineInstanceCounts[pipelineIndex];
+    m_DrawOffsetsDirty = true;
+
+    uint32_t instanceIndex = static_cast<uint32_t>(m_Instances.size() - 1);
+    MarkDirty(instanceIndex);
+    return instanceIndex;
+}
+
+void GpuScene::SetInstanceTransform(uint32_t instanceIndex, const glm::mat4 &world)
+{
+    GpuInstance &instance = m_Instances[instanceIndex];
+    instance.world = world;
+    instance.maxScale = GetMaxScale(world);
+    MarkDirty(instanceIndex);
+}
+
+const std::vector<GpuDrawGeometry> &GpuScene::GetGeometries() const
+{
+    return m_Geometries;
+}
+
+const std::vector<GpuInstance> &GpuScene::GetInstances() const
+{
+    return m_Instances;
+}
+
+uint32_t GpuScene::GetPipelineCount() const
+{
+    return static_cast<uint32_t>(m_PipelineInstanceCounts.size());
+}
+
+const std::vector<uint32_t> &GpuScene::GetDrawOffsets()
+{
+    if (m_DrawOffsetsDirty)
+    {
+        m_DrawOffsets.resize(m_PipelineInstanceCounts.size() + 1);
+
+        uint32_t offset = 0;
+        for (size_t pipeline = 0; pipeline < m_PipelineInstanceCounts.size(); ++pipeline)
+        {
+            m_DrawOffsets[pipeline] = offset;
+            offset += m_PipelineInstanceCounts[pipeline];
+        }
+        m_DrawOffsets.back() = offset;
+
+        m_DrawOffsetsDirty = false;
+    }
+
+    return m_DrawOffsets;
+}
+
+uint32_t GpuScene::GetDirtyBegin() const
+{
+    return m_DirtyBegin;
+}
+
+uint32_t GpuScene::GetDirtyEnd() const
+{
+    return m_DirtyEnd;
+}
+
+void GpuScene::ClearDirtyRange()
+{
+    m_DirtyBegin = 0;
+    m_DirtyEnd = 0;
+}
+
+void GpuScene::MarkDirty(uint32_t instanceIndex)
+{
+    if (m_DirtyBegin >= m_DirtyEnd)
+    {
+        m_DirtyBegin = instanceIndex;
+        m_DirtyEnd = instanceIndex + 1;
+        return;
+    }
+
+    m_DirtyBegin = std::min(m_DirtyBegin, instanceIndex);
+    m_DirtyEnd = std::max(m_DirtyEnd, instanceIndex + 1);
+}
+
+uint32_t GpuSceneCuller::CullInstance(const GpuDrawGeometry &geometry, const GpuInstance &instance, const GpuCullParams &params)
+{
+    glm::vec4 center = instance.world * glm::vec4{ geometry.boundingSphere.x, geometry.boundingSphere.y, geometry.boundingSphere.z, 1.0f };
+    float radius = geometry.boundingSphere.w * instance.maxScale;
+
+    if (geometry.lodCount == 0 || !params.frustum.IntersectsSphere(glm::vec3{ center }, radius))
+    {
+        return ~0u;
+    }
+
+    // Distance to the sphere rather than its center, so large objects near the camera keep detail.
+    float distance = std::max(glm::length(glm::vec3{ center } - params.cameraPosition) - radius, 1e-4f);
+    float scale = instance.maxScale * params.lodScale / distance;
+
+    uint32_t lod = 0;
+    while (lod + 1 < geometry.lodCount && geometry.lods[lod + 1].error * scale <= params.maxScreenError)
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+void GpuSceneCuller::Cull(GpuScene &scene, const GpuCullParams &params, std::vector<DrawIndexedIndirectCommand> &draws, std::vector<uint32_t> &drawCounts, GpuCullStats *stats)
+{
+    const std::vector<uint32_t> &drawOffsets = scene.GetDrawOffsets();
+    const std::vector<GpuDrawGeometry> &geometries = scene.GetGeometries();
+    const std::vector<GpuInstance> &instances = scene.GetInstances();
+
+    draws.assign(drawOffsets.back(), DrawIndexedIndirectCommand{});
+    drawCounts.assign(scene.GetPipelineCount(), 0);
+
+    for (uint32_t instanceIndex = 0; instanceIndex < instances.size(); ++instanceIndex)
+    {
+        const GpuInstance &instance = instances[instanceIndex];
+        const GpuDrawGeometry &geometry = geometries[instance.geometryIndex];
+
+        uint32_t lod = CullInstance(geometry, instance, params);
+
+        if (stats != nullptr)
+        {
+            ++stats->instanceCount;
+            if (lod == ~0u)
+            {
+                ++stats->frustumCulled;
+            }
+            else
+            {
+                ++stats->visibleCount;
+                ++stats->lodHistogram[lod];
+            }
+        }
+
+        if (lod == ~0u)
+        {
+            continue;
+        }
+
+        DrawIndexedIndirectCommand &draw = draws[drawOffsets[instance.pipelineIndex] + drawCounts[instance.pipelineIndex]++];
+        draw.indexCount = geometry.lods[lod].indexCount;
+        draw.instanceCount = 1;
+        draw.firstIndex = geometry.lods[lod].firstIndex;
+        draw.vertexOffset = geometry.vertexOffset;
+        draw.firstInstance = instanceIndex;
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Frustum.h"
+#include "MeshletCuller.h"
+#include "MeshSimplifier.h"
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Mesh;
+
+struct LodSelectionParams;
+
+struct GpuLodRange
+{
+    uint32_t firstIndex;
+
+    uint32_t indexCount;
+
+    // Object space error of the level, see Mesh::GetLodError().
+    float error;
+
+    uint32_t padding;
+};
+
+// std430 layout of one submesh and its LOD chain in the geometry buffer.
+struct GpuDrawGeometry
+{
+    // Object space center and radius.
+    glm::vec4 boundingSphere;
+
+    uint32_t lodCount;
+
+    int32_t vertexOffset;
+
+    uint32_t padding[2];
+
+    GpuLodRange lods[MaxMeshLods];
+};
+
+static_assert(sizeof(GpuDrawGeometry) == 160, "GpuDrawGeometry must match the std430 layout of the geometry buffer");
+
+// std430 layout of one instance, the vertex shader reads it with gl_InstanceIndex.
+struct GpuInstance
+{
+    glm::mat4 world;
+
+    uint32_t geometryIndex;
+
+    uint32_t pipelineIndex;
+
+    uint32_t objectId;
+
+    // Largest axis scale of world, used for the bounding sphere and LOD error.
+    float maxScale;
+};
+
+static_assert(sizeof(GpuInstance) == 80, "GpuInstance must match the std430 layout of the instance buffer");
+
+struct GpuCullParams
+{
+    Frustum frustum{};
+
+    glm::vec3 cameraPosition{ 0.0f };
+
+    // Pixels per world unit at distance 1, viewportHeight / (2 * tan(verticalFov / 2)).
+    float lodScale{ 0.0f };
+
+    float maxScreenError{ 1.0f };
+
+    static GpuCullParams FromView(const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition, const LodSelectionParams &lodParams);
+};
+
+struct GpuCullStats
+{
+    uint32_t instanceCount{ 0 };
+
+    uint32_t frustumCulled{ 0 };
+
+    uint32_t visibleCount{ 0 };
+
+    uint32_t lodHistogram[MaxMeshLods]{};
+};
+
+// Scene description for GPU driven rendering: every submesh is a geometry entry with its LOD ranges,
+// every object an instance pointing at one. Draw commands of a pipeline live in a fixed region of the
+// draw buffer sized for all of its instances, so culling only needs one atomic per visible instance.
+class GpuScene : public NonCopyable
+{
+public:
+
+    // firstIndex and vertexOffset locate the mesh in the shared index and vertex buffers. Returns the
+    // geometry index.
+    uint32_t AddGeometry(const Mesh &mesh, uint32_t subMeshIndex, uint32_t firstIndex, int32_t vertexOffset);
+
+    uint32_t AddInstance(uint32_t geometryIndex, uint32_t pipelineIndex, const glm::mat4 &world, uint32_t objectId);
+
+    void SetInstanceTransform(uint32_t instanceIndex, const glm::mat4 &world);
+
+    const std::vector<GpuDrawGeometry> &GetGeometries() const;
+
+    const std::vector<GpuInstance> &GetInstances() const;
+
+    uint32_t GetPipelineCount() const;
+
+    // First draw slot of every pipeline, followed by the total slot count.
+    const std::vector<uint32_t> &GetDrawOffsets();
+
+    // Instances changed since the last ClearDirtyRange(), empty when begin >= end.
+    uint32_t GetDirtyBegin() const;
+
+    uint32_t GetDirtyEnd() const;
+
+    void ClearDirtyRange();
+
+private:
+
+    void MarkDirty(uint32_t instanceIndex);
+
+    std::vector<GpuDrawGeometry> m_Geometries;
+
+    std::vector<GpuInstance> m_Instances;
+
+    std::vector<uint32_t> m_PipelineInstanceCounts;
+
+    std::vector<uint32_t> m_DrawOffsets;
+
+    bool m_DrawOffsetsDirty{ true };
+
+    uint32_t m_DirtyBegin{ 0 };
+
+    uint32_t m_DirtyEnd{ 0 };
+};
+
+// CPU reference of the culling shader in VulkanGpuScene, handy to validate it under lavapipe.
+namespace GpuSceneCuller
+{
+    // Returns the selected LOD, or ~0u when the instance is culled.
+    uint32_t CullInstance(const GpuDrawGeometry &geometry, const GpuInstance &instance, const GpuCullParams &params);
+
+    // Fills draws (one region per pipeline, see GpuScene::GetDrawOffsets()) and the per-pipeline
+    // draw counts. Unused slots are left zeroed.
+    void Cull(GpuScene &scene, const GpuCullParams &params, std::vector<DrawIndexedIndirectCommand> &draws, std::vector<uint32_t> &drawCounts, GpuCullStats *stats = nullptr);
+}
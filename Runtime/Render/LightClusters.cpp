@@ -0,0 +1,437 @@
+#include "LightClusters.h"
+#include "Thread/ParallelFor.h"
+#include "Thread/ThreadPool.h"
+#include "Profiling/CpuProfiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIGHT_CLUSTERS_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Candidate streams of a slice, each padded to a multiple of four lights.
+enum LightStream
+{
+    LightStreamX,
+
+    LightStreamY,
+
+    LightStreamZ,
+
+    LightStreamRange,
+
+    LightStreamAxisX,
+
+    LightStreamAxisY,
+
+    LightStreamAxisZ,
+
+    LightStreamCos,
+
+    LightStreamSin,
+
+    LightStreamCount,
+};
+
+// Padding lanes sit far away with zero range, so no test ever accepts them.
+static constexpr float PaddingPosition = 1e18f;
+
+static uint32_t AlignToFour(uint32_t value)
+{
+    return (value + 3) & ~3u;
+}
+
+// Bit per lane of the four candidates from group on that reach the cluster.
+static uint32_t TestGroupScalar(float *const *streams, uint32_t group, const LightClusterBounds &bounds)
+{
+    uint32_t mask = 0;
+    for (uint32_t lane = 0; lane < 4; ++lane)
+    {
+        uint32_t candidate = group + lane;
+        glm::vec3 position{ streams[LightStreamX][candidate], streams[LightStreamY][candidate], streams[LightStreamZ][candidate] };
+        float range = streams[LightStreamRange][candidate];
+        if (!LightClusterBuilder::IntersectsSphere(bounds, position, range))
+        {
+            continue;
+        }
+
+        glm::vec3 axis{ streams[LightStreamAxisX][candidate], streams[LightStreamAxisY][candidate], streams[LightStreamAxisZ][candidate] };
+        if (LightClusterBuilder::IntersectsCone(bounds, position, axis, range, streams[LightStreamCos][candidate]))
+        {
+            mask |= 1u << lane;
+        }
+    }
+    return mask;
+}
+
+#if defined(LIGHT_CLUSTERS_SSE)
+// Same tests as TestGroupScalar(), center and radius are those of the cluster's bounding sphere.
+static uint32_t TestGroupSse(float *const *streams, uint32_t group, const LightClusterBounds &bounds, const glm::vec3 &center, float radius)
+{
+    __m128 x = _mm_loadu_ps(streams[LightStreamX] + group);
+    __m128 y = _mm_loadu_ps(streams[LightStreamY] + group);
+    __m128 z = _mm_loadu_ps(streams[LightStreamZ] + group);
+    __m128 range = _mm_loadu_ps(streams[LightStreamRange] + group);
+    __m128 zero = _mm_setzero_ps();
+
+    // Distance from the box, per axis the larger of the two overhangs.
+    __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.x), x), _mm_sub_ps(x, _mm_set1_ps(bounds.max.x))), zero);
+    __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.y), y), _mm_sub_ps(y, _mm_set1_ps(bounds.max.y))), zero);
+    __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.z), z), _mm_sub_ps(z, _mm_set1_ps(bounds.max.z))), zero);
+    __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    __m128 sphereMask = _mm_cmple_ps(distanceSquared, _mm_mul_ps(range, range));
+
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(sphereMask));
+    if (mask == 0)
+    {
+        return 0;
+    }
+
+    __m128 cosAngle = _mm_loadu_ps(streams[LightStreamCos] + group);
+    __m128 spotMask = _mm_cmpgt_ps(cosAngle, _mm_set1_ps(-1.0f));
+    if (_mm_movemask_ps(_mm_and_ps(sphereMask, spotMask)) != 0)
+    {
+        __m128 sinAngle = _mm_loadu_ps(streams[LightStreamSin] + group);
+        __m128 vx = _mm_sub_ps(_mm_set1_ps(center.x), x);
+        __m128 vy = _mm_sub_ps(_mm_set1_ps(center.y), y);
+        __m128 vz = _mm_sub_ps(_mm_set1_ps(center.z), z);
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        __m128 alongAxis = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(streams[LightStreamAxisX] + group)), _mm_mul_ps(vy, _mm_loadu_ps(streams[LightStreamAxisY] + group))),
+            _mm_mul_ps(vz, _mm_loadu_ps(streams[LightStreamAxisZ] + group)));
+        __m128 fromAxis = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lengthSquared, _mm_mul_ps(alongAxis, alongAxis)), zero));
+        __m128 closest = _mm_sub_ps(_mm_mul_ps(cosAngle, fromAxis), _mm_mul_ps(alongAxis, sinAngle));
+
+        __m128 clusterRadius = _mm_set1_ps(radius);
+        __m128 angleCull = _mm_cmpgt_ps(closest, clusterRadius);
+        __m128 frontCull = _mm_cmpgt_ps(alongAxis, _mm_add_ps(clusterRadius, range));
+        __m128 backCull = _mm_cmplt_ps(alongAxis, _mm_sub_ps(zero, clusterRadius));
+        __m128 coneCull = _mm_and_ps(spotMask, _mm_or_ps(angleCull, _mm_or_ps(frontCull, backCull)));
+
+        mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_andnot_ps(coneCull, sphereMask)));
+    }
+    return mask;
+}
+#endif
+
+float LightClusterGrid::GetSliceDepth(uint32_t slice) const
+{
+    return nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(slice) / static_cast<float>(slicesZ));
+}
+
+uint32_t LightClusterGrid::GetSlice(float viewDepth) const
+{
+    if (viewDepth <= nearPlane)
+    {
+        return 0;
+    }
+
+    float slice = std::log(viewDepth / nearPlane) / std::log(farPlane / nearPlane) * static_cast<float>(slicesZ);
+    return std::min(static_cast<uint32_t>(slice), slicesZ - 1);
+}
+
+void LightClusterBuilder::SetView(const LightClusterGrid &grid, const glm::mat4 &projection)
+{
+    assert(grid.tilesX > 0 && grid.tilesY > 0 && grid.slicesZ > 0);
+    assert(grid.nearPlane > 0.0f && grid.farPlane > grid.nearPlane);
+
+    m_Grid = grid;
+    m_ClusterBounds.resize(grid.GetClusterCount());
+
+    glm::mat4 inverseProjection = glm::inverse(projection);
+
+    // Ray through every tile corner, scaled so view space z is -1.
+    std::vector<glm::vec3> corners((grid.tilesX + 1) * (grid.tilesY + 1));
+    for (uint32_t y = 0; y <= grid.tilesY; ++y)
+    {
+        for (uint32_t x = 0; x <= grid.tilesX; ++x)
+        {
+            glm::vec2 ndc{ static_cast<float>(x) / static_cast<float>(grid.tilesX) * 2.0f - 1.0f, static_cast<float>(y) / static_cast<float>(grid.tilesY) * 2.0f - 1.0f };
+            glm::vec4 point = inverseProjection * glm::vec4{ ndc, 0.5f, 1.0f };
+            glm::vec3 position = glm::vec3{ point } / point.w;
+            corners[y * (grid.tilesX + 1) + x] = position / -position.z;
+        }
+    }
+
+    for (uint32_t slice = 0; slice < grid.slicesZ; ++slice)
+    {
+        float depths[2]{ grid.GetSliceDepth(slice), grid.GetSliceDepth(slice + 1) };
+
+        for (uint32_t y = 0; y < grid.tilesY; ++y)
+        {
+            for (uint32_t x = 0; x < grid.tilesX; ++x)
+            {
+                glm::vec3 min{ FLT_MAX };
+                glm::vec3 max{ -FLT_MAX };
+
+                for (uint32_t corner = 0; corner < 4; ++corner)
+                {
+                    const glm::vec3 &ray = corners[(y + corner / 2) * (grid.tilesX + 1) + x + corner % 2];
+                    for (float depth : depths)
+                    {
+                        min = glm::min(min, ray * depth);
+                        max = glm::max(max, ray * depth);
+                    }
+                }
+
+                LightClusterBounds &bounds = m_ClusterBounds[x + y * grid.tilesX + slice * grid.tilesX * grid.tilesY];
+                bounds.min = min;
+                bounds.max = max;
+                bounds.padding0 = 0.0f;
+                bounds.padding1 = 0.0f;
+            }
+        }
+    }
+
+    m_Slices.resize(grid.slicesZ);
+    m_ClusterRanges.resize(grid.GetClusterCount());
+}
+
+void LightClusterBuilder::Build(WorkerThreadPool &pool, const GpuLight *lights, uint32_t lightCount, const glm::mat4 &view)
+{
+    assert(!m_ClusterBounds.empty() && "SetView() must be called before Build().");
+
+    PROFILE_SCOPE("LightClusterBuilder::Build");
+
+    auto begin = std::chrono::steady_clock::now();
+
+    m_LightCount = lightCount;
+    for (std::vector<float> *stream : { &m_LightX, &m_LightY, &m_LightZ, &m_LightRange, &m_AxisX, &m_AxisY, &m_AxisZ, &m_CosAngle, &m_SinAngle })
+    {
+        stream->resize(lightCount);
+    }
+
+    ParallelFor(pool, lightCount, 1024, [this, lights, &view](uint32_t first, uint32_t last)
+    {
+        glm::mat3 rotation{ view };
+        for (uint32_t index = first; index < last; ++index)
+        {
+            const GpuLight &light = lights[index];
+            glm::vec3 position = glm::vec3{ view * glm::vec4{ light.position, 1.0f } };
+            glm::vec3 axis = glm::normalize(rotation * light.direction);
+
+            m_LightX[index] = position.x;
+            m_LightY[index] = position.y;
+            m_LightZ[index] = position.z;
+            m_LightRange[index] = light.range;
+            m_AxisX[index] = axis.x;
+            m_AxisY[index] = axis.y;
+            m_AxisZ[index] = axis.z;
+            m_CosAngle[index] = std::max(light.spotCosAngle, -1.0f);
+            m_SinAngle[index] = std::sqrt(std::max(1.0f - m_CosAngle[index] * m_CosAngle[index], 0.0f));
+        }
+    });
+
+    ParallelFor(pool, m_Grid.slicesZ, 1, [this](uint32_t first, uint32_t last)
+    {
+        for (uint32_t slice = first; slice < last; ++slice)
+        {
+            BuildSlice(slice);
+        }
+    });
+
+    // Slices hold offsets into their own lists, rebase them onto the shared one.
+    m_LightIndices.clear();
+    m_Stats = LightClusterStats{};
+    m_Stats.lightCount = lightCount;
+
+    uint32_t clustersPerSlice = m_Grid.tilesX * m_Grid.tilesY;
+    for (uint32_t slice = 0; slice < m_Grid.slicesZ; ++slice)
+    {
+        SliceResult &result = m_Slices[slice];
+        uint32_t base = static_cast<uint32_t>(m_LightIndices.size());
+        uint32_t available = m_Grid.maxLightIndices - base;
+
+        for (uint32_t cluster = slice * clustersPerSlice; cluster < (slice + 1) * clustersPerSlice; ++cluster)
+        {
+            LightClusterRange &range = m_ClusterRanges[cluster];
+            uint32_t end = std::min(range.offset + range.count, available);
+            uint32_t kept = end > range.offset ? end - range.offset : 0;
+
+            m_Stats.droppedCount += range.count - kept;
+            range.offset = std::min(base + range.offset, m_Grid.maxLightIndices);
+            range.count = kept;
+        }
+
+        uint32_t copied = std::min(static_cast<uint32_t>(result.indices.size()), available);
+        m_LightIndices.insert(m_LightIndices.end(), result.indices.begin(), result.indices.begin() + copied);
+
+        m_Stats.maxClusterLights = std::max(m_Stats.maxClusterLights, result.maxClusterLights);
+        m_Stats.droppedCount += result.droppedCount;
+    }
+
+    m_Stats.indexCount = static_cast<uint32_t>(m_LightIndices.size());
+    m_Stats.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void LightClusterBuilder::BuildSlice(uint32_t slice)
+{
+    SliceResult &result = m_Slices[slice];
+    result.candidates.clear();
+    result.indices.clear();
+    result.maxClusterLights = 0;
+    result.droppedCount = 0;
+
+    // View space looks down -z.
+    float sliceNear = -m_Grid.GetSliceDepth(slice);
+    float sliceFar = -m_Grid.GetSliceDepth(slice + 1);
+
+    for (uint32_t light = 0; light < m_LightCount; ++light)
+    {
+        if (m_LightZ[light] - m_LightRange[light] <= sliceNear && m_LightZ[light] + m_LightRange[light] >= sliceFar)
+        {
+            result.candidates.push_back(light);
+        }
+    }
+
+    uint32_t candidateCount = static_cast<uint32_t>(result.candidates.size());
+    uint32_t paddedCount = AlignToFour(candidateCount);
+
+    // Gathered into slice local streams, every cluster of the slice walks them contiguously.
+    result.streams.resize(paddedCount * LightStreamCount);
+    float *streams[LightStreamCount];
+    for (uint32_t stream = 0; stream < LightStreamCount; ++stream)
+    {
+        streams[stream] = result.streams.data() + stream * paddedCount;
+    }
+
+    for (uint32_t candidate = 0; candidate < paddedCount; ++candidate)
+    {
+        if (candidate < candidateCount)
+        {
+            uint32_t light = result.candidates[candidate];
+            streams[LightStreamX][candidate] = m_LightX[light];
+            streams[LightStreamY][candidate] = m_LightY[light];
+            streams[LightStreamZ][candidate] = m_LightZ[light];
+            streams[LightStreamRange][candidate] = m_LightRange[light];
+            streams[LightStreamAxisX][candidate] = m_AxisX[light];
+            streams[LightStreamAxisY][candidate] = m_AxisY[light];
+            streams[LightStreamAxisZ][candidate] = m_AxisZ[light];
+            streams[LightStreamCos][candidate] = m_CosAngle[light];
+            streams[LightStreamSin][candidate] = m_SinAngle[light];
+        }
+        else
+        {
+            streams[LightStreamX][candidate] = PaddingPosition;
+            streams[LightStreamY][candidate] = PaddingPosition;
+            streams[LightStreamZ][candidate] = PaddingPosition;
+            streams[LightStreamRange][candidate] = 0.0f;
+            streams[LightStreamAxisX][candidate] = 0.0f;
+            streams[LightStreamAxisY][candidate] = 0.0f;
+            streams[LightStreamAxisZ][candidate] = -1.0f;
+            streams[LightStreamCos][candidate] = -1.0f;
+            streams[LightStreamSin][candidate] = 0.0f;
+        }
+    }
+
+    uint32_t clustersPerSlice = m_Grid.tilesX * m_Grid.tilesY;
+    for (uint32_t cluster = slice * clustersPerSlice; cluster < (slice + 1) * clustersPerSlice; ++cluster)
+    {
+        const LightClusterBounds &bounds = m_ClusterBounds[cluster];
+        glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+        float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+
+        uint32_t offset = static_cast<uint32_t>(result.indices.size());
+        uint32_t count = 0;
+
+        for (uint32_t group = 0; group < paddedCount; group += 4)
+        {
+#if defined(LIGHT_CLUSTERS_SSE)
+            uint32_t mask = m_SimdEnabled ? TestGroupSse(streams, group, bounds, center, radius) : TestGroupScalar(streams, group, bounds);
+#else
+            uint32_t mask = TestGroupScalar(streams, group, bounds);
+#endif
+
+            while (mask != 0)
+            {
+                uint32_t lane = 0;
+                while ((mask & (1u << lane)) == 0)
+                {
+                    ++lane;
+                }
+                mask &= mask - 1;
+
+                if (count == m_Grid.maxLightsPerCluster)
+                {
+                    ++result.droppedCount;
+                    continue;
+                }
+
+                result.indices.push_back(result.candidates[group + lane]);
+                ++count;
+            }
+        }
+
+        m_ClusterRanges[cluster] = LightClusterRange{ offset, count };
+        result.maxClusterLights = std::max(result.maxClusterLights, count);
+    }
+}
+
+const LightClusterGrid &LightClusterBuilder::GetGrid() const
+{
+    return m_Grid;
+}
+
+const std::vector<LightClusterBounds> &LightClusterBuilder::GetClusterBounds() const
+{
+    return m_ClusterBounds;
+}
+
+const std::vector<LightClusterRange> &LightClusterBuilder::GetClusterRanges() const
+{
+    return m_ClusterRanges;
+}
+
+const std::vector<uint32_t> &LightClusterBuilder::GetLightIndices() const
+{
+    return m_LightIndices;
+}
+
+const LightClusterStats &LightClusterBuilder::GetStats() const
+{
+    return m_Stats;
+}
+
+void LightClusterBuilder::SetSimdEnabled(bool enabled)
+{
+    m_SimdEnabled = enabled;
+}
+
+bool LightClusterBuilder::IsSimdSupported()
+{
+#if defined(LIGHT_CLUSTERS_SSE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool LightClusterBuilder::IntersectsSphere(const LightClusterBounds &bounds, const glm::vec3 &center, float radius)
+{
+    glm::vec3 distance = glm::max(glm::max(bounds.min - center, center - bounds.max), glm::vec3{ 0.0f });
+    return glm::dot(distance, distance) <= radius * radius;
+}
+
+bool LightClusterBuilder::IntersectsCone(const LightClusterBounds &bounds, const glm::vec3 &apex, const glm::vec3 &axis, float range, float cosAngle)
+{
+    if (cosAngle <= -1.0f)
+    {
+        return true;
+    }
+
+    // Cone against the bounding sphere of the cluster, after Bart Wronski's cull test.
+    glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+    float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+    float sinAngle = std::sqrt(std::max(1.0f - cosAngle * cosAngle, 0.0f));
+
+    glm::vec3 toCenter = center - apex;
+    float alongAxis = glm::dot(toCenter, axis);
+    float fromAxis = std::sqrt(std::max(glm::dot(toCenter, toCenter) - alongAxis * alongAxis, 0.0f));
+    float closest = cosAngle * fromAxis - alongAxis * sinAngle;
+
+    return closest <= radius && alongAxis <= radius + range && alongAxis >= -radius;
+}
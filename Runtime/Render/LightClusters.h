@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class WorkerThreadPool;
+
+// std430 layout shared with the culling and shading shaders. A spot light with a cone of 180 degrees,
+// spotCosAngle <= -1, is a point light.
+struct GpuLight
+{
+    glm::vec3 position{ 0.0f };
+
+    float range{ 1.0f };
+
+    glm::vec3 direction{ 0.0f, 0.0f, -1.0f };
+
+    // Cosine of the outer half angle.
+    float spotCosAngle{ -1.0f };
+
+    glm::vec3 color{ 1.0f };
+
+    float intensity{ 1.0f };
+};
+
+static_assert(sizeof(GpuLight) == 48, "GpuLight must match the std430 layout of the light buffer");
+
+// Lights of one cluster, a range in the light index list.
+struct LightClusterRange
+{
+    uint32_t offset;
+
+    uint32_t count;
+};
+
+// View space froxel grid. Tiles split the screen evenly, tile (0, 0) is the top left corner of the
+// framebuffer; slices split depth exponentially between nearPlane and farPlane. The cluster of a
+// fragment is x + y * tilesX + slice * tilesX * tilesY with
+//
+//     slice = floor(log(viewDepth / nearPlane) / log(farPlane / nearPlane) * slicesZ)
+struct LightClusterGrid
+{
+    uint32_t tilesX{ 16 };
+
+    uint32_t tilesY{ 9 };
+
+    uint32_t slicesZ{ 24 };
+
+    float nearPlane{ 0.1f };
+
+    float farPlane{ 1000.0f };
+
+    // Lights past this are dropped from a cluster, the shaders loop over at most this many.
+    uint32_t maxLightsPerCluster{ 256 };
+
+    // Size of the light index list, shared by all clusters.
+    uint32_t maxLightIndices{ 16 * 9 * 24 * 64 };
+
+    uint32_t GetClusterCount() const { return tilesX * tilesY * slicesZ; }
+
+    float GetSliceDepth(uint32_t slice) const;
+
+    uint32_t GetSlice(float viewDepth) const;
+};
+
+// View space bounds of a cluster, padded to 32 bytes for the compute path.
+struct LightClusterBounds
+{
+    glm::vec3 min;
+
+    float padding0;
+
+    glm::vec3 max;
+
+    float padding1;
+};
+
+struct LightClusterStats
+{
+    uint32_t lightCount{ 0 };
+
+    uint32_t indexCount{ 0 };
+
+    uint32_t maxClusterLights{ 0 };
+
+    // Light references dropped by maxLightsPerCluster or maxLightIndices.
+    uint32_t droppedCount{ 0 };
+
+    double buildSeconds{ 0.0 };
+};
+
+// Bins lights into the clusters of a view on the worker pool. Lights are moved to view space and
+// stored as SoA once, every depth slice then keeps the lights that overlap it and tests them four at
+// a time against its clusters: sphere against box, and spot cones against the bounding sphere of the
+// cluster. The output format is the one VulkanLightClusters produces on the GPU.
+//
+// Buffers are kept between frames, so after the first few frames Build() doesn't allocate.
+class LightClusterBuilder : public NonCopyable
+{
+public:
+
+    // Recomputes the cluster bounds, only needed when the grid or the projection changes. projection
+    // is a Vulkan style perspective matrix, with or without the y flip.
+    void SetView(const LightClusterGrid &grid, const glm::mat4 &projection);
+
+    void Build(WorkerThreadPool &pool, const GpuLight *lights, uint32_t lightCount, const glm::mat4 &view);
+
+    const LightClusterGrid &GetGrid() const;
+
+    const std::vector<LightClusterBounds> &GetClusterBounds() const;
+
+    // One range per cluster.
+    const std::vector<LightClusterRange> &GetClusterRanges() const;
+
+    const std::vector<uint32_t> &GetLightIndices() const;
+
+    const LightClusterStats &GetStats() const;
+
+    // Build() tests four lights at a time with SSE2 where the target has it. Disabled, it takes the
+    // scalar path every target has, for checking one against the other.
+    void SetSimdEnabled(bool enabled);
+
+    static bool IsSimdSupported();
+
+    // The tests Build() runs, for checking other implementations against.
+    static bool IntersectsSphere(const LightClusterBounds &bounds, const glm::vec3 &center, float radius);
+
+    static bool IntersectsCone(const LightClusterBounds &bounds, const glm::vec3 &apex, const glm::vec3 &axis, float range, float cosAngle);
+
+private:
+
+    void BuildSlice(uint32_t slice);
+
+    LightClusterGrid m_Grid{};
+
+    bool m_SimdEnabled{ true };
+
+    std::vector<LightClusterBounds> m_ClusterBounds;
+
+    // View space lights as SoA.
+    std::vector<float> m_LightX;
+
+    std::vector<float> m_LightY;
+
+    std::vector<float> m_LightZ;
+
+    std::vector<float> m_LightRange;
+
+    std::vector<float> m_AxisX;
+
+    std::vector<float> m_AxisY;
+
+    std::vector<float> m_AxisZ;
+
+    std::vector<float> m_CosAngle;
+
+    std::vector<float> m_SinAngle;
+
+    uint32_t m_LightCount{ 0 };
+
+    // Per slice results, merged into the index list once every slice is done.
+    struct SliceResult
+    {
+        // Lights overlapping the slice in depth.
+        std::vector<uint32_t> candidates;
+
+        std::vector<float> streams;
+
+        std::vector<uint32_t> indices;
+
+        uint32_t maxClusterLights{ 0 };
+
+        uint32_t droppedCount{ 0 };
+    };
+
+    std::vector<SliceResult> m_Slices;
+
+    std::vector<LightClusterRange> m_ClusterRanges;
+
+    std::vector<uint32_t> m_LightIndices;
+
+    LightClusterStats m_Stats{};
+};
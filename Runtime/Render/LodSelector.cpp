@@ -0,0 +1,91 @@
+#include "LodSelector.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <cmath>
+
+float LodSelectionStats::GetTriangleReduction() const
+{
+    return triangleCount > 0 ? static_cast<float>(fullDetailTriangleCount) / triangleCount : 1.0f;
+}
+
+void LodSelector::SetParams(const LodSelectionParams &params)
+{
+    m_Params = params;
+}
+
+const LodSelectionParams &LodSelector::GetParams() const
+{
+    return m_Params;
+}
+
+float LodSelector::GetScreenErrorScale(float distance, float worldScale) const
+{
+    float projection = m_Params.viewportHeight / (2.0f * std::tan(m_Params.verticalFov * 0.5f));
+    return worldScale * projection / std::max(distance, 1e-4f);
+}
+
+uint32_t LodSelector::Select(uint32_t objectId, const Mesh &mesh, float distance, float worldScale)
+{
+    if (objectId >= m_CurrentLods.size())
+    {
+        m_CurrentLods.resize(objectId + 1, NoLod);
+    }
+
+    uint32_t lodCount = std::min(mesh.GetLodCount(), MaxMeshLods);
+    float scale = GetScreenErrorScale(distance, worldScale);
+
+    // Coarsest level under a threshold, errors grow monotonically along the chain.
+    auto coarsestUnder = [&](float threshold)
+    {
+        uint32_t lod = 0;
+        while (lod + 1 < lodCount && mesh.GetLodError(lod + 1) * scale <= threshold)
+        {
+            ++lod;
+        }
+        return lod;
+    };
+
+    uint32_t desired = coarsestUnder(m_Params.maxScreenError);
+    uint32_t selected = desired;
+
+    uint8_t current = m_CurrentLods[objectId];
+    if (current != NoLod && current < lodCount)
+    {
+        if (desired > current)
+        {
+            selected = std::max<uint32_t>(current, coarsestUnder(m_Params.maxScreenError * (1.0f - m_Params.hysteresis)));
+        }
+        else if (desired < current && mesh.GetLodError(current) * scale <= m_Params.maxScreenError * (1.0f + m_Params.hysteresis))
+        {
+            selected = current;
+        }
+    }
+
+    if (current != NoLod && selected != current)
+    {
+        ++m_Stats.transitionCount;
+    }
+    m_CurrentLods[objectId] = static_cast<uint8_t>(selected);
+
+    ++m_Stats.objectCount;
+    ++m_Stats.lodHistogram[selected];
+    m_Stats.triangleCount += mesh.GetLodTriangleCount(selected);
+    m_Stats.fullDetailTriangleCount += mesh.GetLodTriangleCount(0);
+
+    return selected;
+}
+
+void LodSelector::Reset()
+{
+    std::fill(m_CurrentLods.begin(), m_CurrentLods.end(), NoLod);
+}
+
+const LodSelectionStats &LodSelector::GetStats() const
+{
+    return m_Stats;
+}
+
+void LodSelector::ResetStats()
+{
+    m_Stats = LodSelectionStats{};
+}
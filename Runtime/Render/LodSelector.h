@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "MeshSimplifier.h"
+#include <vector>
+#include <cstdint>
+
+class Mesh;
+
+struct LodSelectionParams
+{
+    float verticalFov{ 1.0f };
+
+    float viewportHeight{ 1080.0f };
+
+    // Largest projected error, in pixels, a level may have to be selected.
+    float maxScreenError{ 1.0f };
+
+    // A coarser level is only taken once its error is below maxScreenError * (1 - hysteresis), and
+    // the current level is kept until its error exceeds maxScreenError * (1 + hysteresis).
+    float hysteresis{ 0.25f };
+};
+
+struct LodSelectionStats
+{
+    uint32_t objectCount{ 0 };
+
+    // Triangles submitted with the selected levels, and with level 0 everywhere.
+    uint64_t triangleCount{ 0 };
+
+    uint64_t fullDetailTriangleCount{ 0 };
+
+    uint32_t transitionCount{ 0 };
+
+    uint32_t lodHistogram[MaxMeshLods]{};
+
+    float GetTriangleReduction() const;
+};
+
+// Picks the coarsest LOD whose geometric error projects to less than a pixel budget, remembering the
+// level of every object so small camera moves around a threshold don't make it pop back and forth.
+class LodSelector : public NonCopyable
+{
+public:
+
+    void SetParams(const LodSelectionParams &params);
+
+    const LodSelectionParams &GetParams() const;
+
+    // Pixels covered by one object space unit at distance, for an object scaled by worldScale.
+    float GetScreenErrorScale(float distance, float worldScale) const;
+
+    // objectId indexes the persistent per-object state and can be any small dense integer.
+    uint32_t Select(uint32_t objectId, const Mesh &mesh, float distance, float worldScale = 1.0f);
+
+    // Forgets the level of every object, the next selection of each one ignores hysteresis.
+    void Reset();
+
+    const LodSelectionStats &GetStats() const;
+
+    void ResetStats();
+
+private:
+
+    static constexpr uint8_t NoLod = 0xFF;
+
+    LodSelectionParams m_Params{};
+
+    std::vector<uint8_t> m_CurrentLods;
+
+    LodSelectionStats m_Stats{};
+};
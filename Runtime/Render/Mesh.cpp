@@ -0,0 +1,145 @@
+#include "Mesh.h"
+#include <limits>
+
+Mesh::Mesh(const std::string &name) :
+    m_Name{ name }
+{
+}
+
+const std::string &Mesh::GetName() const
+{
+    return m_Name;
+}
+
+uint32_t Mesh::GetVertexCount() const
+{
+    return static_cast<uint32_t>(m_Positions.size());
+}
+
+uint32_t Mesh::GetIndexCount() const
+{
+    return static_cast<uint32_t>(m_Indices.size());
+}
+
+std::vector<glm::vec3> &Mesh::GetPositions()
+{
+    return m_Positions;
+}
+
+const std::vector<glm::vec3> &Mesh::GetPositions() const
+{
+    return m_Positions;
+}
+
+std::vector<glm::vec3> &Mesh::GetNormals()
+{
+    return m_Normals;
+}
+
+const std::vector<glm::vec3> &Mesh::GetNormals() const
+{
+    return m_Normals;
+}
+
+std::vector<glm::vec4> &Mesh::GetTangents()
+{
+    return m_Tangents;
+}
+
+const std::vector<glm::vec4> &Mesh::GetTangents() const
+{
+    return m_Tangents;
+}
+
+std::vector<glm::vec2> &Mesh::GetTexCoords()
+{
+    return m_TexCoords;
+}
+
+const std::vector<glm::vec2> &Mesh::GetTexCoords() const
+{
+    return m_TexCoords;
+}
+
+std::vector<uint32_t> &Mesh::GetIndices()
+{
+    return m_Indices;
+}
+
+const std::vector<uint32_t> &Mesh::GetIndices() const
+{
+    return m_Indices;
+}
+
+std::vector<SubMesh> &Mesh::GetSubMeshes()
+{
+    return m_SubMeshes;
+}
+
+const std::vector<SubMesh> &Mesh::GetSubMeshes() const
+{
+    return m_SubMeshes;
+}
+
+std::vector<MeshLod> &Mesh::GetLods()
+{
+    return m_Lods;
+}
+
+const std::vector<MeshLod> &Mesh::GetLods() const
+{
+    return m_Lods;
+}
+
+uint32_t Mesh::GetLodCount() const
+{
+    return static_cast<uint32_t>(m_Lods.size()) + 1;
+}
+
+const std::vector<SubMesh> &Mesh::GetLodSubMeshes(uint32_t lod) const
+{
+    return lod == 0 ? m_SubMeshes : m_Lods[lod - 1].subMeshes;
+}
+
+float Mesh::GetLodError(uint32_t lod) const
+{
+    return lod == 0 ? 0.0f : m_Lods[lod - 1].error;
+}
+
+uint32_t Mesh::GetLodTriangleCount(uint32_t lod) const
+{
+    if (lod > 0)
+    {
+        return m_Lods[lod - 1].triangleCount;
+    }
+
+    uint32_t triangleCount = 0;
+    for (const SubMesh &subMesh : m_SubMeshes)
+    {
+        triangleCount += subMesh.indexCount / 3;
+    }
+    return triangleCount;
+}
+
+const BoundingBox &Mesh::GetBounds() const
+{
+    return m_Bounds;
+}
+
+void Mesh::ComputeBounds()
+{
+    if (m_Positions.empty())
+    {
+        m_Bounds = {};
+        return;
+    }
+
+    m_Bounds.min = glm::vec3{ std::numeric_limits<float>::max() };
+    m_Bounds.max = glm::vec3{ -std::numeric_limits<float>::max() };
+
+    for (const glm::vec3 &position : m_Positions)
+    {
+        m_Bounds.min = glm::min(m_Bounds.min, position);
+        m_Bounds.max = glm::max(m_Bounds.max, position);
+    }
+}
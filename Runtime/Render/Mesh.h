@@ -1 +1,112 @@
-//SubMesh
\ No newline at end of file
+#pragma once
+
+#include "Common/Utils.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+struct BoundingBox
+{
+    glm::vec3 min{ 0.0f };
+
+    glm::vec3 max{ 0.0f };
+};
+
+// Range of the shared index buffer drawn with a single material.
+struct SubMesh
+{
+    uint32_t indexOffset{ 0 };
+
+    uint32_t indexCount{ 0 };
+
+    int32_t materialIndex{ -1 };
+};
+
+// Simplified version of the mesh sharing its vertex streams. The submeshes index into the same index
+// buffer, after the ranges of the full detail mesh.
+struct MeshLod
+{
+    std::vector<SubMesh> subMeshes;
+
+    // Largest object space distance between the simplified and the original surface.
+    float error{ 0.0f };
+
+    uint32_t triangleCount{ 0 };
+};
+
+// CPU-side triangle list mesh. Attributes are stored as separate streams; normals, tangents and
+// texture coordinates are either empty or have one entry per position.
+class Mesh : public NonCopyable
+{
+public:
+
+    explicit Mesh(const std::string &name = {});
+
+    const std::string &GetName() const;
+
+    uint32_t GetVertexCount() const;
+
+    uint32_t GetIndexCount() const;
+
+    std::vector<glm::vec3> &GetPositions();
+
+    const std::vector<glm::vec3> &GetPositions() const;
+
+    std::vector<glm::vec3> &GetNormals();
+
+    const std::vector<glm::vec3> &GetNormals() const;
+
+    std::vector<glm::vec4> &GetTangents();
+
+    const std::vector<glm::vec4> &GetTangents() const;
+
+    std::vector<glm::vec2> &GetTexCoords();
+
+    const std::vector<glm::vec2> &GetTexCoords() const;
+
+    std::vector<uint32_t> &GetIndices();
+
+    const std::vector<uint32_t> &GetIndices() const;
+
+    std::vector<SubMesh> &GetSubMeshes();
+
+    const std::vector<SubMesh> &GetSubMeshes() const;
+
+    // Levels 1 and above, level 0 is the full detail mesh described by GetSubMeshes().
+    std::vector<MeshLod> &GetLods();
+
+    const std::vector<MeshLod> &GetLods() const;
+
+    uint32_t GetLodCount() const;
+
+    const std::vector<SubMesh> &GetLodSubMeshes(uint32_t lod) const;
+
+    float GetLodError(uint32_t lod) const;
+
+    uint32_t GetLodTriangleCount(uint32_t lod) const;
+
+    const BoundingBox &GetBounds() const;
+
+    void ComputeBounds();
+
+private:
+
+    std::string m_Name{};
+
+    std::vector<glm::vec3> m_Positions;
+
+    std::vector<glm::vec3> m_Normals;
+
+    std::vector<glm::vec4> m_Tangents;
+
+    std::vector<glm::vec2> m_TexCoords;
+
+    std::vector<uint32_t> m_Indices;
+
+    std::vector<SubMesh> m_SubMeshes;
+
+    std::vector<MeshLod> m_Lods;
+
+    BoundingBox m_Bounds{};
+};
@@ -0,0 +1,724 @@
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+#include "TriangleAdjacency.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+static constexpr uint32_t InvalidIndex = ~0u;
+
+// FIFO post-transform cache, as found on most hardware.
+class FifoCacheSimulator
+{
+public:
+
+    FifoCacheSimulator(uint32_t vertexCount, uint32_t cacheSize) :
+        m_Timestamps(vertexCount, 0),
+        m_CacheSize{ cacheSize },
+        m_Time{ cacheSize + 1 }
+    {
+    }
+
+    // Returns true when the vertex had to be transformed.
+    bool Access(uint32_t vertex)
+    {
+        if (m_Time - m_Timestamps[vertex] > m_CacheSize)
+        {
+            m_Timestamps[vertex] = m_Time++;
+            return true;
+        }
+        return false;
+    }
+
+    void Reset()
+    {
+        // Moving time forward evicts everything without touching the timestamps.
+        m_Time += m_CacheSize + 1;
+    }
+
+private:
+
+    std::vector<uint32_t> m_Timestamps;
+
+    uint32_t m_CacheSize{ 0 };
+
+    uint32_t m_Time{ 0 };
+};
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+    assert(indexCount % 3 == 0);
+
+    VertexCacheStats stats{};
+    stats.triangleCount = indexCount / 3;
+
+    FifoCacheSimulator cache{ vertexCount, cacheSize };
+    std::vector<bool> used(vertexCount, false);
+
+    for (uint32_t index = 0; index < indexCount; ++index)
+    {
+        uint32_t vertex = indices[index];
+        stats.transformCount += cache.Access(vertex) ? 1 : 0;
+
+        if (!used[vertex])
+        {
+            used[vertex] = true;
+            ++stats.vertexCount;
+        }
+    }
+
+    stats.acmr = stats.triangleCount > 0 ? static_cast<float>(stats.transformCount) / stats.triangleCount : 0.0f;
+    stats.atvr = stats.vertexCount > 0 ? static_cast<float>(stats.transformCount) / stats.vertexCount : 0.0f;
+
+    return stats;
+}
+
+VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount, uint32_t vertexSize)
+{
+    static constexpr uint32_t CacheLineSize = 64;
+
+    // Small fully associative LRU of cache lines, roughly what a vertex fetch unit keeps around.
+    static constexpr uint32_t CacheLineCount = 64;
+
+    VertexFetchStats stats{};
+
+    uint64_t lines[CacheLineCount];
+    uint32_t lineAges[CacheLineCount];
+    std::fill(std::begin(lines), std::end(lines), std::numeric_limits<uint64_t>::max());
+    std::fill(std::begin(lineAges), std::end(lineAges), 0u);
+
+    uint32_t time = 0;
+
+    for (uint32_t index = 0; index < indexCount; ++index)
+    {
+        uint64_t start = static_cast<uint64_t>(indices[index]) * vertexSize;
+        uint64_t end = start + vertexSize;
+
+        for (uint64_t line = start / CacheLineSize; line <= (end - 1) / CacheLineSize; ++line)
+        {
+            ++time;
+
+            uint32_t hit = CacheLineCount;
+            uint32_t oldest = 0;
+            for (uint32_t slot = 0; slot < CacheLineCount; ++slot)
+            {
+                if (lines[slot] == line)
+                {
+                    hit = slot;
+                    break;
+                }
+                if (lineAges[slot] < lineAges[oldest])
+                {
+                    oldest = slot;
+                }
+            }
+
+            if (hit == CacheLineCount)
+            {
+                lines[oldest] = line;
+                lineAges[oldest] = time;
+                stats.bytesFetched += CacheLineSize;
+            }
+            else
+            {
+                lineAges[hit] = time;
+            }
+        }
+    }
+
+    uint64_t vertexBufferSize = static_cast<uint64_t>(vertexCount) * vertexSize;
+    stats.overfetch = vertexBufferSize > 0 ? static_cast<float>(stats.bytesFetched) / vertexBufferSize : 0.0f;
+
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t *destination, const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+    assert(indexCount % 3 == 0);
+    assert(destination != indices);
+
+    if (indexCount == 0)
+    {
+        return;
+    }
+
+    TriangleAdjacency adjacency;
+    adjacency.Build(indices, indexCount, vertexCount);
+
+    std::vector<uint32_t> liveTriangles = adjacency.counts;
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(indexCount / 3, false);
+
+    std::vector<uint32_t> deadEndStack;
+    deadEndStack.reserve(indexCount);
+
+    std::vector<uint32_t> candidates;
+    candidates.reserve(64);
+
+    uint32_t time = cacheSize + 1;
+    uint32_t inputCursor = 0;
+    uint32_t outputCount = 0;
+
+    uint32_t fanningVertex = indices[0];
+
+    while (fanningVertex != InvalidIndex)
+    {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex.
+        const uint32_t *triangles = &adjacency.triangles[adjacency.offsets[fanningVertex]];
+        for (uint32_t neighbour = 0; neighbour < adjacency.counts[fanningVertex]; ++neighbour)
+        {
+            uint32_t triangle = triangles[neighbour];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t vertex = indices[triangle * 3 + corner];
+
+                destination[outputCount++] = vertex;
+                deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+
+                --liveTriangles[vertex];
+
+                if (time - timestamps[vertex] > cacheSize)
+                {
+                    timestamps[vertex] = time++;
+                }
+            }
+
+            emitted[triangle] = true;
+        }
+
+        // Prefer the candidate that stays in the cache the longest while still having work left.
+        uint32_t bestVertex = InvalidIndex;
+        int32_t bestPriority = -1;
+
+        for (uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+
+            int32_t priority = 0;
+            if (time - timestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+            {
+                priority = static_cast<int32_t>(time - timestamps[vertex]);
+            }
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                bestVertex = vertex;
+            }
+        }
+
+        if (bestVertex == InvalidIndex)
+        {
+            // Dead end, fall back to the most recently used vertex with work left, then to input order.
+            while (!deadEndStack.empty())
+            {
+                uint32_t vertex = deadEndStack.back();
+                deadEndStack.pop_back();
+
+                if (liveTriangles[vertex] > 0)
+                {
+                    bestVertex = vertex;
+                    break;
+                }
+            }
+
+            while (bestVertex == InvalidIndex && inputCursor < vertexCount)
+            {
+                if (liveTriangles[inputCursor] > 0)
+                {
+                    bestVertex = inputCursor;
+                }
+                ++inputCursor;
+            }
+        }
+
+        fanningVertex = bestVertex;
+    }
+
+    assert(outputCount == indexCount);
+    (void)outputCount;
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t *destination, const uint32_t *indices, uint32_t indexCount, const glm::vec3 *positions, uint32_t vertexCount, float threshold, uint32_t cacheSize)
+{
+    assert(indexCount % 3 == 0);
+    assert(destination != indices);
+
+    uint32_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    FifoCacheSimulator cache{ vertexCount, cacheSize };
+
+    std::vector<uint32_t> triangleMisses(triangleCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        uint32_t misses = 0;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            misses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+        }
+        triangleMisses[triangle] = misses;
+    }
+
+    // Hard boundaries: a triangle missing on all three vertices means the cache restarted there,
+    // so splitting costs nothing.
+    std::vector<uint32_t> hardClusters;
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (triangle == 0 || triangleMisses[triangle] == 3)
+        {
+            hardClusters.push_back(triangle);
+        }
+    }
+    hardClusters.push_back(triangleCount);
+
+    // Soft boundaries: split a hard cluster further wherever the running ACMR stays within threshold.
+    std::vector<uint32_t> clusters;
+    for (size_t cluster = 0; cluster + 1 < hardClusters.size(); ++cluster)
+    {
+        uint32_t begin = hardClusters[cluster];
+        uint32_t end = hardClusters[cluster + 1];
+
+        cache.Reset();
+        uint32_t clusterMisses = 0;
+        for (uint32_t triangle = begin; triangle < end; ++triangle)
+        {
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                clusterMisses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+            }
+        }
+
+        float thresholdAcmr = static_cast<float>(clusterMisses) / (end - begin) * threshold;
+
+        clusters.push_back(begin);
+
+        cache.Reset();
+        uint32_t runningMisses = 0;
+        uint32_t runningBegin = begin;
+        for (uint32_t triangle = begin; triangle < end; ++triangle)
+        {
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                runningMisses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+            }
+
+            if (triangle + 1 < end && static_cast<float>(runningMisses) / (triangle + 1 - runningBegin) <= thresholdAcmr)
+            {
+                clusters.push_back(triangle + 1);
+                cache.Reset();
+                runningMisses = 0;
+                runningBegin = triangle + 1;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    uint32_t clusterCount = static_cast<uint32_t>(clusters.size() - 1);
+
+    glm::vec3 meshCentroid{ 0.0f };
+    float meshArea = 0.0f;
+
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3{ 0.0f });
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{ 0.0f });
+
+    for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        float clusterArea = 0.0f;
+
+        for (uint32_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+        {
+            const glm::vec3 &a = positions[indices[triangle * 3 + 0]];
+            const glm::vec3 &b = positions[indices[triangle * 3 + 1]];
+            const glm::vec3 &c = positions[indices[triangle * 3 + 2]];
+
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float area = glm::length(normal);
+            glm::vec3 centroid = (a + b + c) / 3.0f;
+
+            clusterCentroids[cluster] += centroid * area;
+            clusterNormals[cluster] += normal;
+            clusterArea += area;
+        }
+
+        meshCentroid += clusterCentroids[cluster];
+        meshArea += clusterArea;
+
+        clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : positions[indices[clusters[cluster] * 3]];
+
+        float normalLength = glm::length(clusterNormals[cluster]);
+        clusterNormals[cluster] = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : glm::vec3{ 0.0f };
+    }
+
+    if (meshArea > 0.0f)
+    {
+        meshCentroid = meshCentroid / meshArea;
+    }
+
+    // Clusters facing away from the centre occlude the rest from most viewpoints, draw them first.
+    std::vector<float> sortKeys(clusterCount);
+    std::vector<uint32_t> order(clusterCount);
+    for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster]);
+        order[cluster] = cluster;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    uint32_t outputCount = 0;
+    for (uint32_t cluster : order)
+    {
+        uint32_t begin = clusters[cluster] * 3;
+        uint32_t end = clusters[cluster + 1] * 3;
+
+        memcpy(destination + outputCount, indices + begin, (end - begin) * sizeof(uint32_t));
+        outputCount += end - begin;
+    }
+
+    assert(outputCount == indexCount);
+}
+
+uint32_t MeshOptimizer::OptimizeVertexFetchRemap(uint32_t *remap, const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount)
+{
+    std::fill(remap, remap + vertexCount, InvalidIndex);
+
+    uint32_t nextVertex = 0;
+    for (uint32_t index = 0; index < indexCount; ++index)
+    {
+        uint32_t vertex = indices[index];
+        assert(vertex < vertexCount);
+
+        if (remap[vertex] == InvalidIndex)
+        {
+            remap[vertex] = nextVertex++;
+        }
+    }
+
+    return nextVertex;
+}
+
+template <typename T>
+static void RemapStream(std::vector<T> &stream, const std::vector<uint32_t> &remap, uint32_t newVertexCount)
+{
+    if (stream.empty())
+    {
+        return;
+    }
+
+    std::vector<T> remapped(newVertexCount);
+    for (size_t vertex = 0; vertex < stream.size(); ++vertex)
+    {
+        if (remap[vertex] != InvalidIndex)
+        {
+            remapped[remap[vertex]] = stream[vertex];
+        }
+    }
+
+    stream.swap(remapped);
+}
+
+static uint32_t GetSourceVertexSize(const Mesh &mesh)
+{
+    uint32_t size = sizeof(glm::vec3);
+    size += mesh.GetNormals().empty() ? 0 : sizeof(glm::vec3);
+    size += mesh.GetTangents().empty() ? 0 : sizeof(glm::vec4);
+    size += mesh.GetTexCoords().empty() ? 0 : sizeof(glm::vec2);
+    return size;
+}
+
+MeshOptimizerReport MeshOptimizer::OptimizeMesh(Mesh &mesh, float overdrawThreshold)
+{
+    MeshOptimizerReport report{};
+
+    std::vector<uint32_t> &indices = mesh.GetIndices();
+    uint32_t indexCount = mesh.GetIndexCount();
+    uint32_t vertexCount = mesh.GetVertexCount();
+
+    report.vertexStrideBefore = GetSourceVertexSize(mesh);
+    report.vertexStrideAfter = sizeof(QuantizedVertex);
+    report.cacheBefore = AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+    report.fetchBefore = AnalyzeVertexFetch(indices.data(), indexCount, vertexCount, report.vertexStrideBefore);
+
+    // Submeshes are drawn separately, each range of every LOD is reordered on its own.
+    std::vector<uint32_t> cacheOptimized(indexCount);
+    std::vector<uint32_t> overdrawOptimized = indices;
+
+    for (uint32_t lod = 0; lod < mesh.GetLodCount(); ++lod)
+    {
+        for (const SubMesh &subMesh : mesh.GetLodSubMeshes(lod))
+        {
+            const uint32_t *source = indices.data() + subMesh.indexOffset;
+
+            OptimizeVertexCache(cacheOptimized.data() + subMesh.indexOffset, source, subMesh.indexCount, vertexCount);
+            OptimizeOverdraw(overdrawOptimized.data() + subMesh.indexOffset, cacheOptimized.data() + subMesh.indexOffset, subMesh.indexCount, mesh.GetPositions().data(), vertexCount, overdrawThreshold);
+        }
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+    uint32_t newVertexCount = OptimizeVertexFetchRemap(remap.data(), overdrawOptimized.data(), indexCount, vertexCount);
+
+    for (uint32_t index = 0; index < indexCount; ++index)
+    {
+        indices[index] = remap[overdrawOptimized[index]];
+    }
+
+    RemapStream(mesh.GetPositions(), remap, newVertexCount);
+    RemapStream(mesh.GetNormals(), remap, newVertexCount);
+    RemapStream(mesh.GetTangents(), remap, newVertexCount);
+    RemapStream(mesh.GetTexCoords(), remap, newVertexCount);
+
+    report.cacheAfter = AnalyzeVertexCache(indices.data(), indexCount, newVertexCount);
+    report.fetchAfter = AnalyzeVertexFetch(indices.data(), indexCount, newVertexCount, report.vertexStrideAfter);
+
+    return report;
+}
+
+static void AccumulateCacheStats(VertexCacheStats &total, const VertexCacheStats &stats)
+{
+    total.triangleCount += stats.triangleCount;
+    total.vertexCount += stats.vertexCount;
+    total.transformCount += stats.transformCount;
+    total.acmr = total.triangleCount > 0 ? static_cast<float>(total.transformCount) / total.triangleCount : 0.0f;
+    total.atvr = total.vertexCount > 0 ? static_cast<float>(total.transformCount) / total.vertexCount : 0.0f;
+}
+
+static void AccumulateFetchStats(VertexFetchStats &total, const VertexFetchStats &stats)
+{
+    // The vertex buffer sizes aren't kept, they come back out of the ratios.
+    double totalBufferSize = total.overfetch > 0.0f ? total.bytesFetched / static_cast<double>(total.overfetch) : 0.0;
+    double bufferSize = stats.overfetch > 0.0f ? stats.bytesFetched / static_cast<double>(stats.overfetch) : 0.0;
+
+    total.bytesFetched += stats.bytesFetched;
+    total.overfetch = totalBufferSize + bufferSize > 0.0 ? static_cast<float>(total.bytesFetched / (totalBufferSize + bufferSize)) : 0.0f;
+}
+
+void MeshOptimizer::AccumulateReport(MeshOptimizerReport &total, const MeshOptimizerReport &report)
+{
+    uint64_t vertexBytes = static_cast<uint64_t>(total.vertexStrideBefore) * total.cacheBefore.vertexCount +
+                           static_cast<uint64_t>(report.vertexStrideBefore) * report.cacheBefore.vertexCount;
+
+    AccumulateCacheStats(total.cacheBefore, report.cacheBefore);
+    AccumulateCacheStats(total.cacheAfter, report.cacheAfter);
+    AccumulateFetchStats(total.fetchBefore, report.fetchBefore);
+    AccumulateFetchStats(total.fetchAfter, report.fetchAfter);
+
+    // Meshes differ in the streams they have, the source stride becomes the average.
+    total.vertexStrideBefore = total.cacheBefore.vertexCount > 0 ? static_cast<uint32_t>(vertexBytes / total.cacheBefore.vertexCount) : 0;
+    total.vertexStrideAfter = report.vertexStrideAfter;
+}
+
+static int8_t ToSnorm8(float value)
+{
+    return static_cast<int8_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+void MeshOptimizer::EncodeOctahedral(const glm::vec3 &normal, int8_t &x, int8_t &y)
+{
+    float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (sum == 0.0f)
+    {
+        x = 0;
+        y = 0;
+        return;
+    }
+
+    float u = normal.x / sum;
+    float v = normal.y / sum;
+
+    // Fold the lower hemisphere over the diagonals.
+    if (normal.z < 0.0f)
+    {
+        float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = foldedU;
+        v = foldedV;
+    }
+
+    x = ToSnorm8(u);
+    y = ToSnorm8(v);
+}
+
+glm::vec3 MeshOptimizer::DecodeOctahedral(int8_t x, int8_t y)
+{
+    float u = std::max(x / 127.0f, -1.0f);
+    float v = std::max(y / 127.0f, -1.0f);
+
+    glm::vec3 normal{ u, v, 1.0f - std::fabs(u) - std::fabs(v) };
+    if (normal.z < 0.0f)
+    {
+        normal.x = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        normal.y = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return glm::normalize(normal);
+}
+
+uint16_t MeshOptimizer::FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF)
+    {
+        // Infinity stays infinity, NaN stays a quiet NaN.
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+    }
+
+    if (exponent >= 31)
+    {
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+
+        // Denormal, shift the implicit leading one in and round to nearest even.
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t halfMantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (halfMantissa & 1)))
+        {
+            ++halfMantissa;
+        }
+        return static_cast<uint16_t>(sign | halfMantissa);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+
+    // Round to nearest even, a carry into the exponent is the correct result.
+    uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+        ++half;
+    }
+
+    return static_cast<uint16_t>(half);
+}
+
+float MeshOptimizer::HalfToFloat(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Renormalise the denormal.
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+QuantizedMesh MeshOptimizer::QuantizeMesh(const Mesh &mesh)
+{
+    QuantizedMesh result{};
+    result.indices = mesh.GetIndices();
+
+    const auto &positions = mesh.GetPositions();
+    const auto &normals = mesh.GetNormals();
+    const auto &tangents = mesh.GetTangents();
+    const auto &texCoords = mesh.GetTexCoords();
+
+    glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+    glm::vec3 boundsMax{ -std::numeric_limits<float>::max() };
+    for (const glm::vec3 &position : positions)
+    {
+        boundsMin = glm::min(boundsMin, position);
+        boundsMax = glm::max(boundsMax, position);
+    }
+
+    if (positions.empty())
+    {
+        return result;
+    }
+
+    glm::vec3 extent = boundsMax - boundsMin;
+    result.positionOffset = boundsMin;
+    result.positionScale = extent;
+
+    result.vertices.resize(positions.size());
+
+    for (size_t vertex = 0; vertex < positions.size(); ++vertex)
+    {
+        QuantizedVertex &quantized = result.vertices[vertex];
+        memset(&quantized, 0, sizeof(quantized));
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float normalized = extent[axis] > 0.0f ? (positions[vertex][axis] - boundsMin[axis]) / extent[axis] : 0.0f;
+            quantized.position[axis] = static_cast<uint16_t>(std::lround(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+        }
+
+        if (!normals.empty())
+        {
+            EncodeOctahedral(normals[vertex], quantized.normal[0], quantized.normal[1]);
+        }
+
+        if (!tangents.empty())
+        {
+            const glm::vec4 &tangent = tangents[vertex];
+            EncodeOctahedral(glm::vec3{ tangent.x, tangent.y, tangent.z }, quantized.tangent[0], quantized.tangent[1]);
+            quantized.position[3] = tangent.w < 0.0f ? 1 : 0;
+        }
+
+        if (!texCoords.empty())
+        {
+            quantized.texCoord[0] = FloatToHalf(texCoords[vertex].x);
+            quantized.texCoord[1] = FloatToHalf(texCoords[vertex].y);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Mesh;
+
+// Post-transform vertex cache statistics for an index buffer.
+struct VertexCacheStats
+{
+    uint32_t triangleCount{ 0 };
+
+    uint32_t vertexCount{ 0 };
+
+    // Vertex shader invocations with the simulated FIFO cache.
+    uint32_t transformCount{ 0 };
+
+    // Average cache miss ratio: transforms per triangle, 0.5 is the best case for a regular grid.
+    float acmr{ 0.0f };
+
+    // Average transform to vertex ratio, 1.0 means every vertex is shaded exactly once.
+    float atvr{ 0.0f };
+};
+
+// Vertex fetch statistics, measured against a simulated cache of 64 byte lines.
+struct VertexFetchStats
+{
+    uint32_t bytesFetched{ 0 };
+
+    // Bytes fetched divided by the size of the vertex buffer, 1.0 is optimal.
+    float overfetch{ 0.0f };
+};
+
+struct MeshOptimizerReport
+{
+    VertexCacheStats cacheBefore{};
+
+    VertexCacheStats cacheAfter{};
+
+    VertexFetchStats fetchBefore{};
+
+    VertexFetchStats fetchAfter{};
+
+    // Bytes per vertex of the source streams and of the quantised layout.
+    uint32_t vertexStrideBefore{ 0 };
+
+    uint32_t vertexStrideAfter{ 0 };
+};
+
+// Compact vertex layout produced by QuantizeMesh(), 16 bytes per vertex.
+struct QuantizedVertex
+{
+    // Positions normalised to the mesh bounds. The fourth component holds the bitangent sign,
+    // 0 for positive and 1 for negative.
+    uint16_t position[4];
+
+    // Octahedral encoded normal as two snorm8.
+    int8_t normal[2];
+
+    // Octahedral encoded tangent as two snorm8.
+    int8_t tangent[2];
+
+    // Half float texture coordinates.
+    uint16_t texCoord[2];
+};
+
+static_assert(sizeof(QuantizedVertex) == 16, "Unexpected QuantizedVertex size");
+
+struct QuantizedMesh
+{
+    std::vector<QuantizedVertex> vertices;
+
+    std::vector<uint32_t> indices;
+
+    // position = quantised / 65535 * scale + offset
+    glm::vec3 positionOffset{ 0.0f };
+
+    glm::vec3 positionScale{ 1.0f };
+};
+
+namespace MeshOptimizer
+{
+    static constexpr uint32_t DefaultCacheSize = 16;
+
+    VertexCacheStats AnalyzeVertexCache(const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+
+    VertexFetchStats AnalyzeVertexFetch(const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount, uint32_t vertexSize);
+
+    // Tipsify (Sander et al. 2007), linear time reordering for a cache of the given size.
+    void OptimizeVertexCache(uint32_t *destination, const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+
+    // Splits cache optimised triangles into clusters at cache flush points and sorts the clusters front
+    // to back from the mesh centroid, so outward facing geometry is drawn first. threshold bounds how
+    // much the ACMR may degrade, 1.05 allows 5%.
+    void OptimizeOverdraw(uint32_t *destination, const uint32_t *indices, uint32_t indexCount, const glm::vec3 *positions, uint32_t vertexCount, float threshold = 1.05f, uint32_t cacheSize = DefaultCacheSize);
+
+    // Builds a remap table ordering vertices by first use. Returns the number of referenced vertices,
+    // unreferenced ones are mapped to ~0u.
+    uint32_t OptimizeVertexFetchRemap(uint32_t *remap, const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount);
+
+    // Runs cache, overdraw and fetch optimisation per submesh and rewrites the streams of the mesh.
+    MeshOptimizerReport OptimizeMesh(Mesh &mesh, float overdrawThreshold = 1.05f);
+
+    // Adds report to total as if both meshes were one, the ratios are recomputed from the sums.
+    void AccumulateReport(MeshOptimizerReport &total, const MeshOptimizerReport &report);
+
+    void EncodeOctahedral(const glm::vec3 &normal, int8_t &x, int8_t &y);
+
+    glm::vec3 DecodeOctahedral(int8_t x, int8_t y);
+
+    uint16_t FloatToHalf(float value);
+
+    float HalfToFloat(uint16_t value);
+
+    QuantizedMesh QuantizeMesh(const Mesh &mesh);
+}
@@ -0,0 +1,533 @@
+#include "MeshSimplifier.h"
+#include "Mesh.h"
+#include "TriangleAdjacency.h"
+#include "Common/Logging.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// Border edges get a perpendicular plane so collapses along them can't eat into the outline.
+static constexpr double BorderQuadricWeight = 10.0;
+
+static constexpr uint32_t MaxSimplifyPasses = 64;
+
+// Symmetric 4x4 plane quadric, weight is the accumulated area.
+struct Quadric
+{
+    double a00{ 0.0 }, a01{ 0.0 }, a02{ 0.0 }, a11{ 0.0 }, a12{ 0.0 }, a22{ 0.0 };
+
+    double b0{ 0.0 }, b1{ 0.0 }, b2{ 0.0 };
+
+    double c{ 0.0 };
+
+    double weight{ 0.0 };
+
+    static Quadric FromPlane(const glm::vec3 &normal, float distance, double weight)
+    {
+        Quadric quadric;
+        quadric.a00 = weight * normal.x * normal.x;
+        quadric.a01 = weight * normal.x * normal.y;
+        quadric.a02 = weight * normal.x * normal.z;
+        quadric.a11 = weight * normal.y * normal.y;
+        quadric.a12 = weight * normal.y * normal.z;
+        quadric.a22 = weight * normal.z * normal.z;
+        quadric.b0 = weight * normal.x * distance;
+        quadric.b1 = weight * normal.y * distance;
+        quadric.b2 = weight * normal.z * distance;
+        quadric.c = weight * distance * distance;
+        quadric.weight = weight;
+        return quadric;
+    }
+
+    Quadric &operator+=(const Quadric &other)
+    {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    // Weighted mean squared distance of point to the accumulated planes.
+    double Evaluate(const glm::vec3 &point) const
+    {
+        double x = point.x;
+        double y = point.y;
+        double z = point.z;
+
+        double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z
+                     + a11 * y * y + 2.0 * a12 * y * z
+                     + a22 * z * z
+                     + 2.0 * (b0 * x + b1 * y + b2 * z)
+                     + c;
+
+        return weight > 0.0 ? std::fabs(error) / weight : 0.0;
+    }
+};
+
+enum VertexKind : uint8_t
+{
+    ManifoldVertex,
+
+    // On an open border, may only slide along border edges.
+    BorderVertex,
+
+    // Attribute seams, non-manifold vertices and locked borders never move.
+    LockedVertex,
+};
+
+struct Collapse
+{
+    uint32_t from;
+
+    uint32_t to;
+
+    // Squared geometric error, what targetError limits.
+    float error;
+
+    // Geometric error plus the weighted attribute difference, collapses are applied in this order.
+    float cost;
+};
+
+static uint64_t GetEdgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+static void CountEdges(const uint32_t *indices, uint32_t indexCount, const std::vector<uint32_t> &weld, std::unordered_map<uint64_t, uint32_t> &edgeCounts)
+{
+    edgeCounts.clear();
+    for (uint32_t triangle = 0; triangle < indexCount / 3; ++triangle)
+    {
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            uint32_t a = weld[indices[triangle * 3 + corner]];
+            uint32_t b = weld[indices[triangle * 3 + (corner + 1) % 3]];
+            ++edgeCounts[GetEdgeKey(a, b)];
+        }
+    }
+}
+
+// Maps every vertex to the first vertex sharing its position, attribute seams split vertices in place.
+static std::vector<uint32_t> BuildPositionWeld(const std::vector<glm::vec3> &positions)
+{
+    uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+    std::vector<uint32_t> order(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        order[vertex] = vertex;
+    }
+
+    auto less = [&positions](uint32_t a, uint32_t b)
+    {
+        const glm::vec3 &pa = positions[a];
+        const glm::vec3 &pb = positions[b];
+        if (pa.x != pb.x) return pa.x < pb.x;
+        if (pa.y != pb.y) return pa.y < pb.y;
+        if (pa.z != pb.z) return pa.z < pb.z;
+        return a < b;
+    };
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<uint32_t> weld(vertexCount);
+    for (uint32_t index = 0; index < vertexCount; ++index)
+    {
+        uint32_t vertex = order[index];
+        bool samePosition = index > 0 && positions[order[index - 1]] == positions[vertex];
+        weld[vertex] = samePosition ? weld[order[index - 1]] : vertex;
+    }
+
+    return weld;
+}
+
+static glm::vec3 GetTriangleNormal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+    return glm::cross(b - a, c - a);
+}
+
+uint32_t MeshSimplifier::Simplify(uint32_t *destination, const uint32_t *indices, uint32_t indexCount, const Mesh &mesh, uint32_t targetIndexCount, float targetError, const SimplifyParams &params, float *resultError)
+{
+    assert(indexCount % 3 == 0);
+
+    memcpy(destination, indices, indexCount * sizeof(uint32_t));
+
+    if (resultError != nullptr)
+    {
+        *resultError = 0.0f;
+    }
+
+    uint32_t vertexCount = mesh.GetVertexCount();
+    if (indexCount <= targetIndexCount || vertexCount == 0)
+    {
+        return indexCount;
+    }
+
+    // Work in a unit cube so errors and attribute weights don't depend on the scale of the mesh.
+    const std::vector<glm::vec3> &sourcePositions = mesh.GetPositions();
+    glm::vec3 boundsMin = sourcePositions[0];
+    glm::vec3 boundsMax = sourcePositions[0];
+    for (const glm::vec3 &position : sourcePositions)
+    {
+        boundsMin = glm::min(boundsMin, position);
+        boundsMax = glm::max(boundsMax, position);
+    }
+
+    glm::vec3 extent = boundsMax - boundsMin;
+    float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+    float invExtent = maxExtent > 0.0f ? 1.0f / maxExtent : 1.0f;
+
+    std::vector<glm::vec3> positions(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        positions[vertex] = (sourcePositions[vertex] - boundsMin) * invExtent;
+    }
+
+    std::vector<uint32_t> weld = BuildPositionWeld(sourcePositions);
+
+    std::unordered_map<uint64_t, uint32_t> edgeCounts;
+    CountEdges(destination, indexCount, weld, edgeCounts);
+
+    // Classify vertices and seed the quadrics on the welded vertices.
+    std::vector<uint8_t> kinds(vertexCount, ManifoldVertex);
+    std::vector<Quadric> quadrics(vertexCount);
+
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        if (weld[vertex] != vertex)
+        {
+            kinds[vertex] = LockedVertex;
+            kinds[weld[vertex]] = LockedVertex;
+        }
+    }
+
+    for (uint32_t triangle = 0; triangle < indexCount / 3; ++triangle)
+    {
+        const uint32_t *corners = destination + triangle * 3;
+        const glm::vec3 &p0 = positions[corners[0]];
+        const glm::vec3 &p1 = positions[corners[1]];
+        const glm::vec3 &p2 = positions[corners[2]];
+
+        glm::vec3 normal = GetTriangleNormal(p0, p1, p2);
+        float area = glm::length(normal);
+        if (area <= 0.0f)
+        {
+            continue;
+        }
+        normal = normal / area;
+
+        Quadric planeQuadric = Quadric::FromPlane(normal, -glm::dot(normal, p0), area);
+
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            uint32_t a = corners[corner];
+            uint32_t b = corners[(corner + 1) % 3];
+
+            quadrics[weld[a]] += planeQuadric;
+
+            uint32_t edgeCount = edgeCounts[GetEdgeKey(weld[a], weld[b])];
+            if (edgeCount == 1)
+            {
+                uint8_t borderKind = params.lockBorder ? LockedVertex : BorderVertex;
+                kinds[a] = std::max(kinds[a], borderKind);
+                kinds[b] = std::max(kinds[b], borderKind);
+
+                glm::vec3 edge = positions[b] - positions[a];
+                float edgeLength = glm::length(edge);
+                if (edgeLength > 0.0f)
+                {
+                    glm::vec3 borderNormal = glm::normalize(glm::cross(edge, normal));
+                    Quadric borderQuadric = Quadric::FromPlane(borderNormal, -glm::dot(borderNormal, positions[a]), BorderQuadricWeight * edgeLength * edgeLength);
+                    quadrics[weld[a]] += borderQuadric;
+                    quadrics[weld[b]] += borderQuadric;
+                }
+            }
+            else if (edgeCount > 2)
+            {
+                kinds[a] = LockedVertex;
+                kinds[b] = LockedVertex;
+            }
+        }
+    }
+
+    const std::vector<glm::vec3> &normals = mesh.GetNormals();
+    const std::vector<glm::vec2> &texCoords = mesh.GetTexCoords();
+
+    auto getAttributeError = [&](uint32_t from, uint32_t to)
+    {
+        float error = 0.0f;
+        if (!normals.empty())
+        {
+            glm::vec3 delta = normals[from] - normals[to];
+            error += params.normalWeight * glm::dot(delta, delta);
+        }
+        if (!texCoords.empty())
+        {
+            glm::vec2 delta = texCoords[from] - texCoords[to];
+            error += params.texCoordWeight * glm::dot(delta, delta);
+        }
+        return error;
+    };
+
+    float errorLimit = targetError * targetError;
+    float maxError = 0.0f;
+
+    TriangleAdjacency adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> passLocked(vertexCount);
+
+    for (uint32_t pass = 0; pass < MaxSimplifyPasses && indexCount > targetIndexCount; ++pass)
+    {
+        adjacency.Build(destination, indexCount, vertexCount);
+        if (pass > 0)
+        {
+            CountEdges(destination, indexCount, weld, edgeCounts);
+        }
+
+        auto isBorderEdge = [&](uint32_t a, uint32_t b)
+        {
+            auto edge = edgeCounts.find(GetEdgeKey(weld[a], weld[b]));
+            return edge != edgeCounts.end() && edge->second == 1;
+        };
+
+        collapses.clear();
+        for (uint32_t triangle = 0; triangle < indexCount / 3; ++triangle)
+        {
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t a = destination[triangle * 3 + corner];
+                uint32_t b = destination[triangle * 3 + (corner + 1) % 3];
+
+                for (uint32_t direction = 0; direction < 2; ++direction)
+                {
+                    uint32_t from = direction == 0 ? a : b;
+                    uint32_t to = direction == 0 ? b : a;
+
+                    if (kinds[from] == LockedVertex || (kinds[from] == BorderVertex && !isBorderEdge(from, to)))
+                    {
+                        continue;
+                    }
+
+                    Quadric quadric = quadrics[weld[from]];
+                    quadric += quadrics[weld[to]];
+
+                    float error = static_cast<float>(quadric.Evaluate(positions[to]));
+                    if (error <= errorLimit)
+                    {
+                        collapses.push_back(Collapse{ from, to, error, error + getAttributeError(from, to) });
+                    }
+                }
+            }
+        }
+
+        if (collapses.empty())
+        {
+            break;
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            remap[vertex] = vertex;
+        }
+        std::fill(passLocked.begin(), passLocked.end(), false);
+
+        uint32_t trianglesToRemove = (indexCount - targetIndexCount) / 3;
+        uint32_t trianglesRemoved = 0;
+        uint32_t collapseCount = 0;
+
+        for (const Collapse &collapse : collapses)
+        {
+            if (passLocked[collapse.from] || passLocked[collapse.to])
+            {
+                continue;
+            }
+
+            // Reject collapses that flip or degenerate any surviving triangle around the moving vertex.
+            const uint32_t *triangles = adjacency.GetTriangles(collapse.from);
+            uint32_t removed = 0;
+            bool flips = false;
+
+            for (uint32_t neighbour = 0; neighbour < adjacency.counts[collapse.from] && !flips; ++neighbour)
+            {
+                const uint32_t *corners = destination + triangles[neighbour] * 3;
+                if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+                {
+                    ++removed;
+                    continue;
+                }
+
+                glm::vec3 before = GetTriangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+
+                glm::vec3 moved[3];
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    moved[corner] = corners[corner] == collapse.from ? positions[collapse.to] : positions[corners[corner]];
+                }
+                glm::vec3 after = GetTriangleNormal(moved[0], moved[1], moved[2]);
+
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+
+            if (flips)
+            {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[weld[collapse.to]] += quadrics[weld[collapse.from]];
+            maxError = std::max(maxError, collapse.error);
+
+            // Everything touching the moved vertex has a stale cost and flip test until the next pass.
+            for (uint32_t neighbour = 0; neighbour < adjacency.counts[collapse.from]; ++neighbour)
+            {
+                const uint32_t *corners = destination + triangles[neighbour] * 3;
+                passLocked[corners[0]] = true;
+                passLocked[corners[1]] = true;
+                passLocked[corners[2]] = true;
+            }
+
+            ++collapseCount;
+            trianglesRemoved += removed;
+            if (trianglesRemoved >= trianglesToRemove)
+            {
+                break;
+            }
+        }
+
+        if (collapseCount == 0)
+        {
+            break;
+        }
+
+        uint32_t writeIndex = 0;
+        for (uint32_t triangle = 0; triangle < indexCount / 3; ++triangle)
+        {
+            uint32_t a = remap[destination[triangle * 3 + 0]];
+            uint32_t b = remap[destination[triangle * 3 + 1]];
+            uint32_t c = remap[destination[triangle * 3 + 2]];
+
+            if (a != b && b != c && c != a)
+            {
+                destination[writeIndex++] = a;
+                destination[writeIndex++] = b;
+                destination[writeIndex++] = c;
+            }
+        }
+        indexCount = writeIndex;
+    }
+
+    if (resultError != nullptr)
+    {
+        *resultError = std::sqrt(maxError);
+    }
+
+    return indexCount;
+}
+
+void MeshSimplifier::BuildLodChain(Mesh &mesh, const LodChainParams &params, LodChainStats *stats)
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point startTime = Clock::now();
+
+    std::vector<uint32_t> &indices = mesh.GetIndices();
+
+    // Drop the previous chain, its ranges always follow the full detail ones.
+    uint32_t baseIndexCount = 0;
+    for (const SubMesh &subMesh : mesh.GetSubMeshes())
+    {
+        baseIndexCount = std::max(baseIndexCount, subMesh.indexOffset + subMesh.indexCount);
+    }
+    indices.resize(baseIndexCount);
+    mesh.GetLods().clear();
+
+    mesh.ComputeBounds();
+
+    glm::vec3 extent = mesh.GetBounds().max - mesh.GetBounds().min;
+    float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+
+    uint32_t lodCount = std::min(params.maxLodCount, MaxMeshLods);
+    float parentError = 0.0f;
+    uint32_t parentTriangles = mesh.GetLodTriangleCount(0);
+
+    LodChainStats localStats{};
+    localStats.triangleCounts[0] = parentTriangles;
+    localStats.lodCount = 1;
+
+    std::vector<uint32_t> simplified;
+
+    for (uint32_t lod = 1; lod < lodCount; ++lod)
+    {
+        float errorBudget = params.maxError - parentError;
+        if (errorBudget <= 0.0f)
+        {
+            break;
+        }
+
+        MeshLod level{};
+        float levelError = 0.0f;
+        uint32_t levelIndexOffset = static_cast<uint32_t>(indices.size());
+
+        const std::vector<SubMesh> parentSubMeshes = mesh.GetLodSubMeshes(lod - 1);
+        for (const SubMesh &parent : parentSubMeshes)
+        {
+            uint32_t targetIndexCount = static_cast<uint32_t>(parent.indexCount / 3 * params.reductionPerLod) * 3;
+
+            simplified.resize(parent.indexCount);
+
+            float error = 0.0f;
+            uint32_t indexCount = Simplify(simplified.data(), indices.data() + parent.indexOffset, parent.indexCount, mesh, targetIndexCount, errorBudget, params.simplify, &error);
+
+            SubMesh subMesh{};
+            subMesh.indexOffset = static_cast<uint32_t>(indices.size());
+            subMesh.indexCount = indexCount;
+            subMesh.materialIndex = parent.materialIndex;
+            indices.insert(indices.end(), simplified.begin(), simplified.begin() + indexCount);
+
+            level.subMeshes.push_back(subMesh);
+            level.triangleCount += indexCount / 3;
+            levelError = std::max(levelError, error);
+        }
+
+        // Errors of consecutive levels add up in the worst case.
+        float error = parentError + levelError;
+
+        if (level.triangleCount == 0 || level.triangleCount > parentTriangles * (1.0f - params.minReduction))
+        {
+            indices.resize(levelIndexOffset);
+            break;
+        }
+
+        level.error = error * maxExtent;
+        mesh.GetLods().push_back(std::move(level));
+
+        localStats.triangleCounts[lod] = mesh.GetLods().back().triangleCount;
+        localStats.errors[lod] = mesh.GetLods().back().error;
+        localStats.lodCount = lod + 1;
+
+        parentError = error;
+        parentTriangles = mesh.GetLods().back().triangleCount;
+    }
+
+    localStats.seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    LOGD("LOD chain for {}: {} levels, {} -> {} triangles in {:.2f} ms", mesh.GetName(), localStats.lodCount,
+         localStats.triangleCounts[0], localStats.triangleCounts[localStats.lodCount - 1], localStats.seconds * 1000.0);
+
+    if (stats != nullptr)
+    {
+        *stats = localStats;
+    }
+}
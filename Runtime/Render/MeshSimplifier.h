@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+class Mesh;
+
+// Including the full detail level.
+static constexpr uint32_t MaxMeshLods = 8;
+
+struct SimplifyParams
+{
+    // Weights of the squared normal and texture coordinate differences added to the squared position
+    // error, with positions normalised to the mesh extent. They order the collapses so edges across
+    // attribute discontinuities go last; the error limit only applies to the geometry.
+    float normalWeight{ 0.25f };
+
+    float texCoordWeight{ 1.0f };
+
+    // Keeps open borders, including the edges a submesh shares with its neighbours, in place.
+    bool lockBorder{ false };
+};
+
+struct LodChainParams
+{
+    // Including the full detail level, at most MaxMeshLods.
+    uint32_t maxLodCount{ 4 };
+
+    // Triangle count of each level relative to the previous one.
+    float reductionPerLod{ 0.5f };
+
+    // Upper bound of the error of any level, relative to the mesh extent.
+    float maxError{ 0.05f };
+
+    // A level that removes less than this fraction of the triangles of its parent ends the chain.
+    float minReduction{ 0.1f };
+
+    SimplifyParams simplify{};
+};
+
+struct LodChainStats
+{
+    uint32_t lodCount{ 0 };
+
+    uint32_t triangleCounts[MaxMeshLods]{};
+
+    // Object space error of every level, level 0 is always 0.
+    float errors[MaxMeshLods]{};
+
+    double seconds{ 0.0 };
+};
+
+// Quadric error metric edge collapse (Garland and Heckbert 1997). Vertices only collapse onto existing
+// vertices, so every level keeps sharing the vertex streams of the source mesh.
+namespace MeshSimplifier
+{
+    // Simplifies one triangle list towards targetIndexCount without exceeding targetError, both
+    // relative to the mesh extent. Returns the index count written to destination, which must hold
+    // indexCount indices. resultError receives the relative error of the result.
+    uint32_t Simplify(uint32_t *destination, const uint32_t *indices, uint32_t indexCount, const Mesh &mesh, uint32_t targetIndexCount, float targetError, const SimplifyParams &params, float *resultError = nullptr);
+
+    // Replaces the LOD levels of mesh, each simplified from the one before it. The new ranges are
+    // appended to the index buffer of the mesh.
+    void BuildLodChain(Mesh &mesh, const LodChainParams &params, LodChainStats *stats = nullptr);
+}
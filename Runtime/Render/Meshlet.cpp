@@ -0,0 +1,392 @@
+#include "Meshlet.h"
+#include "Mesh.h"
+#include "TriangleAdjacency.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+static constexpr uint32_t InvalidIndex = ~0u;
+
+std::vector<uint32_t> MeshletData::BuildIndexBuffer() const
+{
+    std::vector<uint32_t> indices(triangles.size());
+
+    for (const Meshlet &meshlet : meshlets)
+    {
+        for (uint32_t corner = 0; corner < meshlet.triangleCount * 3; ++corner)
+        {
+            uint32_t index = meshlet.triangleOffset * 3 + corner;
+            indices[index] = vertices[meshlet.vertexOffset + triangles[index]];
+        }
+    }
+
+    return indices;
+}
+
+std::vector<GpuMeshlet> MeshletData::BuildGpuMeshlets() const
+{
+    assert(meshlets.size() == bounds.size());
+
+    std::vector<GpuMeshlet> gpuMeshlets(meshlets.size());
+
+    for (size_t index = 0; index < meshlets.size(); ++index)
+    {
+        const Meshlet &meshlet = meshlets[index];
+        const MeshletBounds &meshletBounds = bounds[index];
+
+        GpuMeshlet &gpuMeshlet = gpuMeshlets[index];
+        gpuMeshlet.boundingSphere = glm::vec4{ meshletBounds.center, meshletBounds.radius };
+        gpuMeshlet.coneApex = glm::vec4{ meshletBounds.coneApex, 0.0f };
+        gpuMeshlet.coneAxisCutoff = glm::vec4{ meshletBounds.coneAxis, meshletBounds.coneCutoff };
+        gpuMeshlet.firstIndex = meshlet.triangleOffset * 3;
+        gpuMeshlet.indexCount = meshlet.triangleCount * 3;
+        gpuMeshlet.padding[0] = 0;
+        gpuMeshlet.padding[1] = 0;
+    }
+
+    return gpuMeshlets;
+}
+
+MeshletBounds MeshletBuilder::ComputeBounds(const uint32_t *vertices, const uint8_t *triangles, uint32_t triangleCount, const glm::vec3 *positions)
+{
+    MeshletBounds bounds{};
+
+    if (triangleCount == 0)
+    {
+        return bounds;
+    }
+
+    auto position = [&](uint32_t corner) -> const glm::vec3 & { return positions[vertices[triangles[corner]]]; };
+
+    uint32_t cornerCount = triangleCount * 3;
+
+    // Ritter's sphere: start from two far apart points, then grow to enclose the rest.
+    auto farthestFrom = [&](const glm::vec3 &point)
+    {
+        uint32_t farthest = 0;
+        float farthestDistance = -1.0f;
+        for (uint32_t corner = 0; corner < cornerCount; ++corner)
+        {
+            glm::vec3 delta = position(corner) - point;
+            float distance = glm::dot(delta, delta);
+            if (distance > farthestDistance)
+            {
+                farthestDistance = distance;
+                farthest = corner;
+            }
+        }
+        return position(farthest);
+    };
+
+    glm::vec3 first = farthestFrom(position(0));
+    glm::vec3 second = farthestFrom(first);
+
+    glm::vec3 center = (first + second) * 0.5f;
+    float radius = glm::length(second - first) * 0.5f;
+
+    for (uint32_t corner = 0; corner < cornerCount; ++corner)
+    {
+        glm::vec3 delta = position(corner) - center;
+        float distance = glm::length(delta);
+        if (distance > radius)
+        {
+            float newRadius = (radius + distance) * 0.5f;
+            center += delta * ((newRadius - radius) / distance);
+            radius = newRadius;
+        }
+    }
+
+    bounds.center = center;
+    bounds.radius = radius;
+
+    // Normal cone from the unit triangle normals, degenerate triangles don't vote.
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> centroids;
+    normals.reserve(triangleCount);
+    centroids.reserve(triangleCount);
+
+    glm::vec3 axis{ 0.0f };
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const glm::vec3 &a = position(triangle * 3 + 0);
+        const glm::vec3 &b = position(triangle * 3 + 1);
+        const glm::vec3 &c = position(triangle * 3 + 2);
+
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float area = glm::length(normal);
+        if (area <= 0.0f)
+        {
+            continue;
+        }
+
+        normals.push_back(normal / area);
+        centroids.push_back((a + b + c) / 3.0f);
+        axis += normals.back();
+    }
+
+    float axisLength = glm::length(axis);
+    if (normals.empty() || axisLength <= 0.0f)
+    {
+        return bounds;
+    }
+    axis = axis / axisLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3 &normal : normals)
+    {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+
+    // Wider than ~84 degrees the cone almost never culls, leave it disabled.
+    if (minDot <= 0.1f)
+    {
+        return bounds;
+    }
+
+    // Slide the apex back along the axis until it is behind every triangle plane.
+    float minOffset = std::numeric_limits<float>::max();
+    for (size_t triangle = 0; triangle < normals.size(); ++triangle)
+    {
+        float offset = glm::dot(centroids[triangle] - center, normals[triangle]) / glm::dot(axis, normals[triangle]);
+        minOffset = std::min(minOffset, offset);
+    }
+
+    bounds.coneApex = center + axis * minOffset;
+    bounds.coneAxis = axis;
+    bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+
+    return bounds;
+}
+
+// Unemitted triangles looked at when no connected one fits, and how far past the cursor to look for them.
+static constexpr uint32_t SeedCandidateCount = 32;
+
+static constexpr uint32_t SeedScanLimit = 256;
+
+static uint32_t SpreadBits(uint32_t value)
+{
+    value = (value | (value << 16)) & 0x030000ffu;
+    value = (value | (value << 8)) & 0x0300f00fu;
+    value = (value | (value << 4)) & 0x030c30c3u;
+    value = (value | (value << 2)) & 0x09249249u;
+    return value;
+}
+
+// Triangles sorted along a Morton curve over their centroids, ties in input order.
+static std::vector<uint32_t> SortTrianglesSpatially(const std::vector<glm::vec3> &centroids)
+{
+    glm::vec3 minimum{ std::numeric_limits<float>::max() };
+    glm::vec3 maximum{ std::numeric_limits<float>::lowest() };
+    for (const glm::vec3 &centroid : centroids)
+    {
+        minimum = glm::min(minimum, centroid);
+        maximum = glm::max(maximum, centroid);
+    }
+
+    glm::vec3 extent = maximum - minimum;
+    float scale = 1023.0f / std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-20f));
+
+    std::vector<std::pair<uint32_t, uint32_t>> keys(centroids.size());
+    for (uint32_t triangle = 0; triangle < centroids.size(); ++triangle)
+    {
+        glm::vec3 cell = (centroids[triangle] - minimum) * scale;
+        uint32_t code = SpreadBits(static_cast<uint32_t>(cell.x)) | (SpreadBits(static_cast<uint32_t>(cell.y)) << 1) | (SpreadBits(static_cast<uint32_t>(cell.z)) << 2);
+        keys[triangle] = { code, triangle };
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> order(centroids.size());
+    for (uint32_t index = 0; index < keys.size(); ++index)
+    {
+        order[index] = keys[index].second;
+    }
+    return order;
+}
+
+void MeshletBuilder::Build(const uint32_t *indices, uint32_t indexCount, const glm::vec3 *positions, uint32_t vertexCount, MeshletData &meshletData)
+{
+    assert(indexCount % 3 == 0);
+
+    uint32_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    TriangleAdjacency adjacency;
+    adjacency.Build(indices, indexCount, vertexCount);
+
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        centroids[triangle] = (positions[indices[triangle * 3]] + positions[indices[triangle * 3 + 1]] + positions[indices[triangle * 3 + 2]]) * (1.0f / 3.0f);
+    }
+
+    // Unwelded and non-indexed meshes have no adjacency to grow along, the spatial order stands in for
+    // it when looking for the next triangle.
+    std::vector<uint32_t> spatialOrder = SortTrianglesSpatially(centroids);
+
+    // Local index of each mesh vertex in the meshlet being built.
+    std::vector<uint32_t> localIndices(vertexCount, InvalidIndex);
+
+    Meshlet meshlet{};
+    glm::vec3 centroidSum{ 0.0f };
+    meshlet.vertexOffset = static_cast<uint32_t>(meshletData.vertices.size());
+    meshlet.triangleOffset = static_cast<uint32_t>(meshletData.triangles.size() / 3);
+
+    auto flush = [&]()
+    {
+        if (meshlet.triangleCount == 0)
+        {
+            return;
+        }
+
+        meshletData.bounds.push_back(ComputeBounds(&meshletData.vertices[meshlet.vertexOffset], &meshletData.triangles[meshlet.triangleOffset * 3], meshlet.triangleCount, positions));
+        meshletData.meshlets.push_back(meshlet);
+
+        for (uint32_t vertex = 0; vertex < meshlet.vertexCount; ++vertex)
+        {
+            localIndices[meshletData.vertices[meshlet.vertexOffset + vertex]] = InvalidIndex;
+        }
+
+        meshlet.vertexOffset = static_cast<uint32_t>(meshletData.vertices.size());
+        meshlet.triangleOffset = static_cast<uint32_t>(meshletData.triangles.size() / 3);
+        meshlet.vertexCount = 0;
+        meshlet.triangleCount = 0;
+        centroidSum = glm::vec3{ 0.0f };
+    };
+
+    auto newVertexCount = [&](uint32_t triangle)
+    {
+        uint32_t count = 0;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            count += localIndices[indices[triangle * 3 + corner]] == InvalidIndex ? 1 : 0;
+        }
+        return count;
+    };
+
+    auto fits = [&](uint32_t triangle)
+    {
+        return meshlet.triangleCount < MaxMeshletTriangles && meshlet.vertexCount + newVertexCount(triangle) <= MaxMeshletVertices;
+    };
+
+    uint32_t scanCursor = 0;
+    uint32_t triangle = 0;
+
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (!fits(triangle))
+        {
+            flush();
+        }
+
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            if (localIndices[vertex] == InvalidIndex)
+            {
+                localIndices[vertex] = meshlet.vertexCount++;
+                meshletData.vertices.push_back(vertex);
+            }
+            meshletData.triangles.push_back(static_cast<uint8_t>(localIndices[vertex]));
+        }
+        ++meshlet.triangleCount;
+        centroidSum += centroids[triangle];
+        emitted[triangle] = true;
+
+        // Continue with the neighbour that adds the fewest new vertices.
+        uint32_t bestTriangle = InvalidIndex;
+        uint32_t bestScore = InvalidIndex;
+
+        for (uint32_t vertex = 0; vertex < meshlet.vertexCount && bestScore != 0; ++vertex)
+        {
+            uint32_t meshVertex = meshletData.vertices[meshlet.vertexOffset + vertex];
+            const uint32_t *neighbours = &adjacency.triangles[adjacency.offsets[meshVertex]];
+
+            for (uint32_t neighbour = 0; neighbour < adjacency.counts[meshVertex]; ++neighbour)
+            {
+                uint32_t candidate = neighbours[neighbour];
+                if (emitted[candidate] || !fits(candidate))
+                {
+                    continue;
+                }
+
+                uint32_t score = newVertexCount(candidate);
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = candidate;
+                    if (score == 0)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        // No connected triangle fits, keep filling with the unconnected one nearest the meshlet among the
+        // next few in spatial order. The meshlet is only closed once not even those fit.
+        while (scanCursor < triangleCount && emitted[spatialOrder[scanCursor]])
+        {
+            ++scanCursor;
+        }
+
+        if (bestTriangle == InvalidIndex && scanCursor < triangleCount)
+        {
+            glm::vec3 meshletCentroid = centroidSum / static_cast<float>(meshlet.triangleCount);
+            float bestDistance = std::numeric_limits<float>::max();
+
+            uint32_t candidateCount = 0;
+            uint32_t scanEnd = std::min(triangleCount, scanCursor + SeedScanLimit);
+            for (uint32_t cursor = scanCursor; cursor < scanEnd && candidateCount < SeedCandidateCount; ++cursor)
+            {
+                uint32_t candidate = spatialOrder[cursor];
+                if (emitted[candidate])
+                {
+                    continue;
+                }
+                ++candidateCount;
+
+                glm::vec3 offset = centroids[candidate] - meshletCentroid;
+                float distance = glm::dot(offset, offset);
+                if (distance < bestDistance && fits(candidate))
+                {
+                    bestDistance = distance;
+                    bestTriangle = candidate;
+                }
+            }
+
+            // Full, start the next meshlet where the spatial order continues.
+            if (bestTriangle == InvalidIndex)
+            {
+                bestTriangle = spatialOrder[scanCursor];
+            }
+        }
+
+        triangle = bestTriangle;
+    }
+
+    flush();
+}
+
+void MeshletBuilder::Build(const Mesh &mesh, MeshletData &meshletData)
+{
+    meshletData = MeshletData{};
+
+    const std::vector<uint32_t> &indices = mesh.GetIndices();
+
+    for (const SubMesh &subMesh : mesh.GetSubMeshes())
+    {
+        MeshletRange range{};
+        range.meshletOffset = static_cast<uint32_t>(meshletData.meshlets.size());
+
+        Build(indices.data() + subMesh.indexOffset, subMesh.indexCount, mesh.GetPositions().data(), mesh.GetVertexCount(), meshletData);
+
+        range.meshletCount = static_cast<uint32_t>(meshletData.meshlets.size()) - range.meshletOffset;
+        meshletData.subMeshes.push_back(range);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Mesh;
+
+static constexpr uint32_t MaxMeshletVertices = 64;
+
+static constexpr uint32_t MaxMeshletTriangles = 124;
+
+struct Meshlet
+{
+    // Offsets into MeshletData::vertices and, in triangles, into MeshletData::triangles / 3.
+    uint32_t vertexOffset{ 0 };
+
+    uint32_t triangleOffset{ 0 };
+
+    uint32_t vertexCount{ 0 };
+
+    uint32_t triangleCount{ 0 };
+};
+
+struct MeshletBounds
+{
+    glm::vec3 center{ 0.0f };
+
+    float radius{ 0.0f };
+
+    // Every triangle faces away from a viewer at position p when
+    // dot(normalize(coneApex - p), coneAxis) >= coneCutoff. A cutoff above 1 disables the test.
+    glm::vec3 coneApex{ 0.0f };
+
+    glm::vec3 coneAxis{ 0.0f };
+
+    float coneCutoff{ 2.0f };
+};
+
+// std430 layout read by the culling shader, 64 bytes.
+struct GpuMeshlet
+{
+    glm::vec4 boundingSphere;
+
+    glm::vec4 coneApex;
+
+    // xyz is the axis, w the cutoff.
+    glm::vec4 coneAxisCutoff;
+
+    // Range in the buffer returned by MeshletData::BuildIndexBuffer().
+    uint32_t firstIndex;
+
+    uint32_t indexCount;
+
+    uint32_t padding[2];
+};
+
+static_assert(sizeof(GpuMeshlet) == 64, "GpuMeshlet must match the std430 layout of the culling shader");
+
+struct MeshletRange
+{
+    uint32_t meshletOffset{ 0 };
+
+    uint32_t meshletCount{ 0 };
+};
+
+struct MeshletData
+{
+    std::vector<Meshlet> meshlets;
+
+    std::vector<MeshletBounds> bounds;
+
+    // Mesh vertex index of every meshlet vertex.
+    std::vector<uint32_t> vertices;
+
+    // Three meshlet-local vertex indices per triangle.
+    std::vector<uint8_t> triangles;
+
+    // Meshlets of each submesh, meshlets never span submeshes.
+    std::vector<MeshletRange> subMeshes;
+
+    // Expands the local triangles into a 32-bit index buffer referencing the mesh vertices. Meshlet i
+    // starts at index meshlets[i].triangleOffset * 3.
+    std::vector<uint32_t> BuildIndexBuffer() const;
+
+    std::vector<GpuMeshlet> BuildGpuMeshlets() const;
+};
+
+namespace MeshletBuilder
+{
+    // Greedily grows meshlets over triangle adjacency, starting from the input order, so a cache
+    // optimised index buffer (see MeshOptimizer) gives the most compact clusters. When no connected
+    // triangle fits, as on unwelded or non-indexed meshes, the nearest unconnected one fills the meshlet
+    // up to its vertex and triangle limits.
+    void Build(const uint32_t *indices, uint32_t indexCount, const glm::vec3 *positions, uint32_t vertexCount, MeshletData &meshletData);
+
+    // Builds meshlets for every submesh of mesh, replacing the contents of meshletData.
+    void Build(const Mesh &mesh, MeshletData &meshletData);
+
+    MeshletBounds ComputeBounds(const uint32_t *vertices, const uint8_t *triangles, uint32_t triangleCount, const glm::vec3 *positions);
+}
@@ -0,0 +1,80 @@
+#include "MeshletCuller.h"
+#include "Meshlet.h"
+
+MeshletCullParams MeshletCullParams::FromWorld(const glm::mat4 &viewProjection, const glm::mat4 &world, const glm::vec3 &cameraPosition)
+{
+    MeshletCullParams params{};
+    params.frustum = Frustum::FromMatrix(viewProjection * world);
+
+    glm::vec4 localCamera = glm::inverse(world) * glm::vec4{ cameraPosition, 1.0f };
+    params.cameraPosition = glm::vec3{ localCamera.x, localCamera.y, localCamera.z };
+
+    return params;
+}
+
+bool MeshletCuller::IsVisible(const GpuMeshlet &meshlet, const MeshletCullParams &params, MeshletCullStats *stats)
+{
+    glm::vec3 center{ meshlet.boundingSphere.x, meshlet.boundingSphere.y, meshlet.boundingSphere.z };
+
+    if (!params.frustum.IntersectsSphere(center, meshlet.boundingSphere.w))
+    {
+        if (stats != nullptr)
+        {
+            ++stats->frustumCulled;
+        }
+        return false;
+    }
+
+    float cutoff = meshlet.coneAxisCutoff.w;
+    if (params.coneCulling && cutoff <= 1.0f)
+    {
+        glm::vec3 apex{ meshlet.coneApex.x, meshlet.coneApex.y, meshlet.coneApex.z };
+        glm::vec3 axis{ meshlet.coneAxisCutoff.x, meshlet.coneAxisCutoff.y, meshlet.coneAxisCutoff.z };
+
+        glm::vec3 direction = apex - params.cameraPosition;
+        float distance = glm::length(direction);
+
+        if (distance > 0.0f && glm::dot(direction / distance, axis) >= cutoff)
+        {
+            if (stats != nullptr)
+            {
+                ++stats->coneCulled;
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t MeshletCuller::Cull(const GpuMeshlet *meshlets, uint32_t meshletCount, const MeshletCullParams &params, std::vector<DrawIndexedIndirectCommand> &draws, MeshletCullStats *stats)
+{
+    uint32_t drawCount = 0;
+
+    for (uint32_t index = 0; index < meshletCount; ++index)
+    {
+        const GpuMeshlet &meshlet = meshlets[index];
+        if (!IsVisible(meshlet, params, stats))
+        {
+            continue;
+        }
+
+        DrawIndexedIndirectCommand draw{};
+        draw.indexCount = meshlet.indexCount;
+        draw.instanceCount = 1;
+        draw.firstIndex = meshlet.firstIndex;
+        draw.vertexOffset = 0;
+        draw.firstInstance = index;
+        draws.push_back(draw);
+
+        ++drawCount;
+    }
+
+    if (stats != nullptr)
+    {
+        stats->meshletCount += meshletCount;
+        stats->visibleCount += drawCount;
+    }
+
+    return drawCount;
+}
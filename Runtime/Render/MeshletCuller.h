@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Frustum.h"
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+struct GpuMeshlet;
+
+// Same layout as VkDrawIndexedIndirectCommand, so the CPU and GPU paths produce identical buffers.
+struct DrawIndexedIndirectCommand
+{
+    uint32_t indexCount;
+
+    uint32_t instanceCount;
+
+    uint32_t firstIndex;
+
+    int32_t vertexOffset;
+
+    // Index of the meshlet or instance that produced the draw, read back through gl_InstanceIndex.
+    uint32_t firstInstance;
+};
+
+static_assert(sizeof(DrawIndexedIndirectCommand) == 20, "DrawIndexedIndirectCommand must match VkDrawIndexedIndirectCommand");
+
+// Culling inputs in the object space of the mesh.
+struct MeshletCullParams
+{
+    Frustum frustum{};
+
+    glm::vec3 cameraPosition{ 0.0f };
+
+    bool coneCulling{ true };
+
+    // Transforms the camera into the object space of world. Cone culling assumes world has a
+    // uniform scale.
+    static MeshletCullParams FromWorld(const glm::mat4 &viewProjection, const glm::mat4 &world, const glm::vec3 &cameraPosition);
+};
+
+struct MeshletCullStats
+{
+    uint32_t meshletCount{ 0 };
+
+    uint32_t frustumCulled{ 0 };
+
+    uint32_t coneCulled{ 0 };
+
+    uint32_t visibleCount{ 0 };
+};
+
+// CPU reference of the culling shader in VulkanMeshletCuller. Draws come out in meshlet order, the
+// GPU appends them in whatever order its atomics resolve.
+namespace MeshletCuller
+{
+    bool IsVisible(const GpuMeshlet &meshlet, const MeshletCullParams &params, MeshletCullStats *stats = nullptr);
+
+    // Appends one draw per visible meshlet and returns how many were appended.
+    uint32_t Cull(const GpuMeshlet *meshlets, uint32_t meshletCount, const MeshletCullParams &params, std::vector<DrawIndexedIndirectCommand> &draws, MeshletCullStats *stats = nullptr);
+}
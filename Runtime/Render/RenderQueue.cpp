@@ -0,0 +1,188 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t QuantizeDepth(float depth, float maxDepth, uint32_t bits)
+{
+    float normalized = maxDepth > 0.0f ? std::min(std::max(depth / maxDepth, 0.0f), 1.0f) : 0.0f;
+    return static_cast<uint64_t>(normalized * static_cast<float>((1u << bits) - 1));
+}
+
+// Instances only merge when mesh, submesh and LOD match exactly; the key bits just keep them together.
+static uint64_t HashGeometry(const DrawItem &item, uint32_t bits)
+{
+    uint32_t hash = item.meshIndex * 2654435761u ^ item.subMeshIndex * 40503u ^ item.lod * 97u;
+    return hash >> (32 - bits);
+}
+
+static bool CanMerge(const DrawBatch &batch, const DrawItem &item)
+{
+    return batch.pass == item.pass
+        && batch.pipelineIndex == item.pipelineIndex
+        && batch.materialIndex == item.materialIndex
+        && batch.meshIndex == item.meshIndex
+        && batch.subMeshIndex == item.subMeshIndex
+        && batch.lod == item.lod;
+}
+
+uint64_t RenderQueue::MakeSortKey(const DrawItem &item, float maxDepth)
+{
+    uint64_t pass = static_cast<uint64_t>(item.pass) & 0x3;
+    uint64_t pipeline = item.pipelineIndex & 0xFFF;
+    uint64_t material = item.materialIndex & 0xFFFF;
+
+    if (item.pass == TransparentPass)
+    {
+        uint64_t depth = ((1u << 24) - 1) - QuantizeDepth(item.depth, maxDepth, 24);
+        return pass << 62 | depth << 38 | pipeline << 26 | material << 10 | HashGeometry(item, 10);
+    }
+
+    uint64_t depth = QuantizeDepth(item.depth, maxDepth, 18);
+    return pass << 62 | pipeline << 50 | material << 34 | HashGeometry(item, 16) << 18 | depth;
+}
+
+void RenderQueue::Reset(uint32_t capacity, float maxDepth)
+{
+    if (m_Items.size() < capacity)
+    {
+        m_Items.resize(capacity);
+    }
+
+    m_ItemCount.store(0, std::memory_order_relaxed);
+    m_DroppedCount.store(0, std::memory_order_relaxed);
+    m_MaxDepth = maxDepth;
+
+    m_Batches.clear();
+    m_InstanceData.clear();
+    m_Stats = RenderQueueStats{};
+}
+
+void RenderQueue::Submit(const DrawItem &item)
+{
+    uint32_t index = m_ItemCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= m_Items.size())
+    {
+        m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_Items[index] = item;
+}
+
+void RenderQueue::Sort(WorkerThreadPool &pool)
+{
+    Clock::time_point startTime = Clock::now();
+
+    uint32_t count = GetDrawCount();
+
+    if (m_SortItems.size() < count)
+    {
+        m_SortItems.resize(m_Items.size());
+        m_SortScratch.resize(m_Items.size());
+    }
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        m_SortItems[index] = RadixSortItem{ MakeSortKey(m_Items[index], m_MaxDepth), index };
+    }
+
+    ParallelRadixSort(pool, m_SortItems.data(), m_SortScratch.data(), count);
+
+    m_Stats.drawCount = count;
+    m_Stats.droppedCount = m_DroppedCount.load(std::memory_order_relaxed);
+    m_Stats.sortSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+void RenderQueue::BuildBatches()
+{
+    Clock::time_point startTime = Clock::now();
+
+    uint32_t count = GetDrawCount();
+
+    m_Batches.clear();
+    m_InstanceData.resize(count);
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const DrawItem &item = m_Items[m_SortItems[index].value];
+
+        InstanceData &instance = m_InstanceData[index];
+        instance.world = item.world;
+        instance.objectId = item.objectId;
+        instance.padding[0] = 0;
+        instance.padding[1] = 0;
+        instance.padding[2] = 0;
+
+        if (!m_Batches.empty() && CanMerge(m_Batches.back(), item))
+        {
+            ++m_Batches.back().instanceCount;
+            continue;
+        }
+
+        DrawBatch batch{};
+        batch.pass = item.pass;
+        batch.pipelineIndex = item.pipelineIndex;
+        batch.materialIndex = item.materialIndex;
+        batch.meshIndex = item.meshIndex;
+        batch.subMeshIndex = item.subMeshIndex;
+        batch.lod = item.lod;
+        batch.firstInstance = index;
+        batch.instanceCount = 1;
+        m_Batches.push_back(batch);
+    }
+
+    m_Stats.batchCount = static_cast<uint32_t>(m_Batches.size());
+    m_Stats.batchSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+void RenderQueue::Execute(RenderQueueVisitor &visitor)
+{
+    m_Stats.pipelineBinds = 0;
+    m_Stats.materialBinds = 0;
+
+    bool bound = false;
+    uint16_t pipelineIndex = 0;
+    uint32_t materialIndex = 0;
+
+    for (const DrawBatch &batch : m_Batches)
+    {
+        if (!bound || batch.pipelineIndex != pipelineIndex)
+        {
+            visitor.BindPipeline(batch.pipelineIndex);
+            pipelineIndex = batch.pipelineIndex;
+            ++m_Stats.pipelineBinds;
+        }
+
+        if (!bound || batch.materialIndex != materialIndex)
+        {
+            visitor.BindMaterial(batch.materialIndex);
+            materialIndex = batch.materialIndex;
+            ++m_Stats.materialBinds;
+        }
+
+        bound = true;
+        visitor.DrawInstanced(batch);
+    }
+}
+
+const std::vector<DrawBatch> &RenderQueue::GetBatches() const
+{
+    return m_Batches;
+}
+
+const std::vector<InstanceData> &RenderQueue::GetInstanceData() const
+{
+    return m_InstanceData;
+}
+
+uint32_t RenderQueue::GetDrawCount() const
+{
+    return std::min(m_ItemCount.load(std::memory_order_acquire), static_cast<uint32_t>(m_Items.size()));
+}
+
+const RenderQueueStats &RenderQueue::GetStats() const
+{
+    return m_Stats;
+}
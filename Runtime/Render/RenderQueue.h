@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Thread/ParallelRadixSort.h"
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class WorkerThreadPool;
+
+enum RenderQueuePass : uint8_t
+{
+    OpaquePass,
+
+    AlphaTestPass,
+
+    // Sorted back to front, state changes come second.
+    TransparentPass,
+
+    RenderQueuePassCount,
+};
+
+struct DrawItem
+{
+    RenderQueuePass pass{ OpaquePass };
+
+    uint16_t pipelineIndex{ 0 };
+
+    uint32_t materialIndex{ 0 };
+
+    uint32_t meshIndex{ 0 };
+
+    uint32_t subMeshIndex{ 0 };
+
+    uint32_t lod{ 0 };
+
+    // View space distance, quantised against RenderQueue's depth range.
+    float depth{ 0.0f };
+
+    uint32_t objectId{ 0 };
+
+    glm::mat4 world{ 1.0f };
+};
+
+// std430 layout of the per-instance storage buffer, indexed with gl_InstanceIndex.
+struct InstanceData
+{
+    glm::mat4 world;
+
+    uint32_t objectId;
+
+    uint32_t padding[3];
+};
+
+static_assert(sizeof(InstanceData) == 80, "InstanceData must match the std430 layout of the instance buffer");
+
+// Consecutive draws sharing pipeline, material and geometry, drawn as one instanced call.
+struct DrawBatch
+{
+    RenderQueuePass pass{ OpaquePass };
+
+    uint16_t pipelineIndex{ 0 };
+
+    uint32_t materialIndex{ 0 };
+
+    uint32_t meshIndex{ 0 };
+
+    uint32_t subMeshIndex{ 0 };
+
+    uint32_t lod{ 0 };
+
+    // Range in RenderQueue::GetInstanceData().
+    uint32_t firstInstance{ 0 };
+
+    uint32_t instanceCount{ 0 };
+};
+
+struct RenderQueueStats
+{
+    uint32_t drawCount{ 0 };
+
+    uint32_t batchCount{ 0 };
+
+    uint32_t pipelineBinds{ 0 };
+
+    uint32_t materialBinds{ 0 };
+
+    // Draws submitted past the capacity given to Reset().
+    uint32_t droppedCount{ 0 };
+
+    double sortSeconds{ 0.0 };
+
+    double batchSeconds{ 0.0 };
+};
+
+// Backend hook for RenderQueue::Execute(), only called when the bound state actually changes.
+class RenderQueueVisitor
+{
+public:
+
+    virtual ~RenderQueueVisitor() = default;
+
+    virtual void BindPipeline(uint16_t pipelineIndex) = 0;
+
+    virtual void BindMaterial(uint32_t materialIndex) = 0;
+
+    virtual void DrawInstanced(const DrawBatch &batch) = 0;
+};
+
+// Collects the draws of a frame, sorts them by a 64-bit state key and merges identical geometry into
+// instanced batches.
+//
+// Opaque and alpha tested key: pass:2 | pipeline:12 | material:16 | geometry:16 | depth:18 (front to back)
+// Transparent key:             pass:2 | depth:24 (back to front) | pipeline:12 | material:16 | geometry:10
+class RenderQueue : public NonCopyable
+{
+public:
+
+    static uint64_t MakeSortKey(const DrawItem &item, float maxDepth);
+
+    // Clears the queue and makes room for capacity draws; Submit() never allocates.
+    void Reset(uint32_t capacity, float maxDepth);
+
+    // Safe to call from several threads at once.
+    void Submit(const DrawItem &item);
+
+    void Sort(WorkerThreadPool &pool);
+
+    // Must follow Sort(). Fills GetBatches() and GetInstanceData() in draw order.
+    void BuildBatches();
+
+    void Execute(RenderQueueVisitor &visitor);
+
+    const std::vector<DrawBatch> &GetBatches() const;
+
+    const std::vector<InstanceData> &GetInstanceData() const;
+
+    uint32_t GetDrawCount() const;
+
+    const RenderQueueStats &GetStats() const;
+
+private:
+
+    std::vector<DrawItem> m_Items;
+
+    std::atomic<uint32_t> m_ItemCount{ 0 };
+
+    std::atomic<uint32_t> m_DroppedCount{ 0 };
+
+    float m_MaxDepth{ 1.0f };
+
+    std::vector<RadixSortItem> m_SortItems;
+
+    std::vector<RadixSortItem> m_SortScratch;
+
+    std::vector<DrawBatch> m_Batches;
+
+    std::vector<InstanceData> m_InstanceData;
+
+    RenderQueueStats m_Stats{};
+};
@@ -0,0 +1,134 @@
+#include "ShadowAtlas.h"
+#include <algorithm>
+#include <cassert>
+
+static bool IsPowerOfTwo(uint32_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+ShadowAtlas::ShadowAtlas(uint32_t atlasSize, uint32_t minTileSize) :
+    m_AtlasSize{ atlasSize },
+    m_MinTileSize{ minTileSize }
+{
+    assert(IsPowerOfTwo(atlasSize) && IsPowerOfTwo(minTileSize) && minTileSize <= atlasSize);
+
+    m_FreeTiles.resize(GetLevel(minTileSize) + 1);
+    Reset();
+}
+
+uint32_t ShadowAtlas::GetLevel(uint32_t size) const
+{
+    uint32_t level = 0;
+    while ((m_AtlasSize >> level) > size)
+    {
+        ++level;
+    }
+    return level;
+}
+
+ShadowAtlasTile ShadowAtlas::Allocate(uint32_t size)
+{
+    size = std::clamp(size, m_MinTileSize, m_AtlasSize);
+
+    uint32_t level = GetLevel(size);
+
+    // Smallest free tile that still fits, the last one freed first to keep reuse local.
+    uint32_t sourceLevel = level + 1;
+    while (sourceLevel > 0 && m_FreeTiles[sourceLevel - 1].empty())
+    {
+        --sourceLevel;
+    }
+    if (sourceLevel == 0)
+    {
+        return ShadowAtlasTile{};
+    }
+    --sourceLevel;
+
+    ShadowAtlasTile tile = m_FreeTiles[sourceLevel].back();
+    m_FreeTiles[sourceLevel].pop_back();
+
+    // Keep the first quarter and free the other three on the way down.
+    while (sourceLevel < level)
+    {
+        ++sourceLevel;
+        uint32_t half = tile.size / 2;
+        m_FreeTiles[sourceLevel].push_back(ShadowAtlasTile{ tile.x + half, tile.y + half, half });
+        m_FreeTiles[sourceLevel].push_back(ShadowAtlasTile{ tile.x, tile.y + half, half });
+        m_FreeTiles[sourceLevel].push_back(ShadowAtlasTile{ tile.x + half, tile.y, half });
+        tile.size = half;
+    }
+
+    m_AllocatedArea += static_cast<uint64_t>(tile.size) * tile.size;
+    return tile;
+}
+
+void ShadowAtlas::Free(const ShadowAtlasTile &tile)
+{
+    if (!tile.IsValid())
+    {
+        return;
+    }
+
+    assert(m_AllocatedArea >= static_cast<uint64_t>(tile.size) * tile.size);
+    m_AllocatedArea -= static_cast<uint64_t>(tile.size) * tile.size;
+
+    ShadowAtlasTile merged = tile;
+    uint32_t level = GetLevel(merged.size);
+    while (level > 0)
+    {
+        uint32_t parentSize = merged.size * 2;
+        uint32_t parentX = merged.x & ~(parentSize - 1);
+        uint32_t parentY = merged.y & ~(parentSize - 1);
+
+        // The three siblings must all be free to merge.
+        std::vector<ShadowAtlasTile> &freeTiles = m_FreeTiles[level];
+        uint32_t siblingCount = 0;
+        for (const ShadowAtlasTile &free : freeTiles)
+        {
+            if ((free.x & ~(parentSize - 1)) == parentX && (free.y & ~(parentSize - 1)) == parentY)
+            {
+                ++siblingCount;
+            }
+        }
+        if (siblingCount < 3)
+        {
+            break;
+        }
+
+        freeTiles.erase(std::remove_if(freeTiles.begin(), freeTiles.end(), [parentX, parentY, parentSize](const ShadowAtlasTile &free)
+        {
+            return (free.x & ~(parentSize - 1)) == parentX && (free.y & ~(parentSize - 1)) == parentY;
+        }), freeTiles.end());
+
+        merged = ShadowAtlasTile{ parentX, parentY, parentSize };
+        --level;
+    }
+
+    m_FreeTiles[level].push_back(merged);
+}
+
+void ShadowAtlas::Reset()
+{
+    for (std::vector<ShadowAtlasTile> &freeTiles : m_FreeTiles)
+    {
+        freeTiles.clear();
+    }
+    m_FreeTiles[0].push_back(ShadowAtlasTile{ 0, 0, m_AtlasSize });
+    m_AllocatedArea = 0;
+}
+
+uint32_t ShadowAtlas::GetAtlasSize() const
+{
+    return m_AtlasSize;
+}
+
+uint32_t ShadowAtlas::GetMinTileSize() const
+{
+    return m_MinTileSize;
+}
+
+uint64_t ShadowAtlas::GetAllocatedArea() const
+{
+    return m_AllocatedArea;
+}
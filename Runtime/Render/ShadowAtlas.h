@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include <cstdint>
+#include <vector>
+
+// Square region of the shadow atlas, in texels.
+struct ShadowAtlasTile
+{
+    uint32_t x{ 0 };
+
+    uint32_t y{ 0 };
+
+    uint32_t size{ 0 };
+
+    bool IsValid() const { return size != 0; }
+};
+
+// Quadtree allocator for square power of two tiles of a square atlas. A free tile is split into four
+// until it has the requested size, and four free siblings merge back on Free(), so tiles of one size
+// pack without fragmenting the others.
+class ShadowAtlas : public NonCopyable
+{
+public:
+
+    // atlasSize and minTileSize must be powers of two.
+    ShadowAtlas(uint32_t atlasSize, uint32_t minTileSize);
+
+    // size is rounded up to a power of two and clamped to [minTileSize, atlasSize]. Returns an
+    // invalid tile when no region of that size is free.
+    ShadowAtlasTile Allocate(uint32_t size);
+
+    void Free(const ShadowAtlasTile &tile);
+
+    void Reset();
+
+    uint32_t GetAtlasSize() const;
+
+    uint32_t GetMinTileSize() const;
+
+    // Texels covered by allocated tiles.
+    uint64_t GetAllocatedArea() const;
+
+private:
+
+    uint32_t GetLevel(uint32_t size) const;
+
+    uint32_t m_AtlasSize{ 0 };
+
+    uint32_t m_MinTileSize{ 0 };
+
+    // Free tiles of every level, level 0 is the whole atlas.
+    std::vector<std::vector<ShadowAtlasTile>> m_FreeTiles;
+
+    uint64_t m_AllocatedArea{ 0 };
+};
@@ -0,0 +1,382 @@
+#include "ShadowCache.h"
+#include "Common/Hash.h"
+#include "Profiling/CpuProfiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+static constexpr float HalfPi = 1.57079632679f;
+
+// Keeps the spot frustum a little wider than the cone so filtering at the edge stays inside the tile.
+static constexpr float SpotFovMargin = 0.05f;
+
+static constexpr float MaxSpotFov = 3.0f;
+
+struct CubeFace
+{
+    glm::vec3 direction;
+
+    glm::vec3 up;
+};
+
+// Cube map face order and orientation.
+static const CubeFace g_CubeFaces[6]{
+    { { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } },
+    { { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } },
+    { { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+    { { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+    { { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f } },
+    { { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f } } };
+
+static glm::vec3 GetUpVector(const glm::vec3 &direction)
+{
+    return std::abs(direction.y) > 0.99f ? glm::vec3{ 0.0f, 0.0f, 1.0f } : glm::vec3{ 0.0f, 1.0f, 0.0f };
+}
+
+static bool IsPointLight(const GpuLight &light)
+{
+    return light.spotCosAngle <= -1.0f;
+}
+
+GpuCullParams ShadowView::GetCullParams(const GpuCullParams &cameraParams) const
+{
+    GpuCullParams params = cameraParams;
+    params.frustum = frustum;
+    return params;
+}
+
+ShadowCache::ShadowCache(const ShadowSettings &settings) :
+    m_Settings{ settings },
+    m_Atlas{ settings.atlasSize, settings.minTileSize },
+    m_CascadeCount{ std::min(settings.cascadeCount, MaxShadowCascades) }
+{
+    assert(settings.cascadeSnapTexels * 4 < settings.cascadeResolution);
+
+    for (uint32_t cascade = 0; cascade < m_CascadeCount; ++cascade)
+    {
+        m_Cascades[cascade].tile = m_Atlas.Allocate(settings.cascadeResolution);
+        assert(m_Cascades[cascade].tile.IsValid() && "The cascades don't fit into the shadow atlas.");
+    }
+}
+
+void ShadowCache::InvalidateStatic(const BoundingBox &bounds)
+{
+    m_Invalidations.push_back(bounds);
+}
+
+void ShadowCache::InvalidateAll()
+{
+    m_InvalidateAll = true;
+}
+
+void ShadowCache::ComputeCascadeSplits(uint32_t cascadeCount, float nearPlane, float farPlane, float lambda, float *splits)
+{
+    for (uint32_t cascade = 0; cascade < cascadeCount; ++cascade)
+    {
+        float fraction = static_cast<float>(cascade + 1) / static_cast<float>(cascadeCount);
+        float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+        splits[cascade] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+    }
+}
+
+void ShadowCache::Update(const glm::mat4 &cameraView, const glm::mat4 &cameraProjection, float cameraNear, float cameraFar, const glm::vec3 &lightDirection,
+    const ShadowLightRequest *lights, uint32_t lightCount, const BoundingBox *dynamicCasters, uint32_t dynamicCasterCount)
+{
+    PROFILE_SCOPE("ShadowCache::Update");
+
+    ++m_Frame;
+    m_Stats = ShadowCacheStats{};
+    m_Views.clear();
+    m_GpuViews.clear();
+
+    if (m_InvalidateAll)
+    {
+        for (TileState &cascade : m_Cascades)
+        {
+            cascade.cached = false;
+        }
+        for (auto &[id, state] : m_Lights)
+        {
+            for (TileState &face : state.faces)
+            {
+                face.cached = false;
+            }
+        }
+    }
+
+    if (m_CascadeCount > 0 && glm::dot(lightDirection, lightDirection) > 0.0f)
+    {
+        float shadowDistance = std::min(m_Settings.shadowDistance, cameraFar);
+        ComputeCascadeSplits(m_CascadeCount, cameraNear, shadowDistance, m_Settings.splitLambda, m_CascadeSplits);
+
+        // View space rays through the frustum corners, scaled so z is -1, like the cluster bounds.
+        // Works for either clip depth convention.
+        glm::mat4 inverseProjection = glm::inverse(cameraProjection);
+        glm::mat4 inverseView = glm::inverse(cameraView);
+        glm::vec3 cornerRays[4];
+        for (uint32_t corner = 0; corner < 4; ++corner)
+        {
+            glm::vec2 ndc{ corner % 2 == 0 ? -1.0f : 1.0f, corner / 2 == 0 ? -1.0f : 1.0f };
+            glm::vec4 point = inverseProjection * glm::vec4{ ndc, 0.5f, 1.0f };
+            glm::vec3 position = glm::vec3{ point } / point.w;
+            cornerRays[corner] = position / -position.z;
+        }
+
+        glm::vec3 direction = glm::normalize(lightDirection);
+        glm::mat4 lightView = glm::lookAt(glm::vec3{ 0.0f }, direction, GetUpVector(direction));
+
+        float resolution = static_cast<float>(m_Settings.cascadeResolution);
+        float snapTexels = static_cast<float>(m_Settings.cascadeSnapTexels);
+
+        for (uint32_t cascade = 0; cascade < m_CascadeCount; ++cascade)
+        {
+            float sliceNear = cascade == 0 ? cameraNear : m_CascadeSplits[cascade - 1];
+            float sliceFar = m_CascadeSplits[cascade];
+
+            glm::vec3 corners[8];
+            glm::vec3 center{ 0.0f };
+            for (uint32_t corner = 0; corner < 8; ++corner)
+            {
+                float depth = corner < 4 ? sliceNear : sliceFar;
+                corners[corner] = glm::vec3{ inverseView * glm::vec4{ cornerRays[corner % 4] * depth, 1.0f } };
+                center += corners[corner];
+            }
+            center /= 8.0f;
+
+            // The bounding sphere of a slice only turns with the camera, its radius never changes.
+            // Rounding it up keeps float noise out of the projection.
+            float radius = 0.0f;
+            for (const glm::vec3 &corner : corners)
+            {
+                radius = std::max(radius, glm::length(corner - center));
+            }
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            // The projection is wider than the sphere by one snapping step, so it can stay put while
+            // the sphere moves within a step. Steps are whole texels, which keeps the edges stable.
+            float extent = radius / (1.0f - 2.0f * snapTexels / resolution);
+            float step = snapTexels * 2.0f * extent / resolution;
+
+            glm::vec3 lightCenter{ lightView * glm::vec4{ center, 1.0f } };
+            float centerX = (std::floor(lightCenter.x / step) + 0.5f) * step;
+            float centerY = (std::floor(lightCenter.y / step) + 0.5f) * step;
+            float centerDepth = (std::floor(-lightCenter.z / step) + 0.5f) * step;
+
+            glm::mat4 projection = glm::orthoRH_ZO(centerX - extent, centerX + extent, centerY - extent, centerY + extent,
+                centerDepth - extent - m_Settings.casterDistance, centerDepth + extent);
+
+            AddView(m_Cascades[cascade], projection * lightView, ~0u, cascade, dynamicCasters, dynamicCasterCount);
+        }
+    }
+
+    // Lights that went away or changed shape give their tiles back before new ones are placed.
+    m_LightViews.assign(lightCount, -1);
+    for (uint32_t index = 0; index < lightCount; ++index)
+    {
+        const ShadowLightRequest &request = lights[index];
+        LightState &state = m_Lights[request.id];
+        assert(state.lastFrame != m_Frame && "Shadow light ids must be unique.");
+
+        uint32_t faceCount = IsPointLight(request.light) ? 6 : 1;
+        if (state.faceCount != 0 && (state.resolution != request.resolution || state.faceCount != faceCount))
+        {
+            FreeLight(state);
+        }
+        state.lastFrame = m_Frame;
+    }
+
+    for (auto iterator = m_Lights.begin(); iterator != m_Lights.end();)
+    {
+        if (iterator->second.lastFrame != m_Frame)
+        {
+            FreeLight(iterator->second);
+            iterator = m_Lights.erase(iterator);
+        }
+        else
+        {
+            ++iterator;
+        }
+    }
+
+    // Largest tiles first, they are the hardest to place.
+    m_LightOrder.resize(lightCount);
+    for (uint32_t index = 0; index < lightCount; ++index)
+    {
+        m_LightOrder[index] = index;
+    }
+    std::stable_sort(m_LightOrder.begin(), m_LightOrder.end(), [lights](uint32_t left, uint32_t right)
+    {
+        return lights[left].resolution > lights[right].resolution;
+    });
+
+    for (uint32_t index : m_LightOrder)
+    {
+        const ShadowLightRequest &request = lights[index];
+        LightState &state = m_Lights[request.id];
+        if (state.faceCount == 0 && !AllocateLight(state, request.resolution, IsPointLight(request.light) ? 6 : 1))
+        {
+            ++m_Stats.droppedLightCount;
+        }
+    }
+
+    for (uint32_t index = 0; index < lightCount; ++index)
+    {
+        const GpuLight &light = lights[index].light;
+        LightState &state = m_Lights[lights[index].id];
+        if (state.faceCount == 0)
+        {
+            continue;
+        }
+
+        m_LightViews[index] = static_cast<int32_t>(m_Views.size());
+
+        float nearPlane = std::max(light.range * 0.005f, 0.01f);
+        if (state.faceCount == 1)
+        {
+            glm::vec3 direction = glm::normalize(light.direction);
+            glm::mat4 view = glm::lookAt(light.position, light.position + direction, GetUpVector(direction));
+
+            float fov = std::min(2.0f * std::acos(std::clamp(light.spotCosAngle, -1.0f, 1.0f)) + SpotFovMargin, MaxSpotFov);
+            glm::mat4 projection = glm::perspectiveRH_ZO(fov, 1.0f, nearPlane, light.range);
+
+            AddView(state.faces[0], projection * view, index, 0, dynamicCasters, dynamicCasterCount);
+        }
+        else
+        {
+            glm::mat4 projection = glm::perspectiveRH_ZO(HalfPi, 1.0f, nearPlane, light.range);
+            for (uint32_t face = 0; face < 6; ++face)
+            {
+                glm::mat4 view = glm::lookAt(light.position, light.position + g_CubeFaces[face].direction, g_CubeFaces[face].up);
+                AddView(state.faces[face], projection * view, index, face, dynamicCasters, dynamicCasterCount);
+            }
+        }
+    }
+
+    m_Invalidations.clear();
+    m_InvalidateAll = false;
+}
+
+void ShadowCache::AddView(TileState &state, const glm::mat4 &viewProjection, uint32_t lightIndex, uint32_t face, const BoundingBox *dynamicCasters, uint32_t dynamicCasterCount)
+{
+    ShadowView view{};
+    view.viewProjection = viewProjection;
+    view.frustum = Frustum::FromMatrix(viewProjection);
+    view.tile = state.tile;
+    view.lightIndex = lightIndex;
+    view.face = face;
+
+    uint64_t tileKey = (static_cast<uint64_t>(state.tile.x) << 40) | (static_cast<uint64_t>(state.tile.y) << 20) | state.tile.size;
+    uint64_t key = Hash::Combine(Hash::Bytes(&viewProjection, sizeof(viewProjection)), tileKey);
+
+    view.renderStatic = !state.cached || state.key != key;
+    for (size_t index = 0; index < m_Invalidations.size() && !view.renderStatic; ++index)
+    {
+        view.renderStatic = view.frustum.IntersectsBox(m_Invalidations[index]);
+    }
+
+    for (uint32_t index = 0; index < dynamicCasterCount && !view.hasDynamicCasters; ++index)
+    {
+        view.hasDynamicCasters = view.frustum.IntersectsBox(dynamicCasters[index]);
+    }
+
+    // Last frame's dynamic casters have to be wiped by a fresh copy of the static depth.
+    view.refresh = view.renderStatic || view.hasDynamicCasters || state.hadDynamicCasters;
+
+    state.key = key;
+    state.cached = true;
+    state.hadDynamicCasters = view.hasDynamicCasters;
+
+    float atlasSize = static_cast<float>(m_Atlas.GetAtlasSize());
+    GpuShadowView gpuView{};
+    gpuView.viewProjection = viewProjection;
+    gpuView.atlasScaleOffset = glm::vec4{ static_cast<float>(state.tile.size) / atlasSize, static_cast<float>(state.tile.size) / atlasSize,
+        static_cast<float>(state.tile.x) / atlasSize, static_cast<float>(state.tile.y) / atlasSize };
+
+    m_Views.push_back(view);
+    m_GpuViews.push_back(gpuView);
+
+    ++m_Stats.viewCount;
+    m_Stats.staticRenderCount += view.renderStatic ? 1 : 0;
+    m_Stats.refreshCount += view.refresh ? 1 : 0;
+}
+
+bool ShadowCache::AllocateLight(LightState &state, uint32_t resolution, uint32_t faceCount)
+{
+    assert(faceCount <= MaxLightFaces);
+
+    for (uint32_t size = std::max(resolution, m_Atlas.GetMinTileSize()); size >= m_Atlas.GetMinTileSize(); size /= 2)
+    {
+        uint32_t allocated = 0;
+        while (allocated < faceCount)
+        {
+            ShadowAtlasTile tile = m_Atlas.Allocate(size);
+            if (!tile.IsValid())
+            {
+                break;
+            }
+            state.faces[allocated++] = TileState{ tile };
+        }
+
+        if (allocated == faceCount)
+        {
+            state.resolution = resolution;
+            state.faceCount = faceCount;
+            return true;
+        }
+
+        for (uint32_t face = 0; face < allocated; ++face)
+        {
+            m_Atlas.Free(state.faces[face].tile);
+            state.faces[face] = TileState{};
+        }
+    }
+
+    return false;
+}
+
+void ShadowCache::FreeLight(LightState &state)
+{
+    for (uint32_t face = 0; face < state.faceCount; ++face)
+    {
+        m_Atlas.Free(state.faces[face].tile);
+        state.faces[face] = TileState{};
+    }
+    state.faceCount = 0;
+}
+
+const std::vector<ShadowView> &ShadowCache::GetViews() const
+{
+    return m_Views;
+}
+
+const std::vector<GpuShadowView> &ShadowCache::GetGpuViews() const
+{
+    return m_GpuViews;
+}
+
+const std::vector<int32_t> &ShadowCache::GetLightViews() const
+{
+    return m_LightViews;
+}
+
+const float *ShadowCache::GetCascadeSplits() const
+{
+    return m_CascadeSplits;
+}
+
+uint32_t ShadowCache::GetCascadeCount() const
+{
+    return m_CascadeCount;
+}
+
+const ShadowSettings &ShadowCache::GetSettings() const
+{
+    return m_Settings;
+}
+
+const ShadowCacheStats &ShadowCache::GetStats() const
+{
+    return m_Stats;
+}
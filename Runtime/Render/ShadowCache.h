@@ -0,0 +1,207 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "GpuScene.h"
+#include "LightClusters.h"
+#include "Mesh.h"
+#include "ShadowAtlas.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+static constexpr uint32_t MaxShadowCascades = 4;
+
+struct ShadowSettings
+{
+    // Cascades and local light tiles share one atlas.
+    uint32_t atlasSize{ 8192 };
+
+    uint32_t minTileSize{ 128 };
+
+    uint32_t cascadeCount{ 4 };
+
+    uint32_t cascadeResolution{ 2048 };
+
+    // Blend between uniform (0) and logarithmic (1) cascade splits.
+    float splitLambda{ 0.75f };
+
+    // View depth the last cascade ends at.
+    float shadowDistance{ 200.0f };
+
+    // Casters this far past a cascade towards the light still cast into it.
+    float casterDistance{ 500.0f };
+
+    // Cascades move in steps of this many texels instead of following the camera, so their static
+    // depth stays valid until the camera has moved a whole step.
+    uint32_t cascadeSnapTexels{ 64 };
+};
+
+// A local light that wants a shadow this frame. Spot lights take one tile, point lights six.
+struct ShadowLightRequest
+{
+    // Stable across frames, the cached tiles of a light are found by it.
+    uint32_t id{ 0 };
+
+    GpuLight light{};
+
+    // Tile size in texels, halved down to the minimum tile size when the atlas is full.
+    uint32_t resolution{ 512 };
+};
+
+// One depth render into the atlas.
+struct ShadowView
+{
+    glm::mat4 viewProjection{ 1.0f };
+
+    Frustum frustum{};
+
+    ShadowAtlasTile tile{};
+
+    // Index of the ShadowLightRequest, ~0u for cascades.
+    uint32_t lightIndex{ ~0u };
+
+    // Cascade index, or cube face of a point light.
+    uint32_t face{ 0 };
+
+    // The cached static depth is stale: the tile is cleared and the static casters redrawn.
+    bool renderStatic{ false };
+
+    // The tile changes this frame: the static depth is copied into the shadow map and the dynamic
+    // casters drawn on top. Tiles without it keep last frame's contents.
+    bool refresh{ false };
+
+    bool hasDynamicCasters{ false };
+
+    // Culling parameters for the scene's visibility path. LODs are picked for the camera, not the
+    // light, so casters match what the camera sees.
+    GpuCullParams GetCullParams(const GpuCullParams &cameraParams) const;
+};
+
+// std430 layout of a view for the shading shaders: uv = (clip.xy / clip.w * 0.5 + 0.5) * scale + offset.
+struct GpuShadowView
+{
+    glm::mat4 viewProjection;
+
+    // xy is the scale, zw the offset.
+    glm::vec4 atlasScaleOffset;
+};
+
+static_assert(sizeof(GpuShadowView) == 80, "GpuShadowView must match the std430 layout of the shadow view buffer");
+
+struct ShadowCacheStats
+{
+    uint32_t viewCount{ 0 };
+
+    // Views whose static casters are redrawn this frame.
+    uint32_t staticRenderCount{ 0 };
+
+    uint32_t refreshCount{ 0 };
+
+    // Lights without a shadow because the atlas was full.
+    uint32_t droppedLightCount{ 0 };
+};
+
+// Plans the shadow renders of a frame: the cascades of the directional light and the atlas tiles of
+// local lights. Static caster depth is kept in a second atlas between frames and only redrawn for
+// tiles whose projection changed or that a static caster change (InvalidateStatic()) touched. Every
+// other tile just gets the dynamic casters drawn over a copy of its static depth, and tiles without
+// dynamic casters now or last frame are left alone.
+class ShadowCache : public NonCopyable
+{
+public:
+
+    explicit ShadowCache(const ShadowSettings &settings = {});
+
+    // A static caster moved, appeared or went away. Pass its world bounds before and after a move.
+    void InvalidateStatic(const BoundingBox &bounds);
+
+    void InvalidateAll();
+
+    // cameraFar only clamps ShadowSettings::shadowDistance. lightDirection is the direction the
+    // directional light shines in, zero when there is none. Shadow projections map depth to [0, 1].
+    void Update(const glm::mat4 &cameraView, const glm::mat4 &cameraProjection, float cameraNear, float cameraFar, const glm::vec3 &lightDirection,
+        const ShadowLightRequest *lights, uint32_t lightCount, const BoundingBox *dynamicCasters, uint32_t dynamicCasterCount);
+
+    // Cascades first, then the faces of every light in request order.
+    const std::vector<ShadowView> &GetViews() const;
+
+    // GetViews() for the shading shaders.
+    const std::vector<GpuShadowView> &GetGpuViews() const;
+
+    // First view of every light request of the last Update(), -1 for lights without a shadow.
+    const std::vector<int32_t> &GetLightViews() const;
+
+    // View depth where every cascade ends.
+    const float *GetCascadeSplits() const;
+
+    uint32_t GetCascadeCount() const;
+
+    const ShadowSettings &GetSettings() const;
+
+    const ShadowCacheStats &GetStats() const;
+
+    // Practical split scheme, splits[i] is the far depth of cascade i.
+    static void ComputeCascadeSplits(uint32_t cascadeCount, float nearPlane, float farPlane, float lambda, float *splits);
+
+private:
+
+    static constexpr uint32_t MaxLightFaces = 6;
+
+    struct TileState
+    {
+        ShadowAtlasTile tile{};
+
+        // Hash of the projection and tile the cached static depth was rendered with.
+        uint64_t key{ 0 };
+
+        bool cached{ false };
+
+        bool hadDynamicCasters{ false };
+    };
+
+    struct LightState
+    {
+        uint32_t resolution{ 0 };
+
+        uint32_t faceCount{ 0 };
+
+        TileState faces[MaxLightFaces]{};
+
+        uint64_t lastFrame{ 0 };
+    };
+
+    void AddView(TileState &state, const glm::mat4 &viewProjection, uint32_t lightIndex, uint32_t face, const BoundingBox *dynamicCasters, uint32_t dynamicCasterCount);
+
+    bool AllocateLight(LightState &state, uint32_t resolution, uint32_t faceCount);
+
+    void FreeLight(LightState &state);
+
+    ShadowSettings m_Settings{};
+
+    ShadowAtlas m_Atlas;
+
+    uint32_t m_CascadeCount{ 0 };
+
+    TileState m_Cascades[MaxShadowCascades]{};
+
+    float m_CascadeSplits[MaxShadowCascades]{};
+
+    std::unordered_map<uint32_t, LightState> m_Lights;
+
+    std::vector<BoundingBox> m_Invalidations;
+
+    bool m_InvalidateAll{ true };
+
+    uint64_t m_Frame{ 0 };
+
+    std::vector<uint32_t> m_LightOrder;
+
+    std::vector<ShadowView> m_Views;
+
+    std::vector<GpuShadowView> m_GpuViews;
+
+    std::vector<int32_t> m_LightViews;
+
+    ShadowCacheStats m_Stats{};
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+// Triangles using each vertex, stored as one flat array with per-vertex offsets.
+struct TriangleAdjacency
+{
+    std::vector<uint32_t> counts;
+
+    std::vector<uint32_t> offsets;
+
+    std::vector<uint32_t> triangles;
+
+    void Build(const uint32_t *indices, uint32_t indexCount, uint32_t vertexCount)
+    {
+        counts.assign(vertexCount, 0);
+        offsets.assign(vertexCount, 0);
+        triangles.resize(indexCount);
+
+        for (uint32_t index = 0; index < indexCount; ++index)
+        {
+            assert(indices[index] < vertexCount);
+            ++counts[indices[index]];
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            offsets[vertex] = offset;
+            offset += counts[vertex];
+        }
+
+        // offsets is advanced while filling and rewound afterwards.
+        for (uint32_t index = 0; index < indexCount; ++index)
+        {
+            triangles[offsets[indices[index]]++] = index / 3;
+        }
+
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            offsets[vertex] -= counts[vertex];
+        }
+    }
+
+    const uint32_t *GetTriangles(uint32_t vertex) const
+    {
+        return triangles.data() + offsets[vertex];
+    }
+};
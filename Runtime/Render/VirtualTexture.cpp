@@ -0,0 +1,519 @@
+#include "VirtualTexture.h"
+#include "Common/Logging.h"
+#include <algorithm>
+#include <cassert>
+
+static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+VirtualTexture::VirtualTexture(const VirtualTextureDesc &desc, AssetStreamer *streamer) :
+    m_Desc{ desc },
+    m_Streamer{ streamer },
+    m_CompletedPages{ std::make_shared<CompletedPages>() }
+{
+    assert(desc.width > 0 && desc.height > 0 && desc.pageSize > 0);
+    assert(desc.physicalPagesX > 0 && desc.physicalPagesX <= 4096 && desc.physicalPagesY > 0 && desc.physicalPagesY <= 4096);
+
+    // Mips down to the first one that fits in a single page.
+    for (uint32_t mip = 0; ; ++mip)
+    {
+        assert(mip < MaxVirtualTextureMips && "Virtual texture has too many mips for its page size.");
+
+        uint32_t width = std::max(desc.width >> mip, 1u);
+        uint32_t height = std::max(desc.height >> mip, 1u);
+        m_PagesX[mip] = (width + desc.pageSize - 1) / desc.pageSize;
+        m_PagesY[mip] = (height + desc.pageSize - 1) / desc.pageSize;
+        m_PageTableOffsets[mip + 1] = m_PageTableOffsets[mip] + m_PagesX[mip] * m_PagesY[mip];
+
+        if (m_PagesX[mip] == 1 && m_PagesY[mip] == 1)
+        {
+            m_MipCount = mip + 1;
+            break;
+        }
+    }
+    assert(m_PagesX[0] <= 0x4000 && m_PagesY[0] <= 0x4000 && "Virtual texture has more pages than a page id can address.");
+
+    // Until anything else is resident every entry shows the root page in slot 0.
+    m_PageTable.assign(m_PageTableOffsets[m_MipCount], VirtualPageEntry::Pack(0, 0, m_MipCount - 1));
+    MarkDirty(0, static_cast<uint32_t>(m_PageTable.size()));
+
+    m_Slots.resize(desc.physicalPagesX * desc.physicalPagesY);
+    m_LruFront = InvalidSlot;
+    m_LruBack = InvalidSlot;
+    for (uint32_t slot = 1; slot < GetSlotCount(); ++slot)
+    {
+        LinkBack(slot);
+    }
+
+    if (m_Streamer != nullptr)
+    {
+        m_Requests.assign(1, VirtualPage::Pack(m_MipCount - 1, 0, 0));
+        RequestPages();
+    }
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    if (m_Streamer != nullptr)
+    {
+        for (const auto &[page, request] : m_PendingPages)
+        {
+            m_Streamer->Cancel(request);
+        }
+    }
+}
+
+void VirtualTexture::Update(uint64_t frame, const uint32_t *feedback, uint32_t feedbackCount)
+{
+    assert(m_Streamer != nullptr && "Update() streams pages, use ResolveFeedback() and MapPage() without a streamer.");
+
+    BeginFrame(frame);
+
+    // Resolving first touches what the view uses, so the pages mapped next evict something else.
+    ResolveFeedback(feedback, feedbackCount, m_Requests);
+    MapCompletedPages();
+    RequestPages();
+
+    m_Stats.residentPages = static_cast<uint32_t>(m_ResidentPages.size());
+    m_Stats.pendingPages = static_cast<uint32_t>(m_PendingPages.size());
+}
+
+void VirtualTexture::BeginFrame(uint64_t frame)
+{
+    assert(frame >= m_Frame);
+
+    m_Frame = frame;
+    m_Stats.mappedPages = 0;
+    m_Stats.evictedPages = 0;
+    m_Stats.rejectedPages = 0;
+}
+
+void VirtualTexture::ResolveFeedback(const uint32_t *feedback, uint32_t feedbackCount, std::vector<uint32_t> &requests)
+{
+    requests.clear();
+
+    // Sorting groups the requests for a page, the run length is how much of the screen wants it.
+    m_SortedFeedback.clear();
+    for (uint32_t index = 0; index < feedbackCount; ++index)
+    {
+        if (feedback[index] != InvalidVirtualPage && IsValidPage(feedback[index]))
+        {
+            m_SortedFeedback.push_back(feedback[index]);
+        }
+    }
+    std::sort(m_SortedFeedback.begin(), m_SortedFeedback.end());
+
+    m_Candidates.clear();
+    for (size_t begin = 0; begin < m_SortedFeedback.size(); )
+    {
+        size_t end = begin + 1;
+        while (end < m_SortedFeedback.size() && m_SortedFeedback[end] == m_SortedFeedback[begin])
+        {
+            ++end;
+        }
+        uint32_t hits = static_cast<uint32_t>(end - begin);
+
+        // Walk up to the first resident ancestor, which is what the page falls back to meanwhile.
+        uint32_t page = m_SortedFeedback[begin];
+        for (;;)
+        {
+            auto resident = m_ResidentPages.find(page);
+            if (resident != m_ResidentPages.end())
+            {
+                Touch(resident->second);
+                break;
+            }
+
+            if (m_PendingPages.find(page) == m_PendingPages.end())
+            {
+                m_Candidates.emplace_back(page, hits);
+            }
+
+            if (VirtualPage::GetMip(page) + 1 >= m_MipCount)
+            {
+                break;
+            }
+            page = VirtualPage::GetParent(page);
+        }
+
+        begin = end;
+    }
+
+    // Ancestors are shared, merge their hits.
+    std::sort(m_Candidates.begin(), m_Candidates.end());
+    size_t mergedCount = 0;
+    for (size_t index = 0; index < m_Candidates.size(); ++index)
+    {
+        if (mergedCount > 0 && m_Candidates[mergedCount - 1].first == m_Candidates[index].first)
+        {
+            m_Candidates[mergedCount - 1].second += m_Candidates[index].second;
+        }
+        else
+        {
+            m_Candidates[mergedCount++] = m_Candidates[index];
+        }
+    }
+    m_Candidates.resize(mergedCount);
+
+    // Coarse pages first, they fix the most blur per byte and the finer ones fall back to them.
+    std::sort(m_Candidates.begin(), m_Candidates.end(), [](const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b)
+    {
+        uint32_t mipA = VirtualPage::GetMip(a.first);
+        uint32_t mipB = VirtualPage::GetMip(b.first);
+        if (mipA != mipB)
+        {
+            return mipA > mipB;
+        }
+        if (a.second != b.second)
+        {
+            return a.second > b.second;
+        }
+        return a.first < b.first;
+    });
+
+    uint32_t pendingCount = static_cast<uint32_t>(m_PendingPages.size());
+    uint32_t budget = pendingCount < m_Desc.maxPendingRequests ? m_Desc.maxPendingRequests - pendingCount : 0;
+    budget = std::min(budget, m_Desc.maxRequestsPerFrame);
+
+    for (size_t index = 0; index < m_Candidates.size() && requests.size() < budget; ++index)
+    {
+        requests.push_back(m_Candidates[index].first);
+    }
+
+    m_Stats.requestedPages = static_cast<uint32_t>(requests.size());
+}
+
+bool VirtualTexture::MapPage(uint32_t page, std::vector<uint8_t> &&data)
+{
+    assert(IsValidPage(page));
+
+    if (data.size() != GetPageBytes())
+    {
+        LOGE("Virtual texture page {} has {} bytes, expected {}", page, data.size(), GetPageBytes());
+        return false;
+    }
+
+    if (m_ResidentPages.find(page) != m_ResidentPages.end())
+    {
+        return false;
+    }
+
+    uint32_t slot = 0;
+    if (VirtualPage::GetMip(page) + 1 < m_MipCount)
+    {
+        slot = m_LruFront;
+        if (slot == InvalidSlot || (m_Slots[slot].page != InvalidVirtualPage && m_Slots[slot].lastUsedFrame >= m_Frame))
+        {
+            ++m_Stats.rejectedPages;
+            return false;
+        }
+
+        uint32_t evictedPage = m_Slots[slot].page;
+        if (evictedPage != InvalidVirtualPage)
+        {
+            UpdatePageTable(evictedPage, slot, false);
+            m_ResidentPages.erase(evictedPage);
+            ++m_Stats.evictedPages;
+        }
+    }
+
+    m_Slots[slot].page = page;
+    m_ResidentPages[page] = slot;
+    Touch(slot);
+    UpdatePageTable(page, slot, true);
+
+    VirtualPageUpload upload;
+    upload.page = page;
+    upload.slotX = slot % m_Desc.physicalPagesX;
+    upload.slotY = slot / m_Desc.physicalPagesX;
+    upload.data = std::move(data);
+    m_Uploads.push_back(std::move(upload));
+
+    ++m_Stats.mappedPages;
+    m_Stats.residentPages = static_cast<uint32_t>(m_ResidentPages.size());
+    return true;
+}
+
+uint32_t VirtualTexture::GetPage(const glm::vec2 &uv, uint32_t mip) const
+{
+    mip = std::min(mip, m_MipCount - 1);
+
+    uint32_t width = std::max(m_Desc.width >> mip, 1u);
+    uint32_t height = std::max(m_Desc.height >> mip, 1u);
+    uint32_t x = std::min(static_cast<uint32_t>(std::clamp(uv.x, 0.0f, 1.0f) * static_cast<float>(width)) / m_Desc.pageSize, m_PagesX[mip] - 1);
+    uint32_t y = std::min(static_cast<uint32_t>(std::clamp(uv.y, 0.0f, 1.0f) * static_cast<float>(height)) / m_Desc.pageSize, m_PagesY[mip] - 1);
+    return VirtualPage::Pack(mip, x, y);
+}
+
+bool VirtualTexture::IsResident(uint32_t page) const
+{
+    return m_ResidentPages.find(page) != m_ResidentPages.end();
+}
+
+bool VirtualTexture::IsValidPage(uint32_t page) const
+{
+    uint32_t mip = VirtualPage::GetMip(page);
+    return mip < m_MipCount && VirtualPage::GetX(page) < m_PagesX[mip] && VirtualPage::GetY(page) < m_PagesY[mip];
+}
+
+const VirtualTextureDesc &VirtualTexture::GetDesc() const
+{
+    return m_Desc;
+}
+
+uint32_t VirtualTexture::GetMipCount() const
+{
+    return m_MipCount;
+}
+
+uint32_t VirtualTexture::GetPagesX(uint32_t mip) const
+{
+    assert(mip < m_MipCount);
+    return m_PagesX[mip];
+}
+
+uint32_t VirtualTexture::GetPagesY(uint32_t mip) const
+{
+    assert(mip < m_MipCount);
+    return m_PagesY[mip];
+}
+
+uint32_t VirtualTexture::GetPaddedPageSize() const
+{
+    return m_Desc.pageSize + 2 * m_Desc.pageBorder;
+}
+
+uint32_t VirtualTexture::GetPageBytes() const
+{
+    return GetPaddedPageSize() * GetPaddedPageSize() * m_Desc.bytesPerTexel;
+}
+
+uint64_t VirtualTexture::GetPageFileOffset(uint32_t page) const
+{
+    assert(IsValidPage(page));
+    uint32_t mip = VirtualPage::GetMip(page);
+    uint64_t index = m_PageTableOffsets[mip] + VirtualPage::GetY(page) * m_PagesX[mip] + VirtualPage::GetX(page);
+    return index * GetPageBytes();
+}
+
+uint32_t VirtualTexture::GetSlotCount() const
+{
+    return static_cast<uint32_t>(m_Slots.size());
+}
+
+uint32_t VirtualTexture::GetSlotPage(uint32_t slot) const
+{
+    assert(slot < m_Slots.size());
+    return m_Slots[slot].page;
+}
+
+const std::vector<uint32_t> &VirtualTexture::GetPageTable() const
+{
+    return m_PageTable;
+}
+
+uint32_t VirtualTexture::GetPageTableOffset(uint32_t mip) const
+{
+    assert(mip < m_MipCount);
+    return m_PageTableOffsets[mip];
+}
+
+uint32_t VirtualTexture::GetPageTableEntry(uint32_t page) const
+{
+    assert(IsValidPage(page));
+    uint32_t mip = VirtualPage::GetMip(page);
+    return m_PageTable[m_PageTableOffsets[mip] + VirtualPage::GetY(page) * m_PagesX[mip] + VirtualPage::GetX(page)];
+}
+
+uint32_t VirtualTexture::GetDirtyBegin() const
+{
+    return m_DirtyBegin;
+}
+
+uint32_t VirtualTexture::GetDirtyEnd() const
+{
+    return m_DirtyEnd;
+}
+
+void VirtualTexture::ClearDirtyRange()
+{
+    m_DirtyBegin = 0;
+    m_DirtyEnd = 0;
+}
+
+std::vector<VirtualPageUpload> &VirtualTexture::GetUploads()
+{
+    return m_Uploads;
+}
+
+void VirtualTexture::ClearUploads()
+{
+    m_Uploads.clear();
+}
+
+const VirtualTextureStats &VirtualTexture::GetStats() const
+{
+    return m_Stats;
+}
+
+void VirtualTexture::RequestPages()
+{
+    std::weak_ptr<CompletedPages> weakCompleted = m_CompletedPages;
+
+    for (uint32_t page : m_Requests)
+    {
+        uint32_t mip = VirtualPage::GetMip(page);
+
+        StreamRequestDesc desc{};
+        desc.path = m_Desc.path;
+        desc.offset = GetPageFileOffset(page);
+        desc.size = GetPageBytes();
+        desc.priority = mip + 1 == m_MipCount ? StreamPriority::Critical : StreamPriority::High;
+        // Coarser pages are read first, like they are requested.
+        desc.distance = static_cast<float>(m_MipCount - 1 - mip);
+        desc.onComplete = [weakCompleted, page](StreamedAsset &asset)
+        {
+            if (auto completed = weakCompleted.lock())
+            {
+                VirtualPageUpload loaded;
+                loaded.page = page;
+                if (asset.succeeded)
+                {
+                    loaded.data = std::move(asset.data);
+                }
+                completed->pages.push_back(std::move(loaded));
+            }
+        };
+
+        m_PendingPages.emplace(page, m_Streamer->Request(std::move(desc)));
+    }
+}
+
+void VirtualTexture::MapCompletedPages()
+{
+    std::vector<VirtualPageUpload> &completed = m_CompletedPages->pages;
+
+    // The rest waits for the next frame, uploads are bounded by the staging memory.
+    size_t mapCount = 0;
+    while (mapCount < completed.size() && m_Uploads.size() < m_Desc.maxUploadsPerFrame)
+    {
+        VirtualPageUpload &loaded = completed[mapCount++];
+        m_PendingPages.erase(loaded.page);
+
+        // A failed read is requested again if the feedback still asks for the page.
+        if (!loaded.data.empty())
+        {
+            MapPage(loaded.page, std::move(loaded.data));
+        }
+    }
+    completed.erase(completed.begin(), completed.begin() + mapCount);
+}
+
+void VirtualTexture::Touch(uint32_t slot)
+{
+    m_Slots[slot].lastUsedFrame = m_Frame;
+
+    if (slot != 0)
+    {
+        Unlink(slot);
+        LinkBack(slot);
+    }
+}
+
+void VirtualTexture::Unlink(uint32_t slot)
+{
+    Slot &entry = m_Slots[slot];
+
+    if (entry.previous != InvalidSlot)
+    {
+        m_Slots[entry.previous].next = entry.next;
+    }
+    else
+    {
+        m_LruFront = entry.next;
+    }
+
+    if (entry.next != InvalidSlot)
+    {
+        m_Slots[entry.next].previous = entry.previous;
+    }
+    else
+    {
+        m_LruBack = entry.previous;
+    }
+}
+
+void VirtualTexture::LinkBack(uint32_t slot)
+{
+    Slot &entry = m_Slots[slot];
+    entry.previous = m_LruBack;
+    entry.next = InvalidSlot;
+
+    if (m_LruBack != InvalidSlot)
+    {
+        m_Slots[m_LruBack].next = slot;
+    }
+    else
+    {
+        m_LruFront = slot;
+    }
+    m_LruBack = slot;
+}
+
+void VirtualTexture::UpdatePageTable(uint32_t page, uint32_t slot, bool map)
+{
+    uint32_t mip = VirtualPage::GetMip(page);
+    uint32_t x = VirtualPage::GetX(page);
+    uint32_t y = VirtualPage::GetY(page);
+
+    uint32_t value = 0;
+    if (map)
+    {
+        value = VirtualPageEntry::Pack(slot % m_Desc.physicalPagesX, slot / m_Desc.physicalPagesX, mip);
+    }
+    else
+    {
+        assert(mip + 1 < m_MipCount && "The root page is never unmapped.");
+        value = GetPageTableEntry(VirtualPage::GetParent(page));
+    }
+
+    // Entries showing a finer resident page keep it, the rest of the footprint at every finer mip
+    // switches to the new mapping.
+    for (uint32_t level = mip + 1; level-- > 0; )
+    {
+        uint32_t shift = mip - level;
+        uint32_t beginX = x << shift;
+        uint32_t beginY = y << shift;
+        uint32_t endX = std::min((x + 1) << shift, m_PagesX[level]);
+        uint32_t endY = std::min((y + 1) << shift, m_PagesY[level]);
+        uint32_t offset = m_PageTableOffsets[level];
+
+        for (uint32_t row = beginY; row < endY; ++row)
+        {
+            uint32_t *entries = &m_PageTable[offset + row * m_PagesX[level]];
+            for (uint32_t column = beginX; column < endX; ++column)
+            {
+                uint32_t entryMip = VirtualPageEntry::GetMip(entries[column]);
+                if (map ? entryMip > mip : entryMip == mip)
+                {
+                    entries[column] = value;
+                }
+            }
+        }
+
+        MarkDirty(offset + beginY * m_PagesX[level] + beginX, offset + (endY - 1) * m_PagesX[level] + endX);
+    }
+}
+
+void VirtualTexture::MarkDirty(uint32_t begin, uint32_t end)
+{
+    if (m_DirtyBegin == m_DirtyEnd)
+    {
+        m_DirtyBegin = begin;
+        m_DirtyEnd = end;
+    }
+    else
+    {
+        m_DirtyBegin = std::min(m_DirtyBegin, begin);
+        m_DirtyEnd = std::max(m_DirtyEnd, end);
+    }
+}
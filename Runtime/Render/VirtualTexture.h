@@ -0,0 +1,295 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Streaming/AssetStreamer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+static constexpr uint32_t MaxVirtualTextureMips = 16;
+
+// Feedback entries no fragment wrote to.
+static constexpr uint32_t InvalidVirtualPage = 0xffffffffu;
+
+// A page is addressed by mip and page coordinates packed into 32 bits, the format the feedback
+// shader writes: mip in bits 28-31, y in 14-27 and x in 0-13.
+namespace VirtualPage
+{
+    inline uint32_t Pack(uint32_t mip, uint32_t x, uint32_t y)
+    {
+        return (mip << 28) | (y << 14) | x;
+    }
+
+    inline uint32_t GetMip(uint32_t page)
+    {
+        return page >> 28;
+    }
+
+    inline uint32_t GetX(uint32_t page)
+    {
+        return page & 0x3fffu;
+    }
+
+    inline uint32_t GetY(uint32_t page)
+    {
+        return (page >> 14) & 0x3fffu;
+    }
+
+    inline uint32_t GetParent(uint32_t page)
+    {
+        return Pack(GetMip(page) + 1, GetX(page) >> 1, GetY(page) >> 1);
+    }
+}
+
+// Page table entries name the physical slot a virtual page samples from and the mip of the page
+// actually stored there, coarser than the entry's own while the page is not resident: slot x in bits
+// 0-11, slot y in 12-23 and the mip in 24-27.
+namespace VirtualPageEntry
+{
+    inline uint32_t Pack(uint32_t slotX, uint32_t slotY, uint32_t mip)
+    {
+        return slotX | (slotY << 12) | (mip << 24);
+    }
+
+    inline uint32_t GetSlotX(uint32_t entry)
+    {
+        return entry & 0xfffu;
+    }
+
+    inline uint32_t GetSlotY(uint32_t entry)
+    {
+        return (entry >> 12) & 0xfffu;
+    }
+
+    inline uint32_t GetMip(uint32_t entry)
+    {
+        return entry >> 24;
+    }
+}
+
+struct VirtualTextureDesc
+{
+    // Page file: every page of every mip, mip 0 first and rows top to bottom, each page
+    // (pageSize + 2 * pageBorder)^2 texels of bytesPerTexel bytes with no header.
+    std::string path;
+
+    // Texels of mip 0.
+    uint32_t width{ 0 };
+
+    uint32_t height{ 0 };
+
+    // Texels of a page without its border.
+    uint32_t pageSize{ 128 };
+
+    // Texels repeated from the neighbouring pages on every side, so filtering never samples a
+    // different slot.
+    uint32_t pageBorder{ 4 };
+
+    uint32_t bytesPerTexel{ 4 };
+
+    // Slots of the physical page cache, the only memory that grows with what is visible.
+    uint32_t physicalPagesX{ 32 };
+
+    uint32_t physicalPagesY{ 32 };
+
+    // Reads started per frame and at most in flight.
+    uint32_t maxRequestsPerFrame{ 32 };
+
+    uint32_t maxPendingRequests{ 128 };
+
+    // Pages mapped per frame, the upload staging memory is sized for this many.
+    uint32_t maxUploadsPerFrame{ 32 };
+};
+
+// A page that was mapped this frame and needs its texels copied into the physical texture.
+struct VirtualPageUpload
+{
+    uint32_t page{ InvalidVirtualPage };
+
+    uint32_t slotX{ 0 };
+
+    uint32_t slotY{ 0 };
+
+    std::vector<uint8_t> data;
+};
+
+struct VirtualTextureStats
+{
+    uint32_t residentPages{ 0 };
+
+    uint32_t pendingPages{ 0 };
+
+    uint32_t requestedPages{ 0 };
+
+    uint32_t mappedPages{ 0 };
+
+    uint32_t evictedPages{ 0 };
+
+    // Loaded pages dropped because every slot was used this frame, the cache is too small for the view.
+    uint32_t rejectedPages{ 0 };
+};
+
+// CPU side of a virtual texture: page table, LRU cache of physical slots and the page request
+// resolution for the GPU feedback. The coarsest mip fits in one page that is pinned to slot (0, 0),
+// so every page table entry always points at something. Memory use is set by the slot count whatever
+// the size of the virtual texture.
+//
+// Per frame: AssetStreamer::PumpUploads() delivers finished reads, Update() maps them and requests what
+// the feedback asks for, the GPU side then copies GetUploads() and the dirty page table range. Update()
+// and PumpUploads() must run on the same thread.
+class VirtualTexture : public NonCopyable
+{
+public:
+
+    VirtualTexture(const VirtualTextureDesc &desc, AssetStreamer *streamer);
+
+    // Cancels the reads still in flight.
+    ~VirtualTexture();
+
+    // BeginFrame(), ResolveFeedback(), maps the pages that finished loading and requests the missing ones.
+    void Update(uint64_t frame, const uint32_t *feedback, uint32_t feedbackCount);
+
+    // frame must not go backwards; slots used in the current frame are never evicted. Only needed
+    // directly when driving ResolveFeedback() and MapPage() without a streamer.
+    void BeginFrame(uint64_t frame);
+
+    // Page request resolution, also the reference for tests: touches resident pages, and returns the
+    // missing pages and their missing ancestors that are not loading yet, coarsest first and then by
+    // how many feedback entries asked for them, cut to the per frame and in flight budgets.
+    void ResolveFeedback(const uint32_t *feedback, uint32_t feedbackCount, std::vector<uint32_t> &requests);
+
+    // Puts a loaded page into the least recently used slot. Returns false, dropping the page, when the
+    // data has the wrong size or every slot was used this frame.
+    bool MapPage(uint32_t page, std::vector<uint8_t> &&data);
+
+    // CPU mirror of the feedback shader: the page uv falls into at mip, uv clamped to [0, 1].
+    uint32_t GetPage(const glm::vec2 &uv, uint32_t mip) const;
+
+    bool IsResident(uint32_t page) const;
+
+    bool IsValidPage(uint32_t page) const;
+
+    const VirtualTextureDesc &GetDesc() const;
+
+    uint32_t GetMipCount() const;
+
+    uint32_t GetPagesX(uint32_t mip) const;
+
+    uint32_t GetPagesY(uint32_t mip) const;
+
+    // Texels of a page including its border, on each side.
+    uint32_t GetPaddedPageSize() const;
+
+    uint32_t GetPageBytes() const;
+
+    uint64_t GetPageFileOffset(uint32_t page) const;
+
+    uint32_t GetSlotCount() const;
+
+    // Page held by slot, InvalidVirtualPage while it is empty.
+    uint32_t GetSlotPage(uint32_t slot) const;
+
+    // Every mip of the page table in one array, mip 0 first, rows of GetPagesX(mip) entries.
+    const std::vector<uint32_t> &GetPageTable() const;
+
+    uint32_t GetPageTableOffset(uint32_t mip) const;
+
+    uint32_t GetPageTableEntry(uint32_t page) const;
+
+    // Entries changed since ClearDirtyRange(), [begin, end) into GetPageTable().
+    uint32_t GetDirtyBegin() const;
+
+    uint32_t GetDirtyEnd() const;
+
+    void ClearDirtyRange();
+
+    std::vector<VirtualPageUpload> &GetUploads();
+
+    void ClearUploads();
+
+    const VirtualTextureStats &GetStats() const;
+
+private:
+
+    // Filled by the streaming callbacks, which only hold a weak reference to it.
+    struct CompletedPages
+    {
+        std::vector<VirtualPageUpload> pages;
+    };
+
+    struct Slot
+    {
+        uint32_t page{ InvalidVirtualPage };
+
+        uint64_t lastUsedFrame{ 0 };
+
+        uint32_t previous{ 0 };
+
+        uint32_t next{ 0 };
+    };
+
+    void RequestPages();
+
+    void MapCompletedPages();
+
+    void Touch(uint32_t slot);
+
+    void Unlink(uint32_t slot);
+
+    void LinkBack(uint32_t slot);
+
+    // Points every entry of page's footprint that shows a coarser page at slot, or back at the parent's
+    // mapping when unmapping.
+    void UpdatePageTable(uint32_t page, uint32_t slot, bool map);
+
+    void MarkDirty(uint32_t begin, uint32_t end);
+
+    VirtualTextureDesc m_Desc;
+
+    AssetStreamer *m_Streamer{ nullptr };
+
+    uint32_t m_MipCount{ 0 };
+
+    uint32_t m_PagesX[MaxVirtualTextureMips]{};
+
+    uint32_t m_PagesY[MaxVirtualTextureMips]{};
+
+    // Also the index of the mip's first page in the page file.
+    uint32_t m_PageTableOffsets[MaxVirtualTextureMips + 1]{};
+
+    std::vector<uint32_t> m_PageTable;
+
+    uint32_t m_DirtyBegin{ 0 };
+
+    uint32_t m_DirtyEnd{ 0 };
+
+    // Slot 0 holds the root page and is never in the LRU list; the list runs from the least recently
+    // used slot at the front.
+    std::vector<Slot> m_Slots;
+
+    uint32_t m_LruFront{ 0 };
+
+    uint32_t m_LruBack{ 0 };
+
+    std::unordered_map<uint32_t, uint32_t> m_ResidentPages;
+
+    std::unordered_map<uint32_t, StreamRequestId> m_PendingPages;
+
+    std::shared_ptr<CompletedPages> m_CompletedPages;
+
+    std::vector<VirtualPageUpload> m_Uploads;
+
+    std::vector<uint32_t> m_Requests;
+
+    // Scratch of ResolveFeedback(), kept to avoid reallocating every frame.
+    std::vector<uint32_t> m_SortedFeedback;
+
+    std::vector<std::pair<uint32_t, uint32_t>> m_Candidates;
+
+    uint64_t m_Frame{ 0 };
+
+    VirtualTextureStats m_Stats{};
+};
@@ -1,8 +1,16 @@
 #pragma once
 #include <limits>
+#include <cstdint>
+
+class Component
+{
+public:
+
+    virtual ~Component() = default;
+};
 
 template <typename T>
 struct ComponentTraits
 {
-    static const uint8_t id = numeric_limits<uint8_t>::max();
-};
\ No newline at end of file
+    static const uint8_t id = std::numeric_limits<uint8_t>::max();
+};
@@ -1,7 +1,11 @@
 #include "GameObject.h"
 
-template <typename T>
-T *GameObject::GetComponent()
+GameObject::GameObject(const std::string &name) :
+    m_Name{ name }
 {
-    return m_Components[ComponentTraits<T>::id];//TODO cast
-}
\ No newline at end of file
+}
+
+const std::string &GameObject::GetName() const
+{
+    return m_Name;
+}
@@ -1,15 +1,40 @@
 #pragma once
 #include "Component.h"
 #include <array>
+#include <memory>
+#include <string>
 
 class GameObject
 {
 public:
 
+    explicit GameObject(const std::string &name = {});
+
+    const std::string &GetName() const;
+
     template <typename T>
     T *GetComponent();
 
+    template <typename T, typename... Args>
+    T &AddComponent(Args &&... args);
+
 private:
 
-    std::array<Component *, 10> m_Components{nullptr};//TODO
-};
\ No newline at end of file
+    std::string m_Name{};
+
+    std::array<std::unique_ptr<Component>, 10> m_Components{};//TODO
+};
+
+template <typename T>
+T *GameObject::GetComponent()
+{
+    return static_cast<T *>(m_Components[ComponentTraits<T>::id].get());
+}
+
+template <typename T, typename... Args>
+T &GameObject::AddComponent(Args &&... args)
+{
+    auto &component = m_Components[ComponentTraits<T>::id];
+    component = std::make_unique<T>(std::forward<Args>(args)...);
+    return static_cast<T &>(*component);
+}
@@ -0,0 +1,980 @@
+#include "GltfImporter.h"
+#include "Scene.h"
+#include "Transform.h"
+#include "MeshRenderer.h"
+#include "Common/Json.h"
+#include "Common/Logging.h"
+#include "IO/MappedFile.h"
+#include "Thread/ParallelFor.h"
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <type_traits>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <memory>
+#include <vector>
+
+static constexpr uint32_t GlbMagic = 0x46546C67;
+
+static constexpr uint32_t GlbChunkJson = 0x4E4F534A;
+
+static constexpr uint32_t GlbChunkBin = 0x004E4942;
+
+// Elements decoded per job; large accessors are split so one huge mesh still spreads across workers.
+static constexpr uint32_t DecodeBatchSize = 64 * 1024;
+
+enum GltfComponentType
+{
+    GltfByte = 5120,
+
+    GltfUnsignedByte = 5121,
+
+    GltfShort = 5122,
+
+    GltfUnsignedShort = 5123,
+
+    GltfUnsignedInt = 5125,
+
+    GltfFloat = 5126,
+};
+
+struct GltfBuffer
+{
+    const uint8_t *data{ nullptr };
+
+    uint64_t size{ 0 };
+};
+
+struct GltfAccessor
+{
+    const uint8_t *data{ nullptr };
+
+    uint32_t count{ 0 };
+
+    uint32_t componentType{ GltfFloat };
+
+    uint32_t componentCount{ 1 };
+
+    uint32_t stride{ 0 };
+
+    bool normalized{ false };
+};
+
+// One slice of an accessor written into a mesh stream.
+struct GltfDecodeJob
+{
+    const GltfAccessor *accessor{ nullptr };
+
+    float *floats{ nullptr };
+
+    uint32_t *indices{ nullptr };
+
+    uint32_t floatComponents{ 0 };
+
+    uint32_t baseVertex{ 0 };
+
+    uint32_t vertexCount{ 0 };
+
+    uint32_t begin{ 0 };
+
+    uint32_t end{ 0 };
+};
+
+class GltfDocument
+{
+public:
+
+    bool Load(const std::string &path, uint64_t &bytes);
+
+    const JsonValue &GetJson() const
+    {
+        return m_Json;
+    }
+
+    bool ResolveAccessor(int64_t index, GltfAccessor &accessor) const;
+
+private:
+
+    bool LoadBuffers(uint64_t &bytes);
+
+    std::string m_Directory{};
+
+    MappedFile m_File;
+
+    JsonValue m_Json;
+
+    GltfBuffer m_BinChunk{};
+
+    std::vector<GltfBuffer> m_Buffers;
+
+    std::vector<std::unique_ptr<MappedFile>> m_ExternalFiles;
+
+    std::vector<std::vector<uint8_t>> m_EmbeddedBuffers;
+};
+
+static uint32_t GetComponentSize(uint32_t componentType)
+{
+    switch (componentType)
+    {
+    case GltfByte:
+    case GltfUnsignedByte:
+        return 1;
+    case GltfShort:
+    case GltfUnsignedShort:
+        return 2;
+    case GltfUnsignedInt:
+    case GltfFloat:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t GetComponentCount(const std::string &type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+static bool DecodeBase64(const char *text, size_t length, std::vector<uint8_t> &out)
+{
+    static const auto decodeChar = [](char c) -> int
+    {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    out.clear();
+    out.reserve(length / 4 * 3);
+
+    uint32_t accumulator = 0;
+    int bits = 0;
+
+    for (size_t index = 0; index < length && text[index] != '='; ++index)
+    {
+        int value = decodeChar(text[index]);
+        if (value < 0)
+        {
+            return false;
+        }
+
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>(accumulator >> bits));
+        }
+    }
+
+    return true;
+}
+
+static std::string DecodeUri(const std::string &uri)
+{
+    std::string result;
+    result.reserve(uri.size());
+
+    for (size_t index = 0; index < uri.size(); ++index)
+    {
+        if (uri[index] == '%' && index + 2 < uri.size() && isxdigit(static_cast<unsigned char>(uri[index + 1])) && isxdigit(static_cast<unsigned char>(uri[index + 2])))
+        {
+            result.push_back(static_cast<char>(strtol(uri.substr(index + 1, 2).c_str(), nullptr, 16)));
+            index += 2;
+        }
+        else
+        {
+            result.push_back(uri[index]);
+        }
+    }
+
+    return result;
+}
+
+bool GltfDocument::Load(const std::string &path, uint64_t &bytes)
+{
+    size_t separator = path.find_last_of("/\\");
+    m_Directory = separator != std::string::npos ? path.substr(0, separator + 1) : std::string{};
+
+    if (!m_File.Open(path))
+    {
+        LOGE("Failed to open glTF file {}", path);
+        return false;
+    }
+
+    bytes += m_File.GetSize();
+
+    const uint8_t *data = m_File.GetData();
+    uint64_t size = m_File.GetSize();
+
+    const char *jsonText = reinterpret_cast<const char *>(data);
+    uint64_t jsonSize = size;
+
+    uint32_t magic = 0;
+    if (size >= 12)
+    {
+        memcpy(&magic, data, sizeof(magic));
+    }
+
+    if (magic == GlbMagic)
+    {
+        uint32_t header[3];
+        memcpy(header, data, sizeof(header));
+
+        if (header[1] != 2 || header[2] > size)
+        {
+            LOGE("Unsupported or truncated GLB container {}", path);
+            return false;
+        }
+
+        jsonText = nullptr;
+
+        // Chunks are 4-byte aligned and follow the 12 byte header.
+        uint64_t offset = 12;
+        while (offset + 8 <= header[2])
+        {
+            uint32_t chunk[2];
+            memcpy(chunk, data + offset, sizeof(chunk));
+
+            const uint8_t *chunkData = data + offset + 8;
+            if (offset + 8 + chunk[0] > header[2])
+            {
+                LOGE("Truncated GLB chunk in {}", path);
+                return false;
+            }
+
+            if (chunk[1] == GlbChunkJson && jsonText == nullptr)
+            {
+                jsonText = reinterpret_cast<const char *>(chunkData);
+                jsonSize = chunk[0];
+            }
+            else if (chunk[1] == GlbChunkBin && m_BinChunk.data == nullptr)
+            {
+                m_BinChunk.data = chunkData;
+                m_BinChunk.size = chunk[0];
+            }
+
+            offset += 8 + ((chunk[0] + 3) & ~3u);
+        }
+
+        if (jsonText == nullptr)
+        {
+            LOGE("GLB file {} has no JSON chunk", path);
+            return false;
+        }
+    }
+
+    std::string error;
+    if (!JsonValue::Parse(jsonText, static_cast<size_t>(jsonSize), m_Json, &error))
+    {
+        LOGE("Failed to parse glTF JSON in {}: {}", path, error);
+        return false;
+    }
+
+    const std::string &version = m_Json["asset"]["version"].AsString();
+    if (version.empty() || version[0] != '2')
+    {
+        LOGE("Unsupported glTF version '{}' in {}", version, path);
+        return false;
+    }
+
+    return LoadBuffers(bytes);
+}
+
+bool GltfDocument::LoadBuffers(uint64_t &bytes)
+{
+    const JsonValue &buffers = m_Json["buffers"];
+    m_Buffers.resize(buffers.Size());
+
+    for (size_t index = 0; index < buffers.Size(); ++index)
+    {
+        const JsonValue &buffer = buffers.At(index);
+        const std::string &uri = buffer["uri"].AsString();
+
+        GltfBuffer &resolved = m_Buffers[index];
+
+        if (uri.empty())
+        {
+            // The first buffer without a uri refers to the GLB binary chunk.
+            resolved = m_BinChunk;
+        }
+        else if (uri.compare(0, 5, "data:") == 0)
+        {
+            size_t comma = uri.find(";base64,");
+            if (comma == std::string::npos)
+            {
+                LOGE("Unsupported data uri in glTF buffer {}", index);
+                return false;
+            }
+
+            m_EmbeddedBuffers.emplace_back();
+            auto &decoded = m_EmbeddedBuffers.back();
+            if (!DecodeBase64(uri.c_str() + comma + 8, uri.size() - comma - 8, decoded))
+            {
+                LOGE("Invalid base64 data in glTF buffer {}", index);
+                return false;
+            }
+
+            resolved.data = decoded.data();
+            resolved.size = decoded.size();
+        }
+        else
+        {
+            auto file = std::make_unique<MappedFile>();
+            std::string path = m_Directory + DecodeUri(uri);
+            if (!file->Open(path))
+            {
+                LOGE("Failed to open glTF buffer {}", path);
+                return false;
+            }
+
+            bytes += file->GetSize();
+            resolved.data = file->GetData();
+            resolved.size = file->GetSize();
+            m_ExternalFiles.push_back(std::move(file));
+        }
+
+        uint64_t declaredSize = static_cast<uint64_t>(buffer["byteLength"].AsInt());
+        if (resolved.data == nullptr || resolved.size < declaredSize)
+        {
+            LOGE("glTF buffer {} is missing or smaller than its byteLength", index);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool GltfDocument::ResolveAccessor(int64_t index, GltfAccessor &accessor) const
+{
+    const JsonValue &json = m_Json["accessors"].At(static_cast<size_t>(index));
+    if (!json.IsObject())
+    {
+        return false;
+    }
+
+    accessor.count = static_cast<uint32_t>(json["count"].AsInt());
+    accessor.componentType = static_cast<uint32_t>(json["componentType"].AsInt());
+    accessor.componentCount = GetComponentCount(json["type"].AsString());
+    accessor.normalized = json["normalized"].AsBool();
+
+    uint32_t elementSize = GetComponentSize(accessor.componentType) * accessor.componentCount;
+    if (elementSize == 0)
+    {
+        LOGE("glTF accessor {} has an unsupported type", index);
+        return false;
+    }
+
+    if (json.Has("sparse"))
+    {
+        LOGW("glTF accessor {} uses sparse storage which is not supported, the base values are used", index);
+    }
+
+    if (!json.Has("bufferView"))
+    {
+        LOGW("glTF accessor {} has no buffer view", index);
+        return false;
+    }
+
+    const JsonValue &view = m_Json["bufferViews"].At(static_cast<size_t>(json["bufferView"].AsInt()));
+    size_t bufferIndex = static_cast<size_t>(view["buffer"].AsInt());
+    if (!view.IsObject() || bufferIndex >= m_Buffers.size())
+    {
+        return false;
+    }
+
+    const GltfBuffer &buffer = m_Buffers[bufferIndex];
+
+    uint64_t offset = static_cast<uint64_t>(view["byteOffset"].AsInt()) + static_cast<uint64_t>(json["byteOffset"].AsInt());
+    uint64_t viewEnd = static_cast<uint64_t>(view["byteOffset"].AsInt()) + static_cast<uint64_t>(view["byteLength"].AsInt());
+
+    accessor.stride = static_cast<uint32_t>(view["byteStride"].AsInt(elementSize));
+    accessor.data = buffer.data + offset;
+
+    uint64_t lastByte = accessor.count > 0 ? offset + static_cast<uint64_t>(accessor.count - 1) * accessor.stride + elementSize : offset;
+    if (lastByte > viewEnd || viewEnd > buffer.size)
+    {
+        LOGE("glTF accessor {} reads outside of its buffer", index);
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+static float NormalizeComponent(T value)
+{
+    // glTF 2.0 normalisation rules for signed and unsigned integers.
+    constexpr float maxValue = static_cast<float>(std::numeric_limits<T>::max());
+    return std::is_signed<T>::value ? std::max(static_cast<float>(value) / maxValue, -1.0f) : static_cast<float>(value) / maxValue;
+}
+
+template <typename T>
+static void DecodeFloats(const GltfDecodeJob &job)
+{
+    const GltfAccessor &accessor = *job.accessor;
+    const uint32_t components = job.floatComponents;
+
+    for (uint32_t element = job.begin; element < job.end; ++element)
+    {
+        const uint8_t *source = accessor.data + static_cast<size_t>(element) * accessor.stride;
+        float *destination = job.floats + static_cast<size_t>(element) * components;
+
+        for (uint32_t component = 0; component < components; ++component)
+        {
+            T value;
+            memcpy(&value, source + component * sizeof(T), sizeof(T));
+
+            if constexpr (std::is_same<T, float>::value)
+            {
+                destination[component] = value;
+            }
+            else
+            {
+                destination[component] = accessor.normalized ? NormalizeComponent(value) : static_cast<float>(value);
+            }
+        }
+    }
+}
+
+template <typename T>
+static void DecodeIndices(const GltfDecodeJob &job)
+{
+    const GltfAccessor &accessor = *job.accessor;
+
+    for (uint32_t element = job.begin; element < job.end; ++element)
+    {
+        T value;
+        memcpy(&value, accessor.data + static_cast<size_t>(element) * accessor.stride, sizeof(T));
+
+        // Out of range indices would make every later pass read past the vertex streams.
+        uint32_t index = static_cast<uint32_t>(value);
+        job.indices[element] = (index < job.vertexCount ? index : 0) + job.baseVertex;
+    }
+}
+
+static void RunDecodeJob(const GltfDecodeJob &job)
+{
+    if (job.accessor == nullptr)
+    {
+        // Primitive without indices, draw its vertices in order.
+        for (uint32_t element = job.begin; element < job.end; ++element)
+        {
+            job.indices[element] = job.baseVertex + element;
+        }
+        return;
+    }
+
+    if (job.indices != nullptr)
+    {
+        switch (job.accessor->componentType)
+        {
+        case GltfUnsignedByte:  DecodeIndices<uint8_t>(job);  break;
+        case GltfUnsignedShort: DecodeIndices<uint16_t>(job); break;
+        case GltfUnsignedInt:   DecodeIndices<uint32_t>(job); break;
+        default: break;
+        }
+        return;
+    }
+
+    // Tightly packed float streams are a straight copy.
+    if (job.accessor->componentType == GltfFloat && job.accessor->stride == job.floatComponents * sizeof(float))
+    {
+        memcpy(job.floats + static_cast<size_t>(job.begin) * job.floatComponents,
+               job.accessor->data + static_cast<size_t>(job.begin) * job.accessor->stride,
+               static_cast<size_t>(job.end - job.begin) * job.accessor->stride);
+        return;
+    }
+
+    switch (job.accessor->componentType)
+    {
+    case GltfByte:          DecodeFloats<int8_t>(job);   break;
+    case GltfUnsignedByte:  DecodeFloats<uint8_t>(job);  break;
+    case GltfShort:         DecodeFloats<int16_t>(job);  break;
+    case GltfUnsignedShort: DecodeFloats<uint16_t>(job); break;
+    case GltfFloat:         DecodeFloats<float>(job);    break;
+    default: break;
+    }
+}
+
+static void AddDecodeJobs(std::vector<GltfDecodeJob> &jobs, const GltfDecodeJob &job, uint32_t count)
+{
+    for (uint32_t begin = 0; begin < count; begin += DecodeBatchSize)
+    {
+        GltfDecodeJob slice = job;
+        slice.begin = begin;
+        slice.end = std::min(begin + DecodeBatchSize, count);
+        jobs.push_back(slice);
+    }
+}
+
+// meshBase is where this file's meshCount meshes start in the scene.
+static void CreateNode(const JsonValue &nodes, int64_t nodeIndex, GameObject *parent, uint32_t meshBase, uint32_t meshCount, uint32_t depth, Scene &scene, GltfImportStats &stats)
+{
+    const JsonValue &node = nodes.At(static_cast<size_t>(nodeIndex));
+    if (!node.IsObject() || depth > 256)
+    {
+        LOGW("Skipping invalid glTF node {}", nodeIndex);
+        return;
+    }
+
+    int64_t meshIndex = node["mesh"].AsInt(-1);
+    if (node.Has("mesh") && (meshIndex < 0 || meshIndex >= static_cast<int64_t>(meshCount)))
+    {
+        LOGW("Skipping glTF node {} with invalid mesh {}", nodeIndex, meshIndex);
+        return;
+    }
+
+    GameObject &gameObject = scene.CreateGameObject(node["name"].AsString(), parent);
+    Transform &transform = *gameObject.GetComponent<Transform>();
+    ++stats.nodeCount;
+
+    const JsonValue &matrix = node["matrix"];
+    if (matrix.Size() == 16)
+    {
+        glm::mat4 value{ 1.0f };
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                value[column][row] = static_cast<float>(matrix.At(column * 4 + row).AsNumber());
+            }
+        }
+        transform.SetMatrix(value);
+    }
+    else
+    {
+        const JsonValue &translation = node["translation"];
+        if (translation.Size() == 3)
+        {
+            transform.SetTranslation(glm::vec3{ static_cast<float>(translation.At(0).AsNumber()), static_cast<float>(translation.At(1).AsNumber()), static_cast<float>(translation.At(2).AsNumber()) });
+        }
+
+        // glTF stores quaternions as x, y, z, w.
+        const JsonValue &rotation = node["rotation"];
+        if (rotation.Size() == 4)
+        {
+            transform.SetRotation(glm::quat{ static_cast<float>(rotation.At(3).AsNumber()), static_cast<float>(rotation.At(0).AsNumber()), static_cast<float>(rotation.At(1).AsNumber()), static_cast<float>(rotation.At(2).AsNumber()) });
+        }
+
+        const JsonValue &scale = node["scale"];
+        if (scale.Size() == 3)
+        {
+            transform.SetScale(glm::vec3{ static_cast<float>(scale.At(0).AsNumber()), static_cast<float>(scale.At(1).AsNumber()), static_cast<float>(scale.At(2).AsNumber()) });
+        }
+    }
+
+    if (node.Has("mesh"))
+    {
+        gameObject.AddComponent<MeshRenderer>(meshBase + static_cast<uint32_t>(meshIndex));
+    }
+
+    const JsonValue &children = node["children"];
+    for (size_t child = 0; child < children.Size(); ++child)
+    {
+        CreateNode(nodes, children.At(child).AsInt(), &gameObject, meshBase, meshCount, depth + 1, scene, stats);
+    }
+}
+
+double GltfImportStats::GetMegabytesPerSecond() const
+{
+    return totalSeconds > 0.0 ? (bytes / (1024.0 * 1024.0)) / totalSeconds : 0.0;
+}
+
+double GltfImportStats::GetMeshesPerSecond() const
+{
+    return totalSeconds > 0.0 ? meshCount / totalSeconds : 0.0;
+}
+
+GltfImporter::GltfImporter(WorkerThreadPool &workerThreadPool) :
+    m_WorkerThreadPool{ workerThreadPool }
+{
+}
+
+void GltfImporter::SetOptimizeMeshes(bool optimize)
+{
+    m_OptimizeMeshes = optimize;
+}
+
+void GltfImporter::SetLodChainParams(const LodChainParams &params)
+{
+    m_GenerateLods = true;
+    m_LodChainParams = params;
+}
+
+bool GltfImporter::Import(const std::string &path, Scene &scene, GltfImportStats *stats)
+{
+    using Clock = std::chrono::steady_clock;
+
+    GltfImportStats localStats{};
+    Clock::time_point startTime = Clock::now();
+
+    GltfDocument document;
+    if (!document.Load(path, localStats.bytes))
+    {
+        return false;
+    }
+
+    const JsonValue &json = document.GetJson();
+    const JsonValue &meshes = json["meshes"];
+
+    Clock::time_point parseTime = Clock::now();
+
+    // Lay out every primitive in its mesh's streams up front so decode jobs can write in place.
+    std::vector<std::unique_ptr<Mesh>> importedMeshes(meshes.Size());
+    std::vector<GltfAccessor> accessors;
+    std::vector<GltfDecodeJob> jobs;
+
+    // Accessors are referenced by pointer from the jobs, reserve the worst case so they never move.
+    size_t maxAccessors = 0;
+    for (size_t meshIndex = 0; meshIndex < meshes.Size(); ++meshIndex)
+    {
+        maxAccessors += meshes.At(meshIndex)["primitives"].Size() * 5;
+    }
+    accessors.reserve(maxAccessors);
+
+    for (size_t meshIndex = 0; meshIndex < meshes.Size(); ++meshIndex)
+    {
+        const JsonValue &meshJson = meshes.At(meshIndex);
+        const JsonValue &primitives = meshJson["primitives"];
+
+        auto mesh = std::make_unique<Mesh>(meshJson["name"].AsString());
+
+        struct PrimitiveLayout
+        {
+            const GltfAccessor *position{ nullptr };
+
+            const GltfAccessor *normal{ nullptr };
+
+            const GltfAccessor *tangent{ nullptr };
+
+            const GltfAccessor *texCoord{ nullptr };
+
+            const GltfAccessor *indices{ nullptr };
+
+            uint32_t vertexCount{ 0 };
+
+            uint32_t indexCount{ 0 };
+        };
+
+        std::vector<PrimitiveLayout> layouts;
+        bool hasNormals = false;
+        bool hasTangents = false;
+        bool hasTexCoords = false;
+
+        const auto resolve = [&](const JsonValue &attributes, const char *name, uint32_t componentCount) -> const GltfAccessor *
+        {
+            if (!attributes.Has(name))
+            {
+                return nullptr;
+            }
+
+            GltfAccessor accessor{};
+            if (!document.ResolveAccessor(attributes[name].AsInt(), accessor) || accessor.componentCount != componentCount)
+            {
+                LOGW("Ignoring invalid {} attribute in glTF mesh {}", name, meshIndex);
+                return nullptr;
+            }
+
+            accessors.push_back(accessor);
+            return &accessors.back();
+        };
+
+        for (size_t primitiveIndex = 0; primitiveIndex < primitives.Size(); ++primitiveIndex)
+        {
+            const JsonValue &primitive = primitives.At(primitiveIndex);
+
+            if (primitive["mode"].AsInt(4) != 4)
+            {
+                LOGW("Skipping non-triangle primitive {} in glTF mesh {}", primitiveIndex, meshIndex);
+                continue;
+            }
+
+            const JsonValue &attributes = primitive["attributes"];
+
+            PrimitiveLayout layout{};
+            layout.position = resolve(attributes, "POSITION", 3);
+            if (layout.position == nullptr)
+            {
+                continue;
+            }
+
+            layout.vertexCount = layout.position->count;
+            layout.normal = resolve(attributes, "NORMAL", 3);
+            layout.tangent = resolve(attributes, "TANGENT", 4);
+            layout.texCoord = resolve(attributes, "TEXCOORD_0", 2);
+
+            if (primitive.Has("indices"))
+            {
+                GltfAccessor accessor{};
+                if (!document.ResolveAccessor(primitive["indices"].AsInt(), accessor) || accessor.componentCount != 1 ||
+                    (accessor.componentType != GltfUnsignedByte && accessor.componentType != GltfUnsignedShort && accessor.componentType != GltfUnsignedInt))
+                {
+                    LOGW("Skipping primitive {} with invalid indices in glTF mesh {}", primitiveIndex, meshIndex);
+                    continue;
+                }
+
+                accessors.push_back(accessor);
+                layout.indices = &accessors.back();
+                layout.indexCount = accessor.count;
+            }
+            else
+            {
+                layout.indexCount = layout.vertexCount;
+            }
+
+            // Attributes shorter than the position stream would read past the end.
+            const auto validate = [&layout](const GltfAccessor *&accessor)
+            {
+                if (accessor != nullptr && accessor->count != layout.vertexCount)
+                {
+                    accessor = nullptr;
+                }
+            };
+            validate(layout.normal);
+            validate(layout.tangent);
+            validate(layout.texCoord);
+
+            hasNormals |= layout.normal != nullptr;
+            hasTangents |= layout.tangent != nullptr;
+            hasTexCoords |= layout.texCoord != nullptr;
+
+            SubMesh subMesh{};
+            subMesh.indexOffset = 0;
+            subMesh.indexCount = layout.indexCount;
+            subMesh.materialIndex = static_cast<int32_t>(primitive["material"].AsInt(-1));
+            mesh->GetSubMeshes().push_back(subMesh);
+
+            layouts.push_back(layout);
+        }
+
+        uint64_t vertexCount = 0;
+        uint64_t indexCount = 0;
+        for (const PrimitiveLayout &layout : layouts)
+        {
+            vertexCount += layout.vertexCount;
+            indexCount += layout.indexCount;
+        }
+
+        if (vertexCount > UINT32_MAX || indexCount > UINT32_MAX)
+        {
+            LOGE("glTF mesh {} is too large", meshIndex);
+            return false;
+        }
+
+        // Missing attributes of individual primitives stay zero.
+        mesh->GetPositions().resize(vertexCount);
+        mesh->GetIndices().resize(indexCount);
+        if (hasNormals)
+        {
+            mesh->GetNormals().resize(vertexCount);
+        }
+        if (hasTangents)
+        {
+            mesh->GetTangents().resize(vertexCount);
+        }
+        if (hasTexCoords)
+        {
+            mesh->GetTexCoords().resize(vertexCount);
+        }
+
+        uint32_t baseVertex = 0;
+        uint32_t baseIndex = 0;
+
+        for (size_t primitiveIndex = 0; primitiveIndex < layouts.size(); ++primitiveIndex)
+        {
+            const PrimitiveLayout &layout = layouts[primitiveIndex];
+            mesh->GetSubMeshes()[primitiveIndex].indexOffset = baseIndex;
+
+            GltfDecodeJob job{};
+            job.accessor = layout.position;
+            job.floats = &mesh->GetPositions()[baseVertex].x;
+            job.floatComponents = 3;
+            AddDecodeJobs(jobs, job, layout.vertexCount);
+
+            if (layout.normal != nullptr)
+            {
+                job.accessor = layout.normal;
+                job.floats = &mesh->GetNormals()[baseVertex].x;
+                job.floatComponents = 3;
+                AddDecodeJobs(jobs, job, layout.vertexCount);
+            }
+
+            if (layout.tangent != nullptr)
+            {
+                job.accessor = layout.tangent;
+                job.floats = &mesh->GetTangents()[baseVertex].x;
+                job.floatComponents = 4;
+                AddDecodeJobs(jobs, job, layout.vertexCount);
+            }
+
+            if (layout.texCoord != nullptr)
+            {
+                job.accessor = layout.texCoord;
+                job.floats = &mesh->GetTexCoords()[baseVertex].x;
+                job.floatComponents = 2;
+                AddDecodeJobs(jobs, job, layout.vertexCount);
+            }
+
+            if (layout.indexCount > 0)
+            {
+                GltfDecodeJob indexJob{};
+                indexJob.accessor = layout.indices;
+                indexJob.indices = &mesh->GetIndices()[baseIndex];
+                indexJob.baseVertex = baseVertex;
+                indexJob.vertexCount = layout.vertexCount;
+                AddDecodeJobs(jobs, indexJob, layout.indexCount);
+            }
+
+            baseVertex += layout.vertexCount;
+            baseIndex += layout.indexCount;
+        }
+
+        localStats.primitiveCount += static_cast<uint32_t>(layouts.size());
+        localStats.vertexCount += vertexCount;
+        localStats.indexCount += indexCount;
+
+        importedMeshes[meshIndex] = std::move(mesh);
+    }
+
+    ParallelFor(m_WorkerThreadPool, static_cast<uint32_t>(jobs.size()), 1, [&jobs](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t index = begin; index < end; ++index)
+        {
+            RunDecodeJob(jobs[index]);
+        }
+    });
+
+    ParallelFor(m_WorkerThreadPool, static_cast<uint32_t>(importedMeshes.size()), 1, [&importedMeshes](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t index = begin; index < end; ++index)
+        {
+            importedMeshes[index]->ComputeBounds();
+        }
+    });
+
+    Clock::time_point optimizeStartTime = Clock::now();
+
+    // Ahead of the LOD chains, OptimizeMesh() remaps the vertex streams they index.
+    if (m_OptimizeMeshes)
+    {
+        std::vector<MeshOptimizerReport> reports(importedMeshes.size());
+        ParallelFor(m_WorkerThreadPool, static_cast<uint32_t>(importedMeshes.size()), 1, [&importedMeshes, &reports](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t index = begin; index < end; ++index)
+            {
+                reports[index] = MeshOptimizer::OptimizeMesh(*importedMeshes[index]);
+            }
+        });
+
+        for (const MeshOptimizerReport &report : reports)
+        {
+            MeshOptimizer::AccumulateReport(localStats.optimizerReport, report);
+        }
+
+        const MeshOptimizerReport &report = localStats.optimizerReport;
+        LOGI("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, overfetch {:.3f} -> {:.3f}",
+             path, report.cacheBefore.acmr, report.cacheAfter.acmr, report.cacheBefore.atvr, report.cacheAfter.atvr,
+             report.fetchBefore.overfetch, report.fetchAfter.overfetch);
+    }
+
+    Clock::time_point lodStartTime = Clock::now();
+    localStats.optimizeSeconds = std::chrono::duration<double>(lodStartTime - optimizeStartTime).count();
+
+    if (m_GenerateLods)
+    {
+        ParallelFor(m_WorkerThreadPool, static_cast<uint32_t>(importedMeshes.size()), 1, [this, &importedMeshes](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t index = begin; index < end; ++index)
+            {
+                MeshSimplifier::BuildLodChain(*importedMeshes[index], m_LodChainParams);
+            }
+        });
+
+        for (const auto &mesh : importedMeshes)
+        {
+            for (const MeshLod &lod : mesh->GetLods())
+            {
+                localStats.lodTriangleCount += lod.triangleCount;
+            }
+        }
+    }
+
+    Clock::time_point decodeTime = Clock::now();
+    localStats.lodSeconds = std::chrono::duration<double>(decodeTime - lodStartTime).count();
+
+    uint32_t meshBase = static_cast<uint32_t>(scene.GetMeshes().size());
+    for (auto &mesh : importedMeshes)
+    {
+        scene.AddMesh(std::move(mesh));
+    }
+    localStats.meshCount = static_cast<uint32_t>(importedMeshes.size());
+
+    const JsonValue &nodes = json["nodes"];
+    const JsonValue &scenes = json["scenes"];
+
+    if (scenes.Size() > 0)
+    {
+        const JsonValue &rootNodes = scenes.At(static_cast<size_t>(json["scene"].AsInt(0)))["nodes"];
+        for (size_t root = 0; root < rootNodes.Size(); ++root)
+        {
+            CreateNode(nodes, rootNodes.At(root).AsInt(), nullptr, meshBase, localStats.meshCount, 0, scene, localStats);
+        }
+    }
+    else
+    {
+        // Without a scene list every node that isn't somebody's child is a root.
+        std::vector<bool> isChild(nodes.Size(), false);
+        for (size_t node = 0; node < nodes.Size(); ++node)
+        {
+            const JsonValue &children = nodes.At(node)["children"];
+            for (size_t child = 0; child < children.Size(); ++child)
+            {
+                size_t childIndex = static_cast<size_t>(children.At(child).AsInt());
+                if (childIndex < isChild.size())
+                {
+                    isChild[childIndex] = true;
+                }
+            }
+        }
+
+        for (size_t node = 0; node < nodes.Size(); ++node)
+        {
+            if (!isChild[node])
+            {
+                CreateNode(nodes, static_cast<int64_t>(node), nullptr, meshBase, localStats.meshCount, 0, scene, localStats);
+            }
+        }
+    }
+
+    Clock::time_point endTime = Clock::now();
+
+    localStats.parseSeconds = std::chrono::duration<double>(parseTime - startTime).count();
+    localStats.decodeSeconds = std::chrono::duration<double>(decodeTime - parseTime).count();
+    localStats.totalSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    LOGI("Imported {}: {} meshes, {} primitives, {} nodes in {:.2f} ms ({:.1f} MB/s, {:.0f} meshes/s)",
+         path, localStats.meshCount, localStats.primitiveCount, localStats.nodeCount, localStats.totalSeconds * 1000.0,
+         localStats.GetMegabytesPerSecond(), localStats.GetMeshesPerSecond());
+
+    if (stats != nullptr)
+    {
+        *stats = localStats;
+    }
+
+    return true;
+}
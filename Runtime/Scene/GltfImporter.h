@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "Render/MeshOptimizer.h"
+#include "Render/MeshSimplifier.h"
+#include <string>
+#include <cstdint>
+
+class Scene;
+class WorkerThreadPool;
+
+struct GltfImportStats
+{
+    // Size of the .gltf/.glb file plus every external buffer.
+    uint64_t bytes{ 0 };
+
+    uint32_t meshCount{ 0 };
+
+    uint32_t primitiveCount{ 0 };
+
+    uint32_t nodeCount{ 0 };
+
+    uint64_t vertexCount{ 0 };
+
+    uint64_t indexCount{ 0 };
+
+    double parseSeconds{ 0.0 };
+
+    double decodeSeconds{ 0.0 };
+
+    // Part of decodeSeconds spent building LOD chains.
+    double lodSeconds{ 0.0 };
+
+    uint64_t lodTriangleCount{ 0 };
+
+    // Part of decodeSeconds spent in MeshOptimizer, before the LOD chains.
+    double optimizeSeconds{ 0.0 };
+
+    // All meshes of the file combined, only filled with SetOptimizeMeshes(true).
+    MeshOptimizerReport optimizerReport{};
+
+    double totalSeconds{ 0.0 };
+
+    double GetMegabytesPerSecond() const;
+
+    double GetMeshesPerSecond() const;
+};
+
+// Imports glTF 2.0 (.gltf with external or embedded buffers, and .glb) into a Scene. Binary data is
+// memory mapped and decoded straight into the destination meshes, split into batches across the pool.
+class GltfImporter : public NonCopyable
+{
+public:
+
+    explicit GltfImporter(WorkerThreadPool &workerThreadPool);
+
+    bool Import(const std::string &path, Scene &scene, GltfImportStats *stats = nullptr);
+
+    // Builds an LOD chain for every imported mesh, in parallel with the other meshes.
+    void SetLodChainParams(const LodChainParams &params);
+
+    // Reorders every imported mesh for the vertex cache, overdraw and vertex fetch.
+    void SetOptimizeMeshes(bool optimize);
+
+private:
+
+    WorkerThreadPool &m_WorkerThreadPool;
+
+    bool m_GenerateLods{ false };
+
+    bool m_OptimizeMeshes{ false };
+
+    LodChainParams m_LodChainParams{};
+};
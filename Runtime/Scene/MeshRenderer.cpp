@@ -0,0 +1,16 @@
+#include "MeshRenderer.h"
+
+MeshRenderer::MeshRenderer(uint32_t meshIndex) :
+    m_MeshIndex{ meshIndex }
+{
+}
+
+uint32_t MeshRenderer::GetMeshIndex() const
+{
+    return m_MeshIndex;
+}
+
+void MeshRenderer::SetMeshIndex(uint32_t meshIndex)
+{
+    m_MeshIndex = meshIndex;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "Component.h"
+
+class MeshRenderer : public Component
+{
+public:
+
+    explicit MeshRenderer(uint32_t meshIndex);
+
+    // Index into Scene::GetMeshes().
+    uint32_t GetMeshIndex() const;
+
+    void SetMeshIndex(uint32_t meshIndex);
+
+private:
+
+    uint32_t m_MeshIndex{ 0 };
+};
+
+template <>
+struct ComponentTraits<MeshRenderer>
+{
+    static const uint8_t id = 1;
+};
@@ -0,0 +1,40 @@
+#include "Scene.h"
+#include "Transform.h"
+
+GameObject &Scene::CreateGameObject(const std::string &name, GameObject *parent)
+{
+    m_GameObjects.push_back(std::make_unique<GameObject>(name));
+    GameObject &gameObject = *m_GameObjects.back();
+
+    Transform &transform = gameObject.AddComponent<Transform>();
+    if (parent != nullptr)
+    {
+        transform.SetParent(parent->GetComponent<Transform>());
+    }
+
+    return gameObject;
+}
+
+uint32_t Scene::AddMesh(std::unique_ptr<Mesh> &&mesh)
+{
+    m_Meshes.push_back(std::move(mesh));
+    return static_cast<uint32_t>(m_Meshes.size() - 1);
+}
+
+const std::vector<std::unique_ptr<GameObject>> &Scene::GetGameObjects() const
+{
+    return m_GameObjects;
+}
+
+const std::vector<std::unique_ptr<Mesh>> &Scene::GetMeshes() const
+{
+    return m_Meshes;
+}
+
+void Scene::UpdateTransforms()
+{
+    for (auto &gameObject : m_GameObjects)
+    {
+        gameObject->GetComponent<Transform>()->UpdateWorldMatrix();
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "GameObject.h"
+#include "Render/Mesh.h"
+#include <vector>
+#include <memory>
+#include <string>
+
+class Scene : public NonCopyable
+{
+public:
+
+    Scene() = default;
+
+    // Every game object gets a Transform; parents must be created before their children.
+    GameObject &CreateGameObject(const std::string &name, GameObject *parent = nullptr);
+
+    uint32_t AddMesh(std::unique_ptr<Mesh> &&mesh);
+
+    const std::vector<std::unique_ptr<GameObject>> &GetGameObjects() const;
+
+    const std::vector<std::unique_ptr<Mesh>> &GetMeshes() const;
+
+    // Walks the objects in creation order, which keeps parents ahead of their children.
+    void UpdateTransforms();
+
+private:
+
+    std::vector<std::unique_ptr<GameObject>> m_GameObjects;
+
+    std::vector<std::unique_ptr<Mesh>> m_Meshes;
+};
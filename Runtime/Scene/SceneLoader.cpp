@@ -1,3 +1,124 @@
 #include "SceneLoader.h"
+#include "GltfImporter.h"
+#include "Thread/ThreadPool.h"
+#include "Common/Logging.h"
+#include <cassert>
+#include <algorithm>
+#include <cctype>
 
-SceneLoader *g_SceneLoader = new  SceneLoader();
\ No newline at end of file
+SceneLoader *g_SceneLoader = new  SceneLoader();
+
+uint32_t SceneLoadState::GetAssetCount() const
+{
+    return static_cast<uint32_t>(m_Assets.size());
+}
+
+uint32_t SceneLoadState::GetResidentCount() const
+{
+    return m_ResidentCount.load(std::memory_order_acquire);
+}
+
+uint32_t SceneLoadState::GetFailedCount() const
+{
+    return m_FailedCount.load(std::memory_order_acquire);
+}
+
+uint32_t SceneLoadState::GetCancelledCount() const
+{
+    return m_CancelledCount.load(std::memory_order_acquire);
+}
+
+bool SceneLoadState::IsResident() const
+{
+    return GetResidentCount() + GetFailedCount() + GetCancelledCount() == GetAssetCount();
+}
+
+bool SceneLoader::Import(const std::string &path, Scene &scene)
+{
+    size_t dot = path.find_last_of('.');
+    std::string extension = dot != std::string::npos ? path.substr(dot + 1) : std::string{};
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == "gltf" || extension == "glb")
+    {
+        GltfImporter importer{ *g_WorkerThreadPool };
+        return importer.Import(path, scene);
+    }
+
+    LOGE("No importer for scene file {}", path);
+    return false;
+}
+
+void SceneLoader::SetAssetStreamer(AssetStreamer *streamer)
+{
+    m_Streamer = streamer;
+}
+
+SceneLoadStatePtr SceneLoader::LoadAsync(std::vector<SceneAssetDesc> &&assets, const glm::vec3 &cameraPosition, const StreamCompleteFunc &onAssetResident)
+{
+    assert(m_Streamer != nullptr && "SceneLoader needs an AssetStreamer before loading.");
+
+    auto state = std::make_shared<SceneLoadState>();
+    state->m_Assets = std::move(assets);
+    state->m_Requests.reserve(state->m_Assets.size());
+
+    // The callbacks only hold a weak reference so a dropped load doesn't keep its state alive.
+    std::weak_ptr<SceneLoadState> weakState = state;
+
+    for (const SceneAssetDesc &asset : state->m_Assets)
+    {
+        StreamRequestDesc desc{};
+        desc.path = asset.path;
+        desc.priority = asset.priority;
+        desc.distance = glm::distance(asset.position, cameraPosition);
+        desc.decompress = asset.decompress;
+        desc.onComplete = [weakState, onAssetResident](StreamedAsset &streamed)
+        {
+            if (onAssetResident)
+            {
+                onAssetResident(streamed);
+            }
+
+            if (auto state = weakState.lock())
+            {
+                if (streamed.succeeded)
+                {
+                    state->m_ResidentCount.fetch_add(1, std::memory_order_release);
+                }
+                else
+                {
+                    state->m_FailedCount.fetch_add(1, std::memory_order_release);
+                }
+            }
+        };
+
+        state->m_Requests.push_back(m_Streamer->Request(std::move(desc)));
+    }
+
+    return state;
+}
+
+void SceneLoader::UpdatePriorities(const SceneLoadState &state, const glm::vec3 &cameraPosition)
+{
+    assert(m_Streamer != nullptr);
+
+    for (size_t index = 0; index < state.m_Requests.size(); ++index)
+    {
+        const SceneAssetDesc &asset = state.m_Assets[index];
+        m_Streamer->UpdatePriority(state.m_Requests[index], asset.priority, glm::distance(asset.position, cameraPosition));
+    }
+}
+
+void SceneLoader::Cancel(SceneLoadState &state)
+{
+    assert(m_Streamer != nullptr);
+
+    for (StreamRequestId id : state.m_Requests)
+    {
+        // False when the request has finished, which onComplete counted, or was cancelled before.
+        if (m_Streamer->Cancel(id))
+        {
+            state.m_CancelledCount.fetch_add(1, std::memory_order_release);
+        }
+    }
+}
@@ -2,16 +2,82 @@
 
 
 #include "Common/Utils.h"
+#include "Streaming/AssetStreamer.h"
 //#include <algorithm>
-//#include <vector>
-//#include <string>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <glm/glm.hpp>
 
+struct SceneAssetDesc
+{
+    std::string path;
+
+    // World-space centre, used to order streaming by camera distance.
+    glm::vec3 position{ 0.0f };
+
+    StreamPriority priority{ StreamPriority::Normal };
+
+    StreamDecompressFunc decompress{};
+};
+
+class SceneLoadState : public NonCopyable
+{
+public:
+
+    uint32_t GetAssetCount() const;
+
+    uint32_t GetResidentCount() const;
+
+    uint32_t GetFailedCount() const;
+
+    uint32_t GetCancelledCount() const;
+
+    // Every asset has arrived, failed or been cancelled, so nothing of this load is still streaming.
+    bool IsResident() const;
+
+private:
 
+    friend class SceneLoader;
 
+    std::vector<SceneAssetDesc> m_Assets;
+
+    std::vector<StreamRequestId> m_Requests;
+
+    std::atomic<uint32_t> m_ResidentCount{ 0 };
+
+    std::atomic<uint32_t> m_FailedCount{ 0 };
+
+    std::atomic<uint32_t> m_CancelledCount{ 0 };
+};
+
+using SceneLoadStatePtr = std::shared_ptr<SceneLoadState>;
+
+class Scene;
 
 class SceneLoader : public NonCopyable
 {
 public:
+
+    // Imports a .gltf or .glb file into scene, decoding on g_WorkerThreadPool.
+    bool Import(const std::string &path, Scene &scene);
+
+    void SetAssetStreamer(AssetStreamer *streamer);
+
+    // Queues every asset and returns before any of them is resident. onAssetResident runs from
+    // AssetStreamer::PumpUploads() as each asset arrives.
+    SceneLoadStatePtr LoadAsync(std::vector<SceneAssetDesc> &&assets, const glm::vec3 &cameraPosition, const StreamCompleteFunc &onAssetResident);
+
+    // Re-sorts the assets that are still queued by their distance to the camera.
+    void UpdatePriorities(const SceneLoadState &state, const glm::vec3 &cameraPosition);
+
+    // Assets already handed to the upload path still arrive and count as resident or failed.
+    void Cancel(SceneLoadState &state);
+
+private:
+
+    AssetStreamer *m_Streamer{ nullptr };
 };
 
-extern SceneLoader *g_SceneLoader;
\ No newline at end of file
+extern SceneLoader *g_SceneLoader;
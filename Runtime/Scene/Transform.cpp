@@ -0,0 +1,87 @@
+#include "Transform.h"
+
+const glm::vec3 &Transform::GetTranslation() const
+{
+    return m_Translation;
+}
+
+void Transform::SetTranslation(const glm::vec3 &translation)
+{
+    m_Translation = translation;
+}
+
+const glm::quat &Transform::GetRotation() const
+{
+    return m_Rotation;
+}
+
+void Transform::SetRotation(const glm::quat &rotation)
+{
+    m_Rotation = rotation;
+}
+
+const glm::vec3 &Transform::GetScale() const
+{
+    return m_Scale;
+}
+
+void Transform::SetScale(const glm::vec3 &scale)
+{
+    m_Scale = scale;
+}
+
+void Transform::SetMatrix(const glm::mat4 &matrix)
+{
+    m_Translation = glm::vec3{ matrix[3].x, matrix[3].y, matrix[3].z };
+
+    glm::vec3 axisX{ matrix[0].x, matrix[0].y, matrix[0].z };
+    glm::vec3 axisY{ matrix[1].x, matrix[1].y, matrix[1].z };
+    glm::vec3 axisZ{ matrix[2].x, matrix[2].y, matrix[2].z };
+
+    m_Scale = glm::vec3{ glm::length(axisX), glm::length(axisY), glm::length(axisZ) };
+
+    // A negative determinant means one axis is mirrored, fold it into the X scale.
+    if (glm::dot(glm::cross(axisX, axisY), axisZ) < 0.0f)
+    {
+        m_Scale.x = -m_Scale.x;
+    }
+
+    glm::mat3 rotation{ 1.0f };
+    rotation[0] = m_Scale.x != 0.0f ? axisX / m_Scale.x : glm::vec3{ 1.0f, 0.0f, 0.0f };
+    rotation[1] = m_Scale.y != 0.0f ? axisY / m_Scale.y : glm::vec3{ 0.0f, 1.0f, 0.0f };
+    rotation[2] = m_Scale.z != 0.0f ? axisZ / m_Scale.z : glm::vec3{ 0.0f, 0.0f, 1.0f };
+
+    m_Rotation = glm::normalize(glm::quat_cast(rotation));
+}
+
+Transform *Transform::GetParent() const
+{
+    return m_Parent;
+}
+
+void Transform::SetParent(Transform *parent)
+{
+    m_Parent = parent;
+}
+
+glm::mat4 Transform::GetLocalMatrix() const
+{
+    glm::mat4 matrix = glm::mat4_cast(m_Rotation);
+
+    matrix[0] *= m_Scale.x;
+    matrix[1] *= m_Scale.y;
+    matrix[2] *= m_Scale.z;
+    matrix[3] = glm::vec4{ m_Translation, 1.0f };
+
+    return matrix;
+}
+
+const glm::mat4 &Transform::GetWorldMatrix() const
+{
+    return m_WorldMatrix;
+}
+
+void Transform::UpdateWorldMatrix()
+{
+    m_WorldMatrix = m_Parent != nullptr ? m_Parent->GetWorldMatrix() * GetLocalMatrix() : GetLocalMatrix();
+}
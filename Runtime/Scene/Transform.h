@@ -1,10 +1,50 @@
 #pragma once
 #include "Component.h"
-
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 class Transform : public Component
 {
+public:
+
+    const glm::vec3 &GetTranslation() const;
+
+    void SetTranslation(const glm::vec3 &translation);
+
+    const glm::quat &GetRotation() const;
+
+    void SetRotation(const glm::quat &rotation);
+
+    const glm::vec3 &GetScale() const;
+
+    void SetScale(const glm::vec3 &scale);
+
+    // Decomposes an affine matrix without shear into translation, rotation and scale.
+    void SetMatrix(const glm::mat4 &matrix);
+
+    Transform *GetParent() const;
+
+    void SetParent(Transform *parent);
+
+    glm::mat4 GetLocalMatrix() const;
+
+    // Valid after the last UpdateWorldMatrix() call.
+    const glm::mat4 &GetWorldMatrix() const;
+
+    // Parents must be updated before their children.
+    void UpdateWorldMatrix();
+
+private:
+
+    glm::vec3 m_Translation{ 0.0f };
+
+    glm::quat m_Rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+
+    glm::vec3 m_Scale{ 1.0f };
+
+    Transform *m_Parent{ nullptr };
 
+    glm::mat4 m_WorldMatrix{ 1.0f };
 };
 
 template <>
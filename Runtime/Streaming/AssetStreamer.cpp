@@ -0,0 +1,562 @@
+#include "AssetStreamer.h"
+#include "Thread/ThreadPool.h"
+#include "Common/Logging.h"
+#include <cassert>
+#include <algorithm>
+
+static double ToMilliseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Reports back whether it runs or the pool abandons it, the destructor waits on every dispatched job.
+class AssetStreamer::DecompressJob : public WorkerThreadJob, public PoolAllocated<MemoryTag::Thread>
+{
+public:
+
+    DecompressJob(AssetStreamer &streamer, StreamRequest *request) :
+        m_Streamer{ streamer },
+        m_Request{ request }
+    {
+    }
+
+    virtual void DoWork() override
+    {
+        m_Streamer.FinishDecompression(m_Request, false);
+        delete this;
+    }
+
+    virtual void Abandon() override
+    {
+        m_Streamer.FinishDecompression(m_Request, true);
+        delete this;
+    }
+
+    virtual const char *GetName() const override
+    {
+        return "AssetStreamer::Decompress";
+    }
+
+private:
+
+    AssetStreamer &m_Streamer;
+
+    StreamRequest *m_Request;
+};
+
+bool AssetStreamer::QueueEntry::operator<(const QueueEntry &other) const
+{
+    if (priority != other.priority)
+    {
+        return priority > other.priority;
+    }
+    return distance > other.distance;
+}
+
+AssetStreamer::AssetStreamer(WorkerThreadPool &workerThreadPool, uint64_t maxInFlightBytes, uint32_t ioQueueDepth, bool useIoUring) :
+    m_WorkerThreadPool{ workerThreadPool },
+    m_Reader{ ioQueueDepth, useIoUring },
+    m_MaxInFlightBytes{ maxInFlightBytes }
+{
+    LOGI("Asset streamer using {} with queue depth {}", m_Reader.IsUsingIoUring() ? "io_uring" : "pread", ioQueueDepth);
+
+    m_IOThread = std::thread(&AssetStreamer::IOThreadMain, this);
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+        m_WakePending = true;
+    }
+
+    m_WakeEvent.notify_one();
+    m_IOThread.join();
+
+    // Decompression jobs reference requests owned by this object.
+    std::unique_lock lock(m_Mutex);
+    m_DecompressionEvent.wait(lock, [this] { return m_PendingDecompressions == 0; });
+}
+
+StreamRequestId AssetStreamer::Request(StreamRequestDesc &&desc)
+{
+    assert(!desc.path.empty());
+
+    auto request = std::make_unique<StreamRequest>();
+    request->desc = std::move(desc);
+    request->requestTime = Clock::now();
+
+    StreamRequestId id = InvalidStreamRequestId;
+
+    {
+        std::lock_guard lock(m_Mutex);
+
+        id = m_NextId++;
+        request->id = id;
+
+        if (m_Stats.requestCount == 0)
+        {
+            m_FirstRequestTime = request->requestTime;
+        }
+        ++m_Stats.requestCount;
+
+        PushQueueEntry(*request);
+        m_Requests.emplace(id, std::move(request));
+    }
+
+    Wake();
+    return id;
+}
+
+void AssetStreamer::UpdatePriority(StreamRequestId id, StreamPriority priority, float distance)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+
+        StreamRequest *request = FindRequest(id);
+        if (request == nullptr || request->state != StreamState::Queued)
+        {
+            return;
+        }
+
+        if (request->desc.priority == priority && request->desc.distance == distance)
+        {
+            return;
+        }
+
+        // The old heap entry becomes stale and is skipped when popped.
+        request->desc.priority = priority;
+        request->desc.distance = distance;
+        ++request->version;
+        PushQueueEntry(*request);
+    }
+
+    Wake();
+}
+
+bool AssetStreamer::Cancel(StreamRequestId id)
+{
+    std::unique_lock lock(m_Mutex);
+
+    StreamRequest *request = FindRequest(id);
+    if (request == nullptr)
+    {
+        return false;
+    }
+
+    switch (request->state)
+    {
+    case StreamState::Queued:
+        ++m_Stats.cancelledCount;
+        m_Requests.erase(id);
+        return true;
+
+    case StreamState::Reading:
+    case StreamState::Decompressing:
+        // The owning stage notices and releases the request when it finishes.
+        request->state = StreamState::Cancelled;
+        return true;
+
+    case StreamState::ReadyForUpload:
+        m_ReadyQueue.erase(std::find(m_ReadyQueue.begin(), m_ReadyQueue.end(), request));
+        ++m_Stats.cancelledCount;
+        ReleaseRequest(id);
+        break;
+
+    default:
+        return false;
+    }
+
+    // The asset's bytes left the budget, a read waiting on it may start now.
+    lock.unlock();
+    Wake();
+    return true;
+}
+
+StreamState AssetStreamer::GetState(StreamRequestId id) const
+{
+    std::lock_guard lock(m_Mutex);
+
+    StreamRequest *request = FindRequest(id);
+    return request != nullptr ? request->state : StreamState::Retired;
+}
+
+void AssetStreamer::SetMaxInFlightBytes(uint64_t maxInFlightBytes)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_MaxInFlightBytes = maxInFlightBytes;
+    }
+
+    Wake();
+}
+
+uint32_t AssetStreamer::PumpUploads(uint32_t maxCount)
+{
+    std::vector<StreamRequest *> ready;
+
+    {
+        std::lock_guard lock(m_Mutex);
+
+        while (!m_ReadyQueue.empty() && ready.size() < maxCount)
+        {
+            StreamRequest *request = m_ReadyQueue.front();
+            m_ReadyQueue.pop_front();
+
+            request->state = StreamState::Resident;
+            ready.push_back(request);
+        }
+    }
+
+    if (ready.empty())
+    {
+        return 0;
+    }
+
+    for (StreamRequest *request : ready)
+    {
+        if (request->desc.onComplete)
+        {
+            StreamedAsset asset{};
+            asset.id = request->id;
+            asset.path = &request->desc.path;
+            asset.succeeded = request->succeeded;
+            asset.data = std::move(request->data);
+
+            request->desc.onComplete(asset);
+        }
+    }
+
+    {
+        std::lock_guard lock(m_Mutex);
+
+        Clock::time_point now = Clock::now();
+
+        for (StreamRequest *request : ready)
+        {
+            if (request->succeeded)
+            {
+                double latency = ToMilliseconds(now - request->requestTime);
+
+                ++m_Stats.completedCount;
+                m_TotalLatency += latency;
+                m_Stats.maxLatency = std::max(m_Stats.maxLatency, latency);
+            }
+            else
+            {
+                ++m_Stats.failedCount;
+            }
+
+            ReleaseRequest(request->id);
+        }
+    }
+
+    Wake();
+    return static_cast<uint32_t>(ready.size());
+}
+
+bool AssetStreamer::IsIdle() const
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Requests.empty();
+}
+
+StreamingStats AssetStreamer::GetStats() const
+{
+    std::lock_guard lock(m_Mutex);
+
+    StreamingStats stats = m_Stats;
+    stats.inFlightBytes = m_InFlightBytes;
+    stats.queuedCount = static_cast<uint32_t>(std::count_if(m_Requests.begin(), m_Requests.end(),
+        [](const auto &entry) { return entry.second->state == StreamState::Queued; }));
+
+    if (stats.completedCount > 0)
+    {
+        stats.averageLatency = m_TotalLatency / stats.completedCount;
+    }
+
+    uint64_t readCount = stats.completedCount + stats.failedCount;
+    if (readCount > 0)
+    {
+        stats.averageReadLatency = m_TotalReadLatency / readCount;
+    }
+
+    double elapsed = ToMilliseconds(Clock::now() - m_FirstRequestTime) / 1000.0;
+    if (stats.requestCount > 0 && elapsed > 0.0)
+    {
+        stats.readThroughput = (stats.bytesRead / (1024.0 * 1024.0)) / elapsed;
+    }
+
+    return stats;
+}
+
+void AssetStreamer::IOThreadMain()
+{
+    std::vector<FileReadResult> results;
+
+    while (true)
+    {
+        IssueReads();
+
+        results.clear();
+
+        bool hasInFlightReads = m_Reader.GetInFlightCount() > 0;
+
+        {
+            std::lock_guard lock(m_Mutex);
+
+            // Only block inside the reader when there is nothing new to issue.
+            hasInFlightReads = hasInFlightReads && !m_WakePending;
+        }
+
+        m_Reader.Poll(results, hasInFlightReads);
+
+        for (const FileReadResult &result : results)
+        {
+            CompleteRead(result);
+        }
+
+        if (!results.empty() || m_Reader.GetInFlightCount() > 0)
+        {
+            continue;
+        }
+
+        std::unique_lock lock(m_Mutex);
+        m_WakeEvent.wait(lock, [this] { return m_WakePending; });
+        m_WakePending = false;
+
+        if (m_Stopping)
+        {
+            break;
+        }
+    }
+
+    // Drain outstanding reads so the kernel stops writing into request buffers.
+    while (m_Reader.GetInFlightCount() > 0)
+    {
+        results.clear();
+        m_Reader.Poll(results, true);
+    }
+}
+
+void AssetStreamer::IssueReads()
+{
+    while (m_Reader.CanSubmit())
+    {
+        StreamRequest *request = nullptr;
+
+        {
+            std::lock_guard lock(m_Mutex);
+
+            m_WakePending = m_Stopping;
+            if (m_Stopping)
+            {
+                return;
+            }
+
+            request = PopQueuedRequest();
+            if (request == nullptr)
+            {
+                return;
+            }
+
+            request->state = StreamState::Reading;
+        }
+
+        bool opened = request->file.IsOpen() || request->file.Open(request->desc.path);
+
+        uint64_t size = 0;
+        if (opened)
+        {
+            uint64_t fileSize = request->file.GetSize();
+            uint64_t available = request->desc.offset < fileSize ? fileSize - request->desc.offset : 0;
+            size = request->desc.size != 0 ? std::min(request->desc.size, available) : available;
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+
+            if (request->state == StreamState::Cancelled)
+            {
+                ++m_Stats.cancelledCount;
+                ReleaseRequest(request->id);
+                continue;
+            }
+
+            if (!opened)
+            {
+                LOGE("Failed to open streamed asset {}", request->desc.path);
+                request->succeeded = false;
+                request->state = StreamState::ReadyForUpload;
+                m_ReadyQueue.push_back(request);
+                continue;
+            }
+
+            // A single asset larger than the whole budget is still allowed through on its own.
+            if (m_InFlightBytes > 0 && m_InFlightBytes + size > m_MaxInFlightBytes)
+            {
+                request->state = StreamState::Queued;
+                PushQueueEntry(*request);
+                return;
+            }
+
+            m_InFlightBytes += size;
+            m_Stats.peakInFlightBytes = std::max(m_Stats.peakInFlightBytes, m_InFlightBytes);
+            request->budgetBytes = size;
+        }
+
+        request->data.resize(size);
+        request->readStartTime = Clock::now();
+
+        FileReadRequest read{};
+        read.file = &request->file;
+        read.offset = request->desc.offset;
+        read.size = size;
+        read.destination = request->data.data();
+        read.userData = request->id;
+
+        bool submitted = m_Reader.Submit(read);
+        assert(submitted);
+        (void)submitted;
+    }
+}
+
+void AssetStreamer::CompleteRead(const FileReadResult &result)
+{
+    StreamRequest *request = nullptr;
+
+    {
+        std::lock_guard lock(m_Mutex);
+
+        request = FindRequest(result.userData);
+        assert(request != nullptr);
+
+        request->file.Close();
+        m_TotalReadLatency += ToMilliseconds(Clock::now() - request->readStartTime);
+
+        if (request->state == StreamState::Cancelled)
+        {
+            ++m_Stats.cancelledCount;
+            ReleaseRequest(request->id);
+            return;
+        }
+
+        if (result.bytesRead != static_cast<int64_t>(request->data.size()))
+        {
+            LOGE("Failed to read streamed asset {}", request->desc.path);
+            request->succeeded = false;
+            request->state = StreamState::ReadyForUpload;
+            m_ReadyQueue.push_back(request);
+            return;
+        }
+
+        m_Stats.bytesRead += result.bytesRead;
+
+        if (!request->desc.decompress)
+        {
+            request->succeeded = true;
+            request->state = StreamState::ReadyForUpload;
+            m_ReadyQueue.push_back(request);
+            return;
+        }
+
+        request->state = StreamState::Decompressing;
+        ++m_PendingDecompressions;
+    }
+
+    m_WorkerThreadPool.DispatchThreadJob(new DecompressJob(*this, request));
+}
+
+void AssetStreamer::FinishDecompression(StreamRequest *request, bool abandoned)
+{
+    std::vector<uint8_t> decompressed;
+    bool succeeded = !abandoned && request->desc.decompress(request->data, decompressed);
+
+    std::lock_guard lock(m_Mutex);
+
+    if (request->state == StreamState::Cancelled)
+    {
+        ++m_Stats.cancelledCount;
+        ReleaseRequest(request->id);
+    }
+    else
+    {
+        if (abandoned)
+        {
+            LOGW("Worker pool shut down before decompressing streamed asset {}", request->desc.path);
+        }
+        else if (!succeeded)
+        {
+            LOGE("Failed to decompress streamed asset {}", request->desc.path);
+        }
+
+        m_Stats.bytesDecompressed += decompressed.size();
+
+        // The decompressed copy replaces the compressed one in the budget.
+        m_InFlightBytes = m_InFlightBytes - request->budgetBytes + decompressed.size();
+        m_Stats.peakInFlightBytes = std::max(m_Stats.peakInFlightBytes, m_InFlightBytes);
+        request->budgetBytes = decompressed.size();
+
+        request->data = std::move(decompressed);
+        request->succeeded = succeeded;
+        request->state = StreamState::ReadyForUpload;
+        m_ReadyQueue.push_back(request);
+    }
+
+    --m_PendingDecompressions;
+    m_DecompressionEvent.notify_all();
+}
+
+AssetStreamer::StreamRequest *AssetStreamer::PopQueuedRequest()
+{
+    while (!m_Queue.empty())
+    {
+        QueueEntry entry = m_Queue.top();
+        m_Queue.pop();
+
+        StreamRequest *request = FindRequest(entry.id);
+        if (request != nullptr && request->state == StreamState::Queued && request->version == entry.version)
+        {
+            return request;
+        }
+    }
+
+    return nullptr;
+}
+
+AssetStreamer::StreamRequest *AssetStreamer::FindRequest(StreamRequestId id) const
+{
+    auto it = m_Requests.find(id);
+    return it != m_Requests.end() ? it->second.get() : nullptr;
+}
+
+void AssetStreamer::PushQueueEntry(const StreamRequest &request)
+{
+    QueueEntry entry{};
+    entry.priority = request.desc.priority;
+    entry.distance = request.desc.distance;
+    entry.version = request.version;
+    entry.id = request.id;
+
+    m_Queue.push(entry);
+}
+
+void AssetStreamer::ReleaseRequest(StreamRequestId id)
+{
+    StreamRequest *request = FindRequest(id);
+    assert(request != nullptr);
+
+    m_InFlightBytes -= request->budgetBytes;
+    m_Requests.erase(id);
+}
+
+void AssetStreamer::Wake()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_WakePending = true;
+    }
+
+    m_WakeEvent.notify_one();
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Common/Utils.h"
+#include "IO/AsyncFileReader.h"
+#include "IO/FileHandle.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <queue>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+class WorkerThreadPool;
+
+using StreamRequestId = uint64_t;
+
+static constexpr StreamRequestId InvalidStreamRequestId = 0;
+
+enum class StreamPriority : uint8_t
+{
+    Critical,
+
+    High,
+
+    Normal,
+
+    Low,
+};
+
+enum class StreamState
+{
+    // Finished, cancelled or never issued; the streamer no longer tracks the request.
+    Retired,
+
+    Queued,
+
+    Reading,
+
+    Decompressing,
+
+    ReadyForUpload,
+
+    Resident,
+
+    Cancelled,
+};
+
+struct StreamedAsset
+{
+    StreamRequestId id{ InvalidStreamRequestId };
+
+    const std::string *path{ nullptr };
+
+    bool succeeded{ false };
+
+    std::vector<uint8_t> data;
+};
+
+// Runs on a worker thread. Returns false when the payload is corrupt.
+using StreamDecompressFunc = std::function<bool(const std::vector<uint8_t> &compressed, std::vector<uint8_t> &decompressed)>;
+
+// Runs on the thread calling AssetStreamer::PumpUploads(), which is where GPU uploads are recorded.
+using StreamCompleteFunc = std::function<void(StreamedAsset &asset)>;
+
+struct StreamRequestDesc
+{
+    std::string path;
+
+    uint64_t offset{ 0 };
+
+    // Zero reads to the end of the file.
+    uint64_t size{ 0 };
+
+    StreamPriority priority{ StreamPriority::Normal };
+
+    // Distance from the camera; closer assets are read first within the same priority.
+    float distance{ 0.0f };
+
+    StreamDecompressFunc decompress{};
+
+    StreamCompleteFunc onComplete{};
+};
+
+struct StreamingStats
+{
+    uint64_t requestCount{ 0 };
+
+    uint64_t completedCount{ 0 };
+
+    uint64_t failedCount{ 0 };
+
+    uint64_t cancelledCount{ 0 };
+
+    uint64_t bytesRead{ 0 };
+
+    uint64_t bytesDecompressed{ 0 };
+
+    uint64_t inFlightBytes{ 0 };
+
+    uint64_t peakInFlightBytes{ 0 };
+
+    uint32_t queuedCount{ 0 };
+
+    // Request to resident, in milliseconds.
+    double averageLatency{ 0.0 };
+
+    double maxLatency{ 0.0 };
+
+    // Time spent waiting on the disk, in milliseconds.
+    double averageReadLatency{ 0.0 };
+
+    // Megabytes per second read since the first request.
+    double readThroughput{ 0.0 };
+};
+
+// Streams file ranges from disk on a dedicated I/O thread, decompresses them on the worker pool and
+// hands the results to the upload path. Bytes are accounted from the moment a read is issued until the
+// asset has been handed over, and no read is started while that total exceeds the in-flight budget.
+class AssetStreamer : public NonCopyable
+{
+public:
+
+    // useIoUring false reads with pread() even where io_uring is available.
+    AssetStreamer(WorkerThreadPool &workerThreadPool, uint64_t maxInFlightBytes = 256ull << 20, uint32_t ioQueueDepth = 32, bool useIoUring = true);
+
+    ~AssetStreamer();
+
+    StreamRequestId Request(StreamRequestDesc &&desc);
+
+    void UpdatePriority(StreamRequestId id, StreamPriority priority, float distance);
+
+    // Returns false when the request has already been handed to the upload path.
+    bool Cancel(StreamRequestId id);
+
+    StreamState GetState(StreamRequestId id) const;
+
+    void SetMaxInFlightBytes(uint64_t maxInFlightBytes);
+
+    // Delivers up to maxCount finished assets to their completion callbacks, returns the number delivered.
+    uint32_t PumpUploads(uint32_t maxCount = UINT32_MAX);
+
+    bool IsIdle() const;
+
+    StreamingStats GetStats() const;
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    struct StreamRequest
+    {
+        StreamRequestId id{ InvalidStreamRequestId };
+
+        StreamRequestDesc desc;
+
+        StreamState state{ StreamState::Queued };
+
+        uint32_t version{ 0 };
+
+        FileHandle file;
+
+        std::vector<uint8_t> data;
+
+        uint64_t budgetBytes{ 0 };
+
+        bool succeeded{ false };
+
+        Clock::time_point requestTime;
+
+        Clock::time_point readStartTime;
+    };
+
+    struct QueueEntry
+    {
+        StreamPriority priority{ StreamPriority::Normal };
+
+        float distance{ 0.0f };
+
+        uint32_t version{ 0 };
+
+        StreamRequestId id{ InvalidStreamRequestId };
+
+        // Inverted so std::priority_queue yields the most urgent entry first.
+        bool operator<(const QueueEntry &other) const;
+    };
+
+    void IOThreadMain();
+
+    void IssueReads();
+
+    void CompleteRead(const FileReadResult &result);
+
+    class DecompressJob;
+
+    // abandoned when the worker pool shut down before running the job, the asset then fails.
+    void FinishDecompression(StreamRequest *request, bool abandoned);
+
+    StreamRequest *PopQueuedRequest();
+
+    StreamRequest *FindRequest(StreamRequestId id) const;
+
+    void PushQueueEntry(const StreamRequest &request);
+
+    void ReleaseRequest(StreamRequestId id);
+
+    void Wake();
+
+    WorkerThreadPool &m_WorkerThreadPool;
+
+    AsyncFileReader m_Reader;
+
+    uint64_t m_MaxInFlightBytes{ 0 };
+
+    uint64_t m_InFlightBytes{ 0 };
+
+    StreamRequestId m_NextId{ 1 };
+
+    std::unordered_map<StreamRequestId, std::unique_ptr<StreamRequest>> m_Requests;
+
+    std::priority_queue<QueueEntry> m_Queue;
+
+    std::deque<StreamRequest *> m_ReadyQueue;
+
+    uint32_t m_PendingDecompressions{ 0 };
+
+    mutable std::mutex m_Mutex;
+
+    std::condition_variable m_WakeEvent;
+
+    std::condition_variable m_DecompressionEvent;
+
+    bool m_WakePending{ false };
+
+    bool m_Stopping{ false };
+
+    std::thread m_IOThread;
+
+    StreamingStats m_Stats{};
+
+    double m_TotalLatency{ 0.0 };
+
+    double m_TotalReadLatency{ 0.0 };
+
+    Clock::time_point m_FirstRequestTime{};
+};
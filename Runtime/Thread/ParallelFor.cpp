@@ -0,0 +1,134 @@
+#include "ParallelFor.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include "Profiling/CpuProfiler.h"
+
+// Shared with the helper jobs, which may start after ParallelFor has returned. Reference counted by
+// hand instead of a shared_ptr so a call allocates nothing but a pooled block.
+struct ParallelForState : public PoolAllocated<MemoryTag::Thread>
+{
+    ParallelForFunc function;
+
+    std::atomic<uint32_t> references{ 1 };
+
+    uint32_t count{ 0 };
+
+    uint32_t batchSize{ 1 };
+
+    std::atomic<uint32_t> nextBegin{ 0 };
+
+    std::atomic<uint32_t> remainingBatches{ 0 };
+
+    std::mutex mutex;
+
+    std::condition_variable doneEvent;
+
+    explicit ParallelForState(ParallelForFunc batchFunction) :
+        function{ batchFunction }
+    {
+    }
+
+    void Release()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete this;
+        }
+    }
+};
+
+// Helpers that start after all batches were taken return without touching the function, which may be gone by then.
+static void RunBatches(ParallelForState &state)
+{
+    while (true)
+    {
+        uint32_t begin = state.nextBegin.fetch_add(state.batchSize, std::memory_order_relaxed);
+        if (begin >= state.count)
+        {
+            return;
+        }
+
+        uint32_t end = std::min(begin + state.batchSize, state.count);
+        state.function(begin, end);
+
+        if (state.remainingBatches.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard lock(state.mutex);
+            state.doneEvent.notify_all();
+        }
+    }
+}
+
+class ParallelForJob : public WorkerThreadJob, public PoolAllocated<MemoryTag::Thread>
+{
+public:
+
+    explicit ParallelForJob(ParallelForState &state) :
+        m_State{ state }
+    {
+    }
+
+    virtual void DoWork() override
+    {
+        RunBatches(m_State);
+        m_State.Release();
+        delete this;
+    }
+
+    virtual void Abandon() override
+    {
+        m_State.Release();
+        delete this;
+    }
+
+    virtual const char *GetName() const override
+    {
+        return "ParallelFor";
+    }
+
+private:
+
+    ParallelForState &m_State;
+};
+
+void ParallelFor(WorkerThreadPool &pool, uint32_t count, uint32_t batchSize, ParallelForFunc function)
+{
+    assert(batchSize > 0);
+
+    PROFILE_SCOPE("ParallelFor");
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint32_t batchCount = (count + batchSize - 1) / batchSize;
+    if (batchCount == 1 || pool.GetThreadNum() == 0)
+    {
+        function(0, count);
+        return;
+    }
+
+    ParallelForState *state = new ParallelForState(function);
+    state->count = count;
+    state->batchSize = batchSize;
+    state->remainingBatches = batchCount;
+
+    uint32_t helperCount = std::min(batchCount - 1, pool.GetThreadNum());
+    state->references.fetch_add(helperCount, std::memory_order_relaxed);
+    for (uint32_t helper = 0; helper < helperCount; ++helper)
+    {
+        pool.DispatchThreadJob(new ParallelForJob(*state));
+    }
+
+    RunBatches(*state);
+
+    {
+        std::unique_lock lock(state->mutex);
+        state->doneEvent.wait(lock, [state] { return state->remainingBatches.load(std::memory_order_acquire) == 0; });
+    }
+
+    state->Release();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+class WorkerThreadPool;
+
+// Non-owning reference to the batch function, so handing a lambda to ParallelFor never copies or
+// allocates. Only valid for the duration of the call it was made for.
+class ParallelForFunc
+{
+public:
+
+    template <typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, ParallelForFunc>>>
+    ParallelForFunc(Function &&function) :
+        m_Context{ const_cast<void *>(static_cast<const void *>(&function)) },
+        m_Invoke{ [](void *context, uint32_t begin, uint32_t end) { (*static_cast<std::remove_reference_t<Function> *>(context))(begin, end); } }
+    {
+    }
+
+    void operator()(uint32_t begin, uint32_t end) const
+    {
+        m_Invoke(m_Context, begin, end);
+    }
+
+private:
+
+    void *m_Context;
+
+    void (*m_Invoke)(void *context, uint32_t begin, uint32_t end);
+};
+
+// Splits [0, count) into batches of batchSize and runs them across the pool. The calling thread takes
+// batches as well, so it is safe to call from inside a worker job, and it returns once every batch has run.
+void ParallelFor(WorkerThreadPool &pool, uint32_t count, uint32_t batchSize, ParallelForFunc function);
@@ -0,0 +1,103 @@
+#include "ParallelRadixSort.h"
+#include "ParallelFor.h"
+#include "ThreadPool.h"
+#include "Memory/LinearArena.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint32_t RadixBits = 8;
+
+static constexpr uint32_t RadixSize = 1 << RadixBits;
+
+static constexpr uint32_t RadixPassCount = 64 / RadixBits;
+
+// Below this many items per chunk the dispatch costs more than the pass.
+static constexpr uint32_t MinItemsPerChunk = 4096;
+
+void ParallelRadixSort(WorkerThreadPool &pool, RadixSortItem *items, RadixSortItem *scratch, uint32_t count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+
+    uint32_t chunkCount = std::max(1u, std::min(pool.GetThreadNum() + 1, count / MinItemsPerChunk));
+    uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    ArenaScope scratchScope{ Memory::GetThreadScratch() };
+    uint32_t *histograms = Memory::GetThreadScratch().AllocateArray<uint32_t>(chunkCount * RadixSize);
+
+    RadixSortItem *source = items;
+    RadixSortItem *destination = scratch;
+
+    for (uint32_t pass = 0; pass < RadixPassCount; ++pass)
+    {
+        uint32_t shift = pass * RadixBits;
+
+        std::fill(histograms, histograms + chunkCount * RadixSize, 0u);
+
+        ParallelFor(pool, chunkCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t chunk = begin; chunk < end; ++chunk)
+            {
+                uint32_t *histogram = &histograms[chunk * RadixSize];
+                uint32_t first = chunk * chunkSize;
+                uint32_t last = std::min(first + chunkSize, count);
+
+                for (uint32_t index = first; index < last; ++index)
+                {
+                    ++histogram[(source[index].key >> shift) & (RadixSize - 1)];
+                }
+            }
+        });
+
+        // Turn the counts into scatter offsets, digit major so the sort stays stable across chunks.
+        bool trivial = false;
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RadixSize; ++digit)
+        {
+            uint32_t digitTotal = 0;
+            for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                uint32_t &slot = histograms[chunk * RadixSize + digit];
+                uint32_t chunkTotal = slot;
+                slot = offset + digitTotal;
+                digitTotal += chunkTotal;
+            }
+
+            if (digitTotal == count)
+            {
+                trivial = true;
+                break;
+            }
+            offset += digitTotal;
+        }
+
+        if (trivial)
+        {
+            continue;
+        }
+
+        ParallelFor(pool, chunkCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t chunk = begin; chunk < end; ++chunk)
+            {
+                uint32_t *offsets = &histograms[chunk * RadixSize];
+                uint32_t first = chunk * chunkSize;
+                uint32_t last = std::min(first + chunkSize, count);
+
+                for (uint32_t index = first; index < last; ++index)
+                {
+                    destination[offsets[(source[index].key >> shift) & (RadixSize - 1)]++] = source[index];
+                }
+            }
+        });
+
+        std::swap(source, destination);
+    }
+
+    if (source != items)
+    {
+        memcpy(items, source, count * sizeof(RadixSortItem));
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+class WorkerThreadPool;
+
+struct RadixSortItem
+{
+    uint64_t key;
+
+    uint32_t value;
+};
+
+// Stable LSD radix sort on 8-bit digits. Each pass histograms and scatters contiguous chunks in
+// parallel, and passes where every key has the same digit are skipped. scratch must hold count
+// items; the sorted result always ends up in items.
+void ParallelRadixSort(WorkerThreadPool &pool, RadixSortItem *items, RadixSortItem *scratch, uint32_t count);
@@ -1,5 +1,108 @@
 #include "ThreadPool.h"
 #include <assert.h>
+#include <algorithm>
+#include <string>
+#include "Profiling/CpuProfiler.h"
+
+WorkerThreadPool *g_WorkerThreadPool = new WorkerThreadPool();
+
+static thread_local const WorkerThreadPool *t_CurrentPool = nullptr;
+
+static thread_local uint32_t t_CurrentThreadIndex = 0;
+
+WorkerThread::WorkerThread(WorkerThreadPool &pool, uint32_t index) :
+    m_Pool{ pool },
+    m_Index{ index }
+{
+    m_Thread = std::thread(&WorkerThread::Run, this);
+}
+
+WorkerThread::~WorkerThread()
+{
+    Stop();
+}
+
+void WorkerThread::DoJob(WorkerThreadJob *job)
+{
+    bool stopping = false;
+
+    {
+        std::lock_guard lock(m_Mutex);
+
+        // Destory() may stop this thread after DispatchThreadJob() handed it out, it might exit without the job.
+        stopping = m_Stopping;
+        if (!stopping)
+        {
+            assert(m_Job == nullptr);
+            m_Job = job;
+        }
+    }
+
+    if (stopping)
+    {
+        job->Abandon();
+        return;
+    }
+
+    m_Event.notify_one();
+}
+
+void WorkerThread::Stop()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+
+    m_Event.notify_one();
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+uint32_t WorkerThread::GetIndex() const
+{
+    return m_Index;
+}
+
+void WorkerThread::Run()
+{
+    t_CurrentPool = &m_Pool;
+    t_CurrentThreadIndex = m_Index;
+
+    PROFILE_THREAD_NAME("Worker " + std::to_string(m_Index));
+
+    while (true)
+    {
+        WorkerThreadJob *job = nullptr;
+
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Event.wait(lock, [this] { return m_Job != nullptr || m_Stopping; });
+
+            if (m_Job == nullptr)
+            {
+                return;
+            }
+
+            job = m_Job;
+            m_Job = nullptr;
+        }
+
+        // Keep draining the shared queue before parking this thread again.
+        while (job != nullptr)
+        {
+            {
+                // Jobs may delete themselves in DoWork(), the name is read before.
+                PROFILE_SCOPE(job->GetName());
+                job->DoWork();
+            }
+            job = m_Pool.ReturnToPoolOrGetNextJob(this);
+        }
+    }
+}
 
 WorkerThreadPool::WorkerThreadPool()
 {
@@ -8,33 +111,150 @@ WorkerThreadPool::WorkerThreadPool()
 
 WorkerThreadPool::~WorkerThreadPool()
 {
+    Destory();
+}
+
+bool WorkerThreadPool::Create(uint32_t threadNum, uint32_t stackSize/*ThreadPriority*/)
+{
+    // std::thread has no portable way to set the stack size, the parameter is kept for the platform layer.
+    (void)stackSize;
+
+    assert(m_Threads.empty());
+
+    if (threadNum == 0)
+    {
+        // hardware_concurrency() may return 0 when unknown.
+        threadNum = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    std::lock_guard lock(m_Mutex);
+
+    m_Dying = false;
+    m_Threads.reserve(threadNum);
+    m_WaitingThreads.reserve(threadNum);
+    m_WaitingJobs.resize(std::max<size_t>(m_WaitingJobs.size(), 64));
+
+    for (uint32_t index = 0; index < threadNum; ++index)
+    {
+        m_Threads.push_back(std::make_unique<WorkerThread>(*this, index));
+        m_WaitingThreads.push_back(m_Threads.back().get());
+    }
+
+    return true;
+}
+
+void WorkerThreadPool::Destory()
+{
+    std::vector<WorkerThreadJob *> abandonedJobs;
 
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Dying = true;
+
+        abandonedJobs.reserve(m_WaitingJobsCount);
+        while (m_WaitingJobsCount > 0)
+        {
+            abandonedJobs.push_back(PopWaitingJob());
+        }
+    }
+
+    for (WorkerThreadJob *job : abandonedJobs)
+    {
+        job->Abandon();
+    }
+
+    for (auto &thread : m_Threads)
+    {
+        thread->Stop();
+    }
+
+    std::lock_guard lock(m_Mutex);
+    m_WaitingThreads.clear();
+    m_Threads.clear();
 }
 
 void WorkerThreadPool::DispatchThreadJob(WorkerThreadJob* job)
 {
     assert(job != nullptr);
 
-    if (m_Dying)
+    WorkerThread *thread = nullptr;
+    bool dying = false;
+
+    {
+        std::lock_guard lock(m_Mutex);
+
+        // Read under the lock Destory() abandons the waiting jobs with, a job queued after that would never run.
+        dying = m_Dying;
+        if (!dying)
+        {
+            if (m_WaitingThreads.empty())
+            {
+                PushWaitingJob(job);
+                return;
+            }
+
+            thread = m_WaitingThreads.back();
+            m_WaitingThreads.pop_back();
+        }
+    }
+
+    if (dying)
     {
         job->Abandon();
         return;
     }
 
-    WorkerThread *thread = nullptr;
+    thread->DoJob(job);
+}
+
+uint32_t WorkerThreadPool::GetThreadNum() const
+{
+    return static_cast<uint32_t>(m_Threads.size());
+}
+
+uint32_t WorkerThreadPool::GetCurrentThreadIndex() const
+{
+    return t_CurrentPool == this ? t_CurrentThreadIndex : GetThreadNum();
+}
 
+WorkerThreadJob *WorkerThreadPool::ReturnToPoolOrGetNextJob(WorkerThread *thread)
+{
+    std::lock_guard lock(m_Mutex);
+
+    if (m_WaitingJobsCount > 0 && !m_Dying)
     {
-        std::lock_guard lock(m_Mutex);
+        return PopWaitingJob();
+    }
 
-        if (m_WaitingThreads.empty())
+    m_WaitingThreads.push_back(thread);
+    return nullptr;
+}
+
+void WorkerThreadPool::PushWaitingJob(WorkerThreadJob *job)
+{
+    if (m_WaitingJobsCount == m_WaitingJobs.size())
+    {
+        // Unroll the ring into a buffer twice the size.
+        std::vector<WorkerThreadJob *> jobs(std::max<size_t>(m_WaitingJobs.size() * 2, 64));
+        for (size_t index = 0; index < m_WaitingJobsCount; ++index)
         {
-            m_WaitingJobs.push_back(job);
-            return;
+            jobs[index] = m_WaitingJobs[(m_WaitingJobsHead + index) % m_WaitingJobs.size()];
         }
 
-        thread = m_WaitingThreads.back();
-        m_WaitingThreads.pop_back();
+        m_WaitingJobs.swap(jobs);
+        m_WaitingJobsHead = 0;
     }
 
-    thread->DoJob(job);
-}
\ No newline at end of file
+    m_WaitingJobs[(m_WaitingJobsHead + m_WaitingJobsCount) % m_WaitingJobs.size()] = job;
+    ++m_WaitingJobsCount;
+}
+
+WorkerThreadJob *WorkerThreadPool::PopWaitingJob()
+{
+    assert(m_WaitingJobsCount > 0);
+
+    WorkerThreadJob *job = m_WaitingJobs[m_WaitingJobsHead];
+    m_WaitingJobsHead = (m_WaitingJobsHead + 1) % m_WaitingJobs.size();
+    --m_WaitingJobsCount;
+    return job;
+}
@@ -1,13 +1,111 @@
 #pragma once
 
 #include <thread>
-#include <Mutex>
-#include <Queue>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include "Common/Utils.h"
+#include "Memory/SmallObjectPool.h"
 
-class WorkerThread;
-class WorkerThreadJob;
+class WorkerThreadPool;
 
-class WorkerThreadPool
+class WorkerThreadJob
+{
+public:
+
+    virtual ~WorkerThreadJob() = default;
+
+    virtual void DoWork() = 0;
+
+    // Called instead of DoWork() when the pool is shutting down.
+    virtual void Abandon() {}
+
+    // Profiler zone name, must outlive the job.
+    virtual const char *GetName() const { return "WorkerThreadJob"; }
+};
+
+// Stores a callable inline and deletes itself once it has run or been abandoned. Pooled, so
+// dispatching a small lambda every frame doesn't reach the heap.
+template <typename Function>
+class FunctionThreadJob : public WorkerThreadJob, public PoolAllocated<MemoryTag::Thread>
+{
+public:
+
+    FunctionThreadJob(Function &&function, const char *name) :
+        m_Function{ std::move(function) },
+        m_Name{ name }
+    {
+    }
+
+    FunctionThreadJob(const Function &function, const char *name) :
+        m_Function{ function },
+        m_Name{ name }
+    {
+    }
+
+    virtual void DoWork() override
+    {
+        m_Function();
+        delete this;
+    }
+
+    virtual void Abandon() override
+    {
+        delete this;
+    }
+
+    virtual const char *GetName() const override
+    {
+        return m_Name;
+    }
+
+private:
+
+    Function m_Function;
+
+    const char *m_Name;
+};
+
+class WorkerThread : public NonCopyable
+{
+public:
+
+    WorkerThread(WorkerThreadPool &pool, uint32_t index);
+
+    ~WorkerThread();
+
+    void DoJob(WorkerThreadJob *job);
+
+    void Stop();
+
+    uint32_t GetIndex() const;
+
+private:
+
+    void Run();
+
+    WorkerThreadPool &m_Pool;
+
+    uint32_t m_Index{ 0 };
+
+    std::thread m_Thread;
+
+    std::mutex m_Mutex;
+
+    std::condition_variable m_Event;
+
+    WorkerThreadJob *m_Job{ nullptr };
+
+    bool m_Stopping{ false };
+};
+
+class WorkerThreadPool : public NonCopyable
 {
 public:
 
@@ -15,17 +113,49 @@ public:
 
     ~WorkerThreadPool();
 
-    bool Create(unit32_t threadNum, uint32_t stackSize/*ThreadPriority*/);
+    bool Create(uint32_t threadNum, uint32_t stackSize/*ThreadPriority*/);
 
     void Destory();
 
     void DispatchThreadJob(WorkerThreadJob* job);
 
+    // name labels the job in profiler captures and must be a string literal.
+    template <typename Function, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Function> &>>>
+    void DispatchThreadJob(Function &&function, const char *name = "FunctionThreadJob")
+    {
+        DispatchThreadJob(new FunctionThreadJob<std::decay_t<Function>>(std::forward<Function>(function), name));
+    }
+
+    uint32_t GetThreadNum() const;
+
+    // Index of the calling worker in [0, GetThreadNum()), or GetThreadNum() when called from outside the pool.
+    uint32_t GetCurrentThreadIndex() const;
+
 private:
 
+    friend class WorkerThread;
+
+    WorkerThreadJob *ReturnToPoolOrGetNextJob(WorkerThread *thread);
+
+    // Ring buffer over m_WaitingJobs, grows but never shrinks. Called with m_Mutex held.
+    void PushWaitingJob(WorkerThreadJob *job);
+
+    WorkerThreadJob *PopWaitingJob();
+
     std::mutex m_Mutex;
 
-    std::deque<WorkerThread *> m_Threads;
+    std::vector<std::unique_ptr<WorkerThread>> m_Threads;
+
+    std::vector<WorkerThread *> m_WaitingThreads;
+
+    std::vector<WorkerThreadJob *> m_WaitingJobs;
+
+    size_t m_WaitingJobsHead{ 0 };
+
+    size_t m_WaitingJobsCount{ 0 };
+
+    // Guarded by m_Mutex.
+    bool m_Dying{ false };
+};
 
-    std::deque<WorkerThread *> m_WaitingThreads;
-};
\ No newline at end of file
+extern WorkerThreadPool *g_WorkerThreadPool;
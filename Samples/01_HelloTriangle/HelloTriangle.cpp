@@ -1,4 +1,6 @@
 #include "../../Runtime/Application.h"
+#include "../../Runtime/Platform.h"
+#include "../../Runtime/Platform/VulkanWindow.h"
 #include "../../Runtime/Gfx/Vulkan/VulkanGfx.h"
 
 class HelloTriangle : public Application
@@ -12,8 +14,49 @@ public:
     {
 
     }
+
+    // Presents to the platform's window, or renders offscreen when it has none.
+    bool Prepare(Platform &platform) override
+    {
+        GfxPresentDesc present{};
+        const VulkanWindow *window = platform.GetVulkanWindow();
+        if (window != nullptr)
+        {
+            present.instanceExtensions = window->GetRequiredInstanceExtensions();
+        }
+
+        bool headless = present.instanceExtensions.empty();
+        if (!headless)
+        {
+            present.createSurface = [window](VkInstance instance) { return window->CreateSurface(instance); };
+            present.extent = window->GetWindowExtent();
+        }
+
+        m_Gfx = std::make_unique<VulkanGfx>(GetName(), std::unordered_map<const char *, bool>{}, std::vector<const char *>{}, headless, std::string{}, present);
+        m_Gfx->SetClearColor(VkClearColorValue{ { 0.1f, 0.2f, 0.4f, 1.0f } });
+        return true;
+    }
+
+    void Render(double deltaTime, double alpha) override
+    {
+        m_Gfx->BeginFrame();
+
+        // Nothing to draw but the clear, which is the first write to the image.
+        m_Gfx->AcquireImage();
+        m_Gfx->EndFrame();
+    }
+
+    void Resize(uint32_t width, uint32_t height) override
+    {
+        m_Gfx->Resize(VkExtent2D{ width, height });
+    }
+
+    void Finish() override
+    {
+        m_Gfx.reset();
+    }
 };
 std::unique_ptr<Application> CreateApplication()
 {
     return std::make_unique<HelloTriangle>();
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 extern std::unique_ptr<Application> CreateApplication();
 
+#if defined(_WIN32)
 #include "Platform/Windows/WindowsPlatform.h"
 int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine, INT nCmdShow)
 {
@@ -16,3 +17,65 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLin
 	}
 	return EXIT_SUCCESS;
 }
+#else
+#include <cstdlib>
+#include <cstring>
+#include "Platform/Linux/LinuxPlatform.h"
+#include "Platform/Headless/HeadlessPlatform.h"
+#include "Profiling/CpuProfiler.h"
+int main(int argc, char **argv)
+{
+	bool headless = false;
+	const char *tracePath = nullptr;
+	FrameLoopDesc frameLoopDesc{};
+	for (int index = 1; index < argc; ++index)
+	{
+		if (strcmp(argv[index], "--headless") == 0)
+		{
+			headless = true;
+		}
+		else if (strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+		{
+			frameLoopDesc.maxFrames = strtoull(argv[++index], nullptr, 10);
+		}
+		else if (strcmp(argv[index], "--fps") == 0 && index + 1 < argc)
+		{
+			frameLoopDesc.targetFrameRate = strtod(argv[++index], nullptr);
+		}
+		else if (strcmp(argv[index], "--trace") == 0 && index + 1 < argc)
+		{
+			tracePath = argv[++index];
+		}
+	}
+
+	std::unique_ptr<Platform> platform;
+	if (headless)
+	{
+		platform = std::make_unique<HeadlessPlatform>();
+	}
+	else
+	{
+		platform = std::make_unique<LinuxPlatform>();
+	}
+	platform->SetFrameLoopDesc(frameLoopDesc);
+
+	auto app = CreateApplication();
+	app->SetName("Hello Triangle");
+
+	if (platform->Initialize(std::move(app)))
+	{
+		platform->MainLoop();
+	}
+	platform->Terminate();
+
+#if defined(NEXT_RENDER_PROFILER)
+	if (tracePath != nullptr)
+	{
+		g_CpuProfiler.ExportChromeTrace(tracePath);
+	}
+#else
+	(void)tracePath;
+#endif
+	return EXIT_SUCCESS;
+}
+#endif